@@ -52,6 +52,7 @@ extern "C" {
 
 #include  <ViennaRNA/io/file_formats.h>
 #include  <ViennaRNA/io/file_formats_msa.h>
+#include  <ViennaRNA/io/probability_store.h>
 #include  <ViennaRNA/io/utils.h>
 
 #include  <ViennaRNA/loops/external.h>
@@ -142,6 +143,7 @@ extern "C" {
 
 namespace std {
   %template(DoublePair) std::pair<double,double>;
+  %template(StringDoublePair) std::pair<std::string,double>;
   %template(IntVector) std::vector<int>;
   %template(UIntVector) std::vector<unsigned int>;
   %template(DoubleVector) std::vector<double>;
@@ -155,6 +157,7 @@ namespace std {
   %template(HelixVector) vector<vrna_hx_t>;
   %template(PathVector) std::vector<vrna_path_t>;
   %template(MoveVector) std::vector<vrna_move_t>;
+  %template(StringDoublePairVector) std::vector<std::pair<std::string,double> >;
 };
 
 %{
@@ -215,6 +218,7 @@ namespace std {
 /* Include all relevant interface definitions */
 /*############################################*/
 %include var_arrays.i
+%include threads.i
 %include type_checks.i
 %include params.i
 %include model_details.i
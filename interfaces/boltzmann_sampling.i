@@ -73,7 +73,9 @@ typedef struct {} vrna_pbacktrack_mem_t;
     std::vector<std::string> str_vec;
     char  **ptr, **output;
 
+    FC_BEGIN_ALLOW_THREADS($self)
     output = vrna_pbacktrack_num($self, num_samples, options);
+    FC_END_ALLOW_THREADS
 
     if (output) {
       for (ptr = output; *ptr != NULL; ptr++) {
@@ -95,7 +97,9 @@ typedef struct {} vrna_pbacktrack_mem_t;
     std::vector<std::string> str_vec;
     char  **ptr, **output;
 
+    FC_BEGIN_ALLOW_THREADS($self)
     output = vrna_pbacktrack5_num($self, num_samples, length, options);
+    FC_END_ALLOW_THREADS
 
     if (output) {
       for (ptr = output; *ptr != NULL; ptr++) {
@@ -118,7 +122,9 @@ typedef struct {} vrna_pbacktrack_mem_t;
     std::vector<std::string> str_vec;
     char  **ptr, **output;
 
+    FC_BEGIN_ALLOW_THREADS($self)
     output = vrna_pbacktrack_sub_num($self, num_samples, start, end, options);
+    FC_END_ALLOW_THREADS
 
     if (output) {
       for (ptr = output; *ptr != NULL; ptr++) {
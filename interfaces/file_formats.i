@@ -280,3 +280,231 @@ int my_file_msa_read_record(FILE                      *filehandle,
 %constant unsigned int FILE_FORMAT_MSA_APPEND    = VRNA_FILE_FORMAT_MSA_APPEND;
 
 %include <ViennaRNA/io/file_formats_msa.h>
+
+
+/*
+ *  Probability stores are created through a small wrapper object that
+ *  finalizes the store upon close() or destruction
+ */
+%ignore vrna_prob_store_t;
+%ignore vrna_prob_store_record_t;
+
+%rename (prob_store_writer) vrna_prob_store_t;
+
+typedef struct {} vrna_prob_store_t;
+
+%nodefaultctor vrna_prob_store_t;
+%nodefaultdtor vrna_prob_store_t;
+
+%extend vrna_prob_store_t {
+  vrna_prob_store_t(const char *filename) {
+    vrna_prob_store_t *s = (vrna_prob_store_t *)vrna_alloc(sizeof(vrna_prob_store_t));
+    *s = vrna_prob_store_create(filename);
+    if (!(*s)) {
+      free(s);
+      throw std::runtime_error("Failed to create probability store");
+    }
+    return s;
+  }
+
+  ~vrna_prob_store_t() {
+    vrna_prob_store_close(*$self);
+    free($self);
+  }
+
+  int
+  add(std::string           id,
+      vrna_fold_compound_t  *fc,
+      std::string           structure,
+      double                mfe,
+      double                ensemble_energy,
+      double                cutoff = 1e-5)
+  {
+    return vrna_prob_store_add_fc(*$self,
+                                  id.c_str(),
+                                  fc,
+                                  (structure.empty()) ? NULL : structure.c_str(),
+                                  mfe,
+                                  ensemble_energy,
+                                  cutoff);
+  }
+
+  int
+  close(void)
+  {
+    int ret = vrna_prob_store_close(*$self);
+    *$self = NULL;
+    return ret;
+  }
+}
+
+
+/*
+ *  Probability stores are read by a pure python implementation that
+ *  maps the file into memory and provides zero-copy views of the data
+ */
+#ifdef SWIGPYTHON
+%pythoncode %{
+import mmap as _mmap
+import struct as _struct
+
+
+class prob_store_record(object):
+    """
+    A record of a probability store
+
+    The pair list is available as list of tuples (i, j, p, type) through the `pairs`
+    attribute, and as raw buffer with 16 bytes per element (two int32 positions, a float32
+    probability, and an int32 type) through `pairs_buffer`. Unpaired probabilities are
+    provided as list of ulength read-only memoryviews, where entry [u - 1][i - 1] is the
+    probability that the stretch of u nucleotides ending at position i is unpaired.
+    All buffers point directly into the store and can be passed to numpy.frombuffer() or
+    numpy.asarray() without copying.
+    """
+
+    _pair = _struct.Struct('=iifi')
+
+    def __init__(self, store, entry):
+        (id_offset, data_offset, self.length, self.ulength, self.n_pairs, has_structure,
+         self.mfe, self.ensemble_energy, self.cutoff, self.temperature,
+         self.dangles, self.noLP, self.noGU, self.circ, self.gquad,
+         self.window_size, self.max_bp_span, self.cutpoint, self.n_seq, _) = entry
+
+        data          = store._data
+        n             = self.length
+        offset        = data_offset
+        self.id       = store._string(id_offset)
+        self.sequence = data[offset:offset + n].decode()
+        offset        += (n + 8) // 8 * 8
+
+        if has_structure:
+            self.structure = data[offset:offset + n].decode()
+            offset         += (n + 8) // 8 * 8
+        else:
+            self.structure = None
+
+        size              = self._pair.size * self.n_pairs
+        self.pairs_buffer = store._view[offset:offset + size]
+        offset            += size + self._pair.size
+
+        self.unpaired = []
+        for u in range(self.ulength):
+            self.unpaired.append(store._view[offset:offset + 8 * n].cast('d'))
+            offset += 8 * n
+
+    @property
+    def pairs(self):
+        return [p for p in self._pair.iter_unpack(self.pairs_buffer)]
+
+
+class prob_store(object):
+    """
+    Read-only access to a probability store
+
+    Probability stores are written by RNAfold, RNAalifold, RNAcofold, and RNAplfold
+    (option --probability-store), by prob_store_writer, or by vrna_prob_store_create()
+    of the C-library.
+    Records can be accessed by their number in insertion order or by their ID, e.g.
+
+        with RNA.prob_store("probs.bpp") as store:
+            for rec in store:
+                print(rec.id, rec.ensemble_energy, len(rec.pairs))
+            rec = store["my_sequence"]
+    """
+
+    _magic      = b'VRNA_BPP'
+    _version    = 1
+    _byte_order = 0x01020304
+    _header     = _struct.Struct('=8sIIQQ')
+    _index      = _struct.Struct('=QQIIIIddddiiiiiiiIII')
+    _position   = _struct.Struct('=Q')
+
+    def __init__(self, filename):
+        with open(filename, 'rb') as f:
+            self._data = _mmap.mmap(f.fileno(), 0, access=_mmap.ACCESS_READ)
+
+        self._view = memoryview(self._data)
+
+        if len(self._data) < self._header.size:
+            raise ValueError('File "%s" is not a valid probability store' % filename)
+
+        magic, version, byte_order, self._n, self._index_offset = self._header.unpack_from(self._data, 0)
+
+        if magic != self._magic:
+            raise ValueError('File "%s" is not a valid probability store' % filename)
+        if byte_order != self._byte_order:
+            raise ValueError('File "%s" was written on a machine with different byte order' % filename)
+        if version != self._version:
+            raise ValueError('Unsupported version %d of file "%s"' % (version, filename))
+
+        self._order_offset = self._index_offset + self._index.size * self._n
+        if self._order_offset + self._position.size * self._n > len(self._data):
+            raise ValueError('File "%s" is not a valid probability store' % filename)
+
+    def __len__(self):
+        return self._n
+
+    def __iter__(self):
+        for k in range(self._n):
+            yield self._record(k)
+
+    def __getitem__(self, key):
+        if isinstance(key, int):
+            if key < 0:
+                key += self._n
+            if key < 0 or key >= self._n:
+                raise IndexError('record index out of range')
+            return self._record(key)
+
+        k = self._find(key)
+        if k is None:
+            raise KeyError(key)
+        return self._record(k)
+
+    def __contains__(self, key):
+        return self._find(key) is not None
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *args):
+        self.close()
+
+    def keys(self):
+        return [self._id(k) for k in range(self._n)]
+
+    def close(self):
+        """Close the store, the mapping is released once no record refers to it anymore"""
+        self._view.release()
+        try:
+            self._data.close()
+        except BufferError:
+            pass
+
+    def _string(self, offset):
+        return self._data[offset:self._data.find(b'\0', offset)].decode()
+
+    def _entry(self, k):
+        return self._index.unpack_from(self._data, self._index_offset + self._index.size * k)
+
+    def _id(self, k):
+        return self._string(self._entry(k)[0])
+
+    def _record(self, k):
+        return prob_store_record(self, self._entry(k))
+
+    def _find(self, key):
+        lo, hi = 0, self._n
+        while lo < hi:
+            mid = (lo + hi) // 2
+            k   = self._position.unpack_from(self._data, self._order_offset + self._position.size * mid)[0]
+            c   = self._id(k)
+            if c == key:
+                return k
+            elif key < c:
+                hi = mid
+            else:
+                lo = mid + 1
+        return None
+%}
+#endif
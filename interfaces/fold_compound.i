@@ -45,6 +45,7 @@ typedef struct {
   vrna_mx_mfe_t         *matrices;
   vrna_mx_pf_t          *exp_matrices;
   vrna_hc_t             *hc;
+  unsigned int          mem_generation;
 } vrna_fold_compound_t;
 %mutable;
 
@@ -135,9 +136,10 @@ def __repr__(self):
   var_array<unsigned int> *
   vrna_fold_compound_t_strand_number_get(vrna_fold_compound_t *fc)
   {
-    return var_array_new(fc->length,
-                         fc->strand_number,
-                         VAR_ARRAY_LINEAR | VAR_ARRAY_ONE_BASED);
+    return var_array_new_fc(fc->length,
+                            fc->strand_number,
+                            VAR_ARRAY_LINEAR | VAR_ARRAY_ONE_BASED,
+                            fc);
   }
 
   std::string
@@ -149,42 +151,47 @@ def __repr__(self):
   var_array<unsigned int> *
   vrna_fold_compound_t_strand_order_get(vrna_fold_compound_t *fc)
   {
-    return var_array_new(fc->strands,
-                         fc->strand_order,
-                         VAR_ARRAY_LINEAR);
+    return var_array_new_fc(fc->strands,
+                            fc->strand_order,
+                            VAR_ARRAY_LINEAR,
+                            fc);
   }
 
   var_array<unsigned int> *
   vrna_fold_compound_t_strand_start_get(vrna_fold_compound_t *fc)
   {
-    return var_array_new(fc->strands,
-                         fc->strand_start,
-                         VAR_ARRAY_LINEAR);
+    return var_array_new_fc(fc->strands,
+                            fc->strand_start,
+                            VAR_ARRAY_LINEAR,
+                            fc);
   }
 
   var_array<unsigned int> *
   vrna_fold_compound_t_strand_end_get(vrna_fold_compound_t *fc)
   {
-    return var_array_new(fc->strands,
-                         fc->strand_end,
-                         VAR_ARRAY_LINEAR);
+    return var_array_new_fc(fc->strands,
+                            fc->strand_end,
+                            VAR_ARRAY_LINEAR,
+                            fc);
   }
 
   var_array<int> *
   vrna_fold_compound_t_iindx_get(vrna_fold_compound_t *fc)
   {
-    return var_array_new(fc->length,
-                         fc->iindx,
-                         VAR_ARRAY_LINEAR | VAR_ARRAY_ONE_BASED);
+    return var_array_new_fc(fc->length,
+                            fc->iindx,
+                            VAR_ARRAY_LINEAR | VAR_ARRAY_ONE_BASED,
+                            fc);
   }
 
   var_array<int> *
   vrna_fold_compound_t_jindx_get(vrna_fold_compound_t *fc)
   {
     if (fc->type == VRNA_FC_TYPE_SINGLE)
-      return var_array_new(fc->length,
-                           fc->jindx,
-                           VAR_ARRAY_LINEAR | VAR_ARRAY_ONE_BASED);
+      return var_array_new_fc(fc->length,
+                              fc->jindx,
+                              VAR_ARRAY_LINEAR | VAR_ARRAY_ONE_BASED,
+                              fc);
 
     return NULL;
   }
@@ -193,9 +200,10 @@ def __repr__(self):
   vrna_fold_compound_t_sequence_encoding_get(vrna_fold_compound_t *fc)
   {
     if (fc->type == VRNA_FC_TYPE_SINGLE)
-      return var_array_new(fc->length + 1,
-                           fc->sequence_encoding,
-                           VAR_ARRAY_LINEAR | VAR_ARRAY_ONE_BASED);
+      return var_array_new_fc(fc->length + 1,
+                              fc->sequence_encoding,
+                              VAR_ARRAY_LINEAR | VAR_ARRAY_ONE_BASED,
+                              fc);
 
     return NULL;
   }
@@ -203,9 +211,10 @@ def __repr__(self):
   var_array<short> *
   vrna_fold_compound_t_sequence_encoding2_get(vrna_fold_compound_t *fc)
   {
-    return var_array_new(fc->length + 1,
-                         fc->sequence_encoding2,
-                         VAR_ARRAY_LINEAR | VAR_ARRAY_ONE_BASED);
+    return var_array_new_fc(fc->length + 1,
+                            fc->sequence_encoding2,
+                            VAR_ARRAY_LINEAR | VAR_ARRAY_ONE_BASED,
+                            fc);
   }
 %}
 
@@ -224,5 +233,6 @@ def __repr__(self):
 %constant unsigned int OPTION_HYBRID    = VRNA_OPTION_HYBRID;
 %constant unsigned int OPTION_EVAL_ONLY = VRNA_OPTION_EVAL_ONLY;
 %constant unsigned int OPTION_WINDOW    = VRNA_OPTION_WINDOW;
+%constant unsigned int OPTION_ALN_UNIQUE = VRNA_OPTION_ALN_UNIQUE;
 
 %include <ViennaRNA/fold_compound.h>
@@ -343,6 +343,55 @@ char *my_circalifold(std::vector<std::string> alignment, float *energy);
 char *my_circalifold(std::vector<std::string> alignment, char *constraints, float *energy);
 
 
+%rename (fold_batch) my_fold_batch;
+
+#ifdef SWIGPYTHON
+%feature("kwargs") my_fold_batch;
+#endif
+
+%{
+  /* MFE and MFE structure for many sequences, computed by C threads without holding the GIL */
+  std::vector<std::pair<std::string, double> >
+  my_fold_batch(std::vector<std::string> sequences,
+                vrna_md_t                *md = NULL,
+                int                      threads = 0)
+  {
+    std::vector<std::pair<std::string, double> > result;
+    std::vector<const char *>                    vc;
+    char                                         **structures;
+    float                                        *energies;
+    size_t                                       n;
+
+    n           = sequences.size();
+    structures  = (char **)vrna_alloc(sizeof(char *) * (n + 1));
+    energies    = (float *)vrna_alloc(sizeof(float) * (n + 1));
+
+    std::transform(sequences.begin(),
+                   sequences.end(),
+                   std::back_inserter(vc),
+                   convert_vecstring2veccharcp);
+    vc.push_back(NULL); /* mark end of sequences */
+
+    BEGIN_ALLOW_THREADS
+    vrna_fold_batch((const char **)&vc[0], md, structures, energies, threads);
+    END_ALLOW_THREADS
+
+    for (size_t i = 0; i < n; i++) {
+      result.push_back(std::make_pair(std::string(structures[i] ? structures[i] : ""),
+                                      (double)energies[i]));
+      free(structures[i]);
+    }
+
+    free(structures);
+    free(energies);
+
+    return result;
+  }
+%}
+
+std::vector<std::pair<std::string, double> > my_fold_batch(std::vector<std::string> sequences, vrna_md_t *md = NULL, int threads = 0);
+
+
 /* tell swig that these functions return objects that require memory management */
 %newobject vrna_fold_compound_t::mfe;
 %newobject vrna_fold_compound_t::mfe_dimer;
@@ -361,7 +410,11 @@ char *my_circalifold(std::vector<std::string> alignment, char *constraints, floa
   char *mfe(float *OUTPUT){
 
     char *structure = (char *)vrna_alloc(sizeof(char) * ($self->length + 1));
+
+    FC_BEGIN_ALLOW_THREADS($self)
     *OUTPUT = vrna_mfe($self, structure);
+    FC_END_ALLOW_THREADS
+
     return structure;
   }
 
@@ -369,7 +422,11 @@ char *my_circalifold(std::vector<std::string> alignment, char *constraints, floa
   char *mfe_dimer(float *OUTPUT){
 
     char *structure = (char*)vrna_alloc(sizeof(char) * ($self->length + 1));
+
+    FC_BEGIN_ALLOW_THREADS($self)
     *OUTPUT = vrna_mfe_dimer($self, structure);
+    FC_END_ALLOW_THREADS
+
     return structure;
   }
 
@@ -68,6 +68,55 @@ char *my_pf_fold(char *string, char *constraints, float *OUTPUT);
 char *my_pf_circ_fold(char *string, char *constraints, float *OUTPUT);
 char *my_pf_circ_fold(char *string, float *OUTPUT);
 
+
+%rename (pf_fold_batch) my_pf_fold_batch;
+
+#ifdef SWIGPYTHON
+%feature("kwargs") my_pf_fold_batch;
+#endif
+
+%{
+  /* ensemble free energy and pairing propensity for many sequences, computed by C threads without holding the GIL */
+  std::vector<std::pair<std::string, double> >
+  my_pf_fold_batch(std::vector<std::string> sequences,
+                   vrna_md_t                *md = NULL,
+                   int                      threads = 0)
+  {
+    std::vector<std::pair<std::string, double> > result;
+    std::vector<const char *>                    vc;
+    char                                         **structures;
+    float                                        *energies;
+    size_t                                       n;
+
+    n           = sequences.size();
+    structures  = (char **)vrna_alloc(sizeof(char *) * (n + 1));
+    energies    = (float *)vrna_alloc(sizeof(float) * (n + 1));
+
+    std::transform(sequences.begin(),
+                   sequences.end(),
+                   std::back_inserter(vc),
+                   convert_vecstring2veccharcp);
+    vc.push_back(NULL); /* mark end of sequences */
+
+    BEGIN_ALLOW_THREADS
+    vrna_pf_fold_batch((const char **)&vc[0], md, structures, energies, threads);
+    END_ALLOW_THREADS
+
+    for (size_t i = 0; i < n; i++) {
+      result.push_back(std::make_pair(std::string(structures[i] ? structures[i] : ""),
+                                      (double)energies[i]));
+      free(structures[i]);
+    }
+
+    free(structures);
+    free(energies);
+
+    return result;
+  }
+%}
+
+std::vector<std::pair<std::string, double> > my_pf_fold_batch(std::vector<std::string> sequences, vrna_md_t *md = NULL, int threads = 0);
+
 %ignore pf_circ_fold;
 
 /* make the float precision identifier available through the interface */
@@ -114,6 +163,7 @@ double my_pf_add(double dG1, double dG2, double kT = 0);
 
 /* tell swig that these functions return objects that require memory management */
 %newobject vrna_fold_compound_t::pf;
+%newobject vrna_fold_compound_t::pf_update;
 
 %extend vrna_fold_compound_t{
 
@@ -121,7 +171,25 @@ double my_pf_add(double dG1, double dG2, double kT = 0);
   pf(float *OUTPUT)
   {
     char *structure = (char *)vrna_alloc(sizeof(char) * ($self->length + 1)); /*output is a structure pointer*/
+
+    FC_BEGIN_ALLOW_THREADS($self)
     *OUTPUT= vrna_pf($self, structure);
+    FC_END_ALLOW_THREADS
+
+    return structure;
+  }
+
+  char *
+  pf_update(unsigned int  i,
+            unsigned int  j,
+            float         *OUTPUT)
+  {
+    char *structure = (char *)vrna_alloc(sizeof(char) * ($self->length + 1)); /*output is a structure pointer*/
+
+    FC_BEGIN_ALLOW_THREADS($self)
+    *OUTPUT= vrna_pf_update($self, i, j, structure);
+    FC_END_ALLOW_THREADS
+
     return structure;
   }
 
@@ -306,7 +374,12 @@ void my_get_concentrations(double FcAB, double FcAA, double FcBB, double FEA,dou
            float *FAB)
   {
     char *structure = (char *)vrna_alloc(sizeof(char) * ($self->length + 1)); /*output is a structure pointer*/
-    vrna_dimer_pf_t temp = vrna_pf_dimer($self, structure);
+    vrna_dimer_pf_t temp;
+
+    FC_BEGIN_ALLOW_THREADS($self)
+    temp = vrna_pf_dimer($self, structure);
+    FC_END_ALLOW_THREADS
+
     *FAB  = (float)temp.FAB;
     *FcAB = (float)temp.FcAB;
     *FA   = (float)temp.FA;
@@ -322,8 +395,22 @@ void my_get_concentrations(double FcAB, double FcAA, double FcBB, double FEA,dou
 %include  <ViennaRNA/concentrations.h>
 
 
+%newobject vrna_fold_compound_t::bpp_view;
+
+#ifdef SWIGPYTHON
+/* the array keeps the fold_compound its data belongs to alive */
+%pythonappend vrna_fold_compound_t::bpp_view %{
+    if val is not None:
+        val._owner = self
+%}
+#endif
+
 %extend vrna_fold_compound_t{
 
+  /*
+   *  Note, that bpp() returns a copy of the probabilities, while
+   *  bpp_view() provides zero-copy access to the triangular matrix
+   */
   std::vector<std::vector<double> >
   bpp(void)
   {
@@ -348,6 +435,26 @@ void my_get_concentrations(double FcAB, double FcAA, double FcBB, double FEA,dou
     }
     return probabilities;
   }
+
+  /*
+   *  The returned array refers to the probabilities of the
+   *  fold_compound, i.e. the probability of pair (i, j) with i < j
+   *  resides at position iindx[i] - j. Once the fold_compound
+   *  releases its partition function matrices, any further access
+   *  raises an exception
+   */
+  var_array<FLT_OR_DBL> *
+  bpp_view(void)
+  {
+    if (($self->exp_matrices) &&
+        ($self->exp_matrices->probs))
+      return var_array_new_fc($self->length,
+                              $self->exp_matrices->probs,
+                              VAR_ARRAY_TRI | VAR_ARRAY_ONE_BASED,
+                              $self);
+
+    return NULL;
+  }
 }
 
 %{
@@ -159,7 +159,12 @@ std::vector<subopt_solution> my_subopt(char *seq, int delta, FILE *nullfile = NU
          FILE *nullfile = NULL)
   {
     std::vector<subopt_solution> ret;
-    SOLUTION *sol = vrna_subopt($self, delta, sorted, nullfile);
+    SOLUTION *sol;
+
+    FC_BEGIN_ALLOW_THREADS($self)
+    sol = vrna_subopt($self, delta, sorted, nullfile);
+    FC_END_ALLOW_THREADS
+
     if (sol)
       for(int i = 0; sol[i].structure != NULL; i++){
         subopt_solution a;
@@ -179,7 +184,12 @@ std::vector<subopt_solution> my_subopt(char *seq, int delta, FILE *nullfile = NU
   subopt_zuker(void)
   {
     std::vector<subopt_solution> ret;
-    SOLUTION *sol = vrna_subopt_zuker($self);
+    SOLUTION *sol;
+
+    FC_BEGIN_ALLOW_THREADS($self)
+    sol = vrna_subopt_zuker($self);
+    FC_END_ALLOW_THREADS
+
     if (sol)
       for(int i = 0; sol[i].structure != NULL; i++){
         subopt_solution a;
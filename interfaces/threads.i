@@ -0,0 +1,61 @@
+/**********************************************/
+/* BEGIN interface for multi-threading        */
+/**********************************************/
+
+/*
+ *  Long running computations release the Python GIL such that other
+ *  Python threads may run concurrently. For methods of a fold compound
+ *  this is only done if nothing bound to it calls back into the
+ *  interpreter, i.e. if no Python callbacks or data have been attached
+ *  as status callback, soft constraints, or unstructured domains.
+ *  Note, that concurrent calls for the same fold compound are still
+ *  not allowed.
+ */
+#ifdef SWIGPYTHON
+%{
+
+  static int
+  fc_releases_gil(vrna_fold_compound_t *fc)
+  {
+    unsigned int s;
+
+    if ((fc->auxdata) ||
+        (fc->stat_cb) ||
+        ((fc->domains_up) && (fc->domains_up->data)))
+      return 0;
+
+    if (fc->type == VRNA_FC_TYPE_SINGLE) {
+      if ((fc->sc) && (fc->sc->data))
+        return 0;
+    } else if (fc->scs) {
+      for (s = 0; s < fc->n_seq; s++)
+        if ((fc->scs[s]) && (fc->scs[s]->data))
+          return 0;
+    }
+
+    return 1;
+  }
+
+#define FC_BEGIN_ALLOW_THREADS(fc) \
+  { \
+    PyThreadState *_fc_save = (fc_releases_gil(fc)) ? PyEval_SaveThread() : NULL;
+
+#define FC_END_ALLOW_THREADS \
+    if (_fc_save) \
+      PyEval_RestoreThread(_fc_save); \
+  }
+
+#define BEGIN_ALLOW_THREADS   Py_BEGIN_ALLOW_THREADS
+#define END_ALLOW_THREADS     Py_END_ALLOW_THREADS
+
+%}
+#else
+%{
+
+#define FC_BEGIN_ALLOW_THREADS(fc)  {
+#define FC_END_ALLOW_THREADS        }
+#define BEGIN_ALLOW_THREADS         {
+#define END_ALLOW_THREADS           }
+
+%}
+#endif
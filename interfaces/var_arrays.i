@@ -13,9 +13,11 @@
 
 template <typename T>
 struct var_array {
-  size_t        length;
-  T             *data;
-  unsigned int  type;
+  size_t                      length;
+  T                           *data;
+  unsigned int                type;
+  const vrna_fold_compound_t  *owner;       /* fold compound the data belongs to, if any */
+  unsigned int                generation;   /* memory generation of owner at creation */
 };
 
 
@@ -104,6 +106,41 @@ var_array_new(size_t        length,
   return a;
 }
 
+
+/* array of data that belongs to fold compound fc, i.e. that is
+   released or replaced by the fold compound at some point
+*/
+template <typename T>
+inline var_array<T> *
+var_array_new_fc(size_t                     length,
+                 T                          *data,
+                 unsigned int               type,
+                 const vrna_fold_compound_t *fc)
+{
+  var_array<T> *a = var_array_new(length, data, type);
+
+  if (a) {
+    a->owner      = fc;
+    a->generation = fc->mem_generation;
+  }
+
+  return a;
+}
+
+
+/* refuse access to data its fold compound has released since
+   the array has been created
+*/
+template <typename T>
+inline void
+var_array_check(const var_array<T> *a)
+{
+  if ((a->owner) &&
+      (a->owner->mem_generation != a->generation))
+    throw std::runtime_error("The memory of this array has been released by its fold_compound, "
+                             "please obtain it from the fold_compound again");
+}
+
 %}
 
 %nodefaultctor var_array;
@@ -182,6 +219,8 @@ struct var_array {};
 /***************************************/
 %extend var_array {
   size_t __len__() const {
+    var_array_check($self);
+
     size_t n = $self->length;
 
     if ($self->type & VAR_ARRAY_ONE_BASED)
@@ -195,7 +234,9 @@ struct var_array {};
     return n;
   }
 
-  const T __getitem__(int i) const throw(std::out_of_range) {
+  const T __getitem__(int i) const throw(std::out_of_range, std::runtime_error) {
+    var_array_check($self);
+
     size_t max_i = $self->length;
 
     if ($self->type & VAR_ARRAY_ONE_BASED)
@@ -213,7 +254,9 @@ struct var_array {};
     return $self->data[i];
   }
 
-  const T __setitem__(int i, const T d) const throw(std::out_of_range) {
+  const T __setitem__(int i, const T d) const throw(std::out_of_range, std::runtime_error) {
+    var_array_check($self);
+
     size_t max_i = $self->length;
 
     if ($self->type & VAR_ARRAY_ONE_BASED)
@@ -238,6 +281,8 @@ struct var_array {};
   std::string
   __str__()
   {
+    var_array_check($self);
+
     size_t n = $self->length;
 
     if ($self->type & VAR_ARRAY_ONE_BASED)
@@ -21,7 +21,7 @@ PRIVATE void usage(void);
 int main(int argc, char *argv[])
 {
    int     i,j;
-   float **dm;
+   PackedDist *dm;
    Split  *S;
    Union  *U;
    char    type[5];
@@ -25,14 +25,14 @@ PRIVATE void usage(void);
 
 int main(int argc, char *argv[])
 {
-   int      n,i,j,l;
+   int      n,i,j,l,jobs;
    int      intty;
    int      outtty;
    char    *mask, junk[20];
    char   **s;
    char   **ss[4];
    float   *B;
-   float  **dm;
+   PackedDist *dm;
    Split   *S;
    Union   *U;
    char     DistAlgorithm='H';
@@ -71,6 +71,12 @@ int main(int argc, char *argv[])
           case 'Q': 
              Do_4_Stg = 1;
              break;
+          case 'j':                /* threads for the distance matrix */
+             jobs = 0;
+             if(argv[i][2]!='\0')
+                if(sscanf(argv[i]+2,"%d",&jobs)!=1 || jobs<0) usage();
+             Set_DistMatrix_Jobs(jobs);
+             break;
           case 'M':
              if(mask) { free(mask); mask = NULL; }
              switch (argv[i][2] ) {
@@ -295,6 +301,6 @@ int main(int argc, char *argv[])
 PRIVATE void usage(void)
 {
    vrna_message_error("usage: AnalyseSeqs [-X[bswnm]] [-Q] [-M{mask}] \n"
-   "                   [-D{H|A[,cost]|G[,cost1,cost2]}] [-d{D|B|H|S}]");
+   "                   [-D{H|A[,cost]|G[,cost1,cost2]}] [-d{D|B|H|S}] [-j[num]]");
    exit(0);
 }
@@ -12,6 +12,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "ViennaRNA/utils/basic.h"
+#include "distance_matrix.h"
 
 #define PUBLIC
 #define PRIVATE static
@@ -33,16 +34,16 @@ typedef struct {
                  int  leftmostleaf;                 
                } Postorder_list;
 
-PUBLIC Union *wards_cluster(float **clmat);
-PUBLIC Union *neighbour_joining(float **clmat);
+PUBLIC Union *wards_cluster(PackedDist *clmat);
+PUBLIC Union *neighbour_joining(PackedDist *clmat);
 PUBLIC void   printf_phylogeny(Union *tree, char *type);
        
 
 /*--------------------------------------------------------------------*/
 
-PUBLIC Union *wards_cluster(float **clmat)
+PUBLIC Union *wards_cluster(PackedDist *clmat)
 {
-   float  **d;
+   PackedDist d;
    int      *indic;
    int      *size;
    float    *help;
@@ -51,12 +52,11 @@ PUBLIC Union *wards_cluster(float **clmat)
    float    min,deno,xa,xb,x;
    int      i,j,step,s=0,t=0,n;
 
-   n= (int)(clmat[0][0]);
+   n= clmat->n;
 
    size  = (int *)     vrna_alloc((n+1)*sizeof(int));
-   d     = (float **)  vrna_alloc((n+1)*sizeof(float *));
-   for(i=0;i<=n;i++)
-      d[i] = (float *) vrna_alloc((n+1)*sizeof(float));
+   d.n   = n;
+   d.d   = (float *)   vrna_alloc((PD_SIZE(n)+1)*sizeof(float));
    indic = (int *)     vrna_alloc((n+1)*sizeof(int));
    help  = (float *)   vrna_alloc((n+1)*sizeof(float));
    tree  = (Union *)   vrna_alloc((n+1)*sizeof(Union));
@@ -67,25 +67,20 @@ PUBLIC Union *wards_cluster(float **clmat)
    tree[0].distance2 = 0.0;    
 
    for (i=1;i<=n;i++) size[i]=1;
-   for (i=1; i<=n; i++){
-      for(j=1; j<=n; j++){
-         d[i][j] = clmat[i][j];
-      }
-   }
+   memcpy(d.d, clmat->d, PD_SIZE(n)*sizeof(float));
 
-   /* look for the indices [s,t]  with minimum  d[s][t]*/
+   /* look for the indices [s,t]  with minimum  d[s][t],
+      the first one is always found with s<t */
    for(step=1;step<n; step++){
       min = INFINITY;
       for (i=1; i<=n; i++){
          if (indic[i]==0){
-            for (j=1; j<=n; j++){
-               if(j!=i){
-                  if (indic[j]==0){
-                     if(d[i][j] < min) {
-                        min = d[i][j];
-                        s = i;
-                        t = j;
-                     }
+            for (j=i+1; j<=n; j++){
+               if (indic[j]==0){
+                  if(d.d[PD_INDEX(j,i)] < min) {
+                     min = d.d[PD_INDEX(j,i)];
+                     s = i;
+                     t = j;
                   }
                }
             }
@@ -105,22 +100,19 @@ PUBLIC Union *wards_cluster(float **clmat)
             xa = ((float) (size[i]+size[s]))/deno; 
             xb = ((float) (size[i]+size[t]))/deno;
              x = ((float) size[i])/deno;
-            help[i] = xa*d[i][s] + xb*d[i][t] - x*d[s][t];
+            help[i] = xa*pd_get(&d,i,s) + xb*pd_get(&d,i,t) - x*pd_get(&d,s,t);
          }
       }
       for (i=1; i<=n; i++){
-         if (indic[i]==0){
-            d[s][i] = help[i];
-            d[i][s] = help[i];
-         }
+         if (indic[i]==0)
+            pd_set(&d,s,i,help[i]);
       }
       size[s] += size[t];
    }
 
    free(help);
    free(indic);
-   for(i=0;i<=n;i++) free(d[i]);
-   free(d);
+   free(d.d);
    free(size);
  
    return tree;
@@ -128,32 +120,27 @@ PUBLIC Union *wards_cluster(float **clmat)
 
 /*--------------------------------------------------------------------*/
 
-PUBLIC Union *neighbour_joining(float **clmat)
+PUBLIC Union *neighbour_joining(PackedDist *clmat)
 {            
   int n,i,j,k,l,step,ll[3];
-  float b1,b2,b3,nn,tot,tmin,d1,d2;
+  float b1,b2,b3,nn,tot,tmin,d1,d2,dij;
   int mini=0, minj=0;
   int    *indic;
-  float  *av, *temp;
-  float **d;
+  float  *av, *temp, *sum;
+  PackedDist d;
   Union   *tree;
 
-  n = (int) (clmat[0][0]);
+  n = clmat->n;
 
   tree = (Union *) vrna_alloc((n+1)*sizeof(Union));
   indic = (int   *) vrna_alloc((n+1)*sizeof(int)   );
   av   = (float *) vrna_alloc((n+1)*sizeof(float) );
   temp = (float *) vrna_alloc((n+1)*sizeof(float) );
-  d    = (float**) vrna_alloc((n+1)*sizeof(float*));
-  for(i=0;i<=n;i++) d[i] = (float*) vrna_alloc((n+1)*sizeof(float));
-
+  sum  = (float *) vrna_alloc((n+1)*sizeof(float) );
+  d.n  = n;
+  d.d  = (float *) vrna_alloc((PD_SIZE(n)+1)*sizeof(float));
 
-  for (i=1; i<=n; i++){
-     for(j=1; j<=n; j++){
-        d[i][j] = clmat[i][j];
-     }
-     d[i][i]=0.0;
-  }
+  memcpy(d.d, clmat->d, PD_SIZE(n)*sizeof(float));
 
   tree[0].set1      = n;
   tree[0].set2      = 0;
@@ -163,18 +150,20 @@ PUBLIC Union *neighbour_joining(float **clmat)
   nn = (float) n;
 
   for(step=1;step<=n-3;step++) {
-/*    for(j=2;j<=n;j++) for(i=1;i<j;i++) d[j][i]=d[i][j]; */
+     /* column sums, the same for all pairs (k,l) of this step */
+     for(k=1; k<=n; k++) {
+        if(!indic[k]) {
+           d1=0.0;
+           for(i=1; i<=n;i++) d1 += pd_get(&d,i,k);
+           sum[k] = d1;
+        }
+     }
      tmin=99999.9;
      for(l=2; l<=n; l++){
         if(!indic[l]) {
            for(k=1;k<l;k++){                          
               if(!indic[k]) {                                       
-                 d1=0.0; d2=0.0;
-                 for(i=1; i<=n;i++) {
-                    d1 += d[i][k];
-                    d2 += d[i][l];
-                 }
-                 tot=(nn-2.0)*d[k][l]-d1-d2;
+                 tot=(nn-2.0)*d.d[PD_INDEX(l,k)]-sum[k]-sum[l];
                  if(tot<tmin){
                     tmin=tot;
                     mini=k;
@@ -185,38 +174,29 @@ PUBLIC Union *neighbour_joining(float **clmat)
         }
      }
 
-     d1=0.0; d2=0.0;                                                                
-     for(i=1;i<=n;i++) {
-        d1 +=d[i][mini];
-        d2 +=d[i][minj];
-     }
-     d1 = (d1-d[mini][minj])/(nn-2.0);
-     d2 = (d2-d[mini][minj])/(nn-2.0);
+     dij = pd_get(&d,mini,minj);
+     d1 = (sum[mini]-dij)/(nn-2.0);
+     d2 = (sum[minj]-dij)/(nn-2.0);
 
      tree[step].set1      = mini;
-     tree[step].distance  = (d[mini][minj]+d1-d2)*0.5-av[mini];
+     tree[step].distance  = (dij+d1-d2)*0.5-av[mini];
      tree[step].set2      = minj; 
-     tree[step].distance2 = d[mini][minj]-(d[mini][minj]+d1-d2)*0.5-av[minj];
+     tree[step].distance2 = dij-(dij+d1-d2)*0.5-av[minj];
 
-     av[mini]=d[mini][minj]*0.5;
+     av[mini]=dij*0.5;
 
      nn=nn-1.0;
      indic[minj]=1;
      for(j=1;j<=n;j++) { 
         if(!indic[j]) 
-           temp[j]=(d[mini][j]+d[minj][j])*0.5;
+           temp[j]=(pd_get(&d,mini,j)+pd_get(&d,minj,j))*0.5;
      }
      for(j=1;j<=n;j++) {
-        if(!indic[j]) {
-           d[mini][j] = temp[j];
-           d[j][mini] = temp[j];
-        }
+        if(!indic[j])
+           pd_set(&d,mini,j,temp[j]);
      }                               
-     for(j=1;j<=n;j++){
-         d[minj][j] = 0.0;
-         d[j][minj] = 0.0;
-         d[j][j]    = 0.0;
-     }
+     for(j=1;j<=n;j++)
+         pd_set(&d,minj,j,0.0);
   }  
                                             
   j=0;   
@@ -226,9 +206,9 @@ PUBLIC Union *neighbour_joining(float **clmat)
         j++;
      }
   }          
-  b1=(d[ll[0]][ll[1]]+d[ll[0]][ll[2]]-d[ll[1]][ll[2]])*0.5;
-  b2=d[ll[0]][ll[1]]-b1;
-  b3=d[ll[0]][ll[2]]-b1;
+  b1=(pd_get(&d,ll[0],ll[1])+pd_get(&d,ll[0],ll[2])-pd_get(&d,ll[1],ll[2]))*0.5;
+  b2=pd_get(&d,ll[0],ll[1])-b1;
+  b3=pd_get(&d,ll[0],ll[2])-b1;
   b1 -= av[ll[0]];
   b2 -= av[ll[1]];
   b3 -= av[ll[2]];
@@ -242,7 +222,8 @@ PUBLIC Union *neighbour_joining(float **clmat)
   tree[step].set2      = ll[1];
   tree[step].distance2 = b1;
 
-  for(i=0;i<=n;i++) free(d[i]); free(d); 
+  free(d.d);
+  free(sum);
   free(temp);
   free(av);
   free(indic);
@@ -1,3 +1,5 @@
+#include "distance_matrix.h"
+
 typedef struct{
         int   set1;
         int   set2;
@@ -5,8 +7,8 @@ typedef struct{
         float distance2;
         } Union;
 
-extern Union *wards_cluster(float **clmat);
-extern Union *neighbour_joining(float **clmat);
+extern Union *wards_cluster(PackedDist *clmat);
+extern Union *neighbour_joining(PackedDist *clmat);
 extern void   printf_phylogeny(Union *tree, char *type);
 
 
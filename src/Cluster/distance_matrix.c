@@ -7,34 +7,48 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/io/utils.h"
 #include "StrEdit_CostMatrix.h"
+#include "distance_matrix.h"
 
 #define  PUBLIC
 #define  PRIVATE         static
 #define  MAXSEQS         1000
+#define  DM_BLOCK        64     /* taxa per tile when filling a distance matrix */
 
-PUBLIC   float **read_distance_matrix(char type[]);
+PUBLIC   PackedDist *read_distance_matrix(char type[]);
 PUBLIC   char  **read_sequence_list(int *n_of_seqs, char *mask);
-PUBLIC   float **Hamming_Distance_Matrix(char **seqs, int n_of_seqs);
-PUBLIC   float **StrEdit_SimpleDistMatrix(char **seqs, int n_of_seqs);
-PUBLIC   float **StrEdit_GotohDistMatrix(char **seqs, int n_of_seqs);
-PUBLIC   void    free_distance_matrix(float **x);
-PUBLIC   void    printf_distance_matrix(float **x);
+PUBLIC   PackedDist *Hamming_Distance_Matrix(char **seqs, int n_of_seqs);
+PUBLIC   PackedDist *StrEdit_SimpleDistMatrix(char **seqs, int n_of_seqs);
+PUBLIC   PackedDist *StrEdit_GotohDistMatrix(char **seqs, int n_of_seqs);
+PUBLIC   void    free_distance_matrix(PackedDist *x);
+PUBLIC   void    printf_distance_matrix(PackedDist *x);
 PUBLIC   void    printf_taxa_list(void);
 PUBLIC   char   *get_taxon_label(int whoami);
 PUBLIC   float   StrEdit_SimpleDist(char *str1, char *str2);
 PUBLIC   float   StrEdit_GotohDist(char *str1, char *str2);
 PUBLIC   void    Set_StrEdit_CostMatrix(char type);
 PUBLIC   void    Set_StrEdit_GapCosts(float per_digit, float per_gap);
-
-/* NOTE:   x[0][0] = (float)size_of_matrix;    */
+PUBLIC   void    Set_DistMatrix_Jobs(int jobs);
 
 PRIVATE  void    read_taxa_list(void);
 PRIVATE  int     string_consists_of(char line[],char *mask);
 PRIVATE  float   StrEditCost( int i, int j, char *T1, char *T2);
 PRIVATE  int     decode(char id);
+PRIVATE  PackedDist *new_distance_matrix(int n);
+PRIVATE  void    fill_distance_matrix(PackedDist *D, float (*dist)(int, int, void *), void *data);
+PRIVATE  float   hamming_pair(int i, int j, void *data);
+PRIVATE  float   simple_pair(int i, int j, void *data);
+PRIVATE  float   gotoh_pair(int i, int j, void *data);
+
+typedef struct {
+        unsigned char *codes;   /* decoded sequences, len characters each */
+        int            len;
+        } Hamming_Data;
 
 PRIVATE  char    Taxa_List[MAXSEQS][50];
 PRIVATE  int     Taxa_Numbers[MAXSEQS];
@@ -46,13 +60,14 @@ PRIVATE  char   *StrEdit_ValidAlphabet;
 PRIVATE  float   StrEdit_GapCost   = 1.;
 PRIVATE  float   StrEdit_GotohAlpha = 1.;
 PRIVATE  float   StrEdit_GotohBeta  = 1.;
+PRIVATE  int     DistMatrix_Jobs    = 0;   /* 0 ... OpenMP default */
 
 
 
-PUBLIC float **read_distance_matrix(char type[])
+PUBLIC PackedDist *read_distance_matrix(char type[])
 {
    char   *line;
-   float **D;
+   PackedDist *D;
    float   tmp;
    int     i,j,size;
    
@@ -82,21 +97,14 @@ PUBLIC float **read_distance_matrix(char type[])
        fprintf(stderr, "%d ", r);
        if (r==EOF) return NULL;
        if((r==2)&&(size>1)) {
-	 D=(float **)vrna_alloc((size+1)*sizeof(float *));
-	 for(i=0; i<=size; i++)
-	   D[i] = (float *)vrna_alloc((size+1)*sizeof(float));
-	 D[0][0] = (float)size;
-	 D[1][1] = 0.0;
+	 D = new_distance_matrix(size);
 	 for(i=2; i<= size; i++) {
-	   D[i][i] = 0.0;
 	   for(j=1; j<i; j++) {
 	     if (scanf("%f", &tmp)!=1) {
-	       for(i=0;i<=size;i++) free(D[i]);
-	       free(D);
+	       free_distance_matrix(D);
 	       return NULL;
 	     }
-	     D[i][j] = tmp;
-	     D[j][i] = tmp;
+	     D->d[PD_INDEX(i,j)] = tmp;
 	   }
 	 }
 	 return D;
@@ -112,13 +120,13 @@ PUBLIC float **read_distance_matrix(char type[])
 
 PUBLIC char **read_sequence_list(int *n_of_seqs, char *mask)
 {
-   int     i;
    char   *line;
-   char   *tt[MAXSEQS];
    char  **sl;
-   int     len;
+   int     i, len, size;
    
    (*n_of_seqs) = 0;
+   size = 0;
+   sl   = NULL;
    while(1) {
       if ((line = vrna_read_line(stdin))==NULL) break;
       
@@ -159,19 +167,22 @@ PUBLIC char **read_sequence_list(int *n_of_seqs, char *mask)
 		   }
 	       }
 	    }
-	    tt[*n_of_seqs] = (char *)vrna_alloc((len+1)*sizeof(char));
-	    sscanf(line,"%s",tt[*n_of_seqs]);
+	    if(*n_of_seqs == size) {
+	       size = (size) ? 2*size : MAXSEQS;
+	       sl   = (char **) vrna_realloc(sl, size*sizeof(char *));
+	    }
+	    sl[*n_of_seqs] = (char *)vrna_alloc((len+1)*sizeof(char));
+	    sscanf(line,"%s",sl[*n_of_seqs]);
 	    (*n_of_seqs)++;
 	 }
       }
       free(line);
    }
-   if(*n_of_seqs == 0) return NULL;
-   else {
-     sl = (char **) vrna_alloc((*n_of_seqs)*sizeof(char *));
-     for(i=0;i<*n_of_seqs; i++) sl[i] = tt[i]; 
-     return sl;
+   if(*n_of_seqs == 0) {
+     free(sl);
+     return NULL;
    }
+   return sl;
 }
 
 /* -------------------------------------------------------------------------- */
@@ -191,25 +202,24 @@ PRIVATE int string_consists_of(char *line, char *mask)
 }
 /* -------------------------------------------------------------------------- */
 
-PUBLIC void free_distance_matrix(float **x)
+PUBLIC void free_distance_matrix(PackedDist *x)
 {
-   int i,n;
-   n=(int) x[0][0];
-   for(i=0;i<=n;i++) free(x[i]);
+   free(x->d);
    free(x);
-   x=NULL;
 }
 
 /* -------------------------------------------------------------------------- */
 
-PUBLIC void printf_distance_matrix(float **x)
+PUBLIC void printf_distance_matrix(PackedDist *x)
 {
-   int i,j,n;
-   n=(int) x[0][0];
+   int     i,j,n;
+   float  *d;
+   n = x->n;
+   d = x->d;
    printf("> X  %d\n",n);
    if(n>1){
       for(i=2;i<=n;i++) {
-         for(j=1;j<i;j++) printf("%g ",x[i][j]);
+         for(j=1;j<i;j++) printf("%g ",*d++);
          printf("\n");
       }
    }
@@ -217,72 +227,131 @@ PUBLIC void printf_distance_matrix(float **x)
 
 /* -------------------------------------------------------------------------- */
 
-PUBLIC float **Hamming_Distance_Matrix(char **seqs, int n_of_seqs)
+PRIVATE PackedDist *new_distance_matrix(int n)
 {
-   int i,j,k;
-   float **D;
-   D = (float **) vrna_alloc((n_of_seqs+1)*sizeof(float *));
-   for(i=0;i<=n_of_seqs;i++)
-      D[i] = (float *) vrna_alloc((n_of_seqs+1)*sizeof(float));
-   D[0][0] = (float) n_of_seqs;
-   
-   for(i=1; i<n_of_seqs; i++) {
-      D[i][i] = 0.;
-      for(j=0;j<i;j++){
-         if(strlen(seqs[i])!=strlen(seqs[j])) 
-            vrna_message_error("Unequal Seqence Length for Hamming Distance.");
-         D[i+1][j+1] = 0.0;
-         for(k=0;k<strlen(seqs[i]);k++)
-            D[i+1][j+1] += StrEditCost(k+1,k+1,seqs[i],seqs[j]);
-	 /* was :  (float)(seqs[i][k]!=seqs[j][k]); */
-         D[j+1][i+1] = D[i+1][j+1];
-      }
-      D[n_of_seqs][n_of_seqs] = 0.;
-   }
+   PackedDist *D;
+   D    = (PackedDist *) vrna_alloc(sizeof(PackedDist));
+   D->n = n;
+   D->d = (float *) vrna_alloc((PD_SIZE(n)+1)*sizeof(float));
    return D;
 }
 
 /* -------------------------------------------------------------------------- */
 
-PUBLIC float **StrEdit_SimpleDistMatrix(char **seqs, int n_of_seqs)
+/* Fill D with dist(i,j,data) for all pairs of taxa (0-based). The matrix is
+   cut into DM_BLOCK x DM_BLOCK tiles, such that the sequences of a tile stay
+   in cache, and the tiles are distributed over the threads. */
+PRIVATE void fill_distance_matrix(PackedDist *D, float (*dist)(int, int, void *), void *data)
 {
-   int i,j;
-   float **D;
-   D = (float **) vrna_alloc((n_of_seqs+1)*sizeof(float *));
-   for(i=0;i<=n_of_seqs;i++)
-      D[i] = (float *) vrna_alloc((n_of_seqs+1)*sizeof(float));
-   D[0][0] = (float) n_of_seqs;
-   
-   for(i=1; i<n_of_seqs; i++) {
-      D[i][i] = 0.;
-      for(j=0;j<i;j++){
-         D[i+1][j+1] = StrEdit_SimpleDist(seqs[i],seqs[j]);
-         D[j+1][i+1] = D[i+1][j+1];
+   int   n, nb, n_tiles, bi, bj, t;
+   int  *tiles;
+
+   n       = D->n;
+   nb      = (n+DM_BLOCK-1)/DM_BLOCK;
+   n_tiles = nb*(nb+1)/2;
+   tiles   = (int *) vrna_alloc((2*n_tiles+1)*sizeof(int));
+   for(t=0, bi=0; bi<nb; bi++)
+      for(bj=0; bj<=bi; bj++, t++) {
+         tiles[2*t]   = bi;
+         tiles[2*t+1] = bj;
+      }
+
+#ifdef _OPENMP
+   int jobs = (DistMatrix_Jobs > 0) ? DistMatrix_Jobs : omp_get_max_threads();
+#pragma omp parallel for schedule(dynamic) num_threads(jobs)
+#endif
+   for(t=0; t<n_tiles; t++) {
+      int    i, j, i_max, j_max;
+      float *row;
+      i_max = MIN2(n, (tiles[2*t]+1)*DM_BLOCK);
+      for(i=tiles[2*t]*DM_BLOCK; i<i_max; i++) {
+         row   = D->d + PD_INDEX(i+1,1);
+         j_max = MIN2(i, (tiles[2*t+1]+1)*DM_BLOCK);
+         for(j=tiles[2*t+1]*DM_BLOCK; j<j_max; j++)
+            row[j] = dist(i, j, data);
       }
-      D[n_of_seqs][n_of_seqs] = 0.;
    }
-   return D;
+
+   free(tiles);
 }
 
 /* -------------------------------------------------------------------------- */
 
-PUBLIC float **StrEdit_GotohDistMatrix(char **seqs, int n_of_seqs)
+PRIVATE float hamming_pair(int i, int j, void *data)
 {
-   int i,j;
-   float **D;
-   D = (float **) vrna_alloc((n_of_seqs+1)*sizeof(float *));
-   for(i=0;i<=n_of_seqs;i++)
-      D[i] = (float *) vrna_alloc((n_of_seqs+1)*sizeof(float));
-   D[0][0] = (float) n_of_seqs;
-   
-   for(i=1; i<n_of_seqs; i++) {
-      D[i][i] = 0.;
-      for(j=0;j<i;j++){
-         D[i+1][j+1] = StrEdit_GotohDist(seqs[i],seqs[j]);
-         D[j+1][i+1] = D[i+1][j+1];
-      }
-      D[n_of_seqs][n_of_seqs] = 0.;
+   Hamming_Data        *h = (Hamming_Data *) data;
+   const unsigned char *a, *b;
+   int                  k, len;
+
+   len = h->len;
+   a   = h->codes + (size_t)i*len;
+   b   = h->codes + (size_t)j*len;
+   if(StrEdit_CostMatrix==NULL) {
+      int mm = 0;
+#pragma omp simd reduction(+:mm)
+      for(k=0;k<len;k++) mm += (a[k]!=b[k]);
+      return (float) mm;
+   }
+   else {
+      float d = 0.;
+      for(k=0;k<len;k++) d += StrEdit_CostMatrix[a[k]][b[k]];
+      return d;
+   }
+}
+
+PRIVATE float simple_pair(int i, int j, void *data)
+{
+   char **seqs = (char **) data;
+   return StrEdit_SimpleDist(seqs[i],seqs[j]);
+}
+
+PRIVATE float gotoh_pair(int i, int j, void *data)
+{
+   char **seqs = (char **) data;
+   return StrEdit_GotohDist(seqs[i],seqs[j]);
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC PackedDist *Hamming_Distance_Matrix(char **seqs, int n_of_seqs)
+{
+   int          i,k;
+   PackedDist  *D;
+   Hamming_Data h;
+
+   /* decode every sequence only once, the pairs just compare the codes */
+   h.len   = (n_of_seqs>0) ? strlen(seqs[0]) : 0;
+   h.codes = (unsigned char *) vrna_alloc((size_t)n_of_seqs*h.len+1);
+   for(i=0; i<n_of_seqs; i++) {
+      if(strlen(seqs[i])!=h.len)
+         vrna_message_error("Unequal Seqence Length for Hamming Distance.");
+      for(k=0;k<h.len;k++)
+         h.codes[(size_t)i*h.len+k] = (unsigned char) decode(seqs[i][k]);
    }
+
+   D = new_distance_matrix(n_of_seqs);
+   fill_distance_matrix(D, &hamming_pair, (void *) &h);
+   free(h.codes);
+   return D;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC PackedDist *StrEdit_SimpleDistMatrix(char **seqs, int n_of_seqs)
+{
+   PackedDist *D;
+   D = new_distance_matrix(n_of_seqs);
+   fill_distance_matrix(D, &simple_pair, (void *) seqs);
+   return D;
+}
+
+/* -------------------------------------------------------------------------- */
+
+PUBLIC PackedDist *StrEdit_GotohDistMatrix(char **seqs, int n_of_seqs)
+{
+   PackedDist *D;
+   D = new_distance_matrix(n_of_seqs);
+   fill_distance_matrix(D, &gotoh_pair, (void *) seqs);
    return D;
 }
 
@@ -368,7 +437,7 @@ PUBLIC char *get_taxon_label(int whoami)
 PUBLIC float StrEdit_SimpleDist(char *str1, char *str2 )
 
 {
-   float  **distance;
+   float        *prev, *cur, *tmp;
 
    int           i, j, length1,length2;
    float         minus, plus, change, temp;
@@ -376,27 +445,27 @@ PUBLIC float StrEdit_SimpleDist(char *str1, char *str2 )
    length1 = strlen(str1);
    length2 = strlen(str2);
 
-   distance = (float **)  vrna_alloc((length1 +1)*sizeof(float *));
-   for(i=0; i<= length1; i++)
-      distance[i] = (float *) vrna_alloc( (length2+1)*sizeof(float));
+   /* only two rows of the dp matrix are kept */
+   prev = (float *) vrna_alloc((length2+1)*sizeof(float));
+   cur  = (float *) vrna_alloc((length2+1)*sizeof(float));
 
-   for(i = 1; i <= length1; i++) 
-      distance[i][0] = distance[i-1][0]+StrEditCost(i,0,str1,str2);
    for(j = 1; j <= length2; j++) 
-      distance[0][j] = distance[0][j-1]+StrEditCost(0,j,str1,str2);
+      prev[j] = prev[j-1]+StrEditCost(0,j,str1,str2);
     
    for (i = 1; i <= length1; i++) {
+      cur[0] = prev[0]+StrEditCost(i,0,str1,str2);
       for (j = 1; j <= length2 ; j++) {
-         minus  = distance[i-1][j]  + StrEditCost(i,0,str1,str2);
-         plus   = distance[i][j-1]  + StrEditCost(0,j,str1,str2);
-         change = distance[i-1][j-1]+ StrEditCost(i,j,str1,str2);
+         minus  = prev[j]   + StrEditCost(i,0,str1,str2);
+         plus   = cur[j-1]  + StrEditCost(0,j,str1,str2);
+         change = prev[j-1]+ StrEditCost(i,j,str1,str2);
             
-         distance[i][j] = MIN3(minus, plus, change);  
+         cur[j] = MIN3(minus, plus, change);  
       } 
+      tmp = prev; prev = cur; cur = tmp;
    }
-   temp = distance[length1][length2];
-   for(i=0;i<=length1;i++) free(distance[i]);
-   free(distance);
+   temp = prev[length2];
+   free(prev);
+   free(cur);
 
    return temp;
 }
@@ -405,49 +474,41 @@ PUBLIC float StrEdit_SimpleDist(char *str1, char *str2 )
 
 PUBLIC float StrEdit_GotohDist(char *str1, char *str2 )
 {
-   float  **D;
-   float  **E;
-   float  **F;
+   float   *D, *D1, *F, *tmp;
+   float    E, d;
    int      i, j, length1,length2;
    float    temp;
     
    length1 = strlen(str1);
    length2 = strlen(str2);
-  
-   D = vrna_alloc((length1+1)*sizeof(float *));
-   for(i=0;i<=length1;i++) D[i] = vrna_alloc((length2+1)*sizeof(float));
-   E = vrna_alloc((length1+1)*sizeof(float *));
-   for(i=0;i<=length1;i++) E[i] = vrna_alloc((length2+1)*sizeof(float));
-   F = vrna_alloc((length1+1)*sizeof(float *));
-   for(i=0;i<=length1;i++) F[i] = vrna_alloc((length2+1)*sizeof(float));
-
-   D[0][0] = 0.; E[0][0] = 0.; F[0][0] = 0.;
-   
-   for(i=1;i<=length1;i++) {
-      D[i][0] = StrEdit_GotohAlpha + StrEdit_GotohBeta*((float)(i-1));
-      E[i][0] = StrEdit_GotohAlpha + StrEdit_GotohBeta*((float)(i-1));
-      F[i][0] = 0.;
-   }
+
+   /* rows i-1 (D1) and i (D) of D, row i of F (updated in place),
+      the current entry of E */
+   D  = vrna_alloc((length2+1)*sizeof(float));
+   D1 = vrna_alloc((length2+1)*sizeof(float));
+   F  = vrna_alloc((length2+1)*sizeof(float));
+
+   D1[0] = 0.; F[0] = 0.;
    for(j=1;j<=length2;j++) {
-      D[0][j] = StrEdit_GotohAlpha + StrEdit_GotohBeta*((float)(j-1));
-      E[0][j] = 0.;
-      F[0][j] = StrEdit_GotohAlpha + StrEdit_GotohBeta*((float)(j-1));
+      D1[j] = StrEdit_GotohAlpha + StrEdit_GotohBeta*((float)(j-1));
+      F[j]  = StrEdit_GotohAlpha + StrEdit_GotohBeta*((float)(j-1));
    }
    for(i=1;i<=length1;i++) {
+      D[0] = StrEdit_GotohAlpha + StrEdit_GotohBeta*((float)(i-1));
+      E    = StrEdit_GotohAlpha + StrEdit_GotohBeta*((float)(i-1));
+      F[0] = 0.;
       for(j=1;j<=length2;j++) {
-         E[i][j] = MIN2(  (D[i][j-1]+StrEdit_GotohAlpha), 
-                         (E[i][j-1]+StrEdit_GotohBeta)  );
-         F[i][j] = MIN2(  (D[i-1][j]+StrEdit_GotohAlpha),
-                         (F[i-1][j]+StrEdit_GotohBeta)  );
-         D[i][j] = MIN3(  E[i][j], F[i][j], 
-                         (D[i-1][j-1]+StrEditCost(i,j,str1,str2)) );
+         E    = MIN2(  (D[j-1]+StrEdit_GotohAlpha), 
+                       (E+StrEdit_GotohBeta)  );
+         F[j] = MIN2(  (D1[j]+StrEdit_GotohAlpha),
+                       (F[j]+StrEdit_GotohBeta)  );
+         d    = D1[j-1]+StrEditCost(i,j,str1,str2);
+         D[j] = MIN3(  E, F[j], d );
       }
+      tmp = D1; D1 = D; D = tmp;
    }
-   temp = D[length1][length2];
-   for(i=0;i<=length1;i++) {
-      free(D[i]); free(E[i]); free(F[i]);
-   }
-   free(D); free(E); free(F);
+   temp = D1[length2];
+   free(D); free(D1); free(F);
    
    return temp;
 }
@@ -559,6 +620,13 @@ PUBLIC void  Set_StrEdit_CostMatrix(char type)
 
 /* -------------------------------------------------------------------------- */
 
+PUBLIC   void    Set_DistMatrix_Jobs(int jobs)
+{
+   DistMatrix_Jobs = (jobs > 0) ? jobs : 0;
+}
+
+/* -------------------------------------------------------------------------- */
+
 PUBLIC   void    Set_StrEdit_GapCosts(float per_digit, float per_gap)
 {
    if(per_gap==0.) per_gap = per_digit;
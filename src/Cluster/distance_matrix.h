@@ -1,14 +1,45 @@
-extern   float **read_distance_matrix(char type[]);
+#ifndef DISTANCE_MATRIX_H
+#define DISTANCE_MATRIX_H
+
+#include <stddef.h>
+
+/* distances of n taxa, the strict lower triangle d(i,j), 1 <= j < i <= n,
+   is stored row by row in d (the order of the "> X n" file format) */
+typedef struct {
+        int    n;
+        float *d;
+        } PackedDist;
+
+#define  PD_SIZE(n)      (((size_t)(n)*((n)-1))/2)
+#define  PD_INDEX(i,j)   ((((size_t)((i)-1))*((i)-2))/2 + (size_t)((j)-1))
+
+/* d(i,j) for any 1 <= i,j <= n, the diagonal is 0 */
+static inline float pd_get(const PackedDist *D, int i, int j)
+{
+   if(i==j) return 0.;
+   return (i>j) ? D->d[PD_INDEX(i,j)] : D->d[PD_INDEX(j,i)];
+}
+
+/* set d(i,j) = d(j,i) = x, the diagonal is left alone */
+static inline void pd_set(PackedDist *D, int i, int j, float x)
+{
+   if(i>j)      D->d[PD_INDEX(i,j)] = x;
+   else if(i<j) D->d[PD_INDEX(j,i)] = x;
+}
+
+extern   PackedDist *read_distance_matrix(char type[]);
 extern   char  **read_sequence_list(int *n_of_seqs,char *mask);
-extern   float **Hamming_Distance_Matrix(char **seqs, int n_of_seqs);
-extern   float **StrEdit_SimpleDistMatrix(char **seqs, int n_of_seqs);
-extern   float **StrEdit_GotohDistMatrix(char **seqs, int n_of_seqs);
+extern   PackedDist *Hamming_Distance_Matrix(char **seqs, int n_of_seqs);
+extern   PackedDist *StrEdit_SimpleDistMatrix(char **seqs, int n_of_seqs);
+extern   PackedDist *StrEdit_GotohDistMatrix(char **seqs, int n_of_seqs);
 extern   char   *get_taxon_label(int whoami);
-extern   void    free_distance_matrix(float **x);
-extern   void    printf_distance_matrix(float **x);
+extern   void    free_distance_matrix(PackedDist *x);
+extern   void    printf_distance_matrix(PackedDist *x);
 extern   void    printf_taxa_list(void);
 extern   float   StrEdit_SimpleDist(char *str1, char *str2);
 extern   float   StrEdit_GotohDist(char *str1, char *str2);
 extern   void    Set_StrEdit_CostMatrix(char type);
 extern   void    Set_StrEdit_GapCosts(float per_digit, float per_gap);
+extern   void    Set_DistMatrix_Jobs(int jobs);
 
+#endif
@@ -13,6 +13,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include "ViennaRNA/utils/basic.h"
+#include "distance_matrix.h"
 
 #define  PUBLIC
 #define  PRIVATE      static
@@ -28,12 +29,12 @@ typedef struct {
    int      splitsize;
    double   isolation_index; } Split;
   
-PUBLIC Split *split_decomposition(float **dist);
+PUBLIC Split *split_decomposition(PackedDist *dist);
 PUBLIC void free_Split(Split *x);
 PUBLIC void print_Split(Split *x);
 PUBLIC void sort_Split(Split *x);
  
-PUBLIC Split *split_decomposition(float **dist)
+PUBLIC Split *split_decomposition(PackedDist *dist)
 {
 
    int      elm, n_of_splits;
@@ -46,7 +47,7 @@ PUBLIC Split *split_decomposition(float **dist)
    Split   *SD, *S;
    int number_of_points;
    
-   number_of_points = (int) dist[0][0];
+   number_of_points = dist->n;
    
    /* Initialize */ 
    elm = 2;
@@ -68,7 +69,7 @@ PUBLIC Split *split_decomposition(float **dist)
    SD[1].splitlist[1]    = (short *) vrna_alloc((number_of_points+1)*sizeof(short));
    SD[1].splitlist[1][1] = 2;
    SD[1].splitsize       = 1;
-   SD[1].isolation_index = dist[1][2];
+   SD[1].isolation_index = dist->d[PD_INDEX(2,1)];
 
 
    /* Iteration */
@@ -96,12 +97,12 @@ PUBLIC Split *split_decomposition(float **dist)
 
 		  /* calculate the value beta = beta(elm,x; y,z) */ 
 
-		  beta = dist[elm][y] + dist[x][z];
-		  tmp  = dist[elm][z] + dist[x][y];
+		  beta = pd_get(dist,elm,y) + pd_get(dist,x,z);
+		  tmp  = pd_get(dist,elm,z) + pd_get(dist,x,y);
 		  if(tmp>beta) beta=tmp;
-		  tmp  = dist[elm][x] + dist[y][z];
+		  tmp  = pd_get(dist,elm,x) + pd_get(dist,y,z);
 		  if(tmp>beta) beta=tmp;
-		  beta -= ( dist[elm][x] + dist[y][z] );
+		  beta -= ( pd_get(dist,elm,x) + pd_get(dist,y,z) );
 
 		  if(beta<alpha) alpha=beta;
 	       }
@@ -143,12 +144,12 @@ PUBLIC Split *split_decomposition(float **dist)
 
 		  /* calculate the value beta = beta(elm,x; y,z) */ 
 
-		  beta = dist[elm][y] + dist[x][z];
-		  tmp  = dist[elm][z] + dist[x][y];
+		  beta = pd_get(dist,elm,y) + pd_get(dist,x,z);
+		  tmp  = pd_get(dist,elm,z) + pd_get(dist,x,y);
 		  if(tmp>beta) beta=tmp;
-		  tmp  = dist[elm][x] + dist[y][z];
+		  tmp  = pd_get(dist,elm,x) + pd_get(dist,y,z);
 		  if(tmp>beta) beta=tmp;
-		  beta -= ( dist[elm][x] + dist[y][z] );
+		  beta -= ( pd_get(dist,elm,x) + pd_get(dist,y,z) );
 
 		  if(beta<alpha) alpha=beta;
 	       }
@@ -179,7 +180,7 @@ PUBLIC Split *split_decomposition(float **dist)
       alpha=DINFTY;
       for(i=1;i<=elm-1;i++){
 	 for(j=1; j<=elm-1;j++){
-	    tmp = dist[elm][i]+dist[elm][j] - dist[i][j];
+	    tmp = pd_get(dist,elm,i)+pd_get(dist,elm,j) - pd_get(dist,i,j);
 	    if( tmp < alpha) alpha = tmp;   
 	 }
       }
@@ -228,7 +229,7 @@ PUBLIC Split *split_decomposition(float **dist)
       n_of_splits = new_sp;
       SD[0].splitsize = n_of_splits;
 #if DEBUG
-      for(test1=0, i=2; i<=elm; i++) for( j=1; j<i; j++) test1+=dist[i][j];
+      for(test1=0, i=2; i<=elm; i++) for( j=1; j<i; j++) test1+=pd_get(dist,i,j);
       for(test2=0, i=1; i<= n_of_splits; i++)
 	 test2 += (elm-SD[i].splitsize)*SD[i].splitsize*SD[i].isolation_index;
       SD[0].isolation_index = (test1 - test2)/test1;
@@ -241,7 +242,7 @@ PUBLIC Split *split_decomposition(float **dist)
       if not already done */
 
    for(test1=0.0, i=2; i<=number_of_points; i++) 
-      for( j=1; j<i; j++) test1+=dist[i][j];
+      for( j=1; j<i; j++) test1+=pd_get(dist,i,j);
    for(test2=0.0, i=1; i<= n_of_splits; i++) 
       test2 += (number_of_points-SD[i].splitsize)*
 	 SD[i].splitsize*SD[i].isolation_index;
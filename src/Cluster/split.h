@@ -1,9 +1,11 @@
+#include "distance_matrix.h"
+
 typedef struct {
         int   *split_list[2];
         int    split_size;
         double   isolation_index; } Split;
 
-extern Split   *split_decomposition(float **dist);
+extern Split   *split_decomposition(PackedDist *dist);
 extern void     free_Split(Split *x);
 extern void     sort_Split(Split *x);
 extern void     print_Split(Split *x);
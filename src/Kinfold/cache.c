@@ -29,116 +29,294 @@
 /*
   modify cache_f(), cache_comp() and the typedef of cache_entry
   in cache_utils.h to suit your application
+
+  The cache is a chained hash table that doubles its number of
+  buckets whenever the load factor exceeds 1. Structures are stored
+  in the 5:1 base-3 packed format of vrna_db_pack(). Memory used by
+  the entries is bounded by the budget passed to initialize_cache();
+  once the budget is exhausted, entries are evicted following the
+  CLOCK (second chance) strategy.
 */
 
 /* PUBLIC FUNCTIONES */
 cache_entry *lookup_cache (char *x);
-int write_cache (cache_entry *x);
-/*  void delete_cache (cache_entry *x); */
+int write_cache (const char *x, cache_entry *c);
 void kill_cache();
-void initialize_cache();
+void initialize_cache(size_t budget);
+void log_cache_stats(FILE *FP);
 
 /* PRIVATE FUNCTIONES */
 /*  static int cache_comp(cache_entry *x, cache_entry *y); */
-INLINE static unsigned cache_f (char *x);
-
-/* #define CACHESIZE 67108864 -1 */ /* 2^26 -1   must be power of 2 -1 */
-/* #define CACHESIZE 33554432 -1 */ /* 2^25 -1   must be power of 2 -1 */
-/* #define CACHESIZE 16777216 -1 */ /* 2^24 -1   must be power of 2 -1 */ 
-/* #define CACHESIZE  4194304 -1 */ /* 2^22 -1   must be power of 2 -1 */
-#define CACHESIZE  1048576 -1  /* 2^20 -1   must be power of 2 -1 */
-/* #define CACHESIZE   262144 -1 */ /* 2^18 -1   must be power of 2 -1 */
-/* next is default */
-/* #define CACHESIZE    65536 -1 */ /* 2^16 -1   must be power of 2 -1 */
-/* #define CACHESIZE    16384 -1 */ /* 2^14 -1   must be power of 2 -1 */
-/* #define CACHESIZE     4096 -1 */ /* 2^12 -1   must be power of 2 -1 */
-
-static cache_entry *cachetab[CACHESIZE+1];
+INLINE static unsigned cache_f (const char *x, int n);
+static int pack_key(const char *x);
+static void grow_cachetab(void);
+static void unlink_entry(cache_entry *c);
+static void evict_entry(void);
+static void free_entry(cache_entry *c);
+
+#define INITIAL_CACHESIZE 1024  /* must be power of 2 */
+
+static cache_entry **cachetab = NULL;
+static unsigned cachemask = 0;          /* number of buckets - 1 */
+static cache_entry **ring = NULL;       /* CLOCK ring of all entries */
+static int ring_size = 0;
+static int ring_max = 0;
+static int hand = 0;                    /* CLOCK hand */
+static size_t mem_budget = 0;
+static size_t mem_used = 0;
+static char *keybuf = NULL;             /* packed key of last query */
+static int keybuf_size = 0;
+static int keylen = 0;                  /* unpacked length of last query */
+static unsigned long hits = 0, misses = 0, evictions = 0;
 static char UNUSED rcsid[] ="$Id: cache.c,v 1.3 2006/10/04 12:45:12 xtof Exp $";
-unsigned long collisions=0;
-
-/* stolen from perl source */
-char coeff[] = {
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1,
-                61,59,53,47,43,41,37,31,29,23,17,13,11,7,3,1};
-
-/* key must not be longer than 128 */
-INLINE static unsigned cache_f(char *x) { 
-  register char *s;
-  register int i;
-  register unsigned cache;
 
-  s = x;
+/* FNV-1a over the packed key */
+INLINE static unsigned cache_f(const char *x, int n) { 
+  register const unsigned char *s;
+  register unsigned cache;
 
-  for (i=0,    cache = 0;
-       /* while */ *s;
-       s++,           i++ , cache *= 5 ) {
-    cache += *s * coeff[i];
+  for (s = (const unsigned char *)x, cache = 2166136261u; n > 0; n--, s++) {
+    cache ^= *s;
+    cache *= 16777619u;
   }
 
-   /* divide through CACHESIZE for normalization */
-  return ((cache) & (CACHESIZE));
+  return cache;
 }
 
+/*
+  pack structure x into keybuf using the same base 3 encoding
+  as vrna_db_pack(), but without allocating memory for each query.
+  returns the length of the packed key
+*/
+static int pack_key(const char *x) {
+  int i, j, pi, l;
+
+  l = (int)strlen(x);
+  if ((l + 4) / 5 + 1 > keybuf_size) {
+    keybuf_size = (l + 4) / 5 + 1;
+    keybuf = (char *) realloc(keybuf, keybuf_size);
+    if (keybuf == NULL) {
+      fprintf(stderr, "out of memory\n"); exit(255);
+    }
+  }
+
+  for (i = j = 0; i < l; j++) {
+    unsigned p;
+    for (p = pi = 0; pi < 5; pi++) {
+      p *= 3;
+      if (i < l) {
+        if (x[i] == ')') p += 1;
+        else if (x[i] == '.') p += 2;
+        i++;
+      }
+    }
+    keybuf[j] = (char)(p + 1); /* never 0, so we can use strcmp() */
+  }
+  keybuf[j] = '\0';
+  keylen = l;
+
+  return j;
+}
 
 /* returns NULL unless x is in the cache */
 cache_entry *lookup_cache (char *x) {
-  int cacheval;
+  unsigned cacheval;
   cache_entry *c;
 
-  cacheval=cache_f(x);
-  if ((c=cachetab[cacheval]))
-    if (strcmp(c->structure,x)==0) return c;
-  
+  if (cachetab == NULL) return NULL;
+
+  cacheval = cache_f(keybuf, pack_key(x));
+  for (c = cachetab[cacheval & cachemask]; c; c = c->next)
+    if ((c->hash == cacheval) && (c->len == keylen) &&
+        (strcmp(c->key, keybuf) == 0)) {
+      c->ref = 1;
+      hits++;
+      return c;
+    }
+
+  misses++;
   return NULL;
 }
 
 /* returns 1 if x already was in the cache */
-int write_cache (cache_entry *x) {
-  int cacheval;
+int write_cache (const char *x, cache_entry *c) {
+  int n, found = 0;
+  unsigned cacheval;
+  cache_entry *o;
+
+  if (cachetab == NULL) { /* cache disabled */
+    c->key = NULL;
+    free_entry(c);
+    return 0;
+  }
+
+  n = pack_key(x);
+  cacheval = cache_f(keybuf, n);
+
+  if ((c->key = (char *) malloc(n + 1)) == NULL) {
+    fprintf(stderr, "out of memory\n"); exit(255);
+  }
+  memcpy(c->key, keybuf, n + 1);
+  c->len  = keylen;
+  c->hash = cacheval;
+  c->ref  = 1;
+  c->size = sizeof(cache_entry) + n + 1 +
+            c->top * (2 * sizeof(short) + sizeof(float) + sizeof(double));
+
+  /* replace previous entry for the same structure */
+  for (o = cachetab[cacheval & cachemask]; o; o = o->next)
+    if ((o->hash == cacheval) && (o->len == c->len) &&
+        (strcmp(o->key, c->key) == 0)) {
+      unlink_entry(o);
+      c->slot = o->slot;
+      ring[c->slot] = c;
+      mem_used -= o->size;
+      free_entry(o);
+      found = 1;
+      break;
+    }
+
+  if (!found) {
+    /* make room within the memory budget */
+    while ((ring_size > 0) && (mem_used + c->size > mem_budget))
+      evict_entry();
+
+    if (ring_size == ring_max) {
+      ring_max = 2 * ring_max + 1024;
+      ring = (cache_entry **) realloc(ring, ring_max * sizeof(cache_entry *));
+      if (ring == NULL) {
+        fprintf(stderr, "out of memory\n"); exit(255);
+      }
+    }
+    c->slot = ring_size;
+    ring[ring_size++] = c;
+  }
+
+  c->next = cachetab[cacheval & cachemask];
+  cachetab[cacheval & cachemask] = c;
+  mem_used += c->size;
+
+  if ((unsigned)ring_size > cachemask + 1)
+    grow_cachetab();
+
+  return found;
+}
+
+/* double the number of buckets and rehash all entries */
+static void grow_cachetab(void) {
+  int i;
+  unsigned mask;
+  cache_entry **tab, *c;
+
+  mask = 2 * cachemask + 1;
+  if ((tab = (cache_entry **) calloc(mask + 1, sizeof(cache_entry *))) == NULL)
+    return; /* keep going with the current table */
+
+  for (i = 0; i < ring_size; i++) {
+    c = ring[i];
+    c->next = tab[c->hash & mask];
+    tab[c->hash & mask] = c;
+  }
+
+  free(cachetab);
+  mem_used += (mask - cachemask) * sizeof(cache_entry *);
+  cachetab = tab;
+  cachemask = mask;
+}
+
+/* remove entry c from its hash bucket */
+static void unlink_entry(cache_entry *c) {
+  cache_entry **p;
+
+  for (p = &(cachetab[c->hash & cachemask]); *p; p = &((*p)->next))
+    if (*p == c) {
+      *p = c->next;
+      break;
+    }
+}
+
+/* evict the first entry under the CLOCK hand without reference bit */
+static void evict_entry(void) {
   cache_entry *c;
-  
-  cacheval=cache_f(x->structure);
-  if ((c=cachetab[cacheval])) {
-    free(c->structure);
-    free(c->neighbors);
-    free(c->rates);
-    free(c->energies);
-    free(c);
+
+  for (;;) {
+    if (hand >= ring_size) hand = 0;
+    c = ring[hand];
+    if (!c->ref) break;
+    c->ref = 0;
+    hand++;
   }
-  cachetab[cacheval]=x;
-  return 0;
+
+  unlink_entry(c);
+  ring[hand] = ring[--ring_size];
+  ring[hand]->slot = hand;
+  mem_used -= c->size;
+  free_entry(c);
+  evictions++;
+}
+
+static void free_entry(cache_entry *c) {
+  free(c->key);
+  free(c->neighbors);
+  free(c->rates);
+  free(c->energies);
+  free(c);
 }
 
 /**/
-void initialize_cache () { }
+void initialize_cache (size_t budget) {
+  kill_cache();
+
+  mem_budget = budget;
+  hits = misses = evictions = 0;
+  if (mem_budget == 0) return; /* cache disabled */
+
+  cachemask = INITIAL_CACHESIZE - 1;
+  if ((cachetab = (cache_entry **) calloc(cachemask + 1, sizeof(cache_entry *))) == NULL) {
+    fprintf(stderr, "out of memory\n"); exit(255);
+  }
+  mem_used = (cachemask + 1) * sizeof(cache_entry *);
+}
 
 /**/
 void kill_cache () {
   int i;
   
-  for (i=0;i<CACHESIZE+1;i++) {
-    if ( cachetab[i] ) {
-      free (cachetab[i]->structure);
-      free (cachetab[i]->neighbors);
-      free (cachetab[i]->rates);
-      free (cachetab[i]->energies);
-      free (cachetab[i]);
-    }
-    cachetab[i]=NULL;
-  }
+  for (i = 0; i < ring_size; i++)
+    free_entry(ring[i]);
+
+  free(ring);
+  free(cachetab);
+  free(keybuf);
+  ring = NULL;
+  cachetab = NULL;
+  keybuf = NULL;
+  ring_size = ring_max = hand = keybuf_size = 0;
+  cachemask = 0;
+  mem_used = 0;
+}
+
+/**/
+void log_cache_stats (FILE *FP) {
+  unsigned long total = hits + misses;
+
+  fprintf(FP,
+          "#Cache: budget=%luMB used=%.2fMB entries=%d "
+          "hits=%lu misses=%lu (hit rate %.2f%%) evictions=%lu\n",
+          (unsigned long)(mem_budget >> 20),
+          (double)mem_used / (1 << 20),
+          ring_size,
+          hits,
+          misses,
+          (total > 0) ? 100. * hits / total : 0.,
+          evictions);
+  fflush(FP);
 }
 
 #if 0
 /**/
 static int cache_comp(cache_entry *x, cache_entry *y) {
-  return strcmp(((cache_entry *)x)->structure, ((cache_entry *)y)->structure);
+  return strcmp(((cache_entry *)x)->key, ((cache_entry *)y)->key);
 }
 #endif
 
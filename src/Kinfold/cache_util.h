@@ -9,14 +9,22 @@
 #ifndef CACHE_UTIL_H
 #define CACHE_UTIL_H
 
+#include <stdio.h>
+
 #ifdef __GNUC__
 #define UNUSED __attribute__ ((unused))
 #else
 #define UNUSED
 #endif
 
-typedef struct {
-  char *structure;
+typedef struct _cache_entry {
+  char *key;         /* packed structure (5 positions per byte) */
+  int len;           /* length of the unpacked structure */
+  unsigned hash;     /* hash value of key */
+  int ref;           /* reference bit for CLOCK eviction */
+  int slot;          /* position in the CLOCK ring */
+  size_t size;       /* number of bytes occupied by this entry */
+  struct _cache_entry *next; /* next entry in hash bucket */
   int top;           /* number of neighbors */
   int lmin;          /* is a local minimum ? */
   double flux;       /* sum of rates */
@@ -26,8 +34,10 @@ typedef struct {
   double *energies;
 } cache_entry;
 
+void initialize_cache(size_t budget);
 extern cache_entry *lookup_cache (char *x);
-extern int write_cache (cache_entry *x);
+extern int write_cache (const char *x, cache_entry *c);
 void kill_cache(void);
+void log_cache_stats(FILE *FP);
 
 #endif
@@ -379,6 +379,11 @@ static void process_options_gg (int argc, char *argv[]) {
   GSV.cut = args_info.cut_arg;
   GSV.grow = args_info.grow_arg;
   GSV.glen = args_info.glen_arg;
+  if (args_info.cachesize_arg < 0) {
+    fprintf(stderr, "Value of --cachesize must be >= 0 >%d<\n", args_info.cachesize_arg);
+    exit(EXIT_FAILURE);
+  }
+  GSV.cachesize = args_info.cachesize_arg;
   GTV.lmin = args_info.lmin_flag;
   GTV.fpt  = args_info.fpt_flag;
   GTV.rect = args_info.rect_flag;
@@ -563,6 +568,7 @@ static void ini_gvars(void) {
   GSV.phi = 1.0;
   GSV.simTime = 0.0;
   GSV.glen = 15;
+  GSV.cachesize = 256;
 }
 
 /**/
@@ -40,6 +40,7 @@ typedef struct _GlobVars {
   double time;
   double phi;
   double simTime;
+  int    cachesize; /* memory budget of the structure cache in MB */
 } GlobVars;
 
 typedef struct _GlobArrays {
@@ -48,6 +48,7 @@ int main(int argc, char *argv[]) {
     process command-line optiones
   */
   decode_switches(argc, argv);
+  initialize_cache((size_t)GSV.cachesize << 20);
 
   /*
     initialize energy parameters
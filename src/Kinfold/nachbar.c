@@ -151,9 +151,6 @@ void put_in_cache(void) {
   if ((c = (cache_entry *) malloc(sizeof(cache_entry)))==NULL) {
     fprintf(stderr, "out of memory\n"); exit(255);
   }
-/*    c->structure = strdup(GAV.currform); */
-  c->structure = (char *) calloc(GSV.len+1, sizeof(char));
-  strcpy(c->structure, GAV.currform);
   c->neighbors = (short *) malloc(top*2*sizeof(short));
   memcpy(c->neighbors,neighbor_list,top*2*sizeof(short));
   c->rates = (float *) malloc(top*sizeof(float));
@@ -164,7 +161,7 @@ void put_in_cache(void) {
   c->lmin = lmin;
   c->flux = totalflux;
   c->energy = GSV.currE;
-  write_cache(c);
+  write_cache(GAV.currform, c);
 }
 
 /*============*/
@@ -404,6 +401,8 @@ void clean_up_nbList(void){
   free(neighbor_list);
   free(bmf);
   free(energies);
+  log_cache_stats(logFP);
+  if (GTV.verbose) log_cache_stats(stdout);
   fprintf(logFP,"\n");
   fclose(logFP);
 }
@@ -377,6 +377,14 @@ void alignPairwise(std::vector<RNAForest*> &inputListPW, Score &score, const Opt
     bool local = options.has(Options::LocalSimilarity);
 		bool printBT = options.has(Options::Backtrace);
 
+		// the full tables are only needed for printing them, without
+		// a backtrace the score is enough
+		TableMode mode = CompactTable;
+		if (options.has(Options::Tables))
+				mode = FullTable;
+		else if (options.has(Options::ShowOnlyScore))
+				mode = ScoreOnly;
+
 		RNA_Algebra<double,RNA_Alphabet> *alg = NULL;
     RNA_AlgebraAffine<double,RNA_Alphabet> * alg_affine = NULL;
 		Alignment<double,RNA_Alphabet,RNA_AlphaPair> * ali = NULL;
@@ -388,7 +396,7 @@ void alignPairwise(std::vector<RNAForest*> &inputListPW, Score &score, const Opt
             alg_affine = new AffineRIBOSUM8560(score);
         else
             alg_affine = new AffineDoubleSimiRNA_Algebra(score);
-        ali = new AlignmentAffine<double,RNA_Alphabet,RNA_AlphaPair>(f1,f2,*alg_affine,topdown,anchored,local,printBT);
+        ali = new AlignmentAffine<double,RNA_Alphabet,RNA_AlphaPair>(f1,f2,*alg_affine,topdown,anchored,local,printBT,SPEEDUP,mode);
 		}
 		else {
         if (options.has(Options::CalculateDistance))
@@ -398,7 +406,7 @@ void alignPairwise(std::vector<RNAForest*> &inputListPW, Score &score, const Opt
         else
             alg = new DoubleSimiRNA_Algebra(score);
 
-        ali = new AlignmentLinear<double,RNA_Alphabet,RNA_AlphaPair>(f1,f2,*alg,topdown,anchored,local,printBT);
+        ali = new AlignmentLinear<double,RNA_Alphabet,RNA_AlphaPair>(f1,f2,*alg,topdown,anchored,local,printBT,SPEEDUP,mode);
 		}
 			
  		if (options.has(Options::Tables)) { // TODO mit stringstream zusammenbauen
@@ -604,7 +612,7 @@ void alignPairwiseSimple(std::vector<RNAForest*> &inputListPW,Score &score,Optio
 
     //  ftime(&t1);
 		//  no local, no print backtrace, but speedup
-    AlignmentLinear<double,RNA_Alphabet,RNA_AlphaPair> ali(f1,f2,*alg,false,false,false,true);
+    AlignmentLinear<double,RNA_Alphabet,RNA_AlphaPair> ali(f1,f2,*alg,false,false,false,true,SPEEDUP,ScoreOnly);
     //  ftime(&t2);
 
     std::cout << "Global optimum: " << ali.getGlobalOptimum() << std::endl;
@@ -28,11 +28,15 @@ protected:
 		const bool anchored_;
 		const bool pIndels_;
 		const bool printBacktrace_;
+		TableMode tableMode_;
     R localOptimum_;
     R localSubOptimum_;
     std::vector<CSFPair> localAlis_;	  // alignments already produced by getOptLocalAlignment
     double suboptimalsPercent_;         // value between 0 and 1
 
+		// storage layout of the tables for the requested mode, sets tableMode_
+		void makeTableLayout(TAD_DP_Layout &layout, TableMode mode, bool local, bool RNA);
+
 		void fillMatricesTopDown(bool local, bool RNA, bool speedup);
 		void fillMatricesBottomUp(bool local, bool RNA, bool speedup);
 		// the matrix is filled like this, implemented in affine and linear
@@ -171,8 +175,8 @@ class AlignmentLinear : public Alignment<R,L,AL> {
 
 		void print(std::ostream &out) const { out << "linear ali's matrix" << std::endl << *mtrx_; };
 
-    AlignmentLinear(const Forest<L> *f1, const Forest<L> *f2,const Algebra<R,L> &alg, const bool topdown, const bool anchored, bool local, bool printBacktrace, bool speedup=SPEEDUP);
-    AlignmentLinear(const Forest<L> *f1, const Forest<L> *f2,const RNA_Algebra<R,L> &rnaAlg, const bool topdown, const bool anchored, bool local, bool printBacktrace, bool speedup=SPEEDUP);
+    AlignmentLinear(const Forest<L> *f1, const Forest<L> *f2,const Algebra<R,L> &alg, const bool topdown, const bool anchored, bool local, bool printBacktrace, bool speedup=SPEEDUP, TableMode mode=FullTable);
+    AlignmentLinear(const Forest<L> *f1, const Forest<L> *f2,const RNA_Algebra<R,L> &rnaAlg, const bool topdown, const bool anchored, bool local, bool printBacktrace, bool speedup=SPEEDUP, TableMode mode=FullTable);
     void makeFirstCell();
     void makeFirstRow();
     void makeFirstCol();
@@ -204,7 +208,7 @@ class AlignmentLinear : public Alignment<R,L,AL> {
 		bool computed(const unsigned long i, const unsigned long j) const { return mtrx_->computed(i,j); }; 
 		void setComputed(const unsigned long i, const unsigned long j) { mtrx_->setComputed(i,j); }; 
 
-    virtual ~AlignmentLinear() {};
+    virtual ~AlignmentLinear() { delete mtrx_; };
 
     // virtual, for replacepair
     virtual inline R computeReplacementScore(CSFPair p, std::string & backtrack_as) const {
@@ -495,9 +499,9 @@ class AlignmentAffine : public Alignment<R,L,AL> {
 		void print(std::ostream &out) const { out << "affine ali's matrix" << std::endl << *mtrx_; };
 
     AlignmentAffine(const Forest<L> *f1, const Forest<L> *f2,const AlgebraAffine<R,L> &alg, 
-				const bool topdown, const bool anchored, bool local, bool printBacktrace, bool speedup=SPEEDUP);
+				const bool topdown, const bool anchored, bool local, bool printBacktrace, bool speedup=SPEEDUP, TableMode mode=FullTable);
     AlignmentAffine(const Forest<L> *f1, const Forest<L> *f2,const RNA_AlgebraAffine<R,L> &rnaAlg, 
-				const bool topdown, const bool anchored, bool local, bool printBacktrace, bool speedup=SPEEDUP);
+				const bool topdown, const bool anchored, bool local, bool printBacktrace, bool speedup=SPEEDUP, TableMode mode=FullTable);
     void makeFirstCell();
     void makeFirstRow();
     void makeFirstCol();
@@ -530,7 +534,7 @@ class AlignmentAffine : public Alignment<R,L,AL> {
 
 		bool computed(const unsigned long i, const unsigned long j) const { return mtrx_->computed(i,j); }; 
 		void setComputed(const unsigned long i, const unsigned long j) { mtrx_->setComputed(i,j); }; 
-    virtual ~AlignmentAffine() {};
+    virtual ~AlignmentAffine() { delete mtrx_; };
 };
 
 #endif
@@ -20,10 +20,103 @@ Alignment<R,L,AL>::Alignment(const Forest<L> *f1, const Forest<L> *f2, const boo
 				anchored_(anchored),
 				pIndels_(true),
 				printBacktrace_(printBacktrace),
+				tableMode_(FullTable),
         suboptimalsPercent_(100) {
 
 }
 
+// Only the bottom up fill of a global alignment gets along with the compact
+// layouts, the other fills fall back to the full table.
+template<class R,class L,class AL>
+void Alignment<R,L,AL>::makeTableLayout(TAD_DP_Layout &layout, TableMode mode, bool local, bool RNA) {
+    if (topdown_ || local)
+        mode = FullTable;
+    tableMode_ = mode;
+
+    unsigned long rows = this->f1_->getNumCSFs();
+    unsigned long cols = this->f2_->getNumCSFs();
+    if (mode == FullTable) {
+        makeFullLayout(layout, rows, cols);
+        return;
+    }
+
+    // csfs (i,j) with j >= getMaxLength(i) + 1 - keep get full rows (columns)
+    // RNA alignments also look at the csfs without the last tree (mdown)
+    const unsigned int keep = RNA ? 2 : 1;
+    unsigned long m = this->f1_->size();
+    unsigned long n = this->f2_->size();
+
+    layout.rows = rows;
+    layout.cols = cols;
+    layout.rowStart.assign(rows, 0);
+    layout.wideRow.assign(rows, false);
+    layout.narrowCol.assign(cols, -1);
+
+    // columns of the narrow rows
+    long width = 0;
+    for (unsigned long k = 0; k < n; k++) {
+        unsigned int maxLen = this->f2_->getMaxLength(k);
+        for (unsigned int l = maxLen > keep ? maxLen + 1 - keep : 1; l <= maxLen; l++)
+            layout.narrowCol[this->f2_->indexpos(k, l)] = width++;
+    }
+
+    // wide rows, including the empty forest
+    unsigned long size = cols;
+    layout.wideRow[0] = true;
+    for (unsigned long i = 0; i < m; i++) {
+        unsigned int maxLen = this->f1_->getMaxLength(i);
+        for (unsigned int j = maxLen > keep ? maxLen + 1 - keep : 1; j <= maxLen; j++) {
+            unsigned long h = this->f1_->indexpos(i, j);
+            layout.wideRow[h] = true;
+            layout.rowStart[h] = size;
+            size += cols;
+        }
+    }
+
+    // column 0 of the narrow rows
+    layout.colZero = size;
+    size += rows;
+
+    // narrow rows
+    if (mode == CompactTable) {
+        for (unsigned long i = 0; i < m; i++) {
+            for (unsigned int j = 1; j + keep <= this->f1_->getMaxLength(i); j++) {
+                layout.rowStart[this->f1_->indexpos(i, j)] = size;
+                size += width;
+            }
+        }
+    }
+    else {
+        // the narrow rows of node i are written when makeInnersGlobal gets to i
+        // and read by i and its left brothers, so they can be reused as soon
+        // as the parent of i is done
+        std::vector<unsigned long> freeSlots;
+        unsigned long slots = 0;
+        for (long i = m - 1; i >= 0; i--) {
+            for (unsigned int j = 1; j + keep <= this->f1_->getMaxLength(i); j++) {
+                unsigned long slot;
+                if (freeSlots.empty()) {
+                    slot = slots++;
+                }
+                else {
+                    slot = freeSlots.back();
+                    freeSlots.pop_back();
+                }
+                layout.rowStart[this->f1_->indexpos(i, j)] = size + slot*width;
+            }
+            if (this->f1_->noc(i)) {
+                for (unsigned long c = i + 1; c; c = this->f1_->rb(c)) {
+                    for (unsigned int j = 1; j + keep <= this->f1_->getMaxLength(c); j++)
+                        freeSlots.push_back((layout.rowStart[this->f1_->indexpos(c, j)] - size)/width);
+                }
+            }
+        }
+        size += slots*width;
+    }
+
+    layout.size = size;
+}
+
 #if 0
 template<class R,class L,class AL>
 Alignment<R,L,AL>::~Alignment() {
@@ -144,18 +237,20 @@ void Alignment<R, L, AL>::recursiveFill(CSFPair p, bool RNA, bool speedup) {
 
 
 template<class R,class L,class AL>
-AlignmentLinear<R,L,AL>::AlignmentLinear(const Forest<L> *f1, const Forest<L> *f2, const Algebra<R,L> &alg, const bool topdown, const bool anchored, const bool local, const bool printBacktrace, bool speedup)
+AlignmentLinear<R,L,AL>::AlignmentLinear(const Forest<L> *f1, const Forest<L> *f2, const Algebra<R,L> &alg, const bool topdown, const bool anchored, const bool local, const bool printBacktrace, bool speedup, TableMode mode)
         : Alignment<R,L,AL>(f1,f2,topdown,anchored,printBacktrace) {
 
+		bool RNA = false;
     // alloc space for the score matrix, backtrace structure,
     // and , if wanted, for the calculation-order-matrix
-		mtrx_ = new TAD_DP_TableLinear<R>(this->f1_->getNumCSFs(),this->f2_->getNumCSFs(),alg.worst_score());
+		TAD_DP_Layout layout;
+		this->makeTableLayout(layout, mode, local, RNA);
+		mtrx_ = new TAD_DP_TableLinear<R>(layout,topdown);
     // initialize variables
     alg_ = &alg;
     rnaAlg_ = NULL;
     this->localOptimum_ = alg.worst_score();
     // align forests f1_ and f2_
-		bool RNA = false;
 		if (topdown)
 			this->fillMatricesTopDown(local, RNA, speedup);
 		else
@@ -165,18 +260,20 @@ AlignmentLinear<R,L,AL>::AlignmentLinear(const Forest<L> *f1, const Forest<L> *f
 
 // constructor for RNA alignments
 template<class R,class L,class AL>
-AlignmentLinear<R,L,AL>::AlignmentLinear(const Forest<L> *f1, const Forest<L> *f2, const RNA_Algebra<R,L> &rnaAlg, const bool topdown, const bool anchored, const bool local, const bool printBacktrace, bool speedup)
+AlignmentLinear<R,L,AL>::AlignmentLinear(const Forest<L> *f1, const Forest<L> *f2, const RNA_Algebra<R,L> &rnaAlg, const bool topdown, const bool anchored, const bool local, const bool printBacktrace, bool speedup, TableMode mode)
         : Alignment<R,L,AL>(f1,f2,topdown,anchored,printBacktrace) {
 
+		bool RNA = true;
     // alloc space for the score matrix, backtrace structure and,
     // if wanted, for the calculation-order-matrix
-		mtrx_ = new TAD_DP_TableLinear<R>(this->f1_->getNumCSFs(),this->f2_->getNumCSFs(),rnaAlg.worst_score());
+		TAD_DP_Layout layout;
+		this->makeTableLayout(layout, mode, local, RNA);
+		mtrx_ = new TAD_DP_TableLinear<R>(layout,topdown);
     // initialize variables
     rnaAlg_ = &rnaAlg;
     alg_ = (const Algebra<R,L>*)&rnaAlg;
     this->localOptimum_ = rnaAlg.worst_score();
     // align forests f1 and f2
-		bool RNA = true;
 		if (topdown)
 			this->fillMatricesTopDown(local, RNA, speedup);
 		else
@@ -782,6 +879,7 @@ R AlignmentLinear<R,L,AL>::getSILOptimum() const {
 template<class R,class L,class AL>
 void AlignmentLinear<R,L,AL>::getOptGlobalAlignment(ForestAli<L,AL> &fali) {
     unsigned int node = 0;
+    assert(this->tableMode_ != ScoreOnly);
 
     // allocate a forest of the maximal size that a forest alignment can have
     fali.initialize(this->f1_->size()+this->f2_->size(),this->anchored_);
@@ -877,6 +975,7 @@ found:
 template<class R,class L,class AL>
 void AlignmentLinear<R,L,AL>::getOptSILAlignment(ForestAli<L,AL> &fali,unsigned int &ybasepos) {
     unsigned int node=0;
+    assert(this->tableMode_ != ScoreOnly);
 
     // allocate a forest of the maximal size that a forest alignment can have
     fali.initialize(this->f1_->size()+this->f2_->size(),this->anchored_);
@@ -906,18 +1005,20 @@ found:
 
 template<class R, class L, class AL>
 AlignmentAffine<R,L,AL>::AlignmentAffine(const Forest<L> *f1, const Forest<L> *f2, const AlgebraAffine<R,L> &alg, 
-		const bool topdown, const bool anchored, const bool local, const bool printBacktrace, bool speedup)
+		const bool topdown, const bool anchored, const bool local, const bool printBacktrace, bool speedup, TableMode mode)
         : Alignment<R,L,AL>(f1, f2, topdown, anchored, printBacktrace) {
 
+		bool RNA = false;
     // alloc space for the score matrix, backtrace structure,
     // and , if wanted, for the calculation-order-matrix
-		mtrx_ = new TAD_DP_TableAffine<R>(this->f1_->getNumCSFs(),this->f2_->getNumCSFs(),alg.worst_score());
+		TAD_DP_Layout layout;
+		this->makeTableLayout(layout, mode, local, RNA);
+		mtrx_ = new TAD_DP_TableAffine<R>(layout,topdown,alg.worst_score());
     // initialize variables
     alg_ = &alg;
     rnaAlg_ = NULL;
     this->localOptimum_ = alg.worst_score();
     // align forests f1_ and f2_
-		bool RNA = false;
 		if (topdown)
 			this->fillMatricesTopDown(local, RNA, speedup);
 		else
@@ -928,18 +1029,20 @@ AlignmentAffine<R,L,AL>::AlignmentAffine(const Forest<L> *f1, const Forest<L> *f
 // constructor for RNA alignments
 template<class R,class L,class AL>
 AlignmentAffine<R,L,AL>::AlignmentAffine(const Forest<L> *f1, const Forest<L> *f2, const RNA_AlgebraAffine<R,L> &rnaAlg, 
-		const bool topdown, const bool anchored, const bool local, const bool printBacktrace, bool speedup)
+		const bool topdown, const bool anchored, const bool local, const bool printBacktrace, bool speedup, TableMode mode)
         : Alignment<R,L,AL>(f1, f2, topdown, anchored, printBacktrace) {
 
+		bool RNA = true;
     // alloc space for the score matrix, backtrace structure and,
     // if wanted, for the calculation-order-matrix
-		mtrx_ = new TAD_DP_TableAffine<R>(this->f1_->getNumCSFs(),this->f2_->getNumCSFs(),rnaAlg.worst_score());
+		TAD_DP_Layout layout;
+		this->makeTableLayout(layout, mode, local, RNA);
+		mtrx_ = new TAD_DP_TableAffine<R>(layout,topdown,rnaAlg.worst_score());
     // initialize variables
     rnaAlg_ = &rnaAlg;
     alg_ = (const AlgebraAffine<R,L>*)&rnaAlg;
     this->localOptimum_ = rnaAlg.worst_score();
     // align forests f1 and f2
-		bool RNA = true;
 		if (topdown)
 			this->fillMatricesTopDown(local, RNA, speedup);
 		else
@@ -1580,6 +1683,7 @@ R AlignmentAffine<R,L,AL>::getSILOptimum() const {
 template<class R, class L, class AL>
 void AlignmentAffine<R, L, AL>::getOptGlobalAlignment(ForestAli<L, AL> &fali) {
   unsigned int node = 0;
+  assert(this->tableMode_ != ScoreOnly);
 
   // allocate a forest of the maximal size that a forest alignment can have
   fali.initialize(this->f1_->size() + this->f2_->size(),this->anchored_);
@@ -1700,6 +1804,7 @@ bool AlignmentAffine<R,L,AL>::nextLocalSuboptimum() {
 template<class R,class L,class AL>
 void AlignmentAffine<R,L,AL>::getOptSILAlignment(ForestAli<L,AL> &fali,unsigned int &ybasepos) {
     unsigned int node=0;
+    assert(this->tableMode_ != ScoreOnly);
 
     // allocate a forest of the maximal size that a forest alignment can have
     fali.initialize(this->f1_->size()+this->f2_->size(), this->anchored_);
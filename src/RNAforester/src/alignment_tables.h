@@ -8,6 +8,54 @@
 #include <cstdlib>
 #include <climits>
 
+#include <vector>
+
+// storage modes of the tables
+//
+// FullTable:    one entry for every pair of closed subforests, needed for
+//               local alignments and the top down fill
+// CompactTable: the bottom up fill of a global alignment only touches entries
+//               where (at least) one of both subforests is a complete sibling
+//               suffix (or, for RNA, lacks only its last tree). Only these are
+//               stored, the backtrace works as before.
+// ScoreOnly:    like CompactTable, but the remaining (narrow) rows of a node
+//               share their storage with rows that are not needed any more,
+//               once the parent node is done. Only the optimum can be read
+//               afterwards, there is no backtrace.
+enum TableMode { FullTable, CompactTable, ScoreOnly };
+
+// maps the entries of a table to offsets in its arrays. Wide rows store
+// all columns, narrow rows only those columns that are listed in narrowCol
+// (plus column 0, which every row keeps in a separate slot).
+// An empty narrowCol means that all rows are wide.
+struct TAD_DP_Layout {
+		unsigned long rows;
+		unsigned long cols;
+		unsigned long size;
+		unsigned long colZero;                // start of the column 0 slots of narrow rows
+		std::vector<unsigned long> rowStart;
+		std::vector<bool> wideRow;
+		std::vector<long> narrowCol;          // position of a column in narrow rows or -1
+};
+
+// layout of a full table with rows x cols entries
+inline void makeFullLayout(TAD_DP_Layout &layout, unsigned long rows, unsigned long cols) {
+		// check for an overflow
+		if (rows > ULONG_MAX / cols) {
+				std::cerr << "Error: Overflow in calculation matrix multiplication. Calculation terminated." << std::endl;
+				exit(EXIT_FAILURE);
+		}
+		layout.rows = rows;
+		layout.cols = cols;
+		layout.size = rows*cols;
+		layout.colZero = 0;
+		layout.rowStart.resize(rows);
+		for (unsigned long h = 0; h < rows; h++)
+				layout.rowStart[h] = h*cols;
+		layout.wideRow.assign(rows, true);
+		layout.narrowCol.clear();
+}
+
 // superclass of tables, has the row start info
 
 template<class R> 
@@ -18,45 +66,68 @@ class TAD_DP_Table {
 			return out;
 		}
 
-		TAD_DP_Table(unsigned long rows, unsigned long cols, R init) 
-			: rows_(rows),
-			cols_(cols),
-			mtrxSize_(rows*cols) {
-	    rowStart_ = new unsigned long[rows];
-	    rowStart_[0] = 0;
-	    for (unsigned long h = 1; h < rows; h++) {
-	        rowStart_[h] = rowStart_[h - 1] + cols;
-	    }
-			//TODO if (topdown)
-			computed_ = new bool[mtrxSize_];
+		TAD_DP_Table(const TAD_DP_Layout &layout, bool topdown)
+			: rows_(layout.rows),
+			cols_(layout.cols),
+			mtrxSize_(layout.size),
+			colZero_(layout.colZero),
+			rowStart_(layout.rowStart),
+			wideRow_(layout.wideRow),
+			narrowCol_(layout.narrowCol),
+			computed_(NULL) {
+			// only the top down fill needs to know which entries are done
+			if (topdown)
+				computed_ = new bool[mtrxSize_]();
 		}
 
-		~TAD_DP_Table(){
-			delete[] rowStart_;
+		virtual ~TAD_DP_Table(){
+			delete[] computed_;
 		}
 
 		virtual void checkSpaceConsumption() = 0;
     virtual void print(std::ostream &s) const = 0;
 
-		// TODO if nicht topdown dann was?
 	  inline bool computed(const unsigned long i, const unsigned long j) const {
-        assert(this->rowStart_[i] + j < this->mtrxSize_);
-        return computed_[this->rowStart_[i] + j];
+        assert(computed_);
+        return computed_[offset(i,j)];
     };
 
     inline void setComputed(const unsigned long i, const unsigned long j) {
-      assert(this->rowStart_[i] + j < this->mtrxSize_);
-      computed_[this->rowStart_[i] + j] = true;
+      assert(computed_);
+      computed_[offset(i,j)] = true;
     };
 
+		// is the entry (i,j) kept by the layout
+		inline bool stored(const unsigned long i, const unsigned long j) const {
+			return narrowCol_.empty() || wideRow_[i] || j == 0 || narrowCol_[j] >= 0;
+		}
 
 	protected:
 		unsigned long rows_;
 		unsigned long cols_;
     unsigned long mtrxSize_;
-    unsigned long *rowStart_;
+		unsigned long colZero_;
+    std::vector<unsigned long> rowStart_;
+		std::vector<bool> wideRow_;
+		std::vector<long> narrowCol_;
 		bool *computed_;
 
+		inline unsigned long offset(const unsigned long i, const unsigned long j) const {
+			assert(i < rows_ && j < cols_);
+			if (narrowCol_.empty() || wideRow_[i])
+				return rowStart_[i] + j;
+			if (j == 0)
+				return colZero_ + i;
+			assert(narrowCol_[j] >= 0);
+			return rowStart_[i] + narrowCol_[j];
+		}
+
+		void printEntry(std::ostream &s, const R *mtrx, const unsigned long i, const unsigned long j) const {
+			if (stored(i,j))
+				s << mtrx[offset(i,j)] << " ";
+			else
+				s << "- ";
+		}
 };
 
 
@@ -68,8 +139,8 @@ class TAD_DP_TableLinear : public TAD_DP_Table<R> {
     R *mtrx_;
 
 	public:
-		TAD_DP_TableLinear(unsigned long rows, unsigned long cols, R init) 
-			: TAD_DP_Table<R>(rows,cols,init) {
+		TAD_DP_TableLinear(const TAD_DP_Layout &layout, bool topdown)
+			: TAD_DP_Table<R>(layout,topdown) {
 			checkSpaceConsumption();
 			mtrx_ = new R[this->mtrxSize_];
 		}
@@ -79,11 +150,6 @@ class TAD_DP_TableLinear : public TAD_DP_Table<R> {
 		}
 
 		void checkSpaceConsumption() {
-		    // check for an overflow
-		    if (this->rows_ > ULONG_MAX / this->cols_) {
-		        std::cerr << "Error: Overflow in calculation matrix multiplication. Calculation terminated." << std::endl;
-		        exit(EXIT_FAILURE);
-		    }
 		    // maximum array size is 2GB
 		    if (this->mtrxSize_ > 2000000000 || this->rows_ > 2000000000) {
 		        std::cerr << "Error: Maximum array size of 2GB exceeded due to large input data. Calculation terminated." << std::endl;
@@ -92,19 +158,17 @@ class TAD_DP_TableLinear : public TAD_DP_Table<R> {
 		}
 
     inline R getMtrxVal(const unsigned long i, const unsigned long j) const {
-        assert(this->rowStart_[i] + j < this->mtrxSize_);
-        return mtrx_[this->rowStart_[i] + j];
+        return mtrx_[this->offset(i,j)];
 		}
 
 		inline void setMtrxVal(const unsigned long i, const unsigned long j, R& val) {
-      assert(this->rowStart_[i] + j < this->mtrxSize_);
-      mtrx_[this->rowStart_[i] + j] = val;
+      mtrx_[this->offset(i,j)] = val;
 		}
 
     void print(std::ostream &s) const {
 			for (unsigned int i = 0; i < this->rows_; i++) {
 				for (unsigned int j = 0; j < this->cols_; j++) {
-					 s << mtrx_[this->rowStart_[i] + j] << " ";
+					 this->printEntry(s, mtrx_, i, j);
 				}
 				s << std::endl;
 			}
@@ -151,8 +215,8 @@ class TAD_DP_TableAffine : public TAD_DP_Table<R> {
     }
 
 	public:
-    TAD_DP_TableAffine(unsigned long rows, unsigned long cols, R init)
-      : TAD_DP_Table<R>(rows,cols,init) {
+    TAD_DP_TableAffine(const TAD_DP_Layout &layout, bool topdown, R init)
+      : TAD_DP_Table<R>(layout,topdown) {
       checkSpaceConsumption();
       mtrxS_ = new R[this->mtrxSize_];
       mtrxV_ = new R[this->mtrxSize_];
@@ -172,12 +236,12 @@ class TAD_DP_TableAffine : public TAD_DP_Table<R> {
 			std::fill( mtrxVH__, mtrxVH__ + this->mtrxSize_, init );
     }
 
+		~TAD_DP_TableAffine() {
+			for (int table = S; table <= VH_; table++)
+				delete[] getMtrx(table);
+		}
+
 		void checkSpaceConsumption() {
-			// check for an overflow
-			if (this->rows_ > ULONG_MAX / this->cols_) {
-				std::cerr << "Error: Overflow in calculation matrix multiplication. Calculation terminated." << std::endl;
-				exit(EXIT_FAILURE);
-			}
 			// maximum array size for 7 arrays is 2GB
 			if ((7*this->mtrxSize_) > 2000000000 || (7*this->rows_) > 2000000000) {
         std::cerr << "Error: Maximum size of 2GB for the calculation tables exceeded due to large input data. Calculation terminated." << std::endl;
@@ -186,16 +250,14 @@ class TAD_DP_TableAffine : public TAD_DP_Table<R> {
 		}
 
 		inline R getMtrxVal(int table, const unsigned long i, const unsigned long j) const {
-        assert(this->rowStart_[i] + j < this->mtrxSize_);
 				R *mtrx = getMtrx(table);
-				return mtrx[this->rowStart_[i] + j];
+				return mtrx[this->offset(i,j)];
     }
 
 		// TODO alg noch nicht am start
     inline void setMtrxVal(int table, const unsigned long i, const unsigned long j, const R val) {
-      	assert(this->rowStart_[i] + j < this->mtrxSize_);
 				R *mtrx = getMtrx(table);
-				mtrx[this->rowStart_[i] + j] = val;
+				mtrx[this->offset(i,j)] = val;
     }
 
     void print(std::ostream &s) const {
@@ -204,7 +266,7 @@ class TAD_DP_TableAffine : public TAD_DP_Table<R> {
 				R *mtrx = getMtrx(table);
 				for (unsigned int i = 0; i < this->rows_; i++) {
 					for (unsigned int j = 0; j < this->cols_; j++) {
-						 s << mtrx[this->rowStart_[i] + j] << " ";
+						 this->printEntry(s, mtrx, i, j);
 					}
 					s << std::endl;
 				}
@@ -35,6 +35,7 @@ Options::Options(int argc, const char **argv)
     setOption(Multiple,                  "-m","","                        ","multiple alignment mode",false);
     setOption(ClusterThreshold,          "-mt","=double","                ","clustering threshold",false);
     setOption(ClusterJoinCutoff,         "-mc","=double","                ","clustering cutoff",false);
+    setOption(Threads,                   "-j","=int","                    ","number of threads for pairwise alignments in multiple alignment mode",false);
 #ifdef HAVE_LIBRNA
     setOption(PredictProfile,            "-p","","                        ","predict structures from sequences",false);
     setOption(PredictMinPairProb,	       "-pmin","=double","              ","minimum basepair frequency for prediction",false);
@@ -116,6 +117,7 @@ Options::Options(int argc, const char **argv)
     requires(LocalSubopts,LocalSimilarity);
     requires(ClusterThreshold,Multiple);
     requires(ClusterJoinCutoff,Multiple);
+    requires(Threads,Multiple);
 #ifdef HAVE_LIBRNA
     requires(PredictProfile,Multiple);
     requires(PredictMinPairProb,PredictProfile);
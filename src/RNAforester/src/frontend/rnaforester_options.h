@@ -52,6 +52,7 @@ public:
         ConsensusMinPairProb,
         ClusterThreshold,
         ClusterJoinCutoff,
+        Threads,
 #ifdef HAVE_LIBRNA
         PredictProfile,
         PredictMinPairProb,
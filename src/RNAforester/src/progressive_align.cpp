@@ -1,9 +1,36 @@
 #include <algorithm>
 #include <fstream>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 #include "alignment.h"
 #include "progressive_align.h"
 #include "alignment.t.cpp"
 
+// score of the alignment of two profiles. Every call uses its own alignment instance,
+// so the scores of several pairs can be computed concurrently. No backtrace is needed,
+// so global alignments only keep the tables for the score.
+// exactly one of alg and alg_affine must be given.
+static double pairwiseScore(const RNAProfileAlignment *f1, const RNAProfileAlignment *f2,
+                            const Algebra<double,RNA_Alphabet_Profile> *alg, const AlgebraAffine<double,RNA_Alphabet_Profile> *alg_affine,
+                            bool topdown, bool anchored, bool local, bool printBT) {
+    Alignment<double,RNA_Alphabet_Profile,RNA_Alphabet_Profile> * ali = NULL;
+    double score;
+
+    if (alg_affine)
+        ali = new AlignmentAffine<double,RNA_Alphabet_Profile,RNA_Alphabet_Profile>(f1,f2,*alg_affine,topdown,anchored,local,printBT,SPEEDUP,ScoreOnly);
+    else
+        ali = new AlignmentLinear<double,RNA_Alphabet_Profile,RNA_Alphabet_Profile>(f1,f2,*alg,topdown,anchored,local,printBT,SPEEDUP,ScoreOnly);
+
+    if (local)
+        score = ali->getLocalOptimum();
+    else
+        score = ali->getGlobalOptimumRelative();
+
+    delete ali;
+    return score;
+}
+
 
 // !!! this operator is defined as > !!!
 bool operator < (std::pair<double,RNAProfileAlignment*> &l, std::pair<double,RNAProfileAlignment*> &r) {
@@ -76,6 +103,16 @@ void progressiveAlign(std::vector<RNAProfileAlignment*> &inputList,
     bool local = options.has(Options::LocalSimilarity);
 		bool printBT = options.has(Options::Backtrace);
 
+    // number of threads for the pairwise alignments
+    int threads = 1;
+    options.get(Options::Threads, threads, 1);
+#ifdef _OPENMP
+    if (threads <= 0)
+        threads = omp_get_num_procs();
+#endif
+    if (threads < 1 || printBT)  // backtraces of concurrent alignments would be interleaved
+        threads = 1;
+
     // generate dot file
 		std::string clusterfilename = options.generateFilename(Options::Help,"_cluster.dot", "cluster.dot");  // use Help as dummy
     std::ofstream s;
@@ -98,36 +135,32 @@ void progressiveAlign(std::vector<RNAProfileAlignment*> &inputList,
 		RNAProfileAlignment *f1 = NULL, *f2 = NULL;
     std::cout << "Computing all pairwise similarities" << std::endl;
 
+    // the pairs are independent, so collect them first and align them in parallel
+    std::vector<std::pair<long,long> > pairKeys;
+    std::vector<std::pair<RNAProfileAlignment*,RNAProfileAlignment*> > pairProfiles;
+    std::vector<double> pairScores;
+
     RNAProfileAliMapType::iterator it2;
     for (it=inputMapProfile.begin(); it!=inputMapProfile.end(); it++) {
-        x = it->first;
-        f1 = it->second;
         for (it2=inputMapProfile.begin(); it2->first<it->first; it2++) {
-            y = it2->first;
-            f2 = it2->second;
-
-						if (options.has(Options::Affine)) {
-							AlignmentAffine<double,RNA_Alphabet_Profile,RNA_Alphabet_Profile> * ali = new AlignmentAffine<double,RNA_Alphabet_Profile,RNA_Alphabet_Profile>(f1,f2,*alg_affine,topdown,anchored,local,printBT);
-	            if (local)
-		              score_mtrx->setAt(x-1,y-1,ali->getLocalOptimum());
-			        else
-				          score_mtrx->setAt(x-1,y-1,ali->getGlobalOptimumRelative());
-
-					    std::cout << x << "," << y << ": " << score_mtrx->getAt(x-1,y-1) << std::endl;
-							delete ali;
-						}
-						else {
-							AlignmentLinear<double,RNA_Alphabet_Profile,RNA_Alphabet_Profile> * ali = new AlignmentLinear<double,RNA_Alphabet_Profile,RNA_Alphabet_Profile>(f1,f2,*alg,topdown,anchored,local,printBT);
-							if (local)
-								  score_mtrx->setAt(x-1,y-1,ali->getLocalOptimum());
-							else
-								  score_mtrx->setAt(x-1,y-1,ali->getGlobalOptimumRelative());
-
-							std::cout << x << "," << y << ": " << score_mtrx->getAt(x-1,y-1) << std::endl;
-							delete ali;
-						}
+            pairKeys.push_back(std::make_pair(it->first,it2->first));
+            pairProfiles.push_back(std::make_pair(it->second,it2->second));
         }
     }
+
+    pairScores.resize(pairKeys.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+#endif
+    for (long k=0; k<(long)pairKeys.size(); k++)
+        pairScores[k] = pairwiseScore(pairProfiles[k].first,pairProfiles[k].second,alg,alg_affine,topdown,anchored,local,printBT);
+
+    for (unsigned long k=0; k<pairKeys.size(); k++) {
+        x = pairKeys[k].first;
+        y = pairKeys[k].second;
+        score_mtrx->setAt(x-1,y-1,pairScores[k]);
+        std::cout << x << "," << y << ": " << score_mtrx->getAt(x-1,y-1) << std::endl;
+    }
     std::cout << std::endl;
 
     std::vector<RNAProfileAliKeyPairType> inputListMult;
@@ -225,9 +258,9 @@ void progressiveAlign(std::vector<RNAProfileAlignment*> &inputList,
             // compute alignment again
             Alignment<double,RNA_Alphabet_Profile,RNA_Alphabet_Profile> * bestali = NULL;
 						if (options.has(Options::Affine))
-							bestali = new AlignmentAffine<double,RNA_Alphabet_Profile,RNA_Alphabet_Profile>(f1,f2,*alg_affine,topdown,anchored,local,printBT);
+							bestali = new AlignmentAffine<double,RNA_Alphabet_Profile,RNA_Alphabet_Profile>(f1,f2,*alg_affine,topdown,anchored,local,printBT,SPEEDUP,CompactTable);
 						else
-							bestali = new AlignmentLinear<double,RNA_Alphabet_Profile,RNA_Alphabet_Profile>(f1,f2,*alg,topdown,anchored,local,printBT);
+							bestali = new AlignmentLinear<double,RNA_Alphabet_Profile,RNA_Alphabet_Profile>(f1,f2,*alg,topdown,anchored,local,printBT,SPEEDUP,CompactTable);
             if (local)
                 bestScore = bestali->getLocalOptimum();
             else
@@ -298,24 +331,24 @@ void progressiveAlign(std::vector<RNAProfileAlignment*> &inputList,
                 f1 = f;
                 // x remains x !!
 								x = joinedClusterNumber;
+                pairKeys.clear();
+                pairProfiles.clear();
                 for (it=inputMapProfile.begin(); it!=inputMapProfile.end(); it++) {
-                    y = it->first;
-                    f2 = it->second;
-
-										Alignment<double,RNA_Alphabet_Profile,RNA_Alphabet_Profile> * ali = NULL;
-										if (options.has(Options::Affine))
-											ali = new AlignmentAffine<double,RNA_Alphabet_Profile,RNA_Alphabet_Profile>(f1,f2,*alg_affine,topdown,anchored,local,printBT);
-										else
-											ali = new AlignmentLinear<double,RNA_Alphabet_Profile,RNA_Alphabet_Profile>(f1,f2,*alg,topdown,anchored,local,printBT);
-                    if (local) {
-                        score_mtrx->setAt(std::min(x-1,y-1),std::max(x-1,y-1),ali->getLocalOptimum());  // min - max = fill the upper triangle
-                        std::cout << std::min(x,y) << "," << std::max(x,y) << ": " << ali->getLocalOptimum() <<  std::endl;
-                    } 
-										else {
-                        score_mtrx->setAt(std::min(x-1,y-1),std::max(x-1,y-1),ali->getGlobalOptimumRelative());  // min - max = fill the upper triangle
-                        std::cout << std::min(x,y) << "," << std::max(x,y) << ": " << ali->getGlobalOptimumRelative() <<  std::endl;
-                    }
-										delete ali;
+                    pairKeys.push_back(std::make_pair(x,it->first));
+                    pairProfiles.push_back(std::make_pair(f1,it->second));
+                }
+
+                pairScores.resize(pairKeys.size());
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(threads)
+#endif
+                for (long k=0; k<(long)pairKeys.size(); k++)
+                    pairScores[k] = pairwiseScore(pairProfiles[k].first,pairProfiles[k].second,alg,alg_affine,topdown,anchored,local,printBT);
+
+                for (unsigned long k=0; k<pairKeys.size(); k++) {
+                    y = pairKeys[k].second;
+                    score_mtrx->setAt(std::min(x-1,y-1),std::max(x-1,y-1),pairScores[k]);  // min - max = fill the upper triangle
+                    std::cout << std::min(x,y) << "," << std::max(x,y) << ": " << pairScores[k] <<  std::endl;
                 }
                 std::cout << std::endl;
 
@@ -14,21 +14,22 @@ extern "C" {
 
 using namespace std;
 
-// global priority queue for stuff in flooding (does not hold memory - memory is in hash)
-priority_queue<struct_en*, vector<struct_en*>, comps_entries_rev> neighs;
-priority_queue<Structure*, vector<Structure*>, comps_entries_rev> neighs2;
-int energy_lvl;
-bool debugg;
-int top_lvl;
-int min_lvl;
-bool minh_total;
-bool found_exit;
-// hash for the flooding
-unordered_set<struct_en*, hash_fncts, hash_eq> hash_flood (HASHSIZE);
-unordered_set<struct_en*, hash_fncts, hash_eq>::iterator it_hash;
-
-unordered_set<Structure*, hash_fncts, hash_eq> hash_flood2 (HASHSIZE);
-unordered_set<Structure*, hash_fncts, hash_eq>::iterator it_hash2;
+// flooding state is kept per thread, so several basins can be flooded in parallel (see --jobs)
+// priority queue for stuff in flooding (does not hold memory - memory is in hash)
+static thread_local priority_queue<struct_en*, vector<struct_en*>, comps_entries_rev> neighs;
+static thread_local priority_queue<Structure*, vector<Structure*>, comps_entries_rev> neighs2;
+static thread_local int energy_lvl;
+static thread_local bool debugg;
+static thread_local int top_lvl;
+static thread_local int min_lvl;
+static thread_local bool minh_total;
+static thread_local bool found_exit;
+// hash for the flooding (holds at most floodMax structures)
+static thread_local unordered_set<struct_en*, hash_fncts, hash_eq> hash_flood;
+static thread_local unordered_set<struct_en*, hash_fncts, hash_eq>::iterator it_hash;
+
+static thread_local unordered_set<Structure*, hash_fncts, hash_eq> hash_flood2;
+static thread_local unordered_set<Structure*, hash_fncts, hash_eq>::iterator it_hash2;
 
 
 void copy_se(struct_en *dest, const struct_en *src) {
@@ -160,10 +161,6 @@ struct_en* flood(const struct_en &he, SeqInfo &sqi, int &saddle_en, int maxh, bo
 
   struct_en *res = NULL;
 
-  // save deg.first + create deg
-  bool first = Opt.first;
-  Opt.first = true;
-
   // if minh specified, assign top_lvl and flood_total
   if (maxh>0) {
     top_lvl = he.energy + maxh;
@@ -293,9 +290,6 @@ struct_en* flood(const struct_en &he, SeqInfo &sqi, int &saddle_en, int maxh, bo
     free_hash(hash_flood);
   }  /// #### END OF PKNOTS BRANCH
 
-  // restore deg options
-  Opt.first = first;
-
   // return found? structure
   return res;
 }
@@ -7,6 +7,10 @@
 
 #include <stack>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 extern "C" {
   #include "pair_mat.h"
   #include "fold.h"
@@ -106,6 +110,11 @@ int Options::Init(gengetopt_args_info &args_info)
     ret = -1;
   }
 
+  if (args_info.jobs_arg<0) {
+    fprintf(stderr, "Number of threads should be non-negative integer (jobs)\n");
+    ret = -1;
+  }
+
   if (ret ==-1) return -1;
 
   // adjust options
@@ -120,6 +129,21 @@ int Options::Init(gengetopt_args_info &args_info)
   pknots = args_info.pseudoknots_flag;
   neighs = args_info.neighborhood_flag;
 
+  // parallel processing
+#ifdef _OPENMP
+  threads = (args_info.jobs_arg == 0 ? omp_get_num_procs() : args_info.jobs_arg);
+#else
+  threads = 1;
+  if (args_info.jobs_arg != 1) {
+    fprintf(stderr, "WARNING: RNAlocmin was compiled without OpenMP support, using only one thread\n");
+  }
+#endif
+  if (threads > 1 && (pknots || neighs || rand)) {
+    // pseudoknot energy evaluation, neighborhood routines and random walks share global state
+    fprintf(stderr, "WARNING: --jobs cannot be combined with pseudoknots (-k), neighborhood routines (-N), or random walk (-w R), using only one thread\n");
+    threads = 1;
+  }
+
   return ret;
 }
 
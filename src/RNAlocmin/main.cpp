@@ -12,6 +12,10 @@
 #include <algorithm>
 #include <memory>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 extern "C" {
   #include "fold.h"
   #include "findpath.h"
@@ -104,7 +108,9 @@ struct barr_info { // info taken from barriers
 
 // functions that are down in file ;-)
 char *read_seq(char *seq_arg, char **name_out);
+int read_structure(struct_en &str, SeqInfo &sqi);
 int move(unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> &structs, map<struct_en, int, comps_entries> &output, set<struct_en, comps_entries> &output_shallow, SeqInfo &sqi, bool pure_output);
+int move_batch(unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> &structs, map<struct_en, int, comps_entries> &output, SeqInfo &sqi, bool pure_output, int batch_size, int find_num, int &not_canonical);
 char *read_previous(char *previous, map<struct_en, int, comps_entries> &output);
 char *read_barr(char *previous, map<struct_en, barr_info, comps_entries> &output);
 
@@ -212,7 +218,17 @@ int main(int argc, char **argv)
 
     // hash
     unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> structs (HASHSIZE); // structures to minima map
-    while ((!args_info.find_num_given || count != args_info.find_num_arg) && !args_info.just_read_flag) {
+    if (Opt.threads > 1) {
+      // parallel gradient walks on batches of input structures
+      while ((!args_info.find_num_given || count != args_info.find_num_arg) && !args_info.just_read_flag) {
+        int res = move_batch(structs, output, sqi, args_info.just_output_flag, 1000*Opt.threads, args_info.find_num_given ? args_info.find_num_arg : 0, not_canonical);
+        count = output.size();
+
+        if (Opt.verbose_lvl>0) fprintf(stderr, "processed %d, minima %d, time %f secs.\n", num_moves, count, (clock()-clck1)/(double)CLOCKS_PER_SEC);
+
+        if (res==-1) break;
+      }
+    } else while ((!args_info.find_num_given || count != args_info.find_num_arg) && !args_info.just_read_flag) {
       int res = move(structs, output, output_shallow, sqi, args_info.just_output_flag);
 
       // print out
@@ -273,16 +289,37 @@ int main(int argc, char **argv)
     // threshold for flooding
     int threshold;
 
+    // minima sorted by energy
+    vector<map<struct_en, int, comps_entries>::iterator> minima;
+    for (map<struct_en, int, comps_entries>::iterator it=output.begin(); it!=output.end(); it++) {
+      minima.push_back(it);
+    }
+    // escapes from flooding (--minh), computed in parallel ahead of the loop below
+    vector<struct_en*> escapes(minima.size(), NULL);
+    int flooded_upto = 0;
+
     int i=0;
     int ii=0;
-    for (map<struct_en, int, comps_entries>::iterator it=output.begin(); it!=output.end(); it++) {
+    for (int m=0; m<(int)minima.size(); m++) {
+      map<struct_en, int, comps_entries>::iterator it = minima[m];
       ii++;
       // if not enough minima
       if (i<num) {
         // first check if the output is not shallow
         if (Opt.minh>0) {
-          int saddle;
-          struct_en *escape = flood(it->first, sqi, saddle, Opt.minh, args_info.pseudoknots_flag, !args_info.minh_lite_flag);
+          if (m >= flooded_upto) {
+            // all of the next (num-i) minima will be checked, so flood them at once
+            int upto = min((int)minima.size(), m + max(num - i, Opt.threads));
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(Opt.threads)
+#endif
+            for (int k=m; k<upto; k++) {
+              int saddle;
+              escapes[k] = flood(minima[k]->first, sqi, saddle, Opt.minh, args_info.pseudoknots_flag, !args_info.minh_lite_flag);
+            }
+            flooded_upto = upto;
+          }
+          struct_en *escape = escapes[m];
 
           if (args_info.verbose_lvl_arg>0 && ii%100 == 0) {
             fprintf(stderr, "non-shallow remained: %d / %d; time: %.2f secs.\n", i, ii, (clock()-clck1)/(double)CLOCKS_PER_SEC);
@@ -311,9 +348,14 @@ int main(int argc, char **argv)
         if (allegiance) LM_to_LMnum[it->first] = i;
 
       } else { // we have enough minima
+        if (escapes[m]) {
+          free(escapes[m]->structure);
+          free(escapes[m]);
+        }
         free(it->first.structure);
       }
     }
+    minima.clear();
     output.clear();
 
     // allegiance:
@@ -382,55 +424,72 @@ int main(int argc, char **argv)
       int flooded = 0;
       // init union-findset
       init_union(num);
-      // first try to flood the highest bins
+      // first try to flood the highest bins (flood only if low number of walks ended there)
+      vector<int> to_flood;
       for (int i=num-1; i>=0; i--) {
-        // flood only if low number of walks ended there
-        if (output_num[i]<=threshold && Opt.floodMax>0) {
-          //copy_arr(Enc.pt, output_he[i].structure);
-          if (args_info.verbose_lvl_arg>2) fprintf(stderr,   "flooding  (%3d): %s %.2f\n", i+1, output_str[i].c_str(), output_he[i].energy/100.0);
-
-          int saddle;
-          struct_en *he = flood(output_he[i], sqi, saddle, Opt.minh, args_info.pseudoknots_flag);
-
-          // print info
-          if (args_info.verbose_lvl_arg>1) {
-            if (he) {
-              fprintf(stderr, "below     (%3d): %s %.2f\n"
-                              "en: %7.2f  is: %s %.2f\n", i,
-                      output_str[i].c_str(), output_he[i].energy/100.0, saddle/100.0,
-                      pt_to_str_pk(he->structure).c_str(), he->energy/100.0);
-            } else {
-              fprintf(stderr, "unsucesful(%3d): %s %.2f\n", i,
-                      output_str[i].c_str(), output_he[i].energy/100.0);
-            }
-          }
-          // if flood succesfull - walk down to find father minima
+        if (output_num[i]<=threshold && Opt.floodMax>0) to_flood.push_back(i);
+      }
+      vector<struct_en*> flood_he(to_flood.size(), NULL);
+      vector<int> flood_saddle(to_flood.size(), 0);
+
+      // flood the basins and walk down from the escapes in parallel
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(Opt.threads)
+#endif
+      for (int k=0; k<(int)to_flood.size(); k++) {
+        int i = to_flood[k];
+        //copy_arr(Enc.pt, output_he[i].structure);
+        if (args_info.verbose_lvl_arg>2) fprintf(stderr,   "flooding  (%3d): %s %.2f\n", i+1, output_str[i].c_str(), output_he[i].energy/100.0);
+
+        int &saddle = flood_saddle[k];
+        struct_en *he = flood(output_he[i], sqi, saddle, Opt.minh, args_info.pseudoknots_flag);
+
+        // print info
+        if (args_info.verbose_lvl_arg>1) {
           if (he) {
-            // walk down
-            move_set(*he, sqi);
+            fprintf(stderr, "below     (%3d): %s %.2f\n"
+                            "en: %7.2f  is: %s %.2f\n", i,
+                    output_str[i].c_str(), output_he[i].energy/100.0, saddle/100.0,
+                    pt_to_str_pk(he->structure).c_str(), he->energy/100.0);
+          } else {
+            fprintf(stderr, "unsucesful(%3d): %s %.2f\n", i,
+                    output_str[i].c_str(), output_he[i].energy/100.0);
+          }
+        }
+
+        // if flood succesfull - walk down to find father minima
+        if (he) move_set(*he, sqi);
+        flood_he[k] = he;
+      }
 
-            // now check if we have the minimum already (hopefuly yes ;-) )
-            vector<struct_en>::iterator it;
-            it = lower_bound(output_he.begin(), output_he.end(), *he, compf_entries2);
+      // join the flooded basins with their fathers in the original order
+      for (int k=0; k<(int)to_flood.size(); k++) {
+        int i = to_flood[k];
+        int saddle = flood_saddle[k];
+        struct_en *he = flood_he[k];
 
-            if (args_info.verbose_lvl_arg>1) fprintf(stderr, "minimum: %s %.2f\n", pt_to_str_pk(he->structure).c_str(), he->energy/100.0);
-            // we dont need it again
+        if (he) {
+          // now check if we have the minimum already (hopefuly yes ;-) )
+          vector<struct_en>::iterator it;
+          it = lower_bound(output_he.begin(), output_he.end(), *he, compf_entries2);
 
-            hash_eq heq;
-            if (it!=output_he.end() && heq(&*it, he)) {
-              int pos = (int)(it-output_he.begin());
-              if (args_info.verbose_lvl_arg>1) fprintf(stderr, "found father at pos: %d\n", pos);
+          if (args_info.verbose_lvl_arg>1) fprintf(stderr, "minimum: %s %.2f\n", pt_to_str_pk(he->structure).c_str(), he->energy/100.0);
+          // we dont need it again
 
-              flooded++;
-              energy_barr[i*num+pos] = energy_barr[pos*num+i] = saddle/100.0;
+          hash_eq heq;
+          if (it!=output_he.end() && heq(&*it, he)) {
+            int pos = (int)(it-output_he.begin());
+            if (args_info.verbose_lvl_arg>1) fprintf(stderr, "found father at pos: %d\n", pos);
 
-              // union set
-              //fprintf(stderr, "join: %d %d\n", min(i, pos), max(i, pos));
-              union_set(min(i, pos), max(i, pos));
-            }
-            free(he->structure);
-            free(he);
+            flooded++;
+            energy_barr[i*num+pos] = energy_barr[pos*num+i] = saddle/100.0;
+
+            // union set
+            //fprintf(stderr, "join: %d %d\n", min(i, pos), max(i, pos));
+            union_set(min(i, pos), max(i, pos));
           }
+          free(he->structure);
+          free(he);
         }
       }
 
@@ -453,20 +512,30 @@ int main(int argc, char **argv)
         fprintf(stderr, "\n");
       }
 
-      // findpath:
+      // findpath (pairs are independent, so compute them in parallel):
+      vector<pair<int, int> > findpath_pairs;
       for (set<int>::iterator it=to_findpath.begin(); it!=to_findpath.end(); it++) {
         set<int>::iterator it2=it;
         it2++;
         for (; it2!=to_findpath.end(); it2++) {
-          if (args_info.pseudoknots_flag) energy_barr[(*it2)*num+(*it)] = energy_barr[(*it)*num+(*it2)] = find_saddle_pk(seq, output_str[*it].c_str(), output_str[*it2].c_str(), args_info.depth_arg)/100.0;
-          else energy_barr[(*it2)*num+(*it)] = energy_barr[(*it)*num+(*it2)] = find_saddle(seq, output_str[*it].c_str(), output_str[*it2].c_str(), args_info.depth_arg)/100.0;
-          findpath_barr[(*it2)*num+(*it)] = findpath_barr[(*it)*num+(*it2)] = true;
-          if (args_info.verbose_lvl_arg>0 && findpath %10000==0){
-            fprintf(stderr, "Findpath:%7d/%7d\n", findpath, (int)(to_findpath.size()*(to_findpath.size()-1)/2));
-          }
-          findpath++;
+          findpath_pairs.push_back(make_pair(*it, *it2));
+        }
+      }
+
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(Opt.threads)
+#endif
+      for (int k=0; k<(int)findpath_pairs.size(); k++) {
+        int a = findpath_pairs[k].first;
+        int b = findpath_pairs[k].second;
+        if (args_info.pseudoknots_flag) energy_barr[b*num+a] = energy_barr[a*num+b] = find_saddle_pk(seq, output_str[a].c_str(), output_str[b].c_str(), args_info.depth_arg)/100.0;
+        else energy_barr[b*num+a] = energy_barr[a*num+b] = find_saddle(seq, output_str[a].c_str(), output_str[b].c_str(), args_info.depth_arg)/100.0;
+        findpath_barr[b*num+a] = findpath_barr[a*num+b] = true;
+        if (args_info.verbose_lvl_arg>0 && k %10000==0){
+          fprintf(stderr, "Findpath:%7d/%7d\n", k, (int)findpath_pairs.size());
         }
       }
+      findpath = findpath_pairs.size();
 
       // debug output
       if (args_info.verbose_lvl_arg>2) {
@@ -834,7 +903,8 @@ char *read_seq(char *seq_arg, char **name_out)
 }
 
 
-int move(unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> &structs, map<struct_en, int, comps_entries> &output, set<struct_en, comps_entries> &output_shallow, SeqInfo &sqi, bool pure_output)
+// read one structure from stdin - returns -1 at the end of input, 0 if the line should be skipped, 1 otherwise
+int read_structure(struct_en &str, SeqInfo &sqi)
 {
   // read a line
   char *line = my_getline(stdin);
@@ -893,7 +963,6 @@ int move(unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> &structs, map<
   }
 
   // make make_pair
-  struct_en str;
   str.structure = Opt.pknots? make_pair_table_PK(p):make_pair_table(p);
 
   // only H,K,L,M types allowed:
@@ -905,6 +974,15 @@ int move(unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> &structs, map<
     free(line);
   }
 
+  return 1;
+}
+
+int move(unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> &structs, map<struct_en, int, comps_entries> &output, set<struct_en, comps_entries> &output_shallow, SeqInfo &sqi, bool pure_output)
+{
+  struct_en str;
+  int res = read_structure(str, sqi);
+  if (res != 1) return res;
+
   // if pure, just do descend and print it:
   if (pure_output) {
     //is it canonical (noLP)
@@ -1006,3 +1084,122 @@ int move(unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> &structs, map<
 
   return 1;
 }
+
+// one input structure of a batch (see move_batch())
+struct batch_item {
+  struct_en str;    // input structure, after the descent its local minimum
+  struct_en old;    // copy of the input structure (key in structs), NULL if not walked
+  gw_struct *lm;    // entry in structs (already seen or reserved for this structure)
+  int res;          // outcome as returned by move()
+  int gw_length;    // length of the gradient walk (for pure output)
+};
+
+// read up to batch_size structures, descend them in parallel and merge the minima in input order,
+// so the results equal the ones of repeated move() calls. Stops once find_num minima are found (0 = unlimited).
+// returns -1 at the end of input (or if enough minima were found), 1 otherwise
+int move_batch(unordered_map<struct_en, gw_struct, hash_fncts, hash_eq> &structs, map<struct_en, int, comps_entries> &output, SeqInfo &sqi, bool pure_output, int batch_size, int find_num, int &not_canonical)
+{
+  vector<batch_item> batch;
+  batch.reserve(batch_size);
+  int ret = 1;
+
+  // read structures and sort out the ones we have seen already (serially)
+  while ((int)batch.size() < batch_size) {
+    batch_item bi;
+    bi.old.structure = NULL;
+    bi.lm = NULL;
+    bi.gw_length = 0;
+    bi.res = read_structure(bi.str, sqi);
+    if (bi.res == -1) {
+      ret = -1;
+      break;
+    }
+    if (bi.res == 0) continue;
+
+    unordered_map<struct_en, gw_struct, hash_fncts, hash_eq>::iterator it_s;
+    if (!pure_output && (it_s = structs.find(bi.str)) != structs.end()) {
+      bi.lm = &it_s->second;
+      bi.res = 0;
+    } else if (Opt.noLP && find_lone_pair(bi.str.structure)!=-1) {
+      bi.res = -2;
+    } else if (!pure_output) {
+      bi.old = bi.str;
+      bi.str.structure = allocopy(bi.str.structure);
+      // reserve the entry, so repeated structures within this batch are found too
+      bi.lm = &structs[bi.old];
+    }
+    batch.push_back(bi);
+  }
+
+  // descend (in parallel)
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic) num_threads(Opt.threads)
+#endif
+  for (int i=0; i<(int)batch.size(); i++) {
+    if (batch[i].res == 1) batch[i].gw_length = move_set(batch[i].str, sqi);
+  }
+
+  // merge the minima in input order
+  bool done = false;
+  for (int i=0; i<(int)batch.size(); i++) {
+    batch_item &bi = batch[i];
+
+    if (done) {
+      // enough minima found - forget the rest of the batch
+      if (bi.old.structure) {
+        structs.erase(bi.old);
+        free(bi.old.structure);
+      }
+      free(bi.str.structure);
+      continue;
+    }
+
+    switch (bi.res) {
+      case 0:
+        bi.lm->count++;
+        free(bi.str.structure);
+        break;
+
+      case -2:
+        if (allegiance && !pure_output) structures.push_back(bi.str);
+        if (Opt.verbose_lvl>0) fprintf(stderr, "WARNING: structure \"%s\" has lone pairs, skipping...\n", pt_to_str_pk(bi.str.structure).c_str());
+        free(bi.str.structure);
+        not_canonical++;
+        break;
+
+      case 1:
+        if (pure_output) {
+          printf("%s %6.2f %4d\n", pt_to_str_pk(bi.str.structure).c_str(), bi.str.energy/100.0, bi.gw_length);
+          free(bi.str.structure);
+          break;
+        }
+
+        // allegiance hack:
+        if (allegiance) structures.push_back(bi.old);
+
+        bi.lm->count = 1;
+
+        // save for output
+        map<struct_en, int, comps_entries>::iterator it;
+        if ((it = output.find(bi.str)) != output.end()) {
+          it->second++;
+          bi.lm->he = it->first;
+          free(bi.str.structure);
+          // allegiance hack:
+          if (allegiance) str_to_LM[bi.old] = it->first;
+        } else {
+          bi.lm->he = bi.str;
+          output.insert(make_pair(bi.str, 1));
+          // allegiance hack:
+          if (allegiance) str_to_LM[bi.old] = bi.str;
+          if (find_num > 0 && (int)output.size() == find_num) {
+            done = true;
+            ret = -1;
+          }
+        }
+        break;
+    }
+  }
+
+  return ret;
+}
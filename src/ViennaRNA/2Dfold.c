@@ -15,6 +15,7 @@
 #include <ctype.h>
 #include <string.h>
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/alphabet.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/fold.h"
@@ -25,6 +26,9 @@
 #endif
 #include "ViennaRNA/2Dfold.h"
 
+/* round up a memory offset such that it is suitably aligned for any (k,l) array entry */
+#define POOL_ALIGN(size)  (((size) + sizeof(double) - 1) & ~(sizeof(double) - 1))
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -105,16 +109,22 @@ backtrack_m2(unsigned int         i,
              vrna_fold_compound_t *vc);
 
 
+PRIVATE INLINE void *
+pool_alloc(vrna_arena_t pool,
+           size_t       size);
+
+
 PRIVATE void
-adjustArrayBoundaries(int ***array,
-                      int *k_min,
-                      int *k_max,
-                      int **l_min,
-                      int **l_max,
-                      int k_min_real,
-                      int k_max_real,
-                      int *l_min_real,
-                      int *l_max_real);
+adjustArrayBoundaries(vrna_arena_t  pool,
+                      int           ***array,
+                      int           *k_min,
+                      int           *k_max,
+                      int           **l_min,
+                      int           **l_max,
+                      int           k_min_real,
+                      int           k_max_real,
+                      int           *l_min_real,
+                      int           *l_max_real);
 
 
 INLINE PRIVATE void
@@ -747,7 +757,8 @@ mfe_linear(vrna_fold_compound_t *vc)
         }
 
         /* resize and move memory portions of energy matrix E_C */
-        adjustArrayBoundaries(&matrices->E_C[ij],
+        adjustArrayBoundaries(matrices->pool_2D,
+                              &matrices->E_C[ij],
                               &matrices->k_min_C[ij],
                               &matrices->k_max_C[ij],
                               &matrices->l_min_C[ij],
@@ -1137,7 +1148,8 @@ mfe_linear(vrna_fold_compound_t *vc)
 
       /* thats all folks for the multiloop decomposition... */
 
-      adjustArrayBoundaries(&matrices->E_M[ij],
+      adjustArrayBoundaries(matrices->pool_2D,
+                            &matrices->E_M[ij],
                             &matrices->k_min_M[ij],
                             &matrices->k_max_M[ij],
                             &matrices->l_min_M[ij],
@@ -1148,7 +1160,8 @@ mfe_linear(vrna_fold_compound_t *vc)
                             max_l_real_m
                             );
 
-      adjustArrayBoundaries(&matrices->E_M1[ij],
+      adjustArrayBoundaries(matrices->pool_2D,
+                            &matrices->E_M1[ij],
                             &matrices->k_min_M1[ij],
                             &matrices->k_max_M1[ij],
                             &matrices->l_min_M1[ij],
@@ -1169,13 +1182,13 @@ mfe_linear(vrna_fold_compound_t *vc)
 
   /* prepare first entries in E_F5 */
   for (cnt1 = 1; cnt1 <= turn + 1; cnt1++) {
-    matrices->E_F5[cnt1]        = (int **)vrna_alloc(sizeof(int *));
-    matrices->E_F5[cnt1][0]     = (int *)vrna_alloc(sizeof(int));
+    matrices->E_F5[cnt1]        = (int **)pool_alloc(matrices->pool_2D, sizeof(int *));
+    matrices->E_F5[cnt1][0]     = (int *)pool_alloc(matrices->pool_2D, sizeof(int));
     matrices->E_F5[cnt1][0][0]  = 0;
     matrices->E_F5_rem[cnt1]    = INF;
     matrices->k_min_F5[cnt1]    = matrices->k_max_F5[cnt1] = 0;
-    matrices->l_min_F5[cnt1]    = (int *)vrna_alloc(sizeof(int));
-    matrices->l_max_F5[cnt1]    = (int *)vrna_alloc(sizeof(int));
+    matrices->l_min_F5[cnt1]    = (int *)pool_alloc(matrices->pool_2D, sizeof(int));
+    matrices->l_max_F5[cnt1]    = (int *)pool_alloc(matrices->pool_2D, sizeof(int));
     matrices->l_min_F5[cnt1][0] = matrices->l_max_F5[cnt1][0] = 0;
 #ifdef COUNT_STATES
     matrices->N_F5[cnt1]        = (unsigned long **)vrna_alloc(sizeof(unsigned long *));
@@ -1384,7 +1397,8 @@ mfe_linear(vrna_fold_compound_t *vc)
     }
 
     /* resize and move memory portions of energy matrix E_F5 */
-    adjustArrayBoundaries(&matrices->E_F5[j],
+    adjustArrayBoundaries(matrices->pool_2D,
+                          &matrices->E_F5[j],
                           &matrices->k_min_F5[j],
                           &matrices->k_max_F5[j],
                           &matrices->l_min_F5[j],
@@ -1398,14 +1412,30 @@ mfe_linear(vrna_fold_compound_t *vc)
 
 
   if (compute_2Dfold_F3) {
+    /*
+     *  the matrices are created without the 3' arrays, since they are
+     *  only required if this global switch is active
+     */
+    if (!matrices->E_F3) {
+      matrices->E_F3      = (int ***)vrna_alloc(sizeof(int **) * (seq_length + 2));
+      matrices->l_min_F3  = (int **)vrna_alloc(sizeof(int *) * (seq_length + 2));
+      matrices->l_max_F3  = (int **)vrna_alloc(sizeof(int *) * (seq_length + 2));
+      matrices->k_min_F3  = (int *)vrna_alloc(sizeof(int) * (seq_length + 2));
+      matrices->k_max_F3  = (int *)vrna_alloc(sizeof(int) * (seq_length + 2));
+      matrices->E_F3_rem  = (int *)vrna_alloc(sizeof(int) * (seq_length + 2));
+      for (cnt1 = 0; cnt1 <= seq_length; cnt1++)
+        matrices->E_F3_rem[cnt1] = INF;
+    }
+
     /* prepare first entries in E_F3 */
     for (cnt1 = seq_length; cnt1 >= seq_length - turn - 1; cnt1--) {
-      matrices->E_F3[cnt1]        = (int **)vrna_alloc(sizeof(int *));
-      matrices->E_F3[cnt1][0]     = (int *)vrna_alloc(sizeof(int));
+      matrices->E_F3[cnt1]        = (int **)pool_alloc(matrices->pool_2D, sizeof(int *));
+      matrices->E_F3[cnt1][0]     = (int *)pool_alloc(matrices->pool_2D, sizeof(int));
       matrices->E_F3[cnt1][0][0]  = 0;
+      matrices->E_F3_rem[cnt1]    = INF;
       matrices->k_min_F3[cnt1]    = matrices->k_max_F3[cnt1] = 0;
-      matrices->l_min_F3[cnt1]    = (int *)vrna_alloc(sizeof(int));
-      matrices->l_max_F3[cnt1]    = (int *)vrna_alloc(sizeof(int));
+      matrices->l_min_F3[cnt1]    = (int *)pool_alloc(matrices->pool_2D, sizeof(int));
+      matrices->l_max_F3[cnt1]    = (int *)pool_alloc(matrices->pool_2D, sizeof(int));
       matrices->l_min_F3[cnt1][0] = matrices->l_max_F3[cnt1][0] = 0;
     }
     /* begin calculations */
@@ -1457,26 +1487,38 @@ mfe_linear(vrna_fold_compound_t *vc)
                    matrices->l_min_F3[j],
                    matrices->l_max_F3[j]
                    );
-      /* begin the actual computation of 5' end energies */
+      /* begin the actual computation of 3' end energies */
 
       /* j is unpaired ... */
+      matrices->E_F3_rem[j] = matrices->E_F3_rem[j + 1];
       for (cnt1 = matrices->k_min_F3[j + 1]; cnt1 <= matrices->k_max_F3[j + 1]; cnt1++) {
         for (cnt2 = matrices->l_min_F3[j + 1][cnt1]; cnt2 <= matrices->l_max_F3[j + 1][cnt1];
              cnt2 += 2) {
-          matrices->E_F3[j][cnt1 + da][(cnt2 + db) /
-                                       2] = MIN2(matrices->E_F3[j][cnt1 + da][(cnt2 + db) / 2],
-                                                 matrices->E_F3[j + 1][cnt1][cnt2 / 2]
-                                                 );
-          updatePosteriorBoundaries(cnt1 + da,
-                                    cnt2 + db,
-                                    &min_k_real,
-                                    &max_k_real,
-                                    &min_l_real,
-                                    &max_l_real
-                                    );
+          if (((cnt1 + da) <= maxD1) && ((cnt2 + db) <= maxD2)) {
+            matrices->E_F3[j][cnt1 + da][(cnt2 + db) /
+                                         2] = MIN2(matrices->E_F3[j][cnt1 + da][(cnt2 + db) / 2],
+                                                   matrices->E_F3[j + 1][cnt1][cnt2 / 2]
+                                                   );
+            updatePosteriorBoundaries(cnt1 + da,
+                                      cnt2 + db,
+                                      &min_k_real,
+                                      &max_k_real,
+                                      &min_l_real,
+                                      &max_l_real
+                                      );
+          }
+          /* collect all cases where da+cnt1 or db+cnt2 exceeds maxD1, maxD2, respectively */
+          else {
+            matrices->E_F3_rem[j] =
+              MIN2(matrices->E_F3_rem[j], matrices->E_F3[j + 1][cnt1][cnt2 / 2]);
+          }
         }
       }
       /* j pairs with n */
+      if (matrices->E_C_rem[my_iindx[j] - seq_length] != INF)
+        matrices->E_F3_rem[j] = MIN2(matrices->E_F3_rem[j],
+                                     matrices->E_C_rem[my_iindx[j] - seq_length] + additional_en);
+
       if (matrices->E_C[my_iindx[j] - seq_length]) {
         for (cnt1 = matrices->k_min_C[my_iindx[j] - seq_length];
              cnt1 <= matrices->k_max_C[my_iindx[j] - seq_length]; cnt1++)
@@ -1499,59 +1541,93 @@ mfe_linear(vrna_fold_compound_t *vc)
       }
 
       /* j pairs with some other nucleotide -> see below */
-      for (i = j - turn - 1; i > 1; i--) {
-        ij = my_iindx[i] - j;
-        if (!matrices->E_C[ij])
-          continue;
-
-        type = ptype[jindx[j] + i];
+      for (i = j + turn + 1; i < seq_length; i++) {
+        ij    = my_iindx[j] - i;
+        type  = ptype[jindx[i] + j];
         if (type) {
-          unsigned int  d1a = referenceBPs1[my_iindx[1] - j] - referenceBPs1[ij] -
-                              referenceBPs1[my_iindx[1] - i + 1];
-          unsigned int  d1b = referenceBPs2[my_iindx[1] - j] - referenceBPs2[ij] -
-                              referenceBPs2[my_iindx[1] - i + 1];
-
           if (dangles == 2)
-            additional_en = vrna_E_ext_stem(type, S1[i - 1], j < seq_length ? S1[j + 1] : -1, P);
+            additional_en = vrna_E_ext_stem(type, j > 1 ? S1[j - 1] : -1, S1[i + 1], P);
           else
             additional_en = vrna_E_ext_stem(type, -1, -1, P);
 
+          if (matrices->E_C_rem[ij] != INF) {
+            for (cnt3 = matrices->k_min_F3[i + 1]; cnt3 <= matrices->k_max_F3[i + 1]; cnt3++)
+              for (cnt4 = matrices->l_min_F3[i + 1][cnt3]; cnt4 <= matrices->l_max_F3[i + 1][cnt3];
+                   cnt4 += 2) {
+                if (matrices->E_F3[i + 1][cnt3][cnt4 / 2] != INF) {
+                  matrices->E_F3_rem[j] = MIN2(matrices->E_F3_rem[j],
+                                               matrices->E_F3[i + 1][cnt3][cnt4 / 2] +
+                                               matrices->E_C_rem[ij] + additional_en
+                                               );
+                }
+              }
+            if (matrices->E_F3_rem[i + 1] != INF) {
+              matrices->E_F3_rem[j] = MIN2(matrices->E_F3_rem[j],
+                                           matrices->E_F3_rem[i + 1] + matrices->E_C_rem[ij] + additional_en
+                                           );
+            }
+          }
+
+          if ((matrices->E_F3_rem[i + 1] != INF) && (matrices->E_C[ij])) {
+            for (cnt1 = matrices->k_min_C[ij]; cnt1 <= matrices->k_max_C[ij]; cnt1++)
+              for (cnt2 = matrices->l_min_C[ij][cnt1]; cnt2 <= matrices->l_max_C[ij][cnt1]; cnt2 += 2)
+                if (matrices->E_C[ij][cnt1][cnt2 / 2] != INF) {
+                  matrices->E_F3_rem[j] = MIN2(matrices->E_F3_rem[j],
+                                               matrices->E_F3_rem[i + 1] +
+                                               matrices->E_C[ij][cnt1][cnt2 / 2] + additional_en
+                                               );
+                }
+          }
+
+          if (!matrices->E_C[ij])
+            continue;
+
+          unsigned int  d1a = referenceBPs1[my_iindx[j] - seq_length] - referenceBPs1[ij] -
+                              referenceBPs1[my_iindx[i + 1] - seq_length];
+          unsigned int  d1b = referenceBPs2[my_iindx[j] - seq_length] - referenceBPs2[ij] -
+                              referenceBPs2[my_iindx[i + 1] - seq_length];
+
           for (cnt1 = matrices->k_min_C[ij]; cnt1 <= matrices->k_max_C[ij]; cnt1++)
             for (cnt2 = matrices->l_min_C[ij][cnt1]; cnt2 <= matrices->l_max_C[ij][cnt1]; cnt2 += 2)
-              for (cnt3 = matrices->k_min_F5[i - 1]; cnt3 <= matrices->k_max_F5[i - 1]; cnt3++)
-                for (cnt4 =
-                       matrices->l_min_F5[i - 1][cnt3]; cnt4 <= matrices->l_max_F5[i - 1][cnt3];
+              for (cnt3 = matrices->k_min_F3[i + 1]; cnt3 <= matrices->k_max_F3[i + 1]; cnt3++)
+                for (cnt4 = matrices->l_min_F3[i + 1][cnt3];
+                     cnt4 <= matrices->l_max_F3[i + 1][cnt3];
                      cnt4 += 2) {
-                  if (matrices->E_F5[i - 1][cnt3][cnt4 / 2] != INF &&
+                  if (matrices->E_F3[i + 1][cnt3][cnt4 / 2] != INF &&
                       matrices->E_C[ij][cnt1][cnt2 / 2] != INF) {
-                    matrices->E_F5[j][cnt1 + cnt3 + d1a][(cnt2 + cnt4 + d1b) / 2] = MIN2(
-                      matrices->E_F5[j][cnt1 + cnt3 + d1a][(cnt2 + cnt4 + d1b) / 2],
-                      matrices->E_F5[
-                        i - 1][cnt3][cnt4 / 2] + matrices->E_C[ij][cnt1][cnt2 / 2] + additional_en
-                      );
-                    updatePosteriorBoundaries(cnt1 + cnt3 + d1a,
-                                              cnt2 + cnt4 + d1b,
-                                              &min_k_real,
-                                              &max_k_real,
-                                              &min_l_real,
-                                              &max_l_real
-                                              );
-#ifdef COUNT_STATES
-                    matrices->N_F5[j][cnt1 + cnt3 + d1a][(cnt2 + cnt4 + d1b) /
-                                                         2] +=
-                      matrices->N_F5[i - 1][cnt3][cnt4 / 2] * matrices->N_C[ij][cnt1][cnt2 / 2];
-#endif
+                    if (((cnt1 + cnt3 + d1a) <= maxD1) && ((cnt2 + cnt4 + d1b) <= maxD2)) {
+                      matrices->E_F3[j][cnt1 + cnt3 + d1a][(cnt2 + cnt4 + d1b) / 2] = MIN2(
+                        matrices->E_F3[j][cnt1 + cnt3 + d1a][(cnt2 + cnt4 + d1b) / 2],
+                        matrices->E_F3[
+                          i + 1][cnt3][cnt4 / 2] + matrices->E_C[ij][cnt1][cnt2 / 2] + additional_en
+                        );
+                      updatePosteriorBoundaries(cnt1 + cnt3 + d1a,
+                                                cnt2 + cnt4 + d1b,
+                                                &min_k_real,
+                                                &max_k_real,
+                                                &min_l_real,
+                                                &max_l_real
+                                                );
+                    }
+                    /* collect all cases where d1a+cnt1+cnt3 or d1b+cnt2+cnt4 exceeds maxD1, maxD2, respectively */
+                    else {
+                      matrices->E_F3_rem[j] = MIN2(matrices->E_F3_rem[j],
+                                                   matrices->E_F3[i + 1][cnt3][cnt4 / 2] +
+                                                   matrices->E_C[ij][cnt1][cnt2 / 2] + additional_en
+                                                   );
+                    }
                   }
                 }
         }
       }
 
-      /* resize and move memory portions of energy matrix E_F5 */
-      adjustArrayBoundaries(&matrices->E_F5[j],
-                            &matrices->k_min_F5[j],
-                            &matrices->k_max_F5[j],
-                            &matrices->l_min_F5[j],
-                            &matrices->l_max_F5[j],
+      /* resize and move memory portions of energy matrix E_F3 */
+      adjustArrayBoundaries(matrices->pool_2D,
+                            &matrices->E_F3[j],
+                            &matrices->k_min_F3[j],
+                            &matrices->k_max_F3[j],
+                            &matrices->l_min_F3[j],
+                            &matrices->l_max_F3[j],
                             min_k_real,
                             max_k_real,
                             min_l_real,
@@ -3366,7 +3442,8 @@ mfe_circ(vrna_fold_compound_t *vc)
     }
 
     /* resize and move memory portions of energy matrix E_M2 */
-    adjustArrayBoundaries(&matrices->E_M2[i],
+    adjustArrayBoundaries(matrices->pool_2D,
+                          &matrices->E_M2[i],
                           &matrices->k_min_M2[i],
                           &matrices->k_max_M2[i],
                           &matrices->l_min_M2[i],
@@ -3606,7 +3683,8 @@ mfe_circ(vrna_fold_compound_t *vc)
   /* end of i-j loop */
 
   /* resize and move memory portions of energy matrix E_FcH */
-  adjustArrayBoundaries(&matrices->E_FcH,
+  adjustArrayBoundaries(matrices->pool_2D,
+                        &matrices->E_FcH,
                         &matrices->k_min_FcH,
                         &matrices->k_max_FcH,
                         &matrices->l_min_FcH,
@@ -3778,7 +3856,8 @@ mfe_circ(vrna_fold_compound_t *vc)
   /* end of i-j loop */
 
   /* resize and move memory portions of energy matrix E_FcI */
-  adjustArrayBoundaries(&matrices->E_FcI,
+  adjustArrayBoundaries(matrices->pool_2D,
+                        &matrices->E_FcI,
                         &matrices->k_min_FcI,
                         &matrices->k_max_FcI,
                         &matrices->l_min_FcI,
@@ -3874,7 +3953,8 @@ mfe_circ(vrna_fold_compound_t *vc)
   }
 
   /* resize and move memory portions of energy matrix E_FcM */
-  adjustArrayBoundaries(&matrices->E_FcM,
+  adjustArrayBoundaries(matrices->pool_2D,
+                        &matrices->E_FcM,
                         &matrices->k_min_FcM,
                         &matrices->k_max_FcM,
                         &matrices->l_min_FcM,
@@ -3953,7 +4033,8 @@ mfe_circ(vrna_fold_compound_t *vc)
                             );
 
 
-  adjustArrayBoundaries(&matrices->E_Fc,
+  adjustArrayBoundaries(matrices->pool_2D,
+                        &matrices->E_Fc,
                         &matrices->k_min_Fc,
                         &matrices->k_max_Fc,
                         &matrices->l_min_Fc,
@@ -3966,94 +4047,98 @@ mfe_circ(vrna_fold_compound_t *vc)
 }
 
 
-PRIVATE void
-adjustArrayBoundaries(int ***array,
-                      int *k_min,
-                      int *k_max,
-                      int **l_min,
-                      int **l_max,
-                      int k_min_post,
-                      int k_max_post,
-                      int *l_min_post,
-                      int *l_max_post)
+PRIVATE INLINE void *
+pool_alloc(vrna_arena_t pool,
+           size_t       size)
 {
-  int cnt1;
-  int k_diff_pre  = k_min_post - *k_min;
-  int mem_size    = k_max_post - k_min_post + 1;
-
-  if (k_min_post < INF) {
-    /* free all the unused memory behind actual data */
-    for (cnt1 = k_max_post + 1; cnt1 <= *k_max; cnt1++) {
-      (*array)[cnt1] += (*l_min)[cnt1] / 2;
-      free((*array)[cnt1]);
-    }
+  void *ptr;
 
-    /* free unused memory before actual data */
-    for (cnt1 = *k_min; cnt1 < k_min_post; cnt1++) {
-      (*array)[cnt1] += (*l_min)[cnt1] / 2;
-      free((*array)[cnt1]);
-    }
-    /* move data to front and thereby eliminating unused memory in front of actual data */
-    if (k_diff_pre > 0) {
-      memmove((int **)(*array), ((int **)(*array)) + k_diff_pre, sizeof(int *) * mem_size);
-      memmove((int *)(*l_min), ((int *)(*l_min)) + k_diff_pre, sizeof(int) * mem_size);
-      memmove((int *)(*l_max), ((int *)(*l_max)) + k_diff_pre, sizeof(int) * mem_size);
-    }
+#ifdef _OPENMP
+#pragma omp critical (pool_2D)
+#endif
+  ptr = vrna_arena_alloc(pool, size);
 
-    /* reallocating memory to actual size used */
-    *array  += *k_min;
-    *array  = (int **)realloc(*array, sizeof(int *) * mem_size);
-    *array  -= k_min_post;
+  return ptr;
+}
 
-    *l_min  += *k_min;
-    *l_min  = (int *)realloc(*l_min, sizeof(int) * mem_size);
-    *l_min  -= k_min_post;
 
-    *l_max  += *k_min;
-    *l_max  = (int *)realloc(*l_max, sizeof(int) * mem_size);
-    *l_max  -= k_min_post;
+/*
+ *  Each (k,l) array of a cell that survives the boundary adjustment
+ *  is stored in a single contiguous chunk of the memory pool. The chunk
+ *  starts with the energies of all k-rows, followed by the row offset
+ *  table and the l-boundaries for each k.
+ */
+PRIVATE void
+adjustArrayBoundaries(vrna_arena_t  pool,
+                      int           ***array,
+                      int           *k_min,
+                      int           *k_max,
+                      int           **l_min,
+                      int           **l_max,
+                      int           k_min_post,
+                      int           k_max_post,
+                      int           *l_min_post,
+                      int           *l_max_post)
+{
+  char          *chunk;
+  unsigned int  start;
+  int           cnt1, shift, mem_size, k_size, *data, *l_min_new, *l_max_new, **rows;
+  size_t        size, offset_rows, offset_l;
 
-    /* adjust l dimension of array */
+  if (k_min_post < INF) {
+    k_size  = k_max_post - k_min_post + 1;
+    size    = 0;
+
+    for (cnt1 = k_min_post; cnt1 <= k_max_post; cnt1++)
+      if (l_min_post[cnt1] < INF)
+        size += (l_max_post[cnt1] - l_min_post[cnt1] + 1) / 2 + 1;
+
+    offset_rows = POOL_ALIGN(sizeof(int) * size);
+    offset_l    = offset_rows + sizeof(int *) * k_size;
+    chunk       = (char *)pool_alloc(pool, offset_l + sizeof(int) * 2 * k_size);
+    data        = (int *)chunk;
+    rows        = (int **)(chunk + offset_rows);
+    l_min_new   = (int *)(chunk + offset_l);
+    l_max_new   = l_min_new + k_size;
+
+    rows      -= k_min_post;
+    l_min_new -= k_min_post;
+    l_max_new -= k_min_post;
+
+    /* copy actual data into the pool and thereby eliminate unused memory */
     for (cnt1 = k_min_post; cnt1 <= k_max_post; cnt1++) {
       if (l_min_post[cnt1] < INF) {
         /* new memsize */
         mem_size = (l_max_post[cnt1] - l_min_post[cnt1] + 1) / 2 + 1;
-        /* reshift the pointer */
-        (*array)[cnt1] += (*l_min)[cnt1] / 2;
-
-        int shift = (l_min_post[cnt1] % 2 == (*l_min)[cnt1] % 2) ? 0 : 1;
-        /* eliminate unused memory in front of actual data */
-        unsigned int start = (l_min_post[cnt1] - (*l_min)[cnt1]) / 2 + shift;
-        if (start > 0)
-          memmove((int *)((*array)[cnt1]), (int *)((*array)[cnt1]) + start, sizeof(int) * mem_size);
 
-        (*array)[cnt1] = (int *)realloc((*array)[cnt1], sizeof(int) * mem_size);
+        shift = (l_min_post[cnt1] % 2 == (*l_min)[cnt1] % 2) ? 0 : 1;
+        start = (l_min_post[cnt1] - (*l_min)[cnt1]) / 2 + shift;
+        memcpy(data, (*array)[cnt1] + (*l_min)[cnt1] / 2 + start, sizeof(int) * mem_size);
 
-        (*array)[cnt1] -= l_min_post[cnt1] / 2;
+        rows[cnt1]  = data - l_min_post[cnt1] / 2;
+        data        += mem_size;
       } else {
-        /* free according memory */
-        (*array)[cnt1] += (*l_min)[cnt1] / 2;
-        free((*array)[cnt1]);
+        rows[cnt1] = NULL;
       }
 
-      (*l_min)[cnt1]  = l_min_post[cnt1];
-      (*l_max)[cnt1]  = l_max_post[cnt1];
+      l_min_new[cnt1] = l_min_post[cnt1];
+      l_max_new[cnt1] = l_max_post[cnt1];
     }
   } else {
-    /* we have to free all unused memory */
-    for (cnt1 = *k_min; cnt1 <= *k_max; cnt1++) {
-      (*array)[cnt1] += (*l_min)[cnt1] / 2;
-      free((*array)[cnt1]);
-    }
-    (*l_min)  += *k_min;
-    (*l_max)  += *k_min;
-    free(*l_min);
-    free(*l_max);
-    (*array) += *k_min;
-    free(*array);
-    *array = NULL;
+    rows      = NULL;
+    l_min_new = NULL;
+    l_max_new = NULL;
   }
 
+  /* release the scratch memory of the array and its prior boundaries */
+  free(*array + *k_min);
+  free(*l_min + *k_min);
+  free(*l_max + *k_min);
+
+  *array  = rows;
+  *l_min  = l_min_new;
+  *l_max  = l_max_new;
+
   l_min_post  += *k_min;
   l_max_post  += *k_min;
   free(l_min_post);
@@ -4138,6 +4223,11 @@ prepareBoundaries(int min_k_pre,
 }
 
 
+/*
+ *  Prepare a temporary (k,l) array for a single cell. All rows reside
+ *  in one block of memory right after the row table, such that the
+ *  entire array can be released at once in adjustArrayBoundaries()
+ */
 INLINE PRIVATE void
 prepareArray(int  ***array,
              int  min_k,
@@ -4145,17 +4235,24 @@ prepareArray(int  ***array,
              int  *min_l,
              int  *max_l)
 {
-  int i, j, mem;
+  int     i, j, mem, *data;
+  size_t  size, offset;
+
+  size = 0;
+  for (i = min_k; i <= max_k; i++)
+    size += (max_l[i] - min_l[i] + 1) / 2 + 1;
 
-  *array  = (int **)vrna_alloc(sizeof(int *) * (max_k - min_k + 1));
+  offset  = POOL_ALIGN(sizeof(int *) * (max_k - min_k + 1));
+  *array  = (int **)vrna_alloc(offset + sizeof(int) * size);
+  data    = (int *)((char *)(*array) + offset);
   *array  -= min_k;
 
   for (i = min_k; i <= max_k; i++) {
-    mem         = (max_l[i] - min_l[i] + 1) / 2 + 1;
-    (*array)[i] = (int *)vrna_alloc(sizeof(int) * mem);
+    mem = (max_l[i] - min_l[i] + 1) / 2 + 1;
     for (j = 0; j < mem; j++)
-      (*array)[i][j] = INF;
-    (*array)[i] -= min_l[i] / 2;
+      data[j] = INF;
+    (*array)[i] = data - min_l[i] / 2;
+    data        += mem;
   }
 }
 
@@ -4206,6 +4303,13 @@ crosslink(TwoDfold_vars *vars)
   vars->dangles       = c->params->model_details.dangles;
   vars->circ          = c->params->model_details.circ;
   vars->temperature   = c->params->model_details.temperature;
+#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
+  /* iindx-based pair types are only created on demand for this deprecated interface */
+  if (!c->ptype_pf_compat)
+    c->ptype_pf_compat = get_ptypes(c->sequence_encoding2, &(c->params->model_details), 1);
+
+#endif
+
   vars->ptype         = c->ptype_pf_compat;
   vars->P             = c->params;
   vars->S             = c->sequence_encoding2;
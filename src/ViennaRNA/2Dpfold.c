@@ -16,12 +16,16 @@
 #include <string.h>
 #include <float.h>    /* #defines FLT_MAX ... */
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/alphabet.h"
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/params/basic.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/loops/all.h"
 #include "ViennaRNA/2Dpfold.h"
 
+/* round up a memory offset such that it is suitably aligned for any (k,l) array entry */
+#define POOL_ALIGN(size)  (((size) + sizeof(double) - 1) & ~(sizeof(double) - 1))
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -113,16 +117,22 @@ backtrack_qcM(vrna_fold_compound_t  *vc,
               int                   d2);
 
 
+PRIVATE INLINE void *
+pool_alloc(vrna_arena_t pool,
+           size_t       size);
+
+
 PRIVATE void
-adjustArrayBoundaries(FLT_OR_DBL  ***array,
-                      int         *k_min,
-                      int         *k_max,
-                      int         **l_min,
-                      int         **l_max,
-                      int         k_min_real,
-                      int         k_max_real,
-                      int         *l_min_real,
-                      int         *l_max_real);
+adjustArrayBoundaries(vrna_arena_t  pool,
+                      FLT_OR_DBL    ***array,
+                      int           *k_min,
+                      int           *k_max,
+                      int           **l_min,
+                      int           **l_max,
+                      int           k_min_real,
+                      int           k_max_real,
+                      int           *l_min_real,
+                      int           *l_max_real);
 
 
 INLINE PRIVATE void
@@ -432,12 +442,12 @@ pf2D_linear(vrna_fold_compound_t *vc)
       ij                        = my_iindx[i] - j;
       matrices->k_min_Q[ij]     = 0;
       matrices->k_max_Q[ij]     = 0;
-      matrices->l_min_Q[ij]     = (int *)vrna_alloc(sizeof(int));
-      matrices->l_max_Q[ij]     = (int *)vrna_alloc(sizeof(int));
+      matrices->l_min_Q[ij]     = (int *)pool_alloc(matrices->pool_2D, sizeof(int));
+      matrices->l_max_Q[ij]     = (int *)pool_alloc(matrices->pool_2D, sizeof(int));
       matrices->l_min_Q[ij][0]  = 0;
       matrices->l_max_Q[ij][0]  = 0;
-      matrices->Q[ij]           = (FLT_OR_DBL **)vrna_alloc(sizeof(FLT_OR_DBL *));
-      matrices->Q[ij][0]        = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL));
+      matrices->Q[ij]           = (FLT_OR_DBL **)pool_alloc(matrices->pool_2D, sizeof(FLT_OR_DBL *));
+      matrices->Q[ij][0]        = (FLT_OR_DBL *)pool_alloc(matrices->pool_2D, sizeof(FLT_OR_DBL));
       matrices->Q[ij][0][0]     = 1.0 * scale[j - i + 1];
     }
 
@@ -692,7 +702,8 @@ pf2D_linear(vrna_fold_compound_t *vc)
         }
 
         if (update_b) {
-          adjustArrayBoundaries(&matrices->Q_B[ij],
+          adjustArrayBoundaries(matrices->pool_2D,
+                                &matrices->Q_B[ij],
                                 &matrices->k_min_Q_B[ij],
                                 &matrices->k_max_Q_B[ij],
                                 &matrices->l_min_Q_B[ij],
@@ -1011,7 +1022,8 @@ pf2D_linear(vrna_fold_compound_t *vc)
       }
 
       if (update_m) {
-        adjustArrayBoundaries(&matrices->Q_M[ij],
+        adjustArrayBoundaries(matrices->pool_2D,
+                              &matrices->Q_M[ij],
                               &matrices->k_min_Q_M[ij],
                               &matrices->k_max_Q_M[ij],
                               &matrices->l_min_Q_M[ij],
@@ -1024,7 +1036,8 @@ pf2D_linear(vrna_fold_compound_t *vc)
       }
 
       if (update_m1) {
-        adjustArrayBoundaries(&matrices->Q_M1[jindx[j] + i],
+        adjustArrayBoundaries(matrices->pool_2D,
+                              &matrices->Q_M1[jindx[j] + i],
                               &matrices->k_min_Q_M1[jindx[j] + i],
                               &matrices->k_max_Q_M1[jindx[j] + i],
                               &matrices->l_min_Q_M1[jindx[j] + i],
@@ -1223,7 +1236,8 @@ pf2D_linear(vrna_fold_compound_t *vc)
       }
 
       if (update_q) {
-        adjustArrayBoundaries(&matrices->Q[ij],
+        adjustArrayBoundaries(matrices->pool_2D,
+                              &matrices->Q[ij],
                               &matrices->k_min_Q[ij],
                               &matrices->k_max_Q[ij],
                               &matrices->l_min_Q[ij],
@@ -1444,7 +1458,8 @@ pf2D_circ(vrna_fold_compound_t *vc)
       }
     }
     if (update_m2) {
-      adjustArrayBoundaries(&matrices->Q_M2[k],
+      adjustArrayBoundaries(matrices->pool_2D,
+                            &matrices->Q_M2[k],
                             &matrices->k_min_Q_M2[k],
                             &matrices->k_max_Q_M2[k],
                             &matrices->l_min_Q_M2[k],
@@ -1820,7 +1835,8 @@ pf2D_circ(vrna_fold_compound_t *vc)
     }
 
   if (update_cH) {
-    adjustArrayBoundaries(&matrices->Q_cH,
+    adjustArrayBoundaries(matrices->pool_2D,
+                          &matrices->Q_cH,
                           &matrices->k_min_Q_cH,
                           &matrices->k_max_Q_cH,
                           &matrices->l_min_Q_cH,
@@ -1833,7 +1849,8 @@ pf2D_circ(vrna_fold_compound_t *vc)
   }
 
   if (update_cI) {
-    adjustArrayBoundaries(&matrices->Q_cI,
+    adjustArrayBoundaries(matrices->pool_2D,
+                          &matrices->Q_cI,
                           &matrices->k_min_Q_cI,
                           &matrices->k_max_Q_cI,
                           &matrices->l_min_Q_cI,
@@ -1920,7 +1937,8 @@ pf2D_circ(vrna_fold_compound_t *vc)
   }
 
   if (update_cM) {
-    adjustArrayBoundaries(&matrices->Q_cM,
+    adjustArrayBoundaries(matrices->pool_2D,
+                          &matrices->Q_cM,
                           &matrices->k_min_Q_cM,
                           &matrices->k_max_Q_cM,
                           &matrices->l_min_Q_cM,
@@ -2004,7 +2022,8 @@ pf2D_circ(vrna_fold_compound_t *vc)
     matrices->Q_c_rem += 1.0 * scale[seq_length];
   }
 
-  adjustArrayBoundaries(&matrices->Q_c,
+  adjustArrayBoundaries(matrices->pool_2D,
+                        &matrices->Q_c,
                         &matrices->k_min_Q_c,
                         &matrices->k_max_Q_c,
                         &matrices->l_min_Q_c,
@@ -4222,97 +4241,99 @@ backtrack_qm_early_escape:
 }
 
 
-PRIVATE void
-adjustArrayBoundaries(FLT_OR_DBL  ***array,
-                      int         *k_min,
-                      int         *k_max,
-                      int         **l_min,
-                      int         **l_max,
-                      int         k_min_post,
-                      int         k_max_post,
-                      int         *l_min_post,
-                      int         *l_max_post)
+PRIVATE INLINE void *
+pool_alloc(vrna_arena_t pool,
+           size_t       size)
 {
-  int cnt1;
-  int k_diff_pre  = k_min_post - *k_min;
-  int mem_size    = k_max_post - k_min_post + 1;
-
-  if (k_min_post < INF) {
-    /* free all the unused memory behind actual data */
-    for (cnt1 = k_max_post + 1; cnt1 <= *k_max; cnt1++) {
-      (*array)[cnt1] += (*l_min)[cnt1] / 2;
-      free((*array)[cnt1]);
-    }
+  void *ptr;
 
-    /* free unused memory before actual data */
-    for (cnt1 = *k_min; cnt1 < k_min_post; cnt1++) {
-      (*array)[cnt1] += (*l_min)[cnt1] / 2;
-      free((*array)[cnt1]);
-    }
-    /* move data to front and thereby eliminating unused memory in front of actual data */
-    if (k_diff_pre > 0) {
-      memmove((FLT_OR_DBL **)(*array),
-              ((FLT_OR_DBL **)(*array)) + k_diff_pre,
-              sizeof(FLT_OR_DBL *) * mem_size);
-      memmove((int *)(*l_min), ((int *)(*l_min)) + k_diff_pre, sizeof(int) * mem_size);
-      memmove((int *)(*l_max), ((int *)(*l_max)) + k_diff_pre, sizeof(int) * mem_size);
-    }
-
-    /* reallocating memory to actual size used */
-    *array  += *k_min;
-    *array  = (FLT_OR_DBL **)realloc(*array, sizeof(FLT_OR_DBL *) * mem_size);
-    *array  -= k_min_post;
+#ifdef _OPENMP
+#pragma omp critical (pool_2D)
+#endif
+  ptr = vrna_arena_alloc(pool, size);
 
-    *l_min  += *k_min;
-    *l_min  = (int *)realloc(*l_min, sizeof(int) * mem_size);
-    *l_min  -= k_min_post;
+  return ptr;
+}
 
-    *l_max  += *k_min;
-    *l_max  = (int *)realloc(*l_max, sizeof(int) * mem_size);
-    *l_max  -= k_min_post;
 
+/*
+ *  Each (k,l) array of a cell that survives the boundary adjustment
+ *  is stored in a single contiguous chunk of the memory pool. The chunk
+ *  starts with the partition functions of all k-rows, followed by the
+ *  row offset table and the l-boundaries for each k.
+ */
+PRIVATE void
+adjustArrayBoundaries(vrna_arena_t  pool,
+                      FLT_OR_DBL    ***array,
+                      int           *k_min,
+                      int           *k_max,
+                      int           **l_min,
+                      int           **l_max,
+                      int           k_min_post,
+                      int           k_max_post,
+                      int           *l_min_post,
+                      int           *l_max_post)
+{
+  char          *chunk;
+  unsigned int  start;
+  int           cnt1, shift, mem_size, k_size, *l_min_new, *l_max_new;
+  size_t        size, offset_rows, offset_l;
+  FLT_OR_DBL    *data, **rows;
 
+  if (k_min_post < INF) {
+    k_size  = k_max_post - k_min_post + 1;
+    size    = 0;
+
+    for (cnt1 = k_min_post; cnt1 <= k_max_post; cnt1++)
+      if (l_min_post[cnt1] < INF)
+        size += (l_max_post[cnt1] - l_min_post[cnt1] + 1) / 2 + 1;
+
+    offset_rows = POOL_ALIGN(sizeof(FLT_OR_DBL) * size);
+    offset_l    = offset_rows + sizeof(FLT_OR_DBL *) * k_size;
+    chunk       = (char *)pool_alloc(pool, offset_l + sizeof(int) * 2 * k_size);
+    data        = (FLT_OR_DBL *)chunk;
+    rows        = (FLT_OR_DBL **)(chunk + offset_rows);
+    l_min_new   = (int *)(chunk + offset_l);
+    l_max_new   = l_min_new + k_size;
+
+    rows      -= k_min_post;
+    l_min_new -= k_min_post;
+    l_max_new -= k_min_post;
+
+    /* copy actual data into the pool and thereby eliminate unused memory */
     for (cnt1 = k_min_post; cnt1 <= k_max_post; cnt1++) {
       if (l_min_post[cnt1] < INF) {
         /* new memsize */
         mem_size = (l_max_post[cnt1] - l_min_post[cnt1] + 1) / 2 + 1;
-        /* reshift the pointer */
-        (*array)[cnt1] += (*l_min)[cnt1] / 2;
 
-        int shift = (l_min_post[cnt1] % 2 == (*l_min)[cnt1] % 2) ? 0 : 1;
-        /* eliminate unused memory in front of actual data */
-        unsigned int start = (l_min_post[cnt1] - (*l_min)[cnt1]) / 2 + shift;
-        if (start > 0)
-          memmove((FLT_OR_DBL *)((*array)[cnt1]), (FLT_OR_DBL *)((*array)[cnt1]) + start,
-                  sizeof(FLT_OR_DBL) * mem_size);
+        shift = (l_min_post[cnt1] % 2 == (*l_min)[cnt1] % 2) ? 0 : 1;
+        start = (l_min_post[cnt1] - (*l_min)[cnt1]) / 2 + shift;
+        memcpy(data, (*array)[cnt1] + (*l_min)[cnt1] / 2 + start, sizeof(FLT_OR_DBL) * mem_size);
 
-        (*array)[cnt1] = (FLT_OR_DBL *)realloc((*array)[cnt1], sizeof(FLT_OR_DBL) * mem_size);
-
-        (*array)[cnt1] -= l_min_post[cnt1] / 2;
+        rows[cnt1]  = data - l_min_post[cnt1] / 2;
+        data        += mem_size;
       } else {
-        /* free according memory */
-        (*array)[cnt1] += (*l_min)[cnt1] / 2;
-        free((*array)[cnt1]);
+        rows[cnt1] = NULL;
       }
 
-      (*l_min)[cnt1]  = l_min_post[cnt1];
-      (*l_max)[cnt1]  = l_max_post[cnt1];
+      l_min_new[cnt1] = l_min_post[cnt1];
+      l_max_new[cnt1] = l_max_post[cnt1];
     }
   } else {
-    /* we have to free all unused memory */
-    for (cnt1 = *k_min; cnt1 <= *k_max; cnt1++) {
-      (*array)[cnt1] += (*l_min)[cnt1] / 2;
-      free((*array)[cnt1]);
-    }
-    (*l_min)  += *k_min;
-    (*l_max)  += *k_min;
-    free(*l_min);
-    free(*l_max);
-    (*array) += *k_min;
-    free(*array);
-    *array = NULL;
+    rows      = NULL;
+    l_min_new = NULL;
+    l_max_new = NULL;
   }
 
+  /* release the scratch memory of the array and its prior boundaries */
+  free(*array + *k_min);
+  free(*l_min + *k_min);
+  free(*l_max + *k_min);
+
+  *array  = rows;
+  *l_min  = l_min_new;
+  *l_max  = l_max_new;
+
   l_min_post  += *k_min;
   l_max_post  += *k_min;
   *k_min      = k_min_post;
@@ -4398,6 +4419,11 @@ prepareBoundaries(int min_k_pre,
 }
 
 
+/*
+ *  Prepare a temporary (k,l) array for a single cell. All rows reside
+ *  in one block of memory right after the row table, such that the
+ *  entire array can be released at once in adjustArrayBoundaries()
+ */
 PRIVATE INLINE void
 prepareArray(FLT_OR_DBL ***array,
              int        min_k,
@@ -4405,15 +4431,22 @@ prepareArray(FLT_OR_DBL ***array,
              int        *min_l,
              int        *max_l)
 {
-  int i, mem;
+  int         i;
+  size_t      size, offset;
+  FLT_OR_DBL  *data;
+
+  size = 0;
+  for (i = min_k; i <= max_k; i++)
+    size += (max_l[i] - min_l[i] + 1) / 2 + 1;
 
-  *array  = (FLT_OR_DBL **)vrna_alloc(sizeof(FLT_OR_DBL *) * (max_k - min_k + 1));
+  offset  = POOL_ALIGN(sizeof(FLT_OR_DBL *) * (max_k - min_k + 1));
+  *array  = (FLT_OR_DBL **)vrna_alloc(offset + sizeof(FLT_OR_DBL) * size);
+  data    = (FLT_OR_DBL *)((char *)(*array) + offset);
   *array  -= min_k;
 
   for (i = min_k; i <= max_k; i++) {
-    mem         = (max_l[i] - min_l[i] + 1) / 2 + 1;
-    (*array)[i] = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * mem);
-    (*array)[i] -= min_l[i] / 2;
+    (*array)[i] = data - min_l[i] / 2;
+    data        += (max_l[i] - min_l[i] + 1) / 2 + 1;
   }
 }
 
@@ -4448,6 +4481,13 @@ crosslink(TwoDpfold_vars *vars)
   vars->pf_scale      = c->exp_params->pf_scale;
   vars->pf_params     = c->exp_params;
 
+#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
+  /* iindx-based pair types are only created on demand for this deprecated interface */
+  if (!c->ptype_pf_compat)
+    c->ptype_pf_compat = get_ptypes(c->sequence_encoding2, &(c->exp_params->model_details), 1);
+
+#endif
+
   vars->scale = m->scale;
   vars->ptype = c->ptype_pf_compat;
   vars->S     = c->sequence_encoding2;
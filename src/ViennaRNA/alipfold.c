@@ -80,6 +80,10 @@ wrap_alipf_fold(const char        **sequences,
                 int               is_circular);
 
 
+PRIVATE short *
+pscores_pf_compat(vrna_fold_compound_t *fc);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -188,6 +192,29 @@ wrap_alipf_fold(const char        **sequences,
  *###########################################
  */
 
+/*
+ *  Copy of the pair scores indexed via iindx, as expected by the deprecated
+ *  get_alipf_arrays() interface
+ */
+PRIVATE short *
+pscores_pf_compat(vrna_fold_compound_t *fc)
+{
+  int   i, j, n, *idx, *my_iindx;
+  short *pscore;
+
+  n         = (int)fc->length;
+  idx       = fc->jindx;
+  my_iindx  = fc->iindx;
+  pscore    = (short *)vrna_alloc(sizeof(short) * ((n * (n + 1)) / 2 + 2));
+
+  for (i = 1; i < n; i++)
+    for (j = i; j <= n; j++)
+      pscore[my_iindx[i] - j] = (short)fc->pscore[idx[j] + i];
+
+  return pscore;
+}
+
+
 PUBLIC float
 alipf_fold(const char **sequences,
            char       *structure,
@@ -292,6 +319,11 @@ get_alipf_arrays(short          ***S_p,
   if (backward_compat_compound) {
     if (backward_compat_compound->exp_matrices) {
       if (backward_compat_compound->exp_matrices->qb) {
+        /* iindx-based pair scores are only created on demand */
+        if (!backward_compat_compound->pscore_pf_compat)
+          backward_compat_compound->pscore_pf_compat =
+            pscores_pf_compat(backward_compat_compound);
+
         *S_p      = backward_compat_compound->S;
         *S5_p     = backward_compat_compound->S5;
         *S3_p     = backward_compat_compound->S3;
@@ -213,14 +213,6 @@ vrna_ptypes_prepare(vrna_fold_compound_t  *fc,
               fc->ptype = vrna_ptypes(fc->sequence_encoding2, &(fc->exp_params->model_details));
             }
           }
-#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
-          /* backward compatibility ptypes */
-          if (!fc->ptype_pf_compat)
-            fc->ptype_pf_compat = get_ptypes(fc->sequence_encoding2,
-                                             &(fc->exp_params->model_details),
-                                             1);
-
-#endif
         }
 
         break;
@@ -0,0 +1,245 @@
+/*
+ * This is a simple implementation of a region-based (arena) memory allocator
+ */
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdarg.h>
+
+#include "ViennaRNA/utils/basic.h"
+
+#include "ViennaRNA/datastructures/arena.h"
+
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+#define ARENA_BLOCK_SIZE_DEFAULT  ((size_t)64 * 1024)
+#define ARENA_BLOCK_SIZE_MAX      ((size_t)16 * 1024 * 1024)
+#define ARENA_ALIGNMENT           (sizeof(long double) > sizeof(void *) ? sizeof(long double) : sizeof(void *))
+
+struct arena_block {
+  struct arena_block  *prev;  /* previously allocated (smaller) block */
+  size_t              size;   /* usable size of this block */
+  size_t              used;   /* number of bytes handed out so far */
+  union {
+    long double       ld;     /* enforce alignment of the payload */
+    void              *p;
+  }                   data[];
+};
+
+
+struct vrna_arena_s {
+  struct arena_block  *current;     /* the block allocations are currently served from */
+  size_t              block_size;   /* the size of the first block */
+};
+
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE struct arena_block *
+block_init(size_t size);
+
+
+PRIVATE INLINE size_t
+align_size(size_t size);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC struct vrna_arena_s *
+vrna_arena_init(size_t block_size)
+{
+  struct vrna_arena_s *arena;
+
+  arena             = (struct vrna_arena_s *)vrna_alloc(sizeof(struct vrna_arena_s));
+  arena->block_size = (block_size > 0) ? align_size(block_size) : ARENA_BLOCK_SIZE_DEFAULT;
+  arena->current    = block_init(arena->block_size);
+
+  return arena;
+}
+
+
+PUBLIC void
+vrna_arena_free(struct vrna_arena_s *arena)
+{
+  struct arena_block *b, *prev;
+
+  if (arena) {
+    for (b = arena->current; b; b = prev) {
+      prev = b->prev;
+      free(b);
+    }
+
+    free(arena);
+  }
+}
+
+
+PUBLIC void
+vrna_arena_reset(struct vrna_arena_s *arena)
+{
+  struct arena_block *b, *prev;
+
+  if ((arena) && (arena->current)) {
+    /*
+     *  blocks grow geometrically up to a maximum size, so the current
+     *  block is at least as large as any regular block before. Keep it
+     *  and release all others
+     */
+    for (b = arena->current->prev; b; b = prev) {
+      prev = b->prev;
+      free(b);
+    }
+
+    arena->current->prev = NULL;
+    arena->current->used = 0;
+  }
+}
+
+
+PUBLIC void *
+vrna_arena_alloc(struct vrna_arena_s  *arena,
+                 size_t               size)
+{
+  size_t              block_size;
+  void                *ptr;
+  struct arena_block  *b;
+
+  if (!arena)
+    return NULL;
+
+  size  = align_size((size > 0) ? size : 1);
+  b     = arena->current;
+
+  if (b->size - b->used < size) {
+    /* grow geometrically, but limit the amount of memory that may remain unused */
+    block_size = 2 * b->size;
+
+    if (block_size > ARENA_BLOCK_SIZE_MAX)
+      block_size = (b->size > ARENA_BLOCK_SIZE_MAX) ? b->size : ARENA_BLOCK_SIZE_MAX;
+
+    if (block_size < size) {
+      /*
+       *  serve oversized requests from a dedicated block that is kept
+       *  behind the current one, such that the remainder of the current
+       *  block is still available for subsequent allocations
+       */
+      b                     = block_init(size);
+      b->used               = size;
+      b->prev               = arena->current->prev;
+      arena->current->prev  = b;
+
+      memset(b->data, 0, size);
+
+      return b->data;
+    }
+
+    b               = block_init(block_size);
+    b->prev         = arena->current;
+    arena->current  = b;
+  }
+
+  ptr     = (char *)b->data + b->used;
+  b->used += size;
+
+  memset(ptr, 0, size);
+
+  return ptr;
+}
+
+
+PUBLIC char *
+vrna_arena_strdup(struct vrna_arena_s *arena,
+                  const char          *s)
+{
+  size_t  l;
+  char    *r;
+
+  if (!s)
+    return NULL;
+
+  l = strlen(s);
+  r = (char *)vrna_arena_alloc(arena, sizeof(char) * (l + 1));
+
+  if (r)
+    memcpy(r, s, sizeof(char) * l);
+
+  return r;
+}
+
+
+PUBLIC char *
+vrna_arena_strdup_printf(struct vrna_arena_s  *arena,
+                         const char           *format,
+                         ...)
+{
+  int     count;
+  char    *r;
+  va_list argp, copy;
+
+  if ((!arena) || (!format))
+    return NULL;
+
+  r = NULL;
+
+  va_start(argp, format);
+  va_copy(copy, argp);
+
+  /* retrieve the number of characters that the string requires */
+#ifdef _WIN32
+  count = _vscprintf(format, argp);
+#else
+  count = vsnprintf(NULL, 0, format, argp);
+#endif
+
+  if (count >= 0) {
+    r = (char *)vrna_arena_alloc(arena, sizeof(char) * ((size_t)count + 1));
+    if (r)
+      vsnprintf(r, (size_t)count + 1, format, copy);
+  }
+
+  va_end(copy);
+  va_end(argp);
+
+  return r;
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE struct arena_block *
+block_init(size_t size)
+{
+  struct arena_block *b;
+
+  /* no need to zero-initialize here, this is done upon allocation */
+  b = (struct arena_block *)malloc(sizeof(struct arena_block) + size);
+
+  if (!b)
+    vrna_message_error("vrna_arena: Memory allocation failure -> no memory");
+
+  b->prev = NULL;
+  b->size = size;
+  b->used = 0;
+
+  return b;
+}
+
+
+PRIVATE INLINE size_t
+align_size(size_t size)
+{
+  return (size + ARENA_ALIGNMENT - 1) & ~(ARENA_ALIGNMENT - 1);
+}
@@ -0,0 +1,122 @@
+#ifndef VIENNA_RNA_PACKAGE_ARENA_H
+#define VIENNA_RNA_PACKAGE_ARENA_H
+
+#include <stddef.h>
+
+/**
+ *  @file     ViennaRNA/datastructures/arena.h
+ *  @ingroup  arena_utils
+ *  @brief    Implementation of a simple region-based (arena) memory allocator
+ */
+
+/**
+ *  @addtogroup arena_utils
+ *  @{
+ *  @brief  Interface for a region-based memory allocator
+ *
+ *  An arena hands out memory from a small number of large blocks and releases all
+ *  of it at once. This is useful for temporaries whose lifetime is bound to a particular
+ *  task, e.g. the processing of a single input record, since it avoids many small
+ *  allocations and de-allocations and the corresponding lock contention within the
+ *  system's memory allocator in multi-threaded applications. An arena itself is not
+ *  thread-safe and is meant to be used by a single thread at a time.
+ */
+
+
+/**
+ *  @brief  An arena (region-based) memory allocator
+ *
+ *  @see  vrna_arena_init(), vrna_arena_free(), vrna_arena_alloc(), vrna_arena_reset()
+ */
+typedef struct vrna_arena_s *vrna_arena_t;
+
+
+/**
+ *  @brief  Initialize an arena memory allocator
+ *
+ *  @see    vrna_arena_free(), vrna_arena_alloc(), vrna_arena_reset()
+ *
+ *  @param  block_size  The size of the first memory block in bytes (0 for a default size)
+ *  @return             An initialized arena, or NULL on error
+ */
+vrna_arena_t
+vrna_arena_init(size_t block_size);
+
+
+/**
+ *  @brief  Free an arena and all memory handed out by it
+ *
+ *  @see    vrna_arena_init()
+ *
+ *  @param  arena   The arena
+ */
+void
+vrna_arena_free(vrna_arena_t arena);
+
+
+/**
+ *  @brief  Release all memory handed out by an arena at once
+ *
+ *  All pointers obtained from the arena become invalid. The largest memory block is
+ *  kept for subsequent allocations, such that an arena that is reset after each task
+ *  quickly reaches a state where no further system allocations are required.
+ *
+ *  @see    vrna_arena_init(), vrna_arena_alloc()
+ *
+ *  @param  arena   The arena
+ */
+void
+vrna_arena_reset(vrna_arena_t arena);
+
+
+/**
+ *  @brief  Allocate zero-initialized memory from an arena
+ *
+ *  The memory is suitably aligned for any type and must not be passed to free().
+ *
+ *  @see    vrna_arena_init(), vrna_arena_reset(), vrna_arena_strdup()
+ *
+ *  @param  arena   The arena
+ *  @param  size    The number of bytes requested
+ *  @return         A pointer to the memory block, or NULL on error
+ */
+void *
+vrna_arena_alloc(vrna_arena_t arena,
+                 size_t       size);
+
+
+/**
+ *  @brief  Duplicate a string using memory of an arena
+ *
+ *  @see    vrna_arena_alloc(), vrna_arena_strdup_printf()
+ *
+ *  @param  arena   The arena
+ *  @param  s       The string to copy
+ *  @return         A copy of @p s, or NULL on error
+ */
+char *
+vrna_arena_strdup(vrna_arena_t  arena,
+                  const char    *s);
+
+
+/**
+ *  @brief  Print a formatted string into memory of an arena
+ *
+ *  @see    vrna_arena_alloc(), vrna_arena_strdup(), vrna_strdup_printf()
+ *
+ *  @param  arena   The arena
+ *  @param  format  The format string (See also asprintf)
+ *  @param  ...     The list of variables used to fill the format string
+ *  @return         The formatted string, or NULL on error
+ */
+char *
+vrna_arena_strdup_printf(vrna_arena_t arena,
+                         const char   *format,
+                         ...);
+
+
+/**
+ *  @}
+ */
+
+#endif
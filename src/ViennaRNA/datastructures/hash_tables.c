@@ -1,108 +1,207 @@
 /* Taken from the barriers tool and modified by GE. */
 
+/*
+ *  Open addressing hash table with Robin Hood insertion and backward shift
+ *  deletion. Each slot caches the full 32-bit hash value of its entry, such
+ *  that the compare callback is only called for entries with equal hashes,
+ *  and the table can be grown without calling the hash callback again.
+ *
+ *  The concurrent variant splits the table into independent shards, each
+ *  of which is protected by its own mutex.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
 
 #include <stdio.h>
 #include <math.h>
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
+
+#if VRNA_WITH_PTHREADS
+# include <pthread.h>
+#endif
 
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/datastructures/hash_tables.h"
 
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
+/* range of hash values we request from the hash function */
+#define HT_HASH_RANGE         ((unsigned long)UINT_MAX)
+/* the smallest number of slots a (shard of a) hash table may have */
+#define HT_MIN_BITS           4
+/* default number of shards for concurrent hash tables */
+#define HT_SHARDS_DEFAULT     64
+/* maximum load factor, i.e. HT_LOAD_NUM / HT_LOAD_DENOM, before a table grows */
+#define HT_LOAD_NUM           4
+#define HT_LOAD_DENOM         5
+
+struct ht_slot {
+  void          *entry;
+  unsigned int  hash;   /* the (mixed) hash value of entry */
+  unsigned int  dist;   /* 1 + distance to the home slot, 0 for empty slots */
+};
+
+
+struct ht_shard {
+  struct ht_slot  *slots;
+  unsigned long   mask;       /* number of slots - 1 */
+  unsigned long   count;      /* number of entries */
+  unsigned long   collisions; /* number of entries that did not find their home slot empty */
+#if VRNA_WITH_PTHREADS
+  pthread_mutex_t mtx;
+#endif
+};
+
 
 struct vrna_hash_table_s {
-  unsigned int                      hash_bits;
-  unsigned long                     Hash_size;
-  /* must be power of 2^hash_bits -1 (example: HASHSIZE 67108864 -1 = 2^26 -1 )*/
-  void                              **Hash_table;
-  unsigned long                     Collisions;
+  unsigned int                      hash_bits;  /* number of bits of a shard at initialization */
+  unsigned int                      shard_bits; /* log2 of number of shards */
+  struct ht_shard                   *shards;
+  int                               concurrent;
   vrna_callback_ht_compare_entries  *Compare_function;
   vrna_callback_ht_hash_function    *Hash_function;
   vrna_callback_ht_free_entry       *Free_hash_entry;
 };
 
 
-typedef struct vrna_hash_entry_list_s {
-  unsigned long length;
-  unsigned long allocated_length;
-  void          **hash_entries;
-} vrna_hash_entry_list_t;
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE struct vrna_hash_table_s *
+ht_init(unsigned int                      hash_bits,
+        unsigned int                      shard_bits,
+        int                               concurrent,
+        vrna_callback_ht_compare_entries  *compare_function,
+        vrna_callback_ht_hash_function    *hash_function,
+        vrna_callback_ht_free_entry       *free_hash_entry);
+
+
+PRIVATE INLINE unsigned int
+ht_hash(struct vrna_hash_table_s  *ht,
+        void                      *x);
+
+
+PRIVATE INLINE struct ht_shard *
+ht_shard_lock(struct vrna_hash_table_s  *ht,
+              unsigned int              hash);
+
+
+PRIVATE INLINE void
+ht_shard_unlock(struct vrna_hash_table_s  *ht,
+                struct ht_shard           *shard);
 
-/* ----------------------------------------------------------------- */
 
+PRIVATE unsigned long
+ht_shard_find(struct vrna_hash_table_s  *ht,
+              struct ht_shard           *shard,
+              void                      *x,
+              unsigned int              hash);
+
+
+PRIVATE int
+ht_shard_grow(struct ht_shard *shard);
+
+
+PRIVATE void
+ht_shard_place(struct ht_shard  *shard,
+               struct ht_slot   slot);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
 PUBLIC struct vrna_hash_table_s *
 vrna_ht_init(unsigned int                     hash_bits,
              vrna_callback_ht_compare_entries *compare_function,
              vrna_callback_ht_hash_function   *hash_function,
              vrna_callback_ht_free_entry      *free_hash_entry)
 {
-  struct vrna_hash_table_s *ht = NULL;
-
-  if (hash_bits > 0) {
-    ht = (struct vrna_hash_table_s *)vrna_alloc(sizeof(struct vrna_hash_table_s));
-
-    ht->hash_bits = hash_bits;
-    /* must be power of 2^hash_bits -1 (example: HASHSIZE 67108864 -1 = 2^26 -1 )
-    * if we want to use '&' instead of modulo '%' for limiting the hash value. */
-    ht->Hash_size   = (((unsigned long)1 << hash_bits) - 1);
-    ht->Hash_table  = calloc((ht->Hash_size + 1), sizeof(void *));
-    if (!ht->Hash_table) {
-      fprintf(stderr, "Error: could not allocate space for the hash table!\n");
-      free(ht);
-      return NULL;
-    }
+  if (hash_bits > 0)
+    return ht_init(hash_bits, 0, 0, compare_function, hash_function, free_hash_entry);
 
-    ht->Collisions = 0;
-
-    if ((!compare_function) &&
-        (!hash_function) &&
-        (!free_hash_entry)) {
-      /*
-       *  Fall-back to expect dot-bracket structure string and
-       *  free energy value as entries in hash table, i.e. pointers
-       *  to vrna_ht_entry_db_t
-       */
-      ht->Compare_function  = &vrna_ht_db_comp;
-      ht->Hash_function     = &vrna_ht_db_hash_func;
-      ht->Free_hash_entry   = &vrna_ht_db_free_entry;
-    } else if ((compare_function) &&
-               (hash_function) &&
-               (free_hash_entry)) {
-      /* Bind user-defined compare, free, and hash functions */
-      ht->Compare_function  = compare_function;
-      ht->Hash_function     = hash_function;
-      ht->Free_hash_entry   = free_hash_entry;
-    } else {
-      /*
-       *  One of the function pointers is missing, so we don't initialize
-       *  anything!
-       */
-      free(ht);
-      ht = NULL;
-    }
-  }
+  return NULL;
+}
 
-  return ht;
+
+PUBLIC struct vrna_hash_table_s *
+vrna_ht_init_concurrent(unsigned int                      hash_bits,
+                        unsigned int                      num_shards,
+                        vrna_callback_ht_compare_entries  *compare_function,
+                        vrna_callback_ht_hash_function    *hash_function,
+                        vrna_callback_ht_free_entry       *free_hash_entry)
+{
+  unsigned int shard_bits;
+
+  if (hash_bits == 0)
+    return NULL;
+
+  if (num_shards == 0)
+    num_shards = HT_SHARDS_DEFAULT;
+
+  /* round up to the next power of 2 */
+  for (shard_bits = 0; ((unsigned int)1 << shard_bits) < num_shards; shard_bits++);
+
+  if (shard_bits > 16)
+    shard_bits = 16;
+
+  /* distribute the initial size among the shards */
+  hash_bits = (hash_bits > shard_bits) ? hash_bits - shard_bits : 0;
+
+  return ht_init(hash_bits, shard_bits, 1, compare_function, hash_function, free_hash_entry);
 }
 
 
-unsigned long
+PUBLIC unsigned long
 vrna_ht_size(struct vrna_hash_table_s *ht)
 {
+  unsigned int  i;
+  unsigned long size = 0;
+
   if (ht)
-    return ht->Hash_size;
+    for (i = 0; i < ((unsigned int)1 << ht->shard_bits); i++)
+      size += ht->shards[i].mask + 1;
 
-  return 0L;
+  return size;
 }
 
 
-unsigned long
+PUBLIC unsigned long
+vrna_ht_count(struct vrna_hash_table_s *ht)
+{
+  unsigned int  i;
+  unsigned long count = 0;
+
+  if (ht)
+    for (i = 0; i < ((unsigned int)1 << ht->shard_bits); i++)
+      count += ht->shards[i].count;
+
+  return count;
+}
+
+
+PUBLIC unsigned long
 vrna_ht_collisions(struct vrna_hash_table_s *ht)
 {
+  unsigned int  i;
+  unsigned long collisions = 0;
+
   if (ht)
-    return ht->Collisions;
+    for (i = 0; i < ((unsigned int)1 << ht->shard_bits); i++)
+      collisions += ht->shards[i].collisions;
 
-  return 0L;
+  return collisions;
 }
 
 
@@ -110,28 +209,23 @@ PUBLIC void *
 vrna_ht_get(struct vrna_hash_table_s  *ht,
             void                      *x)             /* returns NULL unless x is in the hash */
 {
-  unsigned int hashval;
+  unsigned int    hash;
+  unsigned long   pos;
+  void            *entry = NULL;
+  struct ht_shard *shard;
 
   if ((ht) && (x)) {
-    hashval = ht->Hash_function(x, ht->Hash_size);
-    if (hashval >= ht->Hash_size) {
-      fprintf(stderr,
-              "Error: hash function returns a value that is larger than the size of the hash map!\n");
-      return NULL;
-    }
+    hash  = ht_hash(ht, x);
+    shard = ht_shard_lock(ht, hash);
+    pos   = ht_shard_find(ht, shard, x, hash);
 
-    vrna_hash_entry_list_t *entries = ht->Hash_table[hashval];
-    if (entries) {
-      int i;
-      for (i = 0; i < entries->length; i++) {
-        if (ht->Compare_function(x, entries->hash_entries[i]) == 0)
-          //found the same entry
-          return entries->hash_entries[i]; /* success */
-      }
-    }
+    if (pos <= shard->mask)
+      entry = shard->slots[pos].entry;
+
+    ht_shard_unlock(ht, shard);
   }
 
-  return NULL;
+  return entry;
 }
 
 
@@ -139,78 +233,69 @@ vrna_ht_get(struct vrna_hash_table_s  *ht,
 
 PUBLIC int
 vrna_ht_insert(struct vrna_hash_table_s *ht,
-               void                     *x)         /* returns 1 if x already was in the hash */
+               void                     *x)         /* returns 0 if x already was in the hash */
 {
-  unsigned int hashval;
+  int             ret = -1;
+  unsigned int    hash;
+  struct ht_slot  slot;
+  struct ht_shard *shard;
 
   if ((ht) && (x)) {
-    hashval = ht->Hash_function(x, ht->Hash_size);
-    if (hashval >= ht->Hash_size) {
-      fprintf(stderr,
-              "Error: hash function returns a value that is larger than the size of the hash map!\n");
-      return -1; /* failure */;
-    } else {
-      vrna_hash_entry_list_t *entries = (vrna_hash_entry_list_t *)ht->Hash_table[hashval];
-      if (entries) {
-        //at first test if the entry is already in the list.
-        int i;
-        for (i = 0; i < entries->length; i++) {
-          if (ht->Compare_function(x, entries->hash_entries[i]) == 0)
-            //found the same entry
-            return 0; /* success */
-        }
-
-        ht->Collisions++;
-        //append the entry to the list with same hash values.
-        if (i >= entries->length) {
-          if (i >= entries->allocated_length) {
-            //we have to extend the list.
-            entries->allocated_length += 100;
-            entries->hash_entries     = vrna_realloc(entries->hash_entries,
-                                                     entries->allocated_length * sizeof(void *));
-          }
-
-          entries->hash_entries[entries->length] = x;
-          entries->length++;
+    hash  = ht_hash(ht, x);
+    shard = ht_shard_lock(ht, hash);
+    ret   = 0;
+
+    if (ht_shard_find(ht, shard, x, hash) > shard->mask) {
+      /* grow the shard if we would exceed the maximum load factor */
+      if ((shard->count + 1) * HT_LOAD_DENOM > (shard->mask + 1) * HT_LOAD_NUM) {
+        if (!ht_shard_grow(shard)) {
+          vrna_message_warning("vrna_ht_insert: could not allocate space for the hash table!");
+          ret = -1;
         }
-      } else {
-        //allocate new list and insert the value
-        entries                   = malloc(sizeof(vrna_hash_entry_list_t));
-        entries->allocated_length = 2;
-        entries->hash_entries     = vrna_alloc(entries->allocated_length * sizeof(void *));
-        entries->hash_entries[0]  = x;
-        entries->length           = 1;
-        ht->Hash_table[hashval]   = entries;
       }
 
-      return 0; /* success */
+      if (ret == 0) {
+        slot.entry  = x;
+        slot.hash   = hash;
+        slot.dist   = 1;
+
+        if (shard->slots[hash & shard->mask].dist != 0)
+          shard->collisions++;
+
+        ht_shard_place(shard, slot);
+        shard->count++;
+      }
     }
+
+    ht_shard_unlock(ht, shard);
   }
 
-  return -1; /* failure */
+  return ret;
 }
 
 
 PUBLIC void
 vrna_ht_clear(struct vrna_hash_table_s *ht)
 {
-  unsigned int i;
+  unsigned int    i;
+  unsigned long   j;
+  struct ht_shard *shard;
 
   if (ht) {
-    for (i = 0; i < ht->Hash_size + 1; i++) {
-      vrna_hash_entry_list_t *entries = ht->Hash_table[i];
-      if (entries) {
-        int i;
-        for (i = 0; i < entries->length; i++) {
-          ht->Free_hash_entry(entries->hash_entries[i]);
-          entries->hash_entries[i] = NULL;
+    for (i = 0; i < ((unsigned int)1 << ht->shard_bits); i++) {
+      shard = &(ht->shards[i]);
+
+      for (j = 0; j <= shard->mask; j++) {
+        if (shard->slots[j].dist) {
+          ht->Free_hash_entry(shard->slots[j].entry);
+          shard->slots[j].entry = NULL;
+          shard->slots[j].dist  = 0;
         }
-        free(entries->hash_entries);
-        free(entries);
       }
-    }
 
-    ht->Collisions = 0;
+      shard->count      = 0;
+      shard->collisions = 0;
+    }
   }
 }
 
@@ -218,9 +303,21 @@ vrna_ht_clear(struct vrna_hash_table_s *ht)
 PUBLIC void
 vrna_ht_free(struct vrna_hash_table_s *ht)
 {
+  unsigned int i;
+
   if (ht) {
     vrna_ht_clear(ht);
-    free(ht->Hash_table);
+
+    for (i = 0; i < ((unsigned int)1 << ht->shard_bits); i++) {
+      free(ht->shards[i].slots);
+#if VRNA_WITH_PTHREADS
+      if (ht->concurrent)
+        pthread_mutex_destroy(&(ht->shards[i].mtx));
+
+#endif
+    }
+
+    free(ht->shards);
     free(ht);
   }
 }
@@ -233,38 +330,255 @@ vrna_ht_remove(struct vrna_hash_table_s *ht,
                void                     *x)
 {
   /* doesn't free anything ! */
-  unsigned int hashval;
+  unsigned int    hash;
+  unsigned long   pos, next;
+  struct ht_shard *shard;
 
   if ((ht) && (x)) {
-    hashval = ht->Hash_function(x, ht->Hash_size);
-    if (hashval >= ht->Hash_size) {
-      fprintf(stderr,
-              "Error: hash function returns a value that is larger than the size of the hash map!\n");
-      return;
+    hash  = ht_hash(ht, x);
+    shard = ht_shard_lock(ht, hash);
+    pos   = ht_shard_find(ht, shard, x, hash);
+
+    if (pos <= shard->mask) {
+      /* shift all subsequent entries that are not in their home slot one position back */
+      next = (pos + 1) & shard->mask;
+      while (shard->slots[next].dist > 1) {
+        shard->slots[pos] = shard->slots[next];
+        shard->slots[pos].dist--;
+        pos   = next;
+        next  = (next + 1) & shard->mask;
+      }
+
+      shard->slots[pos].entry = NULL;
+      shard->slots[pos].dist  = 0;
+      shard->count--;
     }
 
-    vrna_hash_entry_list_t *entries = ht->Hash_table[hashval];
-    if (entries) {
-      int i;
-      for (i = 0; i < entries->length; i++) {
-        if (ht->Compare_function(x, entries->hash_entries[i]) == 0) {
-          //found the same entry --> shift the list to the left in order to delete the value.
-          int size_rest = entries->length - i - 1;
-          if (size_rest <= 0) {
-            entries->hash_entries[i] = 0;
-          } else {
-            void  *offset     = entries->hash_entries + i;
-            void  *next_entry = entries->hash_entries + i + 1;
-            memcpy(offset, next_entry, size_rest * sizeof(void *));
-          }
-
-          entries->hash_entries[entries->length - 1] = NULL;
-          entries->length--;
-          return; /* success */
-        }
-      }
+    ht_shard_unlock(ht, shard);
+  }
+}
+
+
+/*
+ #################################
+ # STATIC helper functions below #
+ #################################
+ */
+PRIVATE struct vrna_hash_table_s *
+ht_init(unsigned int                      hash_bits,
+        unsigned int                      shard_bits,
+        int                               concurrent,
+        vrna_callback_ht_compare_entries  *compare_function,
+        vrna_callback_ht_hash_function    *hash_function,
+        vrna_callback_ht_free_entry       *free_hash_entry)
+{
+  unsigned int              i, j;
+  struct vrna_hash_table_s  *ht = NULL;
+
+  ht = (struct vrna_hash_table_s *)vrna_alloc(sizeof(struct vrna_hash_table_s));
+
+  if ((!compare_function) &&
+      (!hash_function) &&
+      (!free_hash_entry)) {
+    /*
+     *  Fall-back to expect dot-bracket structure string and
+     *  free energy value as entries in hash table, i.e. pointers
+     *  to vrna_ht_entry_db_t
+     */
+    ht->Compare_function  = &vrna_ht_db_comp;
+    ht->Hash_function     = &vrna_ht_db_hash_func;
+    ht->Free_hash_entry   = &vrna_ht_db_free_entry;
+  } else if ((compare_function) &&
+             (hash_function) &&
+             (free_hash_entry)) {
+    /* Bind user-defined compare, free, and hash functions */
+    ht->Compare_function  = compare_function;
+    ht->Hash_function     = hash_function;
+    ht->Free_hash_entry   = free_hash_entry;
+  } else {
+    /*
+     *  One of the function pointers is missing, so we don't initialize
+     *  anything!
+     */
+    free(ht);
+    return NULL;
+  }
+
+  if (hash_bits < HT_MIN_BITS)
+    hash_bits = HT_MIN_BITS;
+
+  if (hash_bits + shard_bits > 31)
+    hash_bits = 31 - shard_bits;
+
+  ht->hash_bits   = hash_bits;
+  ht->shard_bits  = shard_bits;
+  ht->concurrent  = concurrent;
+  ht->shards      = (struct ht_shard *)vrna_alloc(sizeof(struct ht_shard) << shard_bits);
+
+  for (i = 0; i < ((unsigned int)1 << shard_bits); i++) {
+    ht->shards[i].mask  = ((unsigned long)1 << hash_bits) - 1;
+    ht->shards[i].slots = calloc(ht->shards[i].mask + 1, sizeof(struct ht_slot));
+
+    if (!ht->shards[i].slots) {
+      vrna_message_warning("vrna_ht_init: could not allocate space for the hash table!");
+      for (j = 0; j < i; j++)
+        free(ht->shards[j].slots);
+      free(ht->shards);
+      free(ht);
+      return NULL;
+    }
+
+#if VRNA_WITH_PTHREADS
+    if (concurrent)
+      pthread_mutex_init(&(ht->shards[i].mtx), NULL);
+
+#endif
+  }
+
+  return ht;
+}
+
+
+PRIVATE INLINE unsigned int
+ht_hash(struct vrna_hash_table_s  *ht,
+        void                      *x)
+{
+  unsigned int h = ht->Hash_function(x, HT_HASH_RANGE);
+
+  /*
+   *  Mix all bits of the hash value (MurmurHash3 finalizer), since the
+   *  slot is determined by the lower, and the shard by the upper bits
+   */
+  h ^= h >> 16;
+  h *= 0x85ebca6bU;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35U;
+  h ^= h >> 16;
+
+  return h;
+}
+
+
+PRIVATE INLINE struct ht_shard *
+ht_shard_lock(struct vrna_hash_table_s  *ht,
+              unsigned int              hash)
+{
+  struct ht_shard *shard;
+
+  shard = (ht->shard_bits) ?
+          &(ht->shards[hash >> (32 - ht->shard_bits)]) :
+          &(ht->shards[0]);
+
+#if VRNA_WITH_PTHREADS
+  if (ht->concurrent)
+    pthread_mutex_lock(&(shard->mtx));
+
+#endif
+
+  return shard;
+}
+
+
+PRIVATE INLINE void
+ht_shard_unlock(struct vrna_hash_table_s  *ht,
+                struct ht_shard           *shard)
+{
+#if VRNA_WITH_PTHREADS
+  if (ht->concurrent)
+    pthread_mutex_unlock(&(shard->mtx));
+
+#endif
+}
+
+
+/*
+ *  Return the position of the slot that holds x, or a position
+ *  larger than shard->mask if x is not in the table
+ */
+PRIVATE unsigned long
+ht_shard_find(struct vrna_hash_table_s  *ht,
+              struct ht_shard           *shard,
+              void                      *x,
+              unsigned int              hash)
+{
+  unsigned int  dist;
+  unsigned long pos;
+
+  pos = hash & shard->mask;
+
+  /*
+   *  Due to the Robin Hood invariant, x can not be stored
+   *  beyond the first slot whose entry is closer to its home
+   */
+  for (dist = 1; shard->slots[pos].dist >= dist; dist++) {
+    if ((shard->slots[pos].hash == hash) &&
+        (ht->Compare_function(x, shard->slots[pos].entry) == 0))
+      return pos;
+
+    pos = (pos + 1) & shard->mask;
+  }
+
+  return shard->mask + 1;
+}
+
+
+PRIVATE int
+ht_shard_grow(struct ht_shard *shard)
+{
+  unsigned long   i, old_mask;
+  struct ht_slot  *old_slots, slot;
+
+  old_slots = shard->slots;
+  old_mask  = shard->mask;
+
+  shard->slots = calloc(2 * (old_mask + 1), sizeof(struct ht_slot));
+  if (!shard->slots) {
+    shard->slots = old_slots;
+    return 0;
+  }
+
+  shard->mask = 2 * old_mask + 1;
+
+  /* re-insert all entries using their cached hash values */
+  for (i = 0; i <= old_mask; i++) {
+    if (old_slots[i].dist) {
+      slot      = old_slots[i];
+      slot.dist = 1;
+      ht_shard_place(shard, slot);
     }
   }
+
+  free(old_slots);
+
+  return 1;
+}
+
+
+/*
+ *  Robin Hood insertion, i.e. whenever we encounter an entry that
+ *  is closer to its home slot than the one we carry, we swap both
+ */
+PRIVATE void
+ht_shard_place(struct ht_shard  *shard,
+               struct ht_slot   slot)
+{
+  unsigned long   pos;
+  struct ht_slot  tmp;
+
+  pos = slot.hash & shard->mask;
+
+  while (shard->slots[pos].dist) {
+    if (shard->slots[pos].dist < slot.dist) {
+      tmp               = shard->slots[pos];
+      shard->slots[pos] = slot;
+      slot              = tmp;
+    }
+
+    pos = (pos + 1) & shard->mask;
+    slot.dist++;
+  }
+
+  shard->slots[pos] = slot;
 }
 
 
@@ -21,6 +21,13 @@
  *  Here, we provide an abstract implementation of a hash table interface
  *  and a concrete implementation for pairs of secondary structure and
  *  corresponding free energy value.
+ *
+ *  Our hash tables use open addressing with Robin Hood insertion, i.e.
+ *  entries are stored directly within a single array of slots together
+ *  with their hash value. The table automatically doubles its size
+ *  whenever it becomes too full, so the initial size only serves as a
+ *  hint. A concurrent variant that may be accessed by multiple threads
+ *  simultaneously is available through vrna_ht_init_concurrent().
  */
 
 /**
@@ -48,9 +55,14 @@ typedef int (vrna_callback_ht_compare_entries)(void *x,
 
 /**
  *  @brief  Callback function to generate a hash key, i.e. hash function
+ *
+ *  @note   Since hash tables grow automatically, the hash table implementation
+ *          requests hash values for the full range of an <tt>unsigned int</tt>
+ *          and maps them to the current size of the table itself.
+ *
  *  @see    vrna_ht_init(), vrna_ht_db_hash_func()
  *  @param  x               A hash table entry
- *  @param  hashtable_size  The size of the hash table
+ *  @param  hashtable_size  The range of hash values, i.e. the hash key must be smaller than this value
  *  @return                 The hash table key for entry @p x
  */
 typedef unsigned int (vrna_callback_ht_hash_function)(void          *x,
@@ -70,7 +82,8 @@ typedef int (vrna_callback_ht_free_entry)(void *x);
  *  @brief  Get an initialized hash table
  *
  *  This function returns a ready-to-use hash table with pre-allocated
- *  memory for a particular number of entries.
+ *  memory for a particular number of entries. The hash table grows
+ *  automatically if more entries are inserted.
  *
  *  @note
  *  @parblock
@@ -82,10 +95,9 @@ typedef int (vrna_callback_ht_free_entry)(void *x);
  *
  *  arguments.
  *  @endparblock
- *  @warning  If @p hash_bits is larger than 27 you have to compile it with
- *            the flag gcc -mcmodel=large.
+ *  @see      vrna_ht_init_concurrent(), vrna_ht_free()
  *
- *  @param  b                 Number of bits for the hash table. This determines the size (@f$2^b -1@f$).
+ *  @param  b                 Number of bits for the hash table. This determines the initial size (@f$2^b@f$).
  *  @param  compare_function  A function pointer to compare any two entries in the hash table (may be @p NULL)
  *  @param  hash_function     A function pointer to retrieve the hash value of any entry (may be @p NULL)
  *  @param  free_hash_entry   A function pointer to free the memory occupied by any entry (may be @p NULL)
@@ -98,21 +110,66 @@ vrna_ht_init(unsigned int                     b,
              vrna_callback_ht_free_entry      *free_hash_entry);
 
 
+/**
+ *  @brief  Get an initialized hash table for concurrent access
+ *
+ *  Same as vrna_ht_init() but the returned hash table may be accessed
+ *  by multiple threads at the same time. For that purpose, the table is split into
+ *  @p num_shards independent tables, each protected by its own lock. An entry is
+ *  assigned to a shard according to its hash value, so threads only block each
+ *  other when they access the same shard.
+ *
+ *  vrna_ht_get(), vrna_ht_insert(), and vrna_ht_remove() may be called concurrently.
+ *  vrna_ht_clear() and vrna_ht_free() must not be called while other threads still
+ *  access the hash table. Note, that an entry returned by vrna_ht_get() may be removed
+ *  by another thread at any time, so it is up to the caller to synchronize the life
+ *  time of the entries themselves.
+ *
+ *  @note   If the library was built without POSIX threads support, the returned hash table
+ *          behaves like a hash table returned by vrna_ht_init().
+ *
+ *  @see    vrna_ht_init(), vrna_ht_free()
+ *
+ *  @param  b                 Number of bits for the hash table. This determines the initial size (@f$2^b@f$).
+ *  @param  num_shards        The number of shards, rounded up to the next power of 2 (0 for a default value)
+ *  @param  compare_function  A function pointer to compare any two entries in the hash table (may be @p NULL)
+ *  @param  hash_function     A function pointer to retrieve the hash value of any entry (may be @p NULL)
+ *  @param  free_hash_entry   A function pointer to free the memory occupied by any entry (may be @p NULL)
+ *  @return                   An initialized, empty hash table, or @p NULL on any error
+ */
+vrna_hash_table_t
+vrna_ht_init_concurrent(unsigned int                      b,
+                        unsigned int                      num_shards,
+                        vrna_callback_ht_compare_entries  *compare_function,
+                        vrna_callback_ht_hash_function    *hash_function,
+                        vrna_callback_ht_free_entry       *free_hash_entry);
+
+
 /**
  *  @brief  Get the size of the hash table
  *
  *  @param  ht  The hash table
- *  @return     The size of the hash table, i.e. the maximum number of entries
+ *  @return     The current size of the hash table, i.e. the number of slots available for entries
  */
 unsigned long
 vrna_ht_size(vrna_hash_table_t ht);
 
 
+/**
+ *  @brief  Get the number of entries in the hash table
+ *
+ *  @param  ht  The hash table
+ *  @return     The number of entries stored in the hash table
+ */
+unsigned long
+vrna_ht_count(vrna_hash_table_t ht);
+
+
 /**
  *  @brief  Get the number of collisions in the hash table
  *
  *  @param  ht  The hash table
- *  @return     The number of collisions in the hash table
+ *  @return     The number of entries whose preferred slot was already occupied upon insertion
  */
 unsigned long
 vrna_ht_collisions(struct vrna_hash_table_s *ht);
@@ -142,10 +199,6 @@ vrna_ht_get(vrna_hash_table_t ht,
  *
  *  Writes the pointer to your hash entry into the table.
  *
- *  @warning  In case of collisions, this function simply
- *            increments the hash key until a free entry in
- *            the hash table is found.
- *
  *  @see vrna_ht_init(), vrna_hash_delete(), vrna_ht_clear()
  *
  *  @param  ht  The hash table
@@ -249,7 +302,7 @@ vrna_ht_db_comp(void  *x,
  *  @see  #vrna_ht_entry_db_t, vrna_ht_init(), vrna_ht_db_comp(), vrna_ht_db_free_entry()
  *
  *  @param  x               A hash table entry to compute the key for
- *  @param  hashtable_size  The size of the hash table
+ *  @param  hashtable_size  The range of hash values
  *  @return                 The hash key for entry @p x
  */
 unsigned int
@@ -21,6 +21,11 @@
 #include <string.h>
 #include <math.h>
 
+#if defined(HAVE_SYS_MMAN_H) && defined(HAVE_MMAP)
+#include <sys/mman.h>
+#define VRNA_WITH_MX_PAGES
+#endif
+
 #include "ViennaRNA/datastructures/basic.h"
 #include "ViennaRNA/model.h"
 #include "ViennaRNA/utils/basic.h"
@@ -54,6 +59,21 @@
 #define ALLOC_PF_WO_PROBS         (ALLOC_F | ALLOC_C | ALLOC_FML)
 #define ALLOC_PF_DEFAULT          (ALLOC_PF_WO_PROBS | ALLOC_PROBS | ALLOC_AUX)
 
+/* size of a huge page, matrices smaller than that are always taken from the heap */
+#define MX_HUGE_PAGE_SIZE         ((size_t)2 * 1024 * 1024)
+
+/*
+ #################################
+ # PRIVATE DATA STRUCTURES       #
+ #################################
+ */
+struct vrna_mx_allocator_s {
+  vrna_callback_mx_alloc    *alloc;
+  vrna_callback_mx_release  *release;
+  void                      *data;
+  unsigned int              page_options; /* options of the built-in page allocator */
+};
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -88,7 +108,8 @@ get_mx_pf_alloc_vector_current(vrna_mx_pf_t   *mx,
 
 
 PRIVATE void
-mfe_matrices_free_default(vrna_mx_mfe_t *self);
+mfe_matrices_free_default(vrna_mx_mfe_t       *self,
+                          vrna_mx_allocator_t *allocator);
 
 
 PRIVATE void
@@ -105,7 +126,8 @@ mfe_matrices_free_2Dfold(vrna_mx_mfe_t  *self,
 
 
 PRIVATE void
-pf_matrices_free_default(vrna_mx_pf_t *self);
+pf_matrices_free_default(vrna_mx_pf_t         *self,
+                         vrna_mx_allocator_t  *allocator);
 
 
 PRIVATE void
@@ -172,6 +194,33 @@ PRIVATE INLINE void
 nullify_pf(vrna_mx_pf_t *mx);
 
 
+PRIVATE INLINE void *
+mx_alloc(vrna_mx_allocator_t  *allocator,
+         size_t               size);
+
+
+PRIVATE INLINE void
+mx_release(vrna_mx_allocator_t  *allocator,
+           void                 *ptr,
+           size_t               size);
+
+
+PRIVATE int
+replace_allocator(vrna_fold_compound_t  *fc,
+                  vrna_mx_allocator_t   *allocator);
+
+
+PRIVATE void *
+mx_pages_alloc(size_t size,
+               void   *data);
+
+
+PRIVATE void
+mx_pages_release(void   *ptr,
+                 size_t size,
+                 void   *data);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -185,7 +234,7 @@ vrna_mx_mfe_free(vrna_fold_compound_t *vc)
     if (self) {
       switch (self->type) {
         case VRNA_MX_DEFAULT:
-          mfe_matrices_free_default(self);
+          mfe_matrices_free_default(self, vc->mx_allocator);
           break;
 
         case VRNA_MX_WINDOW:
@@ -204,6 +253,7 @@ vrna_mx_mfe_free(vrna_fold_compound_t *vc)
       }
       free(self);
       vc->matrices = NULL;
+      vc->mem_generation++;
     }
   }
 }
@@ -217,7 +267,7 @@ vrna_mx_pf_free(vrna_fold_compound_t *vc)
     if (self) {
       switch (self->type) {
         case VRNA_MX_DEFAULT:
-          pf_matrices_free_default(self);
+          pf_matrices_free_default(self, vc->mx_allocator);
           break;
 
         case VRNA_MX_WINDOW:
@@ -241,6 +291,7 @@ vrna_mx_pf_free(vrna_fold_compound_t *vc)
 
       free(self);
       vc->exp_matrices = NULL;
+      vc->mem_generation++;
     }
   }
 }
@@ -390,11 +441,227 @@ vrna_mx_prepare(vrna_fold_compound_t  *vc,
 }
 
 
+PUBLIC int
+vrna_mx_allocator_set(vrna_fold_compound_t      *fc,
+                      vrna_callback_mx_alloc    *alloc,
+                      vrna_callback_mx_release  *release,
+                      void                      *data)
+{
+  vrna_mx_allocator_t *allocator;
+
+  if (!fc)
+    return 0;
+
+  allocator = NULL;
+
+  if (alloc) {
+    if (!release)
+      return 0;
+
+    allocator               = (vrna_mx_allocator_t *)vrna_alloc(sizeof(vrna_mx_allocator_t));
+    allocator->alloc        = alloc;
+    allocator->release      = release;
+    allocator->data         = data;
+    allocator->page_options = 0;
+  }
+
+  return replace_allocator(fc, allocator);
+}
+
+
+PUBLIC int
+vrna_mx_allocator_pages(vrna_fold_compound_t  *fc,
+                        unsigned int          options)
+{
+  vrna_mx_allocator_t *allocator;
+
+  if (!fc)
+    return 0;
+
+  allocator               = (vrna_mx_allocator_t *)vrna_alloc(sizeof(vrna_mx_allocator_t));
+  allocator->alloc        = &mx_pages_alloc;
+  allocator->release      = &mx_pages_release;
+  allocator->page_options = options;
+  allocator->data         = &(allocator->page_options);
+
+  return replace_allocator(fc, allocator);
+}
+
+
 /*
  #####################################
  # BEGIN OF STATIC HELPER FUNCTIONS  #
  #####################################
  */
+PRIVATE int
+replace_allocator(vrna_fold_compound_t  *fc,
+                  vrna_mx_allocator_t   *allocator)
+{
+  int           ret;
+  unsigned int  mfe_vector, pf_vector;
+
+  ret         = 1;
+  mfe_vector  = ALLOC_NOTHING;
+  pf_vector   = ALLOC_NOTHING;
+
+  /* release default matrices with the allocator they have been obtained from */
+  if ((fc->matrices) && (fc->matrices->type == VRNA_MX_DEFAULT)) {
+    mfe_vector = get_mx_mfe_alloc_vector_current(fc->matrices, VRNA_MX_DEFAULT);
+    vrna_mx_mfe_free(fc);
+  }
+
+  if ((fc->exp_matrices) && (fc->exp_matrices->type == VRNA_MX_DEFAULT)) {
+    pf_vector = get_mx_pf_alloc_vector_current(fc->exp_matrices, VRNA_MX_DEFAULT);
+    vrna_mx_pf_free(fc);
+  }
+
+  free(fc->mx_allocator);
+  fc->mx_allocator = allocator;
+
+  if (mfe_vector != ALLOC_NOTHING)
+    ret &= add_mfe_matrices(fc, VRNA_MX_DEFAULT, mfe_vector);
+
+  if (pf_vector != ALLOC_NOTHING)
+    ret &= add_pf_matrices(fc, VRNA_MX_DEFAULT, pf_vector);
+
+  return ret;
+}
+
+
+PRIVATE INLINE void *
+mx_alloc(vrna_mx_allocator_t  *allocator,
+         size_t               size)
+{
+  void *ptr;
+
+  if (!allocator)
+    return vrna_alloc(size);
+
+  ptr = allocator->alloc(size, allocator->data);
+
+  if (!ptr)
+    vrna_message_error("mx_alloc@dp_matrices.c: "
+                       "Failed to allocate %lu bytes for DP matrix",
+                       (unsigned long)size);
+
+  return ptr;
+}
+
+
+PRIVATE INLINE void
+mx_release(vrna_mx_allocator_t  *allocator,
+           void                 *ptr,
+           size_t               size)
+{
+  if (!ptr)
+    return;
+
+  if (allocator)
+    allocator->release(ptr, size, allocator->data);
+  else
+    free(ptr);
+}
+
+
+#ifdef VRNA_WITH_MX_PAGES
+
+/*
+ *  Size of the memory mapping actually used for a DP matrix of
+ *  size bytes, or 0 if the matrix is to be taken from the heap
+ */
+PRIVATE INLINE size_t
+mx_pages_mapping_size(size_t        size,
+                      unsigned int  options)
+{
+  if (size < MX_HUGE_PAGE_SIZE)
+    return 0;
+
+  /* round up to full huge pages, such that the entire mapping can be backed by them */
+  if (options & (VRNA_MX_ALLOC_HUGE_PAGES | VRNA_MX_ALLOC_HUGETLB))
+    return ((size + MX_HUGE_PAGE_SIZE - 1) / MX_HUGE_PAGE_SIZE) * MX_HUGE_PAGE_SIZE;
+
+  return size;
+}
+
+
+#endif
+
+
+PRIVATE void *
+mx_pages_alloc(size_t size,
+               void   *data)
+{
+#ifdef VRNA_WITH_MX_PAGES
+  unsigned int  options;
+  size_t        mapping_size;
+  void          *ptr;
+
+  options       = *((unsigned int *)data);
+  mapping_size  = mx_pages_mapping_size(size, options);
+
+  if (mapping_size == 0)
+    return vrna_alloc(size);
+
+  ptr = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+  if (options & VRNA_MX_ALLOC_HUGETLB)
+    ptr = mmap(NULL,
+               mapping_size,
+               PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+               -1,
+               0);
+
+#endif
+
+  if (ptr == MAP_FAILED) {
+    /*
+     *  fresh anonymous mappings are zero-initialized and not backed by
+     *  physical memory until first touch
+     */
+    ptr = mmap(NULL,
+               mapping_size,
+               PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS,
+               -1,
+               0);
+
+    if (ptr == MAP_FAILED)
+      return NULL;
+
+#if defined(HAVE_MADVISE) && defined(MADV_HUGEPAGE)
+    if (options & (VRNA_MX_ALLOC_HUGE_PAGES | VRNA_MX_ALLOC_HUGETLB))
+      (void)madvise(ptr, mapping_size, MADV_HUGEPAGE);
+
+#endif
+  }
+
+  return ptr;
+#else
+  return vrna_alloc(size);
+#endif
+}
+
+
+PRIVATE void
+mx_pages_release(void   *ptr,
+                 size_t size,
+                 void   *data)
+{
+#ifdef VRNA_WITH_MX_PAGES
+  size_t mapping_size = mx_pages_mapping_size(size, *((unsigned int *)data));
+
+  if (mapping_size > 0) {
+    munmap(ptr, mapping_size);
+    return;
+  }
+
+#endif
+  free(ptr);
+}
+
+
 PRIVATE unsigned int
 get_mx_mfe_alloc_vector_current(vrna_mx_mfe_t   *mx,
                                 vrna_mx_type_e  mx_type)
@@ -623,8 +890,11 @@ get_mx_alloc_vector(vrna_fold_compound_t  *fc,
 
 
 PRIVATE void
-mfe_matrices_free_default(vrna_mx_mfe_t *self)
+mfe_matrices_free_default(vrna_mx_mfe_t       *self,
+                          vrna_mx_allocator_t *allocator)
 {
+  size_t size = sizeof(int) * (((size_t)self->length + 1) * (self->length + 2) / 2);
+
   free(self->f5);
   free(self->f3);
 
@@ -640,9 +910,9 @@ mfe_matrices_free_default(vrna_mx_mfe_t *self)
 
   free(self->fms3);
 
-  free(self->c);
-  free(self->fML);
-  free(self->fM1);
+  mx_release(allocator, self->c, size);
+  mx_release(allocator, self->fML, size);
+  mx_release(allocator, self->fM1, size);
   free(self->fM2);
   free(self->ggg);
 }
@@ -666,11 +936,10 @@ mfe_matrices_free_2Dfold(vrna_mx_mfe_t  *self,
                          int            turn,
                          int            *indx)
 {
+#ifdef COUNT_STATES
   unsigned int  i, j, ij;
   int           cnt1;
 
-  /* This will be some fun... */
-#ifdef COUNT_STATES
   if (self->N_F5 != NULL) {
     for (i = 1; i <= length; i++) {
       if (!self->N_F5[i])
@@ -690,63 +959,6 @@ mfe_matrices_free_2Dfold(vrna_mx_mfe_t  *self,
     free(vars->N_F5);
   }
 
-#endif
-
-  if (self->E_F5 != NULL) {
-    for (i = 1; i <= length; i++) {
-      if (!self->E_F5[i])
-        continue;
-
-      for (cnt1 = self->k_min_F5[i]; cnt1 <= self->k_max_F5[i]; cnt1++)
-        if (self->l_min_F5[i][cnt1] < INF) {
-          self->E_F5[i][cnt1] += self->l_min_F5[i][cnt1] / 2;
-          free(self->E_F5[i][cnt1]);
-        }
-
-      if (self->k_min_F5[i] < INF) {
-        self->E_F5[i] += self->k_min_F5[i];
-        free(self->E_F5[i]);
-        self->l_min_F5[i] += self->k_min_F5[i];
-        self->l_max_F5[i] += self->k_min_F5[i];
-        free(self->l_min_F5[i]);
-        free(self->l_max_F5[i]);
-      }
-    }
-    free(self->E_F5);
-    free(self->l_min_F5);
-    free(self->l_max_F5);
-    free(self->k_min_F5);
-    free(self->k_max_F5);
-  }
-
-  if (self->E_F3 != NULL) {
-    for (i = 1; i <= length; i++) {
-      if (!self->E_F3[i])
-        continue;
-
-      for (cnt1 = self->k_min_F3[i]; cnt1 <= self->k_max_F3[i]; cnt1++)
-        if (self->l_min_F3[i][cnt1] < INF) {
-          self->E_F3[i][cnt1] += self->l_min_F3[i][cnt1] / 2;
-          free(self->E_F3[i][cnt1]);
-        }
-
-      if (self->k_min_F3[i] < INF) {
-        self->E_F3[i] += self->k_min_F3[i];
-        free(self->E_F3[i]);
-        self->l_min_F3[i] += self->k_min_F3[i];
-        self->l_max_F3[i] += self->k_min_F3[i];
-        free(self->l_min_F3[i]);
-        free(self->l_max_F3[i]);
-      }
-    }
-    free(self->E_F3);
-    free(self->l_min_F3);
-    free(self->l_max_F3);
-    free(self->k_min_F3);
-    free(self->k_max_F3);
-  }
-
-#ifdef COUNT_STATES
   if (self->N_C != NULL) {
     for (i = 1; i < length; i++) {
       for (j = i; j <= length; j++) {
@@ -769,39 +981,6 @@ mfe_matrices_free_2Dfold(vrna_mx_mfe_t  *self,
     free(self->N_C);
   }
 
-#endif
-
-  if (self->E_C != NULL) {
-    for (i = 1; i < length; i++) {
-      for (j = i; j <= length; j++) {
-        ij = indx[i] - j;
-        if (!self->E_C[ij])
-          continue;
-
-        for (cnt1 = self->k_min_C[ij]; cnt1 <= self->k_max_C[ij]; cnt1++)
-          if (self->l_min_C[ij][cnt1] < INF) {
-            self->E_C[ij][cnt1] += self->l_min_C[ij][cnt1] / 2;
-            free(self->E_C[ij][cnt1]);
-          }
-
-        if (self->k_min_C[ij] < INF) {
-          self->E_C[ij] += self->k_min_C[ij];
-          free(self->E_C[ij]);
-          self->l_min_C[ij] += self->k_min_C[ij];
-          self->l_max_C[ij] += self->k_min_C[ij];
-          free(self->l_min_C[ij]);
-          free(self->l_max_C[ij]);
-        }
-      }
-    }
-    free(self->E_C);
-    free(self->l_min_C);
-    free(self->l_max_C);
-    free(self->k_min_C);
-    free(self->k_max_C);
-  }
-
-#ifdef COUNT_STATES
   if (self->N_M != NULL) {
     for (i = 1; i < length; i++) {
       for (j = i; j <= length; j++) {
@@ -824,39 +1003,6 @@ mfe_matrices_free_2Dfold(vrna_mx_mfe_t  *self,
     free(self->N_M);
   }
 
-#endif
-
-  if (self->E_M != NULL) {
-    for (i = 1; i < length; i++) {
-      for (j = i; j <= length; j++) {
-        ij = indx[i] - j;
-        if (!self->E_M[ij])
-          continue;
-
-        for (cnt1 = self->k_min_M[ij]; cnt1 <= self->k_max_M[ij]; cnt1++)
-          if (self->l_min_M[ij][cnt1] < INF) {
-            self->E_M[ij][cnt1] += self->l_min_M[ij][cnt1] / 2;
-            free(self->E_M[ij][cnt1]);
-          }
-
-        if (self->k_min_M[ij] < INF) {
-          self->E_M[ij] += self->k_min_M[ij];
-          free(self->E_M[ij]);
-          self->l_min_M[ij] += self->k_min_M[ij];
-          self->l_max_M[ij] += self->k_min_M[ij];
-          free(self->l_min_M[ij]);
-          free(self->l_max_M[ij]);
-        }
-      }
-    }
-    free(self->E_M);
-    free(self->l_min_M);
-    free(self->l_max_M);
-    free(self->k_min_M);
-    free(self->k_max_M);
-  }
-
-#ifdef COUNT_STATES
   if (self->N_M1 != NULL) {
     for (i = 1; i < length; i++) {
       for (j = i; j <= length; j++) {
@@ -881,130 +1027,46 @@ mfe_matrices_free_2Dfold(vrna_mx_mfe_t  *self,
 
 #endif
 
-  if (self->E_M1 != NULL) {
-    for (i = 1; i < length; i++) {
-      for (j = i; j <= length; j++) {
-        ij = indx[i] - j;
-        if (!self->E_M1[ij])
-          continue;
-
-        for (cnt1 = self->k_min_M1[ij]; cnt1 <= self->k_max_M1[ij]; cnt1++)
-          if (self->l_min_M1[ij][cnt1] < INF) {
-            self->E_M1[ij][cnt1] += self->l_min_M1[ij][cnt1] / 2;
-            free(self->E_M1[ij][cnt1]);
-          }
-
-        if (self->k_min_M1[ij] < INF) {
-          self->E_M1[ij] += self->k_min_M1[ij];
-          free(self->E_M1[ij]);
-          self->l_min_M1[ij]  += self->k_min_M1[ij];
-          self->l_max_M1[ij]  += self->k_min_M1[ij];
-          free(self->l_min_M1[ij]);
-          free(self->l_max_M1[ij]);
-        }
-      }
-    }
-    free(self->E_M1);
-    free(self->l_min_M1);
-    free(self->l_max_M1);
-    free(self->k_min_M1);
-    free(self->k_max_M1);
-  }
-
-  if (self->E_M2 != NULL) {
-    for (i = 1; i < length - turn - 1; i++) {
-      if (!self->E_M2[i])
-        continue;
-
-      for (cnt1 = self->k_min_M2[i]; cnt1 <= self->k_max_M2[i]; cnt1++)
-        if (self->l_min_M2[i][cnt1] < INF) {
-          self->E_M2[i][cnt1] += self->l_min_M2[i][cnt1] / 2;
-          free(self->E_M2[i][cnt1]);
-        }
-
-      if (self->k_min_M2[i] < INF) {
-        self->E_M2[i] += self->k_min_M2[i];
-        free(self->E_M2[i]);
-        self->l_min_M2[i] += self->k_min_M2[i];
-        self->l_max_M2[i] += self->k_min_M2[i];
-        free(self->l_min_M2[i]);
-        free(self->l_max_M2[i]);
-      }
-    }
-    free(self->E_M2);
-    free(self->l_min_M2);
-    free(self->l_max_M2);
-    free(self->k_min_M2);
-    free(self->k_max_M2);
-  }
-
-  if (self->E_Fc != NULL) {
-    for (cnt1 = self->k_min_Fc; cnt1 <= self->k_max_Fc; cnt1++)
-      if (self->l_min_Fc[cnt1] < INF) {
-        self->E_Fc[cnt1] += self->l_min_Fc[cnt1] / 2;
-        free(self->E_Fc[cnt1]);
-      }
-
-    if (self->k_min_Fc < INF) {
-      self->E_Fc += self->k_min_Fc;
-      free(self->E_Fc);
-      self->l_min_Fc  += self->k_min_Fc;
-      self->l_max_Fc  += self->k_min_Fc;
-      free(self->l_min_Fc);
-      free(self->l_max_Fc);
-    }
-  }
-
-  if (self->E_FcI != NULL) {
-    for (cnt1 = self->k_min_FcI; cnt1 <= self->k_max_FcI; cnt1++)
-      if (self->l_min_FcI[cnt1] < INF) {
-        self->E_FcI[cnt1] += self->l_min_FcI[cnt1] / 2;
-        free(self->E_FcI[cnt1]);
-      }
-
-    if (self->k_min_FcI < INF) {
-      self->E_FcI += self->k_min_FcI;
-      free(self->E_FcI);
-      self->l_min_FcI += self->k_min_FcI;
-      self->l_max_FcI += self->k_min_FcI;
-      free(self->l_min_FcI);
-      free(self->l_max_FcI);
-    }
-  }
-
-  if (self->E_FcH != NULL) {
-    for (cnt1 = self->k_min_FcH; cnt1 <= self->k_max_FcH; cnt1++)
-      if (self->l_min_FcH[cnt1] < INF) {
-        self->E_FcH[cnt1] += self->l_min_FcH[cnt1] / 2;
-        free(self->E_FcH[cnt1]);
-      }
-
-    if (self->k_min_FcH < INF) {
-      self->E_FcH += self->k_min_FcH;
-      free(self->E_FcH);
-      self->l_min_FcH += self->k_min_FcH;
-      self->l_max_FcH += self->k_min_FcH;
-      free(self->l_min_FcH);
-      free(self->l_max_FcH);
-    }
-  }
-
-  if (self->E_FcM != NULL) {
-    for (cnt1 = self->k_min_FcM; cnt1 <= self->k_max_FcM; cnt1++)
-      if (self->l_min_FcM[cnt1] < INF) {
-        self->E_FcM[cnt1] += self->l_min_FcM[cnt1] / 2;
-        free(self->E_FcM[cnt1]);
-      }
-
-    if (self->k_min_FcM < INF) {
-      self->E_FcM += self->k_min_FcM;
-      free(self->E_FcM);
-      self->l_min_FcM += self->k_min_FcM;
-      self->l_max_FcM += self->k_min_FcM;
-      free(self->l_min_FcM);
-      free(self->l_max_FcM);
-    }
-  }
+  /*
+   *  The (k,l) arrays of all cells, including their l-boundaries,
+   *  reside in the memory pool. So we only need to release the
+   *  lookup tables indexed by (i,j)
+   */
+  free(self->E_F5);
+  free(self->l_min_F5);
+  free(self->l_max_F5);
+  free(self->k_min_F5);
+  free(self->k_max_F5);
+
+  free(self->E_F3);
+  free(self->l_min_F3);
+  free(self->l_max_F3);
+  free(self->k_min_F3);
+  free(self->k_max_F3);
+
+  free(self->E_C);
+  free(self->l_min_C);
+  free(self->l_max_C);
+  free(self->k_min_C);
+  free(self->k_max_C);
+
+  free(self->E_M);
+  free(self->l_min_M);
+  free(self->l_max_M);
+  free(self->k_min_M);
+  free(self->k_max_M);
+
+  free(self->E_M1);
+  free(self->l_min_M1);
+  free(self->l_max_M1);
+  free(self->k_min_M1);
+  free(self->k_max_M1);
+
+  free(self->E_M2);
+  free(self->l_min_M2);
+  free(self->l_max_M2);
+  free(self->k_min_M2);
+  free(self->k_max_M2);
 
   free(self->E_F5_rem);
   free(self->E_F3_rem);
@@ -1012,18 +1074,23 @@ mfe_matrices_free_2Dfold(vrna_mx_mfe_t  *self,
   free(self->E_M_rem);
   free(self->E_M1_rem);
   free(self->E_M2_rem);
+
+  vrna_arena_free(self->pool_2D);
 }
 
 
 PRIVATE void
-pf_matrices_free_default(vrna_mx_pf_t *self)
+pf_matrices_free_default(vrna_mx_pf_t         *self,
+                         vrna_mx_allocator_t  *allocator)
 {
-  free(self->q);
-  free(self->qb);
-  free(self->qm);
-  free(self->qm1);
+  size_t size = sizeof(FLT_OR_DBL) * (((size_t)self->length + 1) * (self->length + 2) / 2);
+
+  mx_release(allocator, self->q, size);
+  mx_release(allocator, self->qb, size);
+  mx_release(allocator, self->qm, size);
+  mx_release(allocator, self->qm1, size);
   free(self->qm2);
-  free(self->probs);
+  mx_release(allocator, self->probs, size);
   free(self->G);
   free(self->q1k);
   free(self->qln);
@@ -1054,235 +1121,48 @@ pf_matrices_free_2Dfold(vrna_mx_pf_t  *self,
                         int           *indx,
                         int           *jindx)
 {
-  unsigned int  i, j, ij;
-  int           cnt1;
-
-  /* This will be some fun... */
-  if (self->Q != NULL) {
-    for (i = 1; i <= length; i++) {
-      for (j = i; j <= length; j++) {
-        ij = indx[i] - j;
-        if (!self->Q[ij])
-          continue;
-
-        for (cnt1 = self->k_min_Q[ij]; cnt1 <= self->k_max_Q[ij]; cnt1++)
-          if (self->l_min_Q[ij][cnt1] < INF) {
-            self->Q[ij][cnt1] += self->l_min_Q[ij][cnt1] / 2;
-            free(self->Q[ij][cnt1]);
-          }
-
-        if (self->k_min_Q[ij] < INF) {
-          self->Q[ij] += self->k_min_Q[ij];
-          free(self->Q[ij]);
-          self->l_min_Q[ij] += self->k_min_Q[ij];
-          self->l_max_Q[ij] += self->k_min_Q[ij];
-          free(self->l_min_Q[ij]);
-          free(self->l_max_Q[ij]);
-        }
-      }
-    }
-  }
-
+  /*
+   *  The (k,l) arrays of all cells, including their l-boundaries,
+   *  reside in the memory pool. So we only need to release the
+   *  lookup tables indexed by (i,j)
+   */
   free(self->Q);
   free(self->l_min_Q);
   free(self->l_max_Q);
   free(self->k_min_Q);
   free(self->k_max_Q);
 
-  if (self->Q_B != NULL) {
-    for (i = 1; i < length; i++) {
-      for (j = i; j <= length; j++) {
-        ij = indx[i] - j;
-        if (!self->Q_B[ij])
-          continue;
-
-        for (cnt1 = self->k_min_Q_B[ij]; cnt1 <= self->k_max_Q_B[ij]; cnt1++)
-          if (self->l_min_Q_B[ij][cnt1] < INF) {
-            self->Q_B[ij][cnt1] += self->l_min_Q_B[ij][cnt1] / 2;
-            free(self->Q_B[ij][cnt1]);
-          }
-
-        if (self->k_min_Q_B[ij] < INF) {
-          self->Q_B[ij] += self->k_min_Q_B[ij];
-          free(self->Q_B[ij]);
-          self->l_min_Q_B[ij] += self->k_min_Q_B[ij];
-          self->l_max_Q_B[ij] += self->k_min_Q_B[ij];
-          free(self->l_min_Q_B[ij]);
-          free(self->l_max_Q_B[ij]);
-        }
-      }
-    }
-  }
-
   free(self->Q_B);
   free(self->l_min_Q_B);
   free(self->l_max_Q_B);
   free(self->k_min_Q_B);
   free(self->k_max_Q_B);
 
-  if (self->Q_M != NULL) {
-    for (i = 1; i < length; i++) {
-      for (j = i; j <= length; j++) {
-        ij = indx[i] - j;
-        if (!self->Q_M[ij])
-          continue;
-
-        for (cnt1 = self->k_min_Q_M[ij]; cnt1 <= self->k_max_Q_M[ij]; cnt1++)
-          if (self->l_min_Q_M[ij][cnt1] < INF) {
-            self->Q_M[ij][cnt1] += self->l_min_Q_M[ij][cnt1] / 2;
-            free(self->Q_M[ij][cnt1]);
-          }
-
-        if (self->k_min_Q_M[ij] < INF) {
-          self->Q_M[ij] += self->k_min_Q_M[ij];
-          free(self->Q_M[ij]);
-          self->l_min_Q_M[ij] += self->k_min_Q_M[ij];
-          self->l_max_Q_M[ij] += self->k_min_Q_M[ij];
-          free(self->l_min_Q_M[ij]);
-          free(self->l_max_Q_M[ij]);
-        }
-      }
-    }
-  }
-
   free(self->Q_M);
   free(self->l_min_Q_M);
   free(self->l_max_Q_M);
   free(self->k_min_Q_M);
   free(self->k_max_Q_M);
 
-  if (self->Q_M1 != NULL) {
-    for (i = 1; i < length; i++) {
-      for (j = i; j <= length; j++) {
-        ij = jindx[j] + i;
-        if (!self->Q_M1[ij])
-          continue;
-
-        for (cnt1 = self->k_min_Q_M1[ij]; cnt1 <= self->k_max_Q_M1[ij]; cnt1++)
-          if (self->l_min_Q_M1[ij][cnt1] < INF) {
-            self->Q_M1[ij][cnt1] += self->l_min_Q_M1[ij][cnt1] / 2;
-            free(self->Q_M1[ij][cnt1]);
-          }
-
-        if (self->k_min_Q_M1[ij] < INF) {
-          self->Q_M1[ij] += self->k_min_Q_M1[ij];
-          free(self->Q_M1[ij]);
-          self->l_min_Q_M1[ij]  += self->k_min_Q_M1[ij];
-          self->l_max_Q_M1[ij]  += self->k_min_Q_M1[ij];
-          free(self->l_min_Q_M1[ij]);
-          free(self->l_max_Q_M1[ij]);
-        }
-      }
-    }
-  }
-
   free(self->Q_M1);
   free(self->l_min_Q_M1);
   free(self->l_max_Q_M1);
   free(self->k_min_Q_M1);
   free(self->k_max_Q_M1);
 
-  if (self->Q_M2 != NULL) {
-    for (i = 1; i < length - turn - 1; i++) {
-      if (!self->Q_M2[i])
-        continue;
-
-      for (cnt1 = self->k_min_Q_M2[i]; cnt1 <= self->k_max_Q_M2[i]; cnt1++)
-        if (self->l_min_Q_M2[i][cnt1] < INF) {
-          self->Q_M2[i][cnt1] += self->l_min_Q_M2[i][cnt1] / 2;
-          free(self->Q_M2[i][cnt1]);
-        }
-
-      if (self->k_min_Q_M2[i] < INF) {
-        self->Q_M2[i] += self->k_min_Q_M2[i];
-        free(self->Q_M2[i]);
-        self->l_min_Q_M2[i] += self->k_min_Q_M2[i];
-        self->l_max_Q_M2[i] += self->k_min_Q_M2[i];
-        free(self->l_min_Q_M2[i]);
-        free(self->l_max_Q_M2[i]);
-      }
-    }
-  }
-
   free(self->Q_M2);
   free(self->l_min_Q_M2);
   free(self->l_max_Q_M2);
   free(self->k_min_Q_M2);
   free(self->k_max_Q_M2);
 
-  if (self->Q_c != NULL) {
-    for (cnt1 = self->k_min_Q_c; cnt1 <= self->k_max_Q_c; cnt1++)
-      if (self->l_min_Q_c[cnt1] < INF) {
-        self->Q_c[cnt1] += self->l_min_Q_c[cnt1] / 2;
-        free(self->Q_c[cnt1]);
-      }
-
-    if (self->k_min_Q_c < INF) {
-      self->Q_c += self->k_min_Q_c;
-      free(self->Q_c);
-      self->l_min_Q_c += self->k_min_Q_c;
-      self->l_max_Q_c += self->k_min_Q_c;
-      free(self->l_min_Q_c);
-      free(self->l_max_Q_c);
-    }
-  }
-
-  if (self->Q_cI != NULL) {
-    for (cnt1 = self->k_min_Q_cI; cnt1 <= self->k_max_Q_cI; cnt1++)
-      if (self->l_min_Q_cI[cnt1] < INF) {
-        self->Q_cI[cnt1] += self->l_min_Q_cI[cnt1] / 2;
-        free(self->Q_cI[cnt1]);
-      }
-
-    if (self->k_min_Q_cI < INF) {
-      self->Q_cI += self->k_min_Q_cI;
-      free(self->Q_cI);
-      self->l_min_Q_cI  += self->k_min_Q_cI;
-      self->l_max_Q_cI  += self->k_min_Q_cI;
-      free(self->l_min_Q_cI);
-      free(self->l_max_Q_cI);
-    }
-  }
-
-  if (self->Q_cH != NULL) {
-    for (cnt1 = self->k_min_Q_cH; cnt1 <= self->k_max_Q_cH; cnt1++)
-      if (self->l_min_Q_cH[cnt1] < INF) {
-        self->Q_cH[cnt1] += self->l_min_Q_cH[cnt1] / 2;
-        free(self->Q_cH[cnt1]);
-      }
-
-    if (self->k_min_Q_cH < INF) {
-      self->Q_cH += self->k_min_Q_cH;
-      free(self->Q_cH);
-      self->l_min_Q_cH  += self->k_min_Q_cH;
-      self->l_max_Q_cH  += self->k_min_Q_cH;
-      free(self->l_min_Q_cH);
-      free(self->l_max_Q_cH);
-    }
-  }
-
-  if (self->Q_cM != NULL) {
-    for (cnt1 = self->k_min_Q_cM; cnt1 <= self->k_max_Q_cM; cnt1++)
-      if (self->l_min_Q_cM[cnt1] < INF) {
-        self->Q_cM[cnt1] += self->l_min_Q_cM[cnt1] / 2;
-        free(self->Q_cM[cnt1]);
-      }
-
-    if (self->k_min_Q_cM < INF) {
-      self->Q_cM += self->k_min_Q_cM;
-      free(self->Q_cM);
-      self->l_min_Q_cM  += self->k_min_Q_cM;
-      self->l_max_Q_cM  += self->k_min_Q_cM;
-      free(self->l_min_Q_cM);
-      free(self->l_max_Q_cM);
-    }
-  }
-
   free(self->Q_rem);
   free(self->Q_B_rem);
   free(self->Q_M_rem);
   free(self->Q_M1_rem);
   free(self->Q_M2_rem);
+
+  vrna_arena_free(self->pool_2D);
 }
 
 
@@ -1334,13 +1214,13 @@ init_mx_mfe_default(vrna_fold_compound_t  *fc,
     }
 
     if (alloc_vector & ALLOC_C)
-      mx->c = (int *)vrna_alloc(sizeof(int) * size);
+      mx->c = (int *)mx_alloc(fc->mx_allocator, sizeof(int) * size);
 
     if (alloc_vector & ALLOC_FML)
-      mx->fML = (int *)vrna_alloc(sizeof(int) * size);
+      mx->fML = (int *)mx_alloc(fc->mx_allocator, sizeof(int) * size);
 
     if (alloc_vector & ALLOC_UNIQ)
-      mx->fM1 = (int *)vrna_alloc(sizeof(int) * size);
+      mx->fM1 = (int *)mx_alloc(fc->mx_allocator, sizeof(int) * size);
 
     if (alloc_vector & ALLOC_CIRC)
       mx->fM2 = (int *)vrna_alloc(sizeof(int) * lin_size);
@@ -1423,6 +1303,7 @@ init_mx_mfe_2Dfold(vrna_fold_compound_t *fc,
     lin_size    = n + 2;
     mx->length  = n;
     mx->strands = fc->strands;
+    mx->pool_2D = vrna_arena_init(0);
 
     if (alloc_vector & ALLOC_F5) {
       mx->E_F5      = (int ***)vrna_alloc(sizeof(int **) * lin_size);
@@ -1604,6 +1485,8 @@ nullify_mfe(vrna_mx_mfe_t *mx)
         mx->k_max_FcM = 0;
         mx->E_FcM_rem = INF;
 
+        mx->pool_2D = NULL;
+
 #ifdef COUNT_STATES
         mx->N_F5  = NULL;
         mx->N_C   = NULL;
@@ -1647,22 +1530,22 @@ init_mx_pf_default(vrna_fold_compound_t *fc,
     mx->length  = n;
 
     if (alloc_vector & ALLOC_F)
-      mx->q = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+      mx->q = (FLT_OR_DBL *)mx_alloc(fc->mx_allocator, sizeof(FLT_OR_DBL) * size);
 
     if (alloc_vector & ALLOC_C)
-      mx->qb = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+      mx->qb = (FLT_OR_DBL *)mx_alloc(fc->mx_allocator, sizeof(FLT_OR_DBL) * size);
 
     if (alloc_vector & ALLOC_FML)
-      mx->qm = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+      mx->qm = (FLT_OR_DBL *)mx_alloc(fc->mx_allocator, sizeof(FLT_OR_DBL) * size);
 
     if (alloc_vector & ALLOC_UNIQ)
-      mx->qm1 = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+      mx->qm1 = (FLT_OR_DBL *)mx_alloc(fc->mx_allocator, sizeof(FLT_OR_DBL) * size);
 
     if (alloc_vector & ALLOC_CIRC)
       mx->qm2 = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * lin_size);
 
     if (alloc_vector & ALLOC_PROBS)
-      mx->probs = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * size);
+      mx->probs = (FLT_OR_DBL *)mx_alloc(fc->mx_allocator, sizeof(FLT_OR_DBL) * size);
 
     if (alloc_vector & ALLOC_AUX) {
       mx->q1k = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * lin_size);
@@ -1768,6 +1651,7 @@ init_mx_pf_2Dfold(vrna_fold_compound_t  *fc,
     size        = ((n + 1) * (n + 2)) / 2;
     lin_size    = n + 2;
     mx->length  = n;
+    mx->pool_2D = vrna_arena_init(0);
 
     if (alloc_vector & ALLOC_F) {
       mx->Q       = (FLT_OR_DBL ***)vrna_alloc(sizeof(FLT_OR_DBL * *) * size);
@@ -1922,6 +1806,8 @@ nullify_pf(vrna_mx_pf_t *mx)
         mx->k_max_Q_cM  = 0;
         mx->Q_cM_rem    = 0.;
 
+        mx->pool_2D = NULL;
+
         break;
     }
   }
@@ -16,12 +16,56 @@
  *
  */
 
+#include <stddef.h>
+
 /** @brief Typename for the Minimum Free Energy (MFE) DP matrices data structure #vrna_mx_mfe_s */
 typedef struct  vrna_mx_mfe_s vrna_mx_mfe_t;
 /** @brief Typename for the Partition Function (PF) DP matrices data structure #vrna_mx_pf_s */
 typedef struct  vrna_mx_pf_s vrna_mx_pf_t;
+/** @brief Typename for the (opaque) DP matrix memory allocator data structure */
+typedef struct  vrna_mx_allocator_s vrna_mx_allocator_t;
+
+/**
+ *  @brief  Callback to allocate memory for a Dynamic Programming (DP) matrix
+ *
+ *  @callback
+ *  @parblock
+ *  This function is called whenever one of the large, triangular default DP matrices of a
+ *  #vrna_fold_compound_t is created. It must return a pointer to @p size bytes of memory
+ *  that are initialized to zero, or @p NULL if the allocation failed.
+ *  @endparblock
+ *
+ *  @see  vrna_mx_allocator_set(), vrna_callback_mx_release()
+ *
+ *  @param  size  The number of bytes requested
+ *  @param  data  The auxiliary data passed to vrna_mx_allocator_set()
+ *  @return       A pointer to the zero-initialized memory block
+ */
+typedef void *(vrna_callback_mx_alloc)(size_t size,
+                                      void   *data);
+
+/**
+ *  @brief  Callback to release memory of a Dynamic Programming (DP) matrix
+ *
+ *  @callback
+ *  @parblock
+ *  This function is called to release a memory block previously obtained from the
+ *  corresponding #vrna_callback_mx_alloc function. It receives the same @p size that
+ *  has been requested upon allocation.
+ *  @endparblock
+ *
+ *  @see  vrna_mx_allocator_set(), vrna_callback_mx_alloc()
+ *
+ *  @param  ptr   The memory block to release
+ *  @param  size  The number of bytes requested upon allocation of @p ptr
+ *  @param  data  The auxiliary data passed to vrna_mx_allocator_set()
+ */
+typedef void (vrna_callback_mx_release)(void   *ptr,
+                                        size_t size,
+                                        void   *data);
 
 #include <ViennaRNA/datastructures/basic.h>
+#include <ViennaRNA/datastructures/arena.h>
 #include <ViennaRNA/fold_compound.h>
 
 /**
@@ -198,6 +242,8 @@ struct {
 };
 };
 #endif
+
+  vrna_arena_t  pool_2D;  /**<  @brief  Pooled storage of all (k,l) distance class arrays (only for #VRNA_MX_2DFOLD) */
 };
 
 /**
@@ -356,6 +402,8 @@ struct {
 };
 };
 #endif
+
+  vrna_arena_t  pool_2D;  /**<  @brief  Pooled storage of all (k,l) distance class arrays (only for #VRNA_MX_2DFOLD) */
 };
 
 /**
@@ -432,6 +480,72 @@ void
 vrna_mx_pf_free(vrna_fold_compound_t *vc);
 
 
+/**
+ *  @brief  Option flag for vrna_mx_allocator_pages() to request transparent huge pages
+ *
+ *  Memory regions of the DP matrices are advised to be backed by transparent huge pages
+ *  via @p madvise(), which reduces the number of TLB misses for long sequences.
+ *
+ *  @see  vrna_mx_allocator_pages(), #VRNA_MX_ALLOC_HUGETLB
+ */
+#define VRNA_MX_ALLOC_HUGE_PAGES    1U
+
+/**
+ *  @brief  Option flag for vrna_mx_allocator_pages() to request explicit huge pages
+ *
+ *  DP matrices are mapped from the pool of pre-allocated (explicit) 2 MB huge pages. If the pool
+ *  is exhausted, the allocator silently falls back to regular pages.
+ *
+ *  @see  vrna_mx_allocator_pages(), #VRNA_MX_ALLOC_HUGE_PAGES
+ */
+#define VRNA_MX_ALLOC_HUGETLB       2U
+
+
+/**
+ *  @brief  Set a custom memory allocator for the default DP matrices of a #vrna_fold_compound_t
+ *
+ *  The allocator is used for the large triangular matrices of the default MFE and PF
+ *  DP matrices, i.e. #vrna_mx_mfe_t.c, #vrna_mx_mfe_t.fML, #vrna_mx_mfe_t.fM1, and
+ *  #vrna_mx_pf_t.q, #vrna_mx_pf_t.qb, #vrna_mx_pf_t.qm, #vrna_mx_pf_t.qm1, #vrna_mx_pf_t.probs.
+ *  Any default DP matrices currently attached to @p fc are re-created with the new
+ *  allocator, hence this function should be called before any structure prediction.
+ *  Passing @p NULL as @p alloc restores the default heap allocator.
+ *
+ *  @see  vrna_mx_allocator_pages(), vrna_callback_mx_alloc(), vrna_callback_mx_release()
+ *
+ *  @param  fc      The fold compound
+ *  @param  alloc   The allocation callback (or @p NULL)
+ *  @param  release The release callback
+ *  @param  data    Auxiliary data passed through to @p alloc and @p release
+ *  @return         1 on success, 0 otherwise
+ */
+int
+vrna_mx_allocator_set(vrna_fold_compound_t      *fc,
+                      vrna_callback_mx_alloc    *alloc,
+                      vrna_callback_mx_release  *release,
+                      void                      *data);
+
+
+/**
+ *  @brief  Use the built-in page allocator for the default DP matrices of a #vrna_fold_compound_t
+ *
+ *  Each large DP matrix is placed in a freshly mapped, anonymous memory region that is returned
+ *  to the operating system upon release. Since no page is touched at allocation time, the
+ *  physical memory is placed on the NUMA node of the thread that first writes to it, i.e. the
+ *  thread that fills the matrix. Small matrices are still taken from the heap. On systems without
+ *  @p mmap() this is equivalent to the default allocator.
+ *
+ *  @see  vrna_mx_allocator_set(), #VRNA_MX_ALLOC_HUGE_PAGES, #VRNA_MX_ALLOC_HUGETLB
+ *
+ *  @param  fc      The fold compound
+ *  @param  options Zero, or a bitwise OR of #VRNA_MX_ALLOC_HUGE_PAGES and #VRNA_MX_ALLOC_HUGETLB
+ *  @return         1 on success, 0 otherwise
+ */
+int
+vrna_mx_allocator_pages(vrna_fold_compound_t  *fc,
+                        unsigned int          options);
+
+
 /**
  *  @}
  */
@@ -18,6 +18,7 @@
 #include <ctype.h>
 #include <string.h>
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/alphabet.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/fold.h"
@@ -41,6 +42,25 @@
 #define NONE -10000         /* score for forbidden pairs */
 
 
+struct vrna_duplex_s {
+  vrna_param_t  *P;           /* energy parameters */
+  int           own_params;   /* whether or not P belongs to this context */
+  int           *c_mem;       /* memory of the energy array */
+  int           **c;          /* energy array, given that i-j pair */
+  size_t        c_size;       /* number of allocated cells in c_mem */
+  int           c_rows;       /* number of allocated rows in c */
+  const short   *S1, *SS1;    /* encodings of the first sequence */
+  const short   *S2, *SS2;    /* encodings of the second sequence */
+  int           n1, n2;       /* sequence lengths */
+};
+
+/* the two numerical encodings of a sequence required for duplex predictions */
+struct duplex_seq {
+  short *S;
+  short *SS;
+};
+
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -51,16 +71,20 @@
  # PRIVATE VARIABLES             #
  #################################
  */
+
+/*
+ *  Static state used by the comparative (alignment) duplex functions. All
+ *  single sequence functions operate on a vrna_duplex_t context instead
+ */
 PRIVATE vrna_param_t  *P = NULL;
 PRIVATE int           **c = NULL;     /* energy array, given that i-j pair */
-PRIVATE short         *S1 = NULL, *SS1 = NULL, *S2 = NULL, *SS2 = NULL;
 PRIVATE int           n1, n2;         /* sequence lengths */
 
 #ifdef _OPENMP
 
 /* NOTE: all variables are assumed to be uninitialized if they are declared as threadprivate
  */
-#pragma omp threadprivate(P, c, S1, SS1, S2, SS2, n1, n2)
+#pragma omp threadprivate(P, c, n1, n2)
 
 #endif
 
@@ -69,10 +93,42 @@ PRIVATE int           n1, n2;         /* sequence lengths */
  # PRIVATE FUNCTION DECLARATIONS #
  #################################
  */
+PRIVATE vrna_param_t *
+get_compat_params(void);
+
+
+PRIVATE struct vrna_duplex_s *
+duplex_init(vrna_param_t  *params,
+            int           own_params);
+
+
+PRIVATE void
+duplex_seq_encode(struct duplex_seq *enc,
+                  const char        *s,
+                  vrna_md_t         *md);
+
+
+PRIVATE void
+duplex_seq_free(struct duplex_seq *enc);
+
+
+PRIVATE void
+duplex_prepare(struct vrna_duplex_s     *dup,
+               const struct duplex_seq  *seq1,
+               const struct duplex_seq  *seq2);
+
+
 PRIVATE duplexT
-duplexfold_cu(const char  *s1,
-              const char  *s2,
-              int         clean_up);
+duplex_mfe(struct vrna_duplex_s *dup);
+
+
+PRIVATE duplexT *
+duplex_subopt_list(struct vrna_duplex_s *dup,
+                   double               mfe,
+                   int                  delta,
+                   int                  w,
+                   int                  sorted,
+                   int                  verbose);
 
 
 PRIVATE duplexT
@@ -82,8 +138,9 @@ aliduplexfold_cu(const char *s1[],
 
 
 PRIVATE char *
-backtrack(int i,
-          int j);
+backtrack(struct vrna_duplex_s  *dup,
+          int                   i,
+          int                   j);
 
 
 PRIVATE char *
@@ -108,26 +165,193 @@ covscore(const int  *types,
  # BEGIN OF FUNCTION DEFINITIONS #
  #################################
  */
+PUBLIC struct vrna_duplex_s *
+vrna_duplex_init(vrna_md_t *md_p)
+{
+  vrna_md_t md;
+
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  return duplex_init(vrna_params(&md), 1);
+}
+
+
+PUBLIC void
+vrna_duplex_free(struct vrna_duplex_s *dup)
+{
+  if (dup) {
+    if (dup->own_params)
+      free(dup->P);
+
+    free(dup->c_mem);
+    free(dup->c);
+    free(dup);
+  }
+}
+
+
 PUBLIC duplexT
-duplexfold(const char *s1,
-           const char *s2)
+vrna_duplex_mfe(struct vrna_duplex_s  *dup,
+                const char            *s1,
+                const char            *s2)
 {
-  return duplexfold_cu(s1, s2, 1);
+  duplexT           mfe;
+  struct duplex_seq seq1, seq2;
+
+  memset(&mfe, 0, sizeof(duplexT));
+
+  if ((dup) && (s1) && (s2)) {
+    duplex_seq_encode(&seq1, s1, &(dup->P->model_details));
+    duplex_seq_encode(&seq2, s2, &(dup->P->model_details));
+
+    duplex_prepare(dup, &seq1, &seq2);
+    mfe = duplex_mfe(dup);
+
+    duplex_seq_free(&seq1);
+    duplex_seq_free(&seq2);
+  }
+
+  return mfe;
 }
 
 
-PRIVATE duplexT
-duplexfold_cu(const char  *s1,
-              const char  *s2,
-              int         clean_up)
+PUBLIC duplexT *
+vrna_duplex_subopt(struct vrna_duplex_s *dup,
+                   const char           *s1,
+                   const char           *s2,
+                   int                  delta,
+                   int                  w,
+                   int                  sorted)
 {
-  int       i, j, Emin = INF, i_min = 0, j_min = 0;
-  char      *struc;
-  duplexT   mfe;
-  vrna_md_t md;
+  duplexT           mfe, *subopt;
+  struct duplex_seq seq1, seq2;
+
+  subopt = NULL;
+
+  if ((dup) && (s1) && (s2)) {
+    duplex_seq_encode(&seq1, s1, &(dup->P->model_details));
+    duplex_seq_encode(&seq2, s2, &(dup->P->model_details));
+
+    duplex_prepare(dup, &seq1, &seq2);
+    mfe = duplex_mfe(dup);
+    free(mfe.structure);
+
+    subopt = duplex_subopt_list(dup, mfe.energy, delta, w, sorted, 0);
+
+    duplex_seq_free(&seq1);
+    duplex_seq_free(&seq2);
+  }
+
+  return subopt;
+}
+
+
+PUBLIC duplexT **
+vrna_duplex_batch(const char  **queries,
+                  const char  **targets,
+                  vrna_md_t   *md_p,
+                  int         delta,
+                  int         w,
+                  int         jobs)
+{
+  long              num_tasks, t;
+  unsigned int      num_queries, num_targets, q;
+  duplexT           **results;
+  vrna_md_t         md;
+  vrna_param_t      *params;
+  struct duplex_seq *enc_q, *enc_t;
+
+  if ((!queries) || (!targets))
+    return NULL;
+
+  for (num_queries = 0; queries[num_queries]; num_queries++);
+  for (num_targets = 0; targets[num_targets]; num_targets++);
+
+  num_tasks = (long)num_queries * (long)num_targets;
+  results   = (duplexT **)vrna_alloc(sizeof(duplexT *) * (num_tasks + 1));
+
+  if (num_tasks == 0)
+    return results;
+
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  /* energy parameters and sequence encodings are shared among all threads */
+  params  = vrna_params(&md);
+  enc_q   = (struct duplex_seq *)vrna_alloc(sizeof(struct duplex_seq) * num_queries);
+  enc_t   = (struct duplex_seq *)vrna_alloc(sizeof(struct duplex_seq) * num_targets);
+
+  for (q = 0; q < num_queries; q++)
+    duplex_seq_encode(enc_q + q, queries[q], &(params->model_details));
 
-  n1  = (int)strlen(s1);
-  n2  = (int)strlen(s2);
+  for (q = 0; q < num_targets; q++)
+    duplex_seq_encode(enc_t + q, targets[q], &(params->model_details));
+
+#ifdef _OPENMP
+  if (jobs <= 0)
+    jobs = omp_get_max_threads();
+
+#pragma omp parallel num_threads(jobs)
+#else
+  (void)jobs;
+#endif
+  {
+    duplexT               mfe;
+    struct vrna_duplex_s  *dup;
+
+    /* each thread re-uses its own DP matrices for all of its tasks */
+    dup = duplex_init(params, 0);
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+    for (t = 0; t < num_tasks; t++) {
+      duplex_prepare(dup,
+                     enc_q + t / num_targets,
+                     enc_t + t % num_targets);
+
+      mfe = duplex_mfe(dup);
+
+      if (delta >= 0) {
+        free(mfe.structure);
+        results[t] = duplex_subopt_list(dup, mfe.energy, delta, w, 1, 0);
+      } else {
+        results[t]    = (duplexT *)vrna_alloc(sizeof(duplexT) * 2);
+        results[t][0] = mfe;
+      }
+    }
+
+    vrna_duplex_free(dup);
+  }
+
+  for (q = 0; q < num_queries; q++)
+    duplex_seq_free(enc_q + q);
+
+  for (q = 0; q < num_targets; q++)
+    duplex_seq_free(enc_t + q);
+
+  free(enc_q);
+  free(enc_t);
+  free(params);
+
+  return results;
+}
+
+
+/*
+ #################################
+ # STATIC helper functions below #
+ #################################
+ */
+PRIVATE vrna_param_t *
+get_compat_params(void)
+{
+  vrna_md_t md;
 
   set_model_details(&md);
   if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
@@ -138,19 +362,106 @@ duplexfold_cu(const char  *s1,
     make_pair_matrix();
   }
 
-  c = (int **)vrna_alloc(sizeof(int *) * (n1 + 1));
-  for (i = 1; i <= n1; i++)
-    c[i] = (int *)vrna_alloc(sizeof(int) * (n2 + 1));
+  return P;
+}
+
+
+PRIVATE struct vrna_duplex_s *
+duplex_init(vrna_param_t  *params,
+            int           own_params)
+{
+  struct vrna_duplex_s *dup;
+
+  dup             = (struct vrna_duplex_s *)vrna_alloc(sizeof(struct vrna_duplex_s));
+  dup->P          = params;
+  dup->own_params = own_params;
+  dup->c_mem      = NULL;
+  dup->c          = NULL;
+  dup->c_size     = 0;
+  dup->c_rows     = 0;
+
+  return dup;
+}
+
+
+PRIVATE void
+duplex_seq_encode(struct duplex_seq *enc,
+                  const char        *s,
+                  vrna_md_t         *md)
+{
+  enc->S  = vrna_seq_encode_simple(s, md);
+  enc->SS = vrna_seq_encode(s, md);
+}
+
+
+PRIVATE void
+duplex_seq_free(struct duplex_seq *enc)
+{
+  free(enc->S);
+  free(enc->SS);
+}
 
-  S1  = encode_sequence(s1, 0);
-  S2  = encode_sequence(s2, 0);
-  SS1 = encode_sequence(s1, 1);
-  SS2 = encode_sequence(s2, 1);
+
+PRIVATE void
+duplex_prepare(struct vrna_duplex_s     *dup,
+               const struct duplex_seq  *seq1,
+               const struct duplex_seq  *seq2)
+{
+  int     i;
+  size_t  size;
+
+  dup->S1   = seq1->S;
+  dup->SS1  = seq1->SS;
+  dup->S2   = seq2->S;
+  dup->SS2  = seq2->SS;
+  dup->n1   = (int)seq1->S[0];
+  dup->n2   = (int)seq2->S[0];
+
+  /* the energy array only ever grows, such that it can be re-used for subsequent duplexes */
+  size = (size_t)dup->n1 * (size_t)(dup->n2 + 1);
+
+  if (size > dup->c_size) {
+    free(dup->c_mem);
+    dup->c_mem  = (int *)vrna_alloc(sizeof(int) * size);
+    dup->c_size = size;
+  }
+
+  if (dup->n1 + 1 > dup->c_rows) {
+    dup->c      = (int **)vrna_realloc(dup->c, sizeof(int *) * (dup->n1 + 1));
+    dup->c_rows = dup->n1 + 1;
+  }
+
+  for (i = 1; i <= dup->n1; i++)
+    dup->c[i] = dup->c_mem + (size_t)(i - 1) * (dup->n2 + 1);
+}
+
+
+PRIVATE duplexT
+duplex_mfe(struct vrna_duplex_s *dup)
+{
+  int           i, j, n1, n2, Emin = INF, i_min = 0, j_min = 0, **c;
+  char          *struc;
+  const short   *S1, *S2, *SS1, *SS2;
+  duplexT       mfe;
+  vrna_param_t  *P;
+  vrna_md_t     *md;
+
+  P   = dup->P;
+  md  = &(P->model_details);
+  c   = dup->c;
+  n1  = dup->n1;
+  n2  = dup->n2;
+  S1  = dup->S1;
+  S2  = dup->S2;
+  SS1 = dup->SS1;
+  SS2 = dup->SS2;
+
+  memset(&mfe, 0, sizeof(duplexT));
 
   for (i = 1; i <= n1; i++) {
     for (j = n2; j > 0; j--) {
       int type, type2, E, k, l;
-      type    = pair[S1[i]][S2[j]];
+      type    = md->pair[S1[i]][S2[j]];
       c[i][j] = type ? P->DuplexInit : INF;
       if (!type)
         continue;
@@ -161,17 +472,17 @@ duplexfold_cu(const char  *s1,
           if (i - k + l - j - 2 > MAXLOOP)
             break;
 
-          type2 = pair[S1[k]][S2[l]];
+          type2 = md->pair[S1[k]][S2[l]];
           if (!type2)
             continue;
 
-          E = E_IntLoop(i - k - 1, l - j - 1, type2, rtype[type],
+          E = E_IntLoop(i - k - 1, l - j - 1, type2, md->rtype[type],
                         SS1[k + 1], SS2[l - 1], SS1[i - 1], SS2[j + 1], P);
           c[i][j] = MIN2(c[i][j], c[k][l] + E);
         }
       }
       E = c[i][j];
-      E += vrna_E_ext_stem(rtype[type], (j > 1) ? SS2[j - 1] : -1, (i < n1) ? SS1[i + 1] : -1, P);
+      E += vrna_E_ext_stem(md->rtype[type], (j > 1) ? SS2[j - 1] : -1, (i < n1) ? SS1[i + 1] : -1, P);
       if (E < Emin) {
         Emin  = E;
         i_min = i;
@@ -180,7 +491,7 @@ duplexfold_cu(const char  *s1,
     }
   }
 
-  struc = backtrack(i_min, j_min);
+  struc = backtrack(dup, i_min, j_min);
   if (i_min < n1)
     i_min++;
 
@@ -191,43 +502,44 @@ duplexfold_cu(const char  *s1,
   mfe.j         = j_min;
   mfe.energy    = (float)Emin / 100.;
   mfe.structure = struc;
-  if (clean_up) {
-    for (i = 1; i <= n1; i++)
-      free(c[i]);
-    free(c);
-    free(S1);
-    free(S2);
-    free(SS1);
-    free(SS2);
-  }
 
   return mfe;
 }
 
 
-PUBLIC duplexT *
-duplex_subopt(const char  *s1,
-              const char  *s2,
-              int         delta,
-              int         w)
+PRIVATE duplexT *
+duplex_subopt_list(struct vrna_duplex_s *dup,
+                   double               mfe,
+                   int                  delta,
+                   int                  w,
+                   int                  sorted,
+                   int                  verbose)
 {
-  int     i, j, n1, n2, thresh, E, n_subopt = 0, n_max;
-  char    *struc;
-  duplexT mfe;
-  duplexT *subopt;
+  int           i, j, n1, n2, thresh, E, n_subopt = 0, n_max, **c;
+  char          *struc;
+  const short   *S1, *S2, *SS1, *SS2;
+  duplexT       *subopt;
+  vrna_param_t  *P;
+  vrna_md_t     *md;
+
+  P   = dup->P;
+  md  = &(P->model_details);
+  c   = dup->c;
+  n1  = dup->n1;
+  n2  = dup->n2;
+  S1  = dup->S1;
+  S2  = dup->S2;
+  SS1 = dup->SS1;
+  SS2 = dup->SS2;
 
   n_max   = 16;
   subopt  = (duplexT *)vrna_alloc(n_max * sizeof(duplexT));
-  mfe     = duplexfold_cu(s1, s2, 0);
-  free(mfe.structure);
+  thresh  = (int)mfe * 100 + 0.1 + delta;
 
-  thresh  = (int)mfe.energy * 100 + 0.1 + delta;
-  n1      = strlen(s1);
-  n2      = strlen(s2);
   for (i = n1; i > 0; i--) {
     for (j = 1; j <= n2; j++) {
       int type, ii, jj, Ed;
-      type = pair[S2[j]][S1[i]];
+      type = md->pair[S2[j]][S1[i]];
       if (!type)
         continue;
 
@@ -250,8 +562,10 @@ duplex_subopt(const char  *s1,
       if (!type)
         continue;
 
-      struc = backtrack(i, j);
-      vrna_message_info(stderr, "%d %d %d", i, j, E);
+      struc = backtrack(dup, i, j);
+      if (verbose)
+        vrna_message_info(stderr, "%d %d %d", i, j, E);
+
       if (n_subopt + 1 >= n_max) {
         n_max   *= 2;
         subopt  = (duplexT *)vrna_realloc(subopt, n_max * sizeof(duplexT));
@@ -263,16 +577,8 @@ duplex_subopt(const char  *s1,
       subopt[n_subopt++].structure  = struc;
     }
   }
-  /* free all static globals */
-  for (i = 1; i <= n1; i++)
-    free(c[i]);
-  free(c);
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
 
-  if (subopt_sorted)
+  if (sorted)
     qsort(subopt, n_subopt, sizeof(duplexT), compare);
 
   subopt[n_subopt].i          = 0;
@@ -283,13 +589,27 @@ duplex_subopt(const char  *s1,
 
 
 PRIVATE char *
-backtrack(int i,
-          int j)
+backtrack(struct vrna_duplex_s  *dup,
+          int                   i,
+          int                   j)
 {
   /* backtrack structure going backwards from i, and forwards from j
    * return structure in bracket notation with & as separator */
-  int   k, l, type, type2, E, traced, i0, j0;
-  char  *st1, *st2, *struc;
+  int           k, l, type, type2, E, traced, i0, j0, n1, n2, **c;
+  char          *st1, *st2, *struc;
+  const short   *S1, *S2, *SS1, *SS2;
+  vrna_param_t  *P;
+  vrna_md_t     *md;
+
+  P   = dup->P;
+  md  = &(P->model_details);
+  c   = dup->c;
+  n1  = dup->n1;
+  n2  = dup->n2;
+  S1  = dup->S1;
+  S2  = dup->S2;
+  SS1 = dup->SS1;
+  SS2 = dup->SS2;
 
   st1 = (char *)vrna_alloc(sizeof(char) * (n1 + 1));
   st2 = (char *)vrna_alloc(sizeof(char) * (n2 + 1));
@@ -302,7 +622,7 @@ backtrack(int i,
     traced      = 0;
     st1[i - 1]  = '(';
     st2[j - 1]  = ')';
-    type        = pair[S1[i]][S2[j]];
+    type        = md->pair[S1[i]][S2[j]];
     if (!type)
       vrna_message_error("backtrack failed in fold duplex");
 
@@ -312,11 +632,11 @@ backtrack(int i,
         if (i - k + l - j - 2 > MAXLOOP)
           break;
 
-        type2 = pair[S1[k]][S2[l]];
+        type2 = md->pair[S1[k]][S2[l]];
         if (!type2)
           continue;
 
-        LE = E_IntLoop(i - k - 1, l - j - 1, type2, rtype[type],
+        LE = E_IntLoop(i - k - 1, l - j - 1, type2, md->rtype[type],
                        SS1[k + 1], SS2[l - 1], SS1[i - 1], SS2[j + 1], P);
         if (E == c[k][l] + LE) {
           traced  = 1;
@@ -385,6 +705,55 @@ compare(const void  *sub1,
 }
 
 
+/*
+ #################################
+ # DEPRECATED FUNCTIONS BELOW    #
+ #################################
+ */
+PUBLIC duplexT
+duplexfold(const char *s1,
+           const char *s2)
+{
+  duplexT               mfe;
+  struct vrna_duplex_s  *dup;
+
+  dup = duplex_init(get_compat_params(), 0);
+  mfe = vrna_duplex_mfe(dup, s1, s2);
+  vrna_duplex_free(dup);
+
+  return mfe;
+}
+
+
+PUBLIC duplexT *
+duplex_subopt(const char  *s1,
+              const char  *s2,
+              int         delta,
+              int         w)
+{
+  duplexT               mfe, *subopt;
+  struct duplex_seq     seq1, seq2;
+  struct vrna_duplex_s  *dup;
+
+  dup = duplex_init(get_compat_params(), 0);
+
+  duplex_seq_encode(&seq1, s1, &(dup->P->model_details));
+  duplex_seq_encode(&seq2, s2, &(dup->P->model_details));
+
+  duplex_prepare(dup, &seq1, &seq2);
+  mfe = duplex_mfe(dup);
+  free(mfe.structure);
+
+  subopt = duplex_subopt_list(dup, mfe.energy, delta, w, subopt_sorted, 1);
+
+  duplex_seq_free(&seq1);
+  duplex_seq_free(&seq2);
+  vrna_duplex_free(dup);
+
+  return subopt;
+}
+
+
 /*---------------------------------------------------------------------------*/
 
 PUBLIC duplexT
@@ -2,8 +2,7 @@
 #define VIENNA_RNA_PACKAGE_DUPLEX_H
 
 #include <ViennaRNA/datastructures/basic.h>
-
-#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
+#include <ViennaRNA/model.h>
 
 /**
  *  @file     duplex.h
@@ -11,6 +10,133 @@
  *  @brief    Functions for simple RNA-RNA duplex interactions
  */
 
+/**
+ *  @addtogroup cofold
+ *  @{
+ */
+
+/**
+ *  @brief  A reentrant context for RNA-RNA duplex predictions
+ *
+ *  The context holds the energy parameters and the dynamic programming matrix
+ *  required to compute duplex structures, i.e. hybrids that consist of
+ *  inter-molecular base pairs only. Since the matrix is kept and re-used
+ *  for subsequent predictions, a single context should be used for many
+ *  predictions. Different threads must use different contexts.
+ *
+ *  @see  vrna_duplex_init(), vrna_duplex_free(), vrna_duplex_mfe(), vrna_duplex_subopt()
+ */
+typedef struct vrna_duplex_s *vrna_duplex_t;
+
+
+/**
+ *  @brief  Create a new context for RNA-RNA duplex predictions
+ *
+ *  @see    vrna_duplex_free(), vrna_duplex_mfe(), vrna_duplex_subopt()
+ *
+ *  @param  md_p  The model details to use (Maybe NULL)
+ *  @return       A new duplex prediction context
+ */
+vrna_duplex_t
+vrna_duplex_init(vrna_md_t *md_p);
+
+
+/**
+ *  @brief  Free a duplex prediction context
+ *
+ *  @see    vrna_duplex_init()
+ *
+ *  @param  dup   The duplex prediction context
+ */
+void
+vrna_duplex_free(vrna_duplex_t dup);
+
+
+/**
+ *  @brief  Compute the minimum free energy duplex structure of two RNA strands
+ *
+ *  @see    vrna_duplex_init(), vrna_duplex_subopt(), duplexfold()
+ *
+ *  @param  dup   The duplex prediction context
+ *  @param  s1    The first sequence
+ *  @param  s2    The second sequence
+ *  @return       The MFE duplex structure
+ */
+duplexT
+vrna_duplex_mfe(vrna_duplex_t dup,
+                const char    *s1,
+                const char    *s2);
+
+
+/**
+ *  @brief  Compute suboptimal duplex structures of two RNA strands
+ *
+ *  Reports all duplexes within @p delta dacal/mol of the MFE that are not
+ *  dominated by a better one within a distance of @p w nucleotides. The list
+ *  is terminated by an entry with @p i = 0 and @p structure = NULL. Unless
+ *  @p sorted is non-zero, duplexes are reported in order of decreasing 3'
+ *  end positions in the first sequence.
+ *
+ *  @see    vrna_duplex_init(), vrna_duplex_mfe(), duplex_subopt()
+ *
+ *  @param  dup     The duplex prediction context
+ *  @param  s1      The first sequence
+ *  @param  s2      The second sequence
+ *  @param  delta   The energy range in dacal/mol
+ *  @param  w       The minimal distance between two reported duplexes
+ *  @param  sorted  Sort the duplexes by free energy if non-zero
+ *  @return         A list of suboptimal duplex structures
+ */
+duplexT *
+vrna_duplex_subopt(vrna_duplex_t  dup,
+                   const char     *s1,
+                   const char     *s2,
+                   int            delta,
+                   int            w,
+                   int            sorted);
+
+
+/**
+ *  @brief  Compute duplex structures for all combinations of query and target sequences
+ *
+ *  This function scans each query sequence against each target sequence, e.g. a
+ *  set of small RNAs against a set of mRNAs. The energy parameters and encodings
+ *  of the sequences are prepared only once and are shared among all threads, while
+ *  each thread re-uses its own dynamic programming matrix for all of its tasks.
+ *  The results are stored in an array of size @f$ n_q \cdot n_t @f$ where the
+ *  duplexes of query @f$ q @f$ and target @f$ t @f$ are found at position
+ *  @f$ q \cdot n_t + t @f$. Each entry is a list terminated by an entry with
+ *  @p i = 0 and @p structure = NULL. If @p delta is negative, the lists consist
+ *  of the MFE duplex only. Otherwise, they contain the suboptimal duplexes,
+ *  sorted by free energy, as obtained from vrna_duplex_subopt().
+ *
+ *  @note   Computations are distributed among @p jobs threads if the library has been
+ *          compiled with OpenMP support.
+ *
+ *  @see    vrna_duplex_mfe(), vrna_duplex_subopt()
+ *
+ *  @param  queries   A NULL-terminated list of query sequences
+ *  @param  targets   A NULL-terminated list of target sequences
+ *  @param  md_p      The model details to use (Maybe NULL)
+ *  @param  delta     The energy range in dacal/mol for suboptimal duplexes (< 0 for MFE only)
+ *  @param  w         The minimal distance between two reported duplexes
+ *  @param  jobs      The number of threads (<= 0 to use the OpenMP default)
+ *  @return           The lists of duplexes for each combination of query and target
+ */
+duplexT **
+vrna_duplex_batch(const char  **queries,
+                  const char  **targets,
+                  vrna_md_t   *md_p,
+                  int         delta,
+                  int         w,
+                  int         jobs);
+
+
+/**
+ *  @}
+ */
+
+#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
 duplexT duplexfold(const char *s1,
                    const char *s2);
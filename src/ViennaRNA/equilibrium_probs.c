@@ -39,6 +39,9 @@
 #include "ViennaRNA/loops/internal_sc_pf.inc"
 #include "ViennaRNA/loops/multibranch_sc_pf.inc"
 
+#include "ViennaRNA/loops/ali_rows.inc"
+#include "ViennaRNA/loops/multibranch_ali.inc"
+
 /*
  #################################
  # GLOBAL VARIABLES              #
@@ -89,7 +92,13 @@ typedef struct {
 
 PRIVATE int
 pf_create_bppm(vrna_fold_compound_t *vc,
-               char                 *structure);
+               char                 *structure,
+               int                  keep_i,
+               int                  keep_j);
+
+
+PRIVATE int
+outside_reusable(vrna_fold_compound_t *fc);
 
 
 PRIVATE INLINE void
@@ -169,7 +178,9 @@ free_constraints_helper(constraints_helper *helper);
 
 PRIVATE void
 compute_bpp_external(vrna_fold_compound_t *fc,
-                     constraints_helper   *constraints);
+                     constraints_helper   *constraints,
+                     int                  keep_i,
+                     int                  keep_j);
 
 
 PRIVATE void
@@ -180,7 +191,9 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
                      int                  *corr_size,
                      FLT_OR_DBL           *Qmax,
                      int                  *ov,
-                     constraints_helper   *constraints);
+                     constraints_helper   *constraints,
+                     int                  keep_i,
+                     int                  keep_j);
 
 
 PRIVATE void
@@ -191,7 +204,9 @@ compute_bpp_internal_comparative(vrna_fold_compound_t *fc,
                                  int                  *corr_size,
                                  FLT_OR_DBL           *Qmax,
                                  int                  *ov,
-                                 constraints_helper   *constraints);
+                                 constraints_helper   *constraints,
+                                 int                  keep_i,
+                                 int                  keep_j);
 
 
 PRIVATE void
@@ -210,7 +225,9 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
                         helper_arrays         *ml_helpers,
                         FLT_OR_DBL            *Qmax,
                         int                   *ov,
-                        constraints_helper    *constraints);
+                        constraints_helper    *constraints,
+                        int                   keep_i,
+                        int                   keep_j);
 
 
 PRIVATE void
@@ -219,7 +236,9 @@ compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
                                     helper_arrays         *ml_helpers,
                                     FLT_OR_DBL            *Qmax,
                                     int                   *ov,
-                                    constraints_helper    *constraints);
+                                    constraints_helper    *constraints,
+                                    int                   keep_i,
+                                    int                   keep_j);
 
 
 PRIVATE FLT_OR_DBL
@@ -344,7 +363,27 @@ vrna_pairing_probs(vrna_fold_compound_t *vc,
                    char                 *structure)
 {
   if (vc)
-    return pf_create_bppm(vc, structure);
+    return pf_create_bppm(vc, structure, 0, 0);
+
+  return 0;
+}
+
+
+PUBLIC int
+vrna_pairing_probs_update(vrna_fold_compound_t  *fc,
+                          unsigned int          i,
+                          unsigned int          j,
+                          char                  *structure)
+{
+  if (fc) {
+    if ((i < 1) ||
+        (j < i) ||
+        (j > fc->length) ||
+        (!outside_reusable(fc)))
+      return pf_create_bppm(fc, structure, 0, 0);
+
+    return pf_create_bppm(fc, structure, (int)i, (int)j);
+  }
 
   return 0;
 }
@@ -636,7 +675,9 @@ vrna_pf_dimer_probs(double                  FAB,
 /* calculate base pairing probs */
 PRIVATE int
 pf_create_bppm(vrna_fold_compound_t *vc,
-               char                 *structure)
+               char                 *structure,
+               int                  keep_i,
+               int                  keep_j)
 {
   unsigned int      s;
   int               n, i, j, l, ij, *pscore, *jindx, ov = 0;
@@ -711,14 +752,18 @@ pf_create_bppm(vrna_fold_compound_t *vc,
                                            int                  *corr_size,
                                            FLT_OR_DBL           *Qmax,
                                            int                  *ov,
-                                           constraints_helper   *constraints);
+                                           constraints_helper   *constraints,
+                                           int                  keep_i,
+                                           int                  keep_j);
 
     void (*compute_bpp_mul)(vrna_fold_compound_t  *fc,
                             int                   l,
                             helper_arrays         *ml_helpers,
                             FLT_OR_DBL            *Qmax,
                             int                   *ov,
-                            constraints_helper    *constraints);
+                            constraints_helper    *constraints,
+                            int                   keep_i,
+                            int                   keep_j);
 
     if (vc->type == VRNA_FC_TYPE_SINGLE) {
       compute_bpp_int = &compute_bpp_internal;
@@ -752,7 +797,7 @@ pf_create_bppm(vrna_fold_compound_t *vc,
     if (circular)
       bppm_circ(vc, constraints);
     else
-      compute_bpp_external(vc, constraints);
+      compute_bpp_external(vc, constraints, keep_i, keep_j);
 
     /* 2. all cases where base pair (k,l) is enclosed by another pair (i,j) */
     l = n;
@@ -763,7 +808,9 @@ pf_create_bppm(vrna_fold_compound_t *vc,
                     &corr_size,
                     &Qmax,
                     &ov,
-                    constraints);
+                    constraints,
+                    keep_i,
+                    keep_j);
 
     for (l = n - 1; l > 1; l--) {
       compute_bpp_int(vc,
@@ -773,14 +820,18 @@ pf_create_bppm(vrna_fold_compound_t *vc,
                       &corr_size,
                       &Qmax,
                       &ov,
-                      constraints);
+                      constraints,
+                      keep_i,
+                      keep_j);
 
       compute_bpp_mul(vc,
                       l,
                       ml_helpers,
                       &Qmax,
                       &ov,
-                      constraints);
+                      constraints,
+                      keep_i,
+                      keep_j);
 
       if (vc->strands > 1) {
         multistrand_update_Y5(vc, l, Y5, Y5p);
@@ -927,6 +978,40 @@ pf_create_bppm(vrna_fold_compound_t *vc,
 }
 
 
+/*
+ *  Check whether the outside contributions of base pairs that enclose
+ *  a locally changed region may be re-used as they are. This excludes
+ *  all cases where the outside algorithm computes more than just the
+ *  pair probabilities, or where additional contributions are attached
+ *  to the enclosed pairs
+ */
+PRIVATE int
+outside_reusable(vrna_fold_compound_t *fc)
+{
+  unsigned int  s;
+  vrna_md_t     *md;
+
+  md = &(fc->exp_params->model_details);
+
+  if ((md->circ) ||
+      (md->gquad) ||
+      (fc->strands > 1) ||
+      ((fc->domains_up) && (fc->domains_up->exp_energy_cb)))
+    return 0;
+
+  if (fc->type == VRNA_FC_TYPE_SINGLE) {
+    if ((fc->sc) && (fc->sc->bt))
+      return 0;
+  } else if (fc->scs) {
+    for (s = 0; s < fc->n_seq; s++)
+      if ((fc->scs[s]) && (fc->scs[s]->bt))
+        return 0;
+  }
+
+  return 1;
+}
+
+
 PRIVATE helper_arrays *
 get_ml_helper_arrays(vrna_fold_compound_t *fc)
 {
@@ -1065,7 +1150,9 @@ free_constraints_helper(constraints_helper *helper)
 
 PRIVATE void
 compute_bpp_external(vrna_fold_compound_t *fc,
-                     constraints_helper   *constraints)
+                     constraints_helper   *constraints,
+                     int                  keep_i,
+                     int                  keep_j)
 {
   unsigned int              i, j, n;
   int                       *my_iindx, ij;
@@ -1093,6 +1180,10 @@ compute_bpp_external(vrna_fold_compound_t *fc,
 
   for (i = 1; i <= n; i++) {
     for (j = i + 1; j <= n; j++) {
+      /* outside contributions of pairs enclosing [keep_i, keep_j] are already known */
+      if (((int)i < keep_i) && ((int)j > keep_j))
+        continue;
+
       ij        = my_iindx[i] - j;
       probs[ij] = 0.;
 
@@ -1202,7 +1293,9 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
                      int                  *corr_size,
                      FLT_OR_DBL           *Qmax,
                      int                  *ov,
-                     constraints_helper   *constraints)
+                     constraints_helper   *constraints,
+                     int                  keep_i,
+                     int                  keep_j)
 {
   unsigned char         type, type_2;
   char                  *ptype;
@@ -1251,6 +1344,10 @@ compute_bpp_internal(vrna_fold_compound_t *fc,
     if (qb[kl] == 0.)
       continue;
 
+    /* outside contributions of pairs enclosing [keep_i, keep_j] are already known */
+    if ((k < keep_i) && (l > keep_j))
+      continue;
+
     if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
       type_2 = rtype[vrna_get_ptype(jindx[l] + k, ptype)];
 
@@ -1369,7 +1466,9 @@ compute_bpp_internal_comparative(vrna_fold_compound_t *fc,
                                  int                  *corr_size,
                                  FLT_OR_DBL           *Qmax,
                                  int                  *ov,
-                                 constraints_helper   *constraints)
+                                 constraints_helper   *constraints,
+                                 int                  keep_i,
+                                 int                  keep_j)
 {
   short                 **SS, **S5, **S3;
   unsigned int          type, *tt, s, n_seq, **a2s;
@@ -1416,6 +1515,10 @@ compute_bpp_internal_comparative(vrna_fold_compound_t *fc,
     if (qb[kl] == 0.)
       continue;
 
+    /* outside contributions of pairs enclosing [keep_i, keep_j] are already known */
+    if ((k < keep_i) && (l > keep_j))
+      continue;
+
     if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) {
       psc_exp = exp(pscore[jindx[l] + k] / kTn);
 
@@ -1493,7 +1596,9 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
                         helper_arrays         *ml_helpers,
                         FLT_OR_DBL            *Qmax,
                         int                   *ov,
-                        constraints_helper    *constraints)
+                        constraints_helper    *constraints,
+                        int                   keep_i,
+                        int                   keep_j)
 {
   unsigned char             tt;
   char                      *ptype;
@@ -1692,6 +1797,10 @@ compute_bpp_multibranch(vrna_fold_compound_t  *fc,
           continue;
       }
 
+      /* outside contributions of pairs enclosing [keep_i, keep_j] are already known */
+      if ((k < keep_i) && (l > keep_j))
+        continue;
+
       temp = prm_MLb;
 
       if (sn[k] == sn[k - 1]) {
@@ -1754,10 +1863,10 @@ compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
                                     helper_arrays         *ml_helpers,
                                     FLT_OR_DBL            *Qmax,
                                     int                   *ov,
-                                    constraints_helper    *constraints)
+                                    constraints_helper    *constraints,
+                                    int                   keep_i,
+                                    int                   keep_j)
 {
-  unsigned char     tt;
-  short             **S, **S5, **S3;
   unsigned int      **a2s, s, n_seq, *sn;
   int               i, j, k, n, ii, kl, ij, lj, *my_iindx, *jindx, *pscore, with_gquad;
   FLT_OR_DBL        temp, ppp, prm_MLb, prmt, prmt1, *qb, *probs, *qm, *G, *scale,
@@ -1770,9 +1879,6 @@ compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
 
   n             = (int)fc->length;
   n_seq         = fc->n_seq;
-  S             = fc->S;
-  S5            = fc->S5;
-  S3            = fc->S3;
   a2s           = fc->a2s;
   sn            = fc->strand_number;
   pscore        = fc->pscore;
@@ -1821,13 +1927,7 @@ compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
              * (l+1, j-1)  -> multiloop part with at least one stem
              * a.k.a. (k,l) is left-most stem in multiloop closed by (k-1, j)
              */
-            ppp = probs[ij] *
-                  qm[lj];
-
-            for (s = 0; s < n_seq; s++) {
-              tt  = vrna_get_ptype_md(S[s][j], S[s][i], md);
-              ppp *= exp_E_MLstem(tt, S5[s][j], S3[s][i], pf_params);
-            }
+            ppp = exp_E_MLstem_ali(fc, pf_params, probs[ij] * qm[lj], j, i, j, i);
 
             if (scs) {
               for (s = 0; s < n_seq; s++) {
@@ -1850,13 +1950,14 @@ compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
         ii = my_iindx[i];   /* ii-j=[i,j]     */
 
         if (hc->mx[(l + 1) * n + i] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP) {
-          prmt1 = probs[ii - (l + 1)] *
-                  (FLT_OR_DBL)pow(expMLclosing, (double)n_seq);
-
-          for (s = 0; s < n_seq; s++) {
-            tt    = vrna_get_ptype_md(S[s][l + 1], S[s][i], md);
-            prmt1 *= exp_E_MLstem(tt, S5[s][l + 1], S3[s][i], pf_params);
-          }
+          prmt1 = exp_E_MLstem_ali(fc,
+                                   pf_params,
+                                   probs[ii - (l + 1)] *
+                                   (FLT_OR_DBL)pow(expMLclosing, (double)n_seq),
+                                   l + 1,
+                                   i,
+                                   l + 1,
+                                   i);
 
           if (scs) {
             /* which decompositions are covered here? => (i, l+1) -> enclosing pair */
@@ -1941,6 +2042,10 @@ compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
           continue;
       }
 
+      /* outside contributions of pairs enclosing [keep_i, keep_j] are already known */
+      if ((k < keep_i) && (l > keep_j))
+        continue;
+
       temp = prm_MLb;
 
       if (sn[k] == sn[k - 1]) {
@@ -1955,12 +2060,8 @@ compute_bpp_multibranch_comparative(vrna_fold_compound_t  *fc,
         temp *= G[kl] *
                 expMLstem;
       } else {
-        if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC) {
-          for (s = 0; s < n_seq; s++) {
-            tt    = vrna_get_ptype_md(S[s][k], S[s][l], md);
-            temp  *= exp_E_MLstem(tt, S5[s][k], S3[s][l], pf_params);
-          }
-        }
+        if (hc->mx[l * n + k] & VRNA_CONSTRAINT_CONTEXT_MB_LOOP_ENC)
+          temp = exp_E_MLstem_ali(fc, pf_params, temp, k, l, k, l);
       }
 
       probs[kl] += temp *
@@ -64,6 +64,33 @@ vrna_pairing_probs(vrna_fold_compound_t *vc,
                    char                 *structure);
 
 
+/**
+ *  @brief  Compute base pair probabilities, re-using the outside contributions of pairs enclosing a region
+ *
+ *  This is the outside counterpart of vrna_pf_update(), which prepares the base pair
+ *  probability matrix accordingly. Upon entry, the entries of all base pairs
+ *  @f$ (k,l) @f$ with @f$ k < i @f$ and @f$ l > j @f$ must hold their outside
+ *  contributions divided by the current partition function, all other entries are
+ *  re-computed. For circular RNAs, G-quadruplexes, multi-strand fold compounds,
+ *  unstructured domains, and soft constraints with auxiliary base pairs, all base
+ *  pair probabilities are re-computed instead.
+ *
+ *  @see  vrna_pf_update(), vrna_pairing_probs()
+ *
+ *  @param  fc          The fold compound data structure with up-to-date partition function matrices
+ *  @param  i           The first nucleotide of the changed region (1-based)
+ *  @param  j           The last nucleotide of the changed region (1-based)
+ *  @param  structure   A pointer to the character array where position-wise pairing propensity
+ *                      will be stored. (Maybe NULL)
+ *  @return             1 on success, 0 otherwise
+ */
+int
+vrna_pairing_probs_update(vrna_fold_compound_t  *fc,
+                          unsigned int          i,
+                          unsigned int          j,
+                          char                  *structure);
+
+
 /**
  *  @brief Get the mean base pair distance in the thermodynamic ensemble from a probability matrix
  *
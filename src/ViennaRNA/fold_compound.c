@@ -48,7 +48,6 @@
  */
 
 #define WITH_PTYPE          1L    /* passed to set_fold_compound() to indicate that we need to set fc->ptype */
-#define WITH_PTYPE_COMPAT   2L    /* passed to set_fold_compound() to indicate that we need to set fc->ptype_compat */
 
 /*
  #################################
@@ -100,6 +99,10 @@ PRIVATE INLINE void
 nullify(vrna_fold_compound_t *fc);
 
 
+PRIVATE int
+is_unconstrained_single(vrna_fold_compound_t *fc);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -114,6 +117,7 @@ vrna_fold_compound_free(vrna_fold_compound_t *fc)
     /* first destroy common attributes */
     vrna_mx_mfe_free(fc);
     vrna_mx_pf_free(fc);
+    free(fc->mx_allocator);
     free(fc->iindx);
     free(fc->jindx);
     free(fc->params);
@@ -150,6 +154,12 @@ vrna_fold_compound_free(vrna_fold_compound_t *fc)
         free(fc->S3);
         free(fc->Ss);
         free(fc->a2s);
+        free(fc->seq_weights);
+        free(fc->seq_reps);
+        free(fc->S_cm);
+        free(fc->S5_cm);
+        free(fc->S3_cm);
+        free(fc->a2s_cm);
         free(fc->pscore);
         free(fc->pscore_pf_compat);
         if (fc->scs) {
@@ -247,9 +257,6 @@ vrna_fold_compound(const char       *sequence,
     /* regular global structure prediction */
     aux_options |= WITH_PTYPE;
 
-    if (options & VRNA_OPTION_PF)
-      aux_options |= WITH_PTYPE_COMPAT;
-
     set_fold_compound(fc, options, aux_options);
 
     if (!(options & VRNA_OPTION_EVAL_ONLY)) {
@@ -372,9 +379,6 @@ vrna_fold_compound_comparative2(const char                **sequences,
 
       aux_options |= WITH_PTYPE;
 
-      if (options & VRNA_OPTION_PF)
-        aux_options |= WITH_PTYPE_COMPAT;
-
       set_fold_compound(fc, options, aux_options);
 
       make_pscores(fc);
@@ -453,7 +457,7 @@ vrna_fold_compound_TwoD(const char    *sequence,
     /* now for the energy parameters */
     add_params(fc, &md, options);
 
-    set_fold_compound(fc, options, WITH_PTYPE | WITH_PTYPE_COMPAT);
+    set_fold_compound(fc, options, WITH_PTYPE);
 
     if (!(options & VRNA_OPTION_EVAL_ONLY)) {
       vrna_hc_init(fc); /* add default hard constraints */
@@ -554,6 +558,9 @@ vrna_fold_compound_prepare(vrna_fold_compound_t *fc,
   /* Add DP matrices, if not they are not present or do not fit current settings */
   vrna_mx_prepare(fc, options);
 
+  /* select the callback-free interior loop decomposition, if possible */
+  fc->int_loop_plain = is_unconstrained_single(fc);
+
   return ret;
 }
 
@@ -667,11 +674,6 @@ set_fold_compound(vrna_fold_compound_t  *fc,
         } else {
           fc->ptype = (aux & WITH_PTYPE) ? vrna_ptypes(fc->sequence_encoding2, md_p) : NULL;
         }
-#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
-        /* backward compatibility ptypes */
-        fc->ptype_pf_compat =
-          (aux & WITH_PTYPE_COMPAT) ? get_ptypes(fc->sequence_encoding2, md_p, 1) : NULL;
-#endif
       }
 
       break;
@@ -685,10 +687,6 @@ set_fold_compound(vrna_fold_compound_t  *fc,
       fc->S_cons    = vrna_seq_encode_simple(fc->cons_seq, md_p);
 
       fc->pscore = vrna_alloc(sizeof(int) * ((length * (length + 1)) / 2 + 2));
-      /* backward compatibility ptypes */
-      fc->pscore_pf_compat =
-        (aux & WITH_PTYPE_COMPAT) ? vrna_alloc(sizeof(int) *
-                                               ((length * (length + 1)) / 2 + 2)) : NULL;
 
       oldAliEn = fc->oldAliEn = md_p->oldAliEn;
 
@@ -713,6 +711,50 @@ set_fold_compound(vrna_fold_compound_t  *fc,
       fc->Ss[fc->n_seq]   = NULL;
       fc->S[fc->n_seq]    = NULL;
 
+      /*
+       *  column-major copies of the encodings, such that the per-sequence
+       *  loops in the comparative energy evaluation read contiguous memory.
+       *  Identical rows are stored only once if requested
+       */
+      {
+        size_t        N;
+        unsigned int  i, u, *rep;
+
+        rep = NULL;
+
+        if (options & VRNA_OPTION_ALN_UNIQUE) {
+          fc->n_seq_unique = vrna_aln_unique((const char **)fc->sequences,
+                                             &(fc->seq_reps),
+                                             &(fc->seq_weights));
+
+          if (fc->n_seq_unique == fc->n_seq) {
+            free(fc->seq_weights);
+            free(fc->seq_reps);
+            fc->seq_weights = NULL;
+            fc->seq_reps    = NULL;
+          }
+
+          rep = fc->seq_reps;
+        } else {
+          fc->n_seq_unique = fc->n_seq;
+        }
+
+        N           = fc->n_seq_unique;
+        fc->S_cm    = (short *)vrna_alloc(sizeof(short) * (length + 2) * N);
+        fc->S5_cm   = (short *)vrna_alloc(sizeof(short) * (length + 2) * N);
+        fc->S3_cm   = (short *)vrna_alloc(sizeof(short) * (length + 2) * N);
+        fc->a2s_cm  = (unsigned int *)vrna_alloc(sizeof(unsigned int) * (length + 2) * N);
+
+        for (i = 0; i <= length + 1; i++)
+          for (u = 0; u < N; u++) {
+            s                     = (rep) ? rep[u] : u;
+            fc->S_cm[N * i + u]   = fc->S[s][i];
+            fc->S5_cm[N * i + u]  = fc->S5[s][i];
+            fc->S3_cm[N * i + u]  = fc->S3[s][i];
+            fc->a2s_cm[N * i + u] = fc->a2s[s][i];
+          }
+      }
+
       break;
 
     default:                      /* do nothing ? */
@@ -739,7 +781,8 @@ make_pscores(vrna_fold_compound_t *fc)
 
 #define NONE -10000 /* score for forbidden pairs */
 
-  int       i, j, k, l, s, max_span, turn;
+  int             i, j, k, l, max_span, turn;
+  vrna_aln_bits_t *bits;
   short     **S   = fc->S;
   char      **AS  = fc->sequences;
   int       n_seq = fc->n_seq;
@@ -747,7 +790,6 @@ make_pscores(vrna_fold_compound_t *fc)
     (fc->params) ? &(fc->params->model_details) : &(fc->exp_params->model_details);
   int       *pscore   = fc->pscore;             /* precomputed array of pair types */
   int       *indx     = fc->jindx;
-  int       *my_iindx = fc->iindx;
   int       n         = fc->length;
 
   turn = md->min_loop_size;
@@ -775,6 +817,31 @@ make_pscores(vrna_fold_compound_t *fc)
   if ((max_span < turn + 2) || (max_span > n))
     max_span = n;
 
+  /* pair type frequencies are counted on column-wise bit sets of the alignment */
+  if (fc->seq_weights) {
+    /* identical sequences enter only once, weighted by their multiplicity */
+    unsigned int  u, *rep = fc->seq_reps;
+    short         **S_u   = (short **)vrna_alloc(sizeof(short *) * fc->n_seq_unique);
+    char          **AS_u  = (char **)vrna_alloc(sizeof(char *) * fc->n_seq_unique);
+
+    for (u = 0; u < fc->n_seq_unique; u++) {
+      S_u[u]  = S[rep[u]];
+      AS_u[u] = AS[rep[u]];
+    }
+
+    bits = vrna_aln_bits_weighted((const short **)S_u,
+                                  (const char **)AS_u,
+                                  fc->n_seq_unique,
+                                  (unsigned int)n,
+                                  fc->seq_weights);
+    free(S_u);
+    free(AS_u);
+  } else {
+    bits = vrna_aln_bits((const short **)S, (const char **)AS, (unsigned int)n_seq, (unsigned int)n);
+  }
+
+  /* encodings beyond the range of the bit sets are counted sequence by sequence below */
+
   for (i = 1; i < n; i++) {
     for (j = i + 1; (j < i + turn + 1) && (j <= n); j++)
       pscore[indx[j] + i] = NONE;
@@ -784,31 +851,24 @@ make_pscores(vrna_fold_compound_t *fc)
         continue;
       }
 
-      unsigned int pfreq[8] = {
-        0, 0, 0, 0, 0, 0, 0, 0
-      };
+      unsigned int pfreq[8];
 
-      for (s = 0; s < n_seq; s++) {
-        int type;
-        if (S[s][i] == 0 && S[s][j] == 0) {
-          type = 7;                             /* gap-gap  */
-        } else {
-          if ((AS[s][i] == '~') || (AS[s][j] == '~')) {
-            type = 7;
-          } else {
-            type = md->pair[S[s][i]][S[s][j]];
-            if ((md->noGU) && ((type == 3) || (type == 4)))
-              type = 0;
-          }
-        }
+      if (bits)
+        vrna_aln_bits_pfreq(bits, md, i, j, &pfreq[0]);
+      else
+        vrna_aln_pfreq((const short **)S, (const char **)AS, (unsigned int)n_seq, md, i, j, &pfreq[0]);
 
-        pfreq[type]++;
+      if (md->noGU) {
+        pfreq[0]  += pfreq[3] + pfreq[4];
+        pfreq[3]  = pfreq[4] = 0;
       }
 
       pscore[indx[j] + i] = vrna_pscore_freq(fc, &pfreq[0], 6);
     }
   }
 
+  vrna_aln_bits_free(bits);
+
   if (md->noLP) {
     /* remove unwanted pairs */
     for (k = 1; k < n - turn - 1; k++)
@@ -832,13 +892,6 @@ make_pscores(vrna_fold_compound_t *fc)
         }
       }
   }
-
-  /* copy over pscores for backward compatibility */
-  if (fc->pscore_pf_compat) {
-    for (i = 1; i < n; i++)
-      for (j = i; j <= n; j++)
-        fc->pscore_pf_compat[my_iindx[i] - j] = (short)pscore[indx[j] + i];
-  }
 }
 
 
@@ -894,6 +947,7 @@ nullify(vrna_fold_compound_t *fc)
     fc->hc            = NULL;
     fc->matrices      = NULL;
     fc->exp_matrices  = NULL;
+    fc->mx_allocator  = NULL;
     fc->params        = NULL;
     fc->exp_params    = NULL;
     fc->iindx         = NULL;
@@ -907,6 +961,9 @@ nullify(vrna_fold_compound_t *fc)
     fc->domains_up    = NULL;
     fc->aux_grammar   = NULL;
 
+    fc->int_loop_plain  = 0;
+    fc->mem_generation  = 0;
+
     switch (fc->type) {
       case VRNA_FC_TYPE_SINGLE:
         fc->sequence            = NULL;
@@ -930,6 +987,13 @@ nullify(vrna_fold_compound_t *fc)
         fc->S3                = NULL;
         fc->Ss                = NULL;
         fc->a2s               = NULL;
+        fc->n_seq_unique      = 0;
+        fc->seq_weights       = NULL;
+        fc->seq_reps          = NULL;
+        fc->S_cm              = NULL;
+        fc->S5_cm             = NULL;
+        fc->S3_cm             = NULL;
+        fc->a2s_cm            = NULL;
         fc->pscore            = NULL;
         fc->pscore_local      = NULL;
         fc->pscore_pf_compat  = NULL;
@@ -956,3 +1020,38 @@ nullify(vrna_fold_compound_t *fc)
 #endif
   }
 }
+
+
+/*
+ *  Check whether interior loops closed by any pair (i,j) can be evaluated
+ *  without hard constraint callbacks, soft constraints, unstructured domains,
+ *  and strand nicks. Soft constraints and unstructured domains for both, MFE
+ *  and partition function, are taken into account, such that the MFE and
+ *  partition function fast paths are always taken for the same set of fold
+ *  compounds
+ */
+PRIVATE int
+is_unconstrained_single(vrna_fold_compound_t *fc)
+{
+  vrna_sc_t *sc;
+
+  if ((fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (fc->strands != 1) ||
+      (!fc->hc) ||
+      (fc->hc->type == VRNA_HC_WINDOW) ||
+      (fc->hc->f))
+    return 0;
+
+  sc = fc->sc;
+
+  if ((sc) &&
+      ((sc->energy_up) || (sc->energy_bp) || (sc->energy_stack) || (sc->f) ||
+       (sc->exp_energy_up) || (sc->exp_energy_bp) || (sc->exp_energy_stack) || (sc->exp_f)))
+    return 0;
+
+  if ((fc->domains_up) &&
+      ((fc->domains_up->energy_cb) || (fc->domains_up->exp_energy_cb)))
+    return 0;
+
+  return 1;
+}
@@ -179,6 +179,14 @@ struct vrna_fc_s {
 
   vrna_mx_mfe_t     *matrices;      /**<  @brief  The MFE DP matrices */
   vrna_mx_pf_t      *exp_matrices;  /**<  @brief  The PF DP matrices  */
+  vrna_mx_allocator_t *mx_allocator;  /**<  @brief  Memory allocator for the DP matrices (@p NULL for default)
+                                       *    @see    vrna_mx_allocator_set()
+                                       */
+  unsigned int      mem_generation; /**<  @brief  Number of times the DP matrices or sequence dependent arrays were released
+                                     *    @details  Incremented whenever the DP matrices are freed or replaced, and whenever
+                                     *              strands are added or removed. Scripting language interfaces use it to
+                                     *              detect views into memory that is no longer owned by the fold compound
+                                     */
 
   vrna_param_t      *params;        /**<  @brief  The precomputed free energy contributions for each type of loop */
   vrna_exp_param_t  *exp_params;    /**<  @brief  The precomputed free energy contributions as Boltzmann factors  */
@@ -221,6 +229,12 @@ struct vrna_fc_s {
   /* auxiliary (user-defined) extension to the folding grammar */
   vrna_gr_aux_t *aux_grammar;               /**<  @brief  Additional decomposition grammar rules */
 
+  unsigned int  int_loop_plain;             /**<  @brief  Whether interior loops may be decomposed without constraint and domain callbacks
+                                             *    @details  Derived from the current constraints, unstructured domains, and
+                                             *              strands in vrna_fold_compound_prepare() only. Any change to these
+                                             *              takes effect with the next preparation
+                                             */
+
   /**
    *  @}
    */
@@ -259,7 +273,8 @@ struct vrna_fc_s {
                                          */
       char *ptype_pf_compat;            /**<  @brief  ptype array indexed via iindx
                                          *    @deprecated  This attribute will vanish in the future!
-                                         *    It's meant for backward compatibility only!
+                                         *    It's meant for backward compatibility only and is only created on demand
+                                         *    by the deprecated interfaces that expose it. All other code uses #ptype.
                                          *    @warning   Only available if @verbatim type==VRNA_FC_TYPE_SINGLE @endverbatim
                                          */
       vrna_sc_t *sc;                    /**<  @brief  The soft constraints for usage in structure prediction and evaluation
@@ -304,6 +319,31 @@ struct {
                                          */
   char          **Ss;
   unsigned int  **a2s;
+      unsigned int  n_seq_unique;       /**<  @brief  The number of rows in the column-major copies below
+                                         *    @details   Equals @p n_seq unless the fold compound was created with
+                                         *               #VRNA_OPTION_ALN_UNIQUE, in which case identical rows are
+                                         *               stored only once
+                                         *    @warning   Only available if @verbatim type==VRNA_FC_TYPE_COMPARATIVE @endverbatim
+                                         */
+      unsigned int  *seq_weights;       /**<  @brief  Multiplicities of the rows in the column-major copies below (NULL if all are 1)
+                                         *    @warning   Only available if @verbatim type==VRNA_FC_TYPE_COMPARATIVE @endverbatim
+                                         */
+      unsigned int  *seq_reps;          /**<  @brief  The sequence represented by each row of the column-major copies below (NULL if all rows are distinct)
+                                         *    @warning   Only available if @verbatim type==VRNA_FC_TYPE_COMPARATIVE @endverbatim
+                                         */
+      short         *S_cm;              /**<  @brief  Column-major copy of @p S, i.e. S_cm[i * n_seq_unique + u] = S[s][i]
+                                         *            for the sequence s represented by row u
+                                         *    @warning   Only available if @verbatim type==VRNA_FC_TYPE_COMPARATIVE @endverbatim
+                                         */
+      short         *S5_cm;             /**<  @brief  Column-major copy of @p S5
+                                         *    @warning   Only available if @verbatim type==VRNA_FC_TYPE_COMPARATIVE @endverbatim
+                                         */
+      short         *S3_cm;             /**<  @brief  Column-major copy of @p S3
+                                         *    @warning   Only available if @verbatim type==VRNA_FC_TYPE_COMPARATIVE @endverbatim
+                                         */
+      unsigned int  *a2s_cm;            /**<  @brief  Column-major copy of @p a2s
+                                         *    @warning   Only available if @verbatim type==VRNA_FC_TYPE_COMPARATIVE @endverbatim
+                                         */
       int           *pscore;              /**<  @brief  Precomputed array of pair types expressed as pairing scores
                                            *    @warning   Only available if @verbatim type==VRNA_FC_TYPE_COMPARATIVE @endverbatim
                                            */
@@ -311,7 +351,8 @@ struct {
                                            *    @warning   Only available if @verbatim type==VRNA_FC_TYPE_COMPARATIVE @endverbatim
                                            */
       short         *pscore_pf_compat;    /**<  @brief  Precomputed array of pair types expressed as pairing scores indexed via iindx
-                                           *    @deprecated  This attribute will vanish in the future!
+                                           *    @deprecated  This attribute will vanish in the future! It is only created
+                                           *    on demand by get_alipf_arrays().
                                            *    @warning   Only available if @verbatim type==VRNA_FC_TYPE_COMPARATIVE @endverbatim
                                            */
       vrna_sc_t     **scs;                /**<  @brief  A set of soft constraints (for each sequence in the alignment)
@@ -411,6 +452,18 @@ struct {
  */
 #define VRNA_OPTION_WINDOW          16U
 
+/**
+ *  @brief  Option flag to collapse identical rows of an alignment
+ *
+ *  Use this flag with vrna_fold_compound_comparative() to evaluate the loop energies
+ *  and pair scores of identical aligned sequences only once, weighted by their multiplicity.
+ *  Free energies are unaffected, Boltzmann factors may differ in the last digits due
+ *  to rounding.
+ *
+ *  @see vrna_fold_compound_comparative(), vrna_aln_unique()
+ */
+#define VRNA_OPTION_ALN_UNIQUE      64U
+
 /**
  *  @brief  Retrieve a #vrna_fold_compound_t data structure for single sequences and hybridizing sequences
  *
@@ -470,6 +523,7 @@ vrna_fold_compound(const char       *sequence,
  *  * #VRNA_OPTION_MFE      - @copybrief #VRNA_OPTION_MFE
  *  * #VRNA_OPTION_PF       - @copybrief #VRNA_OPTION_PF
  *  * #VRNA_OPTION_WINDOW   - @copybrief #VRNA_OPTION_WINDOW
+ *  * #VRNA_OPTION_ALN_UNIQUE - @copybrief #VRNA_OPTION_ALN_UNIQUE
  *
  *  The above options may be OR-ed together.
  *
@@ -0,0 +1,405 @@
+/*
+ *  An indexed binary container for opening energies of many sequences
+ *
+ *  File layout (all numbers in native byte order):
+ *
+ *    header    magic, version, byte order mark, number of records, offset of the index
+ *    records   for each record and 1 <= u <= ulength, one row of 'length' opening energies
+ *    index     one entry per record, sorted by ID
+ *    IDs       '\0'-terminated ID strings referenced by the index
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/io/accessibility_store.h"
+
+#include "binary_store.inc"
+
+#define ACC_STORE_MAGIC       "VRNA_ACC"
+#define ACC_STORE_VERSION     1U
+
+struct acc_index {
+  uint64_t  id_offset;
+  uint64_t  data_offset;
+  uint32_t  length;
+  uint32_t  ulength;
+};
+
+struct acc_record {
+  char              *id;
+  struct acc_index  idx;
+};
+
+struct vrna_acc_store_s {
+  int                     writing;
+
+  /* stores opened for writing */
+  FILE                    *fp;
+  uint64_t                offset;
+  int                     failed;   /* a record was written only partially */
+  struct acc_record       *records;
+  size_t                  n_records;
+  size_t                  records_size;
+
+  /* stores opened for reading */
+  struct store_file       file;
+  const struct acc_index  *index;
+  uint64_t                n_index;
+};
+
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE int
+finalize(vrna_acc_store_t store);
+
+
+PRIVATE const struct acc_index *
+find_record(vrna_acc_store_t  store,
+            const char        *id);
+
+
+PRIVATE int
+compare_records(const void  *a,
+                const void  *b);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC vrna_acc_store_t
+vrna_acc_store_create(const char *filename)
+{
+  struct vrna_acc_store_s *store;
+  FILE                    *fp;
+
+  if (!filename)
+    return NULL;
+
+  fp = fopen(filename, "wb");
+  if (!fp) {
+    vrna_message_warning("vrna_acc_store_create: Failed to open file \"%s\" for writing",
+                         filename);
+    return NULL;
+  }
+
+  /* reserve space for the header, the actual one is written upon closing the store */
+  if (!store_header_write(fp, NULL, 0, 0, 0)) {
+    vrna_message_warning("vrna_acc_store_create: Failed to write to file \"%s\"", filename);
+    fclose(fp);
+    return NULL;
+  }
+
+  store               = (struct vrna_acc_store_s *)vrna_alloc(sizeof(struct vrna_acc_store_s));
+  store->writing      = 1;
+  store->fp           = fp;
+  store->offset       = sizeof(struct store_header);
+  store->records_size = 64;
+  store->records      = (struct acc_record *)vrna_alloc(sizeof(struct acc_record) *
+                                                        store->records_size);
+
+  return store;
+}
+
+
+PUBLIC int
+vrna_acc_store_add(vrna_acc_store_t store,
+                   const char       *id,
+                   unsigned int     length,
+                   unsigned int     ulength,
+                   const int        **energies)
+{
+  unsigned int      u;
+  struct acc_record *rec;
+
+  if ((!store) || (!store->writing) || (store->failed) || (!id) || (!energies))
+    return 0;
+
+  if (store->n_records == store->records_size) {
+    store->records_size *= 2;
+    store->records      = (struct acc_record *)vrna_realloc(store->records,
+                                                            sizeof(struct acc_record) *
+                                                            store->records_size);
+  }
+
+  rec                   = store->records + store->n_records;
+  rec->idx.id_offset    = 0;
+  rec->idx.data_offset  = store->offset;
+  rec->idx.length       = length;
+  rec->idx.ulength      = ulength;
+
+  /*
+   *  a partially written record leaves the file in an undefined state, so
+   *  any further records are refused and closing the store fails
+   */
+  for (u = 1; u <= ulength; u++) {
+    if (fwrite(energies[u] + 1, sizeof(int), length, store->fp) != length)
+      goto acc_store_add_fail;
+
+    store->offset += (uint64_t)sizeof(int) * length;
+  }
+
+  if (!store_padding_write(store->fp, &(store->offset)))
+    goto acc_store_add_fail;
+
+  rec->id = strdup(id);
+  store->n_records++;
+
+  return 1;
+
+acc_store_add_fail:
+
+  vrna_message_warning("vrna_acc_store_add: Failed to write data of \"%s\"", id);
+  store->failed = 1;
+
+  return 0;
+}
+
+
+PUBLIC vrna_acc_store_t
+vrna_acc_store_open(const char *filename)
+{
+  uint64_t                k;
+  struct store_header     header;
+  struct vrna_acc_store_s *store;
+
+  if (!filename)
+    return NULL;
+
+  store = (struct vrna_acc_store_s *)vrna_alloc(sizeof(struct vrna_acc_store_s));
+
+  if (!store_map(&(store->file), filename, "vrna_acc_store_open")) {
+    free(store);
+    return NULL;
+  }
+
+  switch (store_header_read(&(store->file),
+                            ACC_STORE_MAGIC,
+                            ACC_STORE_VERSION,
+                            sizeof(struct acc_index),
+                            &header,
+                            "vrna_acc_store_open",
+                            filename)) {
+    case STORE_HEADER_OK:
+      break;
+    case STORE_HEADER_CORRUPT:
+      goto acc_store_open_corrupt;
+    default:
+      goto acc_store_open_fail;
+  }
+
+  store->index    = (const struct acc_index *)(store->file.data + header.index_offset);
+  store->n_index  = header.n_records;
+
+  for (k = 0; k < store->n_index; k++) {
+    const struct acc_index *e = store->index + k;
+
+    if ((e->id_offset >= store->file.size) ||
+        (e->data_offset > header.index_offset) ||
+        ((uint64_t)e->length * e->ulength >
+         (header.index_offset - e->data_offset) / sizeof(int)))
+      goto acc_store_open_corrupt;
+  }
+
+  return store;
+
+acc_store_open_corrupt:
+
+  vrna_message_warning("vrna_acc_store_open: File \"%s\" is not a valid accessibility store",
+                       filename);
+
+acc_store_open_fail:
+
+  store_unmap(&(store->file));
+  free(store);
+
+  return NULL;
+}
+
+
+PUBLIC int
+vrna_acc_store_close(vrna_acc_store_t store)
+{
+  int     ret;
+  size_t  k;
+
+  ret = 1;
+
+  if (store) {
+    if (store->writing) {
+      ret = (store->failed) ? 0 : finalize(store);
+
+      if (fclose(store->fp))
+        ret = 0;
+
+      for (k = 0; k < store->n_records; k++)
+        free(store->records[k].id);
+
+      free(store->records);
+    } else {
+      store_unmap(&(store->file));
+    }
+
+    free(store);
+  }
+
+  return ret;
+}
+
+
+PUBLIC unsigned int
+vrna_acc_store_size(vrna_acc_store_t store)
+{
+  if (store)
+    return (store->writing) ? (unsigned int)store->n_records : (unsigned int)store->n_index;
+
+  return 0;
+}
+
+
+PUBLIC int
+vrna_acc_store_find(vrna_acc_store_t  store,
+                    const char        *id,
+                    unsigned int      *length,
+                    unsigned int      *ulength)
+{
+  const struct acc_index *e;
+
+  e = find_record(store, id);
+
+  if (e) {
+    if (length)
+      *length = e->length;
+
+    if (ulength)
+      *ulength = e->ulength;
+
+    return 1;
+  }
+
+  return 0;
+}
+
+
+PUBLIC const int *
+vrna_acc_store_window(vrna_acc_store_t  store,
+                      const char        *id,
+                      unsigned int      u,
+                      unsigned int      i,
+                      unsigned int      j)
+{
+  const struct acc_index  *e;
+  const int               *row;
+
+  e = find_record(store, id);
+
+  if ((e) &&
+      (u >= 1) &&
+      (u <= e->ulength) &&
+      (i >= 1) &&
+      (i <= j) &&
+      (j <= e->length)) {
+    row = (const int *)(store->file.data + e->data_offset) + (size_t)(u - 1) * e->length;
+    return row + (i - 1);
+  }
+
+  return NULL;
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE int
+finalize(vrna_acc_store_t store)
+{
+  size_t    k;
+  uint64_t  id_offset;
+
+  /* sort records by ID such that look-ups can be done by binary search */
+  qsort(store->records, store->n_records, sizeof(struct acc_record), &compare_records);
+
+  for (k = 1; k < store->n_records; k++)
+    if (!strcmp(store->records[k - 1].id, store->records[k].id))
+      vrna_message_warning("vrna_acc_store_close: Duplicate ID \"%s\", "
+                           "only one of the records will be accessible",
+                           store->records[k].id);
+
+  /* write index, followed by the IDs */
+  id_offset = store->offset + (uint64_t)sizeof(struct acc_index) * store->n_records;
+
+  for (k = 0; k < store->n_records; k++) {
+    store->records[k].idx.id_offset = id_offset;
+    id_offset                       += strlen(store->records[k].id) + 1;
+
+    if (fwrite(&(store->records[k].idx), sizeof(struct acc_index), 1, store->fp) != 1)
+      return 0;
+  }
+
+  for (k = 0; k < store->n_records; k++)
+    if (!store_id_write(store->fp, store->records[k].id))
+      return 0;
+
+  /* finally, write the actual header */
+  if ((fseek(store->fp, 0, SEEK_SET)) ||
+      (!store_header_write(store->fp,
+                           ACC_STORE_MAGIC,
+                           ACC_STORE_VERSION,
+                           store->n_records,
+                           store->offset)))
+    return 0;
+
+  return 1;
+}
+
+
+PRIVATE const struct acc_index *
+find_record(vrna_acc_store_t  store,
+            const char        *id)
+{
+  int       c;
+  uint64_t  lo, hi, mid;
+
+  if ((!store) || (store->writing) || (!id))
+    return NULL;
+
+  lo  = 0;
+  hi  = store->n_index;
+
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    c   = strcmp(id, (const char *)(store->file.data + store->index[mid].id_offset));
+
+    if (c == 0)
+      return store->index + mid;
+    else if (c < 0)
+      hi = mid;
+    else
+      lo = mid + 1;
+  }
+
+  return NULL;
+}
+
+
+PRIVATE int
+compare_records(const void  *a,
+                const void  *b)
+{
+  return strcmp(((const struct acc_record *)a)->id,
+                ((const struct acc_record *)b)->id);
+}
@@ -0,0 +1,168 @@
+#ifndef VIENNA_RNA_PACKAGE_ACCESSIBILITY_STORE_H
+#define VIENNA_RNA_PACKAGE_ACCESSIBILITY_STORE_H
+
+/**
+ *  @file     ViennaRNA/io/accessibility_store.h
+ *  @ingroup  file_utils, accessibility_store
+ *  @brief    An indexed binary container for opening energies of many sequences
+ */
+
+/**
+ *  @addtogroup accessibility_store
+ *  @{
+ *  @brief  Read and write opening energies of many sequences from/to a single indexed file
+ *
+ *  An accessibility store holds the opening energies, i.e. the free energy required
+ *  to keep a stretch of @f$ u @f$ consecutive nucleotides unpaired, for an arbitrary
+ *  number of sequences, each identified by a unique ID. This is the data
+ *  @p RNAplfold computes with its @p -u option, and that @p RNAplex requires for its
+ *  accessibility mode.
+ *
+ *  Opening a store only maps the file into memory (where supported by the operating
+ *  system), and all data is accessed in place. Thus, there is no parsing involved and only
+ *  those parts of the file that are actually used are read from disk. Records are found
+ *  by binary search on an ID index stored at the end of the file.
+ *
+ *  Energies are stored as integers in dcal/mol. For each record and each stretch length
+ *  @f$ 1 \leq u \leq u_{max} @f$ there is one row with an entry for each sequence
+ *  position @f$ i @f$, the energy to open the stretch @f$ [i - u + 1, i] @f$. Data
+ *  is written in native byte order and a store can only be read on machines with the
+ *  same endianness.
+ */
+
+
+/**
+ *  @brief  An accessibility store
+ *
+ *  @see  vrna_acc_store_create(), vrna_acc_store_open(), vrna_acc_store_close()
+ */
+typedef struct vrna_acc_store_s *vrna_acc_store_t;
+
+
+/**
+ *  @brief  Create a new accessibility store
+ *
+ *  The store is written to @p filename. Records are appended by vrna_acc_store_add()
+ *  and the store is finalized, i.e. the index is written, by vrna_acc_store_close().
+ *
+ *  @see  vrna_acc_store_add(), vrna_acc_store_close(), vrna_acc_store_open()
+ *
+ *  @param  filename  The name of the file to create
+ *  @return           The store opened for writing, or NULL on error
+ */
+vrna_acc_store_t
+vrna_acc_store_create(const char *filename);
+
+
+/**
+ *  @brief  Add the opening energies of a sequence to an accessibility store
+ *
+ *  @p energies must provide the opening energies (in dcal/mol) as @p energies[u][i] for
+ *  all @f$ 1 \leq u \leq @f$ @p ulength and @f$ 1 \leq i \leq @f$ @p length. The data is
+ *  copied to the store. If writing the data fails, the store refuses any further
+ *  records and vrna_acc_store_close() reports the failure.
+ *
+ *  @see  vrna_acc_store_create(), vrna_acc_store_close()
+ *
+ *  @param  store     The accessibility store opened for writing
+ *  @param  id        The ID of the sequence
+ *  @param  length    The length of the sequence
+ *  @param  ulength   The maximum length of unpaired stretches
+ *  @param  energies  The opening energies
+ *  @return           Non-zero on success, 0 otherwise
+ */
+int
+vrna_acc_store_add(vrna_acc_store_t store,
+                   const char       *id,
+                   unsigned int     length,
+                   unsigned int     ulength,
+                   const int        **energies);
+
+
+/**
+ *  @brief  Open an existing accessibility store for reading
+ *
+ *  @see  vrna_acc_store_find(), vrna_acc_store_window(), vrna_acc_store_close()
+ *
+ *  @param  filename  The name of the file to open
+ *  @return           The store opened for reading, or NULL on error
+ */
+vrna_acc_store_t
+vrna_acc_store_open(const char *filename);
+
+
+/**
+ *  @brief  Close an accessibility store
+ *
+ *  For stores opened for writing, this also writes the ID index and finalizes the file.
+ *  If any record could not be written completely, the file is left unfinalized, such
+ *  that vrna_acc_store_open() rejects it, and 0 is returned.
+ *  All pointers obtained from a store opened for reading become invalid.
+ *
+ *  @see  vrna_acc_store_create(), vrna_acc_store_open()
+ *
+ *  @param  store   The accessibility store
+ *  @return         Non-zero on success, 0 otherwise
+ */
+int
+vrna_acc_store_close(vrna_acc_store_t store);
+
+
+/**
+ *  @brief  Get the number of records in an accessibility store
+ *
+ *  @param  store   The accessibility store
+ *  @return         The number of records
+ */
+unsigned int
+vrna_acc_store_size(vrna_acc_store_t store);
+
+
+/**
+ *  @brief  Look up a record of an accessibility store opened for reading
+ *
+ *  @see  vrna_acc_store_window()
+ *
+ *  @param  store   The accessibility store
+ *  @param  id      The ID of the sequence
+ *  @param  length  A pointer to store the length of the sequence (may be NULL)
+ *  @param  ulength A pointer to store the maximum length of unpaired stretches (may be NULL)
+ *  @return         Non-zero if the record exists, 0 otherwise
+ */
+int
+vrna_acc_store_find(vrna_acc_store_t  store,
+                    const char        *id,
+                    unsigned int      *length,
+                    unsigned int      *ulength);
+
+
+/**
+ *  @brief  Access the opening energies of a sequence within a window
+ *
+ *  Returns a pointer @p p directly into the store such that @p p[k] is the opening
+ *  energy of the stretch of @p u nucleotides that ends at position @f$ i + k @f$, for
+ *  all @f$ 0 \leq k \leq j - i @f$. The memory must not be modified or freed and is
+ *  valid until the store is closed.
+ *
+ *  @see  vrna_acc_store_open(), vrna_acc_store_find()
+ *
+ *  @param  store   The accessibility store opened for reading
+ *  @param  id      The ID of the sequence
+ *  @param  u       The length of the unpaired stretch
+ *  @param  i       The first position of the window
+ *  @param  j       The last position of the window
+ *  @return         A pointer to the opening energies, or NULL if the record does not exist or the window is out of range
+ */
+const int *
+vrna_acc_store_window(vrna_acc_store_t  store,
+                      const char        *id,
+                      unsigned int      u,
+                      unsigned int      i,
+                      unsigned int      j);
+
+
+/**
+ *  @}
+ */
+
+#endif
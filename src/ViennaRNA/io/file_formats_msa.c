@@ -58,6 +58,23 @@ typedef struct {
   const char          *name;
 } writable;
 
+/*
+ *  Collector for the rows of an alignment record. Rows grow geometrically
+ *  when interleaved blocks are appended, such that parsing is linear in the
+ *  size of the input
+ */
+struct msa_rows {
+  char    **names;
+  char    **aln;
+  size_t  *len;   /* current length of each row */
+  size_t  *cap;   /* allocated memory of each row */
+  int     num;    /* number of rows */
+  int     size;   /* allocated number of rows */
+};
+
+/* initial size of the line buffer */
+#define MSA_LINE_CHUNK  4096
+
 PRIVATE aln_parser_function parse_aln_stockholm;
 
 PRIVATE aln_parser_function parse_aln_clustal;
@@ -123,18 +140,46 @@ free_msa_record(char  ***names,
                 char  **structure);
 
 
+PRIVATE int
+read_line(FILE    *fp,
+          char    **buf,
+          size_t  *size);
+
+
+PRIVATE char *
+next_token(char   **ptr,
+           size_t *len);
+
+
+PRIVATE void
+rows_init(struct msa_rows *rows);
+
+
 PRIVATE void
-add_sequence(const char *id,
-             const char *seq,
-             char       ***names,
-             char       ***aln,
-             int        seq_num);
+rows_clear(struct msa_rows *rows);
 
 
 PRIVATE void
-endmarker_msa_record(char ***names,
-                     char ***aln,
-                     int  seq_num);
+rows_add(struct msa_rows  *rows,
+         const char       *name,
+         size_t           name_len,
+         const char       *seq,
+         size_t           seq_len,
+         int              convert_gaps);
+
+
+PRIVATE void
+rows_append(struct msa_rows *rows,
+            int             i,
+            const char      *seq,
+            size_t          seq_len,
+            int             convert_gaps);
+
+
+PRIVATE int
+rows_finalize(struct msa_rows *rows,
+              char            ***names,
+              char            ***aln);
 
 
 /*
@@ -251,10 +296,13 @@ vrna_file_msa_read(const char   *filename,
     return seq_num;
   }
 
+  setvbuf(fp, NULL, _IOFBF, 1 << 20);
+
   if (names && aln) {
     *names  = NULL;
     *aln    = NULL;
   } else {
+    fclose(fp);
     return seq_num;
   }
 
@@ -504,10 +552,13 @@ parse_stockholm_alignment(FILE  *fp,
                           char  **structure,
                           int   verbosity)
 {
-  char  *line = NULL;
-  int   i, n, seq_num, seq_current;
+  char            *line, *ptr, *tmp_name, *tmp_seq;
+  size_t          line_size, name_len, seq_len;
+  int             n, seq_num, seq_current;
+  struct msa_rows rows;
 
-  seq_num     = 0;
+  line        = NULL;
+  line_size   = 0;
   seq_current = 0;
 
   if (!fp) {
@@ -533,152 +584,120 @@ parse_stockholm_alignment(FILE  *fp,
 
   int inrecord = 0;
 
-  while ((line = vrna_read_line(fp))) {
+  while (read_line(fp, &line, &line_size) >= 0) {
     if (strstr(line, "STOCKHOLM 1.0")) {
       inrecord = 1;
-      free(line);
       break;
     }
+  }
 
+  if (!inrecord) {
+    /*
+     *  if (verbosity >= 0)
+     *    vrna_message_warning("Did not find any Stockholm 1.0 formatted record!");
+     */
     free(line);
+    return -1;
   }
 
-  if (inrecord) {
-    while ((line = vrna_read_line(fp))) {
-      if (strncmp(line, "//", 2) == 0) {
-        /* end of alignment */
-        free(line);
-        line = NULL;
-        break;
-      }
+  rows_init(&rows);
 
-      n = (int)strlen(line);
-
-      switch (*line) {
-        /* we skip lines that start with whitespace */
-        case ' ':
-        case '\0':
-          seq_current = 0; /* reset number of current sequence */
-          goto stockholm_next_line;
-
-        /* Stockholm markup, or comment */
-        case '#':
-          if (strstr(line, "STOCKHOLM 1.0")) {
-            if (verbosity >= 0)
-              vrna_message_warning("Malformatted Stockholm record, missing // ?");
-
-            /* drop everything we've read so far and start new, blank record */
-            free_msa_record(names, aln, id, structure);
-
-            seq_num = 0;
-          } else if (strncmp(line, "#=GF", 4) == 0) {
-            /* found feature markup */
-            if ((id != NULL) && (strncmp(line, "#=GF ID", 7) == 0)) {
-              *id = (char *)vrna_alloc(sizeof(char) * n);
-              if (sscanf(line, "#=GF ID %s", *id) == 1) {
-                *id = (char *)vrna_realloc(*id, sizeof(char) * (strlen(*id) + 1));
-              } else {
-                free(*id);
-                *id = NULL;
-              }
-            }
-          } else if (strncmp(line, "#=GC", 4) == 0) {
-            /* found per-column annotation */
-            if ((structure != NULL) && (strncmp(line, "#=GC SS_cons ", 13) == 0)) {
-              char *ss = (char *)vrna_alloc(sizeof(char) * n);
-              if (sscanf(line, "#=GC SS_cons %s", ss) == 1) {
-                /* always append consensus structure */
-                unsigned int  prev_len  = (*structure) ? strlen(*structure) : 0;
-                unsigned int  ss_len    = strlen(ss);
-                *structure = (char *)vrna_realloc(*structure,
-                                                  sizeof(char) *
-                                                  (prev_len + ss_len + 1));
-                memcpy(*structure + prev_len,
-                       ss,
-                       sizeof(char) * ss_len);
-                (*structure)[prev_len + ss_len] = '\0';
-              }
-
-              free(ss);
-            }
-          } else if (strncmp(line, "#=GS", 4) == 0) {
-            /* found generic per-sequence annotation */
-          } else if (strncmp(line, "#=GR", 4) == 0) {
-            /* found generic per-Residue annotation */
-          } else {
-            /* may be comment? */
-          }
+  while ((n = read_line(fp, &line, &line_size)) >= 0) {
+    if (strncmp(line, "//", 2) == 0) /* end of alignment */
+      break;
 
-          break;
+    switch (*line) {
+      /* we skip lines that start with whitespace */
+      case ' ':
+      case '\0':
+        seq_current = 0; /* reset number of current sequence */
+        break;
 
-        /* should be sequence */
-        default:
-        {
-          char  *tmp_name = (char *)vrna_alloc(sizeof(char) * (n + 1));
-          char  *tmp_seq  = (char *)vrna_alloc(sizeof(char) * (n + 1));
-          if (sscanf(line, "%s %s", tmp_name, tmp_seq) == 2) {
-            for (i = 0; i < strlen(tmp_seq); i++)
-              if (tmp_seq[i] == '.') /* replace '.' gaps with '-' */
-                tmp_seq[i] = '-';
-
-            if (seq_current == seq_num) {
-              /* first time */
-              add_sequence(tmp_name, tmp_seq,
-                           names, aln,
-                           seq_current + 1);
+      /* Stockholm markup, or comment */
+      case '#':
+        if (strncmp(line, "#=GR", 4) == 0) {
+          /* found generic per-Residue annotation, skipped without further inspection */
+        } else if (strstr(line, "STOCKHOLM 1.0")) {
+          if (verbosity >= 0)
+            vrna_message_warning("Malformatted Stockholm record, missing // ?");
+
+          /* drop everything we've read so far and start new, blank record */
+          rows_clear(&rows);
+          free_msa_record(names, aln, id, structure);
+        } else if (strncmp(line, "#=GF", 4) == 0) {
+          /* found feature markup */
+          if ((id != NULL) && (strncmp(line, "#=GF ID", 7) == 0)) {
+            free(*id);
+            *id = (char *)vrna_alloc(sizeof(char) * n);
+            if (sscanf(line, "#=GF ID %s", *id) == 1) {
+              *id = (char *)vrna_realloc(*id, sizeof(char) * (strlen(*id) + 1));
             } else {
-              if (strcmp(tmp_name, (*names)[seq_current]) != 0) {
-                /* name doesn't match */
-                if (verbosity >= 0)
-                  vrna_message_warning(
-                    "Sorry, your file is messed up! Inconsistent (order of) sequence identifiers.");
-
-                free(line);
-                free(tmp_name);
-                free(tmp_seq);
-                return 0;
-              }
-
-              unsigned int  tmp_seq_len = strlen(tmp_seq);
-              unsigned int  current_len = strlen((*aln)[seq_current]);
-
-              (*aln)[seq_current] = (char *)vrna_realloc((*aln)[seq_current],
-                                                         current_len +
-                                                         tmp_seq_len +
-                                                         1);
-              memcpy((*aln)[seq_current] + current_len,
-                     tmp_seq,
-                     sizeof(char) * tmp_seq_len);
-
-              (*aln)[seq_current][current_len + tmp_seq_len] = '\0';
+              free(*id);
+              *id = NULL;
             }
           }
+        } else if (strncmp(line, "#=GC", 4) == 0) {
+          /* found per-column annotation */
+          if ((structure != NULL) && (strncmp(line, "#=GC SS_cons ", 13) == 0)) {
+            char *ss = (char *)vrna_alloc(sizeof(char) * n);
+            if (sscanf(line, "#=GC SS_cons %s", ss) == 1) {
+              /* always append consensus structure */
+              unsigned int  prev_len  = (*structure) ? strlen(*structure) : 0;
+              unsigned int  ss_len    = strlen(ss);
+              *structure = (char *)vrna_realloc(*structure,
+                                                sizeof(char) *
+                                                (prev_len + ss_len + 1));
+              memcpy(*structure + prev_len,
+                     ss,
+                     sizeof(char) * ss_len);
+              (*structure)[prev_len + ss_len] = '\0';
+            }
 
-          seq_current++;
-          if (seq_current > seq_num)
-            seq_num = seq_current;
-
-          free(tmp_name);
-          free(tmp_seq);
+            free(ss);
+          }
+        } else if (strncmp(line, "#=GS", 4) == 0) {
+          /* found generic per-sequence annotation */
+        } else {
+          /* may be comment? */
         }
+
         break;
-      }
 
-stockholm_next_line:
+      /* should be sequence */
+      default:
+        ptr       = line;
+        tmp_name  = next_token(&ptr, &name_len);
+        tmp_seq   = next_token(&ptr, &seq_len);
+
+        if (tmp_seq) {
+          if (seq_current >= rows.num) {
+            /* first time */
+            rows_add(&rows, tmp_name, name_len, tmp_seq, seq_len, 1);
+          } else {
+            if ((strlen(rows.names[seq_current]) != name_len) ||
+                (strncmp(tmp_name, rows.names[seq_current], name_len) != 0)) {
+              /* name doesn't match */
+              if (verbosity >= 0)
+                vrna_message_warning(
+                  "Sorry, your file is messed up! Inconsistent (order of) sequence identifiers.");
+
+              rows_clear(&rows);
+              free(line);
+              return 0;
+            }
+
+            rows_append(&rows, seq_current, tmp_seq, seq_len, 1);
+          }
+        }
 
-      free(line);
+        seq_current++;
+        break;
     }
-  } else {
-    /*
-     *  if (verbosity >= 0)
-     *    vrna_message_warning("Did not find any Stockholm 1.0 formatted record!");
-     */
-    return -1;
   }
 
   free(line);
 
-  endmarker_msa_record(names, aln, seq_num);
+  seq_num = rows_finalize(&rows, names, aln);
 
   if ((seq_num > 0) && (verbosity > 0))
     vrna_message_info(stderr, "%d sequences; length of alignment %d.", seq_num,
@@ -764,32 +783,34 @@ parse_fasta_alignment(FILE  *fp,
                       char  ***aln,
                       int   verbosity)
 {
-  unsigned int  read_opt, rec_type;
-  int           seq_num;
-  char          *rec_id, *rec_sequence, **rec_rest;
+  unsigned int    read_opt, rec_type;
+  int             seq_num;
+  char            *rec_id, *rec_sequence, **rec_rest, *ptr, *id;
+  size_t          id_len;
+  struct msa_rows rows;
 
   rec_id        = NULL;
   rec_sequence  = NULL;
   rec_rest      = NULL;
-  seq_num       = 0;
   read_opt      = VRNA_INPUT_NO_REST; /* read sequence and header information only */
 
+  rows_init(&rows);
+
   /* read until EOF or user abort */
   while (
     !((rec_type = vrna_file_fasta_read_record(&rec_id, &rec_sequence, &rec_rest, fp, read_opt))
       & (VRNA_INPUT_ERROR | VRNA_INPUT_QUIT))) {
     if (rec_id) {
       /* valid FASTA entry */
-      seq_num++;
-
-      char *id = (char *)vrna_alloc(sizeof(char) * strlen(rec_id));
-      (void)sscanf(rec_id, ">%s", id);
-
-      add_sequence(id, rec_sequence,
-                   names, aln,
-                   seq_num);
-
-      free(id);
+      ptr = (rec_id[0] == '>') ? rec_id + 1 : rec_id + strlen(rec_id);
+      id  = next_token(&ptr, &id_len);
+
+      rows_add(&rows,
+               (id) ? id : "",
+               (id) ? id_len : 0,
+               rec_sequence,
+               strlen(rec_sequence),
+               0);
     }
 
     free(rec_id);
@@ -801,7 +822,7 @@ parse_fasta_alignment(FILE  *fp,
   free(rec_sequence);
   free(rec_rest);
 
-  endmarker_msa_record(names, aln, seq_num);
+  seq_num = rows_finalize(&rows, names, aln);
 
   if (seq_num > 0) {
     if (verbosity > 0)
@@ -825,11 +846,19 @@ parse_clustal_alignment(FILE  *clust,
                         char  ***aln,
                         int   verbosity)
 {
-  char  *line, *name, *seq;
-  int   n, nn = 0, seq_num = 0, i;
+  char            *line, *ptr, *name, *seq;
+  size_t          line_size, name_len, seq_len;
+  int             n, nn, seq_num;
+  struct msa_rows rows;
+
+  line      = NULL;
+  line_size = 0;
+  nn        = 0;
 
-  if ((line = vrna_read_line(clust)) == NULL)
+  if (read_line(clust, &line, &line_size) < 0) {
+    free(line);
     return -1;
+  }
 
   if (strncmp(line, "CLUSTAL", 7) != 0) {
     if (verbosity >= 0)
@@ -839,82 +868,50 @@ parse_clustal_alignment(FILE  *clust,
     return -1;
   }
 
-  free(line);
-  line = vrna_read_line(clust);
-
-  while (line != NULL) {
-    n = strlen(line);
+  rows_init(&rows);
 
+  while ((n = read_line(clust, &line, &line_size)) >= 0) {
     if ((n < 4) || isspace((int)line[0])) {
       /* skip non-sequence line */
-      free(line);
-      line  = vrna_read_line(clust);
-      nn    = 0;  /* reset sequence number */
+      nn = 0;  /* reset sequence number */
       continue;
     }
 
     /* skip comments */
-    if (line[0] == '#') {
-      free(line);
-      line = vrna_read_line(clust);
+    if (line[0] == '#')
       continue;
-    }
 
-    seq   = (char *)vrna_alloc(sizeof(char) * (n + 1));
-    name  = (char *)vrna_alloc(sizeof(char) * (n + 1));
-    if (sscanf(line, "%s %s", name, seq) == 2) {
-      /* realloc to actual sizes */
-      seq   = (char *)vrna_realloc(seq, sizeof(char) * (strlen(seq) + 1));
-      name  = (char *)vrna_realloc(name, sizeof(char) * (strlen(name) + 1));
-      for (i = 0; i < strlen(seq); i++)
-        if (seq[i] == '.') /* replace '.' gaps with '-' */
-          seq[i] = '-';
-
-      if (nn == seq_num) {
+    ptr   = line;
+    name  = next_token(&ptr, &name_len);
+    seq   = next_token(&ptr, &seq_len);
+
+    if (seq) {
+      if (nn >= rows.num) {
         /* first time */
-        add_sequence(name, seq,
-                     names, aln,
-                     nn + 1);
+        rows_add(&rows, name, name_len, seq, seq_len, 1);
       } else {
-        if (strcmp(name, (*names)[nn]) != 0) {
+        if ((strlen(rows.names[nn]) != name_len) ||
+            (strncmp(name, rows.names[nn], name_len) != 0)) {
           /* name doesn't match */
           if (verbosity >= 0)
             vrna_message_warning(
               "Sorry, your file is messed up! Inconsistent (order of) sequence identifiers.");
 
+          rows_clear(&rows);
           free(line);
-          free(seq);
           return 0;
         }
 
-        unsigned int  current_len = strlen((*aln)[nn]);
-        unsigned int  seq_len     = strlen(seq);
-
-        (*aln)[nn] = (char *)vrna_realloc((*aln)[nn],
-                                          current_len +
-                                          seq_len +
-                                          1);
-        memcpy((*aln)[nn] + current_len,
-               seq,
-               sizeof(char) * seq_len);
-
-        (*aln)[nn][current_len + seq_len] = '\0';
+        rows_append(&rows, nn, seq, seq_len, 1);
       }
 
       nn++;
-      if (nn > seq_num)
-        seq_num = nn;
-
-      free(seq);
-      free(name);
     }
-
-    free(line);
-
-    line = vrna_read_line(clust);
   }
 
-  endmarker_msa_record(names, aln, seq_num);
+  free(line);
+
+  seq_num = rows_finalize(&rows, names, aln);
 
   if ((seq_num > 0) && (verbosity > 0))
     vrna_message_info(stderr, "%d sequences; length of alignment %d.", seq_num,
@@ -930,10 +927,16 @@ parse_maf_alignment(FILE  *fp,
                     char  ***aln,
                     int   verbosity)
 {
-  char  *line = NULL, *tmp_name, *tmp_sequence, strand;
-  int   n, seq_num, start, length, src_length;
+  char            *line, *tmp_name, *tmp_sequence, strand;
+  size_t          line_size, tmp_size;
+  int             n, seq_num, start, length, src_length;
+  struct msa_rows rows;
 
-  seq_num = 0;
+  line          = NULL;
+  line_size     = 0;
+  tmp_name      = NULL;
+  tmp_sequence  = NULL;
+  tmp_size      = 0;
 
   if (!fp) {
     if (verbosity >= 0)
@@ -952,77 +955,73 @@ parse_maf_alignment(FILE  *fp,
 
   int inrecord = 0;
 
-  while ((line = vrna_read_line(fp))) {
+  while (read_line(fp, &line, &line_size) >= 0) {
     if (*line == 'a') {
       if ((line[1] == '\0') || isspace(line[1])) {
         inrecord = 1;
-        free(line);
         break;
       }
     }
+  }
 
+  if (!inrecord) {
+    /*
+     *  if (verbosity >= 0)
+     *    vrna_message_warning("Did not find any MAF formatted record!");
+     */
     free(line);
+    return -1;
   }
 
-  if (inrecord) {
-    while ((line = vrna_read_line(fp))) {
-      n = (int)strlen(line);
+  rows_init(&rows);
 
-      switch (*line) {
-        case '#': /* comment */
-          break;
+  while ((n = read_line(fp, &line, &line_size)) >= 0) {
+    switch (*line) {
+      case '#': /* comment */
+        break;
 
-        case 'e': /* ignore and fall through */
-        case 'i': /* ignore and fall through */
-        case 'q': /* ignore */
-          break;
+      case 'e': /* ignore and fall through */
+      case 'i': /* ignore and fall through */
+      case 'q': /* ignore */
+        break;
 
-        case 's': /* a sequence within the alignment block */
-          tmp_name      = (char *)vrna_alloc(sizeof(char) * n);
-          tmp_sequence  = (char *)vrna_alloc(sizeof(char) * n);
-          if (sscanf(line, "s %s %d %d %c %d %s",
-                     tmp_name,
-                     &start,
-                     &length,
-                     &strand,
-                     &src_length,
-                     tmp_sequence) == 6) {
-            seq_num++;
-            tmp_name      = (char *)vrna_realloc(tmp_name, sizeof(char) * (strlen(tmp_name) + 1));
-            tmp_sequence  =
-              (char *)vrna_realloc(tmp_sequence, sizeof(char) * (strlen(tmp_sequence) + 1));
-
-            add_sequence(tmp_name, tmp_sequence,
-                         names, aln,
-                         seq_num);
-
-            free(tmp_name);
-            free(tmp_sequence);
-            break;
-          }
+      case 's': /* a sequence within the alignment block */
+        if ((size_t)n >= tmp_size) {
+          tmp_size      = (size_t)n + 1;
+          tmp_name      = (char *)vrna_realloc(tmp_name, sizeof(char) * tmp_size);
+          tmp_sequence  = (char *)vrna_realloc(tmp_sequence, sizeof(char) * tmp_size);
+        }
 
-          free(tmp_name);
-          free(tmp_sequence);
-        /* all through */
+        if (sscanf(line, "s %s %d %d %c %d %s",
+                   tmp_name,
+                   &start,
+                   &length,
+                   &strand,
+                   &src_length,
+                   tmp_sequence) == 6) {
+          rows_add(&rows,
+                   tmp_name,
+                   strlen(tmp_name),
+                   tmp_sequence,
+                   strlen(tmp_sequence),
+                   0);
+          break;
+        }
 
-        default: /* something else that ends the block */
-          free(line);
-          goto maf_exit;
-      }
+      /* all through */
 
-      free(line);
+      default: /* something else that ends the block */
+        goto maf_exit;
     }
-  } else {
-    /*
-     *  if (verbosity >= 0)
-     *    vrna_message_warning("Did not find any MAF formatted record!");
-     */
-    return -1;
   }
 
 maf_exit:
 
-  endmarker_msa_record(names, aln, seq_num);
+  free(line);
+  free(tmp_name);
+  free(tmp_sequence);
+
+  seq_num = rows_finalize(&rows, names, aln);
 
   if ((seq_num > 0) && (verbosity > 0))
     vrna_message_info(stderr, "%d sequences; length of alignment %d.", seq_num,
@@ -1154,58 +1153,43 @@ write_aln_stockholm(FILE          *fp,
 }
 
 
-PRIVATE void
-add_sequence(const char *id,
-             const char *seq,
-             char       ***names,
-             char       ***aln,
-             int        seq_num)
-{
-  (*names)              = (char **)vrna_realloc(*names, sizeof(char *) * (seq_num));
-  (*names)[seq_num - 1] = strdup(id);
-  (*aln)                = (char **)vrna_realloc(*aln, sizeof(char *) * (seq_num));
-  (*aln)[seq_num - 1]   = strdup(seq);
-}
-
-
-PRIVATE void
-endmarker_msa_record(char ***names,
-                     char ***aln,
-                     int  seq_num)
-{
-  /*
-   * append additional entry in 'aln' and 'names' pointing to NULL (this may be
-   * used as an indication for the end of the sequence list)
-   */
-  if (seq_num > 0) {
-    (*aln)            = (char **)vrna_realloc(*aln, sizeof(char *) * (seq_num + 1));
-    (*names)          = (char **)vrna_realloc(*names, sizeof(char *) * (seq_num + 1));
-    (*aln)[seq_num]   = NULL;
-    (*names)[seq_num] = NULL;
-  }
-}
-
-
 PRIVATE int
 check_alignment(const char  **names,
                 const char  **aln,
                 int         seq_num,
                 int         verbosity)
 {
-  int i, j, l, pass = 1;
+  unsigned int  h, size, *table;
+  int           i, j, l, pass = 1;
+  const char    *c;
+
+  /* check for unique names, using an open addressing hash table of row indices + 1 */
+  for (size = 2; size < 2 * (unsigned int)seq_num; size <<= 1);
+
+  table = (unsigned int *)vrna_alloc(sizeof(unsigned int) * size);
 
-  /* check for unique names */
   for (i = 0; i < seq_num; i++) {
-    for (j = i + 1; j < seq_num; j++) {
+    /* FNV-1a */
+    for (h = 2166136261U, c = names[i]; *c; c++)
+      h = (h ^ (unsigned char)(*c)) * 16777619U;
+
+    for (h &= size - 1; table[h] != 0; h = (h + 1) & (size - 1)) {
+      j = (int)table[h] - 1;
       if (!strcmp(names[i], names[j])) {
         if (verbosity >= 0)
           vrna_message_warning("Sequence IDs in input alignment are not unique!");
 
         pass = 0;
+        break;
       }
     }
+
+    if (table[h] == 0)
+      table[h] = (unsigned int)i + 1;
   }
 
+  free(table);
+
   /* check for equal lengths of sequences */
   l = (int)strlen(aln[0]);
   for (i = 1; i < seq_num; i++)
@@ -1218,3 +1202,211 @@ check_alignment(const char  **names,
 
   return pass;
 }
+
+
+/*
+ *  Read a line of arbitrary length into a buffer that is re-used (and
+ *  enlarged on demand) for subsequent lines. The trailing newline is
+ *  removed. Returns the length of the line or -1 on end of file.
+ */
+PRIVATE int
+read_line(FILE    *fp,
+          char    **buf,
+          size_t  *size)
+{
+  size_t  len, l;
+  char    *cp;
+
+  if (*size < MSA_LINE_CHUNK) {
+    *size = MSA_LINE_CHUNK;
+    *buf  = (char *)vrna_realloc(*buf, sizeof(char) * (*size));
+  }
+
+  len = 0;
+
+  while (fgets(*buf + len, (int)(*size - len), fp)) {
+    l   = strlen(*buf + len);
+    cp  = (l > 0) ? *buf + len + l - 1 : NULL;
+    len += l;
+
+    if ((cp) && (*cp == '\n')) {
+      *cp = '\0';
+      return (int)(len - 1);
+    }
+
+    if (len + 1 < *size) /* end of file without trailing newline */
+      return (int)len;
+
+    *size *= 2;
+    *buf  = (char *)vrna_realloc(*buf, sizeof(char) * (*size));
+  }
+
+  return (len > 0) ? (int)len : -1;
+}
+
+
+/*
+ *  Return a pointer to the next whitespace delimited token at *ptr and
+ *  store its length in len. *ptr is advanced past the token. Returns NULL
+ *  if there is no further token
+ */
+PRIVATE char *
+next_token(char   **ptr,
+           size_t *len)
+{
+  char *start, *p;
+
+  for (p = *ptr; (*p) && isspace((int)(*p)); p++);
+
+  if (*p == '\0') {
+    *ptr = p;
+    *len = 0;
+    return NULL;
+  }
+
+  for (start = p; (*p) && !isspace((int)(*p)); p++);
+
+  *ptr = p;
+  *len = (size_t)(p - start);
+
+  return start;
+}
+
+
+PRIVATE void
+rows_init(struct msa_rows *rows)
+{
+  rows->names = NULL;
+  rows->aln   = NULL;
+  rows->len   = NULL;
+  rows->cap   = NULL;
+  rows->num   = 0;
+  rows->size  = 0;
+}
+
+
+PRIVATE void
+rows_clear(struct msa_rows *rows)
+{
+  int i;
+
+  for (i = 0; i < rows->num; i++) {
+    free(rows->names[i]);
+    free(rows->aln[i]);
+  }
+
+  free(rows->names);
+  free(rows->aln);
+  free(rows->len);
+  free(rows->cap);
+
+  rows_init(rows);
+}
+
+
+/*
+ *  copy seq_len characters of seq into row i, growing the row geometrically.
+ *  If convert_gaps is set, '.' gap characters are replaced by '-'
+ */
+PRIVATE void
+rows_append(struct msa_rows *rows,
+            int             i,
+            const char      *seq,
+            size_t          seq_len,
+            int             convert_gaps)
+{
+  size_t  k, len;
+  char    *row;
+
+  len = rows->len[i];
+
+  if (len + seq_len + 1 > rows->cap[i]) {
+    rows->cap[i] = 2 * rows->cap[i];
+    if (rows->cap[i] < len + seq_len + 1)
+      rows->cap[i] = len + seq_len + 1;
+
+    rows->aln[i] = (char *)vrna_realloc(rows->aln[i], sizeof(char) * rows->cap[i]);
+  }
+
+  row = rows->aln[i] + len;
+
+  if (convert_gaps) {
+    for (k = 0; k < seq_len; k++)
+      row[k] = (seq[k] == '.') ? '-' : seq[k];
+  } else {
+    memcpy(row, seq, sizeof(char) * seq_len);
+  }
+
+  row[seq_len]  = '\0';
+  rows->len[i]  = len + seq_len;
+}
+
+
+PRIVATE void
+rows_add(struct msa_rows  *rows,
+         const char       *name,
+         size_t           name_len,
+         const char       *seq,
+         size_t           seq_len,
+         int              convert_gaps)
+{
+  int i;
+
+  if (rows->num == rows->size) {
+    rows->size  = (rows->size) ? 2 * rows->size : 16;
+    rows->names = (char **)vrna_realloc(rows->names, sizeof(char *) * rows->size);
+    rows->aln   = (char **)vrna_realloc(rows->aln, sizeof(char *) * rows->size);
+    rows->len   = (size_t *)vrna_realloc(rows->len, sizeof(size_t) * rows->size);
+    rows->cap   = (size_t *)vrna_realloc(rows->cap, sizeof(size_t) * rows->size);
+  }
+
+  i               = rows->num++;
+  rows->names[i]  = (char *)vrna_alloc(sizeof(char) * (name_len + 1));
+  memcpy(rows->names[i], name, sizeof(char) * name_len);
+
+  rows->aln[i]  = NULL;
+  rows->len[i]  = 0;
+  rows->cap[i]  = 0;
+
+  rows_append(rows, i, seq, seq_len, convert_gaps);
+}
+
+
+/*
+ *  hand over the collected rows as NULL-terminated arrays, shrinking all
+ *  allocations to their actual sizes. Returns the number of rows
+ */
+PRIVATE int
+rows_finalize(struct msa_rows *rows,
+              char            ***names,
+              char            ***aln)
+{
+  int i, num;
+
+  num = rows->num;
+
+  if (num > 0) {
+    for (i = 0; i < num; i++)
+      if (rows->cap[i] > rows->len[i] + 1)
+        rows->aln[i] = (char *)vrna_realloc(rows->aln[i], sizeof(char) * (rows->len[i] + 1));
+
+    /*
+     * append additional entry in 'aln' and 'names' pointing to NULL (this may be
+     * used as an indication for the end of the sequence list)
+     */
+    *names        = (char **)vrna_realloc(rows->names, sizeof(char *) * (num + 1));
+    *aln          = (char **)vrna_realloc(rows->aln, sizeof(char *) * (num + 1));
+    (*names)[num] = NULL;
+    (*aln)[num]   = NULL;
+  } else {
+    free(rows->names);
+    free(rows->aln);
+  }
+
+  free(rows->len);
+  free(rows->cap);
+
+  rows_init(rows);
+
+  return num;
+}
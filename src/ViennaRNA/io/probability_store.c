@@ -0,0 +1,682 @@
+/*
+ *  A compact binary container for base pair probabilities and ensemble data
+ *
+ *  File layout (all numbers in native byte order):
+ *
+ *    header    magic, version, byte order mark, number of records, offset of the index
+ *    records   for each record the sequence, the MFE structure (optional), the pair list
+ *              including its end marker, and 'ulength' rows of 'length' unpaired
+ *              probabilities, each part padded to a multiple of 8 bytes
+ *    index     one entry per record, in the order the records were added
+ *    order     positions of the index entries, sorted by ID
+ *    IDs       '\0'-terminated ID strings referenced by the index
+ */
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/structures.h"
+#include "ViennaRNA/io/probability_store.h"
+
+#include "binary_store.inc"
+
+#define PROB_STORE_MAGIC      "VRNA_BPP"
+#define PROB_STORE_VERSION    1U
+
+struct prob_index {
+  uint64_t  id_offset;
+  uint64_t  data_offset;
+  uint32_t  length;
+  uint32_t  ulength;
+  uint32_t  n_pairs;
+  uint32_t  has_structure;
+  double    mfe;
+  double    ensemble_energy;
+  double    cutoff;
+  double    temperature;
+  int32_t   dangles;
+  int32_t   noLP;
+  int32_t   noGU;
+  int32_t   circ;
+  int32_t   gquad;
+  int32_t   window_size;
+  int32_t   max_bp_span;
+  uint32_t  cutpoint;
+  uint32_t  n_seq;
+  uint32_t  reserved;
+};
+
+/* offsets of the parts of a record relative to its data offset */
+struct prob_layout {
+  uint64_t  structure;
+  uint64_t  pairs;
+  uint64_t  unpaired;
+  uint64_t  size;
+};
+
+struct prob_record {
+  char              *id;
+  struct prob_index idx;
+};
+
+struct vrna_prob_store_s {
+  int                     writing;
+
+  /* stores opened for writing */
+  FILE                    *fp;
+  uint64_t                offset;
+  int                     failed;   /* a record was written only partially */
+  struct prob_record      *records;
+  size_t                  n_records;
+  size_t                  records_size;
+
+  /* stores opened for reading */
+  struct store_file       file;
+  const struct prob_index *index;
+  const uint64_t          *order;
+  uint64_t                n_index;
+};
+
+
+/*
+ #################################
+ # PRIVATE FUNCTION DECLARATIONS #
+ #################################
+ */
+PRIVATE void
+record_layout(const struct prob_index *e,
+              struct prob_layout      *layout);
+
+
+PRIVATE int
+write_block(vrna_prob_store_t store,
+            const void        *data,
+            size_t            size);
+
+
+PRIVATE int
+finalize(vrna_prob_store_t store);
+
+
+PRIVATE void
+fill_record(vrna_prob_store_t         store,
+            const struct prob_index   *e,
+            vrna_prob_store_record_t  *record);
+
+
+PRIVATE int
+compare_records(const void  *a,
+                const void  *b);
+
+
+/*
+ #################################
+ # BEGIN OF FUNCTION DEFINITIONS #
+ #################################
+ */
+PUBLIC vrna_prob_store_t
+vrna_prob_store_create(const char *filename)
+{
+  struct vrna_prob_store_s  *store;
+  FILE                      *fp;
+
+  if (!filename)
+    return NULL;
+
+  fp = fopen(filename, "wb");
+  if (!fp) {
+    vrna_message_warning("vrna_prob_store_create: Failed to open file \"%s\" for writing",
+                         filename);
+    return NULL;
+  }
+
+  /* reserve space for the header, the actual one is written upon closing the store */
+  if (!store_header_write(fp, NULL, 0, 0, 0)) {
+    vrna_message_warning("vrna_prob_store_create: Failed to write to file \"%s\"", filename);
+    fclose(fp);
+    return NULL;
+  }
+
+  store               = (struct vrna_prob_store_s *)vrna_alloc(sizeof(struct vrna_prob_store_s));
+  store->writing      = 1;
+  store->fp           = fp;
+  store->offset       = sizeof(struct store_header);
+  store->records_size = 64;
+  store->records      = (struct prob_record *)vrna_alloc(sizeof(struct prob_record) *
+                                                         store->records_size);
+
+  return store;
+}
+
+
+PUBLIC int
+vrna_prob_store_add(vrna_prob_store_t               store,
+                    const vrna_prob_store_record_t  *record)
+{
+  static const vrna_ep_t  end_marker = {
+    0, 0, 0., 0
+  };
+  unsigned int            u;
+  size_t                  n;
+  struct prob_record      *rec;
+  struct prob_index       *e;
+  struct prob_layout      layout;
+
+  if ((!store) || (!store->writing) || (store->failed) || (!record) || (!record->id) ||
+      (!record->sequence) || ((record->n_pairs > 0) && (!record->pairs)))
+    return 0;
+
+  n = (size_t)record->length;
+
+  if ((strlen(record->sequence) != n) ||
+      ((record->structure) && (strlen(record->structure) != n))) {
+    vrna_message_warning("vrna_prob_store_add: Sequence and structure of \"%s\" "
+                         "do not match the length %u",
+                         record->id,
+                         record->length);
+    return 0;
+  }
+
+  if (store->n_records == store->records_size) {
+    store->records_size *= 2;
+    store->records      = (struct prob_record *)vrna_realloc(store->records,
+                                                             sizeof(struct prob_record) *
+                                                             store->records_size);
+  }
+
+  rec = store->records + store->n_records;
+  e   = &(rec->idx);
+
+  memset(e, 0, sizeof(struct prob_index));
+  e->data_offset      = store->offset;
+  e->length           = record->length;
+  e->ulength          = (record->unpaired) ? record->ulength : 0;
+  e->n_pairs          = record->n_pairs;
+  e->has_structure    = (record->structure) ? 1 : 0;
+  e->mfe              = record->mfe;
+  e->ensemble_energy  = record->ensemble_energy;
+  e->cutoff           = record->cutoff;
+  e->temperature      = record->temperature;
+  e->dangles          = record->dangles;
+  e->noLP             = record->noLP;
+  e->noGU             = record->noGU;
+  e->circ             = record->circ;
+  e->gquad            = record->gquad;
+  e->window_size      = record->window_size;
+  e->max_bp_span      = record->max_bp_span;
+  e->cutpoint         = record->cutpoint;
+  e->n_seq            = record->n_seq;
+
+  record_layout(e, &layout);
+
+  /*
+   *  a partially written record leaves the file in an undefined state, so
+   *  any further records are refused and closing the store fails
+   */
+  if ((!write_block(store, record->sequence, n + 1)) ||
+      ((record->structure) && (!write_block(store, record->structure, n + 1))) ||
+      ((record->n_pairs > 0) &&
+       (!write_block(store, record->pairs, sizeof(vrna_ep_t) * record->n_pairs))) ||
+      (!write_block(store, &end_marker, sizeof(vrna_ep_t))))
+    goto prob_store_add_fail;
+
+  for (u = 0; u < e->ulength; u++) {
+    if (fwrite(record->unpaired + (size_t)u * n, sizeof(double), n, store->fp) != n)
+      goto prob_store_add_fail;
+
+    store->offset += (uint64_t)sizeof(double) * n;
+  }
+
+  if (store->offset - e->data_offset != layout.size)
+    goto prob_store_add_fail;
+
+  rec->id = strdup(record->id);
+  store->n_records++;
+
+  return 1;
+
+prob_store_add_fail:
+
+  vrna_message_warning("vrna_prob_store_add: Failed to write data of \"%s\"", record->id);
+  store->failed = 1;
+
+  return 0;
+}
+
+
+PUBLIC int
+vrna_prob_store_add_fc(vrna_prob_store_t    store,
+                       const char           *id,
+                       vrna_fold_compound_t *fc,
+                       const char           *structure,
+                       double               mfe,
+                       double               ensemble_energy,
+                       double               cutoff)
+{
+  int                       ret;
+  vrna_prob_store_record_t  *record;
+
+  if (!store)
+    return 0;
+
+  record = vrna_prob_store_record_fc(id, fc, structure, mfe, ensemble_energy, cutoff);
+  if (!record)
+    return 0;
+
+  ret = vrna_prob_store_add(store, record);
+
+  vrna_prob_store_record_free(record);
+
+  return ret;
+}
+
+
+PUBLIC vrna_prob_store_record_t *
+vrna_prob_store_record_fc(const char            *id,
+                          vrna_fold_compound_t  *fc,
+                          const char            *structure,
+                          double                mfe,
+                          double                ensemble_energy,
+                          double                cutoff)
+{
+  short                     *S;
+  int                       *iindx;
+  unsigned int              i, j, n;
+  double                    *unpaired;
+  FLT_OR_DBL                *probs, p;
+  vrna_ep_t                 *pl, *ptr;
+  vrna_md_t                 *md;
+  vrna_prob_store_record_t  *record;
+
+  if ((!fc) || (!id))
+    return NULL;
+
+  if ((!fc->exp_matrices) || (!fc->exp_matrices->probs)) {
+    vrna_message_warning("vrna_prob_store_record_fc: "
+                         "Base pair probabilities of \"%s\" have not been computed",
+                         id);
+    return NULL;
+  }
+
+  n     = fc->length;
+  md    = &(fc->exp_params->model_details);
+  S     = (fc->type == VRNA_FC_TYPE_SINGLE) ? fc->sequence_encoding2 : fc->S_cons;
+  iindx = fc->iindx;
+  probs = fc->exp_matrices->probs;
+  pl    = vrna_plist_from_probs(fc, cutoff);
+
+  record = (vrna_prob_store_record_t *)vrna_alloc(sizeof(vrna_prob_store_record_t));
+
+  for (ptr = pl; (ptr) && (ptr->i); ptr++)
+    record->n_pairs++;
+
+  /* probability of each nucleotide not to be involved in any base pair */
+  unpaired = (double *)vrna_alloc(sizeof(double) * n);
+
+  for (i = 1; i <= n; i++)
+    unpaired[i - 1] = 1.;
+
+  for (i = 1; i < n; i++)
+    for (j = i + 1; j <= n; j++) {
+      /* entries of G-quadruplexes do not denote base pairs */
+      if ((md->gquad) && (S[i] == 3) && (S[j] == 3))
+        continue;
+
+      p                 = probs[iindx[i] - j];
+      unpaired[i - 1]   -= p;
+      unpaired[j - 1]   -= p;
+    }
+
+  record->id              = strdup(id);
+  record->sequence        = strdup((fc->type == VRNA_FC_TYPE_SINGLE) ? fc->sequence : fc->cons_seq);
+  record->structure       = (structure) ? strdup(structure) : NULL;
+  record->length          = n;
+  record->ulength         = 1;
+  record->pairs           = pl;
+  record->unpaired        = unpaired;
+  record->mfe             = mfe;
+  record->ensemble_energy = ensemble_energy;
+  record->cutoff          = cutoff;
+  record->temperature     = md->temperature;
+  record->dangles         = md->dangles;
+  record->noLP            = md->noLP;
+  record->noGU            = md->noGU;
+  record->circ            = md->circ;
+  record->gquad           = md->gquad;
+  record->window_size     = md->window_size;
+  record->max_bp_span     = md->max_bp_span;
+  record->cutpoint        = (fc->strands > 1) ? fc->strand_start[1] : 0;
+  record->n_seq           = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
+
+  return record;
+}
+
+
+PUBLIC void
+vrna_prob_store_record_free(vrna_prob_store_record_t *record)
+{
+  if (record) {
+    free((char *)record->id);
+    free((char *)record->sequence);
+    free((char *)record->structure);
+    free((vrna_ep_t *)record->pairs);
+    free((double *)record->unpaired);
+    free(record);
+  }
+}
+
+
+PUBLIC vrna_prob_store_t
+vrna_prob_store_open(const char *filename)
+{
+  uint64_t                  k, ids_offset;
+  struct store_header       header;
+  struct prob_layout        layout;
+  struct vrna_prob_store_s  *store;
+
+  if (!filename)
+    return NULL;
+
+  store = (struct vrna_prob_store_s *)vrna_alloc(sizeof(struct vrna_prob_store_s));
+
+  if (!store_map(&(store->file), filename, "vrna_prob_store_open")) {
+    free(store);
+    return NULL;
+  }
+
+  /* each record has an index entry and a position in the order */
+  switch (store_header_read(&(store->file),
+                            PROB_STORE_MAGIC,
+                            PROB_STORE_VERSION,
+                            sizeof(struct prob_index) + sizeof(uint64_t),
+                            &header,
+                            "vrna_prob_store_open",
+                            filename)) {
+    case STORE_HEADER_OK:
+      break;
+    case STORE_HEADER_CORRUPT:
+      goto prob_store_open_corrupt;
+    default:
+      goto prob_store_open_fail;
+  }
+
+  store->index    = (const struct prob_index *)(store->file.data + header.index_offset);
+  store->order    = (const uint64_t *)(store->index + header.n_records);
+  store->n_index  = header.n_records;
+  ids_offset      = header.index_offset +
+                    (sizeof(struct prob_index) + sizeof(uint64_t)) * header.n_records;
+
+  for (k = 0; k < store->n_index; k++) {
+    const struct prob_index *e = store->index + k;
+
+    if ((store->order[k] >= store->n_index) ||
+        (e->id_offset < ids_offset) ||
+        (e->id_offset >= store->file.size) ||
+        (e->data_offset % STORE_ALIGN) ||
+        (e->data_offset > header.index_offset) ||
+        ((uint64_t)e->ulength * e->length >
+         (header.index_offset - e->data_offset) / sizeof(double)))
+      goto prob_store_open_corrupt;
+
+    record_layout(e, &layout);
+
+    if ((layout.size > header.index_offset - e->data_offset) ||
+        (store->file.data[e->data_offset + e->length] != '\0') ||
+        ((e->has_structure) &&
+         (store->file.data[e->data_offset + layout.structure + e->length] != '\0')))
+      goto prob_store_open_corrupt;
+  }
+
+  return store;
+
+prob_store_open_corrupt:
+
+  vrna_message_warning("vrna_prob_store_open: File \"%s\" is not a valid probability store",
+                       filename);
+
+prob_store_open_fail:
+
+  store_unmap(&(store->file));
+  free(store);
+
+  return NULL;
+}
+
+
+PUBLIC int
+vrna_prob_store_close(vrna_prob_store_t store)
+{
+  int     ret;
+  size_t  k;
+
+  ret = 1;
+
+  if (store) {
+    if (store->writing) {
+      ret = (store->failed) ? 0 : finalize(store);
+
+      if (fclose(store->fp))
+        ret = 0;
+
+      for (k = 0; k < store->n_records; k++)
+        free(store->records[k].id);
+
+      free(store->records);
+    } else {
+      store_unmap(&(store->file));
+    }
+
+    free(store);
+  }
+
+  return ret;
+}
+
+
+PUBLIC unsigned int
+vrna_prob_store_size(vrna_prob_store_t store)
+{
+  if (store)
+    return (store->writing) ? (unsigned int)store->n_records : (unsigned int)store->n_index;
+
+  return 0;
+}
+
+
+PUBLIC int
+vrna_prob_store_get(vrna_prob_store_t         store,
+                    const char                *id,
+                    vrna_prob_store_record_t  *record)
+{
+  int                     c;
+  uint64_t                lo, hi, mid;
+  const struct prob_index *e;
+
+  if ((!store) || (store->writing) || (!id) || (!record))
+    return 0;
+
+  lo  = 0;
+  hi  = store->n_index;
+
+  while (lo < hi) {
+    mid = lo + (hi - lo) / 2;
+    e   = store->index + store->order[mid];
+    c   = strcmp(id, (const char *)(store->file.data + e->id_offset));
+
+    if (c == 0) {
+      fill_record(store, e, record);
+      return 1;
+    } else if (c < 0) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+
+  return 0;
+}
+
+
+PUBLIC int
+vrna_prob_store_get_nth(vrna_prob_store_t         store,
+                        unsigned int              n,
+                        vrna_prob_store_record_t  *record)
+{
+  if ((!store) || (store->writing) || (!record) || (n >= store->n_index))
+    return 0;
+
+  fill_record(store, store->index + n, record);
+
+  return 1;
+}
+
+
+/*
+ #####################################
+ # BEGIN OF STATIC HELPER FUNCTIONS  #
+ #####################################
+ */
+PRIVATE void
+record_layout(const struct prob_index *e,
+              struct prob_layout      *layout)
+{
+  uint64_t s;
+
+  s                 = STORE_PAD((uint64_t)e->length + 1);
+  layout->structure = s;
+
+  if (e->has_structure)
+    s += STORE_PAD((uint64_t)e->length + 1);
+
+  layout->pairs     = s;
+  s                 += (uint64_t)sizeof(vrna_ep_t) * ((uint64_t)e->n_pairs + 1);
+  layout->unpaired  = s;
+  s                 += (uint64_t)sizeof(double) * e->ulength * e->length;
+  layout->size      = s;
+}
+
+
+PRIVATE int
+write_block(vrna_prob_store_t store,
+            const void        *data,
+            size_t            size)
+{
+  if (fwrite(data, 1, size, store->fp) != size)
+    return 0;
+
+  store->offset += size;
+
+  return store_padding_write(store->fp, &(store->offset));
+}
+
+
+PRIVATE int
+finalize(vrna_prob_store_t store)
+{
+  size_t              k;
+  uint64_t            id_offset, pos;
+  struct prob_record  **sorted;
+
+  /* write index in insertion order, followed by the order sorted by ID, and the IDs */
+  id_offset = store->offset +
+              (uint64_t)(sizeof(struct prob_index) + sizeof(uint64_t)) * store->n_records;
+
+  for (k = 0; k < store->n_records; k++) {
+    store->records[k].idx.id_offset = id_offset;
+    id_offset                       += strlen(store->records[k].id) + 1;
+
+    if (fwrite(&(store->records[k].idx), sizeof(struct prob_index), 1, store->fp) != 1)
+      return 0;
+  }
+
+  /* sort records by ID such that look-ups can be done by binary search */
+  sorted = (struct prob_record **)vrna_alloc(sizeof(struct prob_record *) *
+                                             (store->n_records + 1));
+
+  for (k = 0; k < store->n_records; k++)
+    sorted[k] = store->records + k;
+
+  qsort(sorted, store->n_records, sizeof(struct prob_record *), &compare_records);
+
+  for (k = 0; k < store->n_records; k++) {
+    if ((k > 0) && (!strcmp(sorted[k - 1]->id, sorted[k]->id)))
+      vrna_message_warning("vrna_prob_store_close: Duplicate ID \"%s\", "
+                           "only one of the records will be accessible by ID",
+                           sorted[k]->id);
+
+    pos = (uint64_t)(sorted[k] - store->records);
+
+    if (fwrite(&pos, sizeof(uint64_t), 1, store->fp) != 1) {
+      free(sorted);
+      return 0;
+    }
+  }
+
+  free(sorted);
+
+  for (k = 0; k < store->n_records; k++)
+    if (!store_id_write(store->fp, store->records[k].id))
+      return 0;
+
+  /* finally, write the actual header */
+  if ((fseek(store->fp, 0, SEEK_SET)) ||
+      (!store_header_write(store->fp,
+                           PROB_STORE_MAGIC,
+                           PROB_STORE_VERSION,
+                           store->n_records,
+                           store->offset)))
+    return 0;
+
+  return 1;
+}
+
+
+PRIVATE void
+fill_record(vrna_prob_store_t         store,
+            const struct prob_index   *e,
+            vrna_prob_store_record_t  *record)
+{
+  const unsigned char *data;
+  struct prob_layout  layout;
+
+  record_layout(e, &layout);
+
+  data = store->file.data + e->data_offset;
+
+  record->id              = (const char *)(store->file.data + e->id_offset);
+  record->sequence        = (const char *)data;
+  record->structure       = (e->has_structure) ? (const char *)(data + layout.structure) : NULL;
+  record->length          = e->length;
+  record->ulength         = e->ulength;
+  record->n_pairs         = e->n_pairs;
+  record->pairs           = (const vrna_ep_t *)(data + layout.pairs);
+  record->unpaired        = (e->ulength > 0) ? (const double *)(data + layout.unpaired) : NULL;
+  record->mfe             = e->mfe;
+  record->ensemble_energy = e->ensemble_energy;
+  record->cutoff          = e->cutoff;
+  record->temperature     = e->temperature;
+  record->dangles         = e->dangles;
+  record->noLP            = e->noLP;
+  record->noGU            = e->noGU;
+  record->circ            = e->circ;
+  record->gquad           = e->gquad;
+  record->window_size     = e->window_size;
+  record->max_bp_span     = e->max_bp_span;
+  record->cutpoint        = e->cutpoint;
+  record->n_seq           = e->n_seq;
+}
+
+
+PRIVATE int
+compare_records(const void  *a,
+                const void  *b)
+{
+  return strcmp((*(const struct prob_record *const *)a)->id,
+                (*(const struct prob_record *const *)b)->id);
+}
@@ -0,0 +1,260 @@
+#ifndef VIENNA_RNA_PACKAGE_PROBABILITY_STORE_H
+#define VIENNA_RNA_PACKAGE_PROBABILITY_STORE_H
+
+#include <ViennaRNA/fold_compound.h>
+#include <ViennaRNA/utils/structures.h>
+
+/**
+ *  @file     ViennaRNA/io/probability_store.h
+ *  @ingroup  file_utils, probability_store
+ *  @brief    A compact binary container for base pair probabilities and ensemble data
+ */
+
+/**
+ *  @addtogroup probability_store
+ *  @{
+ *  @brief  Read and write base pair probabilities and ensemble properties of many sequences
+ *  from/to a single binary file
+ *
+ *  A probability store holds, for an arbitrary number of sequences, the base pair probabilities
+ *  above a cutoff as a sparse pair list, the probabilities of nucleotides (or stretches of
+ *  nucleotides) to be unpaired, the MFE and ensemble free energy, and the most important
+ *  model settings used to obtain them. Each record is identified by a unique ID. This is the
+ *  data that is otherwise spread over dot-plot files and plain text output of @p RNAfold,
+ *  @p RNAalifold, @p RNAcofold, and @p RNAplfold.
+ *
+ *  Opening a store only maps the file into memory (where supported by the operating
+ *  system), and all data is accessed in place. Thus, there is no parsing involved and only
+ *  those parts of the file that are actually used are read from disk. Records can be
+ *  accessed in the order they were added, or by their ID via binary search on an index
+ *  stored at the end of the file.
+ *
+ *  Pair lists are stored as arrays of #vrna_ep_t terminated by an element with
+ *  @p i = @p j = 0, such that they can be passed directly to any function that expects
+ *  an element probability list. Data is written in native byte order and a store can only
+ *  be read on machines with the same endianness.
+ */
+
+
+/**
+ *  @brief  A probability store
+ *
+ *  @see  vrna_prob_store_create(), vrna_prob_store_open(), vrna_prob_store_close()
+ */
+typedef struct vrna_prob_store_s *vrna_prob_store_t;
+
+
+/**
+ *  @brief  A record of a probability store
+ *
+ *  Records obtained from a store opened for reading point directly into the store.
+ *  The memory must not be modified or freed and is valid until the store is closed.
+ *
+ *  @see  vrna_prob_store_add(), vrna_prob_store_get(), vrna_prob_store_get_nth()
+ */
+typedef struct {
+  const char      *id;              /**<  @brief  The ID of the sequence */
+  const char      *sequence;        /**<  @brief  The sequence (consensus sequence for alignments) */
+  const char      *structure;       /**<  @brief  The MFE structure, or NULL if not available */
+  unsigned int    length;           /**<  @brief  The length of the sequence */
+  unsigned int    ulength;          /**<  @brief  The maximum length of unpaired stretches */
+  unsigned int    n_pairs;          /**<  @brief  The number of elements in @p pairs */
+  const vrna_ep_t *pairs;           /**<  @brief  The pair list, terminated by an element with @p i = @p j = 0 */
+  const double    *unpaired;        /**<  @brief  Unpaired probabilities, @p unpaired[(u - 1) * length + (i - 1)] for the stretch of @p u nucleotides that ends at position @p i */
+  double          mfe;              /**<  @brief  The MFE in kcal/mol, or NaN if not available */
+  double          ensemble_energy;  /**<  @brief  The ensemble free energy in kcal/mol, or NaN if not available */
+  double          cutoff;           /**<  @brief  The probability cutoff applied to the pair list */
+  double          temperature;      /**<  @brief  The temperature in degrees Celsius */
+  int             dangles;          /**<  @brief  The dangle model */
+  int             noLP;             /**<  @brief  Whether lonely pairs were excluded */
+  int             noGU;             /**<  @brief  Whether GU pairs were excluded */
+  int             circ;             /**<  @brief  Whether the sequence is circular */
+  int             gquad;            /**<  @brief  Whether G-quadruplexes were included */
+  int             window_size;      /**<  @brief  The window size, i.e. the sequence length for global folding */
+  int             max_bp_span;      /**<  @brief  The maximum base pair span */
+  unsigned int    cutpoint;         /**<  @brief  The first position of the second strand, or 0 for single strands */
+  unsigned int    n_seq;            /**<  @brief  The number of sequences of an alignment, or 1 */
+} vrna_prob_store_record_t;
+
+
+/**
+ *  @brief  Create a new probability store
+ *
+ *  The store is written to @p filename. Records are appended by vrna_prob_store_add()
+ *  and the store is finalized, i.e. the index is written, by vrna_prob_store_close().
+ *
+ *  @see  vrna_prob_store_add(), vrna_prob_store_add_fc(), vrna_prob_store_close(),
+ *        vrna_prob_store_open()
+ *
+ *  @param  filename  The name of the file to create
+ *  @return           The store opened for writing, or NULL on error
+ */
+vrna_prob_store_t
+vrna_prob_store_create(const char *filename);
+
+
+/**
+ *  @brief  Add a record to a probability store
+ *
+ *  All data of @p record is copied to the store. The pair list @p record->pairs must
+ *  provide @p record->n_pairs elements and @p record->unpaired, if not NULL, must
+ *  provide @p record->ulength rows of @p record->length probabilities each. The
+ *  MFE structure may be NULL. If writing the data fails, the store refuses any further
+ *  records and vrna_prob_store_close() reports the failure.
+ *
+ *  @see  vrna_prob_store_create(), vrna_prob_store_add_fc(), vrna_prob_store_close()
+ *
+ *  @param  store   The probability store opened for writing
+ *  @param  record  The record to add
+ *  @return         Non-zero on success, 0 otherwise
+ */
+int
+vrna_prob_store_add(vrna_prob_store_t               store,
+                    const vrna_prob_store_record_t  *record);
+
+
+/**
+ *  @brief  Add the equilibrium probabilities of a fold compound to a probability store
+ *
+ *  Collects all pairs with probability of at least @p cutoff from the base pair probability
+ *  matrix of @p fc, the probabilities of each nucleotide to be unpaired, and the model
+ *  settings of @p fc and adds them as a new record. Base pair probabilities must have been
+ *  computed before, e.g. by vrna_pf().
+ *
+ *  @see  vrna_prob_store_add(), vrna_pf(), vrna_plist_from_probs()
+ *
+ *  @param  store           The probability store opened for writing
+ *  @param  id              The ID of the sequence
+ *  @param  fc              The fold compound
+ *  @param  structure       The MFE structure (may be NULL)
+ *  @param  mfe             The MFE in kcal/mol
+ *  @param  ensemble_energy The ensemble free energy in kcal/mol
+ *  @param  cutoff          The probability cutoff for the pair list
+ *  @return                 Non-zero on success, 0 otherwise
+ */
+int
+vrna_prob_store_add_fc(vrna_prob_store_t    store,
+                       const char           *id,
+                       vrna_fold_compound_t *fc,
+                       const char           *structure,
+                       double               mfe,
+                       double               ensemble_energy,
+                       double               cutoff);
+
+
+/**
+ *  @brief  Collect the equilibrium probabilities of a fold compound in a new record
+ *
+ *  Same as vrna_prob_store_add_fc() but the record is returned instead of being added to
+ *  a store. All data is copied, such that the record remains valid after @p fc has been
+ *  freed. This allows for adding records in an order that differs from the order they
+ *  were computed in, e.g. the input order when processing several sequences in parallel.
+ *
+ *  @see  vrna_prob_store_add_fc(), vrna_prob_store_add(), vrna_prob_store_record_free()
+ *
+ *  @param  id              The ID of the sequence
+ *  @param  fc              The fold compound
+ *  @param  structure       The MFE structure (may be NULL)
+ *  @param  mfe             The MFE in kcal/mol
+ *  @param  ensemble_energy The ensemble free energy in kcal/mol
+ *  @param  cutoff          The probability cutoff for the pair list
+ *  @return                 The record, or NULL on error
+ */
+vrna_prob_store_record_t *
+vrna_prob_store_record_fc(const char            *id,
+                          vrna_fold_compound_t  *fc,
+                          const char            *structure,
+                          double                mfe,
+                          double                ensemble_energy,
+                          double                cutoff);
+
+
+/**
+ *  @brief  Free a record obtained from vrna_prob_store_record_fc()
+ *
+ *  @note   Records obtained from a store opened for reading must not be freed.
+ *
+ *  @param  record  The record to free
+ */
+void
+vrna_prob_store_record_free(vrna_prob_store_record_t *record);
+
+
+/**
+ *  @brief  Open an existing probability store for reading
+ *
+ *  @see  vrna_prob_store_get(), vrna_prob_store_get_nth(), vrna_prob_store_close()
+ *
+ *  @param  filename  The name of the file to open
+ *  @return           The store opened for reading, or NULL on error
+ */
+vrna_prob_store_t
+vrna_prob_store_open(const char *filename);
+
+
+/**
+ *  @brief  Close a probability store
+ *
+ *  For stores opened for writing, this also writes the ID index and finalizes the file.
+ *  If any record could not be written completely, the file is left unfinalized, such
+ *  that vrna_prob_store_open() rejects it, and 0 is returned. All records obtained from
+ *  a store opened for reading become invalid.
+ *
+ *  @see  vrna_prob_store_create(), vrna_prob_store_open()
+ *
+ *  @param  store   The probability store
+ *  @return         Non-zero on success, 0 otherwise
+ */
+int
+vrna_prob_store_close(vrna_prob_store_t store);
+
+
+/**
+ *  @brief  Get the number of records in a probability store
+ *
+ *  @param  store   The probability store
+ *  @return         The number of records
+ */
+unsigned int
+vrna_prob_store_size(vrna_prob_store_t store);
+
+
+/**
+ *  @brief  Look up a record of a probability store opened for reading by its ID
+ *
+ *  @see  vrna_prob_store_get_nth()
+ *
+ *  @param  store   The probability store
+ *  @param  id      The ID of the sequence
+ *  @param  record  A pointer to the record to fill
+ *  @return         Non-zero if the record exists, 0 otherwise
+ */
+int
+vrna_prob_store_get(vrna_prob_store_t         store,
+                    const char                *id,
+                    vrna_prob_store_record_t  *record);
+
+
+/**
+ *  @brief  Get the @p n-th record of a probability store opened for reading
+ *
+ *  Records are numbered from 0 in the order they were added to the store.
+ *
+ *  @see  vrna_prob_store_get(), vrna_prob_store_size()
+ *
+ *  @param  store   The probability store
+ *  @param  n       The number of the record
+ *  @param  record  A pointer to the record to fill
+ *  @return         Non-zero if the record exists, 0 otherwise
+ */
+int
+vrna_prob_store_get_nth(vrna_prob_store_t         store,
+                        unsigned int              n,
+                        vrna_prob_store_record_t  *record);
+
+
+/**
+ *  @}
+ */
+
+#endif
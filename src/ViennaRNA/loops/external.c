@@ -34,6 +34,7 @@
 
 #include "external_hc.inc"
 #include "external_sc.inc"
+#include "ali_rows.inc"
 
 #ifdef VRNA_WITH_SVM
 #include "ViennaRNA/zscore_dat.inc"
@@ -867,7 +868,7 @@ get_stem_contributions_d0(vrna_fold_compound_t      *fc,
 {
   char          *ptype;
   short         **S;
-  unsigned int  s, n_seq, type;
+  unsigned int  r, s, n_seq, type;
   int           i, ij, *indx, *c, *stems;
   vrna_param_t  *P;
   vrna_md_t     *md;
@@ -883,7 +884,7 @@ get_stem_contributions_d0(vrna_fold_compound_t      *fc,
   c     = fc->matrices->c;
   ij    = indx[j] + j - 1;
   ptype = (fc->type == VRNA_FC_TYPE_SINGLE) ? fc->ptype : NULL;
-  n_seq = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
+  n_seq = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq_unique;
   S     = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S;
 
   sc_spl_stem = sc_wrapper->decomp_stem5;
@@ -910,9 +911,10 @@ get_stem_contributions_d0(vrna_fold_compound_t      *fc,
             (evaluate(1, j, i - 1, i, VRNA_DECOMP_EXT_EXT_STEM, hc_dat_local))) {
           stems[i] = c[ij];
 
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < n_seq; r++) {
+            s = ali_row(fc, r);
             type      = vrna_get_ptype_md(S[s][i], S[s][j], md);
-            stems[i]  += vrna_E_ext_stem(type, -1, -1, P);
+            stems[i]  += ali_weight(fc, r, vrna_E_ext_stem(type, -1, -1, P));
           }
         }
       }
@@ -938,9 +940,10 @@ get_stem_contributions_d0(vrna_fold_compound_t      *fc,
         break;
 
       case VRNA_FC_TYPE_COMPARATIVE:
-        for (s = 0; s < n_seq; s++) {
+        for (r = 0; r < n_seq; r++) {
+          s = ali_row(fc, r);
           type      = vrna_get_ptype_md(S[s][1], S[s][j], md);
-          stems[1]  += vrna_E_ext_stem(type, -1, -1, P);
+          stems[1]  += ali_weight(fc, r, vrna_E_ext_stem(type, -1, -1, P));
         }
         break;
     }
@@ -962,7 +965,7 @@ f3_get_stem_contributions_d0(vrna_fold_compound_t       *fc,
 {
   char            **ptype;
   short           **S, *si;
-  unsigned int    s, n_seq, type, length;
+  unsigned int    r, s, n_seq, type, length;
   int             energy, j, max_j, *c, *stems, maxdist;
   vrna_param_t    *P;
   vrna_md_t       *md;
@@ -1051,9 +1054,10 @@ f3_get_stem_contributions_d0(vrna_fold_compound_t       *fc,
         if ((c[j] != INF) &&
             (evaluate(i, length, j, j + 1, VRNA_DECOMP_EXT_STEM_EXT, hc_dat_local))) {
           energy = c[j];
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < fc->n_seq_unique; r++) {
+            s = ali_row(fc, r);
             type    = vrna_get_ptype_md(si[s], S[s][j], md);
-            energy  += vrna_E_ext_stem(type, -1, -1, P);
+            energy  += ali_weight(fc, r, vrna_E_ext_stem(type, -1, -1, P));
           }
           stems[j] = energy;
         }
@@ -1083,9 +1087,10 @@ f3_get_stem_contributions_d0(vrna_fold_compound_t       *fc,
           break;
 
         case VRNA_FC_TYPE_COMPARATIVE:
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < fc->n_seq_unique; r++) {
+            s = ali_row(fc, r);
             type    = vrna_get_ptype_md(si[s], S[s][j], md);
-            energy  += vrna_E_ext_stem(type, -1, -1, P);
+            energy  += ali_weight(fc, r, vrna_E_ext_stem(type, -1, -1, P));
           }
 
           break;
@@ -1132,7 +1137,7 @@ get_stem_contributions_d2(vrna_fold_compound_t      *fc,
 {
   char          *ptype;
   short         *S, sj1, *si1, **SS, **S5, **S3, *s3j, *sj;
-  unsigned int  s, n_seq, **a2s, type, *sn;
+  unsigned int  r, s, n_seq, **a2s, type, *sn;
   int           n, i, ij, *indx, *c, *stems, mm5;
   vrna_param_t  *P;
   vrna_md_t     *md;
@@ -1209,10 +1214,11 @@ get_stem_contributions_d2(vrna_fold_compound_t      *fc,
         if ((c[ij] != INF) &&
             (evaluate(1, j, i - 1, i, VRNA_DECOMP_EXT_EXT_STEM, hc_dat_local))) {
           stems[i] = c[ij];
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < fc->n_seq_unique; r++) {
+            s = ali_row(fc, r);
             type      = vrna_get_ptype_md(SS[s][i], sj[s], md);
             mm5       = (a2s[s][i] > 1) ? S5[s][i] : -1;
-            stems[i]  += vrna_E_ext_stem(type, mm5, s3j[s], P);
+            stems[i]  += ali_weight(fc, r, vrna_E_ext_stem(type, mm5, s3j[s], P));
           }
         }
       }
@@ -1228,9 +1234,10 @@ get_stem_contributions_d2(vrna_fold_compound_t      *fc,
       if ((c[ij] != INF) && (evaluate(1, j, 1, j, VRNA_DECOMP_EXT_STEM, hc_dat_local))) {
         stems[1] = c[ij];
 
-        for (s = 0; s < n_seq; s++) {
+        for (r = 0; r < fc->n_seq_unique; r++) {
+          s = ali_row(fc, r);
           type      = vrna_get_ptype_md(SS[s][1], sj[s], md);
-          stems[1]  += vrna_E_ext_stem(type, -1, s3j[s], P);
+          stems[1]  += ali_weight(fc, r, vrna_E_ext_stem(type, -1, s3j[s], P));
         }
 
         if (sc_red_stem)
@@ -1256,7 +1263,7 @@ f3_get_stem_contributions_d2(vrna_fold_compound_t       *fc,
 {
   char            **ptype;
   short           **S, **S5, **S3, *S1, si1, sj1, *s5i1, *si;
-  unsigned int    s, n_seq, type, length, **a2s;
+  unsigned int    r, s, n_seq, type, length, **a2s;
   int             energy, j, max_j, *c, *stems, maxdist;
   vrna_param_t    *P;
   vrna_md_t       *md;
@@ -1386,10 +1393,11 @@ f3_get_stem_contributions_d2(vrna_fold_compound_t       *fc,
         if ((c[j] != INF) &&
             (evaluate(i, length, j, j + 1, VRNA_DECOMP_EXT_STEM_EXT, hc_dat_local))) {
           energy = c[j];
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < fc->n_seq_unique; r++) {
+            s = ali_row(fc, r);
             type    = vrna_get_ptype_md(si[s], S[s][j], md);
             sj1     = (a2s[s][j] < a2s[s][length]) ? S3[s][j] : -1;
-            energy  += vrna_E_ext_stem(type, s5i1[s], sj1, P);
+            energy  += ali_weight(fc, r, vrna_E_ext_stem(type, s5i1[s], sj1, P));
           }
           stems[j] = energy;
         }
@@ -1406,9 +1414,10 @@ f3_get_stem_contributions_d2(vrna_fold_compound_t       *fc,
 
         if ((c[j] != INF) && (evaluate(i, j, i, j, VRNA_DECOMP_EXT_STEM, hc_dat_local))) {
           energy = c[j];
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < fc->n_seq_unique; r++) {
+            s = ali_row(fc, r);
             type    = vrna_get_ptype_md(si[s], S[s][j], md);
-            energy  += vrna_E_ext_stem(type, s5i1[s], -1, P);
+            energy  += ali_weight(fc, r, vrna_E_ext_stem(type, s5i1[s], -1, P));
           }
 
           if (sc_red_stem)
@@ -1555,7 +1564,7 @@ f3_get_stem_contributions_d3(vrna_fold_compound_t       *fc,
 {
   char            **ptype;
   short           *S1, **S, **S3, sj1, *si;
-  unsigned int    s, n_seq, **a2s, type;
+  unsigned int    r, s, n_seq, **a2s, type;
   int             energy, j, max_j, *c, *stems, length, maxdist;
   vrna_param_t    *P;
   vrna_md_t       *md;
@@ -1678,10 +1687,11 @@ f3_get_stem_contributions_d3(vrna_fold_compound_t       *fc,
         if ((c[j - 1] != INF) &&
             (evaluate(i, length, j - 1, j + 1, VRNA_DECOMP_EXT_STEM_EXT, hc_dat_local))) {
           energy = c[j - 1];
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < fc->n_seq_unique; r++) {
+            s = ali_row(fc, r);
             type    = vrna_get_ptype_md(si[s], S[s][j - 1], md);
             sj1     = (a2s[s][j - 1] < a2s[s][length]) ? S3[s][j - 1] : -1;
-            energy  += vrna_E_ext_stem(type, -1, sj1, P);
+            energy  += ali_weight(fc, r, vrna_E_ext_stem(type, -1, sj1, P));
           }
           stems[j] = energy;
         }
@@ -1698,10 +1708,11 @@ f3_get_stem_contributions_d3(vrna_fold_compound_t       *fc,
         if ((c[j - 1] != INF) &&
             (evaluate(i, j, i, j - 1, VRNA_DECOMP_EXT_STEM, hc_dat_local))) {
           energy = c[j - 1];
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < fc->n_seq_unique; r++) {
+            s = ali_row(fc, r);
             type    = vrna_get_ptype_md(si[s], S[s][j - 1], md);
             sj1     = (a2s[s][j - 1] < a2s[s][length]) ? S3[s][j - 1] : -1;
-            energy  += vrna_E_ext_stem(type, -1, sj1, P);
+            energy  += ali_weight(fc, r, vrna_E_ext_stem(type, -1, sj1, P));
           }
 
           if (sc_red_stem)
@@ -1729,7 +1740,7 @@ f5_get_stem_contributions_d3(vrna_fold_compound_t       *fc,
 {
   char          *ptype;
   short         *S, sj1, **SS, **S3, *s3j1, *ssj1;
-  unsigned int  n, s, n_seq, **a2s, type;
+  unsigned int  n, r, s, n_seq, **a2s, type;
   int           i, ij, *indx, *c, *stems;
   vrna_param_t  *P;
   vrna_md_t     *md;
@@ -1808,9 +1819,10 @@ f5_get_stem_contributions_d3(vrna_fold_compound_t       *fc,
             (c[ij] != INF) &&
             (evaluate(1, j, i - 1, i, VRNA_DECOMP_EXT_EXT_STEM1, hc_dat_local))) {
           stems[i] = c[ij];
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < fc->n_seq_unique; r++) {
+            s = ali_row(fc, r);
             type      = vrna_get_ptype_md(SS[s][i], ssj1[s], md);
-            stems[i]  += vrna_E_ext_stem(type, -1, s3j1[s], P);
+            stems[i]  += ali_weight(fc, r, vrna_E_ext_stem(type, -1, s3j1[s], P));
           }
         }
       }
@@ -1828,9 +1840,10 @@ f5_get_stem_contributions_d3(vrna_fold_compound_t       *fc,
         if ((c[ij] != INF) && (evaluate(1, j, 1, j - 1, VRNA_DECOMP_EXT_STEM, hc_dat_local))) {
           stems[1] = c[ij];
 
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < fc->n_seq_unique; r++) {
+            s = ali_row(fc, r);
             type      = vrna_get_ptype_md(SS[s][1], ssj1[s], md);
-            stems[1]  += vrna_E_ext_stem(type, -1, s3j1[s], P);
+            stems[1]  += ali_weight(fc, r, vrna_E_ext_stem(type, -1, s3j1[s], P));
           }
 
           if (sc_red_stem)
@@ -1857,7 +1870,7 @@ f3_get_stem_contributions_d5(vrna_fold_compound_t       *fc,
 {
   char            **ptype;
   short           *S1, **S, **S5, *s5i1, si, *si1;
-  unsigned int    s, n_seq, **a2s, type;
+  unsigned int    r, s, n_seq, **a2s, type;
   int             energy, j, max_j, *c, *stems, length, maxdist;
   vrna_param_t    *P;
   vrna_md_t       *md;
@@ -1987,9 +2000,10 @@ f3_get_stem_contributions_d5(vrna_fold_compound_t       *fc,
         if ((c[j] != INF) &&
             (evaluate(i, length, j, j + 1, VRNA_DECOMP_EXT_STEM_EXT1, hc_dat_local))) {
           energy = c[j];
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < fc->n_seq_unique; r++) {
+            s = ali_row(fc, r);
             type    = vrna_get_ptype_md(si1[s], S[s][j], md);
-            energy  += vrna_E_ext_stem(type, s5i1[s], -1, P);
+            energy  += ali_weight(fc, r, vrna_E_ext_stem(type, s5i1[s], -1, P));
           }
           stems[j] = energy;
         }
@@ -2007,9 +2021,10 @@ f3_get_stem_contributions_d5(vrna_fold_compound_t       *fc,
         if ((c[j] != INF) &&
             (evaluate(i, j, i + 1, j, VRNA_DECOMP_EXT_STEM, hc_dat_local))) {
           energy = c[j];
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < fc->n_seq_unique; r++) {
+            s = ali_row(fc, r);
             type    = vrna_get_ptype_md(si1[s], S[s][j], md);
-            energy  += vrna_E_ext_stem(type, s5i1[s], -1, P);
+            energy  += ali_weight(fc, r, vrna_E_ext_stem(type, s5i1[s], -1, P));
           }
 
           if (sc_red_stem)
@@ -2038,7 +2053,7 @@ f5_get_stem_contributions_d53(vrna_fold_compound_t      *fc,
 {
   char          *ptype;
   short         *S, *si1, sj1, **SS, **S5, **S3, *s3j1, *ssj1;
-  unsigned int  n, s, n_seq, **a2s, type;
+  unsigned int  n, r, s, n_seq, **a2s, type;
   int           i, ij, *indx, *c, *stems;
   vrna_param_t  *P;
   vrna_md_t     *md;
@@ -2119,9 +2134,10 @@ f5_get_stem_contributions_d53(vrna_fold_compound_t      *fc,
             (c[ij] != INF) &&
             (evaluate(1, j, i - 1, i + 1, VRNA_DECOMP_EXT_EXT_STEM1, hc_dat_local))) {
           stems[i] = c[ij];
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < fc->n_seq_unique; r++) {
+            s = ali_row(fc, r);
             type      = vrna_get_ptype_md(SS[s][i + 1], ssj1[s], md);
-            stems[i]  += vrna_E_ext_stem(type, (a2s[s][i + 1] > 1) ? S5[s][i + 1] : -1, s3j1[s], P);
+            stems[i]  += ali_weight(fc, r, vrna_E_ext_stem(type, (a2s[s][i + 1] > 1) ? S5[s][i + 1] : -1, s3j1[s], P));
           }
         }
       }
@@ -2137,9 +2153,10 @@ f5_get_stem_contributions_d53(vrna_fold_compound_t      *fc,
 
         if ((c[ij] != INF) && (evaluate(1, j, 2, j - 1, VRNA_DECOMP_EXT_STEM, hc_dat_local))) {
           stems[1] = c[ij];
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < fc->n_seq_unique; r++) {
+            s = ali_row(fc, r);
             type      = vrna_get_ptype_md(SS[s][2], ssj1[s], md);
-            stems[1]  += vrna_E_ext_stem(type, (a2s[s][2] > 1) ? S5[s][2] : -1, s3j1[s], P);
+            stems[1]  += ali_weight(fc, r, vrna_E_ext_stem(type, (a2s[s][2] > 1) ? S5[s][2] : -1, s3j1[s], P));
           }
 
           if (sc_red_stem)
@@ -2166,7 +2183,7 @@ f3_get_stem_contributions_d53(vrna_fold_compound_t      *fc,
 {
   char            **ptype;
   short           *S1, **S, **S5, **S3, *s5i1, si1, sj1, *ssi1;
-  unsigned int    s, n_seq, **a2s, type;
+  unsigned int    r, s, n_seq, **a2s, type;
   int             energy, j, max_j, *c, *stems, length, maxdist;
   vrna_param_t    *P;
   vrna_md_t       *md;
@@ -2294,10 +2311,11 @@ f3_get_stem_contributions_d53(vrna_fold_compound_t      *fc,
         if ((c[j - 1] != INF) &&
             (evaluate(i, length, j - 1, j + 1, VRNA_DECOMP_EXT_STEM_EXT1, hc_dat_local))) {
           energy = c[j - 1];
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < fc->n_seq_unique; r++) {
+            s = ali_row(fc, r);
             type    = vrna_get_ptype_md(ssi1[s], S[s][j - 1], md);
             sj1     = (a2s[s][j - 1] < a2s[s][length]) ? S3[s][j - 1] : -1;
-            energy  += vrna_E_ext_stem(type, s5i1[s], sj1, P);
+            energy  += ali_weight(fc, r, vrna_E_ext_stem(type, s5i1[s], sj1, P));
           }
           stems[j] = energy;
         }
@@ -2313,10 +2331,11 @@ f3_get_stem_contributions_d53(vrna_fold_compound_t      *fc,
         if ((c[j - 1] != INF) &&
             (evaluate(i, length, i + 1, j - 1, VRNA_DECOMP_EXT_STEM, hc_dat_local))) {
           energy = c[j - 1];
-          for (s = 0; s < n_seq; s++) {
+          for (r = 0; r < fc->n_seq_unique; r++) {
+            s = ali_row(fc, r);
             type    = vrna_get_ptype_md(ssi1[s], S[s][j - 1], md);
             sj1     = (a2s[s][j - 1] < a2s[s][length]) ? S3[s][j - 1] : -1;
-            energy  += vrna_E_ext_stem(type, s5i1[s], sj1, P);
+            energy  += ali_weight(fc, r, vrna_E_ext_stem(type, s5i1[s], sj1, P));
           }
 
           if (sc_red_stem)
@@ -165,6 +165,33 @@ vrna_exp_E_ext_fast_update(vrna_fold_compound_t *fc,
                            vrna_mx_pf_aux_el_t  aux_mx);
 
 
+/**
+ *  @brief  Update the auxiliary arrays for exterior loops with segments that are not re-computed
+ *
+ *  The fast exterior loop recursions keep the partition functions of all segments
+ *  @f$ [k, j] @f$ that end at the current position @f$ j @f$ in @p aux_mx. Whenever
+ *  the segments @f$ [k, j] @f$ with @f$ i \leq k < j @f$ are skipped in a column, e.g.
+ *  because they are not affected by a local change of constraints as in vrna_pf_update(),
+ *  this function must be called for that range before any further segment of column
+ *  @f$ j @f$ is evaluated with vrna_exp_E_ext_fast(). It takes the values from the
+ *  (unchanged) partition function matrices of @p fc and processes the segments in the
+ *  same order as the full recursions.
+ *  Nothing is done if @p fc or @p aux_mx is \c NULL.
+ *
+ *  @see vrna_exp_E_ext_fast(), vrna_exp_E_ml_fast_aux_update(), vrna_pf_update()
+ *
+ *  @param  fc      The fold compound with filled partition function matrices for the skipped segments
+ *  @param  i       The 5' most position of the skipped segments
+ *  @param  j       The 3' end of the skipped segments
+ *  @param  aux_mx  The auxiliary arrays for fast exterior loop computations
+ */
+void
+vrna_exp_E_ext_fast_aux_update(vrna_fold_compound_t  *fc,
+                               int                   i,
+                               int                   j,
+                               vrna_mx_pf_aux_el_t   aux_mx);
+
+
 /* End partition function interface */
 /**@}*/
 
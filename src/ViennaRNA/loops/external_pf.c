@@ -30,6 +30,7 @@
 
 #include "external_hc.inc"
 #include "external_sc_pf.inc"
+#include "ali_rows.inc"
 
 struct vrna_mx_pf_aux_el_s {
   FLT_OR_DBL  *qq;
@@ -85,6 +86,16 @@ split_ext_fast(vrna_fold_compound_t       *fc,
                struct sc_ext_exp_dat      *sc_wrapper);
 
 
+PRIVATE INLINE void
+update_qq(vrna_fold_compound_t        *fc,
+          int                         i,
+          int                         j,
+          struct vrna_mx_pf_aux_el_s  *aux_mx,
+          vrna_callback_hc_evaluate   *evaluate,
+          struct hc_ext_def_dat       *hc_dat_local,
+          struct sc_ext_exp_dat       *sc_wrapper);
+
+
 PRIVATE FLT_OR_DBL
 exp_E_ext_fast(vrna_fold_compound_t       *fc,
                int                        i,
@@ -284,6 +295,34 @@ vrna_exp_E_ext_fast(vrna_fold_compound_t        *fc,
 }
 
 
+PUBLIC void
+vrna_exp_E_ext_fast_aux_update(vrna_fold_compound_t       *fc,
+                               int                        i,
+                               int                        j,
+                               struct vrna_mx_pf_aux_el_s *aux_mx)
+{
+  int                       k;
+  vrna_callback_hc_evaluate *evaluate;
+  struct hc_ext_def_dat     hc_dat_local;
+  struct sc_ext_exp_dat     sc_wrapper;
+
+  if ((fc) && (aux_mx)) {
+    if (fc->hc->type == VRNA_HC_WINDOW)
+      evaluate = prepare_hc_ext_def_window(fc, &hc_dat_local);
+    else
+      evaluate = prepare_hc_ext_def(fc, &hc_dat_local);
+
+    init_sc_ext_exp(fc, &sc_wrapper);
+
+    /* segments [k, j] are processed in the same order as in the full recursions */
+    for (k = j - 1; k >= i; k--)
+      update_qq(fc, k, j, aux_mx, evaluate, &hc_dat_local, &sc_wrapper);
+
+    free_sc_ext_exp(&sc_wrapper);
+  }
+}
+
+
 PUBLIC void
 vrna_exp_E_ext_fast_update(vrna_fold_compound_t       *fc,
                            int                        j,
@@ -380,7 +419,7 @@ reduce_ext_stem_fast(vrna_fold_compound_t       *fc,
                      struct sc_ext_exp_dat      *sc_wrapper)
 {
   short             **S, **S5, **S3, *S1, *S2, s5, s3;
-  unsigned int      type, *sn, n, s, n_seq, **a2s;
+  unsigned int      type, *sn, n, r, s, n_seq, **a2s;
   int               *idx, circular;
   FLT_OR_DBL        qbt, q_temp, qb;
   vrna_exp_param_t  *pf_params;
@@ -414,17 +453,18 @@ reduce_ext_stem_fast(vrna_fold_compound_t       *fc,
         break;
 
       case VRNA_FC_TYPE_COMPARATIVE:
-        n_seq = fc->n_seq;
+        n_seq = fc->n_seq_unique;
         S     = fc->S;
         S5    = fc->S5;
         S3    = fc->S3;
         a2s   = fc->a2s;
-        for (s = 0; s < n_seq; s++) {
+        for (r = 0; r < n_seq; r++) {
+          s = ali_row(fc, r);
           type    = vrna_get_ptype_md(S[s][i], S[s][j], md);
-          q_temp  *= vrna_exp_E_ext_stem(type,
-                                         ((a2s[s][i] > 1) || circular) ? S5[s][i] : -1,
-                                         ((a2s[s][j] < a2s[s][n]) || circular) ? S3[s][j] : -1,
-                                         pf_params);
+          q_temp  *= exp_ali_weight(fc, r, vrna_exp_E_ext_stem(type,
+                                                               ((a2s[s][i] > 1) || circular) ? S5[s][i] : -1,
+                                                               ((a2s[s][j] < a2s[s][n]) || circular) ? S3[s][j] : -1,
+                                                               pf_params));
         }
         break;
     }
@@ -579,42 +619,33 @@ split_ext_fast(vrna_fold_compound_t       *fc,
 }
 
 
-PRIVATE FLT_OR_DBL
-exp_E_ext_fast(vrna_fold_compound_t       *fc,
-               int                        i,
-               int                        j,
-               struct vrna_mx_pf_aux_el_s *aux_mx)
+PRIVATE INLINE void
+update_qq(vrna_fold_compound_t        *fc,
+          int                         i,
+          int                         j,
+          struct vrna_mx_pf_aux_el_s  *aux_mx,
+          vrna_callback_hc_evaluate   *evaluate,
+          struct hc_ext_def_dat       *hc_dat_local,
+          struct sc_ext_exp_dat       *sc_wrapper)
 {
-  int                       *iidx, ij, with_ud, with_gquad;
-  FLT_OR_DBL                qbt1, *qq, **qqu, *G, **G_local;
-  vrna_md_t                 *md;
-  vrna_exp_param_t          *pf_params;
-  vrna_ud_t                 *domains_up;
-  vrna_callback_hc_evaluate *evaluate;
-  struct hc_ext_def_dat     hc_dat_local;
-  struct sc_ext_exp_dat     sc_wrapper;
+  int         *iidx, ij, with_ud, with_gquad;
+  FLT_OR_DBL  qbt1, *qq, **qqu, *G, **G_local;
+  vrna_md_t   *md;
+  vrna_ud_t   *domains_up;
 
   qq          = aux_mx->qq;
   qqu         = aux_mx->qqu;
-  pf_params   = fc->exp_params;
-  md          = &(pf_params->model_details);
+  md          = &(fc->exp_params->model_details);
   domains_up  = fc->domains_up;
   with_gquad  = md->gquad;
   with_ud     = (domains_up && domains_up->exp_energy_cb);
 
-  if (fc->hc->type == VRNA_HC_WINDOW)
-    evaluate = prepare_hc_ext_def_window(fc, &hc_dat_local);
-  else
-    evaluate = prepare_hc_ext_def(fc, &hc_dat_local);
-
-  init_sc_ext_exp(fc, &sc_wrapper);
-
   qbt1 = 0.;
 
   /* all exterior loop parts [i, j] with exactly one stem (i, u) i < u < j */
-  qbt1 += reduce_ext_ext_fast(fc, i, j, aux_mx, evaluate, &hc_dat_local, &sc_wrapper);
+  qbt1 += reduce_ext_ext_fast(fc, i, j, aux_mx, evaluate, hc_dat_local, sc_wrapper);
   /* exterior loop part with stem (i, j) */
-  qbt1 += reduce_ext_stem_fast(fc, i, j, aux_mx, evaluate, &hc_dat_local, &sc_wrapper);
+  qbt1 += reduce_ext_stem_fast(fc, i, j, aux_mx, evaluate, hc_dat_local, sc_wrapper);
 
   if (with_gquad) {
     if (fc->hc->type == VRNA_HC_WINDOW) {
@@ -632,6 +663,30 @@ exp_E_ext_fast(vrna_fold_compound_t       *fc,
 
   if (with_ud)
     qqu[0][i] = qbt1;
+}
+
+
+PRIVATE FLT_OR_DBL
+exp_E_ext_fast(vrna_fold_compound_t       *fc,
+               int                        i,
+               int                        j,
+               struct vrna_mx_pf_aux_el_s *aux_mx)
+{
+  FLT_OR_DBL                qbt1;
+  vrna_callback_hc_evaluate *evaluate;
+  struct hc_ext_def_dat     hc_dat_local;
+  struct sc_ext_exp_dat     sc_wrapper;
+
+  if (fc->hc->type == VRNA_HC_WINDOW)
+    evaluate = prepare_hc_ext_def_window(fc, &hc_dat_local);
+  else
+    evaluate = prepare_hc_ext_def(fc, &hc_dat_local);
+
+  init_sc_ext_exp(fc, &sc_wrapper);
+
+  update_qq(fc, i, j, aux_mx, evaluate, &hc_dat_local, &sc_wrapper);
+
+  qbt1 = aux_mx->qq[i];
 
   /* the entire stretch [i,j] is unpaired */
   qbt1 += reduce_ext_up_fast(fc, i, j, aux_mx, evaluate, &hc_dat_local, &sc_wrapper);
@@ -29,6 +29,7 @@
 
 #include "hairpin_hc.inc"
 #include "hairpin_sc.inc"
+#include "ali_rows.inc"
 
 /*
  #################################
@@ -101,15 +102,17 @@ vrna_eval_ext_hp_loop(vrna_fold_compound_t  *fc,
                       int                   i,
                       int                   j)
 {
-  char              **Ss, loopseq[10] = {
+  char                **Ss, loopseq[10] = {
     0
   };
-  unsigned int      **a2s;
-  short             *S, *S2, **SS, **S5, **S3;
-  int               u1, u2, e, s, type, n_seq, length, noGUclosure;
-  vrna_param_t      *P;
-  vrna_md_t         *md;
-  struct sc_hp_dat  sc_wrapper;
+  unsigned int        r, s, n_seq;
+  short               *S, *S2;
+  const short         *Si, *Sj, *S5i, *S3j;
+  const unsigned int  *Ai, *Aj, *An;
+  int                 u1, u2, e, type, length, noGUclosure;
+  vrna_param_t        *P;
+  vrna_md_t           *md;
+  struct sc_hp_dat    sc_wrapper;
 
   length      = fc->length;
   P           = fc->params;
@@ -148,31 +151,37 @@ vrna_eval_ext_hp_loop(vrna_fold_compound_t  *fc,
 
     /* sequence alignments */
     case  VRNA_FC_TYPE_COMPARATIVE:
-      SS    = fc->S;
-      S5    = fc->S5;   /* S5[s][i] holds next base 5' of i in sequence s */
-      S3    = fc->S3;   /* Sl[s][i] holds next base 3' of i in sequence s */
       Ss    = fc->Ss;
-      a2s   = fc->a2s;
-      n_seq = fc->n_seq;
+      n_seq = fc->n_seq_unique;
+      Si    = fc->S_cm + (size_t)n_seq * i;
+      Sj    = fc->S_cm + (size_t)n_seq * j;
+      S5i   = fc->S5_cm + (size_t)n_seq * i;
+      S3j   = fc->S3_cm + (size_t)n_seq * j;
+      Ai    = fc->a2s_cm + (size_t)n_seq * (i - 1);
+      Aj    = fc->a2s_cm + (size_t)n_seq * j;
+      An    = fc->a2s_cm + (size_t)n_seq * length;
       e     = 0;
 
-      for (s = 0; s < n_seq; s++) {
-        u1  = a2s[s][length] - a2s[s][j];
-        u2  = a2s[s][i - 1];
+      for (r = 0; r < n_seq; r++) {
+        u1  = An[r] - Aj[r];
+        u2  = Ai[r];
+
+        if ((u1 + u2) < 3) {
+          e += ali_weight(fc, r, 600);
+          continue;
+        }
+
         memset(loopseq, '\0', sizeof(loopseq));
 
         if ((u1 + u2) < 7) {
-          memcpy(loopseq, Ss[s] + a2s[s][j] - 1, sizeof(char) * (u1 + 1));
+          s = ali_row(fc, r);
+          memcpy(loopseq, Ss[s] + Aj[r] - 1, sizeof(char) * (u1 + 1));
           memcpy(loopseq + u1 + 1, Ss[s], sizeof(char) * (u2 + 1));
           loopseq[u1 + u2 + 2] = '\0';
         }
 
-        if ((u1 + u2) < 3) {
-          e += 600;
-        } else {
-          type  = vrna_get_ptype_md(SS[s][j], SS[s][i], md);
-          e     += E_Hairpin(u1 + u2, type, S3[s][j], S5[s][i], loopseq, P);
-        }
+        type  = ptype_ali(md, Sj[r], Si[r]);
+        e     += ali_weight(fc, r, E_Hairpin(u1 + u2, type, S3j[r], S5i[r], loopseq, P));
       }
 
       break;
@@ -210,14 +219,16 @@ vrna_eval_hp_loop(vrna_fold_compound_t  *fc,
                   int                   i,
                   int                   j)
 {
-  char              **Ss;
-  unsigned int      **a2s;
-  short             *S, *S2, **SS, **S5, **S3;
-  int               u, e, s, type, n_seq, en, noGUclosure;
-  vrna_param_t      *P;
-  vrna_md_t         *md;
-  vrna_ud_t         *domains_up;
-  struct sc_hp_dat  sc_wrapper;
+  char                **Ss;
+  unsigned int        r, n_seq;
+  short               *S, *S2;
+  const short         *Si, *Sj, *S3i, *S5j;
+  const unsigned int  *Ai, *Ai1, *Aj;
+  int                 u, e, type, en, noGUclosure;
+  vrna_param_t        *P;
+  vrna_md_t           *md;
+  vrna_ud_t           *domains_up;
+  struct sc_hp_dat    sc_wrapper;
 
   P           = fc->params;
   md          = &(P->model_details);
@@ -250,20 +261,23 @@ vrna_eval_hp_loop(vrna_fold_compound_t  *fc,
 
     /* sequence alignments */
     case  VRNA_FC_TYPE_COMPARATIVE:
-      SS    = fc->S;
-      S5    = fc->S5;   /* S5[s][i] holds next base 5' of i in sequence s */
-      S3    = fc->S3;   /* Sl[s][i] holds next base 3' of i in sequence s */
       Ss    = fc->Ss;
-      a2s   = fc->a2s;
-      n_seq = fc->n_seq;
-
-      for (e = s = 0; s < n_seq; s++) {
-        u = a2s[s][j - 1] - a2s[s][i];
+      n_seq = fc->n_seq_unique;
+      Si    = fc->S_cm + (size_t)n_seq * i;
+      Sj    = fc->S_cm + (size_t)n_seq * j;
+      S3i   = fc->S3_cm + (size_t)n_seq * i;
+      S5j   = fc->S5_cm + (size_t)n_seq * j;
+      Ai1   = fc->a2s_cm + (size_t)n_seq * (i - 1);
+      Ai    = fc->a2s_cm + (size_t)n_seq * i;
+      Aj    = fc->a2s_cm + (size_t)n_seq * (j - 1);
+
+      for (e = r = 0; r < n_seq; r++) {
+        u = Aj[r] - Ai[r];
         if (u < 3) {
-          e += 600;                          /* ??? really 600 ??? */
+          e += ali_weight(fc, r, 600);       /* ??? really 600 ??? */
         } else {
-          type  = vrna_get_ptype_md(SS[s][i], SS[s][j], md);
-          e     += E_Hairpin(u, type, S3[s][i], S5[s][j], Ss[s] + (a2s[s][i - 1]), P);
+          type  = ptype_ali(md, Si[r], Sj[r]);
+          e     += ali_weight(fc, r, E_Hairpin(u, type, S3i[r], S5j[r], Ss[ali_row(fc, r)] + Ai1[r], P));
         }
       }
 
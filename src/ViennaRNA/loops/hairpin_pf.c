@@ -29,6 +29,7 @@
 
 #include "hairpin_hc.inc"
 #include "hairpin_sc_pf.inc"
+#include "ali_rows.inc"
 
 /*
  #################################
@@ -91,10 +92,12 @@ exp_eval_hp_loop(vrna_fold_compound_t *fc,
                  int                  j)
 {
   char                  **Ss;
-  unsigned int          **a2s;
-  short                 *S, *S2, **SS, **S5, **S3;
+  unsigned int          r, n_seq;
+  short                 *S, *S2;
+  const short           *Si, *Sj, *S3i, *S5j;
+  const unsigned int    *Ai, *Aj;
   unsigned int          *sn;
-  int                   u, type, n_seq, s;
+  int                   u, type;
   FLT_OR_DBL            q, qbt1, *scale;
   vrna_exp_param_t      *P;
   vrna_md_t             *md;
@@ -133,21 +136,25 @@ exp_eval_hp_loop(vrna_fold_compound_t *fc,
       break;
 
     case VRNA_FC_TYPE_COMPARATIVE:
-      SS    = fc->S;
-      S5    = fc->S5;   /* S5[s][i] holds next base 5' of i in sequence s */
-      S3    = fc->S3;   /* Sl[s][i] holds next base 3' of i in sequence s */
       Ss    = fc->Ss;
-      a2s   = fc->a2s;
-      n_seq = fc->n_seq;
+      n_seq = fc->n_seq_unique;
+      Si    = fc->S_cm + (size_t)n_seq * i;
+      Sj    = fc->S_cm + (size_t)n_seq * j;
+      S3i   = fc->S3_cm + (size_t)n_seq * i;
+      S5j   = fc->S5_cm + (size_t)n_seq * j;
+      Ai    = fc->a2s_cm + (size_t)n_seq * i;
+      Aj    = fc->a2s_cm + (size_t)n_seq * (j - 1);
       qbt1  = 1.;
 
-      for (s = 0; s < n_seq; s++) {
-        u = a2s[s][j - 1] - a2s[s][i];
-        if (a2s[s][i] < 1)
+      for (r = 0; r < n_seq; r++) {
+        u = Aj[r] - Ai[r];
+        if (Ai[r] < 1)
           continue;
 
-        type  = vrna_get_ptype_md(SS[s][i], SS[s][j], md);
-        qbt1  *= exp_E_Hairpin(u, type, S3[s][i], S5[s][j], Ss[s] + a2s[s][i] - 1, P);
+        type  = ptype_ali(md, Si[r], Sj[r]);
+        qbt1  *= exp_ali_weight(fc,
+                                r,
+                                exp_E_Hairpin(u, type, S3i[r], S5j[r], Ss[ali_row(fc, r)] + Ai[r] - 1, P));
       }
 
       q = qbt1;
@@ -185,9 +192,11 @@ exp_eval_ext_hp_loop(vrna_fold_compound_t *fc,
   char                  **Ss, *sequence, loopseq[10] = {
     0
   };
-  unsigned int          **a2s;
-  short                 *S, *S2, **SS, **S5, **S3;
-  int                   u1, u2, n, type, n_seq, s, noGUclosure;
+  unsigned int          r, s, n_seq;
+  short                 *S, *S2;
+  const short           *Si, *Sj, *S5i, *S3j;
+  const unsigned int    *Ai, *Aj, *An;
+  int                   u1, u2, n, type, noGUclosure;
   FLT_OR_DBL            q, qbt1, *scale;
   vrna_exp_param_t      *P;
   vrna_md_t             *md;
@@ -232,27 +241,33 @@ exp_eval_ext_hp_loop(vrna_fold_compound_t *fc,
       break;
 
     case VRNA_FC_TYPE_COMPARATIVE:
-      SS    = fc->S;
-      S5    = fc->S5;   /* S5[s][i] holds next base 5' of i in sequence s */
-      S3    = fc->S3;   /* Sl[s][i] holds next base 3' of i in sequence s */
       Ss    = fc->Ss;
-      a2s   = fc->a2s;
-      n_seq = fc->n_seq;
+      n_seq = fc->n_seq_unique;
+      Si    = fc->S_cm + (size_t)n_seq * i;
+      Sj    = fc->S_cm + (size_t)n_seq * j;
+      S5i   = fc->S5_cm + (size_t)n_seq * i;
+      S3j   = fc->S3_cm + (size_t)n_seq * j;
+      Ai    = fc->a2s_cm + (size_t)n_seq * (i - 1);
+      Aj    = fc->a2s_cm + (size_t)n_seq * j;
+      An    = fc->a2s_cm + (size_t)n_seq * n;
       qbt1  = 1.;
 
-      for (s = 0; s < n_seq; s++) {
-        const int u1_local  = a2s[s][n] - a2s[s][j];
-        const int u2_local  = a2s[s][i - 1];
+      for (r = 0; r < n_seq; r++) {
+        s = ali_row(fc, r);
+        const int u1_local  = An[r] - Aj[r];
+        const int u2_local  = Ai[r];
         memset(loopseq, '\0', sizeof(loopseq));
 
         if ((u1_local + u2_local) < 7) {
-          memcpy(loopseq, Ss[s] + a2s[s][j] - 1, sizeof(char) * (u1_local + 1));
+          memcpy(loopseq, Ss[s] + Aj[r] - 1, sizeof(char) * (u1_local + 1));
           memcpy(loopseq + u1_local + 1, Ss[s], sizeof(char) * (u2_local + 1));
           loopseq[u1_local + u2_local + 2] = '\0';
         }
 
-        type  = vrna_get_ptype_md(SS[s][j], SS[s][i], md);
-        qbt1  *= exp_E_Hairpin(u1_local + u2_local, type, S3[s][j], S5[s][i], loopseq, P);
+        type  = ptype_ali(md, Sj[r], Si[r]);
+        qbt1  *= exp_ali_weight(fc,
+                                r,
+                                exp_E_Hairpin(u1_local + u2_local, type, S3j[r], S5i[r], loopseq, P));
       }
 
       q = qbt1;
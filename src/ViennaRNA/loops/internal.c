@@ -27,6 +27,8 @@
 
 #include "internal_hc.inc"
 #include "internal_sc.inc"
+#include "ali_rows.inc"
+#include "internal_ali.inc"
 
 /*
  #################################
@@ -40,6 +42,18 @@ E_internal_loop(vrna_fold_compound_t  *fc,
                 int                   j);
 
 
+PRIVATE int
+E_internal_loop_default(vrna_fold_compound_t  *fc,
+                        int                   i,
+                        int                   j);
+
+
+PRIVATE int
+E_internal_loop_plain(vrna_fold_compound_t  *fc,
+                      int                   i,
+                      int                   j);
+
+
 PRIVATE int
 E_ext_internal_loop(vrna_fold_compound_t  *fc,
                     int                   i,
@@ -147,24 +161,19 @@ eval_int_loop(vrna_fold_compound_t  *fc,
               int                   k,
               int                   l)
 {
-  unsigned int      *sn, n_seq, s, **a2s;
+  unsigned int      *sn;
   int               e, type, type2, with_ud;
-  short             *S, *S2, **SS, **S5, **S3;
+  short             *S, *S2;
   vrna_param_t      *P;
   vrna_md_t         *md;
   vrna_ud_t         *domains_up;
   struct sc_int_dat sc_wrapper;
 
-  n_seq       = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
   P           = fc->params;
   md          = &(P->model_details);
   sn          = fc->strand_number;
   S           = (fc->type == VRNA_FC_TYPE_SINGLE) ? fc->sequence_encoding : NULL;
   S2          = (fc->type == VRNA_FC_TYPE_SINGLE) ? fc->sequence_encoding2 : NULL;
-  SS          = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S;
-  S5          = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S5;
-  S3          = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S3;
-  a2s         = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->a2s;
   domains_up  = fc->domains_up;
   with_ud     = ((domains_up) && (domains_up->energy_cb)) ? 1 : 0;
   e           = INF;
@@ -209,13 +218,7 @@ eval_int_loop(vrna_fold_compound_t  *fc,
         break;
 
       case VRNA_FC_TYPE_COMPARATIVE:
-        for (s = 0; s < n_seq; s++) {
-          type    = vrna_get_ptype_md(SS[s][i], SS[s][j], md);
-          type2   = vrna_get_ptype_md(SS[s][l], SS[s][k], md);
-          u1      = a2s[s][k - 1] - a2s[s][i];
-          u2      = a2s[s][j - 1] - a2s[s][l];
-          energy  += E_IntLoop(u1, u2, type, type2, S3[s][i], S5[s][j], S5[s][k], S3[s][l], P);
-        }
+        energy = E_IntLoop_ali(fc, P, NULL, i, j, k, l);
 
         break;
     }
@@ -265,24 +268,19 @@ eval_ext_int_loop(vrna_fold_compound_t  *fc,
                   int                   k,
                   int                   l)
 {
-  unsigned int      n, n_seq, s, **a2s;
+  unsigned int      n;
   int               e, type, type2, with_ud;
-  short             *S, *S2, **SS, **S5, **S3;
+  short             *S, *S2;
   vrna_param_t      *P;
   vrna_md_t         *md;
   vrna_ud_t         *domains_up;
   struct sc_int_dat sc_wrapper;
 
   n           = fc->length;
-  n_seq       = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
   P           = fc->params;
   md          = &(P->model_details);
   S           = (fc->type == VRNA_FC_TYPE_SINGLE) ? fc->sequence_encoding : NULL;
   S2          = (fc->type == VRNA_FC_TYPE_SINGLE) ? fc->sequence_encoding2 : NULL;
-  SS          = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S;
-  S5          = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S5;
-  S3          = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S3;
-  a2s         = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->a2s;
   domains_up  = fc->domains_up;
   with_ud     = ((domains_up) && (domains_up->energy_cb)) ? 1 : 0;
   e           = INF;
@@ -309,14 +307,7 @@ eval_ext_int_loop(vrna_fold_compound_t  *fc,
         break;
 
       case VRNA_FC_TYPE_COMPARATIVE:
-        for (s = 0; s < n_seq; s++) {
-          type    = vrna_get_ptype_md(SS[s][j], SS[s][i], md);
-          type2   = vrna_get_ptype_md(SS[s][l], SS[s][k], md);
-          u1      = a2s[s][i - 1];
-          u2      = a2s[s][k - 1] - a2s[s][j];
-          u3      = a2s[s][n] - a2s[s][l];
-          energy  += E_IntLoop(u2, u1 + u3, type, type2, S3[s][j], S5[s][i], S5[s][k], S3[s][l], P);
-        }
+        energy = E_ExtIntLoop_ali(fc, P, NULL, i, j, k, l);
 
         break;
     }
@@ -365,472 +356,25 @@ E_internal_loop(vrna_fold_compound_t  *fc,
                 int                   i,
                 int                   j)
 {
-  unsigned char         sliding_window, hc_decompose, *hc_mx, **hc_mx_local;
-  char                  *ptype, **ptype_local;
-  short                 *S, **SS, **S5, **S3;
-  unsigned int          *sn, **a2s, n_seq, s, n;
-  int                   e, eee, *idx, ij, *c, *ggg, *rtype, with_ud, with_gquad, noclose,
-                        *hc_up, **c_local, **ggg_local;
-  vrna_param_t          *P;
-  vrna_md_t             *md;
-  vrna_ud_t             *domains_up;
-  struct hc_int_def_dat hc_dat_local;
-  eval_hc               *evaluate;
-  struct sc_int_dat     sc_wrapper;
-
-  evaluate = prepare_hc_int_def(fc, &hc_dat_local);
-  init_sc_int(fc, &sc_wrapper);
-
-  e = INF;
-
-  n               = fc->length;
-  sliding_window  = (fc->hc->type == VRNA_HC_WINDOW) ? 1 : 0;
-  sn              = fc->strand_number;
-  n_seq           = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
-  idx             = fc->jindx;
-  ij              = (sliding_window) ? 0 : idx[j] + i;
-  hc_mx           = (sliding_window) ? NULL : fc->hc->mx;
-  hc_mx_local     = (sliding_window) ? fc->hc->matrix_local : NULL;
-  hc_up           = fc->hc->up_int;
-  ptype           = (fc->type == VRNA_FC_TYPE_SINGLE) ? (sliding_window ? NULL : fc->ptype) : NULL;
-  ptype_local     =
-    (fc->type == VRNA_FC_TYPE_SINGLE) ? (sliding_window ? fc->ptype_local : NULL) : NULL;
-  S           = (fc->type == VRNA_FC_TYPE_SINGLE) ? fc->sequence_encoding : NULL;
-  SS          = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S;
-  S5          = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S5;
-  S3          = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S3;
-  a2s         = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->a2s;
-  c           = (sliding_window) ? NULL : fc->matrices->c;
-  ggg         = (sliding_window) ? NULL : fc->matrices->ggg;
-  c_local     = (sliding_window) ? fc->matrices->c_local : NULL;
-  ggg_local   = (sliding_window) ? fc->matrices->ggg_local : NULL;
-  P           = fc->params;
-  md          = &(P->model_details);
-  rtype       = &(md->rtype[0]);
-  domains_up  = fc->domains_up;
-  with_ud     = ((domains_up) && (domains_up->energy_cb)) ? 1 : 0;
-  with_gquad  = md->gquad;
-
-  hc_decompose = (sliding_window) ? hc_mx_local[i][j - i] : hc_mx[n * i + j];
-
-  if (hc_decompose & VRNA_CONSTRAINT_CONTEXT_INT_LOOP) {
-    unsigned int  type, type2, has_nick, *tt;
-    int           k, l, kl, last_k, first_l, u1, u2, noGUclosure;
-
-    has_nick    = sn[i] != sn[j] ? 1 : 0;
-    noGUclosure = md->noGUclosure;
-    tt          = NULL;
-    type        = 0;
-
-    if (fc->type == VRNA_FC_TYPE_SINGLE)
-      type = sliding_window ?
-             vrna_get_ptype_window(i, j, ptype_local) :
-             vrna_get_ptype(ij, ptype);
-
-    noclose = ((noGUclosure) && (type == 3 || type == 4)) ? 1 : 0;
-
-    if (fc->type == VRNA_FC_TYPE_COMPARATIVE) {
-      tt = (unsigned int *)vrna_alloc(sizeof(unsigned int) * n_seq);
-      for (s = 0; s < n_seq; s++)
-        tt[s] = vrna_get_ptype_md(SS[s][i], SS[s][j], md);
-    }
-
-    /* handle stacks separately */
-    k = i + 1;
-    l = j - 1;
-    if (k < l) {
-      kl            = (sliding_window) ? 0 : idx[l] + k;
-      hc_decompose  = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[n * k + l];
-
-      if ((hc_decompose & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
-          (evaluate(i, j, k, l, &hc_dat_local))) {
-        eee = (sliding_window) ? c_local[k][l - k] : c[kl];
-
-        if (eee != INF) {
-          switch (fc->type) {
-            case VRNA_FC_TYPE_SINGLE:
-              type2 = sliding_window ?
-                      rtype[vrna_get_ptype_window(k, l, ptype_local)] :
-                      rtype[vrna_get_ptype(kl, ptype)];
-
-              if ((has_nick) && ((sn[i] != sn[i + 1]) || (sn[j - 1] != sn[j]))) {
-#if 0
-                /* interior loop like cofold structure */
-                short Si, Sj;
-                Si  = (sn[i + 1] == sn[i]) ? S[i + 1] : -1;
-                Sj  = (sn[j] == sn[j - 1]) ? S[j - 1] : -1;
-                eee += E_IntLoop_Co(rtype[type], rtype[type2],
-                                    i, j, k, l,
-                                    ss[fc->strand_order[1]], /* serves as cutpoint replacement */
-                                    Si, Sj,
-                                    S[i], S[j],
-                                    md->dangles,
-                                    P);
-#else
-                eee = INF;
-#endif
-              } else {
-                eee += E_IntLoop(0, 0, type, type2, S[i + 1], S[j - 1], S[i], S[j], P);
-              }
-
-              break;
-
-            case VRNA_FC_TYPE_COMPARATIVE:
-              for (s = 0; s < n_seq; s++) {
-                type2 = vrna_get_ptype_md(SS[s][l], SS[s][k], md);
-                eee   += E_IntLoop(0, 0, tt[s], type2, S3[s][i], S5[s][j], S5[s][k], S3[s][l], P);
-              }
-
-              break;
-          }
-
-          if (sc_wrapper.pair)
-            eee += sc_wrapper.pair(i, j, k, l, &sc_wrapper);
-
-          e = MIN2(e, eee);
-        }
-      }
-    }
-
-    if (!noclose) {
-      /* only proceed if the enclosing pair is allowed */
-
-      /* handle bulges in 5' side */
-      l = j - 1;
-      if (l > i + 2) {
-        last_k = l - 1;
-
-        if (last_k > i + 1 + MAXLOOP)
-          last_k = i + 1 + MAXLOOP;
-
-        if (last_k > i + 1 + hc_up[i + 1])
-          last_k = i + 1 + hc_up[i + 1];
-
-        u1 = 1;
-
-        k   = i + 2;
-        kl  = (sliding_window) ? 0 : idx[l] + k;
-
-        hc_mx += n * l;
-
-        for (; k <= last_k; k++, u1++, kl++) {
-          hc_decompose = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[k];
-
-          if ((hc_decompose & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
-              (evaluate(i, j, k, l, &hc_dat_local))) {
-            eee = (sliding_window) ? c_local[k][l - k] : c[kl];
-
-            if (eee < INF) {
-              switch (fc->type) {
-                case VRNA_FC_TYPE_SINGLE:
-                  type2 = sliding_window ?
-                          rtype[vrna_get_ptype_window(k, l, ptype_local)] :
-                          rtype[vrna_get_ptype(kl, ptype)];
-
-                  if ((noGUclosure) && (type2 == 3 || type2 == 4))
-                    continue;
-
-                  if ((has_nick) && ((sn[i] != sn[k]) || (sn[j - 1] != sn[j]))) {
-#if 0
-                    /* interior loop like cofold structure */
-                    short Si, Sj;
-                    Si  = (sn[i + 1] == sn[i]) ? S[i + 1] : -1;
-                    Sj  = (sn[j] == sn[j - 1]) ? S[j - 1] : -1;
-                    eee += E_IntLoop_Co(rtype[type], rtype[type2],
-                                        i, j, k, l,
-                                        ss[fc->strand_order[1]],
-                                        Si, Sj,
-                                        S[k - 1], S[j],
-                                        md->dangles,
-                                        P);
-#else
-                    eee = INF;
-#endif
-                  } else {
-                    eee += E_IntLoop(u1, 0, type, type2, S[i + 1], S[j - 1], S[k - 1], S[l + 1], P);
-                  }
-
-                  break;
-
-                case VRNA_FC_TYPE_COMPARATIVE:
-                  for (s = 0; s < n_seq; s++) {
-                    int u1_local = a2s[s][k - 1] - a2s[s][i];
-                    type2 = vrna_get_ptype_md(SS[s][l], SS[s][k], md);
-                    eee   +=
-                      E_IntLoop(u1_local, 0, tt[s], type2, S3[s][i], S5[s][j], S5[s][k], S3[s][l],
-                                P);
-                  }
-
-                  break;
-              }
-
-              if (sc_wrapper.pair)
-                eee += sc_wrapper.pair(i, j, k, l, &sc_wrapper);
-
-              e = MIN2(e, eee);
-
-              if (with_ud) {
-                eee += domains_up->energy_cb(fc,
-                                             i + 1, k - 1,
-                                             VRNA_UNSTRUCTURED_DOMAIN_INT_LOOP,
-                                             domains_up->data);
-                e = MIN2(e, eee);
-              }
-            }
-          }
-        }
-
-        hc_mx -= n * l;
-      }
-
-      /* handle bulges in 3' side */
-      k = i + 1;
-      if (k < j - 2) {
-        first_l = k + 1;
-        if (first_l < j - 1 - MAXLOOP)
-          first_l = j - 1 - MAXLOOP;
-
-        u2    = 1;
-        hc_mx += n * k;
-
-        for (l = j - 2; l >= first_l; l--, u2++) {
-          if (u2 > hc_up[l + 1])
-            break;
-
-          kl            = (sliding_window) ? 0 : idx[l] + k;
-          hc_decompose  = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[l];
-
-          if ((hc_decompose & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
-              (evaluate(i, j, k, l, &hc_dat_local))) {
-            eee = (sliding_window) ? c_local[k][l - k] : c[kl];
-
-            if (eee < INF) {
-              switch (fc->type) {
-                case VRNA_FC_TYPE_SINGLE:
-                  type2 = sliding_window ?
-                          rtype[vrna_get_ptype_window(k, l, ptype_local)] :
-                          rtype[vrna_get_ptype(kl, ptype)];
-
-                  if ((noGUclosure) && (type2 == 3 || type2 == 4))
-                    continue;
-
-                  if ((has_nick) && ((sn[i] != sn[i + 1]) || (sn[j] != sn[l]))) {
-#if 0
-                    /* interior loop like cofold structure */
-                    short Si, Sj;
-                    Si  = (sn[i + 1] == sn[i]) ? S[i + 1] : -1;
-                    Sj  = (sn[j] == sn[j - 1]) ? S[j - 1] : -1;
-                    eee += E_IntLoop_Co(rtype[type], rtype[type2],
-                                        i, j, k, l,
-                                        ss[fc->strand_order[1]],
-                                        Si, Sj,
-                                        S[i], S[l + 1],
-                                        md->dangles,
-                                        P);
-#else
-                    eee = INF;
-#endif
-                  } else {
-                    eee += E_IntLoop(0, u2, type, type2, S[i + 1], S[j - 1], S[k - 1], S[l + 1], P);
-                  }
-
-                  break;
-
-                case VRNA_FC_TYPE_COMPARATIVE:
-                  for (s = 0; s < n_seq; s++) {
-                    int u2_local = a2s[s][j - 1] - a2s[s][l];
-                    type2 = vrna_get_ptype_md(SS[s][l], SS[s][k], md);
-                    eee   +=
-                      E_IntLoop(0, u2_local, tt[s], type2, S3[s][i], S5[s][j], S5[s][k], S3[s][l],
-                                P);
-                  }
-
-                  break;
-              }
-
-              if (sc_wrapper.pair)
-                eee += sc_wrapper.pair(i, j, k, l, &sc_wrapper);
-
-              e = MIN2(e, eee);
-
-              if (with_ud) {
-                eee += domains_up->energy_cb(fc,
-                                             l + 1, j - 1,
-                                             VRNA_UNSTRUCTURED_DOMAIN_INT_LOOP,
-                                             domains_up->data);
-                e = MIN2(e, eee);
-              }
-            }
-          }
-        }
-
-        hc_mx -= n * k;
-      }
-
-      /* last but not least, all other internal loops */
-      first_l = i + 2 + 1;
-      if (first_l < j - 1 - MAXLOOP)
-        first_l = j - 1 - MAXLOOP;
-
-      u2 = 1;
-      for (l = j - 2; l >= first_l; l--, u2++) {
-        if (u2 > hc_up[l + 1])
-          break;
+  if (fc->int_loop_plain)
+    return E_internal_loop_plain(fc, i, j);
 
-        last_k = l - 1;
-
-        if (last_k > i + 1 + MAXLOOP - u2)
-          last_k = i + 1 + MAXLOOP - u2;
-
-        if (last_k > i + 1 + hc_up[i + 1])
-          last_k = i + 1 + hc_up[i + 1];
-
-        u1  = 1;
-        k   = i + 2;
-        kl  = (sliding_window) ? 0 : idx[l] + k;
-
-        hc_mx += n * l;
-
-        for (; k <= last_k; k++, u1++, kl++) {
-          hc_decompose = (sliding_window) ? hc_mx_local[k][l - k] : hc_mx[k];
-
-          if ((hc_decompose & VRNA_CONSTRAINT_CONTEXT_INT_LOOP_ENC) &&
-              (evaluate(i, j, k, l, &hc_dat_local))) {
-            eee = (sliding_window) ? c_local[k][l - k] : c[kl];
-
-            if (eee < INF) {
-              switch (fc->type) {
-                case VRNA_FC_TYPE_SINGLE:
-                  type2 = sliding_window ?
-                          rtype[vrna_get_ptype_window(k, l, ptype_local)] :
-                          rtype[vrna_get_ptype(kl, ptype)];
-
-                  if ((noGUclosure) && (type2 == 3 || type2 == 4))
-                    continue;
-
-                  if ((has_nick) && ((sn[i] != sn[k]) || (sn[j] != sn[l]))) {
-#if 0
-                    /* interior loop like cofold structure */
-                    short Si, Sj;
-                    Si  = (sn[i + 1] == sn[i]) ? S[i + 1] : -1;
-                    Sj  = (sn[j] == sn[j - 1]) ? S[j - 1] : -1;
-                    eee += E_IntLoop_Co(rtype[type], rtype[type2],
-                                        i, j, k, l,
-                                        ss[fc->strand_order[1]],
-                                        Si, Sj,
-                                        S[k - 1], S[l + 1],
-                                        md->dangles,
-                                        P);
-#else
-                    eee = INF;
-#endif
-                  } else {
-                    eee +=
-                      E_IntLoop(u1, u2, type, type2, S[i + 1], S[j - 1], S[k - 1], S[l + 1], P);
-                  }
-
-                  break;
-
-                case VRNA_FC_TYPE_COMPARATIVE:
-                  for (s = 0; s < n_seq; s++) {
-                    int u1_local  = a2s[s][k - 1] - a2s[s][i];
-                    int u2_local  = a2s[s][j - 1] - a2s[s][l];
-                    type2 = vrna_get_ptype_md(SS[s][l], SS[s][k], md);
-                    eee   += E_IntLoop(u1_local,
-                                       u2_local,
-                                       tt[s],
-                                       type2,
-                                       S3[s][i],
-                                       S5[s][j],
-                                       S5[s][k],
-                                       S3[s][l],
-                                       P);
-                  }
-
-                  break;
-              }
-
-              if (sc_wrapper.pair)
-                eee += sc_wrapper.pair(i, j, k, l, &sc_wrapper);
-
-              e = MIN2(e, eee);
-
-              if (with_ud) {
-                int e5, e3;
-
-                e5 = domains_up->energy_cb(fc,
-                                           i + 1, k - 1,
-                                           VRNA_UNSTRUCTURED_DOMAIN_INT_LOOP,
-                                           domains_up->data);
-                e3 = domains_up->energy_cb(fc,
-                                           l + 1, j - 1,
-                                           VRNA_UNSTRUCTURED_DOMAIN_INT_LOOP,
-                                           domains_up->data);
-
-                e = MIN2(e, eee + e5);
-                e = MIN2(e, eee + e3);
-                e = MIN2(e, eee + e5 + e3);
-              }
-            }
-          }
-        }
-
-        hc_mx -= n * l;
-      }
-
-      if (with_gquad) {
-        /* include all cases where a g-quadruplex may be enclosed by base pair (i,j) */
-        eee = INF;
-
-        switch (fc->type) {
-          case VRNA_FC_TYPE_SINGLE:
-            if (sliding_window)
-              eee = E_GQuad_IntLoop_L(i, j, type, S, ggg_local, fc->window_size, P);
-            else if (sn[j] == sn[i])
-              eee = E_GQuad_IntLoop(i, j, type, S, ggg, idx, P);
-
-            break;
-
-          case VRNA_FC_TYPE_COMPARATIVE:
-            if (sliding_window) {
-              eee = E_GQuad_IntLoop_L_comparative(i,
-                                                  j,
-                                                  tt,
-                                                  fc->S_cons,
-                                                  S5,
-                                                  S3,
-                                                  a2s,
-                                                  ggg_local,
-                                                  n_seq,
-                                                  P);
-            } else {
-              eee = E_GQuad_IntLoop_comparative(i,
-                                                j,
-                                                tt,
-                                                fc->S_cons,
-                                                S5,
-                                                S3,
-                                                a2s,
-                                                ggg,
-                                                idx,
-                                                n_seq,
-                                                P);
-            }
-
-            break;
-        }
+  return E_internal_loop_default(fc, i, j);
+}
 
-        e = MIN2(e, eee);
-      }
 
-      free(tt);
-    }
-  }
+#define INT_LOOP_PLAIN  0
+#define INT_LOOP_FUNC   E_internal_loop_default
+#include "internal_loop.inc"
+#undef INT_LOOP_FUNC
+#undef INT_LOOP_PLAIN
 
-  free_sc_int(&sc_wrapper);
 
-  return e;
-}
+#define INT_LOOP_PLAIN  1
+#define INT_LOOP_FUNC   E_internal_loop_plain
+#include "internal_loop.inc"
+#undef INT_LOOP_FUNC
+#undef INT_LOOP_PLAIN
 
 
 PRIVATE int
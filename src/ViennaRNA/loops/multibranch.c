@@ -34,6 +34,8 @@
 
 #include "multibranch_hc.inc"
 #include "multibranch_sc.inc"
+#include "ali_rows.inc"
+#include "multibranch_ali.inc"
 
 /*
  #################################
@@ -200,8 +202,8 @@ ml_pair_d0(vrna_fold_compound_t       *fc,
            struct hc_mb_def_dat       *hc_wrapper,
            struct sc_mb_dat           *sc_wrapper)
 {
-  short         *S, **SS;
-  unsigned int  tt, s, n_seq;
+  short         *S;
+  unsigned int  tt, n_seq;
   int           e;
   vrna_param_t  *P;
   vrna_md_t     *md;
@@ -229,13 +231,8 @@ ml_pair_d0(vrna_fold_compound_t       *fc,
 
         case VRNA_FC_TYPE_COMPARATIVE:
           n_seq = fc->n_seq;
-          SS    = fc->S;
-          for (s = 0; s < n_seq; s++) {
-            tt  = vrna_get_ptype_md(SS[s][j], SS[s][i], md);
-            e   += E_MLstem(tt, -1, -1, P);
-          }
-
-          e += n_seq * P->MLclosing;
+          e     += E_MLstem_ali(fc, P, j, i, -1, -1) +
+                   n_seq * P->MLclosing;
           break;
       }
 
@@ -288,8 +285,8 @@ ml_pair_d2(vrna_fold_compound_t       *fc,
            struct hc_mb_def_dat       *hc_wrapper,
            struct sc_mb_dat           *sc_wrapper)
 {
-  short         *S, *S2, **SS, **S5, **S3, si1, sj1;
-  unsigned int  tt, strands, *sn, s, n_seq;
+  short         *S, *S2, si1, sj1;
+  unsigned int  tt, strands, *sn, n_seq;
   int           e;
   vrna_param_t  *P;
   vrna_md_t     *md;
@@ -323,16 +320,8 @@ ml_pair_d2(vrna_fold_compound_t       *fc,
 
         case VRNA_FC_TYPE_COMPARATIVE:
           n_seq = fc->n_seq;
-          SS    = fc->S;
-          S5    = fc->S5;
-          S3    = fc->S3;
-
-          for (s = 0; s < n_seq; s++) {
-            tt  = vrna_get_ptype_md(SS[s][j], SS[s][i], md);
-            e   += E_MLstem(tt, S5[s][j], S3[s][i], P);
-          }
-
-          e += n_seq * P->MLclosing;
+          e     += E_MLstem_ali(fc, P, j, i, j, i) +
+                   n_seq * P->MLclosing;
           break;
       }
 
@@ -354,8 +343,8 @@ ml_pair5(vrna_fold_compound_t       *fc,
          struct hc_mb_def_dat       *hc_wrapper,
          struct sc_mb_dat           *sc_wrapper)
 {
-  short         *S, *S2, **SS, **S3, si1;
-  unsigned int  tt, strands, *sn, n_seq, s;
+  short         *S, *S2, si1;
+  unsigned int  tt, strands, *sn, n_seq;
   int           e;
   vrna_param_t  *P;
   vrna_md_t     *md;
@@ -389,16 +378,9 @@ ml_pair5(vrna_fold_compound_t       *fc,
 
         case VRNA_FC_TYPE_COMPARATIVE:
           n_seq = fc->n_seq;
-          SS    = fc->S;
-          S3    = fc->S3;
-
-          for (s = 0; s < n_seq; s++) {
-            tt  = vrna_get_ptype_md(SS[s][j], SS[s][i], md);
-            e   += E_MLstem(tt, -1, S3[s][i], P);
-          }
-
-          e += (P->MLclosing + P->MLbase) *
-               n_seq;
+          e     += E_MLstem_ali(fc, P, j, i, -1, i) +
+                   (P->MLclosing + P->MLbase) *
+                   n_seq;
           break;
       }
 
@@ -420,8 +402,8 @@ ml_pair3(vrna_fold_compound_t       *fc,
          struct hc_mb_def_dat       *hc_wrapper,
          struct sc_mb_dat           *sc_wrapper)
 {
-  short         *S, *S2, **SS, **S5, sj1;
-  unsigned int  tt, strands, *sn, n_seq, s;
+  short         *S, *S2, sj1;
+  unsigned int  tt, strands, *sn, n_seq;
   int           e;
   vrna_param_t  *P;
   vrna_md_t     *md;
@@ -455,16 +437,9 @@ ml_pair3(vrna_fold_compound_t       *fc,
 
         case VRNA_FC_TYPE_COMPARATIVE:
           n_seq = fc->n_seq;
-          SS    = fc->S;
-          S5    = fc->S5;
-
-          for (s = 0; s < n_seq; s++) {
-            tt  = vrna_get_ptype_md(SS[s][j], SS[s][i], md);
-            e   += E_MLstem(tt, S5[s][j], -1, P);
-          }
-
-          e += (P->MLclosing + P->MLbase) *
-               n_seq;
+          e     += E_MLstem_ali(fc, P, j, i, j, -1) +
+                   (P->MLclosing + P->MLbase) *
+                   n_seq;
           break;
       }
 
@@ -487,8 +462,8 @@ ml_pair53(vrna_fold_compound_t      *fc,
           struct hc_mb_def_dat      *hc_wrapper,
           struct sc_mb_dat          *sc_wrapper)
 {
-  short         *S, *S2, **SS, **S3, **S5, si1, sj1;
-  unsigned int  tt, strands, *sn, n_seq, s;
+  short         *S, *S2, si1, sj1;
+  unsigned int  tt, strands, *sn, n_seq;
   int           e;
   vrna_param_t  *P;
   vrna_md_t     *md;
@@ -523,17 +498,9 @@ ml_pair53(vrna_fold_compound_t      *fc,
 
         case VRNA_FC_TYPE_COMPARATIVE:
           n_seq = fc->n_seq;
-          SS    = fc->S;
-          S5    = fc->S5;
-          S3    = fc->S3;
-
-          for (s = 0; s < n_seq; s++) {
-            tt  = vrna_get_ptype_md(SS[s][j], SS[s][i], md);
-            e   += E_MLstem(tt, S5[s][j], S3[s][i], P);
-          }
-
-          e += (P->MLclosing + 2 * P->MLbase) *
-               n_seq;
+          e     += E_MLstem_ali(fc, P, j, i, j, i) +
+                   (P->MLclosing + 2 * P->MLbase) *
+                   n_seq;
           break;
       }
 
@@ -719,8 +686,7 @@ E_mb_loop_stack(vrna_fold_compound_t  *fc,
                 int                   j)
 {
   char                      *ptype, **ptype_local;
-  short                     **SS;
-  unsigned int              n_seq, s, *tt, sliding_window;
+  unsigned int              n_seq, *tt, sliding_window;
   int                       *c, *fML, e, decomp, en, i1k, k1j1, ij, k, *indx,
                             type, type_2, *rtype, **c_local, **fML_local;
   vrna_param_t              *P;
@@ -732,7 +698,6 @@ E_mb_loop_stack(vrna_fold_compound_t  *fc,
   sliding_window = (fc->hc->type == VRNA_HC_WINDOW) ? 1 : 0;
 
   n_seq       = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
-  SS          = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S;
   indx        = fc->jindx;
   P           = fc->params;
   md          = &(P->model_details);
@@ -754,9 +719,8 @@ E_mb_loop_stack(vrna_fold_compound_t  *fc,
 
   /* prepare type(s) for enclosing pair (i, j) */
   if (fc->type == VRNA_FC_TYPE_COMPARATIVE) {
-    tt = (unsigned int *)vrna_alloc(sizeof(unsigned int) * n_seq);
-    for (s = 0; s < n_seq; s++)
-      tt[s] = vrna_get_ptype_md(SS[s][i], SS[s][j], md);
+    tt = (unsigned int *)vrna_alloc(sizeof(unsigned int) * fc->n_seq_unique);
+    ptypes_ali(fc, md, i, j, tt);
   } else if (sliding_window) {
     type = vrna_get_ptype_window(i, j, ptype_local);
   } else {
@@ -778,10 +742,7 @@ E_mb_loop_stack(vrna_fold_compound_t  *fc,
               break;
 
             case VRNA_FC_TYPE_COMPARATIVE:
-              for (s = 0; s < n_seq; s++) {
-                type_2  = vrna_get_ptype_md(SS[s][k], SS[s][i + 1], md);
-                en      += P->stack[tt[s]][type_2];
-              }
+              en += E_coaxial_ali(fc, P, tt, i, j, k, i + 1);
               break;
           }
 
@@ -803,10 +764,7 @@ E_mb_loop_stack(vrna_fold_compound_t  *fc,
               break;
 
             case VRNA_FC_TYPE_COMPARATIVE:
-              for (s = 0; s < n_seq; s++) {
-                type_2  = vrna_get_ptype_md(SS[s][j - 1], SS[s][k + 1], md);
-                en      += P->stack[tt[s]][type_2];
-              }
+              en += E_coaxial_ali(fc, P, tt, i, j, j - 1, k + 1);
 
               break;
           }
@@ -834,10 +792,7 @@ E_mb_loop_stack(vrna_fold_compound_t  *fc,
               break;
 
             case VRNA_FC_TYPE_COMPARATIVE:
-              for (s = 0; s < n_seq; s++) {
-                type_2  = vrna_get_ptype_md(SS[s][k], SS[s][i + 1], md);
-                en      += P->stack[tt[s]][type_2];
-              }
+              en += E_coaxial_ali(fc, P, tt, i, j, k, i + 1);
 
               break;
           }
@@ -860,10 +815,7 @@ E_mb_loop_stack(vrna_fold_compound_t  *fc,
               break;
 
             case VRNA_FC_TYPE_COMPARATIVE:
-              for (s = 0; s < n_seq; s++) {
-                type_2  = vrna_get_ptype_md(SS[s][j - 1], SS[s][k + 1], md);
-                en      += P->stack[tt[s]][type_2];
-              }
+              en += E_coaxial_ali(fc, P, tt, i, j, j - 1, k + 1);
 
               break;
           }
@@ -908,8 +860,8 @@ extend_fm_3p(int                        i,
              struct hc_mb_def_dat       *hc_dat_local,
              struct sc_mb_dat           *sc_wrapper)
 {
-  short         *S, **SS, **S5, **S3;
-  unsigned int  *sn, n_seq, s, sliding_window;
+  short         *S;
+  unsigned int  *sn, n_seq, sliding_window;
   int           en, en2, length, *indx, *c, **c_local, **fm_local, *ggg, **ggg_local, ij, type,
                 dangle_model, with_gquad, e, u, k, cnt, with_ud;
   vrna_param_t  *P;
@@ -920,9 +872,6 @@ extend_fm_3p(int                        i,
   n_seq           = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
   length          = fc->length;
   S               = (fc->type == VRNA_FC_TYPE_SINGLE) ? fc->sequence_encoding : NULL;
-  SS              = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S;
-  S5              = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S5;
-  S3              = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S3;
   indx            = (sliding_window) ? NULL : fc->jindx;
   sn              = fc->strand_number;
   c               = (sliding_window) ? NULL : fc->matrices->c;
@@ -962,17 +911,10 @@ extend_fm_3p(int                        i,
           break;
 
         case VRNA_FC_TYPE_COMPARATIVE:
-          if (dangle_model == 2) {
-            for (s = 0; s < n_seq; s++) {
-              type  = vrna_get_ptype_md(SS[s][i], SS[s][j], md);
-              en    += E_MLstem(type, S5[s][i], S3[s][j], P);
-            }
-          } else {
-            for (s = 0; s < n_seq; s++) {
-              type  = vrna_get_ptype_md(SS[s][i], SS[s][j], md);
-              en    += E_MLstem(type, -1, -1, P);
-            }
-          }
+          if (dangle_model == 2)
+            en += E_MLstem_ali(fc, P, i, j, i, j);
+          else
+            en += E_MLstem_ali(fc, P, i, j, -1, -1);
 
           break;
       }
@@ -1022,10 +964,7 @@ extend_fm_3p(int                        i,
             break;
 
           case VRNA_FC_TYPE_COMPARATIVE:
-            for (s = 0; s < n_seq; s++) {
-              type  = vrna_get_ptype_md(SS[s][i + 1], SS[s][j], md);
-              en    += E_MLstem(type, S5[s][i + 1], -1, P);
-            }
+            en += E_MLstem_ali(fc, P, i + 1, j, i + 1, -1);
             break;
         }
 
@@ -1050,10 +989,7 @@ extend_fm_3p(int                        i,
             break;
 
           case VRNA_FC_TYPE_COMPARATIVE:
-            for (s = 0; s < n_seq; s++) {
-              type  = vrna_get_ptype_md(SS[s][i], SS[s][j - 1], md);
-              en    += E_MLstem(type, -1, S3[s][j], P);
-            }
+            en += E_MLstem_ali(fc, P, i, j - 1, -1, j);
             break;
         }
 
@@ -1078,10 +1014,7 @@ extend_fm_3p(int                        i,
             break;
 
           case VRNA_FC_TYPE_COMPARATIVE:
-            for (s = 0; s < n_seq; s++) {
-              type  = vrna_get_ptype_md(SS[s][i + 1], SS[s][j - 1], md);
-              en    += E_MLstem(type, S5[s][i], S3[s][j], P);
-            }
+            en += E_MLstem_ali(fc, P, i + 1, j - 1, i, j);
             break;
         }
 
@@ -1134,8 +1067,8 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
                 int                   *dmli)
 {
   char                      *ptype, **ptype_local;
-  short                     *S, **SS, **S5, **S3;
-  unsigned int              *sn, *se, n_seq, s;
+  short                     *S;
+  unsigned int              *sn, *se, n_seq;
   int                       k, en, decomp, mm5, mm3, type_2, k1j, length, *indx,
                             *c, *fm, ij, dangle_model, type, *rtype, circular, e, u,
                             cnt, with_ud, sliding_window, **c_local, **fm_local;
@@ -1155,9 +1088,6 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
   ptype_local =
     (fc->type == VRNA_FC_TYPE_SINGLE) ? ((sliding_window) ? fc->ptype_local : NULL) : NULL;
   S             = (fc->type == VRNA_FC_TYPE_SINGLE) ? fc->sequence_encoding : NULL;
-  SS            = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S;
-  S5            = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S5;
-  S3            = (fc->type == VRNA_FC_TYPE_SINGLE) ? NULL : fc->S3;
   indx          = (sliding_window) ? NULL : fc->jindx;
   n_seq         = (fc->type == VRNA_FC_TYPE_SINGLE) ? 1 : fc->n_seq;
   sn            = fc->strand_number;
@@ -1264,10 +1194,7 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
             break;
 
           case VRNA_FC_TYPE_COMPARATIVE:
-            for (s = 0; s < n_seq; s++) {
-              type  = vrna_get_ptype_md(SS[s][i + 1], SS[s][j], md);
-              en    += E_MLstem(type, S5[s][i + 1], -1, P);
-            }
+            en += E_MLstem_ali(fc, P, i + 1, j, i + 1, -1);
             break;
         }
 
@@ -1296,10 +1223,7 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
             break;
 
           case VRNA_FC_TYPE_COMPARATIVE:
-            for (s = 0; s < n_seq; s++) {
-              type  = vrna_get_ptype_md(SS[s][i], SS[s][j - 1], md);
-              en    += E_MLstem(type, -1, S3[s][j - 1], P);
-            }
+            en += E_MLstem_ali(fc, P, i, j - 1, -1, j - 1);
             break;
         }
 
@@ -1328,10 +1252,7 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
             break;
 
           case VRNA_FC_TYPE_COMPARATIVE:
-            for (s = 0; s < n_seq; s++) {
-              type  = vrna_get_ptype_md(SS[s][i + 1], SS[s][j - 1], md);
-              en    += E_MLstem(type, S5[s][i + 1], S3[s][j - 1], P);
-            }
+            en += E_MLstem_ali(fc, P, i + 1, j - 1, i + 1, j - 1);
             break;
         }
 
@@ -1494,12 +1415,7 @@ E_ml_stems_fast(vrna_fold_compound_t  *fc,
                 break;
 
               case VRNA_FC_TYPE_COMPARATIVE:
-                for (s = 0; s < n_seq; s++) {
-                  type    = vrna_get_ptype_md(SS[s][k], SS[s][i], md);
-                  type_2  = vrna_get_ptype_md(SS[s][j], SS[s][k + 1], md);
-
-                  en += P->stack[type][type_2];
-                }
+                en += E_coaxial_ali(fc, P, NULL, k, i, j, k + 1);
 
                 break;
             }
@@ -3245,14 +3245,22 @@ PRIVATE INLINE struct aux_arrays *
 get_aux_arrays(unsigned int length)
 {
   unsigned int      j;
-  struct aux_arrays *aux = (struct aux_arrays *)vrna_alloc(sizeof(struct aux_arrays));
+  struct aux_arrays *aux;
 
-  aux->cc     = (int *)vrna_alloc(sizeof(int) * (length + 2));  /* auxilary arrays for canonical structures     */
-  aux->cc1    = (int *)vrna_alloc(sizeof(int) * (length + 2));  /* auxilary arrays for canonical structures     */
-  aux->Fmi    = (int *)vrna_alloc(sizeof(int) * (length + 1));  /* holds row i of fML (avoids jumps in memory)  */
-  aux->DMLi   = (int *)vrna_alloc(sizeof(int) * (length + 1));  /* DMLi[j] holds  MIN(fML[i,k]+fML[k+1,j])      */
-  aux->DMLi1  = (int *)vrna_alloc(sizeof(int) * (length + 1));  /*                MIN(fML[i+1,k]+fML[k+1,j])    */
-  aux->DMLi2  = (int *)vrna_alloc(sizeof(int) * (length + 1));  /*                MIN(fML[i+2,k]+fML[k+1,j])    */
+  /*
+   *  all helper arrays are carved from a single memory block that directly
+   *  follows the struct itself, such that a single allocation suffices for
+   *  the entire recursion
+   */
+  aux = (struct aux_arrays *)vrna_alloc(sizeof(struct aux_arrays) +
+                                        sizeof(int) * (2 * (length + 2) + 4 * (length + 1)));
+
+  aux->cc     = (int *)(aux + 1);         /* auxilary arrays for canonical structures     */
+  aux->cc1    = aux->cc + (length + 2);   /* auxilary arrays for canonical structures     */
+  aux->Fmi    = aux->cc1 + (length + 2);  /* holds row i of fML (avoids jumps in memory)  */
+  aux->DMLi   = aux->Fmi + (length + 1);  /* DMLi[j] holds  MIN(fML[i,k]+fML[k+1,j])      */
+  aux->DMLi1  = aux->DMLi + (length + 1); /*                MIN(fML[i+1,k]+fML[k+1,j])    */
+  aux->DMLi2  = aux->DMLi1 + (length + 1); /*               MIN(fML[i+2,k]+fML[k+1,j])    */
 
   /* prefill helper arrays */
   for (j = 0; j <= length; j++)
@@ -3284,11 +3292,6 @@ rotate_aux_arrays(struct aux_arrays *aux,
 PRIVATE INLINE void
 free_aux_arrays(struct aux_arrays *aux)
 {
-  free(aux->cc);
-  free(aux->cc1);
-  free(aux->Fmi);
-  free(aux->DMLi);
-  free(aux->DMLi1);
-  free(aux->DMLi2);
+  /* the helper arrays share the memory block of the struct */
   free(aux);
 }
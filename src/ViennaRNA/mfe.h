@@ -182,6 +182,37 @@ vrna_circfold(const char  *sequence,
               char        *structure);
 
 
+/**
+ *  @brief  Compute Minimum Free Energy (MFE), and corresponding secondary structures for many RNA sequences
+ *
+ *  This simplified interface to vrna_mfe() processes a NULL-terminated list of sequences
+ *  independently of each other, using the same model details @p md for each of them. The MFE of
+ *  the i-th sequence is stored in @p energies[i]. If @p structures is not NULL, @p structures[i]
+ *  will point to a newly allocated string holding the corresponding MFE structure in dot-bracket
+ *  notation that must be free'd by the caller. Otherwise, structures are not backtracked at all.
+ *  Sequences for which no #vrna_fold_compound_t could be created receive an energy of
+ *  #INF / 100. and a NULL structure.
+ *
+ *  @note   Computations are distributed among @p jobs threads if the library has been
+ *          compiled with OpenMP support.
+ *
+ *  @see vrna_fold(), vrna_mfe(), vrna_pf_fold_batch()
+ *
+ *  @param sequences  A NULL-terminated list of RNA sequences
+ *  @param md         The model details to use (Maybe NULL)
+ *  @param structures An array of size n to store the MFE structures in (Maybe NULL)
+ *  @param energies   An array of size n to store the minimum free energies in kcal/mol in
+ *  @param jobs       The number of threads (<= 0 to use the OpenMP default)
+ *  @return           The number of sequences n
+ */
+int
+vrna_fold_batch(const char  **sequences,
+                vrna_md_t   *md,
+                char        **structures,
+                float       *energies,
+                int         jobs);
+
+
 /**
  *  @brief  Compute Minimum Free Energy (MFE), and a corresponding consensus secondary structure
  *          for an RNA sequence alignment using a comparative method
@@ -13,9 +13,14 @@
 
 #include "ViennaRNA/fold_compound.h"
 #include "ViennaRNA/model.h"
+#include "ViennaRNA/params/constants.h"
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/mfe.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 
 /* wrappers for single sequences */
 PUBLIC float
@@ -55,6 +60,63 @@ vrna_circfold(const char  *string,
 }
 
 
+PUBLIC int
+vrna_fold_batch(const char  **sequences,
+                vrna_md_t   *md_p,
+                char        **structures,
+                float       *energies,
+                int         jobs)
+{
+  long      num, i;
+  vrna_md_t md;
+
+  if ((!sequences) || (!energies))
+    return 0;
+
+  for (num = 0; sequences[num]; num++);
+
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  /* no need to backtrack if nobody is interested in the structures */
+  if (!structures)
+    md.backtrack = 0;
+
+#ifdef _OPENMP
+  if (jobs <= 0)
+    jobs = omp_get_max_threads();
+
+#pragma omp parallel for num_threads(jobs) schedule(dynamic, 1)
+#else
+  (void)jobs;
+#endif
+  for (i = 0; i < num; i++) {
+    char                  *structure;
+    vrna_fold_compound_t  *fc;
+
+    structure = NULL;
+    fc        = vrna_fold_compound(sequences[i], &md, VRNA_OPTION_DEFAULT);
+
+    if (fc) {
+      if (structures)
+        structure = (char *)vrna_alloc(sizeof(char) * (fc->length + 1));
+
+      energies[i] = vrna_mfe(fc, structure);
+      vrna_fold_compound_free(fc);
+    } else {
+      energies[i] = (float)INF / 100.;
+    }
+
+    if (structures)
+      structures[i] = structure;
+  }
+
+  return (int)num;
+}
+
+
 /* wrappers for multiple sequence alignments */
 
 PUBLIC float
@@ -17,6 +17,7 @@
 #include <limits.h>
 
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/utils/strings.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/loops/all.h"
@@ -49,8 +50,30 @@
  # PRIVATE FUNCTION DECLARATIONS #
  #################################
  */
+PRIVATE FLT_OR_DBL
+pf_region(vrna_fold_compound_t  *fc,
+          int                   from,
+          int                   to,
+          char                  *structure);
+
+
+PRIVATE int
+fill_arrays(vrna_fold_compound_t  *fc,
+            int                   from,
+            int                   to);
+
+
+PRIVATE void
+keep_outside_prepare(vrna_fold_compound_t *fc,
+                     int                  from,
+                     int                  to);
+
+
 PRIVATE int
-fill_arrays(vrna_fold_compound_t *fc);
+keep_outside_finish(vrna_fold_compound_t  *fc,
+                    int                   from,
+                    int                   to,
+                    FLT_OR_DBL            rescale);
 
 
 PRIVATE void
@@ -82,13 +105,7 @@ PUBLIC FLT_OR_DBL
 vrna_pf(vrna_fold_compound_t  *fc,
         char                  *structure)
 {
-  int               n;
-  FLT_OR_DBL        Q, dG;
-  vrna_md_t         *md;
-  vrna_exp_param_t  *params;
-  vrna_mx_pf_t      *matrices;
-
-  dG = (FLT_OR_DBL)(INF / 100.);
+  FLT_OR_DBL dG = (FLT_OR_DBL)(INF / 100.);
 
   if (fc) {
     /* make sure, everything is set up properly to start partition function computations */
@@ -97,11 +114,437 @@ vrna_pf(vrna_fold_compound_t  *fc,
       return dG;
     }
 
+    dG = pf_region(fc, 1, (int)fc->length, structure);
+  }
+
+  return dG;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_pf_update(vrna_fold_compound_t *fc,
+               unsigned int         i,
+               unsigned int         j,
+               char                 *structure)
+{
+  int           n, from, to;
+  double        pf_scale, kT;
+  FLT_OR_DBL    dG;
+  vrna_mx_pf_t  *matrices;
+
+  dG = (FLT_OR_DBL)(INF / 100.);
+
+  if (fc) {
+    n = (int)fc->length;
+
+    if ((i < 1) ||
+        (j < i) ||
+        ((int)j > n)) {
+      vrna_message_warning("vrna_pf_update@part_func.c: "
+                           "Invalid region [%u, %u] for sequence of length %d",
+                           i, j, n);
+      return dG;
+    }
+
+    /*
+     *  remember what the previous computations have been done with
+     *  to detect whether we can re-use any of their results at all
+     */
+    matrices  = fc->exp_matrices;
+    pf_scale  = (fc->exp_params) ? fc->exp_params->pf_scale : -1.;
+    kT        = (fc->exp_params) ? fc->exp_params->kT : -1.;
+
+    if (!vrna_fold_compound_prepare(fc, VRNA_OPTION_PF)) {
+      vrna_message_warning("vrna_pf_update@part_func.c: Failed to prepare vrna_fold_compound");
+      return dG;
+    }
+
+    /*
+     *  Loop energies of a pair may depend on its adjacent nucleotides, so
+     *  we extend the region by one nucleotide on each side. Everything is
+     *  re-computed if the matrices have been (re-)allocated in the meantime,
+     *  or if the Boltzmann factors or their scaling changed
+     */
+    from  = MAX2(1, (int)i - 1);
+    to    = MIN2(n, (int)j + 1);
+
+    if ((matrices != fc->exp_matrices) ||
+        (matrices->q == NULL) ||
+        (matrices->q[fc->iindx[1] - n] <= 0.) ||
+        (pf_scale != fc->exp_params->pf_scale) ||
+        (kT != fc->exp_params->kT) ||
+        (fc->hc->type == VRNA_HC_WINDOW) ||
+        (fc->strands > 1) ||
+        (fc->aux_grammar)) {
+      from  = 1;
+      to    = n;
+    }
+
+    dG = pf_region(fc, from, to, structure);
+  }
+
+  return dG;
+}
+
+
+PUBLIC vrna_dimer_pf_t
+vrna_pf_dimer(vrna_fold_compound_t  *fc,
+              char                  *structure)
+{
+  vrna_dimer_pf_t X;
+
+  X.F0AB = X.FAB = X.FcAB = X.FA = X.FB = 0.;
+
+  if (fc) {
+    (void)vrna_pf(fc, structure);
+
+    /* backward compatibility partition function and ensemble energy computation */
+    extract_dimer_props(fc,
+                        &(X.F0AB),
+                        &(X.FAB),
+                        &(X.FcAB),
+                        &(X.FA),
+                        &(X.FB));
+  }
+
+  return X;
+}
+
+
+PUBLIC int
+vrna_pf_float_precision(void)
+{
+  return sizeof(FLT_OR_DBL) == sizeof(float);
+}
+
+
+PUBLIC FLT_OR_DBL *
+vrna_pf_substrands(vrna_fold_compound_t *fc,
+                   size_t               complex_size)
+{
+  FLT_OR_DBL *Q_sub = NULL;
+
+  if ((fc) &&
+      (fc->strands >= complex_size) &&
+      (fc->exp_matrices) &&
+      (fc->exp_matrices->q)) {
+    unsigned int      *ss, *se, *so;
+    FLT_OR_DBL        Q;
+    vrna_exp_param_t  *params;
+    vrna_mx_pf_t      *matrices;
+
+    ss        = fc->strand_start;
+    se        = fc->strand_end;
+    so        = fc->strand_order;
+    params    = fc->exp_params;
+    matrices  = fc->exp_matrices;
+
+    Q_sub = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (fc->strands - complex_size + 1));
+
+    for (size_t i = 0; i < fc->strands - complex_size + 1; i++) {
+      size_t start, end;
+      start     = ss[so[i]];
+      end       = se[so[i + complex_size - 1]];
+      Q         = matrices->q[fc->iindx[start] - end];
+      Q_sub[i]  = (-log(Q) - (end - start + 1) * log(params->pf_scale)) *
+                  params->kT /
+                  1000.0;
+    }
+  }
+
+  return Q_sub;
+}
+
+
+PUBLIC FLT_OR_DBL
+vrna_pf_add(FLT_OR_DBL  dG1,
+            FLT_OR_DBL  dG2,
+            double      kT)
+{
+  double  x1  = -(double)dG1 / kT;
+  double  x2  = -(double)dG2 / kT;
+  double  xs  = MAX2(x1, x2);
+
+  return -kT * (xs + log(exp(x1 - xs) + exp(x2 - xs)));
+}
+
+
+PUBLIC double **
+vrna_pf_complexes(vrna_fold_compound_t  *fc,
+                  unsigned int          ***complexes,
+                  size_t                max_strands,
+                  const vrna_md_t       *md_p,
+                  int                   jobs)
+{
+  return vrna_pf_complexes_cb(fc, complexes, max_strands, md_p, jobs, NULL, NULL);
+}
+
+
+PUBLIC double **
+vrna_pf_complexes_cb(vrna_fold_compound_t       *fc,
+                     unsigned int               ***complexes,
+                     size_t                     max_strands,
+                     const vrna_md_t            *md_p,
+                     int                        jobs,
+                     vrna_callback_pf_complexes *cb,
+                     void                       *data)
+{
+  unsigned int  **mapping, **perm, *perm_map, **complex_strands;
+  size_t        k, c, i, kk, num_complexes, num_tasks, mem_tasks, cnt, done;
+  size_t        *first_task, *complex_size, *remaining;
+  int           failed;
+  double        **dG, *F, kT;
+  vrna_md_t     md;
+
+  if ((!fc) ||
+      (fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (!complexes) ||
+      (max_strands == 0) ||
+      (max_strands > fc->strands))
+    return NULL;
+
+  if (md_p) {
+    md = *md_p;
+  } else {
+    md = (fc->params) ? fc->params->model_details : fc->exp_params->model_details;
+
+    /* undo the adjustments to the length of the full sequence */
+    if (md.max_bp_span == (int)fc->length)
+      md.max_bp_span = VRNA_MODEL_DEFAULT_MAX_BP_SPAN;
+
+    md.window_size = VRNA_MODEL_DEFAULT_WINDOW_SIZE;
+  }
+
+  /* base pair probabilities are not required for any of the complexes */
+  md.compute_bpp = 0;
+
+  kT = md.betaScale * (md.temperature + K0) * GASCONST / 1000.;
+
+  /*
+   *  Collect all permutations of all complexes as independent tasks. For
+   *  each task, we store the permutation and the mapping of its species to
+   *  the actual strands. The tasks of complex c with k strands are stored
+   *  consecutively, starting at first_task[cnt] where cnt counts complexes
+   *  over all sizes.
+   */
+  num_complexes = 0;
+  for (k = 1; k <= max_strands; k++)
+    for (c = 0; complexes[k][c]; c++)
+      num_complexes++;
+
+  dG              = (double **)vrna_alloc(sizeof(double *) * (max_strands + 1));
+  mapping         = (unsigned int **)vrna_alloc(sizeof(unsigned int *) * (num_complexes + 1));
+  first_task      = (size_t *)vrna_alloc(sizeof(size_t) * (num_complexes + 1));
+  complex_size    = (size_t *)vrna_alloc(sizeof(size_t) * (num_complexes + 1));
+  complex_strands = (unsigned int **)vrna_alloc(sizeof(unsigned int *) * (num_complexes + 1));
+  mem_tasks       = num_complexes + 1;
+  perm            = (unsigned int **)vrna_alloc(sizeof(unsigned int *) * mem_tasks);
+  perm_map        = (unsigned int *)vrna_alloc(sizeof(unsigned int) * mem_tasks);
+  num_tasks       = 0;
+  cnt             = 0;
+
+  for (k = 1; k <= max_strands; k++) {
+    for (c = 0; complexes[k][c]; c++, cnt++) {
+      unsigned int  *species, *species_count, **necklaces;
+      size_t        known_species = 0;
+
+      species       = (unsigned int *)vrna_alloc(sizeof(unsigned int) * (k + 1));
+      species_count = (unsigned int *)vrna_alloc(sizeof(unsigned int) * fc->strands);
+      mapping[cnt]  = (unsigned int *)vrna_alloc(sizeof(unsigned int) * fc->strands);
+
+      for (kk = 0; kk < k; kk++)
+        species_count[complexes[k][c][kk]]++;
+
+      for (kk = 0; kk < fc->strands; kk++)
+        if (species_count[kk] > 0) {
+          mapping[cnt][known_species] = kk;
+          species[known_species]      = species_count[kk];
+          known_species++;
+        }
+
+      species[known_species] = 0;
+
+      /* all non-cyclic permutations of the current complex */
+      necklaces         = vrna_enumerate_necklaces(species);
+      first_task[cnt]       = num_tasks;
+      complex_size[cnt]     = k;
+      complex_strands[cnt]  = complexes[k][c];
+
+      for (i = 0; necklaces[i]; i++) {
+        if (num_tasks == mem_tasks) {
+          mem_tasks *= 2;
+          perm      = (unsigned int **)vrna_realloc(perm, sizeof(unsigned int *) * mem_tasks);
+          perm_map  = (unsigned int *)vrna_realloc(perm_map, sizeof(unsigned int) * mem_tasks);
+        }
+
+        perm[num_tasks]     = necklaces[i];
+        perm_map[num_tasks] = cnt;
+        num_tasks++;
+      }
+
+      free(necklaces);
+      free(species);
+      free(species_count);
+    }
+  }
+
+  first_task[cnt] = num_tasks;
+
+  /*
+   *  Now, compute the ensemble free energy of each permutation. Larger
+   *  complexes are enumerated last but take longest, so we process the
+   *  task list backwards to keep all threads busy until the end.
+   */
+  F       = (double *)vrna_alloc(sizeof(double) * (num_tasks + 1));
+  failed  = 0;
+  done    = 0;
+
+  /* the number of permutations of each complex that are still to be processed */
+  remaining = (size_t *)vrna_alloc(sizeof(size_t) * (num_complexes + 1));
+  for (cnt = 0; cnt < num_complexes; cnt++)
+    remaining[cnt] = first_task[cnt + 1] - first_task[cnt];
+
+#ifdef _OPENMP
+  if (jobs <= 0)
+    jobs = omp_get_max_threads();
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(jobs)
+#else
+  (void)jobs;
+#endif
+  for (long t = (long)num_tasks - 1; t >= 0; t--) {
+    unsigned int          *p, *map;
+    char                  *sequence;
+    size_t                left;
+    double                mfe;
+    vrna_fold_compound_t  *fc_perm;
+
+    p         = perm[t];
+    map       = mapping[perm_map[t]];
+    sequence  = vrna_strdup_printf("%s", fc->nucleotides[map[p[1]]].string);
+
+    for (size_t j = 2; j <= complex_size[perm_map[t]]; j++)
+      vrna_strcat_printf(&sequence, "&%s", fc->nucleotides[map[p[j]]].string);
+
+    fc_perm = vrna_fold_compound(sequence, &md, VRNA_OPTION_DEFAULT);
+
+    if (!fc_perm) {
+      vrna_message_warning("vrna_pf_complexes@part_func.c: "
+                           "Failed to create vrna_fold_compound for permutation %ld",
+                           t);
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+      failed = 1;
+    } else {
+      mfe = (double)vrna_mfe(fc_perm, NULL);
+
+      vrna_exp_params_rescale(fc_perm, &mfe);
+
+      F[t] = (double)vrna_pf(fc_perm, NULL);
+
+      vrna_fold_compound_free(fc_perm);
+    }
+
+    free(sequence);
+
+    if (cb) {
+      /* the last permutation of a complex to finish reports the complex */
+#ifdef _OPENMP
+#pragma omp atomic capture
+#endif
+      left = --remaining[perm_map[t]];
+
+      if (left == 0) {
+#ifdef _OPENMP
+#pragma omp critical (pf_complexes_progress)
+#endif
+        {
+          done++;
+          cb(done,
+             num_complexes,
+             complex_strands[perm_map[t]],
+             complex_size[perm_map[t]],
+             data);
+        }
+      }
+    }
+  }
+
+  /* add up the permutations of each complex in enumeration order */
+  cnt = 0;
+  for (k = 1; (!failed) && (k <= max_strands); k++) {
+    for (c = 0; complexes[k][c]; c++);
+
+    dG[k] = (double *)vrna_alloc(sizeof(double) * (c + 1));
+
+    for (c = 0; complexes[k][c]; c++, cnt++) {
+      dG[k][c] = 0.;
+      for (i = first_task[cnt]; i < first_task[cnt + 1]; i++)
+        dG[k][c] = (i == first_task[cnt]) ? F[i] : vrna_pf_add(dG[k][c], F[i], kT);
+    }
+  }
+
+  for (i = 0; i < num_tasks; i++)
+    free(perm[i]);
+
+  for (i = 0; i < num_complexes; i++)
+    free(mapping[i]);
+
+  free(perm);
+  free(perm_map);
+  free(mapping);
+  free(first_task);
+  free(complex_size);
+  free(complex_strands);
+  free(remaining);
+  free(F);
+
+  if (failed) {
+    free(dG);
+    dG = NULL;
+  }
+
+  return dG;
+}
+
+
+/*
+ #################################
+ # STATIC helper functions below #
+ #################################
+ */
+PRIVATE FLT_OR_DBL
+pf_region(vrna_fold_compound_t  *fc,
+          int                   from,
+          int                   to,
+          char                  *structure)
+{
+  int               n, keep;
+  FLT_OR_DBL        Q, Z_old, dG;
+  vrna_md_t         *md;
+  vrna_exp_param_t  *params;
+  vrna_mx_pf_t      *matrices;
+
+  dG = (FLT_OR_DBL)(INF / 100.);
+
+  if (fc) {
     n         = fc->length;
     params    = fc->exp_params;
     matrices  = fc->exp_matrices;
     md        = &(params->model_details);
 
+    /*
+     *  Only base pairs (k,l) with k < from and l > to may keep their
+     *  outside contributions from a previous computation, since their
+     *  outside part does not include any of the changed nucleotides
+     */
+    keep  = ((md->compute_bpp) && (matrices->probs) && (from > 1) && (to < n)) ? 1 : 0;
+    Z_old = (keep) ? matrices->q[fc->iindx[1] - n] : 0.;
+
+    if (keep)
+      keep_outside_prepare(fc, from, to);
+
 #ifdef _OPENMP
     /* Explicitly turn off dynamic threads */
     omp_set_dynamic(0);
@@ -125,7 +568,7 @@ vrna_pf(vrna_fold_compound_t  *fc,
     if ((fc->aux_grammar) && (fc->aux_grammar->cb_proc))
       fc->aux_grammar->cb_proc(fc, VRNA_STATUS_PF_PRE, fc->aux_grammar->data);
 
-    if (!fill_arrays(fc)) {
+    if (!fill_arrays(fc, from, to)) {
 #ifdef SUN4
       standard_arithmetic();
 #elif defined(HP9)
@@ -185,7 +628,11 @@ vrna_pf(vrna_fold_compound_t  *fc,
 
     /* calculate base pairing probability matrix (bppm)  */
     if (md->compute_bpp) {
-      vrna_pairing_probs(fc, structure);
+      if ((keep) &&
+          (keep_outside_finish(fc, from, to, Z_old / matrices->q[fc->iindx[1] - n])))
+        vrna_pairing_probs_update(fc, (unsigned int)from, (unsigned int)to, structure);
+      else
+        vrna_pairing_probs(fc, structure);
 
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
@@ -210,95 +657,16 @@ vrna_pf(vrna_fold_compound_t  *fc,
 }
 
 
-PUBLIC vrna_dimer_pf_t
-vrna_pf_dimer(vrna_fold_compound_t  *fc,
-              char                  *structure)
-{
-  vrna_dimer_pf_t X;
-
-  X.F0AB = X.FAB = X.FcAB = X.FA = X.FB = 0.;
-
-  if (fc) {
-    (void)vrna_pf(fc, structure);
-
-    /* backward compatibility partition function and ensemble energy computation */
-    extract_dimer_props(fc,
-                        &(X.F0AB),
-                        &(X.FAB),
-                        &(X.FcAB),
-                        &(X.FA),
-                        &(X.FB));
-  }
-
-  return X;
-}
-
-
-PUBLIC int
-vrna_pf_float_precision(void)
-{
-  return sizeof(FLT_OR_DBL) == sizeof(float);
-}
-
-
-PUBLIC FLT_OR_DBL *
-vrna_pf_substrands(vrna_fold_compound_t *fc,
-                   size_t               complex_size)
-{
-  FLT_OR_DBL *Q_sub = NULL;
-
-  if ((fc) &&
-      (fc->strands >= complex_size) &&
-      (fc->exp_matrices) &&
-      (fc->exp_matrices->q)) {
-    unsigned int      *ss, *se, *so;
-    FLT_OR_DBL        Q;
-    vrna_exp_param_t  *params;
-    vrna_mx_pf_t      *matrices;
-
-    ss        = fc->strand_start;
-    se        = fc->strand_end;
-    so        = fc->strand_order;
-    params    = fc->exp_params;
-    matrices  = fc->exp_matrices;
-
-    Q_sub = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (fc->strands - complex_size + 1));
-
-    for (size_t i = 0; i < fc->strands - complex_size + 1; i++) {
-      size_t start, end;
-      start     = ss[so[i]];
-      end       = se[so[i + complex_size - 1]];
-      Q         = matrices->q[fc->iindx[start] - end];
-      Q_sub[i]  = (-log(Q) - (end - start + 1) * log(params->pf_scale)) *
-                  params->kT /
-                  1000.0;
-    }
-  }
-
-  return Q_sub;
-}
-
-
-PUBLIC FLT_OR_DBL
-vrna_pf_add(FLT_OR_DBL  dG1,
-            FLT_OR_DBL  dG2,
-            double      kT)
-{
-  double  x1  = -(double)dG1 / kT;
-  double  x2  = -(double)dG2 / kT;
-  double  xs  = MAX2(x1, x2);
-
-  return -kT * (xs + log(exp(x1 - xs) + exp(x2 - xs)));
-}
-
-
 /*
- #################################
- # STATIC helper functions below #
- #################################
+ *  Fill the DP matrices for all segments [i, j] that overlap with
+ *  [from, to]. All other segments are assumed to be unchanged since
+ *  the last call, so we only update the auxiliary arrays for them.
+ *  A full fill is simply the case from = 1, to = n.
  */
 PRIVATE int
-fill_arrays(vrna_fold_compound_t *fc)
+fill_arrays(vrna_fold_compound_t  *fc,
+            int                   from,
+            int                   to)
 {
   int                 n, i, j, k, ij, *my_iindx, *jindx, with_gquad, with_ud;
   FLT_OR_DBL          temp, Qmax, *q, *qb, *qm, *qm1, *q1k, *qln;
@@ -369,7 +737,17 @@ fill_arrays(vrna_fold_compound_t *fc)
   }
 
   for (j = 2; j <= n; j++) {
-    for (i = j - 1; i >= 1; i--) {
+    i = j - 1;
+
+    /* segments [i, j] not overlapping with [from, to] remain as they are */
+    if ((j < from) || (i > to)) {
+      k = (j < from) ? 1 : to + 1;
+      vrna_exp_E_ext_fast_aux_update(fc, k, j, aux_mx_el);
+      vrna_exp_E_ml_fast_aux_update(fc, k, j, aux_mx_ml);
+      i = k - 1;
+    }
+
+    for (; i >= 1; i--) {
       ij = my_iindx[i] - j;
 
       qb[ij] = decompose_pair(fc, i, j, aux_mx_ml);
@@ -434,6 +812,82 @@ fill_arrays(vrna_fold_compound_t *fc)
 }
 
 
+/*
+ *  Base pairs (k,l) that enclose the changed region [from, to] keep
+ *  their outside contributions. Here, we convert their probabilities
+ *  back into outside contributions (divided by the previous partition
+ *  function) before the inside matrices are overwritten. Pairs that
+ *  have been impossible so far are marked, since nothing is known about
+ *  their outside contributions.
+ */
+PRIVATE void
+keep_outside_prepare(vrna_fold_compound_t *fc,
+                     int                  from,
+                     int                  to)
+{
+  int         k, l, n, kl, *my_iindx, *jindx, *pscore;
+  FLT_OR_DBL  *qb, *probs;
+  double      kTn;
+
+  n         = (int)fc->length;
+  my_iindx  = fc->iindx;
+  jindx     = fc->jindx;
+  pscore    = (fc->type == VRNA_FC_TYPE_COMPARATIVE) ? fc->pscore : NULL;
+  kTn       = fc->exp_params->kT / 10.; /* kT in cal/mol */
+  qb        = fc->exp_matrices->qb;
+  probs     = fc->exp_matrices->probs;
+
+  for (k = 1; k < from; k++)
+    for (l = to + 1; l <= n; l++) {
+      kl = my_iindx[k] - l;
+
+      if (qb[kl] > 0.) {
+        probs[kl] /= qb[kl];
+
+        if (pscore)
+          probs[kl] /= exp(-pscore[jindx[l] + k] / kTn);
+      } else {
+        probs[kl] = -1.;
+      }
+    }
+}
+
+
+/*
+ *  Re-scale the kept outside contributions to the new partition
+ *  function. Returns 0 if any of the previously impossible pairs
+ *  became possible, i.e. the full outside algorithm is required.
+ */
+PRIVATE int
+keep_outside_finish(vrna_fold_compound_t  *fc,
+                    int                   from,
+                    int                   to,
+                    FLT_OR_DBL            rescale)
+{
+  int         k, l, n, kl, *my_iindx;
+  FLT_OR_DBL  *qb, *probs;
+
+  n         = (int)fc->length;
+  my_iindx  = fc->iindx;
+  qb        = fc->exp_matrices->qb;
+  probs     = fc->exp_matrices->probs;
+
+  for (k = 1; k < from; k++)
+    for (l = to + 1; l <= n; l++) {
+      kl = my_iindx[k] - l;
+
+      if (qb[kl] == 0.)
+        probs[kl] = 0.;
+      else if (probs[kl] < 0.)
+        return 0;
+      else
+        probs[kl] *= rescale;
+    }
+
+  return 1;
+}
+
+
 PRIVATE FLT_OR_DBL
 decompose_pair(vrna_fold_compound_t *fc,
                int                  i,
@@ -149,6 +149,46 @@ vrna_pf(vrna_fold_compound_t  *vc,
         char                  *structure);
 
 
+/**
+ *  @brief  Update the partition function @f$Q@f$ after a local change of constraints
+ *
+ *  This function yields the same results as vrna_pf() but assumes that, compared to
+ *  the last call of vrna_pf() or vrna_pf_update() for @p fc, only the constraints of
+ *  nucleotides within the region @f$ [i, j] @f$ have been changed. Only segments
+ *  @f$ [p, q] @f$ of the partition function matrices that overlap with this region
+ *  are then re-computed. If the model's compute_bpp is set, base pairs that enclose
+ *  the region keep their outside contributions and only need to be re-scaled, see
+ *  vrna_pairing_probs_update(). This speeds up scans that repeatedly change hard or
+ *  soft constraints of a small window, e.g. to block or probe one window after the
+ *  other.
+ *
+ *  The region must cover all nucleotides whose constraints have been changed, i.e.
+ *  a base pair constraint @f$ (p, q) @f$ requires @f$ i \le p @f$ and @f$ q \le j @f$.
+ *  Generic soft constraint callbacks must only depend on nucleotides within the
+ *  segment they are evaluated for. The function falls back to a full re-computation
+ *  whenever results of a previous computation can not be re-used, e.g. if the DP
+ *  matrices have been re-allocated, the Boltzmann factors or their scaling changed,
+ *  or for multi-strand fold compounds.
+ *
+ *  @note The last computation for @p fc must have been done with the same model
+ *        settings, in particular the same compute_bpp setting, as the current one.
+ *
+ *  @see  vrna_pf(), vrna_pairing_probs_update(), vrna_hc_add_up(), vrna_sc_set_up()
+ *
+ *  @param[in,out]  fc          The fold compound data structure
+ *  @param          i           The first nucleotide of the changed region (1-based)
+ *  @param          j           The last nucleotide of the changed region (1-based)
+ *  @param[in,out]  structure   A pointer to the character array where position-wise pairing propensity
+ *                              will be stored. (Maybe NULL)
+ *  @return         The ensemble free energy @f$G = -RT \cdot \log(Q) @f$ in kcal/mol
+ */
+FLT_OR_DBL
+vrna_pf_update(vrna_fold_compound_t *fc,
+               unsigned int         i,
+               unsigned int         j,
+               char                 *structure);
+
+
 /**
  *  @brief  Calculate partition function and base pair probabilities of
  *          nucleic acid/nucleic acid dimers
@@ -181,6 +221,96 @@ vrna_pf_add(FLT_OR_DBL  dG1,
             FLT_OR_DBL  dG2,
             double      kT);
 
+
+/**
+ *  @brief  Compute the ensemble free energies of a set of complexes formed by the strands of a fold compound
+ *
+ *  For each complex, all non-cyclic permutations of its strands are enumerated with
+ *  vrna_enumerate_necklaces(), and the ensemble free energies of the individual
+ *  permutations are added up to yield the ensemble free energy of the complex.
+ *  The permutations are independent of each other and are evaluated concurrently
+ *  using @p jobs threads if the library has been compiled with OpenMP support.
+ *  The result does not depend on the number of threads, since the contributions of
+ *  the permutations are always summed up in enumeration order.
+ *
+ *  The complexes are given as lists of strand numbers (starting at 0) for each complex
+ *  size @f$ 1 \le k \le @f$ @p max_strands, e.g. as obtained from vrna_n_multichoose_k().
+ *  The list @p complexes[k] contains the complexes of size @f$ k @f$ and is terminated by
+ *  a @p NULL pointer. Index 0 of @p complexes is not accessed.
+ *
+ *  The returned array uses the same layout, i.e. the free energy of complex @p complexes[k][c]
+ *  is stored in @p dG[k][c]. The caller is responsible to free the array and all its entries.
+ *
+ *  @note Only single sequence fold compounds are supported. Constraints and other modifications
+ *        of @p fc do not apply to the complexes.
+ *
+ *  @see  vrna_pf_complexes_cb(), vrna_n_multichoose_k(), vrna_enumerate_necklaces(),
+ *        vrna_equilibrium_constants()
+ *
+ *  @param  fc          The fold compound of the (multi-strand) input
+ *  @param  complexes   The complexes to evaluate, indexed by size (1-based)
+ *  @param  max_strands The largest complex size in @p complexes
+ *  @param  md_p        The model details used for the complexes (may be @p NULL to use those of @p fc)
+ *  @param  jobs        The number of threads (<= 0 to use the OpenMP default)
+ *  @return             The ensemble free energies (kcal/mol) of the complexes, or @p NULL on any error
+ */
+double **
+vrna_pf_complexes(vrna_fold_compound_t  *fc,
+                  unsigned int          ***complexes,
+                  size_t                max_strands,
+                  const vrna_md_t       *md_p,
+                  int                   jobs);
+
+
+/**
+ *  @brief  Callback to follow the progress of vrna_pf_complexes_cb()
+ *
+ *  This callback is executed once for each complex as soon as the ensemble free
+ *  energies of all its permutations are available. Complexes finish in arbitrary
+ *  order if several threads are used, but the callback is never executed
+ *  concurrently.
+ *
+ *  @see  vrna_pf_complexes_cb()
+ *
+ *  @param  done      The number of complexes finished so far, including the current one
+ *  @param  total     The total number of complexes
+ *  @param  strands   The strand numbers of the current complex
+ *  @param  size      The number of strands in the current complex
+ *  @param  data      The data pointer passed to vrna_pf_complexes_cb()
+ */
+typedef void (vrna_callback_pf_complexes)(size_t              done,
+                                          size_t              total,
+                                          const unsigned int  *strands,
+                                          size_t              size,
+                                          void                *data);
+
+
+/**
+ *  @brief  Compute the ensemble free energies of a set of complexes and report the progress
+ *
+ *  Same as vrna_pf_complexes() but executes the callback @p cb whenever a complex is
+ *  finished, e.g. to print progress information.
+ *
+ *  @see  vrna_pf_complexes(), #vrna_callback_pf_complexes
+ *
+ *  @param  fc          The fold compound of the (multi-strand) input
+ *  @param  complexes   The complexes to evaluate, indexed by size (1-based)
+ *  @param  max_strands The largest complex size in @p complexes
+ *  @param  md_p        The model details used for the complexes (may be @p NULL to use those of @p fc)
+ *  @param  jobs        The number of threads (<= 0 to use the OpenMP default)
+ *  @param  cb          The progress callback (may be @p NULL)
+ *  @param  data        An arbitrary data pointer passed through to @p cb
+ *  @return             The ensemble free energies (kcal/mol) of the complexes, or @p NULL on any error
+ */
+double **
+vrna_pf_complexes_cb(vrna_fold_compound_t       *fc,
+                     unsigned int               ***complexes,
+                     size_t                     max_strands,
+                     const vrna_md_t            *md_p,
+                     int                        jobs,
+                     vrna_callback_pf_complexes *cb,
+                     void                       *data);
+
 /* End basic global interface */
 /**@}*/
 
@@ -246,6 +376,37 @@ vrna_pf_circfold(const char *sequence,
                  vrna_ep_t  **pl);
 
 
+/**
+ *  @brief  Compute Partition function @f$Q@f$ (and base pair probabilities) for many RNA sequences
+ *
+ *  This simplified interface to vrna_pf() processes a NULL-terminated list of sequences
+ *  independently of each other, using the same model details @p md for each of them. The
+ *  ensemble free energy of the i-th sequence is stored in @p energies[i]. If @p structures
+ *  is not NULL, @p structures[i] will point to a newly allocated string holding the position-wise
+ *  pairing propensity that must be free'd by the caller. Otherwise, base pair probabilities are
+ *  not computed at all. Sequences for which no #vrna_fold_compound_t could be created receive
+ *  an energy of #INF / 100. and a NULL structure.
+ *
+ *  @note   Computations are distributed among @p jobs threads if the library has been
+ *          compiled with OpenMP support.
+ *
+ *  @see vrna_pf_fold(), vrna_pf(), vrna_fold_batch()
+ *
+ *  @param sequences  A NULL-terminated list of RNA sequences
+ *  @param md         The model details to use (Maybe NULL)
+ *  @param structures An array of size n to store the pairing propensities in (Maybe NULL)
+ *  @param energies   An array of size n to store the ensemble free energies in kcal/mol in
+ *  @param jobs       The number of threads (<= 0 to use the OpenMP default)
+ *  @return           The number of sequences n
+ */
+int
+vrna_pf_fold_batch(const char **sequences,
+                   vrna_md_t  *md,
+                   char       **structures,
+                   float      *energies,
+                   int        jobs);
+
+
 /**
  *  @brief  Compute Partition function @f$Q@f$ (and base pair probabilities) for an RNA
  *          sequence alignment using a comparative method
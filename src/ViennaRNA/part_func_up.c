@@ -71,6 +71,7 @@
 #include "ViennaRNA/loops/all.h"
 #include "ViennaRNA/part_func_up.h"
 #include "ViennaRNA/duplex.h"
+#include "ViennaRNA/alphabet.h"
 
 
 #define CO_TURN 0
@@ -85,23 +86,32 @@
  #################################
  */
 
+/*
+ *  All data required by a single call of the unstructuredness or
+ *  interaction recursions. Keeping it here instead of in module-level
+ *  variables allows for concurrent computations
+ */
+struct up_data {
+  vrna_exp_param_t  *Pf;            /* Boltzmann weights */
+  double            pf_scale;       /* scaling factor used for the scale[] and expMLbase[] arrays */
+  int               no_closingGU;
+  short             *S1;            /* numerical encoding of the sequence (alias) */
+  char              *ptype;         /* precomputed array of pair types (my_iindx) */
+  FLT_OR_DBL        *qb, *qm, *q1k, *qln, *probs;
+  FLT_OR_DBL        *prpr;          /* add arrays for pf_unpaired()*/
+  double            *qqm2, *qq_1m2, *qqm, *qqm1;
+  FLT_OR_DBL        *scale, *expMLbase;
+  int               *my_iindx;
+};
+
+
 /*
  #################################
  # PRIVATE VARIABLES             #
  #################################
  */
-PRIVATE short             *S = NULL, *S1 = NULL, *SS = NULL, *SS2 = NULL;
-PRIVATE vrna_exp_param_t  *Pf = NULL;                           /* use this structure for all the exp-arrays*/
-PRIVATE FLT_OR_DBL        *qb = NULL, *qm = NULL, *prpr = NULL; /* add arrays for pf_unpaired()*/
-PRIVATE FLT_OR_DBL        *probs = NULL;
-PRIVATE FLT_OR_DBL        *q1k = NULL, *qln = NULL;
-PRIVATE double            *qqm2 = NULL, *qq_1m2 = NULL, *qqm = NULL, *qqm1 = NULL;
-PRIVATE FLT_OR_DBL        *scale = NULL, *expMLbase = NULL;
-PRIVATE char              *ptype = NULL;  /* precomputed array of pair types */
-PRIVATE int               init_length;    /* length in last call to init_pf_fold()*/
-PRIVATE double            init_temp;      /* temperature in last call to scale_pf_params */
-PRIVATE int               *my_iindx = NULL;
-/* make iptypes array for intermolecular constrains (ipidx for indexing)*/
+PRIVATE vrna_exp_param_t  *Pf = NULL; /* energy parameters of the backward compatibility interface */
+PRIVATE double            init_temp;  /* temperature in last call to scale_pf_params */
 
 
 /*
@@ -123,41 +133,56 @@ plot_free_pu_out(pu_out   *res,
 
 
 PRIVATE void
-scale_stru_pf_params(unsigned int length);
+scale_stru_pf_params(void);
 
 
 PRIVATE void
-init_pf_two(int length);
+scale_arrays(struct up_data *d,
+             unsigned int   length);
 
 
 PRIVATE void
-scale_int(const char  *s,
-          const char  *sl,
-          double      *sc_int);
+init_pf_two(struct up_data *d);
 
 
 PRIVATE void
-encode_seq(const char *s1,
-           const char *s2);
+scale_int(struct up_data  *d,
+          const char      *s,
+          const char      *sl,
+          double          *sc_int);
 
 
 PRIVATE constrain *
 get_ptypes_up(char        *S,
-              const char  *structure);
+              const char  *structure,
+              vrna_md_t   *md);
 
 
 PRIVATE void
-get_up_arrays(unsigned int length);
+get_up_arrays(struct up_data  *d,
+              unsigned int    length);
 
 
 PRIVATE void
-free_up_arrays(void);
+free_up_arrays(struct up_data *d);
 
 
-PRIVATE void
-set_encoded_seq(const char  *sequence,
-                short       **S,
-                short       **S1);
+PRIVATE pu_contrib *
+unstru(struct up_data *d,
+       const char     *sequence,
+       int            w);
+
+
+PRIVATE interact *
+interaction(struct up_data  *d,
+            const char      *s1,
+            const char      *s2,
+            pu_contrib      *p_c,
+            pu_contrib      *p_c2,
+            int             w,
+            const char      *cstruc,
+            int             incr3,
+            int             incr5);
 
 
 PRIVATE void
@@ -239,13 +264,85 @@ PUBLIC pu_contrib *
 pf_unstru(char  *sequence,
           int   w)
 {
-  int           n, i, j, v, k, l, o, p, ij, kl, po, u, u1, d, type, type_2, tt;
-  unsigned int  size;
-  double        temp, tqm2;
-  double        qbt1, *tmp, sum_l, *sum_M;
-  double        *store_H, *store_Io, **store_I2o; /* hairp., interior contribs */
-  double        *store_M_qm_o, *store_M_mlbase;   /* multiloop contributions */
-  pu_contrib    *pu_test;
+  short           *S;
+  struct up_data  d;
+
+  memset(&d, 0, sizeof(struct up_data));
+
+  /* gets the arrays, that we need, from part_func.c */
+  if (!get_pf_arrays(&S, &(d.S1), &(d.ptype), &(d.qb), &(d.qm), &(d.q1k), &(d.qln)))
+    vrna_message_error("init_pf_two: pf_fold() has to be called before calling pf_unstru()\n");
+
+  init_pf_two(&d);
+
+  return unstru(&d, sequence, w);
+}
+
+
+PUBLIC pu_contrib *
+vrna_pf_unstru(vrna_fold_compound_t *fc,
+               int                  w)
+{
+  int             i, j, n, *my_iindx;
+  pu_contrib      *pu;
+  struct up_data  d;
+
+  if ((!fc) ||
+      (fc->type != VRNA_FC_TYPE_SINGLE) ||
+      (!fc->exp_matrices) ||
+      (fc->exp_matrices->type != VRNA_MX_DEFAULT) ||
+      (!fc->exp_matrices->probs)) {
+    vrna_message_warning("vrna_pf_unstru: "
+                         "Base pair probabilities of a single sequence must be computed first");
+    return NULL;
+  }
+
+  n         = (int)fc->length;
+  my_iindx  = fc->iindx;
+
+  memset(&d, 0, sizeof(struct up_data));
+  d.Pf            = fc->exp_params;
+  d.pf_scale      = fc->exp_params->pf_scale;
+  d.no_closingGU  = fc->exp_params->model_details.noGUclosure;
+  d.S1            = fc->sequence_encoding;
+  d.qb            = fc->exp_matrices->qb;
+  d.qm            = fc->exp_matrices->qm;
+  d.q1k           = fc->exp_matrices->q1k;
+  d.qln           = fc->exp_matrices->qln;
+  d.probs         = fc->exp_matrices->probs;
+
+  /* the recursions below require pair types in my_iindx order */
+  d.ptype = (char *)vrna_alloc(sizeof(char) * (((n + 1) * (n + 2)) / 2 + 1));
+  for (i = 1; i < n; i++)
+    for (j = i + 1; j <= n; j++)
+      d.ptype[my_iindx[i] - j] = fc->ptype[fc->jindx[j] + i];
+
+  pu = unstru(&d, fc->sequence, w);
+
+  free(d.ptype);
+
+  return pu;
+}
+
+
+PRIVATE pu_contrib *
+unstru(struct up_data *d,
+       const char     *sequence,
+       int            w)
+{
+  int               n, i, j, v, k, l, o, p, ij, kl, po, u, u1, dd, type, type_2, tt, *my_iindx;
+  unsigned int      size;
+  short             *S1;
+  char              *ptype;
+  double            temp, tqm2;
+  double            qbt1, *tmp, sum_l, *sum_M;
+  double            *store_H, *store_Io, **store_I2o; /* hairp., interior contribs */
+  double            *store_M_qm_o, *store_M_mlbase;   /* multiloop contributions */
+  double            *qqm2, *qq_1m2, *qqm, *qqm1;
+  FLT_OR_DBL        *qb, *qm, *q1k, *qln, *probs, *prpr, *scale, *expMLbase;
+  vrna_exp_param_t  *Pf;
+  vrna_md_t         *md;
+  pu_contrib        *pu_test;
 
   sum_l   = 0.0;
   temp    = 0;
@@ -254,16 +351,34 @@ pf_unstru(char  *sequence,
   pu_test = get_pu_contrib_struct((unsigned)n, (unsigned)w);
   size    = ((n + 1) * (n + 2)) >> 1;
 
-  get_up_arrays((unsigned)n);
-  init_pf_two(n);
+  get_up_arrays(d, (unsigned)n);
+  scale_arrays(d, (unsigned)n);
+
+  Pf        = d->Pf;
+  md        = &(Pf->model_details);
+  S1        = d->S1;
+  ptype     = d->ptype;
+  qb        = d->qb;
+  qm        = d->qm;
+  q1k       = d->q1k;
+  qln       = d->qln;
+  probs     = d->probs;
+  prpr      = d->prpr;
+  scale     = d->scale;
+  expMLbase = d->expMLbase;
+  qqm       = d->qqm;
+  qqm1      = d->qqm1;
+  qqm2      = d->qqm2;
+  qq_1m2    = d->qq_1m2;
+  my_iindx  = d->my_iindx;
 
   /* init everything */
-  for (d = 0; d <= TURN; d++)
-    for (i = 1; i <= n - d; i++) {
-      j   = i + d;
+  for (dd = 0; dd <= TURN; dd++)
+    for (i = 1; i <= n - dd; i++) {
+      j   = i + dd;
       ij  = my_iindx[i] - j;
-      if (d < w)
-        pu_test->H[i][d] = pu_test->I[i][d] = pu_test->M[i][d] = pu_test->E[i][d] = 0.;
+      if (dd < w)
+        pu_test->H[i][dd] = pu_test->I[i][dd] = pu_test->M[i][dd] = pu_test->E[i][dd] = 0.;
     }
 
 
@@ -308,7 +423,7 @@ pf_unstru(char  *sequence,
       type  = ptype[po];
       if (type) {
         /*hairpin contribution*/
-        if (((type == 3) || (type == 4)) && no_closingGU)
+        if (((type == 3) || (type == 4)) && d->no_closingGU)
           temp = 0.;
         else
           temp = prpr[po] *
@@ -330,7 +445,7 @@ pf_unstru(char  *sequence,
 
             temp = 0.;
             if (type_2) {
-              type_2  = rtype[type_2];
+              type_2  = md->rtype[type_2];
               temp    = prpr[po] * qb[kl] * exp_E_IntLoop(u1,
                                                           o - l - 1,
                                                           type,
@@ -380,7 +495,7 @@ pf_unstru(char  *sequence,
         qqm[p] += qbt1;
         /* reverse dangles for prpr[po]*... */
         temp  = 0.;
-        tt    = rtype[type];
+        tt    = md->rtype[type];
         temp  = prpr[po] * exp_E_MLstem(tt, S1[o - 1], S1[p + 1], Pf) * scale[2] * Pf->expMLclosing;
         for (i = p + 1; i < o; i++) {
           int p1i = (p + 1) < (i - 1)  ? my_iindx[p + 1] - (i - 1)  : 0;
@@ -492,7 +607,7 @@ pf_unstru(char  *sequence,
         qqm[p]  += qbt1;
         /* revers dangles for prpr[po]...  */
         temp  = 0.;
-        tt    = rtype[type];
+        tt    = md->rtype[type];
         temp  = prpr[po] * exp_E_MLstem(tt, S1[p - 1], S1[o + 1], Pf) * Pf->expMLclosing * scale[2];
       }
 
@@ -538,7 +653,7 @@ pf_unstru(char  *sequence,
 
   free(sum_M);
   free(store_M_mlbase);
-  free_up_arrays();
+  free_up_arrays(d);
   return pu_test;
 }
 
@@ -590,18 +705,90 @@ pf_interact(const char  *s1,
             int         incr3,
             int         incr5)
 {
-  int         i, j, k, l, n1, n2, add_i5, add_i3, pc_size;
-  double      temp, Z, rev_d, E, Z2, **p_c_S, **p_c2_S, int_scale;
-  FLT_OR_DBL  ****qint_4, **qint_ik;
+  interact        *Int;
+  struct up_data  d;
+
+  if (fold_constrained && cstruc == NULL)
+    vrna_message_error("option -C selected, but no constrained structure given\n");
+
+  scale_stru_pf_params();
+
+  memset(&d, 0, sizeof(struct up_data));
+  d.Pf = Pf;
+
+  Int = interaction(&d, s1, s2, p_c, p_c2, w, (fold_constrained) ? cstruc : NULL, incr3, incr5);
+
+  free_pf_arrays(); /* for arrays for pf_fold(...) */
+
+  return Int;
+}
+
+
+PUBLIC interact *
+vrna_pf_interact(const char *s1,
+                 const char *s2,
+                 pu_contrib *p_c,
+                 pu_contrib *p_c2,
+                 int        w,
+                 const char *cstruc,
+                 int        incr3,
+                 int        incr5,
+                 vrna_md_t  *md_p)
+{
+  interact        *Int;
+  vrna_md_t       md;
+  struct up_data  d;
+
+  if ((!s1) || (!s2) || (!p_c))
+    return NULL;
+
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  memset(&d, 0, sizeof(struct up_data));
+  d.Pf = vrna_exp_params(&md);
+
+  Int = interaction(&d, s1, s2, p_c, p_c2, w, cstruc, incr3, incr5);
+
+  free(d.Pf);
+
+  return Int;
+}
+
+
+PRIVATE interact *
+interaction(struct up_data  *d,
+            const char      *s1,
+            const char      *s2,
+            pu_contrib      *p_c,
+            pu_contrib      *p_c2,
+            int             w,
+            const char      *cstruc,
+            int             incr3,
+            int             incr5)
+{
+  int               i, j, k, l, n1, n2, add_i5, add_i3, pc_size, fold_constrained;
+  double            temp, Z, rev_d, E, Z2, **p_c_S, **p_c2_S, int_scale;
+  FLT_OR_DBL        ****qint_4, **qint_ik, *scale;
   /* PRIVATE double **pint; array for pf_up() output */
-  interact    *Int;
-  double      G_min, G_is, Gi_min;
-  int         gi, gj, gk, gl, ci, cj, ck, cl, prev_k, prev_l;
-  FLT_OR_DBL  **int_ik;
-  double      Z_int, temp_int, temppfs;
-  double      const_scale, const_T;
-  constrain   *cc = NULL;                           /* constrains for cofolding */
-  char        *Seq, *i_long, *i_short, *pos = NULL; /* short seq appended to long one */
+  interact          *Int;
+  double            G_min, G_is, Gi_min;
+  int               gi, gj, gk, gl, ci, cj, ck, cl, prev_k, prev_l;
+  FLT_OR_DBL        **int_ik;
+  double            Z_int, temp_int;
+  double            const_scale, const_T;
+  short             *S1, *SS2;
+  constrain         *cc = NULL;                           /* constrains for cofolding */
+  char              *Seq, *i_long, *i_short;              /* short seq appended to long one */
+  const char        *pos = NULL;
+  vrna_exp_param_t  *Pf;
+  vrna_md_t         *md;
+
+  Pf                = d->Pf;
+  md                = &(Pf->model_details);
+  fold_constrained  = (cstruc != NULL) ? 1 : 0;
 
   /* int ***pu_jl; */ /* positions of interaction in the short RNA */
 
@@ -620,10 +807,10 @@ pf_interact(const char  *s1,
   strcpy(Seq, s1);
   strcat(Seq, s2);
 
-  set_encoded_seq(s1, &S, &S1);
-  set_encoded_seq(s2, &SS, &SS2);
+  S1  = vrna_seq_encode(s1, md);
+  SS2 = vrna_seq_encode(s2, md);
 
-  cc = get_ptypes_up(Seq, cstruc);
+  cc = get_ptypes_up(Seq, cstruc, md);
 
   get_interact_arrays(n1, n2, p_c, p_c2, w, incr5, incr3, &p_c_S, &p_c2_S);
 
@@ -633,16 +820,13 @@ pf_interact(const char  *s1,
   Int->Gi = (double *)vrna_alloc(sizeof(double) * (n1 + 2));
 
   /* use a different scaling for pf_interact*/
-  scale_int(s2, s1, &int_scale);
-
-  /* set the global scale array and the global variable pf_scale to the
-   * values used to scale the interaction, keep their former values !! */
-  temppfs   = pf_scale;
-  pf_scale  = int_scale;
+  scale_int(d, s2, s1, &int_scale);
 
   /* in order to scale expLoopEnergy correctly call*/
   /* we also pass twice the seq-length to avoid bogus access to scale[] array */
-  scale_stru_pf_params((unsigned)2 * n1);
+  d->pf_scale = int_scale;
+  scale_arrays(d, (unsigned)2 * n1);
+  scale = d->scale;
 
   qint_ik = (FLT_OR_DBL **)vrna_alloc(sizeof(FLT_OR_DBL *) * (n1 + 1));
   for (i = 1; i <= n1; i++)
@@ -653,16 +837,14 @@ pf_interact(const char  *s1,
     int_ik[i] = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * (n1 + 1));
   Z_int = 0.;
   /*  Gint = ( -log(int_ik[gk][gi])-( ((int) w/2)*log(pf_scale)) )*((Pf->temperature+K0)*GASCONST/1000.0); */
-  const_scale = ((int)w / 2) * log(pf_scale);
+  const_scale = ((int)w / 2) * log(d->pf_scale);
   const_T     = (Pf->kT / 1000.0);
-  encode_seq(s1, s2);
-  /* static  short *S~S1, *S1~SS1, *SS~S2, *SS2; */
   for (i = 0; i <= n1; i++)
     Int->Pi[i] = Int->Gi[i] = 0.;
   E = 0.;
   Z = 0.;
 
-  if (fold_constrained && cstruc != NULL) {
+  if (fold_constrained) {
     pos = strchr(cstruc, '|');
     if (pos) {
       ci = ck = cl = cj = 0;
@@ -703,8 +885,6 @@ pf_interact(const char  *s1,
         vrna_message_error("pf_interact: could not satisfy all constraints");
       }
     }
-  } else if (fold_constrained && cstruc == NULL) {
-    vrna_message_error("option -C selected, but no constrained structure given\n");
   }
 
   if (fold_constrained)
@@ -766,7 +946,7 @@ pf_interact(const char  *s1,
                                           (j < n2) ? SS2[j + 1] : -1,
                                           Pf);
 
-      rev_d = vrna_exp_E_ext_stem(rtype[type], (j > 1) ? SS2[j - 1] : -1, (i < n1) ? S1[i + 1] : -1, Pf);
+      rev_d = vrna_exp_E_ext_stem(md->rtype[type], (j > 1) ? SS2[j - 1] : -1, (i < n1) ? S1[i + 1] : -1, Pf);
 
       /* add inc5 and incr3 */
       if ((i - incr5) > 0)
@@ -842,7 +1022,7 @@ pf_interact(const char  *s1,
           if (i - k + l - j - 2 <= MAXLOOP) {
             if (k >= prev_k && l <= prev_l) {
               /* don't violate constrains */
-              E = exp_E_IntLoop(i - k - 1, l - j - 1, type2, rtype[type],
+              E = exp_E_IntLoop(i - k - 1, l - j - 1, type2, md->rtype[type],
                                 S1[k + 1], SS2[l - 1], S1[i - 1], SS2[j + 1], Pf) *
                   scale[i - k + l - j]; /* add *scale[u1+u2+2] */
 
@@ -964,7 +1144,7 @@ pf_interact(const char  *s1,
         Int->Pi[l] += qint_ik[i][k] / Z;
         /* Int->Gi[l]: minimal delta G at position [l] */
         Int->Gi[l] = MIN2(Int->Gi[l],
-                          (-log(qint_ik[i][k]) - (((int)w / 2) * log(pf_scale))) *
+                          (-log(qint_ik[i][k]) - (((int)w / 2) * log(d->pf_scale))) *
                           (Pf->kT / 1000.0));
       }
     }
@@ -1035,20 +1215,10 @@ pf_interact(const char  *s1,
     free(qint_ik[i]);
   free(qint_ik);
 
-  /* reset the global variables pf_scale and scale to their original values */
-  pf_scale = temppfs;                 /* reset pf_scale */
-  scale_stru_pf_params((unsigned)n1); /* reset the scale array */
-  free_pf_arrays();                   /* for arrays for pf_fold(...) */
-
-  if (expMLbase != NULL) {
-    free(expMLbase);
-    expMLbase = NULL;
-  }
-
-  if (scale != NULL) {
-    free(scale);
-    scale = NULL;
-  }
+  free(d->expMLbase);
+  free(d->scale);
+  d->expMLbase  = NULL;
+  d->scale      = NULL;
 
   for (i = 1; i <= n1; i++)
     free(p_c_S[i]);
@@ -1060,6 +1230,8 @@ pf_interact(const char  *s1,
   }
 
   free(Seq);
+  free(S1);
+  free(SS2);
   free(cc->indx);
   free(cc->ptype);
   free(cc);
@@ -1070,43 +1242,47 @@ pf_interact(const char  *s1,
 /*------------------------------------------------------------------------*/
 /* use an extra scale for pf_interact, here sl is the longer sequence */
 PRIVATE void
-scale_int(const char  *s,
-          const char  *sl,
-          double      *sc_int)
+scale_int(struct up_data  *d,
+          const char      *s,
+          const char      *sl,
+          double          *sc_int)
 {
-  int     n, nl;
-  duplexT mfe;
-  double  kT;
+  int               n, nl;
+  duplexT           mfe;
+  double            kT;
+  vrna_duplex_t     dup;
 
   n   = strlen(s);
   nl  = strlen(sl);
 
-  free(expMLbase);
-  free(scale);
+  free(d->expMLbase);
+  free(d->scale);
 
-  expMLbase = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * ((nl + 1) * 2));
-  scale     = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * ((nl + 1) * 2));
+  d->expMLbase  = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * ((nl + 1) * 2));
+  d->scale      = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * ((nl + 1) * 2));
 
   /* use RNA duplex to get a realistic estimate for the best possible
    * interaction energy between the short RNA s and its target sl */
-  mfe = duplexfold(s, sl);
+  dup = vrna_duplex_init(&(d->Pf->model_details));
+  mfe = vrna_duplex_mfe(dup, s, sl);
+  vrna_duplex_free(dup);
 
-  kT = Pf->kT / 1000.0; /* in Kcal */
+  kT = d->Pf->kT / 1000.0; /* in Kcal */
 
   /* sc_int is similar to pf_scale: i.e. one time the scale */
   *sc_int = exp(-(mfe.energy) / kT / n);
 
-  /* free the structure returned by duplexfold */
+  /* free the structure returned by vrna_duplex_mfe() */
   free(mfe.structure);
 }
 
 
 /*----------------------------------------------------------------------*/
-/* init_pf_two(n) :gets the arrays, that you need, from part_func.c */
-/* get_pf_arrays(&S, &S1, &ptype, &qb, &qm, &q1k, &qln);*/
+/* init_pf_two(d) :gets the parameters, that you need, for the arrays from part_func.c */
+/* get_pf_arrays(&S, &S1, &ptype, &qb, &qm, &q1k, &qln) has been called by pf_unstru() */
 /* init_pf_fold(), update_pf_params, encode_char(), make_ptypes() are called by pf_fold() */
 PRIVATE void
-init_pf_two(int length)
+init_pf_two(struct up_data *d)
 {
 #ifdef SUN4
   nonstandard_arithmetic();
@@ -1117,96 +1293,64 @@ init_pf_two(int length)
 #endif
   make_pair_matrix();
 
-  /* gets the arrays, that we need, from part_func.c */
-  if (!get_pf_arrays(&S, &S1, &ptype, &qb, &qm, &q1k, &qln))
-    vrna_message_error("init_pf_two: pf_fold() has to be called before calling pf_unstru()\n");
-
   /* get a pointer to the base pair probs */
-  probs = export_bppm();
+  d->probs = export_bppm();
+
+  scale_stru_pf_params();
 
-  scale_stru_pf_params((unsigned)length);
+  d->Pf           = Pf;
+  d->pf_scale     = pf_scale;
+  d->no_closingGU = no_closingGU;
 
-  init_length = length;
   if (init_temp != Pf->temperature)
     vrna_message_error("init_pf_two: inconsistency with temperature");
 }
 
 
 PRIVATE void
-get_up_arrays(unsigned int length)
+get_up_arrays(struct up_data  *d,
+              unsigned int    length)
 {
   unsigned int  l1  = length + 1;
   unsigned int  l2  = length + 2;
 
-  prpr      = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * ((l1 * l2) >> 1));
-  expMLbase = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * l2);
-  scale     = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * l2);
-  qqm2      = (double *)vrna_alloc(sizeof(double) * l2);
-  qq_1m2    = (double *)vrna_alloc(sizeof(double) * l2);
-  qqm       = (double *)vrna_alloc(sizeof(double) * l2);
-  qqm1      = (double *)vrna_alloc(sizeof(double) * l2);
-  my_iindx  = vrna_idx_row_wise(length);
+  d->prpr       = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * ((l1 * l2) >> 1));
+  d->expMLbase  = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * l2);
+  d->scale      = (FLT_OR_DBL *)vrna_alloc(sizeof(FLT_OR_DBL) * l2);
+  d->qqm2       = (double *)vrna_alloc(sizeof(double) * l2);
+  d->qq_1m2     = (double *)vrna_alloc(sizeof(double) * l2);
+  d->qqm        = (double *)vrna_alloc(sizeof(double) * l2);
+  d->qqm1       = (double *)vrna_alloc(sizeof(double) * l2);
+  d->my_iindx   = vrna_idx_row_wise(length);
 }
 
 
 PRIVATE void
-free_up_arrays(void)
+free_up_arrays(struct up_data *d)
 {
-  if (prpr != NULL) {
-    free(prpr);
-    prpr = NULL;
-  }
-
-  if (expMLbase != NULL) {
-    free(expMLbase);
-    expMLbase = NULL;
-  }
-
-  if (scale != NULL) {
-    free(scale);
-    scale = NULL;
-  }
-
-  if (qqm != NULL) {
-    free(qqm);
-    qqm = NULL;
-  }
-
-  if (qqm1 != NULL) {
-    free(qqm1);
-    qqm1 = NULL;
-  }
-
-  if (qqm2 != NULL) {
-    free(qqm2);
-    qqm2 = NULL;
-  }
-
-  if (qq_1m2 != NULL) {
-    free(qq_1m2);
-    qq_1m2 = NULL;
-  }
-
-  if (my_iindx != NULL) {
-    free(my_iindx);
-    my_iindx = NULL;
-  }
+  free(d->prpr);
+  free(d->expMLbase);
+  free(d->scale);
+  free(d->qqm);
+  free(d->qqm1);
+  free(d->qqm2);
+  free(d->qq_1m2);
+  free(d->my_iindx);
+
+  d->prpr       = NULL;
+  d->expMLbase  = NULL;
+  d->scale      = NULL;
+  d->qqm        = NULL;
+  d->qqm1       = NULL;
+  d->qqm2       = NULL;
+  d->qq_1m2     = NULL;
+  d->my_iindx   = NULL;
 }
 
 
 PUBLIC void
 free_interact(interact *pin)
 {
-  if (S != NULL && pin != NULL) {
-    free(S);
-    S = NULL;
-  }
-
-  if (S1 != NULL && pin != NULL) {
-    free(S1);
-    S1 = NULL;
-  }
-
   if (pin != NULL) {
     free(pin->Pi);
     free(pin->Gi);
@@ -1216,47 +1360,15 @@ free_interact(interact *pin)
 }
 
 
-/*---------------------------------------------------------------------------*/
-
-PRIVATE void
-encode_seq(const char *s1,
-           const char *s2)
-{
-  unsigned int i, l;
-
-  l = strlen(s1);
-  /* S and S1 are freed by free_pf_arrays(); ! */
-  S   = (short *)vrna_alloc(sizeof(short) * (l + 1));
-  S1  = (short *)vrna_alloc(sizeof(short) * (l + 1));
-  /* S1 exists only for the special X K and I bases and energy_set!=0 */
-  S[0] = l;
-  for (i = 1; i <= l; i++) {
-    /* make numerical encoding of sequence */
-    S[i]  = (short)encode_char(toupper(s1[i - 1]));
-    S1[i] = alias[S[i]]; /* for mismatches of nostandard bases */
-  }
-  if (s2 != NULL) {
-    l = strlen(s2);
-    /* SS2 exists only for the special X K and I bases and energy_set!=0 */
-    SS[0] = l;
-    for (i = 1; i <= l; i++) {
-      /* make numerical encoding of sequence */
-      SS[i]   = (short)encode_char(toupper(s2[i - 1]));
-      SS2[i]  = alias[SS[i]]; /* for mismatches of nostandard bases */
-    }
-  }
-}
-
-
 /*-------------------------------------------------------------------------*/
 /* scale energy parameters and pre-calculate Boltzmann weights:
  * most of this is done in structure Pf see params.c,h (function:
- * get_scaled_pf_parameters(), only arrays scale and expMLbase are handled here*/
+ * get_scaled_pf_parameters(), the arrays scale and expMLbase are handled
+ * by scale_arrays() below */
 PRIVATE void
-scale_stru_pf_params(unsigned int length)
+scale_stru_pf_params(void)
 {
-  unsigned int  i;
-  double        kT;
+  double kT;
 
 
   /* Do this only at the first call for get_scaled_pf_parameters()
@@ -1282,14 +1394,27 @@ scale_stru_pf_params(unsigned int length)
       pf_scale = 1;
   }
 
-  Pf->pf_scale  = pf_scale;
+  Pf->pf_scale = pf_scale;
+}
+
+
+/* fill the arrays scale and expMLbase of d according to d->pf_scale */
+PRIVATE void
+scale_arrays(struct up_data *d,
+             unsigned int   length)
+{
+  unsigned int  i;
+  FLT_OR_DBL    *scale, *expMLbase;
+
+  scale         = d->scale;
+  expMLbase     = d->expMLbase;
   scale[0]      = 1.;
-  scale[1]      = 1. / pf_scale;
+  scale[1]      = 1. / d->pf_scale;
   expMLbase[0]  = 1;
-  expMLbase[1]  = Pf->expMLbase / pf_scale;
+  expMLbase[1]  = d->Pf->expMLbase / d->pf_scale;
   for (i = 2; i <= length + 1; i++) {
     scale[i]      = scale[i / 2] * scale[i - (i / 2)];
-    expMLbase[i]  = pow(Pf->expMLbase, (double)i) * scale[i];
+    expMLbase[i]  = pow(d->Pf->expMLbase, (double)i) * scale[i];
   }
 }
 
@@ -1485,7 +1610,7 @@ plot_free_pu_out(pu_out   *res,
   double  dG_u;
   char    nan[4], *time, dg[11];
   FILE    *wastl;
-  double  kT = Pf->kT;
+  double  kT = (Pf) ? Pf->kT : (temperature + K0) * GASCONST;
 
   wastl = fopen(ofile, "a");
   if (wastl == NULL) {
@@ -1620,21 +1745,21 @@ Up_plot(pu_contrib    *p_c,
 /* copy from part_func_co.c */
 PRIVATE constrain *
 get_ptypes_up(char        *Seq,
-              const char  *structure)
+              const char  *structure,
+              vrna_md_t   *md)
 {
   int       n, i, j, k, l, length;
   constrain *con;
-  short     *s, *s1;
+  short     *s;
 
   length = strlen(Seq);
-  make_pair_matrix();
   con       = (constrain *)vrna_alloc(sizeof(constrain));
   con->indx = (int *)vrna_alloc(sizeof(int) * (length + 1));
   for (i = 1; i <= length; i++)
     con->indx[i] = ((length + 1 - i) * (length - i)) / 2 + length + 1;
   con->ptype = (char *)vrna_alloc(sizeof(char) * ((length + 1) * (length + 2) / 2));
 
-  set_encoded_seq((const char *)Seq, &s, &s1);
+  s = vrna_seq_encode_simple(Seq, md);
 
   n = s[0];
   for (k = 1; k <= n - CO_TURN - 1; k++)
@@ -1645,12 +1770,12 @@ get_ptypes_up(char        *Seq,
       if (j > n)
         continue;
 
-      type = pair[s[i]][s[j]];
+      type = md->pair[s[i]][s[j]];
       while ((i >= 1) && (j <= n)) {
         if ((i > 1) && (j < n))
-          ntype = pair[s[i - 1]][s[j + 1]];
+          ntype = md->pair[s[i - 1]][s[j + 1]];
 
-        if (noLonelyPairs && (!otype) && (!ntype))
+        if (md->noLP && (!otype) && (!ntype))
           type = 0; /* i.j can only form isolated pairs */
 
         con->ptype[con->indx[i] - j]  = (char)type;
@@ -1661,7 +1786,7 @@ get_ptypes_up(char        *Seq,
       }
     }
 
-  if (fold_constrained && (structure != NULL)) {
+  if (structure != NULL) {
     int   hx, *stack;
     char  type;
     stack = (int *)vrna_alloc(sizeof(int) * (n + 1));
@@ -1704,34 +1829,5 @@ get_ptypes_up(char        *Seq,
   }
 
   free(s);
-  free(s1);
   return con;
 }
-
-
-PRIVATE void
-set_encoded_seq(const char  *sequence,
-                short       **S,
-                short       **S1)
-{
-  unsigned int i, l;
-
-  l = strlen(sequence);
-  if (S != NULL) {
-    *S = (short *)vrna_alloc(sizeof(short) * (l + 2));
-    for (i = 1; i <= l; i++) /* make numerical encoding of sequence */
-      (*S)[i] = (short)encode_char(toupper(sequence[i - 1]));
-    (*S)[l + 1] = (*S)[1];
-    (*S)[0]     = (short)l;
-  }
-
-  /* S1 exists only for the special X K and I bases and energy_set!=0 */
-  if (S1 != NULL) {
-    *S1 = (short *)vrna_alloc(sizeof(short) * (l + 2));
-    for (i = 1; i <= l; i++)                                            /* make numerical encoding of sequence */
-      (*S1)[i] = alias[(short)encode_char(toupper(sequence[i - 1]))];   /* for mismatches of nostandard bases */
-    /* for circular folding add first base at position n+1 and last base at position 0 in S1 */
-    (*S1)[l + 1]  = (*S1)[1];
-    (*S1)[0]      = (*S1)[l];
-  }
-}
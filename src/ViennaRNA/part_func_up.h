@@ -2,6 +2,8 @@
 #define VIENNA_RNA_PACKAGE_PART_FUNC_UP_H
 
 #include <ViennaRNA/datastructures/basic.h>
+#include <ViennaRNA/model.h>
+#include <ViennaRNA/fold_compound.h>
 
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
@@ -9,6 +11,8 @@
 #define   RNA_UP_MODE_2   2U
 #define   RNA_UP_MODE_3   4U
 
+#endif
+
 /**
  *  @file     part_func_up.h
  *  @ingroup  cofold pf_cofold
@@ -32,6 +36,87 @@
  *  we compute the free energy of an interaction for every possible binding site.
  */
 
+/**
+ *  @brief Calculate the partition function over all unpaired regions
+ *  of a maximal length for a fold compound.
+ *
+ *  This is the re-entrant counterpart of pf_unstru(). Instead of the
+ *  partition function arrays of the last call to pf_fold(), it uses those
+ *  stored in @p fc, so vrna_pf() has to be called with base pair probability
+ *  computations turned on (#vrna_md_t.compute_bpp) before calling this function.
+ *  Energy parameters, model settings and the scaling factor are taken from @p fc
+ *  as well. Since no global state is involved, different fold compounds may be
+ *  processed concurrently.
+ *
+ *  Use free_pu_contrib_struct() to free the returned structure.
+ *
+ *  @see  pf_unstru(), vrna_pf_interact(), vrna_pf()
+ *
+ *  @param  fc    The fold compound with base pair probabilities
+ *  @param  max_w The maximal length of unpaired regions
+ *  @return       The contributions to the probabilities of being unpaired, or NULL on error
+ */
+pu_contrib *
+vrna_pf_unstru(vrna_fold_compound_t *fc,
+               int                  max_w);
+
+
+/**
+ *  @brief Calculate the probability of a local interaction between two sequences
+ *  using a given set of model settings.
+ *
+ *  This is the re-entrant counterpart of pf_interact(). The arguments have the
+ *  same meaning, except that the constraint @p cstruc is always applied when
+ *  it is not NULL, and Boltzmann weights are derived from @p md rather than from
+ *  the global model settings. Pass NULL for @p md to use default settings.
+ *  @p p_c and @p p_c2 are only read, so once computed they may be passed to
+ *  any number of calls, e.g. to compare a single query against many targets.
+ *
+ *  Use free_interact() to free the returned structure.
+ *
+ *  @see  pf_interact(), vrna_pf_unstru()
+ *
+ *  @param  s1      The longer sequence
+ *  @param  s2      The shorter sequence
+ *  @param  p_c     The contributions to the probabilities of being unpaired for @p s1
+ *  @param  p_c2    The contributions to the probabilities of being unpaired for @p s2 (may be NULL)
+ *  @param  max_w   The maximal length of the interaction
+ *  @param  cstruc  The constraint for the interaction (may be NULL)
+ *  @param  incr3   The number of unpaired residues included right of the interaction in @p s1
+ *  @param  incr5   The number of unpaired residues included left of the interaction in @p s1
+ *  @param  md      The model settings (may be NULL)
+ *  @return         The interaction data, or NULL on error
+ */
+interact *
+vrna_pf_interact(const char *s1,
+                 const char *s2,
+                 pu_contrib *p_c,
+                 pu_contrib *p_c2,
+                 int        max_w,
+                 const char *cstruc,
+                 int        incr3,
+                 int        incr5,
+                 vrna_md_t  *md);
+
+
+/**
+ *  @brief Frees the output of function pf_interact().
+ */
+void free_interact(interact *pin);
+
+/**
+ *  @brief
+ */
+pu_contrib  *get_pu_contrib_struct( unsigned int n,
+                                    unsigned int w);
+
+/**
+ *  @brief Frees the output of function pf_unstru().
+ */
+void        free_pu_contrib_struct(pu_contrib *pu);
+
+#ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
+
 /**
  *  @brief Calculate the partition function over all unpaired regions
  *  of a maximal length.
@@ -112,11 +197,6 @@ interact *pf_interact(const char *s1,
                       int incr3,
                       int incr5);
 
-/**
- *  @brief Frees the output of function pf_interact().
- */
-void free_interact(interact *pin);
-
 /**
  *  @brief
  */
@@ -129,24 +209,13 @@ int Up_plot(pu_contrib *p_c,
             char *head,
             unsigned int mode);
 
-/**
- *  @brief
- */
-pu_contrib  *get_pu_contrib_struct( unsigned int n,
-                                    unsigned int w);
-
-/**
- *  @brief Frees the output of function pf_unstru().
- */
-void        free_pu_contrib_struct(pu_contrib *pu);
-
 void
 free_pu_contrib(pu_contrib *pu);
 
+#endif
+
 /**
  * @}
  */
 
 #endif
-
-#endif
@@ -7,12 +7,17 @@
 
 #include "ViennaRNA/fold_compound.h"
 #include "ViennaRNA/model.h"
+#include "ViennaRNA/params/constants.h"
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/utils/structures.h"
 #include "ViennaRNA/mfe.h"
 #include "ViennaRNA/part_func.h"
 #include "ViennaRNA/part_func_window.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 PUBLIC float
 vrna_pf_fold(const char *seq,
              char       *structure,
@@ -80,6 +85,69 @@ vrna_pf_circfold(const char *seq,
 }
 
 
+PUBLIC int
+vrna_pf_fold_batch(const char **sequences,
+                   vrna_md_t  *md_p,
+                   char       **structures,
+                   float      *energies,
+                   int        jobs)
+{
+  long      num, i;
+  vrna_md_t md;
+
+  if ((!sequences) || (!energies))
+    return 0;
+
+  for (num = 0; sequences[num]; num++);
+
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  /* no need to backtrack MFE structure */
+  md.backtrack = 0;
+
+  /* pair probabilities are only required for the pairing propensities */
+  if (!structures)
+    md.compute_bpp = 0;
+
+#ifdef _OPENMP
+  if (jobs <= 0)
+    jobs = omp_get_max_threads();
+
+#pragma omp parallel for num_threads(jobs) schedule(dynamic, 1)
+#else
+  (void)jobs;
+#endif
+  for (i = 0; i < num; i++) {
+    char                  *structure;
+    double                mfe;
+    vrna_fold_compound_t  *fc;
+
+    structure = NULL;
+    fc        = vrna_fold_compound(sequences[i], &md, VRNA_OPTION_DEFAULT);
+
+    if (fc) {
+      if (structures)
+        structure = (char *)vrna_alloc(sizeof(char) * (fc->length + 1));
+
+      mfe = (double)vrna_mfe(fc, NULL);
+      vrna_exp_params_rescale(fc, &mfe);
+      energies[i] = vrna_pf(fc, structure);
+      vrna_fold_compound_free(fc);
+    } else {
+      energies[i] = (float)INF / 100.;
+    }
+
+    if (structures)
+      structures[i] = structure;
+  }
+
+  return (int)num;
+}
+
+
 PUBLIC float
 vrna_pf_alifold(const char  **strings,
                 char        *structure,
@@ -28,6 +28,7 @@
 #include <limits.h>
 
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/alphabet.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/loops/all.h"
@@ -435,6 +436,13 @@ get_pf_arrays(short       **S_p,
   if (backward_compat_compound) {
     if (backward_compat_compound->exp_matrices) {
       if (backward_compat_compound->exp_matrices->qb) {
+        /* iindx-based pair types are only created on demand */
+        if (!backward_compat_compound->ptype_pf_compat)
+          backward_compat_compound->ptype_pf_compat =
+            get_ptypes(backward_compat_compound->sequence_encoding2,
+                       &(backward_compat_compound->exp_params->model_details),
+                       1);
+
         *S_p      = backward_compat_compound->sequence_encoding2;
         *S1_p     = backward_compat_compound->sequence_encoding;
         *ptype_p  = backward_compat_compound->ptype_pf_compat;
@@ -41,14 +41,20 @@
 #include <ctype.h>
 #include <string.h>
 #include "ViennaRNA/utils/basic.h"
+#include "ViennaRNA/alphabet.h"
 #include "ViennaRNA/params/default.h"
 #include "ViennaRNA/fold_vars.h"
 #include "ViennaRNA/fold.h"
-#include "ViennaRNA/pair_mat.h"
 #include "ViennaRNA/params/basic.h"
+#include "ViennaRNA/datastructures/char_stream.h"
 #include "ViennaRNA/plex.h"
 #include "ViennaRNA/ali_plex.h"
 #include "ViennaRNA/loops/all.h"
+#include "ViennaRNA/utils/cpu.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 /* #################SIMD############### */
 
 /* int subopt_sorted=0; */
@@ -77,17 +83,83 @@
 #define LINIX(i, j, l)    ((i + 20) * l + j)
 #define LINIY(i, j, l)    ((i + 25) * l + j)
 
+PRIVATE struct vrna_plex_s *
+plex_init(vrna_param_t  *params,
+          int           own_params);
+
+
+PRIVATE void
+encode_seqs(struct vrna_plex_s  *plex,
+            const char          *s1,
+            const char          *s2);
+
+
+PRIVATE void
+prepare_seqs(struct vrna_plex_s *plex,
+             const char         *s1,
+             const char         *s2);
+
+
+PRIVATE void
+release_seqs(struct vrna_plex_s *plex);
+
+
+PRIVATE struct plex_target *
+target_init(const char  *s1,
+            const int   **access_s1,
+            vrna_md_t   *md);
+
+
 PRIVATE void
-encode_seqs(const char  *s1,
-            const char  *s2);
+target_free(struct plex_target *target);
 
 
-PRIVATE short *
-encode_seq(const char *seq);
+PRIVATE int **
+target_penalties(const int  **access_s1,
+                 int        n1);
 
 
 PRIVATE void
-update_dfold_params(void);
+penalties_free(int **D);
+
+
+PRIVATE vrna_param_t *
+get_compat_params(void);
+
+
+/**
+*** plex_fold(_XS) are the entry points that scan the target for duplexes with the
+*** query, all results are written to the output buffer of the context
+**/
+PRIVATE void
+plex_fold(struct vrna_plex_s  *plex,
+          const char          *s1,
+          const char          *s2,
+          const int           threshold,
+          const int           extension_cost,
+          const int           alignment_length,
+          const int           delta,
+          const int           fast,
+          const int           il_a,
+          const int           il_b,
+          const int           b_a,
+          const int           b_b);
+
+
+PRIVATE void
+plex_fold_XS(struct vrna_plex_s *plex,
+             const char         *s1,
+             const char         *s2,
+             const int          **access_s1,
+             const int          **access_s2,
+             const int          threshold,
+             const int          alignment_length,
+             const int          delta,
+             const int          fast,
+             const int          il_a,
+             const int          il_b,
+             const int          b_a,
+             const int          b_b);
 
 
 /**
@@ -96,154 +168,292 @@ update_dfold_params(void);
 *** fduplexfold(_XS) computes duplex in a plex way
 **/
 PRIVATE duplexT
-duplexfold(const char *s1,
-           const char *s2,
-           const int  extension_cost);
+duplexfold(struct vrna_plex_s *plex,
+           const char         *s1,
+           const char         *s2,
+           const int          extension_cost);
 
 
 PRIVATE char *
-backtrack(int       i,
-          int       j,
-          const int extension_cost);
+backtrack(struct vrna_plex_s *plex,
+          int                i,
+          int                j,
+          const int          extension_cost);
 
 
 PRIVATE void
-find_max(const int  *position,
-         const int  *position_j,
-         const int  delta,
-         const int  threshold,
-         const int  length,
-         const char *s1,
-         const char *s2,
-         const int  extension_cost,
-         const int  fast,
-         const int  il_a,
-         const int  il_b,
-         const int  b_a,
-         const int  b_b);
+find_max(struct vrna_plex_s *plex,
+         const int          *position,
+         const int          *position_j,
+         const int          delta,
+         const int          threshold,
+         const int          length,
+         const char         *s1,
+         const char         *s2,
+         const int          extension_cost,
+         const int          fast,
+         const int          il_a,
+         const int          il_b,
+         const int          b_a,
+         const int          b_b);
 
 
 PRIVATE void
-plot_max(const int  max,
-         const int  max_pos,
-         const int  max_pos_j,
-         const int  alignment_length,
-         const char *s1,
-         const char *s2,
-         const int  extension_cost,
-         const int  fast,
-         const int  il_a,
-         const int  il_b,
-         const int  b_a,
-         const int  b_b);
+plot_max(struct vrna_plex_s *plex,
+         const int          max,
+         const int          max_pos,
+         const int          max_pos_j,
+         const int          alignment_length,
+         const char         *s1,
+         const char         *s2,
+         const int          extension_cost,
+         const int          fast,
+         const int          il_a,
+         const int          il_b,
+         const int          b_a,
+         const int          b_b);
 
 
 /* PRIVATE duplexT duplexfold_XS(const char *s1, const char *s2,const int **access_s1, const int **access_s2, const int i_pos, const int j_pos, const int threshold); */
 PRIVATE duplexT
-duplexfold_XS(const char  *s1,
-              const char  *s2,
-              const int   **access_s1,
-              const int   **access_s2,
-              const int   i_pos,
-              const int   j_pos,
-              const int   threshold,
-              const int   i_flag,
-              const int   j_flag);
+duplexfold_XS(struct vrna_plex_s  *plex,
+              const char          *s1,
+              const char          *s2,
+              const int           **access_s1,
+              const int           **access_s2,
+              const int           i_pos,
+              const int           j_pos,
+              const int           threshold,
+              const int           i_flag,
+              const int           j_flag);
 
 
 /* PRIVATE char *   backtrack_XS(int i, int j, const int** access_s1, const int** access_s2); */
 PRIVATE char *
-backtrack_XS(int        i,
-             int        j,
-             const int  **access_s1,
-             const int  **access_s2,
-             const int  i_flag,
-             const int  j_flag);
+backtrack_XS(struct vrna_plex_s  *plex,
+             int                 i,
+             int                 j,
+             const int           **access_s1,
+             const int           **access_s2,
+             const int           i_flag,
+             const int           j_flag);
 
 
 PRIVATE void
-find_max_XS(const int   *position,
-            const int   *position_j,
-            const int   delta,
-            const int   threshold,
-            const int   alignment_length,
-            const char  *s1,
-            const char  *s2,
-            const int   **access_s1,
-            const int   **access_s2,
-            const int   fast,
-            const int   il_a,
-            const int   il_b,
-            const int   b_a,
-            const int   b_b);
+find_max_XS(struct vrna_plex_s  *plex,
+            const int           *position,
+            const int           *position_j,
+            const int           delta,
+            const int           threshold,
+            const int           alignment_length,
+            const char          *s1,
+            const char          *s2,
+            const int           **access_s1,
+            const int           **access_s2,
+            const int           fast,
+            const int           il_a,
+            const int           il_b,
+            const int           b_a,
+            const int           b_b);
 
 
 PRIVATE void
-plot_max_XS(const int   max,
-            const int   max_pos,
-            const int   max_pos_j,
-            const int   alignment_length,
-            const char  *s1,
-            const char  *s2,
-            const int   **access_s1,
-            const int   **access_s2,
-            const int   fast,
-            const int   il_a,
-            const int   il_b,
-            const int   b_a,
-            const int   b_b);
+plot_max_XS(struct vrna_plex_s  *plex,
+            const int           max,
+            const int           max_pos,
+            const int           max_pos_j,
+            const int           alignment_length,
+            const char          *s1,
+            const char          *s2,
+            const int           **access_s1,
+            const int           **access_s2,
+            const int           fast,
+            const int           il_a,
+            const int           il_b,
+            const int           b_a,
+            const int           b_b);
 
 
 PRIVATE duplexT
-fduplexfold(const char  *s1,
-            const char  *s2,
-            const int   extension_cost,
-            const int   il_a,
-            const int   il_b,
-            const int   b_a,
-            const int   b_b);
+fduplexfold(struct vrna_plex_s  *plex,
+            const char          *s1,
+            const char          *s2,
+            const int           extension_cost,
+            const int           il_a,
+            const int           il_b,
+            const int           b_a,
+            const int           b_b);
 
 
 PRIVATE char *
-fbacktrack(int        i,
-           int        j,
-           const int  extension_cost,
-           const int  il_a,
-           const int  il_b,
-           const int  b_a,
-           const int  b_b,
-           int        *dG);
+fbacktrack(struct vrna_plex_s  *plex,
+           int                 i,
+           int                 j,
+           const int           extension_cost,
+           const int           il_a,
+           const int           il_b,
+           const int           b_a,
+           const int           b_b,
+           int                 *dG);
 
 
 PRIVATE duplexT
-fduplexfold_XS(const char *s1,
-               const char *s2,
-               const int  **access_s1,
-               const int  **access_s2,
-               const int  i_pos,
-               const int  j_pos,
-               const int  threshold,
-               const int  il_a,
-               const int  il_b,
-               const int  b_a,
-               const int  b_b);
+fduplexfold_XS(struct vrna_plex_s *plex,
+               const char         *s1,
+               const char         *s2,
+               const int          **access_s1,
+               const int          **access_s2,
+               const int          i_pos,
+               const int          j_pos,
+               const int          threshold,
+               const int          il_a,
+               const int          il_b,
+               const int          b_a,
+               const int          b_b);
 
 
 PRIVATE char *
-fbacktrack_XS(int       i,
-              int       j,
-              const int **access_s1,
-              const int **access_s2,
-              const int i_pos,
-              const int j_pos,
-              const int il_a,
-              const int il_b,
-              const int b_a,
-              const int b_b,
-              int       *dGe,
-              int       *dGeplex,
-              int       *dGx,
-              int       *dGy);
+fbacktrack_XS(struct vrna_plex_s *plex,
+              int                i,
+              int                j,
+              const int          **access_s1,
+              const int          **access_s2,
+              const int          i_pos,
+              const int          j_pos,
+              const int          il_a,
+              const int          il_b,
+              const int          b_a,
+              const int          b_b,
+              int                *dGe,
+              int                *dGeplex,
+              int                *dGx,
+              int                *dGy);
+
+
+/**
+*** Vectorized column fill for Lduplexfold(_XS)
+*** All energy contributions of the recursions that depend on the query and a few
+*** nucleotides of the target only are tabulated in query profiles, one row per
+*** target context. A complete column of the single array SA can then be computed
+*** from contiguous memory, see fill_column_simd(). Profile rows are computed upon
+*** first use of a target context.
+**/
+#define PROFILE_IJ        0   /* context S1[i-1], S1[i] */
+#define PROFILE_EXIT      1   /* context S1[i], S1[i+1] */
+#define PROFILE_BULGE     2   /* context S1[i-2], S1[i] */
+#define PROFILE_3         3   /* context S1[i-2], S1[i-1], S1[i] */
+#define PROFILE_4         4   /* context S1[i-3], S1[i-2], S1[i-1], S1[i] */
+#define PROFILE_4X        5   /* context S1[i-4], S1[i-3], S1[i-1], S1[i] */
+#define PROFILE_GROUPS    6
+
+/* rows of context PROFILE_IJ */
+#define P_TYPE        0
+#define P_INIT        1
+#define P_STACK       2
+#define P_BULGE_Q     3
+#define P_MMI         4
+#define P_MM1NI       5
+#define P_MMI_OPEN    6
+#define P_MM1NI_OPEN  7
+#define P_AU_BX       8
+#define P_AU_BY       9
+#define P_AU          10
+/* rows of context PROFILE_3 */
+#define P_INT11       0
+#define P_INT12       1
+/* rows of context PROFILE_4 */
+#define P_INT22       0
+#define P_INT21       1
+#define P_INT23_Q     2
+
+struct plex_profile {
+  int *zero;                    /* a row of zeros */
+  int **rows[PROFILE_GROUPS];   /* rows[group][context], NULL until first use */
+};
+
+struct plex_costs {
+  int ec;                       /* extension cost */
+  int bopen;
+  int bext;
+  int iopen;
+  int iext_s;
+  int iext_ass;
+};
+
+typedef void (proto_fill_min)(int          *dst,
+                              const int    **src,
+                              const int    **prof,
+                              const int    **dj,
+                              const int    *c,
+                              unsigned int n,
+                              const int    *type,
+                              int          from,
+                              int          to);
+
+typedef int (proto_column_min)(const int  *lc,
+                               const int  *e,
+                               int        c,
+                               const int  *type,
+                               int        from,
+                               int        to,
+                               int        *pos);
+
+
+#if VRNA_WITH_SIMD_SSE41
+void
+vrna_plex_fill_min_sse41(int          *dst,
+                         const int    **src,
+                         const int    **prof,
+                         const int    **dj,
+                         const int    *c,
+                         unsigned int n,
+                         const int    *type,
+                         int          from,
+                         int          to);
+
+
+int
+vrna_plex_column_min_sse41(const int  *lc,
+                           const int  *e,
+                           int        c,
+                           const int  *type,
+                           int        from,
+                           int        to,
+                           int        *pos);
+
+
+#endif
+
+
+PRIVATE void
+simd_dispatch(void);
+
+
+PRIVATE struct plex_profile *
+simd_profile_init(struct vrna_plex_s *plex);
+
+
+PRIVATE void
+profile_free(struct plex_profile *prof);
+
+
+PRIVATE const int *
+profile_rows(struct vrna_plex_s   *plex,
+             struct plex_profile  *prof,
+             unsigned int         group,
+             int                  i);
+
+
+PRIVATE void
+fill_column_simd(struct vrna_plex_s       *plex,
+                 int                      *SA,
+                 struct plex_profile      *prof,
+                 int                      i,
+                 const int                *di,
+                 const int                **dj,
+                 const struct plex_costs  *e,
+                 int                      *min_colonne,
+                 int                      *min_j_colonne);
 
 
 /*@unused@*/
@@ -251,25 +461,47 @@ fbacktrack_XS(int       i,
 #define MAXSECTORS      500     /* dimension for a backtrack array */
 #define LOCALITY        0.      /* locality parameter for base-pairs */
 
-PRIVATE vrna_param_t *P = NULL;
+/**
+*** A target that is scanned with many queries is encoded only once. Its
+*** accessibility penalties for 1-4 unpaired nucleotides, DI[0..3], are
+*** likewise computed only once and shared among the contexts of all threads
+**/
+struct plex_target {
+  short *S, *SS;  /* encodings of the target */
+  int   **DI;     /* accessibility penalties, see target_penalties() */
+};
 
 /**
-*** energy array used in fduplexfold and fduplexfold_XS
+*** The context of a plex computation, every thread requires its own
+***
+*** energy arrays used in fduplexfold and fduplexfold_XS
 *** We do not use the 1D array here as it is not time critical
 *** It also makes the code more readable
 *** c -> stack;in -> interior loop;bx/by->bulge;inx/iny->1xn loops
-**/
-
-PRIVATE int **c = NULL, **in = NULL, **bx = NULL, **by = NULL, **inx = NULL, **iny = NULL;
-
-/**
+***
 *** S1, SS1, ... contains the encoded sequence for target and query
 *** n1, n2, n3, n4 contains target and query length
 **/
+struct vrna_plex_s {
+  vrna_param_t              *P;           /* energy parameters */
+  int                       own_params;   /* whether or not P belongs to this context */
+  int                       **c, **in, **bx, **by, **inx, **iny;
+  short                     *S1, *SS1, *S2, *SS2; /*contains the sequences*/
+  int                       n1, n2;               /* sequence lengths */
+  int                       n3, n4;               /*sequence length for the duplex*/
+  const struct plex_target  *target;      /* pre-processed target (Maybe NULL) */
+  vrna_cstr_t               out;          /* receives the duplexes found */
+};
+
+/* energy parameters of the backward compatible interface, see get_compat_params() */
+PRIVATE vrna_param_t *compat_params = NULL;
 
-PRIVATE short *S1 = NULL, *SS1 = NULL, *S2 = NULL, *SS2 = NULL; /*contains the sequences*/
-PRIVATE int   n1, n2;                                           /* sequence lengths */
-PRIVATE int   n3, n4; /*sequence length for the duplex*/;
+/**
+*** SIMD kernels for the column fill, set upon first use according to the CPU features
+**/
+PRIVATE int               simd_dispatched = 0;
+PRIVATE proto_fill_min    *fill_min       = NULL;
+PRIVATE proto_column_min  *column_min     = NULL;
 
 
 /*-----------------------------------------------------------------------duplexfold_XS---------------------------------------------------------------------------*/
@@ -282,57 +514,57 @@ PRIVATE int   n3, n4; /*sequence length for the duplex*/;
 *** profiles, i_pos, j_pos are the coordinates of the closing pair.
 **/
 PRIVATE duplexT
-duplexfold_XS(const char  *s1,
-              const char  *s2,
-              const int   **access_s1,
-              const int   **access_s2,
-              const int   i_pos,
-              const int   j_pos,
-              const int   threshold,
-              const int   i_flag,
-              const int   j_flag)
+duplexfold_XS(struct vrna_plex_s  *plex,
+              const char          *s1,
+              const char          *s2,
+              const int           **access_s1,
+              const int           **access_s2,
+              const int           i_pos,
+              const int           j_pos,
+              const int           threshold,
+              const int           i_flag,
+              const int           j_flag)
 {
+  vrna_param_t  *P     = plex->P;
+  vrna_md_t     *md    = &(P->model_details);
+  int           *rtype = &(md->rtype[0]);
+
   int       i, j, p, q, Emin = INF, l_min = 0, k_min = 0;
   char      *struc;
-  vrna_md_t md;
 
   struc = NULL;
   duplexT   mfe;
 
-  n3  = (int)strlen(s1);
-  n4  = (int)strlen(s2);
+  plex->n3  = (int)strlen(s1);
+  plex->n4  = (int)strlen(s2);
 
-  set_model_details(&md);
-
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    update_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
-
-  c = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  for (i = 0; i <= n3; i++)
-    c[i] = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-  for (i = 0; i <= n3; i++)
-    for (j = 0; j <= n4; j++)
-      c[i][j] = INF;
-  encode_seqs(s1, s2);
+  plex->c = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  for (i = 0; i <= plex->n3; i++)
+    plex->c[i] = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+  for (i = 0; i <= plex->n3; i++)
+    for (j = 0; j <= plex->n4; j++)
+      plex->c[i][j] = INF;
+  encode_seqs(plex, s1, s2);
   int type, type2, type3, E, k, l;
 
-  i     = n3 - i_flag;
+  i     = plex->n3 - i_flag;
   j     = 1 + j_flag;
-  type  = pair[S1[i]][S2[j]];
+  type  = md->pair[plex->S1[i]][plex->S2[j]];
   if (!type) {
-    printf("Error during initialization of the duplex in duplexfold_XS\n");
+    vrna_cstr_printf(plex->out, "Error during initialization of the duplex in duplexfold_XS\n");
     mfe.structure = NULL;
     mfe.energy    = INF;
+    for (i = 0; i <= plex->n3; i++)
+      free(plex->c[i]);
+    free(plex->c);
+    free(plex->S1);
+    free(plex->S2);
+    free(plex->SS1);
+    free(plex->SS2);
     return mfe;
   }
 
-  c[i][j] = P->DuplexInit;
+  plex->c[i][j] = P->DuplexInit;
   /**  if (type>2) c[i][j] += P->TerminalAU;
    ***  c[i][j]+=P->dangle3[rtype[type]][SS1[i+1]];
    ***  c[i][j]+=P->dangle5[rtype[type]][SS2[j-1]];
@@ -340,8 +572,8 @@ duplexfold_XS(const char  *s1,
    **/
 
 
-  c[i][j] +=
-    vrna_E_ext_stem(rtype[type], (j_flag ? SS2[j - 1] : -1), (i_flag ? SS1[i + 1] : -1), P);
+  plex->c[i][j] +=
+    vrna_E_ext_stem(rtype[type], (j_flag ? plex->SS2[j - 1] : -1), (i_flag ? plex->SS1[i + 1] : -1), P);
 
   /*
    *   if(j_flag ==0 && i_flag==0){
@@ -358,25 +590,25 @@ duplexfold_XS(const char  *s1,
    */
   k_min = i;
   l_min = j;
-  Emin  = c[i][j];
+  Emin  = plex->c[i][j];
   for (k = i; k > 1; k--) {
     if (k < i)
-      c[k + 1][0] = INF;
+      plex->c[k + 1][0] = INF;
 
-    for (l = j; l <= n4 - 1; l++) {
+    for (l = j; l <= plex->n4 - 1; l++) {
       if (!(k == i && l == j))
-        c[k][l] = INF;
+        plex->c[k][l] = INF;
 
-      type2 = pair[S1[k]][S2[l]];
+      type2 = md->pair[plex->S1[k]][plex->S2[l]];
       if (!type2)
         continue;
 
-      for (p = k + 1; p <= n3 - i_flag && p < k + MAXLOOP - 1; p++) {
+      for (p = k + 1; p <= plex->n3 - i_flag && p < k + MAXLOOP - 1; p++) {
         for (q = l - 1; q >= 1 + j_flag; q--) {
           if (p - k + l - q - 2 > MAXLOOP)
             break;
 
-          type3 = pair[S1[p]][S2[q]];
+          type3 = md->pair[plex->S1[p]][plex->S2[q]];
           if (!type3)
             continue;
 
@@ -384,22 +616,22 @@ duplexfold_XS(const char  *s1,
                         l - q - 1,
                         type2,
                         rtype[type3],
-                        SS1[k + 1],
-                        SS2[l - 1],
-                        SS1[p - 1],
-                        SS2[q + 1],
+                        plex->SS1[k + 1],
+                        plex->SS2[l - 1],
+                        plex->SS1[p - 1],
+                        plex->SS2[q + 1],
                         P);
-          c[k][l] = MIN2(c[k][l], c[p][q] + E);
+          plex->c[k][l] = MIN2(plex->c[k][l], plex->c[p][q] + E);
         }
       }
-      E = c[k][l];
+      E = plex->c[k][l];
       E += access_s1[i - k + 1][i_pos] + access_s2[l - 1][j_pos + (l - 1) - 1];
       /**if (type2>2) E += P->TerminalAU;
        ***if (k>1) E += P->dangle5[type2][SS1[k-1]];
        ***if (l<n4) E += P->dangle3[type2][SS2[l+1]];
        *** Replaced by the line below
        **/
-      E += vrna_E_ext_stem(type2, (k > 1) ? SS1[k - 1] : -1, (l < n4) ? SS2[l + 1] : -1, P);
+      E += vrna_E_ext_stem(type2, (k > 1) ? plex->SS1[k - 1] : -1, (l < plex->n4) ? plex->SS2[l + 1] : -1, P);
 
       if (E < Emin) {
         Emin  = E;
@@ -413,16 +645,16 @@ duplexfold_XS(const char  *s1,
     mfe.energy    = INF;
     mfe.ddG       = INF;
     mfe.structure = NULL;
-    for (i = 0; i <= n3; i++)
-      free(c[i]);
-    free(c);
-    free(S1);
-    free(S2);
-    free(SS1);
-    free(SS2);
+    for (i = 0; i <= plex->n3; i++)
+      free(plex->c[i]);
+    free(plex->c);
+    free(plex->S1);
+    free(plex->S2);
+    free(plex->SS1);
+    free(plex->SS2);
     return mfe;
   } else {
-    struc = backtrack_XS(k_min, l_min, access_s1, access_s2, i_flag, j_flag);
+    struc = backtrack_XS(plex, k_min, l_min, access_s1, access_s2, i_flag, j_flag);
   }
 
   /**
@@ -459,49 +691,54 @@ duplexfold_XS(const char  *s1,
   mfe.energy = mfe.ddG - mfe.dG1 - mfe.dG2;
 
   mfe.structure = struc;
-  for (i = 0; i <= n3; i++)
-    free(c[i]);
-  free(c);
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
+  for (i = 0; i <= plex->n3; i++)
+    free(plex->c[i]);
+  free(plex->c);
+  free(plex->S1);
+  free(plex->S2);
+  free(plex->SS1);
+  free(plex->SS2);
   return mfe;
 }
 
 
 PRIVATE char *
-backtrack_XS(int        i,
-             int        j,
-             const int  **access_s1,
-             const int  **access_s2,
-             const int  i_flag,
-             const int  j_flag)
+backtrack_XS(struct vrna_plex_s  *plex,
+             int                 i,
+             int                 j,
+             const int           **access_s1,
+             const int           **access_s2,
+             const int           i_flag,
+             const int           j_flag)
 {
+  vrna_param_t  *P     = plex->P;
+  vrna_md_t     *md    = &(P->model_details);
+  int           *rtype = &(md->rtype[0]);
+
   /* backtrack structure going backwards from i, and forwards from j
    * return structure in bracket notation with & as separator */
   int   k, l, type, type2, E, traced, i0, j0;
   char  *st1, *st2, *struc;
 
-  st1 = (char *)vrna_alloc(sizeof(char) * (n3 + 1));
-  st2 = (char *)vrna_alloc(sizeof(char) * (n4 + 1));
+  st1 = (char *)vrna_alloc(sizeof(char) * (plex->n3 + 1));
+  st2 = (char *)vrna_alloc(sizeof(char) * (plex->n4 + 1));
   i0  = i; /*MAX2(i-1,1);*/ j0 = j;/*MIN2(j+1,n4);*/
-  while (i <= n3 - i_flag && j >= 1 + j_flag) {
-    E           = c[i][j];
+  while (i <= plex->n3 - i_flag && j >= 1 + j_flag) {
+    E           = plex->c[i][j];
     traced      = 0;
     st1[i - 1]  = '(';
     st2[j - 1]  = ')';
-    type        = pair[S1[i]][S2[j]];
+    type        = md->pair[plex->S1[i]][plex->S2[j]];
     if (!type)
       vrna_message_error("backtrack failed in fold duplex bli");
 
-    for (k = i + 1; k <= n3 && k > i - MAXLOOP - 2; k++) {
+    for (k = i + 1; k <= plex->n3 && k > i - MAXLOOP - 2; k++) {
       for (l = j - 1; l >= 1; l--) {
         int LE;
         if (i - k + l - j - 2 > MAXLOOP)
           break;
 
-        type2 = pair[S1[k]][S2[l]];
+        type2 = md->pair[plex->S1[k]][plex->S2[l]];
         if (!type2)
           continue;
 
@@ -509,12 +746,12 @@ backtrack_XS(int        i,
                        j - l - 1,
                        type,
                        rtype[type2],
-                       SS1[i + 1],
-                       SS2[j - 1],
-                       SS1[k - 1],
-                       SS2[l + 1],
+                       plex->SS1[i + 1],
+                       plex->SS2[j - 1],
+                       plex->SS1[k - 1],
+                       plex->SS2[l + 1],
                        P);
-        if (E == c[k][l] + LE) {
+        if (E == plex->c[k][l] + LE) {
           traced  = 1;
           i       = k;
           j       = l;
@@ -526,17 +763,17 @@ backtrack_XS(int        i,
     }
     if (!traced) {
 #if 0
-      if (i < n3)
-        E -= P->dangle3[rtype[type]][SS1[i + 1]];      /* +access_s1[1][i+1]; */
+      if (i < plex->n3)
+        E -= P->dangle3[rtype[type]][plex->SS1[i + 1]];      /* +access_s1[1][i+1]; */
 
       if (j > 1)
-        E -= P->dangle5[rtype[type]][SS2[j - 1]];      /* +access_s2[1][j+1]; */
+        E -= P->dangle5[rtype[type]][plex->SS2[j - 1]];      /* +access_s2[1][j+1]; */
 
       if (type > 2)
         E -= P->TerminalAU;
 
 #endif
-      E -= vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1], P);
+      E -= vrna_E_ext_stem(rtype[type], plex->SS2[j - 1], plex->SS1[i + 1], P);
       break;
       if (E != P->DuplexInit)
         vrna_message_error("backtrack failed in fold duplex bal");
@@ -572,18 +809,23 @@ backtrack_XS(int        i,
 *** We use the standard matrix (c, in, etc..., because we backtrack)
 **/
 PRIVATE duplexT
-fduplexfold_XS(const char *s1,
-               const char *s2,
-               const int  **access_s1,
-               const int  **access_s2,
-               const int  i_pos,
-               const int  j_pos,
-               const int  threshold,
-               const int  il_a,
-               const int  il_b,
-               const int  b_a,
-               const int  b_b)
+fduplexfold_XS(struct vrna_plex_s *plex,
+               const char         *s1,
+               const char         *s2,
+               const int          **access_s1,
+               const int          **access_s2,
+               const int          i_pos,
+               const int          j_pos,
+               const int          threshold,
+               const int          il_a,
+               const int          il_b,
+               const int          b_a,
+               const int          b_b)
 {
+  vrna_param_t  *P     = plex->P;
+  vrna_md_t     *md    = &(P->model_details);
+  int           *rtype = &(md->rtype[0]);
+
   /**
   *** i,j recursion index
   *** Emin, i_min, j_min MFE position and energy
@@ -622,56 +864,45 @@ fduplexfold_XS(const char *s1,
   int       max = INF;
   int       **DJ;
   int       maxPenalty[4];
-  vrna_md_t md;
 
   /**
   *** variable initialization
   **/
-  n3  = (int)strlen(s1);
-  n4  = (int)strlen(s2);
-
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    update_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
+  plex->n3  = (int)strlen(s1);
+  plex->n4  = (int)strlen(s2);
 
   /**
   *** array initialization
   **/
-  c   = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  in  = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  bx  = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  by  = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  inx = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  iny = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
+  plex->c   = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->in  = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->bx  = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->by  = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->inx = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->iny = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
   /* #pragma omp parallel for */
-  for (i = 0; i <= n3; i++) {
-    c[i]    = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    in[i]   = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    bx[i]   = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    by[i]   = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    inx[i]  = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    iny[i]  = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
+  for (i = 0; i <= plex->n3; i++) {
+    plex->c[i]    = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->in[i]   = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->bx[i]   = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->by[i]   = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->inx[i]  = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->iny[i]  = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
   }
-  for (i = 0; i < n3; i++) {
-    for (j = 0; j < n4; j++) {
-      in[i][j]  = INF;  /* no in before  1 */
-      c[i][j]   = INF;  /* no bulge and no in before n2 */
-      bx[i][j]  = INF;  /* no bulge before 1 */
-      by[i][j]  = INF;
-      inx[i][j] = INF;  /* no bulge before 1 */
-      iny[i][j] = INF;
+  for (i = 0; i < plex->n3; i++) {
+    for (j = 0; j < plex->n4; j++) {
+      plex->in[i][j]  = INF;  /* no in before  1 */
+      plex->c[i][j]   = INF;  /* no bulge and no in before n2 */
+      plex->bx[i][j]  = INF;  /* no bulge before 1 */
+      plex->by[i][j]  = INF;
+      plex->inx[i][j] = INF;  /* no bulge before 1 */
+      plex->iny[i][j] = INF;
     }
   }
   /**
   *** sequence encoding
   **/
-  encode_seqs(s1, s2);
+  encode_seqs(plex, s1, s2);
   /**
   *** Compute max accessibility penalty for the query only once
   **/
@@ -682,12 +913,12 @@ fduplexfold_XS(const char *s1,
 
 
   DJ    = (int **)vrna_alloc(4 * sizeof(int *));
-  DJ[0] = (int *)vrna_alloc((1 + n4) * sizeof(int));
-  DJ[1] = (int *)vrna_alloc((1 + n4) * sizeof(int));
-  DJ[2] = (int *)vrna_alloc((1 + n4) * sizeof(int));
-  DJ[3] = (int *)vrna_alloc((1 + n4) * sizeof(int));
+  DJ[0] = (int *)vrna_alloc((1 + plex->n4) * sizeof(int));
+  DJ[1] = (int *)vrna_alloc((1 + plex->n4) * sizeof(int));
+  DJ[2] = (int *)vrna_alloc((1 + plex->n4) * sizeof(int));
+  DJ[3] = (int *)vrna_alloc((1 + plex->n4) * sizeof(int));
 
-  j = n4 - 9;
+  j = plex->n4 - 9;
   while (--j > 9) {
     int jdiff = j_pos + j - 11;
     /**
@@ -726,10 +957,10 @@ fduplexfold_XS(const char *s1,
   *** allow to reduce number of if test
   **/
   i         = 11;
-  i_length  = n3 - 9;
+  i_length  = plex->n3 - 9;
   while (i < i_length) {
     int di1, di2, di3, di4;
-    int idiff = i_pos - (n3 - 10 - i);
+    int idiff = i_pos - (plex->n3 - 10 - i);
     di1 = 0.5 *
           (access_s1[5][idiff + 4] - access_s1[4][idiff + 4] + access_s1[5][idiff] -
            access_s1[4][idiff - 1]);
@@ -752,7 +983,7 @@ fduplexfold_XS(const char *s1,
      *  di3=MIN2(di3,maxPenalty[2]);
      *  di4=MIN2(di4,maxPenalty[3]);
      */
-    j           = n4 - 9;
+    j           = plex->n4 - 9;
     min_colonne = INF;
     while (10 < --j) {
       int dj1, dj2, dj3, dj4;
@@ -762,58 +993,58 @@ fduplexfold_XS(const char *s1,
       dj3 = DJ[2][j];
       dj4 = DJ[3][j];
       int type, type2;
-      type = pair[S1[i]][S2[j]];
+      type = md->pair[plex->S1[i]][plex->S2[j]];
       /**
       *** Start duplex
       **/
       /*
        * c[i][j]=type ? P->DuplexInit + access_s1[1][idiff]+access_s2[1][jdiff] : INF;
        */
-      c[i][j] = type ? P->DuplexInit : INF;
+      plex->c[i][j] = type ? P->DuplexInit : INF;
       /**
       *** update lin bx by linx liny matrix
       **/
-      type2 = pair[S2[j + 1]][S1[i - 1]];
+      type2 = md->pair[plex->S2[j + 1]][plex->S1[i - 1]];
       /**
       *** start/extend interior loop
       **/
-      in[i][j] = MIN2(
-        c[i - 1][j + 1] + P->mismatchI[type2][SS2[j]][SS1[i]] + iopen + iext_s + di1 + dj1,
-        in[i - 1][j] + iext_ass + di1);
+      plex->in[i][j] = MIN2(
+        plex->c[i - 1][j + 1] + P->mismatchI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s + di1 + dj1,
+        plex->in[i - 1][j] + iext_ass + di1);
 
       /**
       *** start/extend nx1 target
       *** use same type2 as for in
       **/
-      inx[i][j] = MIN2(
-        c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s + di1 + dj1,
-        inx[i - 1][j] + iext_ass + di1);
+      plex->inx[i][j] = MIN2(
+        plex->c[i - 1][j + 1] + P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s + di1 + dj1,
+        plex->inx[i - 1][j] + iext_ass + di1);
       /**
       *** start/extend 1xn target
       *** use same type2 as for in
       **/
-      iny[i][j] = MIN2(
-        c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s + di1 + dj1,
-        iny[i][j + 1] + iext_ass + dj1);
+      plex->iny[i][j] = MIN2(
+        plex->c[i - 1][j + 1] + P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s + di1 + dj1,
+        plex->iny[i][j + 1] + iext_ass + dj1);
       /**
       *** extend interior loop
       **/
-      in[i][j]  = MIN2(in[i][j], in[i][j + 1] + iext_ass + dj1);
-      in[i][j]  = MIN2(in[i][j], in[i - 1][j + 1] + iext_s + di1 + dj1);
+      plex->in[i][j]  = MIN2(plex->in[i][j], plex->in[i][j + 1] + iext_ass + dj1);
+      plex->in[i][j]  = MIN2(plex->in[i][j], plex->in[i - 1][j + 1] + iext_s + di1 + dj1);
       /**
       *** start/extend bulge target
       **/
-      type2     = pair[S2[j]][S1[i - 1]];
-      bx[i][j]  =
-        MIN2(bx[i - 1][j] + bext + di1,
-             c[i - 1][j] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0) + di1);
+      type2     = md->pair[plex->S2[j]][plex->S1[i - 1]];
+      plex->bx[i][j]  =
+        MIN2(plex->bx[i - 1][j] + bext + di1,
+             plex->c[i - 1][j] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0) + di1);
       /**
       *** start/extend bulge query
       **/
-      type2     = pair[S2[j + 1]][S1[i]];
-      by[i][j]  =
-        MIN2(by[i][j + 1] + bext + dj1,
-             c[i][j + 1] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0) + dj1);
+      type2     = md->pair[plex->S2[j + 1]][plex->S1[i]];
+      plex->by[i][j]  =
+        MIN2(plex->by[i][j + 1] + bext + dj1,
+             plex->c[i][j + 1] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0) + dj1);
       /**
        ***end update recursion
        ***######################## Start stack extension##############################
@@ -821,37 +1052,37 @@ fduplexfold_XS(const char *s1,
       if (!type)
         continue;
 
-      c[i][j] += vrna_E_ext_stem(type, SS1[i - 1], SS2[j + 1], P);
+      plex->c[i][j] += vrna_E_ext_stem(type, plex->SS1[i - 1], plex->SS2[j + 1], P);
       /**
       *** stack extension
       **/
-      if ((type2 = pair[S1[i - 1]][S2[j + 1]]))
-        c[i][j] = MIN2(c[i - 1][j + 1] + P->stack[rtype[type]][type2] + di1 + dj1, c[i][j]);
+      if ((type2 = md->pair[plex->S1[i - 1]][plex->S2[j + 1]]))
+        plex->c[i][j] = MIN2(plex->c[i - 1][j + 1] + P->stack[rtype[type]][type2] + di1 + dj1, plex->c[i][j]);
 
       /**
       *** 1x0 / 0x1 stack extension
       **/
-      if ((type2 = pair[S1[i - 1]][S2[j + 2]]))
-        c[i][j] = MIN2(c[i - 1][j + 2] + P->bulge[1] + P->stack[rtype[type]][type2] + di1 + dj2,
-                       c[i][j]);
+      if ((type2 = md->pair[plex->S1[i - 1]][plex->S2[j + 2]]))
+        plex->c[i][j] = MIN2(plex->c[i - 1][j + 2] + P->bulge[1] + P->stack[rtype[type]][type2] + di1 + dj2,
+                       plex->c[i][j]);
 
-      if ((type2 = pair[S1[i - 2]][S2[j + 1]]))
-        c[i][j] = MIN2(c[i - 2][j + 1] + P->bulge[1] + P->stack[type2][rtype[type]] + di2 + dj1,
-                       c[i][j]);
+      if ((type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 1]]))
+        plex->c[i][j] = MIN2(plex->c[i - 2][j + 1] + P->bulge[1] + P->stack[type2][rtype[type]] + di2 + dj1,
+                       plex->c[i][j]);
 
       /**
       *** 1x1 / 2x2 stack extension
       **/
-      if ((type2 = pair[S1[i - 2]][S2[j + 2]]))
-        c[i][j] = MIN2(
-          c[i - 2][j + 2] + P->int11[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]] + di2 + dj2,
-          c[i][j]);
-
-      if ((type2 = pair[S1[i - 3]][S2[j + 3]])) {
-        c[i][j] =
-          MIN2(c[i - 3][j + 3] +
-               P->int22[type2][rtype[type]][SS1[i - 2]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + di3 + dj3,
-               c[i][j]);
+      if ((type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 2]]))
+        plex->c[i][j] = MIN2(
+          plex->c[i - 2][j + 2] + P->int11[type2][rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + di2 + dj2,
+          plex->c[i][j]);
+
+      if ((type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 3]])) {
+        plex->c[i][j] =
+          MIN2(plex->c[i - 3][j + 3] +
+               P->int22[type2][rtype[type]][plex->SS1[i - 2]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + di3 + dj3,
+               plex->c[i][j]);
       }
 
       /**
@@ -859,32 +1090,32 @@ fduplexfold_XS(const char *s1,
       *** E_IntLoop(1,2,type2, rtype[type],SS1[i-1], SS2[j+2], SS1[i-1], SS2[j+1], P) corresponds to
       *** P->int21[rtype[type]][type2][SS2[j+2]][SS1[i-1]][SS1[i-1]]
       **/
-      if ((type2 = pair[S1[i - 3]][S2[j + 2]])) {
-        c[i][j] =
+      if ((type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 2]])) {
+        plex->c[i][j] =
           MIN2(
-            c[i - 3][j + 2] + P->int21[rtype[type]][type2][SS2[j + 1]][SS1[i - 2]][SS1[i - 1]] + di3 + dj2,
-            c[i][j]);
+            plex->c[i - 3][j + 2] + P->int21[rtype[type]][type2][plex->SS2[j + 1]][plex->SS1[i - 2]][plex->SS1[i - 1]] + di3 + dj2,
+            plex->c[i][j]);
       }
 
-      if ((type2 = pair[S1[i - 2]][S2[j + 3]])) {
-        c[i][j] =
+      if ((type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 3]])) {
+        plex->c[i][j] =
           MIN2(
-            c[i - 2][j + 3] + P->int21[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + di2 + dj3,
-            c[i][j]);
+            plex->c[i - 2][j + 3] + P->int21[type2][rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + di2 + dj3,
+            plex->c[i][j]);
       }
 
       /**
       *** 2x3 / 3x2 stack extension
       **/
-      if ((type2 = pair[S1[i - 4]][S2[j + 3]]))
-        c[i][j] = MIN2(c[i - 4][j + 3] + P->internal_loop[5] + P->ninio[2] +
-                       P->mismatch23I[type2][SS1[i - 3]][SS2[j + 2]] +
-                       P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + di4 + dj3, c[i][j]);
+      if ((type2 = md->pair[plex->S1[i - 4]][plex->S2[j + 3]]))
+        plex->c[i][j] = MIN2(plex->c[i - 4][j + 3] + P->internal_loop[5] + P->ninio[2] +
+                       P->mismatch23I[type2][plex->SS1[i - 3]][plex->SS2[j + 2]] +
+                       P->mismatch23I[rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + di4 + dj3, plex->c[i][j]);
 
-      if ((type2 = pair[S1[i - 3]][S2[j + 4]]))
-        c[i][j] = MIN2(c[i - 3][j + 4] + P->internal_loop[5] + P->ninio[2] +
-                       P->mismatch23I[type2][SS1[i - 2]][SS2[j + 3]] +
-                       P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + di3 + dj4, c[i][j]);
+      if ((type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 4]]))
+        plex->c[i][j] = MIN2(plex->c[i - 3][j + 4] + P->internal_loop[5] + P->ninio[2] +
+                       P->mismatch23I[type2][plex->SS1[i - 2]][plex->SS2[j + 3]] +
+                       P->mismatch23I[rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + di3 + dj4, plex->c[i][j]);
 
       /**
       *** So now we have to handle 1x3, 3x1, 3x3, and mxn m,n > 3
@@ -892,48 +1123,48 @@ fduplexfold_XS(const char *s1,
       /**
       *** 3x3 or more
       **/
-      c[i][j] = MIN2(
-        in[i - 3][j + 3] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + 2 * iext_s + di3 + dj3,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->in[i - 3][j + 3] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 2 * iext_s + di3 + dj3,
+        plex->c[i][j]);
       /**
       *** 2xn or more
       **/
-      c[i][j] = MIN2(
-        in[i - 4][j + 2] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + di4 + dj2,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->in[i - 4][j + 2] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + di4 + dj2,
+        plex->c[i][j]);
       /**
       *** nx2 or more
       **/
-      c[i][j] = MIN2(
-        in[i - 2][j + 4] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + di2 + dj4,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->in[i - 2][j + 4] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + di2 + dj4,
+        plex->c[i][j]);
       /**
       *** nx1 n>2
       **/
-      c[i][j] = MIN2(
-        inx[i - 3][j + 1] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + di3 + dj1,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->inx[i - 3][j + 1] + P->mismatch1nI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + di3 + dj1,
+        plex->c[i][j]);
       /**
       *** 1xn n>2
       **/
-      c[i][j] = MIN2(
-        iny[i - 1][j + 3] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + dj3 + di1,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->iny[i - 1][j + 3] + P->mismatch1nI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + dj3 + di1,
+        plex->c[i][j]);
       /**
       *** nx0 n>1
       **/
       int bAU;
       bAU     = (type > 2 ? P->TerminalAU : 0);
-      c[i][j] = MIN2(bx[i - 2][j + 1] + di2 + dj1 + bext + bAU, c[i][j]);
+      plex->c[i][j] = MIN2(plex->bx[i - 2][j + 1] + di2 + dj1 + bext + bAU, plex->c[i][j]);
       /**
       *** 0xn n>1
       **/
-      c[i][j] = MIN2(by[i - 1][j + 2] + di1 + dj2 + bext + bAU, c[i][j]);
+      plex->c[i][j] = MIN2(plex->by[i - 1][j + 2] + di1 + dj2 + bext + bAU, plex->c[i][j]);
       /*
        * remove this line printf("%d\t",c[i][j]);
        */
       temp        = min_colonne;
-      min_colonne = MIN2(c[i][j] + vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1], P),
+      min_colonne = MIN2(plex->c[i][j] + vrna_E_ext_stem(rtype[type], plex->SS2[j - 1], plex->SS1[i + 1], P),
                          min_colonne);
       if (temp > min_colonne)
         min_j_colonne = j;
@@ -953,26 +1184,26 @@ fduplexfold_XS(const char *s1,
   }
   Emin = max;
   if (Emin > threshold) {
-    free(S1);
-    free(S2);
-    free(SS1);
-    free(SS2);
-    for (i = 0; i <= n3; i++) {
-      free(c[i]);
-      free(in[i]);
-      free(bx[i]);
-      free(by[i]);
-      free(inx[i]);
-      free(iny[i]);
+    free(plex->S1);
+    free(plex->S2);
+    free(plex->SS1);
+    free(plex->SS2);
+    for (i = 0; i <= plex->n3; i++) {
+      free(plex->c[i]);
+      free(plex->in[i]);
+      free(plex->bx[i]);
+      free(plex->by[i]);
+      free(plex->inx[i]);
+      free(plex->iny[i]);
     }
     for (i = 0; i <= 3; i++)
       free(DJ[i]);
-    free(c);
-    free(in);
-    free(bx);
-    free(by);
-    free(inx);
-    free(iny);
+    free(plex->c);
+    free(plex->in);
+    free(plex->bx);
+    free(plex->by);
+    free(plex->inx);
+    free(plex->iny);
     free(DJ);
     mfe.energy    = 0;
     mfe.structure = NULL;
@@ -985,7 +1216,8 @@ fduplexfold_XS(const char *s1,
 
   dGe = dGeplex = dGx = dGy = 0;
   /* printf("MAX fduplexfold_XS %d\n",Emin); */
-  struc = fbacktrack_XS(i_min,
+  struc = fbacktrack_XS(plex,
+                        i_min,
                         j_min,
                         access_s1,
                         access_s2,
@@ -1012,12 +1244,12 @@ fduplexfold_XS(const char *s1,
   lengthx = l1;
   lengthx -= (struc[0] == '.' ? 1 : 0);
   lengthx -= (struc[l1 - 1] == '.' ? 1 : 0);
-  endx    = (i_pos - (n3 - i_min));
+  endx    = (i_pos - (plex->n3 - i_min));
   lengthy = size - l1;
   lengthy -= (struc[size] == '.' ? 1 : 0);
   lengthy -= (struc[l1 + 1] == '.' ? 1 : 0);
   endy    = j_pos + j_min + lengthy - 22;
-  if (i_min < n3 - 10)
+  if (i_min < plex->n3 - 10)
     i_min++;
 
   if (j_min > 11)
@@ -1033,47 +1265,52 @@ fduplexfold_XS(const char *s1,
   mfe.opening_backtrack_y = (double)dGy * 0.01;
   mfe.dG1                 = 0;  /* !remove access to complete access array (double) access_s1[lengthx][endx+10] * 0.01; */
   mfe.dG2                 = 0;  /* !remove access to complete access array (double) access_s2[lengthy][endy+10] * 0.01; */
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
-  for (i = 0; i <= n3; i++) {
-    free(c[i]);
-    free(in[i]);
-    free(bx[i]);
-    free(by[i]);
-    free(inx[i]);
-    free(iny[i]);
+  free(plex->S1);
+  free(plex->S2);
+  free(plex->SS1);
+  free(plex->SS2);
+  for (i = 0; i <= plex->n3; i++) {
+    free(plex->c[i]);
+    free(plex->in[i]);
+    free(plex->bx[i]);
+    free(plex->by[i]);
+    free(plex->inx[i]);
+    free(plex->iny[i]);
   }
   for (i = 0; i <= 3; i++)
     free(DJ[i]);
   free(DJ);
-  free(c);
-  free(in);
-  free(bx);
-  free(by);
-  free(iny);
-  free(inx);
+  free(plex->c);
+  free(plex->in);
+  free(plex->bx);
+  free(plex->by);
+  free(plex->iny);
+  free(plex->inx);
   return mfe;
 }
 
 
 PRIVATE char *
-fbacktrack_XS(int       i,
-              int       j,
-              const int **access_s1,
-              const int **access_s2,
-              const int i_pos,
-              const int j_pos,
-              const int il_a,
-              const int il_b,
-              const int b_a,
-              const int b_b,
-              int       *dG,
-              int       *dGplex,
-              int       *dGx,
-              int       *dGy)
+fbacktrack_XS(struct vrna_plex_s *plex,
+              int                i,
+              int                j,
+              const int          **access_s1,
+              const int          **access_s2,
+              const int          i_pos,
+              const int          j_pos,
+              const int          il_a,
+              const int          il_b,
+              const int          b_a,
+              const int          b_b,
+              int                *dG,
+              int                *dGplex,
+              int                *dGx,
+              int                *dGy)
 {
+  vrna_param_t  *P     = plex->P;
+  vrna_md_t     *md    = &(P->model_details);
+  int           *rtype = &(md->rtype[0]);
+
   /* backtrack structure going backwards from i, and forwards from j
    * return structure in bracket notation with & as separator */
   int   k, l, type, type2, E, traced, i0, j0;
@@ -1084,9 +1321,9 @@ fbacktrack_XS(int       i,
   int   iext_s    = 2 * il_a;   /* iext_s 2 nt nucleotide extension of interior loop, on i and j side */
   int   iext_ass  = 50 + il_a;  /* iext_ass assymetric extension of interior loop, either on i or on j side. */
 
-  st1 = (char *)vrna_alloc(sizeof(char) * (n3 + 1));
-  st2 = (char *)vrna_alloc(sizeof(char) * (n4 + 1));
-  i0  = MIN2(i + 1, n3 - 10);
+  st1 = (char *)vrna_alloc(sizeof(char) * (plex->n3 + 1));
+  st2 = (char *)vrna_alloc(sizeof(char) * (plex->n4 + 1));
+  i0  = MIN2(i + 1, plex->n3 - 10);
   j0  = MAX2(j - 1, 11);
   int state;
 
@@ -1105,31 +1342,19 @@ fbacktrack_XS(int       i,
   **/
 
   int       maxPenalty[4];
-  vrna_md_t md;
-
-  set_model_details(&md);
-
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    update_dfold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
 
   maxPenalty[0] = (int)-1 * P->stack[2][2] / 2;
   maxPenalty[1] = (int)-1 * P->stack[2][2];
   maxPenalty[2] = (int)-3 * P->stack[2][2] / 2;
   maxPenalty[3] = (int)-2 * P->stack[2][2];
 
-  type    = pair[S1[i]][S2[j]];
-  *dG     += vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1], P);
+  type    = md->pair[plex->S1[i]][plex->S2[j]];
+  *dG     += vrna_E_ext_stem(rtype[type], plex->SS2[j - 1], plex->SS1[i + 1], P);
   *dGplex = *dG;
 
-  while (i > 10 && j <= n4 - 9 && traced) {
+  while (i > 10 && j <= plex->n4 - 9 && traced) {
     int di1, di2, di3, di4;
-    idiff = i_pos - (n3 - 10 - i);
+    idiff = i_pos - (plex->n3 - 10 - i);
     di1   = 0.5 *
             (access_s1[5][idiff + 4] - access_s1[4][idiff + 4] + access_s1[5][idiff] -
              access_s1[4][idiff - 1]);
@@ -1181,33 +1406,33 @@ fbacktrack_XS(int       i,
     traced = 0;
     switch (state) {
       case 1:
-        type = pair[S1[i]][S2[j]];
+        type = md->pair[plex->S1[i]][plex->S2[j]];
         int bAU;
         bAU = (type > 2 ? P->TerminalAU : 0);
         if (!type)
           vrna_message_error("backtrack failed in fold duplex");
 
-        type2 = pair[S1[i - 1]][S2[j + 1]];
-        if (type2 && c[i][j] == (c[i - 1][j + 1] + P->stack[rtype[type]][type2] + di1 + dj1)) {
+        type2 = md->pair[plex->S1[i - 1]][plex->S2[j + 1]];
+        if (type2 && plex->c[i][j] == (plex->c[i - 1][j + 1] + P->stack[rtype[type]][type2] + di1 + dj1)) {
           k     = i - 1;
           l     = j + 1;
           (*dG) += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
                              rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
                              P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
                                rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
                                P);
           *dGx        += di1;
           *dGy        += dj1;
@@ -1220,28 +1445,28 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 1]][S2[j + 2]];
+        type2 = md->pair[plex->S1[i - 1]][plex->S2[j + 2]];
         if (type2 &&
-            c[i][j] == (c[i - 1][j + 2] + P->bulge[1] + P->stack[rtype[type]][type2] + di1 + dj2)) {
+            plex->c[i][j] == (plex->c[i - 1][j + 2] + P->bulge[1] + P->stack[rtype[type]][type2] + di1 + dj2)) {
           k   = i - 1;
           l   = j + 2;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
                                rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
                                P);
           *dGx        += di1;
           *dGy        += dj2;
@@ -1254,28 +1479,28 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 2]][S2[j + 1]];
+        type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 1]];
         if (type2 &&
-            c[i][j] == (c[i - 2][j + 1] + P->bulge[1] + P->stack[type2][rtype[type]] + di2 + dj1)) {
+            plex->c[i][j] == (plex->c[i - 2][j + 1] + P->bulge[1] + P->stack[type2][rtype[type]] + di2 + dj1)) {
           k   = i - 2;
           l   = j + 1;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
                                rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
                                P);
           *dGx        += di2;
           *dGy        += dj1;
@@ -1288,29 +1513,29 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 2]][S2[j + 2]];
+        type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 2]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 2][j + 2] + P->int11[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]] + di2 + dj2)) {
+            plex->c[i][j] ==
+            (plex->c[i - 2][j + 2] + P->int11[type2][rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + di2 + dj2)) {
           k   = i - 2;
           l   = j + 2;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
                                rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
                                P);
           *dGx        += di2;
           *dGy        += dj2;
@@ -1323,11 +1548,11 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 3]][S2[j + 3]];
+        type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 3]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 3][j + 3] +
-             P->int22[type2][rtype[type]][SS1[i - 2]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + di3 +
+            plex->c[i][j] ==
+            (plex->c[i - 3][j + 3] +
+             P->int22[type2][rtype[type]][plex->SS1[i - 2]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + di3 +
              dj3)) {
           k   = i - 3;
           l   = j + 3;
@@ -1335,19 +1560,19 @@ fbacktrack_XS(int       i,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
                                rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
                                P);
           *dGx        += di3;
           *dGy        += dj3;
@@ -1360,10 +1585,10 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 3]][S2[j + 2]];
+        type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 2]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 3][j + 2] + P->int21[rtype[type]][type2][SS2[j + 1]][SS1[i - 2]][SS1[i - 1]] +
+            plex->c[i][j] ==
+            (plex->c[i - 3][j + 2] + P->int21[rtype[type]][type2][plex->SS2[j + 1]][plex->SS1[i - 2]][plex->SS1[i - 1]] +
              di3 +
              dj2)) {
           k   = i - 3;
@@ -1372,19 +1597,19 @@ fbacktrack_XS(int       i,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
                                rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
                                P);
           *dGx        += di3;
           *dGy        += dj2;
@@ -1397,10 +1622,10 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 2]][S2[j + 3]];
+        type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 3]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 2][j + 3] + P->int21[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] +
+            plex->c[i][j] ==
+            (plex->c[i - 2][j + 3] + P->int21[type2][rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] +
              di2 +
              dj3)) {
           k   = i - 2;
@@ -1409,19 +1634,19 @@ fbacktrack_XS(int       i,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
                                rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
                                P);
           *dGx        += di2;
           *dGy        += dj3;
@@ -1434,29 +1659,29 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 4]][S2[j + 3]];
-        if (type2 && c[i][j] == (c[i - 4][j + 3] + P->internal_loop[5] + P->ninio[2] +
-                                 P->mismatch23I[type2][SS1[i - 3]][SS2[j + 2]] +
-                                 P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + di4 + dj3)) {
+        type2 = md->pair[plex->S1[i - 4]][plex->S2[j + 3]];
+        if (type2 && plex->c[i][j] == (plex->c[i - 4][j + 3] + P->internal_loop[5] + P->ninio[2] +
+                                 P->mismatch23I[type2][plex->SS1[i - 3]][plex->SS2[j + 2]] +
+                                 P->mismatch23I[rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + di4 + dj3)) {
           k   = i - 4;
           l   = j + 3;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
                                rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
                                P);
           *dGx        += di2;
           *dGy        += dj3;
@@ -1469,29 +1694,29 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S1[i - 3]][S2[j + 4]];
-        if (type2 && c[i][j] == (c[i - 3][j + 4] + P->internal_loop[5] + P->ninio[2] +
-                                 P->mismatch23I[type2][SS1[i - 2]][SS2[j + 3]] +
-                                 P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + di3 + dj4)) {
+        type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 4]];
+        if (type2 && plex->c[i][j] == (plex->c[i - 3][j + 4] + P->internal_loop[5] + P->ninio[2] +
+                                 P->mismatch23I[type2][plex->SS1[i - 2]][plex->SS2[j + 3]] +
+                                 P->mismatch23I[rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + di3 + dj4)) {
           k   = i - 3;
           l   = j + 4;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           *dGplex += E_IntLoop(i - k - 1,
                                l - j - 1,
                                type2,
                                rtype[type],
-                               SS1[k + 1],
-                               SS2[l - 1],
-                               SS1[i - 1],
-                               SS2[j + 1],
+                               plex->SS1[k + 1],
+                               plex->SS2[l - 1],
+                               plex->SS1[i - 1],
+                               plex->SS2[j + 1],
                                P);
           *dGx        += di2;
           *dGy        += dj3;
@@ -1504,12 +1729,12 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (c[i][j] ==
-            (in[i - 3][j + 3] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + di3 + dj3 + 2 *
+        if (plex->c[i][j] ==
+            (plex->in[i - 3][j + 3] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + di3 + dj3 + 2 *
              iext_s)) {
           k           = i;
           l           = j;
-          *dGplex     += P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + 2 * iext_s;
+          *dGplex     += P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 2 * iext_s;
           *dGx        += di3;
           *dGy        += dj3;
           st1[i - 1]  = '(';
@@ -1521,13 +1746,13 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (c[i][j] ==
-            (in[i - 4][j + 2] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + di4 + dj2 +
+        if (plex->c[i][j] ==
+            (plex->in[i - 4][j + 2] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + di4 + dj2 +
              iext_s +
              2 * iext_ass)) {
           k           = i;
           l           = j;
-          *dGplex     += P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass;
+          *dGplex     += P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass;
           *dGx        += di4;
           *dGy        += dj2;
           st1[i - 1]  = '(';
@@ -1539,13 +1764,13 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (c[i][j] ==
-            (in[i - 2][j + 4] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + di2 + dj4 +
+        if (plex->c[i][j] ==
+            (plex->in[i - 2][j + 4] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + di2 + dj4 +
              iext_s +
              2 * iext_ass)) {
           k           = i;
           l           = j;
-          *dGplex     += P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass;
+          *dGplex     += P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass;
           *dGx        += di2;
           *dGy        += dj4;
           st1[i - 1]  = '(';
@@ -1557,12 +1782,12 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (c[i][j] ==
-            (inx[i - 3][j + 1] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass +
+        if (plex->c[i][j] ==
+            (plex->inx[i - 3][j + 1] + P->mismatch1nI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass +
              iext_ass + di3 + dj1)) {
           k       = i;
           l       = j;
-          *dGplex += P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass +
+          *dGplex += P->mismatch1nI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass +
                      di3 + dj1;
           *dGx        += di3;
           *dGy        += dj1;
@@ -1575,12 +1800,12 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (c[i][j] ==
-            (iny[i - 1][j + 3] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass +
+        if (plex->c[i][j] ==
+            (plex->iny[i - 1][j + 3] + P->mismatch1nI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass +
              iext_ass + di1 + dj3)) {
           k       = i;
           l       = j;
-          *dGplex += P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass +
+          *dGplex += P->mismatch1nI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass +
                      di1 + dj3;
           *dGx        += di1;
           *dGy        += dj3;
@@ -1593,7 +1818,7 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (c[i][j] == (bx[i - 2][j + 1] + di2 + dj1 + bext + bAU)) {
+        if (plex->c[i][j] == (plex->bx[i - 2][j + 1] + di2 + dj1 + bext + bAU)) {
           k           = i;
           l           = j;
           st1[i - 1]  = '(';
@@ -1608,7 +1833,7 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (c[i][j] == (by[i - 1][j + 2] + di1 + dj2 + bext + bAU)) {
+        if (plex->c[i][j] == (plex->by[i - 1][j + 2] + di1 + dj2 + bext + bAU)) {
           k           = i;
           l           = j;
           *dGplex     += bext + bAU;
@@ -1625,7 +1850,7 @@ fbacktrack_XS(int       i,
 
         break;
       case 2:
-        if (in[i][j] == (in[i - 1][j + 1] + iext_s + di1 + dj1)) {
+        if (plex->in[i][j] == (plex->in[i - 1][j + 1] + iext_s + di1 + dj1)) {
           i--;
           j++;
           *dGplex += iext_s;
@@ -1636,7 +1861,7 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (in[i][j] == (in[i - 1][j] + iext_ass + di1)) {
+        if (plex->in[i][j] == (plex->in[i - 1][j] + iext_ass + di1)) {
           i       = i - 1;
           *dGplex += iext_ass;
           *dGx    += di1;
@@ -1645,7 +1870,7 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        if (in[i][j] == (in[i][j + 1] + iext_ass + dj1)) {
+        if (plex->in[i][j] == (plex->in[i][j + 1] + iext_ass + dj1)) {
           j++;
           state   = 2;
           *dGy    += dj1;
@@ -1654,11 +1879,11 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[SS2[j + 1]][SS1[i - 1]];
+        type2 = md->pair[plex->SS2[j + 1]][plex->SS1[i - 1]];
         if (type2 &&
-            in[i][j] ==
-            (c[i - 1][j + 1] + P->mismatchI[type2][SS2[j]][SS1[i]] + iopen + iext_s + di1 + dj1)) {
-          *dGplex += P->mismatchI[type2][SS2[j]][SS1[i]] + iopen + iext_s;
+            plex->in[i][j] ==
+            (plex->c[i - 1][j + 1] + P->mismatchI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s + di1 + dj1)) {
+          *dGplex += P->mismatchI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s;
           int temp;
           temp  = k;
           k     = i - 1;
@@ -1666,15 +1891,15 @@ fbacktrack_XS(int       i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = md->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
                              rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
                              P);
           *dGx    += di1;
           *dGy    += dj1;
@@ -1686,7 +1911,7 @@ fbacktrack_XS(int       i,
         }
 
       case 3:
-        if (bx[i][j] == (bx[i - 1][j] + bext + di1)) {
+        if (plex->bx[i][j] == (plex->bx[i - 1][j] + bext + di1)) {
           i--;
           *dGplex += bext;
           *dGx    += di1;
@@ -1695,9 +1920,9 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S2[j]][S1[i - 1]];
+        type2 = md->pair[plex->S2[j]][plex->S1[i - 1]];
         if (type2 &&
-            bx[i][j] == (c[i - 1][j] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0) + di1)) {
+            plex->bx[i][j] == (plex->c[i - 1][j] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0) + di1)) {
           int temp;
           temp  = k;
           k     = i - 1;
@@ -1705,15 +1930,15 @@ fbacktrack_XS(int       i,
           temp  = l;
           l     = j;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = md->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
                              rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
                              P);
           *dGplex += bopen + bext + (type2 > 2 ? P->TerminalAU : 0);
           *dGx    += di1;
@@ -1725,7 +1950,7 @@ fbacktrack_XS(int       i,
         }
 
       case 4:
-        if (by[i][j] == (by[i][j + 1] + bext + dj1)) {
+        if (plex->by[i][j] == (plex->by[i][j + 1] + bext + dj1)) {
           j++;
           *dGplex += bext;
           state   = 4;
@@ -1733,9 +1958,9 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S2[j + 1]][S1[i]];
+        type2 = md->pair[plex->S2[j + 1]][plex->S1[i]];
         if (type2 &&
-            by[i][j] == (c[i][j + 1] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0) + dj1)) {
+            plex->by[i][j] == (plex->c[i][j + 1] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0) + dj1)) {
           int temp;
           temp  = k;
           k     = i;
@@ -1743,15 +1968,15 @@ fbacktrack_XS(int       i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = md->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
                              rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
                              P);
           *dGplex += bopen + bext + (type2 > 2 ? P->TerminalAU : 0);
           *dGy    += dj1;
@@ -1763,7 +1988,7 @@ fbacktrack_XS(int       i,
         }
 
       case 5:
-        if (inx[i][j] == (inx[i - 1][j] + iext_ass + di1)) {
+        if (plex->inx[i][j] == (plex->inx[i - 1][j] + iext_ass + di1)) {
           i--;
           *dGplex += iext_ass;
           *dGx    += di1;
@@ -1772,12 +1997,12 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S2[j + 1]][S1[i - 1]];
+        type2 = md->pair[plex->S2[j + 1]][plex->S1[i - 1]];
         if (type2 &&
-            inx[i][j] ==
-            (c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s + di1 +
+            plex->inx[i][j] ==
+            (plex->c[i - 1][j + 1] + P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s + di1 +
              dj1)) {
-          *dGplex += P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s;
+          *dGplex += P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s;
           int temp;
           temp  = k;
           k     = i - 1;
@@ -1785,15 +2010,15 @@ fbacktrack_XS(int       i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = md->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
                              rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
                              P);
           *dGx    += di1;
           *dGy    += dj1;
@@ -1805,7 +2030,7 @@ fbacktrack_XS(int       i,
         }
 
       case 6:
-        if (iny[i][j] == (iny[i][j + 1] + iext_ass + dj1)) {
+        if (plex->iny[i][j] == (plex->iny[i][j + 1] + iext_ass + dj1)) {
           j++;
           *dGplex += iext_ass;
           *dGx    += dj1;
@@ -1814,12 +2039,12 @@ fbacktrack_XS(int       i,
           break;
         }
 
-        type2 = pair[S2[j + 1]][S1[i - 1]];
+        type2 = md->pair[plex->S2[j + 1]][plex->S1[i - 1]];
         if (type2 &&
-            iny[i][j] ==
-            (c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s + di1 +
+            plex->iny[i][j] ==
+            (plex->c[i - 1][j + 1] + P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s + di1 +
              dj1)) {
-          *dGplex += P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s;
+          *dGplex += P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s;
           int temp;
           temp  = k;
           k     = i - 1;
@@ -1827,15 +2052,15 @@ fbacktrack_XS(int       i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = md->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
                              rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
                              P);
           *dGx    += di1;
           *dGy    += dj1;
@@ -1848,16 +2073,16 @@ fbacktrack_XS(int       i,
     }
   }
   if (!traced) {
-    idiff = i_pos - (n3 - 10 - i);
+    idiff = i_pos - (plex->n3 - 10 - i);
     jdiff = j_pos + j - 11;
-    E     = c[i][j];
+    E     = plex->c[i][j];
     /**
     *** if (i>1) {E -= P->dangle5[type][SS1[i-1]]; *dG+=P->dangle5[type][SS1[i-1]];*dGplex+=P->dangle5[type][SS1[i-1]];}
     *** if (j<n4){E -= P->dangle3[type][SS2[j+1]]; *dG+=P->dangle3[type][SS2[j+1]];*dGplex+=P->dangle3[type][SS2[j+1]];}
     *** if (type>2) {E -= P->TerminalAU; *dG+=P->TerminalAU;*dGplex+=P->TerminalAU;}
     **/
     int correction;
-    correction  = vrna_E_ext_stem(type, (i > 1) ? SS1[i - 1] : -1, (j < n4) ? SS2[j + 1] : -1, P);
+    correction  = vrna_E_ext_stem(type, (i > 1) ? plex->SS1[i - 1] : -1, (j < plex->n4) ? plex->SS2[j + 1] : -1, P);
     *dG         += correction;
     *dGplex     += correction;
     E           -= correction;
@@ -1882,7 +2107,7 @@ fbacktrack_XS(int       i,
   if (i > 11)
     i--;
 
-  if (j < n4 - 10)
+  if (j < plex->n4 - 10)
     j++;
 
   struc = (char *)vrna_alloc(i0 - i + 1 + j - j0 + 1 + 2);
@@ -1904,20 +2129,25 @@ fbacktrack_XS(int       i,
 }
 
 
-duplexT **
-Lduplexfold_XS(const char *s1,
-               const char *s2,
-               const int  **access_s1,
-               const int  **access_s2,
-               const int  threshold,
-               const int  alignment_length,
-               const int  delta,
-               const int  fast,
-               const int  il_a,
-               const int  il_b,
-               const int  b_a,
-               const int  b_b)
+PRIVATE void
+plex_fold_XS(struct vrna_plex_s *plex,
+             const char         *s1,
+             const char         *s2,
+             const int          **access_s1,
+             const int          **access_s2,
+             const int          threshold,
+             const int          alignment_length,
+             const int          delta,
+             const int          fast,
+             const int          il_a,
+             const int          il_b,
+             const int          b_a,
+             const int          b_b)
 {
+  vrna_param_t  *P     = plex->P;
+  vrna_md_t     *md    = &(P->model_details);
+  int           *rtype = &(md->rtype[0]);
+
   /**
   *** See variable definition in fduplexfold_XS
   **/
@@ -1936,40 +2166,37 @@ Lduplexfold_XS(const char *s1,
   int       *position;
   int       *position_j;
   int       maxPenalty[4];
+  int       **DI;
   int       **DJ;
   /**
   *** 1D array corresponding to the standard 2d recursion matrix
   *** Makes the computation 20% faster
   **/
   int       *SA;
-  vrna_md_t md;
+  /**
+  *** query profile, penalties and costs for the vectorized column fill
+  **/
+  struct plex_profile *prof;
+  struct plex_costs   costs = {
+    0, bopen, bext, iopen, iext_s, iext_ass
+  };
+  const int           *dj[5];
 
   /**
   *** variable initialization
   **/
-  n1  = (int)strlen(s1);
-  n2  = (int)strlen(s2);
+  plex->n1  = (int)strlen(s1);
+  plex->n2  = (int)strlen(s2);
   /**
   *** Sequence encoding
   **/
 
-  set_model_details(&md);
-
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    update_dfold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
-
-  encode_seqs(s1, s2);
+  prepare_seqs(plex, s1, s2);
   /**
   *** Position of the high score on the target and query sequence
   **/
-  position    = (int *)vrna_alloc((delta + n1 + 3 + delta) * sizeof(int));
-  position_j  = (int *)vrna_alloc((delta + n1 + 3 + delta) * sizeof(int));
+  position    = (int *)vrna_alloc((delta + plex->n1 + 3 + delta) * sizeof(int));
+  position_j  = (int *)vrna_alloc((delta + plex->n1 + 3 + delta) * sizeof(int));
   /**
   *** extension penalty, computed only once, further reduce the computation time
   **/
@@ -1978,12 +2205,20 @@ Lduplexfold_XS(const char *s1,
   maxPenalty[2] = (int)-3 * P->stack[2][2] / 2;
   maxPenalty[3] = (int)-2 * P->stack[2][2];
 
+  /**
+  *** accessibility penalties of the target, unless they are shared by all queries
+  **/
+  if ((plex->target) && (plex->target->DI))
+    DI = plex->target->DI;
+  else
+    DI = target_penalties(access_s1, plex->n1);
+
   DJ    = (int **)vrna_alloc(4 * sizeof(int *));
-  DJ[0] = (int *)vrna_alloc(n2 * sizeof(int));
-  DJ[1] = (int *)vrna_alloc(n2 * sizeof(int));
-  DJ[2] = (int *)vrna_alloc(n2 * sizeof(int));
-  DJ[3] = (int *)vrna_alloc(n2 * sizeof(int));
-  j     = n2 - 9;
+  DJ[0] = (int *)vrna_alloc(plex->n2 * sizeof(int));
+  DJ[1] = (int *)vrna_alloc(plex->n2 * sizeof(int));
+  DJ[2] = (int *)vrna_alloc(plex->n2 * sizeof(int));
+  DJ[3] = (int *)vrna_alloc(plex->n2 * sizeof(int));
+  j     = plex->n2 - 9;
   while (--j > 10) {
     DJ[0][j] = 0.5 *
                (access_s2[5][j + 4] - access_s2[4][j + 4] + access_s2[5][j] - access_s2[4][j - 1]);
@@ -2024,8 +2259,8 @@ Lduplexfold_XS(const char *s1,
   ***                  * length of the sequence
   **/
 
-  SA = (int *)vrna_alloc(sizeof(int) * 5 * 6 * (n2 + 5));
-  for (j = n2 + 4; j >= 0; j--) {
+  SA = (int *)vrna_alloc(sizeof(int) * 5 * 6 * (plex->n2 + 5));
+  for (j = plex->n2 + 4; j >= 0; j--) {
     SA[(j *
         30)]            =
       SA[(j * 30) + 1]  = SA[(j * 30) + 2] = SA[(j * 30) + 3] = SA[(j * 30) + 4] = INF;
@@ -2056,8 +2291,15 @@ Lduplexfold_XS(const char *s1,
         SA[(j * 30) + 2 + 25] = SA[(j * 30) + 3 + 25] = SA[(j * 30) + 4 + 25] = INF;
   }
 
+  prof = simd_profile_init(plex);
+  if (prof) {
+    dj[0] = prof->zero;
+    for (j = 1; j < 5; j++)
+      dj[j] = DJ[j - 1];
+  }
+
   i         = 10;
-  i_length  = n1 - 9;
+  i_length  = plex->n1 - 9;
   while (i < i_length) {
     int di1, di2, di3, di4;
     int idx   = i % 5;
@@ -2065,16 +2307,10 @@ Lduplexfold_XS(const char *s1,
     int idx_2 = (i - 2) % 5;
     int idx_3 = (i - 3) % 5;
     int idx_4 = (i - 4) % 5;
-    di1 = 0.5 * (access_s1[5][i + 4] - access_s1[4][i + 4] + access_s1[5][i] - access_s1[4][i - 1]);
-    di2 = 0.5 *
-          (access_s1[5][i + 3] - access_s1[4][i + 3] + access_s1[5][i - 1] - access_s1[4][i - 2]) +
-          di1;
-    di3 = 0.5 *
-          (access_s1[5][i + 2] - access_s1[4][i + 2] + access_s1[5][i - 2] - access_s1[4][i - 3]) +
-          di2;
-    di4 = 0.5 *
-          (access_s1[5][i + 1] - access_s1[4][i + 1] + access_s1[5][i - 3] - access_s1[4][i - 4]) +
-          di3;
+    di1 = DI[0][i];
+    di2 = DI[1][i];
+    di3 = DI[2][i];
+    di4 = DI[3][i];
     /*
      *  di1 = access_s1[5][i]   - access_s1[4][i-1];
      *  di2 = access_s1[5][i-1] - access_s1[4][i-2] + di1;
@@ -2085,232 +2321,239 @@ Lduplexfold_XS(const char *s1,
      *  di3=MIN2(di3,maxPenalty[2]);
      *  di4=MIN2(di4,maxPenalty[3]);
      */
-    j = n2 - 9;
-    while (--j > 9) {
-      int dj1, dj2, dj3, dj4;
-      dj1 = DJ[0][j];
-      dj2 = DJ[1][j];
-      dj3 = DJ[2][j];
-      dj4 = DJ[3][j];
-      int type2, type, temp;
-      type = pair[S1[i]][S2[j]];
-      /**
-      *** Start duplex
-      **/
-      /* SA[LCI(idx,j,n2)] = type ? P->DuplexInit + access_s1[1][i] + access_s2[1][j] : INF; */
-      SA[LCI(idx, j, n2)] = type ? P->DuplexInit : INF;
-      /**
-      *** update lin bx by linx liny matrix
-      **/
-      type2 = pair[S2[j + 1]][S1[i - 1]];
-      /**
-      *** start/extend interior loop
-      **/
-      SA[LINI(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                         n2)] + P->mismatchI[type2][SS2[j]][SS1[i]] + di1 + dj1 + iopen + iext_s,
-                                  SA[LINI(idx_1, j, n2)] + iext_ass + di1);
+    if (prof) {
+      const int di[5] = {
+        0, di1, di2, di3, di4
+      };
+      fill_column_simd(plex, SA, prof, i, di, dj, &costs, &min_colonne, &min_j_colonne);
+    } else {
+      j = plex->n2 - 9;
+      while (--j > 9) {
+        int dj1, dj2, dj3, dj4;
+        dj1 = DJ[0][j];
+        dj2 = DJ[1][j];
+        dj3 = DJ[2][j];
+        dj4 = DJ[3][j];
+        int type2, type, temp;
+        type = md->pair[plex->S1[i]][plex->S2[j]];
+        /**
+        *** Start duplex
+        **/
+        /* SA[LCI(idx,j,n2)] = type ? P->DuplexInit + access_s1[1][i] + access_s2[1][j] : INF; */
+        SA[LCI(idx, j, plex->n2)] = type ? P->DuplexInit : INF;
+        /**
+        *** update lin bx by linx liny matrix
+        **/
+        type2 = md->pair[plex->S2[j + 1]][plex->S1[i - 1]];
+        /**
+        *** start/extend interior loop
+        **/
+        SA[LINI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                           plex->n2)] + P->mismatchI[type2][plex->SS2[j]][plex->SS1[i]] + di1 + dj1 + iopen + iext_s,
+                                    SA[LINI(idx_1, j, plex->n2)] + iext_ass + di1);
+
+        /**
+        *** start/extend nx1 target
+        *** use same type2 as for in
+        **/
+        SA[LINIX(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                            plex->n2)] + P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + di1 + dj1 + iopen + iext_s,
+                                     SA[LINIX(idx_1, j, plex->n2)] + iext_ass + di1);
+        /**
+        *** start/extend 1xn target
+        *** use same type2 as for in
+        **/
+        SA[LINIY(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                            plex->n2)] + P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + di1 + dj1 + iopen + iext_s,
+                                     SA[LINIY(idx, j + 1, plex->n2)] + iext_ass + dj1);
+        /**
+        *** extend interior loop
+        **/
+        SA[LINI(idx, j, plex->n2)]  = MIN2(SA[LINI(idx, j, plex->n2)], SA[LINI(idx, j + 1, plex->n2)] + iext_ass + dj1);
+        SA[LINI(idx, j, plex->n2)]  = MIN2(SA[LINI(idx, j, plex->n2)],
+                                     SA[LINI(idx_1, j + 1, plex->n2)] + iext_s + di1 + dj1);
+        /**
+        *** start/extend bulge target
+        **/
+        type2                 = md->pair[plex->S2[j]][plex->S1[i - 1]];
+        SA[LBXI(idx, j, plex->n2)]  = MIN2(SA[LBXI(idx_1, j, plex->n2)] + bext + di1,
+                                     SA[LCI(idx_1, j,
+                                            plex->n2)] + bopen + bext +
+                                     (type2 > 2 ? P->TerminalAU : 0) + di1);
+        /**
+        *** start/extend bulge query
+        **/
+        type2                 = md->pair[plex->S2[j + 1]][plex->S1[i]];
+        SA[LBYI(idx, j, plex->n2)]  = MIN2(SA[LBYI(idx, j + 1, plex->n2)] + bext + dj1,
+                                     SA[LCI(idx, j + 1,
+                                            plex->n2)] + bopen + bext +
+                                     (type2 > 2 ? P->TerminalAU : 0) + dj1);
+        /**
+         ***end update recursion
+         **/
+        if (!type)
+          continue; /**
+                    *** stack extension
+                    **/
+
+        SA[LCI(idx, j, plex->n2)] += vrna_E_ext_stem(type, plex->SS1[i - 1], plex->SS2[j + 1], P);
+        /**
+        *** stack extension
+        **/
+        if ((type2 = md->pair[plex->S1[i - 1]][plex->S2[j + 1]]))
+          SA[LCI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                            plex->n2)] + P->stack[rtype[type]][type2] + di1 + dj1,
+                                     SA[LCI(idx, j, plex->n2)]);
+
+        /**
+        *** 1x0 / 0x1 stack extension
+        **/
+        if ((type2 = md->pair[plex->S1[i - 1]][plex->S2[j + 2]])) {
+          SA[LCI(idx, j,
+                 plex->n2)] = MIN2(SA[LCI(idx_1, j + 2,
+                                    plex->n2)] + P->bulge[1] + P->stack[rtype[type]][type2] + di1 + dj2,
+                             SA[LCI(idx, j, plex->n2)]);
+        }
 
-      /**
-      *** start/extend nx1 target
-      *** use same type2 as for in
-      **/
-      SA[LINIX(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                          n2)] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + di1 + dj1 + iopen + iext_s,
-                                   SA[LINIX(idx_1, j, n2)] + iext_ass + di1);
-      /**
-      *** start/extend 1xn target
-      *** use same type2 as for in
-      **/
-      SA[LINIY(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                          n2)] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + di1 + dj1 + iopen + iext_s,
-                                   SA[LINIY(idx, j + 1, n2)] + iext_ass + dj1);
-      /**
-      *** extend interior loop
-      **/
-      SA[LINI(idx, j, n2)]  = MIN2(SA[LINI(idx, j, n2)], SA[LINI(idx, j + 1, n2)] + iext_ass + dj1);
-      SA[LINI(idx, j, n2)]  = MIN2(SA[LINI(idx, j, n2)],
-                                   SA[LINI(idx_1, j + 1, n2)] + iext_s + di1 + dj1);
-      /**
-      *** start/extend bulge target
-      **/
-      type2                 = pair[S2[j]][S1[i - 1]];
-      SA[LBXI(idx, j, n2)]  = MIN2(SA[LBXI(idx_1, j, n2)] + bext + di1,
-                                   SA[LCI(idx_1, j,
-                                          n2)] + bopen + bext +
-                                   (type2 > 2 ? P->TerminalAU : 0) + di1);
-      /**
-      *** start/extend bulge query
-      **/
-      type2                 = pair[S2[j + 1]][S1[i]];
-      SA[LBYI(idx, j, n2)]  = MIN2(SA[LBYI(idx, j + 1, n2)] + bext + dj1,
-                                   SA[LCI(idx, j + 1,
-                                          n2)] + bopen + bext +
-                                   (type2 > 2 ? P->TerminalAU : 0) + dj1);
-      /**
-       ***end update recursion
-       **/
-      if (!type)
-        continue; /**
-                  *** stack extension
-                  **/
+        if ((type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 1]])) {
+          SA[LCI(idx, j,
+                 plex->n2)] = MIN2(SA[LCI(idx_2, j + 1,
+                                    plex->n2)] + P->bulge[1] + P->stack[type2][rtype[type]] + di2 + dj1,
+                             SA[LCI(idx, j, plex->n2)]);
+        }
 
-      SA[LCI(idx, j, n2)] += vrna_E_ext_stem(type, SS1[i - 1], SS2[j + 1], P);
-      /**
-      *** stack extension
-      **/
-      if ((type2 = pair[S1[i - 1]][S2[j + 1]]))
-        SA[LCI(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                          n2)] + P->stack[rtype[type]][type2] + di1 + dj1,
-                                   SA[LCI(idx, j, n2)]);
+        /**
+        *** 1x1 / 2x2 stack extension
+        **/
+        if ((type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 2]])) {
+          SA[LCI(idx, j,
+                 plex->n2)] = MIN2(SA[LCI(idx_2, j + 2,
+                                    plex->n2)] + P->int11[type2][rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + di2 + dj2,
+                             SA[LCI(idx, j, plex->n2)]);
+        }
 
-      /**
-      *** 1x0 / 0x1 stack extension
-      **/
-      if ((type2 = pair[S1[i - 1]][S2[j + 2]])) {
-        SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_1, j + 2,
-                                  n2)] + P->bulge[1] + P->stack[rtype[type]][type2] + di1 + dj2,
-                           SA[LCI(idx, j, n2)]);
-      }
+        if ((type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 3]])) {
+          SA[LCI(idx, j,
+                 plex->n2)] = MIN2(SA[LCI(idx_3, j + 3,
+                                    plex->n2)] +
+                             P->int22[type2][rtype[type]][plex->SS1[i - 2]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j +
+                                                                                                  2]] + di3 + dj3,
+                             SA[LCI(idx, j, plex->n2)]);
+        }
 
-      if ((type2 = pair[S1[i - 2]][S2[j + 1]])) {
-        SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_2, j + 1,
-                                  n2)] + P->bulge[1] + P->stack[type2][rtype[type]] + di2 + dj1,
-                           SA[LCI(idx, j, n2)]);
-      }
+        /**
+        *** 1x2 / 2x1 stack extension
+        *** E_IntLoop(1,2,type2, rtype[type],SS1[i-1], SS2[j+2], SS1[i-1], SS2[j+1], P) corresponds to
+        *** P->int21[rtype[type]][type2][SS2[j+2]][SS1[i-1]][SS1[i-1]]
+        **/
+        if ((type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 2]])) {
+          SA[LCI(idx, j,
+                 plex->n2)] = MIN2(SA[LCI(idx_3, j + 2,
+                                    plex->n2)] +
+                             P->int21[rtype[type]][type2][plex->SS2[j + 1]][plex->SS1[i - 2]][plex->SS1[i - 1]] + di3 + dj2,
+                             SA[LCI(idx, j, plex->n2)]);
+        }
 
-      /**
-      *** 1x1 / 2x2 stack extension
-      **/
-      if ((type2 = pair[S1[i - 2]][S2[j + 2]])) {
-        SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_2, j + 2,
-                                  n2)] + P->int11[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]] + di2 + dj2,
-                           SA[LCI(idx, j, n2)]);
-      }
+        if ((type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 3]])) {
+          SA[LCI(idx, j,
+                 plex->n2)] = MIN2(SA[LCI(idx_2, j + 3,
+                                    plex->n2)] +
+                             P->int21[type2][rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + di2 + dj3,
+                             SA[LCI(idx, j, plex->n2)]);
+        }
 
-      if ((type2 = pair[S1[i - 3]][S2[j + 3]])) {
-        SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_3, j + 3,
-                                  n2)] +
-                           P->int22[type2][rtype[type]][SS1[i - 2]][SS1[i - 1]][SS2[j + 1]][SS2[j +
-                                                                                                2]] + di3 + dj3,
-                           SA[LCI(idx, j, n2)]);
-      }
+        /**
+        *** 2x3 / 3x2 stack extension
+        **/
+        if ((type2 = md->pair[plex->S1[i - 4]][plex->S2[j + 3]])) {
+          SA[LCI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_4, j + 3, plex->n2)] + P->internal_loop[5] + P->ninio[2] +
+                                     P->mismatch23I[type2][plex->SS1[i - 3]][plex->SS2[j + 2]] +
+                                     P->mismatch23I[rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + di4 + dj3,
+                                     SA[LCI(idx, j, plex->n2)]);
+        }
 
-      /**
-      *** 1x2 / 2x1 stack extension
-      *** E_IntLoop(1,2,type2, rtype[type],SS1[i-1], SS2[j+2], SS1[i-1], SS2[j+1], P) corresponds to
-      *** P->int21[rtype[type]][type2][SS2[j+2]][SS1[i-1]][SS1[i-1]]
-      **/
-      if ((type2 = pair[S1[i - 3]][S2[j + 2]])) {
-        SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_3, j + 2,
-                                  n2)] +
-                           P->int21[rtype[type]][type2][SS2[j + 1]][SS1[i - 2]][SS1[i - 1]] + di3 + dj2,
-                           SA[LCI(idx, j, n2)]);
-      }
+        if ((type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 4]])) {
+          SA[LCI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_3, j + 4, plex->n2)] + P->internal_loop[5] + P->ninio[2] +
+                                     P->mismatch23I[type2][plex->SS1[i - 2]][plex->SS2[j + 3]] +
+                                     P->mismatch23I[rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + di3 + dj4,
+                                     SA[LCI(idx, j, plex->n2)]);
+        }
 
-      if ((type2 = pair[S1[i - 2]][S2[j + 3]])) {
+        /**
+        *** So now we have to handle 1x3, 3x1, 3x3, and mxn m,n > 3
+        **/
+        /**
+        *** 3x3 or more
+        **/
         SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_2, j + 3,
-                                  n2)] +
-                           P->int21[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + di2 + dj3,
-                           SA[LCI(idx, j, n2)]);
-      }
+               plex->n2)] = MIN2(SA[LINI(idx_3, j + 3,
+                                   plex->n2)] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 2 * iext_s + di3 + dj3,
+                           SA[LCI(idx, j, plex->n2)]);
+        /**
+        *** 2xn or more
+        **/
+        SA[LCI(idx, j,
+               plex->n2)] = MIN2(SA[LINI(idx_4, j + 2,
+                                   plex->n2)] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + di4 + dj2,
+                           SA[LCI(idx, j, plex->n2)]);
+        /**
+        *** nx2 or more
+        **/
+        SA[LCI(idx, j,
+               plex->n2)] = MIN2(SA[LINI(idx_2, j + 4,
+                                   plex->n2)] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + di2 + dj4,
+                           SA[LCI(idx, j, plex->n2)]);
+        /**
+        *** nx1 n>2
+        **/
+        SA[LCI(idx, j,
+               plex->n2)] = MIN2(SA[LINIX(idx_3, j + 1,
+                                    plex->n2)] + P->mismatch1nI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + di3 + dj1,
+                           SA[LCI(idx, j, plex->n2)]);
+        /**
+        *** 1xn n>2
+        **/
+        SA[LCI(idx, j,
+               plex->n2)] = MIN2(SA[LINIY(idx_1, j + 3,
+                                    plex->n2)] + P->mismatch1nI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + dj3 + di1,
+                           SA[LCI(idx, j, plex->n2)]);
+        /**
+        *** nx0 n>1
+        **/
+        int bAU;
+        bAU = (type > 2 ? P->TerminalAU : 0);
+        SA[LCI(idx, j,
+               plex->n2)] = MIN2(SA[LBXI(idx_2, j + 1, plex->n2)] + di2 + dj1 + bext + bAU, SA[LCI(idx, j, plex->n2)]);
+        /**
+        *** 0xn n>1
+        **/
+        SA[LCI(idx, j,
+               plex->n2)] = MIN2(SA[LBYI(idx_1, j + 2, plex->n2)] + di1 + dj2 + bext + bAU, SA[LCI(idx, j, plex->n2)]);
+        temp        = min_colonne;
+        /**
+        *** (type>2?P->TerminalAU:0)+
+        *** P->dangle3[rtype[type]][SS1[i+1]]+
+        *** P->dangle5[rtype[type]][SS2[j-1]],
+        **/
+        /*
+         * remove this line printf("LCI %d:%d %d\t",i,j,SA[LCI(idx,j,n2)]);
+         * remove this line printf("LI %d:%d %d\t",i,j, SA[LINI(idx,j,n2)]);
+         */
+        min_colonne =
+          MIN2(SA[LCI(idx, j, plex->n2)] + vrna_E_ext_stem(rtype[type], plex->SS2[j - 1], plex->SS1[i + 1], P),
+               min_colonne);
 
-      /**
-      *** 2x3 / 3x2 stack extension
-      **/
-      if ((type2 = pair[S1[i - 4]][S2[j + 3]])) {
-        SA[LCI(idx, j, n2)] = MIN2(SA[LCI(idx_4, j + 3, n2)] + P->internal_loop[5] + P->ninio[2] +
-                                   P->mismatch23I[type2][SS1[i - 3]][SS2[j + 2]] +
-                                   P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + di4 + dj3,
-                                   SA[LCI(idx, j, n2)]);
-      }
+        if (temp > min_colonne)
+          min_j_colonne = j;
 
-      if ((type2 = pair[S1[i - 3]][S2[j + 4]])) {
-        SA[LCI(idx, j, n2)] = MIN2(SA[LCI(idx_3, j + 4, n2)] + P->internal_loop[5] + P->ninio[2] +
-                                   P->mismatch23I[type2][SS1[i - 2]][SS2[j + 3]] +
-                                   P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + di3 + dj4,
-                                   SA[LCI(idx, j, n2)]);
+        /* ---------------------------------------------------------------------end update */
       }
-
-      /**
-      *** So now we have to handle 1x3, 3x1, 3x3, and mxn m,n > 3
-      **/
-      /**
-      *** 3x3 or more
-      **/
-      SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINI(idx_3, j + 3,
-                                 n2)] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + 2 * iext_s + di3 + dj3,
-                         SA[LCI(idx, j, n2)]);
-      /**
-      *** 2xn or more
-      **/
-      SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINI(idx_4, j + 2,
-                                 n2)] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + di4 + dj2,
-                         SA[LCI(idx, j, n2)]);
-      /**
-      *** nx2 or more
-      **/
-      SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINI(idx_2, j + 4,
-                                 n2)] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + di2 + dj4,
-                         SA[LCI(idx, j, n2)]);
-      /**
-      *** nx1 n>2
-      **/
-      SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINIX(idx_3, j + 1,
-                                  n2)] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + di3 + dj1,
-                         SA[LCI(idx, j, n2)]);
-      /**
-      *** 1xn n>2
-      **/
-      SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINIY(idx_1, j + 3,
-                                  n2)] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + dj3 + di1,
-                         SA[LCI(idx, j, n2)]);
-      /**
-      *** nx0 n>1
-      **/
-      int bAU;
-      bAU = (type > 2 ? P->TerminalAU : 0);
-      SA[LCI(idx, j,
-             n2)] = MIN2(SA[LBXI(idx_2, j + 1, n2)] + di2 + dj1 + bext + bAU, SA[LCI(idx, j, n2)]);
-      /**
-      *** 0xn n>1
-      **/
-      SA[LCI(idx, j,
-             n2)] = MIN2(SA[LBYI(idx_1, j + 2, n2)] + di1 + dj2 + bext + bAU, SA[LCI(idx, j, n2)]);
-      temp        = min_colonne;
-      /**
-      *** (type>2?P->TerminalAU:0)+
-      *** P->dangle3[rtype[type]][SS1[i+1]]+
-      *** P->dangle5[rtype[type]][SS2[j-1]],
-      **/
-      /*
-       * remove this line printf("LCI %d:%d %d\t",i,j,SA[LCI(idx,j,n2)]);
-       * remove this line printf("LI %d:%d %d\t",i,j, SA[LINI(idx,j,n2)]);
-       */
-      min_colonne =
-        MIN2(SA[LCI(idx, j, n2)] + vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1], P),
-             min_colonne);
-
-      if (temp > min_colonne)
-        min_j_colonne = j;
-
-      /* ---------------------------------------------------------------------end update */
-    }
-    if (max >= min_colonne) {
-      max       = min_colonne;
-      max_pos   = i;
-      max_pos_j = min_j_colonne;
-    }
+    }
+    if (max >= min_colonne) {
+      max       = min_colonne;
+      max_pos   = i;
+      max_pos_j = min_j_colonne;
+    }
 
     position[i + delta]   = min_colonne;
     min_colonne           = INF;
@@ -2319,13 +2562,12 @@ Lduplexfold_XS(const char *s1,
     i++;
   }
   /* printf("MAX: %d",max); */
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
+  release_seqs(plex);
   free(SA);
+  profile_free(prof);
   if (max < threshold) {
-    find_max_XS(position,
+    find_max_XS(plex,
+                position,
                 position_j,
                 delta,
                 threshold,
@@ -2342,7 +2584,8 @@ Lduplexfold_XS(const char *s1,
   }
 
   if (max < INF) {
-    plot_max_XS(max,
+    plot_max_XS(plex,
+                max,
                 max_pos,
                 max_pos_j,
                 alignment_length,
@@ -2357,32 +2600,35 @@ Lduplexfold_XS(const char *s1,
                 b_b);
   }
 
+  if (DI != ((plex->target) ? plex->target->DI : NULL))
+    penalties_free(DI);
+
   for (i = 0; i <= 3; i++)
     free(DJ[i]);
   free(DJ);
   free(position);
   free(position_j);
-  return NULL;
 }
 
 
 PRIVATE void
-find_max_XS(const int   *position,
-            const int   *position_j,
-            const int   delta,
-            const int   threshold,
-            const int   alignment_length,
-            const char  *s1,
-            const char  *s2,
-            const int   **access_s1,
-            const int   **access_s2,
-            const int   fast,
-            const int   il_a,
-            const int   il_b,
-            const int   b_a,
-            const int   b_b)
+find_max_XS(struct vrna_plex_s  *plex,
+            const int           *position,
+            const int           *position_j,
+            const int           delta,
+            const int           threshold,
+            const int           alignment_length,
+            const char          *s1,
+            const char          *s2,
+            const int           **access_s1,
+            const int           **access_s2,
+            const int           fast,
+            const int           il_a,
+            const int           il_b,
+            const int           b_a,
+            const int           b_b)
 {
-  int pos = n1 - 9;
+  int pos = plex->n1 - 9;
 
   if (fast == 1) {
     while (10 < pos--) {
@@ -2399,15 +2645,15 @@ find_max_XS(const int   *position,
         max_pos_j = position_j[pos + delta];
         int max;
         max = position[pos + delta];
-        printf("target upper bound %d: query lower bound %d  (%5.2f) \n",
-               pos - 10,
-               max_pos_j - 10,
-               ((double)max) / 100);
+        vrna_cstr_printf(plex->out, "target upper bound %d: query lower bound %d  (%5.2f) \n",
+                                    pos - 10,
+                                    max_pos_j - 10,
+                                    ((double)max) / 100);
         pos = MAX2(10, pos + temp_min - delta);
       }
     }
   } else if (fast == 2) {
-    pos = n1 - 9;
+    pos = plex->n1 - 9;
     while (10 < pos--) {
       int temp_min = 0;
       if (position[pos + delta] < (threshold)) {
@@ -2426,11 +2672,11 @@ find_max_XS(const int   *position,
          * max_pos_j -> position 1 in the sequence ( not 0 like in C)
          */
         int   alignment_length2;
-        alignment_length2 = MIN2(n1, n2);
+        alignment_length2 = MIN2(plex->n1, plex->n2);
         int   begin_t = MAX2(11, pos - alignment_length2 + 1);  /* 10 */
-        int   end_t   = MIN2(n1 - 10, pos + 1);
+        int   end_t   = MIN2(plex->n1 - 10, pos + 1);
         int   begin_q = MAX2(11, max_pos_j - 1);                /* 10 */
-        int   end_q   = MIN2(n2 - 10, max_pos_j + alignment_length2 - 1);
+        int   end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length2 - 1);
         char  *s3     = (char *)vrna_alloc(sizeof(char) * (end_t - begin_t + 2 + 20));
         char  *s4     = (char *)vrna_alloc(sizeof(char) * (end_q - begin_q + 2 + 20));
         strcpy(s3, "NNNNNNNNNN");
@@ -2442,7 +2688,8 @@ find_max_XS(const int   *position,
         s3[end_t - begin_t + 1 + 20]  = '\0';
         s4[end_q - begin_q + 1 + 20]  = '\0';
         duplexT test;
-        test = fduplexfold_XS(s3,
+        test = fduplexfold_XS(plex,
+                              s3,
                               s4,
                               access_s1,
                               access_s2,
@@ -2455,21 +2702,21 @@ find_max_XS(const int   *position,
                               b_b);
         if (test.energy * 100 < threshold) {
           int l1 = strchr(test.structure, '&') - test.structure;
-          printf(
-            " %s %3d,%-3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f) [%5.2f] i:%d,j:%d <%5.2f>\n",
-            test.structure,
-            begin_t - 10 + test.i - l1 - 10,
-            begin_t - 10 + test.i - 1 - 10,
-            begin_q - 10 + test.j - 1 - 10,
-            (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
-            test.ddG,
-            test.energy,
-            test.opening_backtrack_x,
-            test.opening_backtrack_y,
-            test.energy_backtrack,
-            pos - 10,
-            max_pos_j - 10,
-            ((double)position[pos + delta]) / 100);
+          vrna_cstr_printf(plex->out, 
+                                 " %s %3d,%-3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f) [%5.2f] i:%d,j:%d <%5.2f>\n",
+                                 test.structure,
+                                 begin_t - 10 + test.i - l1 - 10,
+                                 begin_t - 10 + test.i - 1 - 10,
+                                 begin_q - 10 + test.j - 1 - 10,
+                                 (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
+                                 test.ddG,
+                                 test.energy,
+                                 test.opening_backtrack_x,
+                                 test.opening_backtrack_y,
+                                 test.energy_backtrack,
+                                 pos - 10,
+                                 max_pos_j - 10,
+                                 ((double)position[pos + delta]) / 100);
           pos = MAX2(10, pos + temp_min - delta);
           free(test.structure);
         }
@@ -2479,7 +2726,7 @@ find_max_XS(const int   *position,
       }
     }
   } else {
-    pos = n1 - 9;
+    pos = plex->n1 - 9;
     while (pos-- > 10) {
       int temp_min = 0;
       if (position[pos + delta] < (threshold)) {
@@ -2493,9 +2740,9 @@ find_max_XS(const int   *position,
         int     max_pos_j;
         max_pos_j = position_j[pos + delta];  /* position on j */
         int     begin_t = MAX2(11, pos - alignment_length);
-        int     end_t   = MIN2(n1 - 10, pos + 1);
+        int     end_t   = MIN2(plex->n1 - 10, pos + 1);
         int     begin_q = MAX2(11, max_pos_j - 1);
-        int     end_q   = MIN2(n2 - 10, max_pos_j + alignment_length - 1);
+        int     end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length - 1);
         int     i_flag;
         int     j_flag;
         i_flag  = (end_t == pos + 1 ? 1 : 0);
@@ -2508,21 +2755,21 @@ find_max_XS(const int   *position,
         s4[end_q - begin_q + 1] = '\0';
         duplexT test;
         test =
-          duplexfold_XS(s3, s4, access_s1, access_s2, pos, max_pos_j, threshold, i_flag, j_flag);
+          duplexfold_XS(plex, s3, s4, access_s1, access_s2, pos, max_pos_j, threshold, i_flag, j_flag);
         if (test.energy * 100 < threshold) {
-          printf("%s %3d,%-3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f) i:%d,j:%d <%5.2f>\n",
-                 test.structure,
-                 test.tb,
-                 test.te,
-                 test.qb,
-                 test.qe,
-                 test.ddG,
-                 test.energy,
-                 test.dG1,
-                 test.dG2,
-                 pos - 10,
-                 max_pos_j - 10,
-                 ((double)position[pos + delta]) / 100);
+          vrna_cstr_printf(plex->out, "%s %3d,%-3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f) i:%d,j:%d <%5.2f>\n",
+                                      test.structure,
+                                      test.tb,
+                                      test.te,
+                                      test.qb,
+                                      test.qe,
+                                      test.ddG,
+                                      test.energy,
+                                      test.dG1,
+                                      test.dG2,
+                                      pos - 10,
+                                      max_pos_j - 10,
+                                      ((double)position[pos + delta]) / 100);
           pos = MAX2(10, pos + temp_min - delta);
         }
 
@@ -2559,30 +2806,31 @@ compare(const void  *sub1,
 #endif
 
 PRIVATE void
-plot_max_XS(const int   max,
-            const int   max_pos,
-            const int   max_pos_j,
-            const int   alignment_length,
-            const char  *s1,
-            const char  *s2,
-            const int   **access_s1,
-            const int   **access_s2,
-            const int   fast,
-            const int   il_a,
-            const int   il_b,
-            const int   b_a,
-            const int   b_b)
+plot_max_XS(struct vrna_plex_s  *plex,
+            const int           max,
+            const int           max_pos,
+            const int           max_pos_j,
+            const int           alignment_length,
+            const char          *s1,
+            const char          *s2,
+            const int           **access_s1,
+            const int           **access_s2,
+            const int           fast,
+            const int           il_a,
+            const int           il_b,
+            const int           b_a,
+            const int           b_b)
 {
   if (fast == 1) {
-    printf("target upper bound %d: query lower bound %d (%5.2f)\n", max_pos - 3, max_pos_j,
-           ((double)max) / 100);
+    vrna_cstr_printf(plex->out, "target upper bound %d: query lower bound %d (%5.2f)\n", max_pos - 3, max_pos_j,
+                                ((double)max) / 100);
   } else if (fast == 2) {
     int   alignment_length2;
-    alignment_length2 = MIN2(n1, n2);
+    alignment_length2 = MIN2(plex->n1, plex->n2);
     int   begin_t = MAX2(11, max_pos - alignment_length2 + 1);  /* 10 */
-    int   end_t   = MIN2(n1 - 10, max_pos + 1);
+    int   end_t   = MIN2(plex->n1 - 10, max_pos + 1);
     int   begin_q = MAX2(11, max_pos_j - 1);                    /* 10 */
-    int   end_q   = MIN2(n2 - 10, max_pos_j + alignment_length2 - 1);
+    int   end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length2 - 1);
     char  *s3     = (char *)vrna_alloc(sizeof(char) * (end_t - begin_t + 2 + 20));
     char  *s4     = (char *)vrna_alloc(sizeof(char) * (end_q - begin_q + 2 + 20));
     strcpy(s3, "NNNNNNNNNN");
@@ -2594,31 +2842,31 @@ plot_max_XS(const int   max,
     s3[end_t - begin_t + 1 + 20]  = '\0';
     s4[end_q - begin_q + 1 + 20]  = '\0';
     duplexT test;
-    test = fduplexfold_XS(s3, s4, access_s1, access_s2, end_t, begin_q, INF, il_a, il_b, b_a, b_b);
+    test = fduplexfold_XS(plex, s3, s4, access_s1, access_s2, end_t, begin_q, INF, il_a, il_b, b_a, b_b);
     int     l1 = strchr(test.structure, '&') - test.structure;
-    printf("%s %3d,%-3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f) [%5.2f] i:%d,j:%d <%5.2f>\n",
-           test.structure,
-           begin_t - 10 + test.i - l1 - 10,
-           begin_t - 10 + test.i - 1 - 10,
-           begin_q - 10 + test.j - 1 - 10,
-           (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
-           test.ddG,
-           test.energy,
-           test.opening_backtrack_x,
-           test.opening_backtrack_y,
-           test.energy_backtrack,
-           max_pos - 10,
-           max_pos_j - 10,
-           (double)max / 100);
+    vrna_cstr_printf(plex->out, "%s %3d,%-3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f) [%5.2f] i:%d,j:%d <%5.2f>\n",
+                                test.structure,
+                                begin_t - 10 + test.i - l1 - 10,
+                                begin_t - 10 + test.i - 1 - 10,
+                                begin_q - 10 + test.j - 1 - 10,
+                                (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
+                                test.ddG,
+                                test.energy,
+                                test.opening_backtrack_x,
+                                test.opening_backtrack_y,
+                                test.energy_backtrack,
+                                max_pos - 10,
+                                max_pos_j - 10,
+                                (double)max / 100);
 
     free(s3);
     free(s4);
     free(test.structure);
   } else {
     int   begin_t = MAX2(11, max_pos - alignment_length);
-    int   end_t   = MIN2(n1 - 10, max_pos + 1);
+    int   end_t   = MIN2(plex->n1 - 10, max_pos + 1);
     int   begin_q = MAX2(11, max_pos_j - 1);
-    int   end_q   = MIN2(n2 - 10, max_pos_j + alignment_length - 1);
+    int   end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length - 1);
     int   i_flag;
     int   j_flag;
     i_flag  = (end_t == max_pos + 1 ? 1 : 0);
@@ -2631,20 +2879,20 @@ plot_max_XS(const int   max,
     s3[end_t - begin_t + 1] = '\0';                       /*  */
     s4[end_q - begin_q + 1] = '\0';
     duplexT test;
-    test = duplexfold_XS(s3, s4, access_s1, access_s2, max_pos, max_pos_j, INF, i_flag, j_flag);
-    printf("%s %3d,%-3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f) i:%d,j:%d <%5.2f>\n",
-           test.structure,
-           test.tb,
-           test.te,
-           test.qb,
-           test.qe,
-           test.ddG,
-           test.energy,
-           test.dG1,
-           test.dG2,
-           max_pos - 10,
-           max_pos_j - 10,
-           (double)max / 100);
+    test = duplexfold_XS(plex, s3, s4, access_s1, access_s2, max_pos, max_pos_j, INF, i_flag, j_flag);
+    vrna_cstr_printf(plex->out, "%s %3d,%-3d : %3d,%-3d (%5.2f = %5.2f + %5.2f + %5.2f) i:%d,j:%d <%5.2f>\n",
+                                test.structure,
+                                test.tb,
+                                test.te,
+                                test.qb,
+                                test.qe,
+                                test.ddG,
+                                test.energy,
+                                test.dG1,
+                                test.dG2,
+                                max_pos - 10,
+                                max_pos_j - 10,
+                                (double)max / 100);
     free(s3);
     free(s4);
     free(test.structure);
@@ -2656,37 +2904,31 @@ plot_max_XS(const int   max,
 
 
 PRIVATE duplexT
-duplexfold(const char *s1,
-           const char *s2,
-           const int  extension_cost)
+duplexfold(struct vrna_plex_s *plex,
+           const char         *s1,
+           const char         *s2,
+           const int          extension_cost)
 {
+  vrna_param_t  *P     = plex->P;
+  vrna_md_t     *md    = &(P->model_details);
+  int           *rtype = &(md->rtype[0]);
+
   int       i, j, l1, Emin = INF, i_min = 0, j_min = 0;
   char      *struc;
   duplexT   mfe;
-  vrna_md_t md;
-
-  n3  = (int)strlen(s1);
-  n4  = (int)strlen(s2);
-
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    update_fold_params();
-    if (P)
-      free(P);
 
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
+  plex->n3  = (int)strlen(s1);
+  plex->n4  = (int)strlen(s2);
 
-  c = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  for (i = 0; i <= n3; i++)
-    c[i] = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-  encode_seqs(s1, s2);
-  for (i = 1; i <= n3; i++) {
-    for (j = n4; j > 0; j--) {
+  plex->c = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  for (i = 0; i <= plex->n3; i++)
+    plex->c[i] = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+  encode_seqs(plex, s1, s2);
+  for (i = 1; i <= plex->n3; i++) {
+    for (j = plex->n4; j > 0; j--) {
       int type, type2, E, k, l;
-      type    = pair[S1[i]][S2[j]];
-      c[i][j] = type ? P->DuplexInit + 2 * extension_cost : INF;
+      type    = md->pair[plex->S1[i]][plex->S2[j]];
+      plex->c[i][j] = type ? P->DuplexInit + 2 * extension_cost : INF;
       if (!type)
         continue;
 
@@ -2695,30 +2937,30 @@ duplexfold(const char *s1,
       ***       if (j<n4) c[i][j] += P->dangle3[type][SS2[j+1]]+ extension_cost;
       ***       if (type>2) c[i][j] += P->TerminalAU;
       **/
-      c[i][j] += vrna_E_ext_stem(type, (i > 1) ? SS1[i - 1] : -1, (j < n4) ? SS2[j + 1] : -1, P);
+      plex->c[i][j] += vrna_E_ext_stem(type, (i > 1) ? plex->SS1[i - 1] : -1, (j < plex->n4) ? plex->SS2[j + 1] : -1, P);
       for (k = i - 1; k > 0 && k > i - MAXLOOP - 2; k--) {
-        for (l = j + 1; l <= n4; l++) {
+        for (l = j + 1; l <= plex->n4; l++) {
           if (i - k + l - j - 2 > MAXLOOP)
             break;
 
-          type2 = pair[S1[k]][S2[l]];
+          type2 = md->pair[plex->S1[k]][plex->S2[l]];
           if (!type2)
             continue;
 
           E = E_IntLoop(i - k - 1, l - j - 1, type2, rtype[type],
-                        SS1[k + 1], SS2[l - 1], SS1[i - 1], SS2[j + 1],
+                        plex->SS1[k + 1], plex->SS2[l - 1], plex->SS1[i - 1], plex->SS2[j + 1],
                         P) + (i - k + l - j) * extension_cost;
-          c[i][j] = MIN2(c[i][j], c[k][l] + E);
+          plex->c[i][j] = MIN2(plex->c[i][j], plex->c[k][l] + E);
         }
       }
-      E = c[i][j];
+      E = plex->c[i][j];
       /**
       ***      if (i<n3) E += P->dangle3[rtype[type]][SS1[i+1]]+extension_cost;
       ***      if (j>1)  E += P->dangle5[rtype[type]][SS2[j-1]]+extension_cost;
       ***      if (type>2) E += P->TerminalAU;
       ***
       **/
-      E += vrna_E_ext_stem(rtype[type], (j > 1) ? SS2[j - 1] : -1, (i < n3) ? SS1[i + 1] : -1, P);
+      E += vrna_E_ext_stem(rtype[type], (j > 1) ? plex->SS2[j - 1] : -1, (i < plex->n3) ? plex->SS1[i + 1] : -1, P);
       if (E < Emin) {
         Emin  = E;
         i_min = i;
@@ -2726,8 +2968,8 @@ duplexfold(const char *s1,
       }
     }
   }
-  struc = backtrack(i_min, j_min, extension_cost);
-  if (i_min < n3)
+  struc = backtrack(plex, i_min, j_min, extension_cost);
+  if (i_min < plex->n3)
     i_min++;
 
   if (j_min > 1)
@@ -2742,56 +2984,61 @@ duplexfold(const char *s1,
   mfe.j         = j_min;
   mfe.energy    = (double)Emin / 100.;
   mfe.structure = struc;
-  for (i = 0; i <= n3; i++)
-    free(c[i]);
-  free(c);
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
+  for (i = 0; i <= plex->n3; i++)
+    free(plex->c[i]);
+  free(plex->c);
+  free(plex->S1);
+  free(plex->S2);
+  free(plex->SS1);
+  free(plex->SS2);
   return mfe;
 }
 
 
 PRIVATE char *
-backtrack(int       i,
-          int       j,
-          const int extension_cost)
+backtrack(struct vrna_plex_s *plex,
+          int                i,
+          int                j,
+          const int          extension_cost)
 {
+  vrna_param_t  *P     = plex->P;
+  vrna_md_t     *md    = &(P->model_details);
+  int           *rtype = &(md->rtype[0]);
+
   /* backtrack structure going backwards from i, and forwards from j
    * return structure in bracket notation with & as separator */
   int   k, l, type, type2, E, traced, i0, j0;
   char  *st1, *st2, *struc;
 
-  st1 = (char *)vrna_alloc(sizeof(char) * (n3 + 1));
-  st2 = (char *)vrna_alloc(sizeof(char) * (n4 + 1));
+  st1 = (char *)vrna_alloc(sizeof(char) * (plex->n3 + 1));
+  st2 = (char *)vrna_alloc(sizeof(char) * (plex->n4 + 1));
 
-  i0  = MIN2(i + 1, n3);
+  i0  = MIN2(i + 1, plex->n3);
   j0  = MAX2(j - 1, 1);
 
-  while (i > 0 && j <= n4) {
-    E           = c[i][j];
+  while (i > 0 && j <= plex->n4) {
+    E           = plex->c[i][j];
     traced      = 0;
     st1[i - 1]  = '(';
     st2[j - 1]  = ')';
-    type        = pair[S1[i]][S2[j]];
+    type        = md->pair[plex->S1[i]][plex->S2[j]];
     if (!type)
       vrna_message_error("backtrack failed in fold duplex");
 
     for (k = i - 1; k > 0 && k > i - MAXLOOP - 2; k--) {
-      for (l = j + 1; l <= n4; l++) {
+      for (l = j + 1; l <= plex->n4; l++) {
         int LE;
         if (i - k + l - j - 2 > MAXLOOP)
           break;
 
-        type2 = pair[S1[k]][S2[l]];
+        type2 = md->pair[plex->S1[k]][plex->S2[l]];
         if (!type2)
           continue;
 
         LE = E_IntLoop(i - k - 1, l - j - 1, type2, rtype[type],
-                       SS1[k + 1], SS2[l - 1], SS1[i - 1], SS2[j + 1],
+                       plex->SS1[k + 1], plex->SS2[l - 1], plex->SS1[i - 1], plex->SS2[j + 1],
                        P) + (i - k + l - j) * extension_cost;
-        if (E == c[k][l] + LE) {
+        if (E == plex->c[k][l] + LE) {
           traced  = 1;
           i       = k;
           j       = l;
@@ -2802,7 +3049,7 @@ backtrack(int       i,
         break;
     }
     if (!traced) {
-      E -= vrna_E_ext_stem(type, (i > 1) ? SS1[i - 1] : -1, (j < n4) ? SS2[j + 1] : -1, P);
+      E -= vrna_E_ext_stem(type, (i > 1) ? plex->SS1[i - 1] : -1, (j < plex->n4) ? plex->SS2[j + 1] : -1, P);
       /**
       ***      if (i>1) E -= P->dangle5[type][SS1[i-1]]+extension_cost;
       ***      if (j<n4) E -= P->dangle3[type][SS2[j+1]]+extension_cost;
@@ -2817,7 +3064,7 @@ backtrack(int       i,
   if (i > 1)
     i--;
 
-  if (j < n4)
+  if (j < plex->n4)
     j++;
 
   struc = (char *)vrna_alloc(i0 - i + 1 + j - j0 + 1 + 2);
@@ -2840,14 +3087,19 @@ backtrack(int       i,
 
 
 PRIVATE duplexT
-fduplexfold(const char  *s1,
-            const char  *s2,
-            const int   extension_cost,
-            const int   il_a,
-            const int   il_b,
-            const int   b_a,
-            const int   b_b)
+fduplexfold(struct vrna_plex_s  *plex,
+            const char          *s1,
+            const char          *s2,
+            const int           extension_cost,
+            const int           il_a,
+            const int           il_b,
+            const int           b_a,
+            const int           b_b)
 {
+  vrna_param_t  *P     = plex->P;
+  vrna_md_t     *md    = &(P->model_details);
+  int           *rtype = &(md->rtype[0]);
+
   int       i, j, Emin, i_min, j_min, l1;
   duplexT   mfe;
   char      *struc;
@@ -2863,12 +3115,11 @@ fduplexfold(const char  *s1,
   int       temp = INF;
   int       min_j_colonne;
   int       max = INF;
-  vrna_md_t md;
 
   /* FOLLOWING NEXT 4 LINE DEFINES AN ARRAY CONTAINING POSITION OF THE SUBOPT IN S1 */
 
-  n3  = (int)strlen(s1);
-  n4  = (int)strlen(s2);
+  plex->n3  = (int)strlen(s1);
+  plex->n4  = (int)strlen(s2);
   /*
    * delta_check is the minimal distance allowed for two hits to be accepted
    * if both hits are closer, reject the smaller ( in term of position)  hits
@@ -2877,46 +3128,37 @@ fduplexfold(const char  *s1,
    * for this i first need to rewrite backtrack in order to remove the printf functio
    * END OF DEFINITION FOR NEEDED SUBOPT DATA
    */
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    update_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
 
   /*local c array initialization---------------------------------------------*/
-  c   = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  in  = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  bx  = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  by  = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  inx = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  iny = (int **)vrna_alloc(sizeof(int *) * (n3 + 1));
-  for (i = 0; i <= n3; i++) {
-    c[i]    = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    in[i]   = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    bx[i]   = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    by[i]   = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    inx[i]  = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
-    iny[i]  = (int *)vrna_alloc(sizeof(int) * (n4 + 1));
+  plex->c   = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->in  = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->bx  = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->by  = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->inx = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  plex->iny = (int **)vrna_alloc(sizeof(int *) * (plex->n3 + 1));
+  for (i = 0; i <= plex->n3; i++) {
+    plex->c[i]    = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->in[i]   = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->bx[i]   = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->by[i]   = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->inx[i]  = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
+    plex->iny[i]  = (int *)vrna_alloc(sizeof(int) * (plex->n4 + 1));
   }
   /*
    * -------------------------------------------------------------------------
    * end of array initialisation----------------------------------
    *maybe int *** would be better
    */
-  encode_seqs(s1, s2);
+  encode_seqs(plex, s1, s2);
   /* ------------------------------------------matrix initialisierung */
-  for (i = 0; i < n3; i++) {
-    for (j = 0; j < n4; j++) {
-      in[i][j]  = INF;  /* no in before  1 */
-      c[i][j]   = INF;  /* no bulge and no in before n2 */
-      bx[i][j]  = INF;  /* no bulge before 1 */
-      by[i][j]  = INF;
-      inx[i][j] = INF;  /* no bulge before 1 */
-      iny[i][j] = INF;
+  for (i = 0; i < plex->n3; i++) {
+    for (j = 0; j < plex->n4; j++) {
+      plex->in[i][j]  = INF;  /* no in before  1 */
+      plex->c[i][j]   = INF;  /* no bulge and no in before n2 */
+      plex->bx[i][j]  = INF;  /* no bulge before 1 */
+      plex->by[i][j]  = INF;
+      plex->inx[i][j] = INF;  /* no bulge before 1 */
+      plex->iny[i][j] = INF;
     }
   }
 
@@ -2925,56 +3167,56 @@ fduplexfold(const char  *s1,
 
   /* -------------------------------------------------------------matrix initialisierung */
   i         = 11;
-  i_length  = n3 - 9;
+  i_length  = plex->n3 - 9;
   while (i < i_length) {
-    j           = n4 - 9;
+    j           = plex->n4 - 9;
     min_colonne = INF;
     while (10 < --j) {
       int type, type2;
-      type = pair[S1[i]][S2[j]];
+      type = md->pair[plex->S1[i]][plex->S2[j]];
       /**
       *** Start duplex
       **/
-      c[i][j] = type ? P->DuplexInit + 2 * extension_cost : INF;
+      plex->c[i][j] = type ? P->DuplexInit + 2 * extension_cost : INF;
       /**
       *** update lin bx by linx liny matrix
       **/
-      type2 = pair[S2[j + 1]][S1[i - 1]];
+      type2 = md->pair[plex->S2[j + 1]][plex->S1[i - 1]];
       /**
       *** start/extend interior loop
       **/
-      in[i][j] =
-        MIN2(c[i - 1][j + 1] + P->mismatchI[type2][SS2[j]][SS1[i]] + iopen + iext_s,
-             in[i - 1][j] + iext_ass);
+      plex->in[i][j] =
+        MIN2(plex->c[i - 1][j + 1] + P->mismatchI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s,
+             plex->in[i - 1][j] + iext_ass);
       /**
       *** start/extend nx1 target
       *** use same type2 as for in
       **/
-      inx[i][j] = MIN2(c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s,
-                       inx[i - 1][j] + iext_ass);
+      plex->inx[i][j] = MIN2(plex->c[i - 1][j + 1] + P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s,
+                       plex->inx[i - 1][j] + iext_ass);
       /**
       *** start/extend 1xn target
       *** use same type2 as for in
       **/
-      iny[i][j] = MIN2(c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s,
-                       iny[i][j + 1] + iext_ass);
+      plex->iny[i][j] = MIN2(plex->c[i - 1][j + 1] + P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s,
+                       plex->iny[i][j + 1] + iext_ass);
       /**
       *** extend interior loop
       **/
-      in[i][j]  = MIN2(in[i][j], in[i][j + 1] + iext_ass);
-      in[i][j]  = MIN2(in[i][j], in[i - 1][j + 1] + iext_s);
+      plex->in[i][j]  = MIN2(plex->in[i][j], plex->in[i][j + 1] + iext_ass);
+      plex->in[i][j]  = MIN2(plex->in[i][j], plex->in[i - 1][j + 1] + iext_s);
       /**
       *** start/extend bulge target
       **/
-      type2     = pair[S2[j]][S1[i - 1]];
-      bx[i][j]  =
-        MIN2(bx[i - 1][j] + bext, c[i - 1][j] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0));
+      type2     = md->pair[plex->S2[j]][plex->S1[i - 1]];
+      plex->bx[i][j]  =
+        MIN2(plex->bx[i - 1][j] + bext, plex->c[i - 1][j] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0));
       /**
       *** start/extend bulge query
       **/
-      type2     = pair[S2[j + 1]][S1[i]];
-      by[i][j]  =
-        MIN2(by[i][j + 1] + bext, c[i][j + 1] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0));
+      type2     = md->pair[plex->S2[j + 1]][plex->S1[i]];
+      plex->by[i][j]  =
+        MIN2(plex->by[i][j + 1] + bext, plex->c[i][j + 1] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0));
       /**
        ***end update recursion
        ***######################## Start stack extension##############################
@@ -2982,68 +3224,68 @@ fduplexfold(const char  *s1,
       if (!type)
         continue;
 
-      c[i][j] += vrna_E_ext_stem(type, SS1[i - 1], SS2[j + 1], P) + 2 * extension_cost;
+      plex->c[i][j] += vrna_E_ext_stem(type, plex->SS1[i - 1], plex->SS2[j + 1], P) + 2 * extension_cost;
       /**
       *** stack extension
       **/
-      if ((type2 = pair[S1[i - 1]][S2[j + 1]]))
-        c[i][j] =
-          MIN2(c[i - 1][j + 1] + P->stack[rtype[type]][type2] + 2 * extension_cost, c[i][j]);
+      if ((type2 = md->pair[plex->S1[i - 1]][plex->S2[j + 1]]))
+        plex->c[i][j] =
+          MIN2(plex->c[i - 1][j + 1] + P->stack[rtype[type]][type2] + 2 * extension_cost, plex->c[i][j]);
 
       /**
       *** 1x0 / 0x1 stack extension
       **/
-      type2   = pair[S1[i - 1]][S2[j + 2]];
-      c[i][j] = MIN2(
-        c[i - 1][j + 2] + P->bulge[1] + P->stack[rtype[type]][type2] + 3 * extension_cost,
-        c[i][j]);
-      type2   = pair[S1[i - 2]][S2[j + 1]];
-      c[i][j] = MIN2(
-        c[i - 2][j + 1] + P->bulge[1] + P->stack[type2][rtype[type]] + 3 * extension_cost,
-        c[i][j]);
+      type2   = md->pair[plex->S1[i - 1]][plex->S2[j + 2]];
+      plex->c[i][j] = MIN2(
+        plex->c[i - 1][j + 2] + P->bulge[1] + P->stack[rtype[type]][type2] + 3 * extension_cost,
+        plex->c[i][j]);
+      type2   = md->pair[plex->S1[i - 2]][plex->S2[j + 1]];
+      plex->c[i][j] = MIN2(
+        plex->c[i - 2][j + 1] + P->bulge[1] + P->stack[type2][rtype[type]] + 3 * extension_cost,
+        plex->c[i][j]);
       /**
       *** 1x1 / 2x2 stack extension
       **/
-      type2   = pair[S1[i - 2]][S2[j + 2]];
-      c[i][j] = MIN2(
-        c[i - 2][j + 2] + P->int11[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]] + 4 * extension_cost,
-        c[i][j]);
-      type2   = pair[S1[i - 3]][S2[j + 3]];
-      c[i][j] =
-        MIN2(c[i - 3][j + 3] +
-             P->int22[type2][rtype[type]][SS1[i - 2]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + 6 * extension_cost,
-             c[i][j]);
+      type2   = md->pair[plex->S1[i - 2]][plex->S2[j + 2]];
+      plex->c[i][j] = MIN2(
+        plex->c[i - 2][j + 2] + P->int11[type2][rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 4 * extension_cost,
+        plex->c[i][j]);
+      type2   = md->pair[plex->S1[i - 3]][plex->S2[j + 3]];
+      plex->c[i][j] =
+        MIN2(plex->c[i - 3][j + 3] +
+             P->int22[type2][rtype[type]][plex->SS1[i - 2]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + 6 * extension_cost,
+             plex->c[i][j]);
       /**
       *** 1x2 / 2x1 stack extension
       *** E_IntLoop(1,2,type2, rtype[type],SS1[i-1], SS2[j+2], SS1[i-1], SS2[j+1], P) corresponds to
       *** P->int21[rtype[type]][type2][SS2[j+2]][SS1[i-1]][SS1[i-1]]
       **/
-      type2   = pair[S1[i - 3]][S2[j + 2]];
-      c[i][j] =
+      type2   = md->pair[plex->S1[i - 3]][plex->S2[j + 2]];
+      plex->c[i][j] =
         MIN2(
-          c[i - 3][j + 2] + P->int21[rtype[type]][type2][SS2[j + 1]][SS1[i - 2]][SS1[i - 1]] + 5 * extension_cost,
-          c[i][j]);
-      type2   = pair[S1[i - 2]][S2[j + 3]];
-      c[i][j] =
+          plex->c[i - 3][j + 2] + P->int21[rtype[type]][type2][plex->SS2[j + 1]][plex->SS1[i - 2]][plex->SS1[i - 1]] + 5 * extension_cost,
+          plex->c[i][j]);
+      type2   = md->pair[plex->S1[i - 2]][plex->S2[j + 3]];
+      plex->c[i][j] =
         MIN2(
-          c[i - 2][j + 3] + P->int21[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + 5 * extension_cost,
-          c[i][j]);
+          plex->c[i - 2][j + 3] + P->int21[type2][rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + 5 * extension_cost,
+          plex->c[i][j]);
 
       /**
       *** 2x3 / 3x2 stack extension
       **/
-      if ((type2 = pair[S1[i - 4]][S2[j + 3]])) {
-        c[i][j] = MIN2(c[i - 4][j + 3] + P->internal_loop[5] + P->ninio[2] +
-                       P->mismatch23I[type2][SS1[i - 3]][SS2[j + 2]] +
-                       P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + 7 * extension_cost,
-                       c[i][j]);
+      if ((type2 = md->pair[plex->S1[i - 4]][plex->S2[j + 3]])) {
+        plex->c[i][j] = MIN2(plex->c[i - 4][j + 3] + P->internal_loop[5] + P->ninio[2] +
+                       P->mismatch23I[type2][plex->SS1[i - 3]][plex->SS2[j + 2]] +
+                       P->mismatch23I[rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + 7 * extension_cost,
+                       plex->c[i][j]);
       }
 
-      if ((type2 = pair[S1[i - 3]][S2[j + 4]])) {
-        c[i][j] = MIN2(c[i - 3][j + 4] + P->internal_loop[5] + P->ninio[2] +
-                       P->mismatch23I[type2][SS1[i - 2]][SS2[j + 3]] +
-                       P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + 7 * extension_cost,
-                       c[i][j]);
+      if ((type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 4]])) {
+        plex->c[i][j] = MIN2(plex->c[i - 3][j + 4] + P->internal_loop[5] + P->ninio[2] +
+                       P->mismatch23I[type2][plex->SS1[i - 2]][plex->SS2[j + 3]] +
+                       P->mismatch23I[rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + 7 * extension_cost,
+                       plex->c[i][j]);
       }
 
       /**
@@ -3052,45 +3294,45 @@ fduplexfold(const char  *s1,
       /**
       *** 3x3 or more
       **/
-      c[i][j] = MIN2(
-        in[i - 3][j + 3] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + 2 * iext_s + 2 * extension_cost,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->in[i - 3][j + 3] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 2 * iext_s + 2 * extension_cost,
+        plex->c[i][j]);
       /**
       *** 2xn or more
       **/
-      c[i][j] = MIN2(
-        in[i - 4][j + 2] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->in[i - 4][j + 2] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
+        plex->c[i][j]);
       /**
       *** nx2 or more
       **/
-      c[i][j] = MIN2(
-        in[i - 2][j + 4] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->in[i - 2][j + 4] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
+        plex->c[i][j]);
       /**
       *** nx1 n>2
       **/
-      c[i][j] = MIN2(
-        inx[i - 3][j + 1] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->inx[i - 3][j + 1] + P->mismatch1nI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
+        plex->c[i][j]);
       /**
       *** 1xn n>2
       **/
-      c[i][j] = MIN2(
-        iny[i - 1][j + 3] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
-        c[i][j]);
+      plex->c[i][j] = MIN2(
+        plex->iny[i - 1][j + 3] + P->mismatch1nI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
+        plex->c[i][j]);
       /**
       *** nx0 n>1
       **/
       int bAU;
       bAU     = (type > 2 ? P->TerminalAU : 0);
-      c[i][j] = MIN2(bx[i - 2][j + 1] + 2 * extension_cost + bext + bAU, c[i][j]);
+      plex->c[i][j] = MIN2(plex->bx[i - 2][j + 1] + 2 * extension_cost + bext + bAU, plex->c[i][j]);
       /**
       *** 0xn n>1
       **/
-      c[i][j]     = MIN2(by[i - 1][j + 2] + 2 * extension_cost + bext + bAU, c[i][j]);
+      plex->c[i][j]     = MIN2(plex->by[i - 1][j + 2] + 2 * extension_cost + bext + bAU, plex->c[i][j]);
       temp        = min_colonne;
-      min_colonne = MIN2(c[i][j] + vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1],
+      min_colonne = MIN2(plex->c[i][j] + vrna_E_ext_stem(rtype[type], plex->SS2[j - 1], plex->SS1[i + 1],
                                                    P) + 2 * extension_cost,
                          min_colonne);
       if (temp > min_colonne)
@@ -3112,8 +3354,8 @@ fduplexfold(const char  *s1,
   int dGe;
 
   dGe   = 0;
-  struc = fbacktrack(i_min, j_min, extension_cost, il_a, il_b, b_a, b_b, &dGe);
-  if (i_min < n3 - 10)
+  struc = fbacktrack(plex, i_min, j_min, extension_cost, il_a, il_b, b_a, b_b, &dGe);
+  if (i_min < plex->n3 - 10)
     i_min++;
 
   if (j_min > 11)
@@ -3129,38 +3371,43 @@ fduplexfold(const char  *s1,
   mfe.energy            = (double)Emin / 100.;
   mfe.energy_backtrack  = (double)dGe / 100.;
   mfe.structure         = struc;
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
-  for (i = 0; i <= n3; i++) {
-    free(c[i]);
-    free(in[i]);
-    free(bx[i]);
-    free(by[i]);
-    free(inx[i]);
-    free(iny[i]);
+  free(plex->S1);
+  free(plex->S2);
+  free(plex->SS1);
+  free(plex->SS2);
+  for (i = 0; i <= plex->n3; i++) {
+    free(plex->c[i]);
+    free(plex->in[i]);
+    free(plex->bx[i]);
+    free(plex->by[i]);
+    free(plex->inx[i]);
+    free(plex->iny[i]);
   }
-  free(c);
-  free(in);
-  free(bx);
-  free(by);
-  free(inx);
-  free(iny);
+  free(plex->c);
+  free(plex->in);
+  free(plex->bx);
+  free(plex->by);
+  free(plex->inx);
+  free(plex->iny);
   return mfe;
 }
 
 
 PRIVATE char *
-fbacktrack(int        i,
-           int        j,
-           const int  extension_cost,
-           const int  il_a,
-           const int  il_b,
-           const int  b_a,
-           const int  b_b,
-           int        *dG)
+fbacktrack(struct vrna_plex_s  *plex,
+           int                 i,
+           int                 j,
+           const int           extension_cost,
+           const int           il_a,
+           const int           il_b,
+           const int           b_a,
+           const int           b_b,
+           int                 *dG)
 {
+  vrna_param_t  *P     = plex->P;
+  vrna_md_t     *md    = &(P->model_details);
+  int           *rtype = &(md->rtype[0]);
+
   /* backtrack structure going backwards from i, and forwards from j
    * return structure in bracket notation with & as separator */
   int   k, l, type, type2, E, traced, i0, j0;
@@ -3171,9 +3418,9 @@ fbacktrack(int        i,
   int   iext_s    = 2 * (il_a + extension_cost);  /* iext_s 2 nt nucleotide extension of interior loop, on i and j side */
   int   iext_ass  = 50 + il_a + extension_cost;   /* iext_ass assymetric extension of interior loop, either on i or on j side. */
 
-  st1 = (char *)vrna_alloc(sizeof(char) * (n3 + 1));
-  st2 = (char *)vrna_alloc(sizeof(char) * (n4 + 1));
-  i0  = MIN2(i + 1, n3 - 10);
+  st1 = (char *)vrna_alloc(sizeof(char) * (plex->n3 + 1));
+  st2 = (char *)vrna_alloc(sizeof(char) * (plex->n4 + 1));
+  i0  = MIN2(i + 1, plex->n3 - 10);
   j0  = MAX2(j - 1, 11);
   int state;
 
@@ -3186,32 +3433,32 @@ fbacktrack(int        i,
   traced  = 1;
   k       = i;
   l       = j;
-  type    = pair[S1[i]][S2[j]];
-  *dG     += vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1], P);
+  type    = md->pair[plex->S1[i]][plex->S2[j]];
+  *dG     += vrna_E_ext_stem(rtype[type], plex->SS2[j - 1], plex->SS1[i + 1], P);
   /*     (type>2?P->TerminalAU:0)+P->dangle3[rtype[type]][SS1[i+1]]+P->dangle5[rtype[type]][SS2[j-1]]; */
-  while (i > 10 && j <= n4 - 9 && traced) {
+  while (i > 10 && j <= plex->n4 - 9 && traced) {
     traced = 0;
     switch (state) {
       case 1:
-        type = pair[S1[i]][S2[j]];
+        type = md->pair[plex->S1[i]][plex->S2[j]];
         int bAU;
         bAU = (type > 2 ? P->TerminalAU : 0);
         if (!type)
           vrna_message_error("backtrack failed in fold duplex");
 
-        type2 = pair[S1[i - 1]][S2[j + 1]];
+        type2 = md->pair[plex->S1[i - 1]][plex->S2[j + 1]];
         if (type2 &&
-            c[i][j] == (c[i - 1][j + 1] + P->stack[rtype[type]][type2] + 2 * extension_cost)) {
+            plex->c[i][j] == (plex->c[i - 1][j + 1] + P->stack[rtype[type]][type2] + 2 * extension_cost)) {
           k     = i - 1;
           l     = j + 1;
           (*dG) += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
                              rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
                              P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
@@ -3222,20 +3469,20 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 1]][S2[j + 2]];
+        type2 = md->pair[plex->S1[i - 1]][plex->S2[j + 2]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 1][j + 2] + P->bulge[1] + P->stack[rtype[type]][type2] + 3 * extension_cost)) {
+            plex->c[i][j] ==
+            (plex->c[i - 1][j + 2] + P->bulge[1] + P->stack[rtype[type]][type2] + 3 * extension_cost)) {
           k   = i - 1;
           l   = j + 2;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
@@ -3246,20 +3493,20 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 2]][S2[j + 1]];
+        type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 1]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 2][j + 1] + P->bulge[1] + P->stack[type2][rtype[type]] + 3 * extension_cost)) {
+            plex->c[i][j] ==
+            (plex->c[i - 2][j + 1] + P->bulge[1] + P->stack[type2][rtype[type]] + 3 * extension_cost)) {
           k   = i - 2;
           l   = j + 1;
           *dG += E_IntLoop(i - k - 1,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
@@ -3270,10 +3517,10 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 2]][S2[j + 2]];
+        type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 2]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 2][j + 2] + P->int11[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]] + 4 *
+            plex->c[i][j] ==
+            (plex->c[i - 2][j + 2] + P->int11[type2][rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 4 *
              extension_cost)) {
           k   = i - 2;
           l   = j + 2;
@@ -3281,10 +3528,10 @@ fbacktrack(int        i,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
@@ -3295,11 +3542,11 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 3]][S2[j + 3]];
+        type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 3]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 3][j + 3] +
-             P->int22[type2][rtype[type]][SS1[i - 2]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + 6 *
+            plex->c[i][j] ==
+            (plex->c[i - 3][j + 3] +
+             P->int22[type2][rtype[type]][plex->SS1[i - 2]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + 6 *
              extension_cost)) {
           k   = i - 3;
           l   = j + 3;
@@ -3307,10 +3554,10 @@ fbacktrack(int        i,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
@@ -3321,10 +3568,10 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 3]][S2[j + 2]];
+        type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 2]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 3][j + 2] + P->int21[rtype[type]][type2][SS2[j + 1]][SS1[i - 2]][SS1[i - 1]] +
+            plex->c[i][j] ==
+            (plex->c[i - 3][j + 2] + P->int21[rtype[type]][type2][plex->SS2[j + 1]][plex->SS1[i - 2]][plex->SS1[i - 1]] +
              5 *
              extension_cost)) {
           k   = i - 3;
@@ -3333,10 +3580,10 @@ fbacktrack(int        i,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
@@ -3347,10 +3594,10 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 2]][S2[j + 3]];
+        type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 3]];
         if (type2 &&
-            c[i][j] ==
-            (c[i - 2][j + 3] + P->int21[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] +
+            plex->c[i][j] ==
+            (plex->c[i - 2][j + 3] + P->int21[type2][rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] +
              5 *
              extension_cost)) {
           k   = i - 2;
@@ -3359,10 +3606,10 @@ fbacktrack(int        i,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
@@ -3373,10 +3620,10 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 4]][S2[j + 3]];
-        if (type2 && c[i][j] == (c[i - 4][j + 3] + P->internal_loop[5] + P->ninio[2] +
-                                 P->mismatch23I[type2][SS1[i - 3]][SS2[j + 2]] +
-                                 P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + 7 *
+        type2 = md->pair[plex->S1[i - 4]][plex->S2[j + 3]];
+        if (type2 && plex->c[i][j] == (plex->c[i - 4][j + 3] + P->internal_loop[5] + P->ninio[2] +
+                                 P->mismatch23I[type2][plex->SS1[i - 3]][plex->SS2[j + 2]] +
+                                 P->mismatch23I[rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + 7 *
                                  extension_cost)) {
           k   = i - 4;
           l   = j + 3;
@@ -3384,10 +3631,10 @@ fbacktrack(int        i,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
@@ -3398,10 +3645,10 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S1[i - 3]][S2[j + 4]];
-        if (type2 && c[i][j] == (c[i - 3][j + 4] + P->internal_loop[5] + P->ninio[2] +
-                                 P->mismatch23I[type2][SS1[i - 2]][SS2[j + 3]] +
-                                 P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + 7 *
+        type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 4]];
+        if (type2 && plex->c[i][j] == (plex->c[i - 3][j + 4] + P->internal_loop[5] + P->ninio[2] +
+                                 P->mismatch23I[type2][plex->SS1[i - 2]][plex->SS2[j + 3]] +
+                                 P->mismatch23I[rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + 7 *
                                  extension_cost)) {
           k   = i - 3;
           l   = j + 4;
@@ -3409,10 +3656,10 @@ fbacktrack(int        i,
                            l - j - 1,
                            type2,
                            rtype[type],
-                           SS1[k + 1],
-                           SS2[l - 1],
-                           SS1[i - 1],
-                           SS2[j + 1],
+                           plex->SS1[k + 1],
+                           plex->SS2[l - 1],
+                           plex->SS1[i - 1],
+                           plex->SS2[j + 1],
                            P);
           st1[i - 1]  = '(';
           st2[j - 1]  = ')';
@@ -3423,8 +3670,8 @@ fbacktrack(int        i,
           break;
         }
 
-        if (c[i][j] ==
-            (in[i - 3][j + 3] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + 2 *
+        if (plex->c[i][j] ==
+            (plex->in[i - 3][j + 3] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 2 *
              extension_cost +
              2 * iext_s)) {
           k           = i;
@@ -3438,8 +3685,8 @@ fbacktrack(int        i,
           break;
         }
 
-        if (c[i][j] ==
-            (in[i - 4][j + 2] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 *
+        if (plex->c[i][j] ==
+            (plex->in[i - 4][j + 2] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 *
              iext_ass + 2 * extension_cost)) {
           k           = i;
           l           = j;
@@ -3452,8 +3699,8 @@ fbacktrack(int        i,
           break;
         }
 
-        if (c[i][j] ==
-            (in[i - 2][j + 4] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 *
+        if (plex->c[i][j] ==
+            (plex->in[i - 2][j + 4] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 *
              iext_ass + 2 * extension_cost)) {
           k           = i;
           l           = j;
@@ -3466,8 +3713,8 @@ fbacktrack(int        i,
           break;
         }
 
-        if (c[i][j] ==
-            (inx[i - 3][j + 1] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass +
+        if (plex->c[i][j] ==
+            (plex->inx[i - 3][j + 1] + P->mismatch1nI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass +
              iext_ass + 2 * extension_cost)) {
           k           = i;
           l           = j;
@@ -3480,8 +3727,8 @@ fbacktrack(int        i,
           break;
         }
 
-        if (c[i][j] ==
-            (iny[i - 1][j + 3] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass +
+        if (plex->c[i][j] ==
+            (plex->iny[i - 1][j + 3] + P->mismatch1nI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass +
              iext_ass + 2 * extension_cost)) {
           k           = i;
           l           = j;
@@ -3494,7 +3741,7 @@ fbacktrack(int        i,
           break;
         }
 
-        if (c[i][j] == (bx[i - 2][j + 1] + 2 * extension_cost + bext + bAU)) {
+        if (plex->c[i][j] == (plex->bx[i - 2][j + 1] + 2 * extension_cost + bext + bAU)) {
           k           = i;
           l           = j;
           st1[i - 1]  = '(';
@@ -3506,7 +3753,7 @@ fbacktrack(int        i,
           break;
         }
 
-        if (c[i][j] == (by[i - 1][j + 2] + 2 * extension_cost + bext + bAU)) {
+        if (plex->c[i][j] == (plex->by[i - 1][j + 2] + 2 * extension_cost + bext + bAU)) {
           k           = i;
           l           = j;
           st1[i - 1]  = '(';
@@ -3520,7 +3767,7 @@ fbacktrack(int        i,
 
         break;
       case 2:
-        if (in[i][j] == (in[i - 1][j + 1] + iext_s)) {
+        if (plex->in[i][j] == (plex->in[i - 1][j + 1] + iext_s)) {
           i--;
           j++;
           state   = 2;
@@ -3528,23 +3775,23 @@ fbacktrack(int        i,
           break;
         }
 
-        if (in[i][j] == (in[i - 1][j] + iext_ass)) {
+        if (plex->in[i][j] == (plex->in[i - 1][j] + iext_ass)) {
           i       = i - 1;
           state   = 2;
           traced  = 1;
           break;
         }
 
-        if (in[i][j] == (in[i][j + 1] + iext_ass)) {
+        if (plex->in[i][j] == (plex->in[i][j + 1] + iext_ass)) {
           j++;
           state   = 2;
           traced  = 1;
           break;
         }
 
-        type2 = pair[S2[j + 1]][S1[i - 1]];
+        type2 = md->pair[plex->S2[j + 1]][plex->S1[i - 1]];
         if (type2 &&
-            in[i][j] == (c[i - 1][j + 1] + P->mismatchI[type2][SS2[j]][SS1[i]] + iopen + iext_s)) {
+            plex->in[i][j] == (plex->c[i - 1][j + 1] + P->mismatchI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s)) {
           int temp;
           temp  = k;
           k     = i - 1;
@@ -3552,15 +3799,15 @@ fbacktrack(int        i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = md->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
                              rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
                              P);
           i       = k;
           j       = l;
@@ -3570,15 +3817,15 @@ fbacktrack(int        i,
         }
 
       case 3:
-        if (bx[i][j] == (bx[i - 1][j] + bext)) {
+        if (plex->bx[i][j] == (plex->bx[i - 1][j] + bext)) {
           i--;
           state   = 3;
           traced  = 1;
           break;
         }
 
-        type2 = pair[S2[j]][S1[i - 1]];
-        if (type2 && bx[i][j] == (c[i - 1][j] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0))) {
+        type2 = md->pair[plex->S2[j]][plex->S1[i - 1]];
+        if (type2 && plex->bx[i][j] == (plex->c[i - 1][j] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0))) {
           int temp;
           temp  = k;
           k     = i - 1;
@@ -3586,15 +3833,15 @@ fbacktrack(int        i,
           temp  = l;
           l     = j;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = md->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
                              rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
                              P);
           i       = k;
           j       = l;
@@ -3604,7 +3851,7 @@ fbacktrack(int        i,
         }
 
       case 4:
-        if (by[i][j] == (by[i][j + 1] + bext)) {
+        if (plex->by[i][j] == (plex->by[i][j + 1] + bext)) {
           j++;
 
           state   = 4;
@@ -3612,8 +3859,8 @@ fbacktrack(int        i,
           break;
         }
 
-        type2 = pair[S2[j + 1]][S1[i]];
-        if (type2 && by[i][j] == (c[i][j + 1] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0))) {
+        type2 = md->pair[plex->S2[j + 1]][plex->S1[i]];
+        if (type2 && plex->by[i][j] == (plex->c[i][j + 1] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0))) {
           int temp;
           temp  = k;
           k     = i;
@@ -3621,15 +3868,15 @@ fbacktrack(int        i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = md->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
                              rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
                              P);
           i       = k;
           j       = l;
@@ -3639,17 +3886,17 @@ fbacktrack(int        i,
         }
 
       case 5:
-        if (inx[i][j] == (inx[i - 1][j] + iext_ass)) {
+        if (plex->inx[i][j] == (plex->inx[i - 1][j] + iext_ass)) {
           i--;
           state   = 5;
           traced  = 1;
           break;
         }
 
-        type2 = pair[S2[j + 1]][S1[i - 1]];
+        type2 = md->pair[plex->S2[j + 1]][plex->S1[i - 1]];
         if (type2 &&
-            inx[i][j] ==
-            (c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s)) {
+            plex->inx[i][j] ==
+            (plex->c[i - 1][j + 1] + P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s)) {
           int temp;
           temp  = k;
           k     = i - 1;
@@ -3657,15 +3904,15 @@ fbacktrack(int        i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = md->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
                              rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
                              P);
           i       = k;
           j       = l;
@@ -3675,17 +3922,17 @@ fbacktrack(int        i,
         }
 
       case 6:
-        if (iny[i][j] == (iny[i][j + 1] + iext_ass)) {
+        if (plex->iny[i][j] == (plex->iny[i][j + 1] + iext_ass)) {
           j++;
           state   = 6;
           traced  = 1;
           break;
         }
 
-        type2 = pair[S2[j + 1]][S1[i - 1]];
+        type2 = md->pair[plex->S2[j + 1]][plex->S1[i - 1]];
         if (type2 &&
-            iny[i][j] ==
-            (c[i - 1][j + 1] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s)) {
+            plex->iny[i][j] ==
+            (plex->c[i - 1][j + 1] + P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s)) {
           int temp;
           temp  = k;
           k     = i - 1;
@@ -3693,15 +3940,15 @@ fbacktrack(int        i,
           temp  = l;
           l     = j + 1;
           j     = temp;
-          type  = pair[S1[i]][S2[j]];
+          type  = md->pair[plex->S1[i]][plex->S2[j]];
           *dG   += E_IntLoop(i - k - 1,
                              l - j - 1,
                              type2,
                              rtype[type],
-                             SS1[k + 1],
-                             SS2[l - 1],
-                             SS1[i - 1],
-                             SS2[j + 1],
+                             plex->SS1[k + 1],
+                             plex->SS2[l - 1],
+                             plex->SS1[i - 1],
+                             plex->SS2[j + 1],
                              P);
           i       = k;
           j       = l;
@@ -3712,14 +3959,14 @@ fbacktrack(int        i,
     }
   }
   if (!traced) {
-    E = c[i][j];
+    E = plex->c[i][j];
     /**
     ***    if (i>1) {E -= P->dangle5[type][SS1[i-1]]+extension_cost; *dG+=P->dangle5[type][SS1[i-1]];}
     ***    if (j<n4){E -= P->dangle3[type][SS2[j+1]]+extension_cost; *dG+=P->dangle3[type][SS2[j+1]];}
     ***    if (type>2) {E -= P->TerminalAU; *dG+=P->TerminalAU;}
     **/
     int correction;
-    correction  = vrna_E_ext_stem(type, (i > 1) ? SS1[i - 1] : -1, (j < n4) ? SS2[j + 1] : -1, P);
+    correction  = vrna_E_ext_stem(type, (i > 1) ? plex->SS1[i - 1] : -1, (j < plex->n4) ? plex->SS2[j + 1] : -1, P);
     *dG         += correction;
     E           -= correction + 2 * extension_cost;
     if (E != P->DuplexInit + 2 * extension_cost) {
@@ -3734,7 +3981,7 @@ fbacktrack(int        i,
   if (i > 11)
     i--;
 
-  if (j < n4 - 10)
+  if (j < plex->n4 - 10)
     j++;
 
   struc = (char *)vrna_alloc(i0 - i + 1 + j - j0 + 1 + 2);
@@ -3756,19 +4003,24 @@ fbacktrack(int        i,
 }
 
 
-duplexT **
-Lduplexfold(const char  *s1,
-            const char  *s2,
-            const int   threshold,
-            const int   extension_cost,
-            const int   alignment_length,
-            const int   delta,
-            const int   fast,
-            const int   il_a,
-            const int   il_b,
-            const int   b_a,
-            const int   b_b)
+PRIVATE void
+plex_fold(struct vrna_plex_s  *plex,
+          const char          *s1,
+          const char          *s2,
+          const int           threshold,
+          const int           extension_cost,
+          const int           alignment_length,
+          const int           delta,
+          const int           fast,
+          const int           il_a,
+          const int           il_b,
+          const int           b_a,
+          const int           b_b)
 {
+  vrna_param_t  *P     = plex->P;
+  vrna_md_t     *md    = &(P->model_details);
+  int           *rtype = &(md->rtype[0]);
+
   /**
   *** See variable definition in fduplexfold_XS
   **/
@@ -3792,32 +4044,33 @@ Lduplexfold(const char  *s1,
   *** Makes the computation 20% faster
   **/
   int       *SA;
-  vrna_md_t md;
+  /**
+  *** query profile, penalties and costs for the vectorized column fill
+  **/
+  struct plex_profile *prof;
+  struct plex_costs   costs = {
+    extension_cost, bopen, bext, iopen, iext_s, iext_ass
+  };
+  const int           di[5] = {
+    0, 0, 0, 0, 0
+  };
+  const int           *dj[5];
 
   /**
   *** variable initialization
   **/
-  n1  = (int)strlen(s1);
-  n2  = (int)strlen(s2);
+  plex->n1  = (int)strlen(s1);
+  plex->n2  = (int)strlen(s2);
   /**
   *** Sequence encoding
   **/
-  set_model_details(&md);
-  if ((!P) || (fabs(P->temperature - temperature) > 1e-6)) {
-    update_fold_params();
-    if (P)
-      free(P);
-
-    P = vrna_params(&md);
-    make_pair_matrix();
-  }
 
-  encode_seqs(s1, s2);
+  prepare_seqs(plex, s1, s2);
   /**
   *** Position of the high score on the target and query sequence
   **/
-  position    = (int *)vrna_alloc((delta + n1 + 3 + delta) * sizeof(int));
-  position_j  = (int *)vrna_alloc((delta + n1 + 3 + delta) * sizeof(int));
+  position    = (int *)vrna_alloc((delta + plex->n1 + 3 + delta) * sizeof(int));
+  position_j  = (int *)vrna_alloc((delta + plex->n1 + 3 + delta) * sizeof(int));
   /**
   *** instead of having 4 2-dim arrays we use a unique 1-dim array
   *** The mapping 2d -> 1D is done based ont the macro
@@ -3832,8 +4085,8 @@ Lduplexfold(const char  *s1,
   ***                  * 6 (number of structures we look at) *
   ***                  * length of the sequence
   **/
-  SA = (int *)vrna_alloc(sizeof(int) * 5 * 6 * (n2 + 5));
-  for (j = n2 + 4; j >= 0; j--) {
+  SA = (int *)vrna_alloc(sizeof(int) * 5 * 6 * (plex->n2 + 5));
+  for (j = plex->n2 + 4; j >= 0; j--) {
     SA[(j *
         30)]            =
       SA[(j * 30) + 1]  = SA[(j * 30) + 2] = SA[(j * 30) + 3] = SA[(j * 30) + 4] = INF;
@@ -3863,218 +4116,227 @@ Lduplexfold(const char  *s1,
          25]                  =
         SA[(j * 30) + 2 + 25] = SA[(j * 30) + 3 + 25] = SA[(j * 30) + 4 + 25] = INF;
   }
+  prof = simd_profile_init(plex);
+  if (prof)
+    for (j = 0; j < 5; j++)
+      dj[j] = prof->zero;
+
   i         = 10;
-  i_length  = n1 - 9;
+  i_length  = plex->n1 - 9;
   while (i < i_length) {
     int idx   = i % 5;
     int idx_1 = (i - 1) % 5;
     int idx_2 = (i - 2) % 5;
     int idx_3 = (i - 3) % 5;
     int idx_4 = (i - 4) % 5;
-    j = n2 - 9;
-    while (9 < --j) {
-      int type, type2;
-      type = pair[S1[i]][S2[j]];
-      /**
-      *** Start duplex
-      **/
-      SA[LCI(idx, j, n2)] = type ? P->DuplexInit + 2 * extension_cost : INF;
-      /**
-      *** update lin bx by linx liny matrix
-      **/
-      type2 = pair[S2[j + 1]][S1[i - 1]];
-      /**
-      *** start/extend interior loop
-      **/
-      SA[LINI(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                         n2)] + P->mismatchI[type2][SS2[j]][SS1[i]] + iopen + iext_s,
-                                  SA[LINI(idx_1, j, n2)] + iext_ass);
-      /**
-      *** start/extend nx1 target
-      *** use same type2 as for in
-      **/
-      SA[LINIX(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                          n2)] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s,
-                                   SA[LINIX(idx_1, j, n2)] + iext_ass);
-      /**
-      *** start/extend 1xn target
-      *** use same type2 as for in
-      **/
-      SA[LINIY(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                          n2)] + P->mismatch1nI[type2][SS2[j]][SS1[i]] + iopen + iext_s,
-                                   SA[LINIY(idx, j + 1, n2)] + iext_ass);
-      /**
-      *** extend interior loop
-      **/
-      SA[LINI(idx, j, n2)]  = MIN2(SA[LINI(idx, j, n2)], SA[LINI(idx, j + 1, n2)] + iext_ass);
-      SA[LINI(idx, j, n2)]  = MIN2(SA[LINI(idx, j, n2)], SA[LINI(idx_1, j + 1, n2)] + iext_s);
-      /**
-      *** start/extend bulge target
-      **/
-      type2                 = pair[S2[j]][S1[i - 1]];
-      SA[LBXI(idx, j, n2)]  = MIN2(SA[LBXI(idx_1, j, n2)] + bext,
-                                   SA[LCI(idx_1, j,
-                                          n2)] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0));
-      /**
-      *** start/extend bulge query
-      **/
-      type2                 = pair[S2[j + 1]][S1[i]];
-      SA[LBYI(idx, j, n2)]  = MIN2(SA[LBYI(idx, j + 1, n2)] + bext,
-                                   SA[LCI(idx, j + 1,
-                                          n2)] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0));
-      /**
-       ***end update recursion
-       ***##################### Start stack extension ######################
-       **/
-      if (!type)
-        continue; /**
-                  *** stack extension
-                  **/
-
-      SA[LCI(idx, j, n2)] += vrna_E_ext_stem(type, SS1[i - 1], SS2[j + 1], P) + 2 * extension_cost;
-      /**
-      *** stack extension
-      **/
-      if ((type2 = pair[S1[i - 1]][S2[j + 1]]))
-        SA[LCI(idx, j, n2)] = MIN2(SA[LCI(idx_1, j + 1,
-                                          n2)] + P->stack[rtype[type]][type2] + 2 * extension_cost,
-                                   SA[LCI(idx, j, n2)]);
+    if (prof) {
+      fill_column_simd(plex, SA, prof, i, di, dj, &costs, &min_colonne, &min_j_colonne);
+    } else {
+      j = plex->n2 - 9;
+      while (9 < --j) {
+        int type, type2;
+        type = md->pair[plex->S1[i]][plex->S2[j]];
+        /**
+        *** Start duplex
+        **/
+        SA[LCI(idx, j, plex->n2)] = type ? P->DuplexInit + 2 * extension_cost : INF;
+        /**
+        *** update lin bx by linx liny matrix
+        **/
+        type2 = md->pair[plex->S2[j + 1]][plex->S1[i - 1]];
+        /**
+        *** start/extend interior loop
+        **/
+        SA[LINI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                           plex->n2)] + P->mismatchI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s,
+                                    SA[LINI(idx_1, j, plex->n2)] + iext_ass);
+        /**
+        *** start/extend nx1 target
+        *** use same type2 as for in
+        **/
+        SA[LINIX(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                            plex->n2)] + P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s,
+                                     SA[LINIX(idx_1, j, plex->n2)] + iext_ass);
+        /**
+        *** start/extend 1xn target
+        *** use same type2 as for in
+        **/
+        SA[LINIY(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                            plex->n2)] + P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]] + iopen + iext_s,
+                                     SA[LINIY(idx, j + 1, plex->n2)] + iext_ass);
+        /**
+        *** extend interior loop
+        **/
+        SA[LINI(idx, j, plex->n2)]  = MIN2(SA[LINI(idx, j, plex->n2)], SA[LINI(idx, j + 1, plex->n2)] + iext_ass);
+        SA[LINI(idx, j, plex->n2)]  = MIN2(SA[LINI(idx, j, plex->n2)], SA[LINI(idx_1, j + 1, plex->n2)] + iext_s);
+        /**
+        *** start/extend bulge target
+        **/
+        type2                 = md->pair[plex->S2[j]][plex->S1[i - 1]];
+        SA[LBXI(idx, j, plex->n2)]  = MIN2(SA[LBXI(idx_1, j, plex->n2)] + bext,
+                                     SA[LCI(idx_1, j,
+                                            plex->n2)] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0));
+        /**
+        *** start/extend bulge query
+        **/
+        type2                 = md->pair[plex->S2[j + 1]][plex->S1[i]];
+        SA[LBYI(idx, j, plex->n2)]  = MIN2(SA[LBYI(idx, j + 1, plex->n2)] + bext,
+                                     SA[LCI(idx, j + 1,
+                                            plex->n2)] + bopen + bext + (type2 > 2 ? P->TerminalAU : 0));
+        /**
+         ***end update recursion
+         ***##################### Start stack extension ######################
+         **/
+        if (!type)
+          continue; /**
+                    *** stack extension
+                    **/
+
+        SA[LCI(idx, j, plex->n2)] += vrna_E_ext_stem(type, plex->SS1[i - 1], plex->SS2[j + 1], P) + 2 * extension_cost;
+        /**
+        *** stack extension
+        **/
+        if ((type2 = md->pair[plex->S1[i - 1]][plex->S2[j + 1]]))
+          SA[LCI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_1, j + 1,
+                                            plex->n2)] + P->stack[rtype[type]][type2] + 2 * extension_cost,
+                                     SA[LCI(idx, j, plex->n2)]);
+
+        /**
+        *** 1x0 / 0x1 stack extension
+        **/
+        if ((type2 = md->pair[plex->S1[i - 1]][plex->S2[j + 2]])) {
+          SA[LCI(idx, j,
+                 plex->n2)] = MIN2(SA[LCI(idx_1, j + 2,
+                                    plex->n2)] + P->bulge[1] + P->stack[rtype[type]][type2] + 3 * extension_cost,
+                             SA[LCI(idx, j, plex->n2)]);
+        }
 
-      /**
-      *** 1x0 / 0x1 stack extension
-      **/
-      if ((type2 = pair[S1[i - 1]][S2[j + 2]])) {
-        SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_1, j + 2,
-                                  n2)] + P->bulge[1] + P->stack[rtype[type]][type2] + 3 * extension_cost,
-                           SA[LCI(idx, j, n2)]);
-      }
+        if ((type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 1]])) {
+          SA[LCI(idx, j,
+                 plex->n2)] = MIN2(SA[LCI(idx_2, j + 1,
+                                    plex->n2)] + P->bulge[1] + P->stack[type2][rtype[type]] + 3 * extension_cost,
+                             SA[LCI(idx, j, plex->n2)]);
+        }
 
-      if ((type2 = pair[S1[i - 2]][S2[j + 1]])) {
-        SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_2, j + 1,
-                                  n2)] + P->bulge[1] + P->stack[type2][rtype[type]] + 3 * extension_cost,
-                           SA[LCI(idx, j, n2)]);
-      }
+        /**
+        *** 1x1 / 2x2 stack extension
+        **/
+        if ((type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 2]])) {
+          SA[LCI(idx, j,
+                 plex->n2)] = MIN2(SA[LCI(idx_2, j + 2,
+                                    plex->n2)] + P->int11[type2][rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 4 * extension_cost,
+                             SA[LCI(idx, j, plex->n2)]);
+        }
 
-      /**
-      *** 1x1 / 2x2 stack extension
-      **/
-      if ((type2 = pair[S1[i - 2]][S2[j + 2]])) {
-        SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_2, j + 2,
-                                  n2)] + P->int11[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]] + 4 * extension_cost,
-                           SA[LCI(idx, j, n2)]);
-      }
+        if ((type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 3]])) {
+          SA[LCI(idx, j,
+                 plex->n2)] = MIN2(SA[LCI(idx_3, j + 3,
+                                    plex->n2)] +
+                             P->int22[type2][rtype[type]][plex->SS1[i - 2]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j +
+                                                                                                  2]] + 6 * extension_cost,
+                             SA[LCI(idx, j, plex->n2)]);
+        }
 
-      if ((type2 = pair[S1[i - 3]][S2[j + 3]])) {
-        SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_3, j + 3,
-                                  n2)] +
-                           P->int22[type2][rtype[type]][SS1[i - 2]][SS1[i - 1]][SS2[j + 1]][SS2[j +
-                                                                                                2]] + 6 * extension_cost,
-                           SA[LCI(idx, j, n2)]);
-      }
+        /**
+        *** 1x2 / 2x1 stack extension
+        *** E_IntLoop(1,2,type2, rtype[type],SS1[i-1], SS2[j+2], SS1[i-1], SS2[j+1], P) corresponds to
+        *** P->int21[rtype[type]][type2][SS2[j+2]][SS1[i-1]][SS1[i-1]]
+        **/
+        if ((type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 2]])) {
+          SA[LCI(idx, j,
+                 plex->n2)] = MIN2(SA[LCI(idx_3, j + 2,
+                                    plex->n2)] +
+                             P->int21[rtype[type]][type2][plex->SS2[j + 1]][plex->SS1[i - 2]][plex->SS1[i - 1]] + 5 * extension_cost,
+                             SA[LCI(idx, j, plex->n2)]);
+        }
 
-      /**
-      *** 1x2 / 2x1 stack extension
-      *** E_IntLoop(1,2,type2, rtype[type],SS1[i-1], SS2[j+2], SS1[i-1], SS2[j+1], P) corresponds to
-      *** P->int21[rtype[type]][type2][SS2[j+2]][SS1[i-1]][SS1[i-1]]
-      **/
-      if ((type2 = pair[S1[i - 3]][S2[j + 2]])) {
-        SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_3, j + 2,
-                                  n2)] +
-                           P->int21[rtype[type]][type2][SS2[j + 1]][SS1[i - 2]][SS1[i - 1]] + 5 * extension_cost,
-                           SA[LCI(idx, j, n2)]);
-      }
+        if ((type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 3]])) {
+          SA[LCI(idx, j,
+                 plex->n2)] = MIN2(SA[LCI(idx_2, j + 3,
+                                    plex->n2)] +
+                             P->int21[type2][rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] + 5 * extension_cost,
+                             SA[LCI(idx, j, plex->n2)]);
+        }
 
-      if ((type2 = pair[S1[i - 2]][S2[j + 3]])) {
-        SA[LCI(idx, j,
-               n2)] = MIN2(SA[LCI(idx_2, j + 3,
-                                  n2)] +
-                           P->int21[type2][rtype[type]][SS1[i - 1]][SS2[j + 1]][SS2[j + 2]] + 5 * extension_cost,
-                           SA[LCI(idx, j, n2)]);
-      }
+        /**
+        *** 2x3 / 3x2 stack extension
+        **/
+        if ((type2 = md->pair[plex->S1[i - 4]][plex->S2[j + 3]])) {
+          SA[LCI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_4, j + 3,
+                                            plex->n2)] + P->internal_loop[5] + P->ninio[2] +
+                                     P->mismatch23I[type2][plex->SS1[i - 3]][plex->SS2[j + 2]] +
+                                     P->mismatch23I[rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + 7 * extension_cost,
+                                     SA[LCI(idx, j, plex->n2)]);
+        }
 
-      /**
-      *** 2x3 / 3x2 stack extension
-      **/
-      if ((type2 = pair[S1[i - 4]][S2[j + 3]])) {
-        SA[LCI(idx, j, n2)] = MIN2(SA[LCI(idx_4, j + 3,
-                                          n2)] + P->internal_loop[5] + P->ninio[2] +
-                                   P->mismatch23I[type2][SS1[i - 3]][SS2[j + 2]] +
-                                   P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + 7 * extension_cost,
-                                   SA[LCI(idx, j, n2)]);
-      }
+        if ((type2 = md->pair[plex->S1[i - 3]][plex->S2[j + 4]])) {
+          SA[LCI(idx, j, plex->n2)] = MIN2(SA[LCI(idx_3, j + 4,
+                                            plex->n2)] + P->internal_loop[5] + P->ninio[2] +
+                                     P->mismatch23I[type2][plex->SS1[i - 2]][plex->SS2[j + 3]] +
+                                     P->mismatch23I[rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] + 7 * extension_cost,
+                                     SA[LCI(idx, j, plex->n2)]);
+        }
 
-      if ((type2 = pair[S1[i - 3]][S2[j + 4]])) {
-        SA[LCI(idx, j, n2)] = MIN2(SA[LCI(idx_3, j + 4,
-                                          n2)] + P->internal_loop[5] + P->ninio[2] +
-                                   P->mismatch23I[type2][SS1[i - 2]][SS2[j + 3]] +
-                                   P->mismatch23I[rtype[type]][SS2[j + 1]][SS1[i - 1]] + 7 * extension_cost,
-                                   SA[LCI(idx, j, n2)]);
+        /**
+        *** So now we have to handle 1x3, 3x1, 3x3, and mxn m,n > 3
+        **/
+        /**
+        *** 3x3 or more
+        **/
+        SA[LCI(idx, j,
+               plex->n2)] = MIN2(SA[LINI(idx_3, j + 3,
+                                   plex->n2)] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + 2 * iext_s + 2 * extension_cost,
+                           SA[LCI(idx, j, plex->n2)]);
+        /**
+        *** 2xn or more
+        **/
+        SA[LCI(idx, j,
+               plex->n2)] = MIN2(SA[LINI(idx_4, j + 2,
+                                   plex->n2)] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
+                           SA[LCI(idx, j, plex->n2)]);
+        /**
+        *** nx2 or more
+        **/
+        SA[LCI(idx, j,
+               plex->n2)] = MIN2(SA[LINI(idx_2, j + 4,
+                                   plex->n2)] + P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
+                           SA[LCI(idx, j, plex->n2)]);
+        /**
+        *** nx1 n>2
+        **/
+        SA[LCI(idx, j,
+               plex->n2)] = MIN2(SA[LINIX(idx_3, j + 1,
+                                    plex->n2)] + P->mismatch1nI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
+                           SA[LCI(idx, j, plex->n2)]);
+        /**
+        *** 1xn n>2
+        **/
+        SA[LCI(idx, j,
+               plex->n2)] = MIN2(SA[LINIY(idx_1, j + 3,
+                                    plex->n2)] + P->mismatch1nI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
+                           SA[LCI(idx, j, plex->n2)]);
+        /**
+        *** nx0 n>1
+        **/
+        int bAU;
+        bAU = (type > 2 ? P->TerminalAU : 0);
+        SA[LCI(idx, j,
+               plex->n2)] =
+          MIN2(SA[LBXI(idx_2, j + 1, plex->n2)] + 2 * extension_cost + bext + bAU, SA[LCI(idx, j, plex->n2)]);
+        /**
+        *** 0xn n>1
+        **/
+        SA[LCI(idx, j,
+               plex->n2)] =
+          MIN2(SA[LBYI(idx_1, j + 2, plex->n2)] + 2 * extension_cost + bext + bAU, SA[LCI(idx, j, plex->n2)]);
+        temp = min_colonne;
+
+        min_colonne = MIN2(SA[LCI(idx, j, plex->n2)] + vrna_E_ext_stem(rtype[type], plex->SS2[j - 1], plex->SS1[i + 1],
+                                                                 P) + 2 * extension_cost,
+                           min_colonne);
+        if (temp > min_colonne)
+          min_j_colonne = j;
       }
-
-      /**
-      *** So now we have to handle 1x3, 3x1, 3x3, and mxn m,n > 3
-      **/
-      /**
-      *** 3x3 or more
-      **/
-      SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINI(idx_3, j + 3,
-                                 n2)] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + 2 * iext_s + 2 * extension_cost,
-                         SA[LCI(idx, j, n2)]);
-      /**
-      *** 2xn or more
-      **/
-      SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINI(idx_4, j + 2,
-                                 n2)] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
-                         SA[LCI(idx, j, n2)]);
-      /**
-      *** nx2 or more
-      **/
-      SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINI(idx_2, j + 4,
-                                 n2)] + P->mismatchI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_s + 2 * iext_ass + 2 * extension_cost,
-                         SA[LCI(idx, j, n2)]);
-      /**
-      *** nx1 n>2
-      **/
-      SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINIX(idx_3, j + 1,
-                                  n2)] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
-                         SA[LCI(idx, j, n2)]);
-      /**
-      *** 1xn n>2
-      **/
-      SA[LCI(idx, j,
-             n2)] = MIN2(SA[LINIY(idx_1, j + 3,
-                                  n2)] + P->mismatch1nI[rtype[type]][SS1[i - 1]][SS2[j + 1]] + iext_ass + iext_ass + 2 * extension_cost,
-                         SA[LCI(idx, j, n2)]);
-      /**
-      *** nx0 n>1
-      **/
-      int bAU;
-      bAU = (type > 2 ? P->TerminalAU : 0);
-      SA[LCI(idx, j,
-             n2)] =
-        MIN2(SA[LBXI(idx_2, j + 1, n2)] + 2 * extension_cost + bext + bAU, SA[LCI(idx, j, n2)]);
-      /**
-      *** 0xn n>1
-      **/
-      SA[LCI(idx, j,
-             n2)] =
-        MIN2(SA[LBYI(idx_1, j + 2, n2)] + 2 * extension_cost + bext + bAU, SA[LCI(idx, j, n2)]);
-      temp = min_colonne;
-
-      min_colonne = MIN2(SA[LCI(idx, j, n2)] + vrna_E_ext_stem(rtype[type], SS2[j - 1], SS1[i + 1],
-                                                               P) + 2 * extension_cost,
-                         min_colonne);
-      if (temp > min_colonne)
-        min_j_colonne = j;
     }
     if (max >= min_colonne) {
       max       = min_colonne;
@@ -4088,12 +4350,10 @@ Lduplexfold(const char  *s1,
     i++;
   }
   /* printf("MAX: %d",max); */
-  free(S1);
-  free(S2);
-  free(SS1);
-  free(SS2);
+  release_seqs(plex);
   if (max < threshold) {
-    find_max(position,
+    find_max(plex,
+             position,
              position_j,
              delta,
              threshold,
@@ -4109,7 +4369,8 @@ Lduplexfold(const char  *s1,
   }
 
   if (max < INF) {
-    plot_max(max,
+    plot_max(plex,
+             max,
              max_pos,
              max_pos_j,
              alignment_length,
@@ -4124,28 +4385,29 @@ Lduplexfold(const char  *s1,
   }
 
   free(SA);
+  profile_free(prof);
   free(position);
   free(position_j);
-  return NULL;
 }
 
 
 PRIVATE void
-find_max(const int  *position,
-         const int  *position_j,
-         const int  delta,
-         const int  threshold,
-         const int  alignment_length,
-         const char *s1,
-         const char *s2,
-         const int  extension_cost,
-         const int  fast,
-         const int  il_a,
-         const int  il_b,
-         const int  b_a,
-         const int  b_b)
+find_max(struct vrna_plex_s *plex,
+         const int          *position,
+         const int          *position_j,
+         const int          delta,
+         const int          threshold,
+         const int          alignment_length,
+         const char         *s1,
+         const char         *s2,
+         const int          extension_cost,
+         const int          fast,
+         const int          il_a,
+         const int          il_b,
+         const int          b_a,
+         const int          b_b)
 {
-  int pos = n1 - 9;
+  int pos = plex->n1 - 9;
 
   if (fast == 1) {
     while (10 < pos--) {
@@ -4162,15 +4424,15 @@ find_max(const int  *position,
         max_pos_j = position_j[pos + delta];
         int max;
         max = position[pos + delta];
-        printf("target upper bound %d: query lower bound %d  (%5.2f) \n",
-               pos - 10,
-               max_pos_j - 10,
-               ((double)max) / 100);
+        vrna_cstr_printf(plex->out, "target upper bound %d: query lower bound %d  (%5.2f) \n",
+                                    pos - 10,
+                                    max_pos_j - 10,
+                                    ((double)max) / 100);
         pos = MAX2(10, pos + temp_min - delta);
       }
     }
   } else if (fast == 2) {
-    pos = n1 - 9;
+    pos = plex->n1 - 9;
     while (10 < pos--) {
       int temp_min = 0;
       if (position[pos + delta] < (threshold)) {
@@ -4189,11 +4451,11 @@ find_max(const int  *position,
          * max_pos_j -> position 1 in the sequence ( not 0 like in C)
          */
         int   alignment_length2;
-        alignment_length2 = MIN2(n1, n2);
+        alignment_length2 = MIN2(plex->n1, plex->n2);
         int   begin_t = MAX2(11, pos - alignment_length2 + 1);  /* 10 */
-        int   end_t   = MIN2(n1 - 10, pos + 1);
+        int   end_t   = MIN2(plex->n1 - 10, pos + 1);
         int   begin_q = MAX2(11, max_pos_j - 1);                /* 10 */
-        int   end_q   = MIN2(n2 - 10, max_pos_j + alignment_length2 - 1);
+        int   end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length2 - 1);
         char  *s3     = (char *)vrna_alloc(sizeof(char) * (end_t - begin_t + 2 + 20));
         char  *s4     = (char *)vrna_alloc(sizeof(char) * (end_q - begin_q + 2 + 20));
         strcpy(s3, "NNNNNNNNNN");
@@ -4205,16 +4467,16 @@ find_max(const int  *position,
         s3[end_t - begin_t + 1 + 20]  = '\0';
         s4[end_q - begin_q + 1 + 20]  = '\0';
         duplexT test;
-        test = fduplexfold(s3, s4, extension_cost, il_a, il_b, b_a, b_b);
+        test = fduplexfold(plex, s3, s4, extension_cost, il_a, il_b, b_a, b_b);
         if (test.energy * 100 < threshold) {
           int l1 = strchr(test.structure, '&') - test.structure;
-          printf("%s %3d,%-3d : %3d,%-3d (%5.2f) [%5.2f]  i:%d,j:%d <%5.2f>\n", test.structure,
-                 begin_t - 10 + test.i - l1 - 10,
-                 begin_t - 10 + test.i - 1 - 10,
-                 begin_q - 10 + test.j - 1 - 10,
-                 (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
-                 test.energy, test.energy_backtrack, pos - 10, max_pos_j - 10,
-                 ((double)position[pos + delta]) / 100);
+          vrna_cstr_printf(plex->out, "%s %3d,%-3d : %3d,%-3d (%5.2f) [%5.2f]  i:%d,j:%d <%5.2f>\n", test.structure,
+                                      begin_t - 10 + test.i - l1 - 10,
+                                      begin_t - 10 + test.i - 1 - 10,
+                                      begin_q - 10 + test.j - 1 - 10,
+                                      (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
+                                      test.energy, test.energy_backtrack, pos - 10, max_pos_j - 10,
+                                      ((double)position[pos + delta]) / 100);
           pos = MAX2(10, pos + temp_min - delta);
         }
 
@@ -4227,7 +4489,7 @@ find_max(const int  *position,
 
 #if 0
   else if (fast == 3) {
-    pos = n1 - 9;
+    pos = plex->n1 - 9;
     while (10 < pos--) {
       int temp_min = 0;
       if (position[pos + delta] < (threshold)) {
@@ -4251,12 +4513,12 @@ find_max(const int  *position,
 
         int   alignment_length2;
         //Select the smallest interaction length in order to define the new interaction length
-        alignment_length2 = MIN2(n1 - pos + 1, max_pos_j - 1 + 1);
+        alignment_length2 = MIN2(plex->n1 - pos + 1, max_pos_j - 1 + 1);
         //
         int   begin_t = MAX2(11, pos - alignment_length2 + 1);  /* 10 */
-        int   end_t   = MIN2(n1 - 10, pos + 1);
+        int   end_t   = MIN2(plex->n1 - 10, pos + 1);
         int   begin_q = MAX2(11, max_pos_j - 1);                /* 10 */
-        int   end_q   = MIN2(n2 - 10, max_pos_j + alignment_length2 - 1);
+        int   end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length2 - 1);
         char  *s3     = (char *)vrna_alloc(sizeof(char) * (end_t - begin_t + 2 + 20));
         char  *s4     = (char *)vrna_alloc(sizeof(char) * (end_q - begin_q + 2 + 20));
         strcpy(s3, "NNNNNNNNNN");
@@ -4268,7 +4530,7 @@ find_max(const int  *position,
         s3[end_t - begin_t + 1 + 20]  = '\0';
         s4[end_q - begin_q + 1 + 20]  = '\0';
         duplexT test;
-        test = fduplexfold(s4, s3, extension_cost, il_a, il_b, b_a, b_b);
+        test = fduplexfold(plex, s4, s3, extension_cost, il_a, il_b, b_a, b_b);
         if (test.energy * 100 < threshold) {
           int   structureLength = strlen(test.structure);
           int   l1 = strchr(test.structure, '&') - test.structure;
@@ -4295,17 +4557,17 @@ find_max(const int  *position,
           //          l1=strchr(reverse.structure, '&')-test.structure;
 
 
-          printf("%s %3d,%-3d : %3d,%-3d (%5.2f) [%5.2f] i:%d,j:%d <%5.2f>\n",
-                 reverseStructure,
-                 begin_t - 10 + test.j - 1 - 10,
-                 (begin_t - 11) + test.j + strlen(test.structure) - l1 - 2 - 10,
-                 begin_q - 10 + test.i - l1 - 10,
-                 begin_q - 10 + test.i - 1 - 10,
-                 test.energy,
-                 test.energy_backtrack,
-                 pos,
-                 max_pos_j,
-                 ((double)position[pos + delta]) / 100);
+          vrna_cstr_printf(plex->out, "%s %3d,%-3d : %3d,%-3d (%5.2f) [%5.2f] i:%d,j:%d <%5.2f>\n",
+                                      reverseStructure,
+                                      begin_t - 10 + test.j - 1 - 10,
+                                      (begin_t - 11) + test.j + strlen(test.structure) - l1 - 2 - 10,
+                                      begin_q - 10 + test.i - l1 - 10,
+                                      begin_q - 10 + test.i - 1 - 10,
+                                      test.energy,
+                                      test.energy_backtrack,
+                                      pos,
+                                      max_pos_j,
+                                      ((double)position[pos + delta]) / 100);
           pos = MAX2(10, pos + temp_min - delta);
         }
 
@@ -4317,7 +4579,7 @@ find_max(const int  *position,
   }
 #endif
   else {
-    pos = n1 - 9;
+    pos = plex->n1 - 9;
     while (10 < pos--) {
       int temp_min = 0;
       if (position[pos + delta] < (threshold)) {
@@ -4336,11 +4598,11 @@ find_max(const int  *position,
          * max_pos_j -> position 1 in the sequence ( not 0 like in C)
          */
         int     alignment_length2;
-        alignment_length2 = MIN2(n1, n2);
+        alignment_length2 = MIN2(plex->n1, plex->n2);
         int     begin_t = MAX2(11, pos - alignment_length2 + 1);  /* 10 */
-        int     end_t   = MIN2(n1 - 10, pos + 1);
+        int     end_t   = MIN2(plex->n1 - 10, pos + 1);
         int     begin_q = MAX2(11, max_pos_j - 1);                /* 10 */
-        int     end_q   = MIN2(n2 - 10, max_pos_j + alignment_length2 - 1);
+        int     end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length2 - 1);
         char    *s3     = (char *)vrna_alloc(sizeof(char) * (end_t - begin_t + 2));
         char    *s4     = (char *)vrna_alloc(sizeof(char) * (end_q - begin_q + 2));
         strncpy(s3, (s1 + begin_t - 1), end_t - begin_t + 1);
@@ -4348,15 +4610,15 @@ find_max(const int  *position,
         s3[end_t - begin_t + 1] = '\0';
         s4[end_q - begin_q + 1] = '\0';
         duplexT test;
-        test = duplexfold(s3, s4, extension_cost);
+        test = duplexfold(plex, s3, s4, extension_cost);
         if (test.energy * 100 < threshold) {
           int l1 = strchr(test.structure, '&') - test.structure;
-          printf("%s %3d,%-3d : %3d,%-3d (%5.2f)  i:%d,j:%d <%5.2f>\n", test.structure,
-                 begin_t - 10 + test.i - l1,
-                 begin_t - 10 + test.i - 1,
-                 begin_q - 10 + test.j - 1,
-                 (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2,
-                 test.energy, pos - 10, max_pos_j - 10, ((double)position[pos + delta]) / 100);
+          vrna_cstr_printf(plex->out, "%s %3d,%-3d : %3d,%-3d (%5.2f)  i:%d,j:%d <%5.2f>\n", test.structure,
+                                      begin_t - 10 + test.i - l1,
+                                      begin_t - 10 + test.i - 1,
+                                      begin_q - 10 + test.j - 1,
+                                      (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2,
+                                      test.energy, pos - 10, max_pos_j - 10, ((double)position[pos + delta]) / 100);
           pos = MAX2(10, pos + temp_min - delta);
         }
 
@@ -4370,29 +4632,30 @@ find_max(const int  *position,
 
 
 PRIVATE void
-plot_max(const int  max,
-         const int  max_pos,
-         const int  max_pos_j,
-         const int  alignment_length,
-         const char *s1,
-         const char *s2,
-         const int  extension_cost,
-         const int  fast,
-         const int  il_a,
-         const int  il_b,
-         const int  b_a,
-         const int  b_b)
+plot_max(struct vrna_plex_s *plex,
+         const int          max,
+         const int          max_pos,
+         const int          max_pos_j,
+         const int          alignment_length,
+         const char         *s1,
+         const char         *s2,
+         const int          extension_cost,
+         const int          fast,
+         const int          il_a,
+         const int          il_b,
+         const int          b_a,
+         const int          b_b)
 {
   if (fast == 1) {
-    printf("target upper bound %d: query lower bound %d (%5.2f)\n", max_pos - 10, max_pos_j - 10,
-           ((double)max) / 100);
+    vrna_cstr_printf(plex->out, "target upper bound %d: query lower bound %d (%5.2f)\n", max_pos - 10, max_pos_j - 10,
+                                ((double)max) / 100);
   } else if (fast == 2) {
     int   alignment_length2;
-    alignment_length2 = MIN2(n1, n2);
+    alignment_length2 = MIN2(plex->n1, plex->n2);
     int   begin_t = MAX2(11, max_pos - alignment_length2 + 1);  /* 10 */
-    int   end_t   = MIN2(n1 - 10, max_pos + 1);
+    int   end_t   = MIN2(plex->n1 - 10, max_pos + 1);
     int   begin_q = MAX2(11, max_pos_j - 1);                    /* 10 */
-    int   end_q   = MIN2(n2 - 10, max_pos_j + alignment_length2 - 1);
+    int   end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length2 - 1);
     char  *s3     = (char *)vrna_alloc(sizeof(char) * (end_t - begin_t + 2 + 20));
     char  *s4     = (char *)vrna_alloc(sizeof(char) * (end_q - begin_q + 2 + 20));
     strcpy(s3, "NNNNNNNNNN");
@@ -4404,39 +4667,39 @@ plot_max(const int  max,
     s3[end_t - begin_t + 1 + 20]  = '\0';
     s4[end_q - begin_q + 1 + 20]  = '\0';
     duplexT test;
-    test = fduplexfold(s3, s4, extension_cost, il_a, il_b, b_a, b_b);
+    test = fduplexfold(plex, s3, s4, extension_cost, il_a, il_b, b_a, b_b);
     int     l1 = strchr(test.structure, '&') - test.structure;
-    printf("%s %3d,%-3d : %3d,%-3d (%5.2f) [%5.2f] i:%d,j:%d <%5.2f>\n", test.structure,
-           begin_t - 10 + test.i - l1 - 10,
-           begin_t - 10 + test.i - 1 - 10,
-           begin_q - 10 + test.j - 1 - 10,
-           (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
-           test.energy, test.energy_backtrack, max_pos - 10, max_pos_j - 10, ((double)max) / 100);
+    vrna_cstr_printf(plex->out, "%s %3d,%-3d : %3d,%-3d (%5.2f) [%5.2f] i:%d,j:%d <%5.2f>\n", test.structure,
+                                begin_t - 10 + test.i - l1 - 10,
+                                begin_t - 10 + test.i - 1 - 10,
+                                begin_q - 10 + test.j - 1 - 10,
+                                (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2 - 10,
+                                test.energy, test.energy_backtrack, max_pos - 10, max_pos_j - 10, ((double)max) / 100);
     free(s3);
     free(s4);
     free(test.structure);
   } else {
     duplexT test;
     int     alignment_length2;
-    alignment_length2 = MIN2(n1, n2);
+    alignment_length2 = MIN2(plex->n1, plex->n2);
     int     begin_t = MAX2(11, max_pos - alignment_length2 + 1);
-    int     end_t   = MIN2(n1 - 10, max_pos + 1);
+    int     end_t   = MIN2(plex->n1 - 10, max_pos + 1);
     int     begin_q = MAX2(11, max_pos_j - 1);
-    int     end_q   = MIN2(n2 - 10, max_pos_j + alignment_length2 - 1);
+    int     end_q   = MIN2(plex->n2 - 10, max_pos_j + alignment_length2 - 1);
     char    *s3     = (char *)vrna_alloc(sizeof(char) * (end_t - begin_t + 2));
     char    *s4     = (char *)vrna_alloc(sizeof(char) * (end_q - begin_q + 2));
     strncpy(s3, (s1 + begin_t - 1), end_t - begin_t + 1);
     strncpy(s4, (s2 + begin_q - 1), end_q - begin_q + 1);
     s3[end_t - begin_t + 1] = '\0';
     s4[end_q - begin_q + 1] = '\0';
-    test                    = duplexfold(s3, s4, extension_cost);
+    test                    = duplexfold(plex, s3, s4, extension_cost);
     int l1 = strchr(test.structure, '&') - test.structure;
-    printf("%s %3d,%-3d : %3d,%-3d (%5.2f) i:%d,j:%d <%5.2f>\n", test.structure,
-           begin_t - 10 + test.i - l1,
-           begin_t - 10 + test.i - 1,
-           begin_q - 10 + test.j - 1,
-           (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2,
-           test.energy, max_pos - 10, max_pos_j - 10, ((double)max) / 100);
+    vrna_cstr_printf(plex->out, "%s %3d,%-3d : %3d,%-3d (%5.2f) i:%d,j:%d <%5.2f>\n", test.structure,
+                                begin_t - 10 + test.i - l1,
+                                begin_t - 10 + test.i - 1,
+                                begin_q - 10 + test.j - 1,
+                                (begin_q - 11) + test.j + (int)strlen(test.structure) - l1 - 2,
+                                test.energy, max_pos - 10, max_pos_j - 10, ((double)max) / 100);
     free(s3);
     free(s4);
     free(test.structure);
@@ -4444,62 +4707,794 @@ plot_max(const int  max,
 }
 
 
+/**
+*** Select the SIMD kernels for the column fill according to the CPU features
+**/
 PRIVATE void
-update_dfold_params(void)
+simd_dispatch(void)
 {
-  vrna_md_t md;
+  if (!simd_dispatched) {
+#if VRNA_WITH_SIMD_SSE41
+    if (vrna_cpu_simd_capabilities() & VRNA_CPU_SIMD_SSE41) {
+      fill_min    = &vrna_plex_fill_min_sse41;
+      column_min  = &vrna_plex_column_min_sse41;
+    }
+
+#endif
+    simd_dispatched = 1;
+  }
+}
+
 
-  if (P)
-    free(P);
+/**
+*** Returns a new (empty) query profile for S2 if the column fill can be done by one
+*** of the SIMD kernels, NULL otherwise. Profiles are indexed by the encoding of the
+*** target nucleotides, so only the default alphabet (codes 0-4) is supported.
+**/
+PRIVATE struct plex_profile *
+simd_profile_init(struct vrna_plex_s *plex)
+{
+  vrna_md_t           *md = &(plex->P->model_details);
+  struct plex_profile *prof;
+
+  simd_dispatch();
+
+  /* kernels require at least 4 query positions per column */
+  if ((!fill_min) || (md->energy_set != 0) || (plex->n2 - 19 < 4))
+    return NULL;
+
+  prof        = (struct plex_profile *)vrna_alloc(sizeof(struct plex_profile));
+  prof->zero  = (int *)vrna_alloc(sizeof(int) * (plex->n2 + 5));
+
+  return prof;
+}
+
+
+PRIVATE void
+profile_free(struct plex_profile *prof)
+{
+  unsigned int  g, k, n_ctx;
+
+  if (prof) {
+    for (g = 0; g < PROFILE_GROUPS; g++) {
+      if (prof->rows[g]) {
+        n_ctx = (g < PROFILE_3) ? 25 : ((g == PROFILE_3) ? 125 : 625);
+        for (k = 0; k < n_ctx; k++)
+          free(prof->rows[g][k]);
+        free(prof->rows[g]);
+      }
+    }
+    free(prof->zero);
+    free(prof);
+  }
+}
+
+
+/**
+*** Returns the profile rows of a group for the target context at position i.
+*** The rows are stored consecutively, each of length n2, and are indexed by
+*** the query position j. Entries for j outside [10, n2 - 10] are not used.
+**/
+PRIVATE const int *
+profile_rows(struct vrna_plex_s   *plex,
+             struct plex_profile  *prof,
+             unsigned int         group,
+             int                  i)
+{
+  vrna_param_t  *P     = plex->P;
+  vrna_md_t     *md    = &(P->model_details);
+  int           *rtype = &(md->rtype[0]);
+
+  int           j, type, type2, *r;
+  unsigned int  ctx, n_ctx, n_rows;
+
+  switch (group) {
+    case PROFILE_IJ:
+      ctx     = plex->S1[i - 1] * 5 + plex->S1[i];
+      n_ctx   = 25;
+      n_rows  = 11;
+      break;
+    case PROFILE_EXIT:
+      ctx     = plex->S1[i] * 5 + plex->S1[i + 1];
+      n_ctx   = 25;
+      n_rows  = 1;
+      break;
+    case PROFILE_BULGE:
+      ctx     = plex->S1[i - 2] * 5 + plex->S1[i];
+      n_ctx   = 25;
+      n_rows  = 1;
+      break;
+    case PROFILE_3:
+      ctx     = (plex->S1[i - 2] * 5 + plex->S1[i - 1]) * 5 + plex->S1[i];
+      n_ctx   = 125;
+      n_rows  = 2;
+      break;
+    case PROFILE_4:
+      ctx     = ((plex->S1[i - 3] * 5 + plex->S1[i - 2]) * 5 + plex->S1[i - 1]) * 5 + plex->S1[i];
+      n_ctx   = 625;
+      n_rows  = 3;
+      break;
+    default:
+      ctx     = ((plex->S1[i - 4] * 5 + plex->S1[i - 3]) * 5 + plex->S1[i - 1]) * 5 + plex->S1[i];
+      n_ctx   = 625;
+      n_rows  = 1;
+      break;
+  }
+
+  if (!prof->rows[group])
+    prof->rows[group] = (int **)vrna_alloc(sizeof(int *) * n_ctx);
+
+  if (prof->rows[group][ctx])
+    return prof->rows[group][ctx];
+
+  r                       = (int *)vrna_alloc(sizeof(int) * n_rows * plex->n2);
+  prof->rows[group][ctx]  = r;
+
+  /* the same energy contributions as in the scalar recursions of Lduplexfold() */
+  for (j = 10; j <= plex->n2 - 10; j++) {
+    type = md->pair[plex->S1[i]][plex->S2[j]];
+
+    switch (group) {
+      case PROFILE_IJ:
+        r[P_TYPE * plex->n2 + j] = type;
+        r[P_INIT * plex->n2 + j] = type ? P->DuplexInit + vrna_E_ext_stem(type, plex->SS1[i - 1], plex->SS2[j + 1], P) : 0;
+        type2               = md->pair[plex->S1[i - 1]][plex->S2[j + 1]];
+        r[P_STACK * plex->n2 + j] = type2 ? P->stack[rtype[type]][type2] : INF;
+        type2                 = md->pair[plex->S1[i - 1]][plex->S2[j + 2]];
+        r[P_BULGE_Q * plex->n2 + j] = type2 ? P->bulge[1] + P->stack[rtype[type]][type2] : INF;
+        r[P_MMI * plex->n2 + j]     = P->mismatchI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]];
+        r[P_MM1NI * plex->n2 + j]   = P->mismatch1nI[rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]];
+        type2                     = md->pair[plex->S2[j + 1]][plex->S1[i - 1]];
+        r[P_MMI_OPEN * plex->n2 + j]    = P->mismatchI[type2][plex->SS2[j]][plex->SS1[i]];
+        r[P_MM1NI_OPEN * plex->n2 + j]  = P->mismatch1nI[type2][plex->SS2[j]][plex->SS1[i]];
+        type2                 = md->pair[plex->S2[j]][plex->S1[i - 1]];
+        r[P_AU_BX * plex->n2 + j]   = type2 > 2 ? P->TerminalAU : 0;
+        type2                 = md->pair[plex->S2[j + 1]][plex->S1[i]];
+        r[P_AU_BY * plex->n2 + j]   = type2 > 2 ? P->TerminalAU : 0;
+        r[P_AU * plex->n2 + j]      = type > 2 ? P->TerminalAU : 0;
+        break;
+
+      case PROFILE_EXIT:
+        r[j] = type ? vrna_E_ext_stem(rtype[type], plex->SS2[j - 1], plex->SS1[i + 1], P) : 0;
+        break;
+
+      case PROFILE_BULGE:
+        type2 = md->pair[plex->S1[i - 2]][plex->S2[j + 1]];
+        r[j]  = type2 ? P->bulge[1] + P->stack[type2][rtype[type]] : INF;
+        break;
+
+      case PROFILE_3:
+        type2               = md->pair[plex->S1[i - 2]][plex->S2[j + 2]];
+        r[P_INT11 * plex->n2 + j] = type2 ?
+                              P->int11[type2][rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]] :
+                              INF;
+        type2               = md->pair[plex->S1[i - 2]][plex->S2[j + 3]];
+        r[P_INT12 * plex->n2 + j] = type2 ?
+                              P->int21[type2][rtype[type]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] :
+                              INF;
+        break;
+
+      case PROFILE_4:
+        type2               = md->pair[plex->S1[i - 3]][plex->S2[j + 3]];
+        r[P_INT22 * plex->n2 + j] = type2 ?
+                              P->int22[type2][rtype[type]][plex->SS1[i - 2]][plex->SS1[i - 1]][plex->SS2[j + 1]][plex->SS2[j + 2]] :
+                              INF;
+        type2               = md->pair[plex->S1[i - 3]][plex->S2[j + 2]];
+        r[P_INT21 * plex->n2 + j] = type2 ?
+                              P->int21[rtype[type]][type2][plex->SS2[j + 1]][plex->SS1[i - 2]][plex->SS1[i - 1]] :
+                              INF;
+        type2                 = md->pair[plex->S1[i - 3]][plex->S2[j + 4]];
+        r[P_INT23_Q * plex->n2 + j] = type2 ?
+                                P->internal_loop[5] + P->ninio[2] +
+                                P->mismatch23I[type2][plex->SS1[i - 2]][plex->SS2[j + 3]] +
+                                P->mismatch23I[rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] :
+                                INF;
+        break;
+
+      default:
+        type2 = md->pair[plex->S1[i - 4]][plex->S2[j + 3]];
+        r[j]  = type2 ?
+                P->internal_loop[5] + P->ninio[2] +
+                P->mismatch23I[type2][plex->SS1[i - 3]][plex->SS2[j + 2]] +
+                P->mismatch23I[rtype[type]][plex->SS2[j + 1]][plex->SS1[i - 1]] :
+                INF;
+        break;
+    }
+  }
+
+  return r;
+}
+
+
+/**
+*** Fill column i of the single array SA as in the inner loop of Lduplexfold(_XS).
+*** All cells of a column only depend on previous columns, except for the extension
+*** of interior loops and query bulges along the query. These are resolved in a
+*** final sweep over the column. di[k] and dj[k] are the accessibility penalties
+*** for k unpaired nucleotides on target and query (0 and rows of zeros for
+*** Lduplexfold()), dj[0] must be a row of zeros.
+**/
+PRIVATE void
+fill_column_simd(struct vrna_plex_s       *plex,
+                 int                      *SA,
+                 struct plex_profile      *prof,
+                 int                      i,
+                 const int                *di,
+                 const int                **dj,
+                 const struct plex_costs  *e,
+                 int                      *min_colonne,
+                 int                      *min_j_colonne)
+{
+  int       j, k, idx, from, to, ec;
+  int       *lc[5], *lin[5], *lbx[5], *lby[5], *linx[5], *liny[5];
+  const int *zero, *r_ij, *r_exit, *r_bulge, *r_3, *r_4, *r_4x;
+
+  for (k = 0; k < 5; k++) {
+    idx     = (i - k) % 5;
+    lc[k]   = SA + LCI(idx, 0, plex->n2);
+    lin[k]  = SA + LINI(idx, 0, plex->n2);
+    lbx[k]  = SA + LBXI(idx, 0, plex->n2);
+    lby[k]  = SA + LBYI(idx, 0, plex->n2);
+    linx[k] = SA + LINIX(idx, 0, plex->n2);
+    liny[k] = SA + LINIY(idx, 0, plex->n2);
+  }
+
+  from    = 10;
+  to      = plex->n2 - 10;
+  ec      = e->ec;
+  zero    = prof->zero;
+  r_ij    = profile_rows(plex, prof, PROFILE_IJ, i);
+  r_exit  = profile_rows(plex, prof, PROFILE_EXIT, i);
+  r_bulge = profile_rows(plex, prof, PROFILE_BULGE, i);
+  r_3     = profile_rows(plex, prof, PROFILE_3, i);
+  r_4     = profile_rows(plex, prof, PROFILE_4, i);
+  r_4x    = profile_rows(plex, prof, PROFILE_4X, i);
+
+  /* start/extend interior loop, extension along the query follows below */
+  {
+    const int *src[] = {
+      lc[1] + 1, lin[1], lin[1] + 1
+    };
+    const int *pr[] = {
+      r_ij + P_MMI_OPEN * plex->n2, zero, zero
+    };
+    const int *djr[] = {
+      dj[1], zero, dj[1]
+    };
+    const int c[] = {
+      di[1] + e->iopen + e->iext_s, e->iext_ass + di[1], e->iext_s + di[1]
+    };
+    (*fill_min)(lin[0], src, pr, djr, c, 3, NULL, from, to);
+  }
+
+  /* start/extend nx1 target */
+  {
+    const int *src[] = {
+      lc[1] + 1, linx[1]
+    };
+    const int *pr[] = {
+      r_ij + P_MM1NI_OPEN * plex->n2, zero
+    };
+    const int *djr[] = {
+      dj[1], zero
+    };
+    const int c[] = {
+      di[1] + e->iopen + e->iext_s, e->iext_ass + di[1]
+    };
+    (*fill_min)(linx[0], src, pr, djr, c, 2, NULL, from, to);
+  }
+
+  /* start 1xn target, extension along the query follows below */
+  {
+    const int *src[] = {
+      lc[1] + 1
+    };
+    const int *pr[] = {
+      r_ij + P_MM1NI_OPEN * plex->n2
+    };
+    const int *djr[] = {
+      dj[1]
+    };
+    const int c[] = {
+      di[1] + e->iopen + e->iext_s
+    };
+    (*fill_min)(liny[0], src, pr, djr, c, 1, NULL, from, to);
+  }
+
+  /* start/extend bulge target */
+  {
+    const int *src[] = {
+      lbx[1], lc[1]
+    };
+    const int *pr[] = {
+      zero, r_ij + P_AU_BX * plex->n2
+    };
+    const int *djr[] = {
+      zero, zero
+    };
+    const int c[] = {
+      e->bext + di[1], e->bopen + e->bext + di[1]
+    };
+    (*fill_min)(lbx[0], src, pr, djr, c, 2, NULL, from, to);
+  }
+
+  /* duplex start, stack extensions, and closing of loops */
+  {
+    const int *src[] = {
+      zero,
+      lc[1] + 1, lc[1] + 2, lc[2] + 1,
+      lc[2] + 2, lc[3] + 3,
+      lc[3] + 2, lc[2] + 3,
+      lc[4] + 3, lc[3] + 4,
+      lin[3] + 3, lin[4] + 2, lin[2] + 4,
+      linx[3] + 1, liny[1] + 3,
+      lbx[2] + 1, lby[1] + 2
+    };
+    const int *pr[] = {
+      r_ij + P_INIT * plex->n2,
+      r_ij + P_STACK * plex->n2, r_ij + P_BULGE_Q * plex->n2, r_bulge,
+      r_3 + P_INT11 * plex->n2, r_4 + P_INT22 * plex->n2,
+      r_4 + P_INT21 * plex->n2, r_3 + P_INT12 * plex->n2,
+      r_4x, r_4 + P_INT23_Q * plex->n2,
+      r_ij + P_MMI * plex->n2, r_ij + P_MMI * plex->n2, r_ij + P_MMI * plex->n2,
+      r_ij + P_MM1NI * plex->n2, r_ij + P_MM1NI * plex->n2,
+      r_ij + P_AU * plex->n2, r_ij + P_AU * plex->n2
+    };
+    const int *djr[] = {
+      zero,
+      dj[1], dj[2], dj[1],
+      dj[2], dj[3],
+      dj[2], dj[3],
+      dj[3], dj[4],
+      dj[3], dj[2], dj[4],
+      dj[1], dj[3],
+      dj[1], dj[2]
+    };
+    const int c[] = {
+      4 * ec,
+      2 * ec + di[1], 3 * ec + di[1], 3 * ec + di[2],
+      4 * ec + di[2], 6 * ec + di[3],
+      5 * ec + di[3], 5 * ec + di[2],
+      7 * ec + di[4], 7 * ec + di[3],
+      2 * e->iext_s + 2 * ec + di[3],
+      e->iext_s + 2 * e->iext_ass + 2 * ec + di[4],
+      e->iext_s + 2 * e->iext_ass + 2 * ec + di[2],
+      2 * e->iext_ass + 2 * ec + di[3],
+      2 * e->iext_ass + 2 * ec + di[1],
+      e->bext + 2 * ec + di[2],
+      e->bext + 2 * ec + di[1]
+    };
+    (*fill_min)(lc[0], src, pr, djr, c, 17, r_ij + P_TYPE * plex->n2, from, to);
+  }
+
+  /* extensions along the query, and start/extend bulge query */
+  for (j = to; j >= from; j--) {
+    lin[0][j]   = MIN2(lin[0][j], lin[0][j + 1] + e->iext_ass + dj[1][j]);
+    liny[0][j]  = MIN2(liny[0][j], liny[0][j + 1] + e->iext_ass + dj[1][j]);
+    lby[0][j]   = MIN2(lby[0][j + 1] + e->bext + dj[1][j],
+                       lc[0][j + 1] + e->bopen + e->bext + r_ij[P_AU_BY * plex->n2 + j] + dj[1][j]);
+  }
+
+  *min_colonne = (*column_min)(lc[0],
+                               r_exit,
+                               2 * ec,
+                               r_ij + P_TYPE * plex->n2,
+                               from,
+                               to,
+                               min_j_colonne);
+}
+
+
+PRIVATE struct vrna_plex_s *
+plex_init(vrna_param_t  *params,
+          int           own_params)
+{
+  struct vrna_plex_s *plex;
+
+  plex              = (struct vrna_plex_s *)vrna_alloc(sizeof(struct vrna_plex_s));
+  plex->P           = params;
+  plex->own_params  = own_params;
+  plex->target      = NULL;
+  plex->out         = vrna_cstr(0, NULL);
+
+  return plex;
+}
+
+
+/**
+*** The energy parameters of the backward compatible interface follow the global
+*** model settings and are only updated upon a change of the temperature
+**/
+PRIVATE vrna_param_t *
+get_compat_params(void)
+{
+  vrna_md_t md;
 
   set_model_details(&md);
-  P = vrna_params(&md);
-  make_pair_matrix();
+  if ((!compat_params) || (fabs(compat_params->temperature - temperature) > 1e-6)) {
+    free(compat_params);
+    compat_params = vrna_params(&md);
+  }
+
+  return compat_params;
+}
+
+
+PRIVATE void
+encode_seqs(struct vrna_plex_s  *plex,
+            const char          *s1,
+            const char          *s2)
+{
+  vrna_md_t *md = &(plex->P->model_details);
+
+  /* SS1, SS2 differ from S1, S2 only for the special X K and I bases and energy_set!=0 */
+  plex->S1  = vrna_seq_encode_simple(s1, md);
+  plex->SS1 = vrna_seq_encode(s1, md);
+  plex->S2  = vrna_seq_encode_simple(s2, md);
+  plex->SS2 = vrna_seq_encode(s2, md);
+}
+
+
+/**
+*** Sequence encodings for plex_fold(_XS), the target may already be encoded
+**/
+PRIVATE void
+prepare_seqs(struct vrna_plex_s *plex,
+             const char         *s1,
+             const char         *s2)
+{
+  vrna_md_t *md = &(plex->P->model_details);
+
+  if (plex->target) {
+    plex->S1  = plex->target->S;
+    plex->SS1 = plex->target->SS;
+    plex->S2  = vrna_seq_encode_simple(s2, md);
+    plex->SS2 = vrna_seq_encode(s2, md);
+  } else {
+    encode_seqs(plex, s1, s2);
+  }
+}
+
+
+PRIVATE void
+release_seqs(struct vrna_plex_s *plex)
+{
+  if (!plex->target) {
+    free(plex->S1);
+    free(plex->SS1);
+  }
+
+  free(plex->S2);
+  free(plex->SS2);
+
+  plex->S1  = plex->SS1 = NULL;
+  plex->S2  = plex->SS2 = NULL;
+}
+
+
+PRIVATE struct plex_target *
+target_init(const char  *s1,
+            const int   **access_s1,
+            vrna_md_t   *md)
+{
+  struct plex_target *target;
+
+  target      = (struct plex_target *)vrna_alloc(sizeof(struct plex_target));
+  target->S   = vrna_seq_encode_simple(s1, md);
+  target->SS  = vrna_seq_encode(s1, md);
+  target->DI  = (access_s1) ? target_penalties(access_s1, (int)strlen(s1)) : NULL;
+
+  return target;
 }
 
 
 PRIVATE void
-encode_seqs(const char  *s1,
-            const char  *s2)
+target_free(struct plex_target *target)
+{
+  if (target) {
+    free(target->S);
+    free(target->SS);
+    penalties_free(target->DI);
+    free(target);
+  }
+}
+
+
+/**
+*** Accessibility penalties of the target for 1-4 unpaired nucleotides as used
+*** in the column fill of plex_fold_XS(), i.e. D[k - 1][i] for k unpaired
+*** nucleotides at position i
+**/
+PRIVATE int **
+target_penalties(const int  **access_s1,
+                 int        n1)
+{
+  int i, **D;
+
+  D     = (int **)vrna_alloc(4 * sizeof(int *));
+  D[0]  = (int *)vrna_alloc(n1 * sizeof(int));
+  D[1]  = (int *)vrna_alloc(n1 * sizeof(int));
+  D[2]  = (int *)vrna_alloc(n1 * sizeof(int));
+  D[3]  = (int *)vrna_alloc(n1 * sizeof(int));
+
+  for (i = 10; i < n1 - 9; i++) {
+    D[0][i] = 0.5 *
+              (access_s1[5][i + 4] - access_s1[4][i + 4] + access_s1[5][i] - access_s1[4][i - 1]);
+    D[1][i] = 0.5 *
+              (access_s1[5][i + 3] - access_s1[4][i + 3] + access_s1[5][i - 1] - access_s1[4][i - 2]) +
+              D[0][i];
+    D[2][i] = 0.5 *
+              (access_s1[5][i + 2] - access_s1[4][i + 2] + access_s1[5][i - 2] - access_s1[4][i - 3]) +
+              D[1][i];
+    D[3][i] = 0.5 *
+              (access_s1[5][i + 1] - access_s1[4][i + 1] + access_s1[5][i - 3] - access_s1[4][i - 4]) +
+              D[2][i];
+  }
+
+  return D;
+}
+
+
+PRIVATE void
+penalties_free(int **D)
+{
+  int k;
+
+  if (D) {
+    for (k = 0; k <= 3; k++)
+      free(D[k]);
+    free(D);
+  }
+}
+
+
+PUBLIC struct vrna_plex_s *
+vrna_plex_init(vrna_md_t *md_p)
+{
+  vrna_md_t md;
+
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  return plex_init(vrna_params(&md), 1);
+}
+
+
+PUBLIC void
+vrna_plex_free(struct vrna_plex_s *plex)
+{
+  if (plex) {
+    if (plex->own_params)
+      free(plex->P);
+
+    vrna_cstr_discard(plex->out);
+    vrna_cstr_free(plex->out);
+    free(plex);
+  }
+}
+
+
+PUBLIC char *
+vrna_plex_scan(struct vrna_plex_s     *plex,
+               const char             *s1,
+               const char             *s2,
+               const int              **access_s1,
+               const int              **access_s2,
+               const vrna_plex_opt_t  *opt)
+{
+  char *output;
+
+  if ((!plex) || (!s1) || (!s2) || (!opt) || ((access_s1) && (!access_s2)))
+    return NULL;
+
+  if (access_s1) {
+    plex_fold_XS(plex,
+                 s1,
+                 s2,
+                 access_s1,
+                 access_s2,
+                 opt->threshold,
+                 opt->alignment_length,
+                 opt->delta,
+                 opt->fast,
+                 opt->il_a,
+                 opt->il_b,
+                 opt->b_a,
+                 opt->b_b);
+  } else {
+    plex_fold(plex,
+              s1,
+              s2,
+              opt->threshold,
+              opt->extension_cost,
+              opt->alignment_length,
+              opt->delta,
+              opt->fast,
+              opt->il_a,
+              opt->il_b,
+              opt->b_a,
+              opt->b_b);
+  }
+
+  output = strdup(vrna_cstr_string(plex->out));
+  vrna_cstr_discard(plex->out);
+
+  return output;
+}
+
+
+PUBLIC char **
+vrna_plex_batch(const char            *target,
+                const int             **access_target,
+                const char            **queries,
+                const int             ***access_queries,
+                vrna_md_t             *md_p,
+                const vrna_plex_opt_t *opt,
+                int                   jobs)
 {
-  unsigned int i, l;
+  long                num_queries, q;
+  char                **results;
+  vrna_md_t           md;
+  vrna_param_t        *params;
+  struct plex_target  *enc_target;
+
+  if ((!target) || (!queries) || (!opt) || ((access_target) && (!access_queries)))
+    return NULL;
+
+  for (num_queries = 0; queries[num_queries]; num_queries++);
+
+  results = (char **)vrna_alloc(sizeof(char *) * (num_queries + 1));
+
+  if (num_queries == 0)
+    return results;
+
+  if (md_p)
+    md = *md_p;
+  else
+    vrna_md_set_default(&md);
+
+  /* energy parameters, target encoding and accessibility penalties are shared among all threads */
+  params      = vrna_params(&md);
+  enc_target  = target_init(target, access_target, &(params->model_details));
 
-  l   = strlen(s1);
-  S1  = encode_seq(s1);
-  SS1 = (short *)vrna_alloc(sizeof(short) * (l + 1));
-  /* SS1 exists only for the special X K and I bases and energy_set!=0 */
+  simd_dispatch();
 
-  for (i = 1; i <= l; i++)  /* make numerical encoding of sequence */
-    SS1[i] = alias[S1[i]];  /* for mismatches of nostandard bases */
+#ifdef _OPENMP
+  if (jobs <= 0)
+    jobs = omp_get_max_threads();
+
+#pragma omp parallel num_threads(jobs)
+#else
+  (void)jobs;
+#endif
+  {
+    struct vrna_plex_s *plex;
+
+    /* each thread scans the target with its own context */
+    plex          = plex_init(params, 0);
+    plex->target  = enc_target;
+
+#ifdef _OPENMP
+#pragma omp for schedule(dynamic, 1)
+#endif
+    for (q = 0; q < num_queries; q++)
+      results[q] = vrna_plex_scan(plex,
+                                  target,
+                                  queries[q],
+                                  access_target,
+                                  (access_target) ? access_queries[q] : NULL,
+                                  opt);
+
+    vrna_plex_free(plex);
+  }
 
-  l   = strlen(s2);
-  S2  = encode_seq(s2);
-  SS2 = (short *)vrna_alloc(sizeof(short) * (l + 1));
-  /* SS2 exists only for the special X K and I bases and energy_set!=0 */
+  target_free(enc_target);
+  free(params);
 
-  for (i = 1; i <= l; i++)  /* make numerical encoding of sequence */
-    SS2[i] = alias[S2[i]];  /* for mismatches of nostandard bases */
+  return results;
 }
 
 
-PRIVATE short *
-encode_seq(const char *sequence)
+PUBLIC void
+vrna_plex_dispatch_disable(void)
+{
+  simd_dispatched = 1;
+  fill_min        = NULL;
+  column_min      = NULL;
+}
+
+
+PUBLIC void
+vrna_plex_dispatch_enable(void)
+{
+  simd_dispatched = 0;
+  fill_min        = NULL;
+  column_min      = NULL;
+}
+
+
+/*
+ #################################
+ # DEPRECATED FUNCTIONS BELOW    #
+ #################################
+ */
+PUBLIC duplexT **
+Lduplexfold(const char  *s1,
+            const char  *s2,
+            const int   threshold,
+            const int   extension_cost,
+            const int   alignment_length,
+            const int   delta,
+            const int   fast,
+            const int   il_a,
+            const int   il_b,
+            const int   b_a,
+            const int   b_b)
 {
-  unsigned int  i, l;
-  short         *S;
+  struct vrna_plex_s *plex;
+
+  plex = plex_init(get_compat_params(), 0);
+
+  plex_fold(plex,
+            s1,
+            s2,
+            threshold,
+            extension_cost,
+            alignment_length,
+            delta,
+            fast,
+            il_a,
+            il_b,
+            b_a,
+            b_b);
+
+  /* all duplexes go to stdout */
+  vrna_cstr_fflush(plex->out);
+  vrna_plex_free(plex);
 
-  l     = strlen(sequence);
-  S     = (short *)vrna_alloc(sizeof(short) * (l + 2));
-  S[0]  = (short)l;
+  return NULL;
+}
 
-  /* make numerical encoding of sequence */
-  for (i = 1; i <= l; i++)
-    S[i] = (short)encode_char(toupper(sequence[i - 1]));
 
-  /* for circular folding add first base at position n+1 */
-  S[l + 1] = S[1];
+PUBLIC duplexT **
+Lduplexfold_XS(const char *s1,
+               const char *s2,
+               const int  **access_s1,
+               const int  **access_s2,
+               const int  threshold,
+               const int  alignment_length,
+               const int  delta,
+               const int  fast,
+               const int  il_a,
+               const int  il_b,
+               const int  b_a,
+               const int  b_b)
+{
+  struct vrna_plex_s *plex;
+
+  plex = plex_init(get_compat_params(), 0);
+
+  plex_fold_XS(plex,
+               s1,
+               s2,
+               access_s1,
+               access_s2,
+               threshold,
+               alignment_length,
+               delta,
+               fast,
+               il_a,
+               il_b,
+               b_a,
+               b_b);
+
+  /* all duplexes go to stdout */
+  vrna_cstr_fflush(plex->out);
+  vrna_plex_free(plex);
 
-  return S;
+  return NULL;
 }
 
 
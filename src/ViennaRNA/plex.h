@@ -2,6 +2,153 @@
 #define VIENNA_RNA_PACKAGE_PLEX_H
 
 #include <ViennaRNA/datastructures/basic.h>
+#include <ViennaRNA/model.h>
+
+/**
+ *  @file     plex.h
+ *  @ingroup  cofold
+ *  @brief    Functions to scan long target RNAs for duplexes with short query RNAs
+ */
+
+/**
+ *  @addtogroup cofold
+ *  @{
+ */
+
+/**
+ *  @brief  A reentrant context for the duplex scans of RNAplex
+ *
+ *  The context holds the energy parameters, the dynamic programming matrices
+ *  and the output buffer of a duplex scan. It may be re-used for subsequent
+ *  scans. Different threads must use different contexts.
+ *
+ *  @see  vrna_plex_init(), vrna_plex_free(), vrna_plex_scan()
+ */
+typedef struct vrna_plex_s *vrna_plex_t;
+
+
+/**
+ *  @brief  Settings of a duplex scan
+ *
+ *  The fields correspond to the arguments of Lduplexfold() and Lduplexfold_XS().
+ *  All energies are given in dacal/mol.
+ */
+typedef struct {
+  int threshold;        /**<  @brief  Energy threshold for a duplex to be reported */
+  int alignment_length; /**<  @brief  Maximal length of a duplex on the target */
+  int delta;            /**<  @brief  Distance between the target 3' ends of two consecutive duplexes */
+  int extension_cost;   /**<  @brief  Cost per base pair, only used without accessibilities */
+  int fast;             /**<  @brief  Report the duplex energies of the affine loop model only */
+  int il_a;             /**<  @brief  Slope of the affine interior loop energies */
+  int il_b;             /**<  @brief  Offset of the affine interior loop energies */
+  int b_a;              /**<  @brief  Slope of the affine bulge loop energies */
+  int b_b;              /**<  @brief  Offset of the affine bulge loop energies */
+} vrna_plex_opt_t;
+
+
+/**
+ *  @brief  Create a new context for duplex scans
+ *
+ *  @see    vrna_plex_free(), vrna_plex_scan()
+ *
+ *  @param  md_p  The model details to use (Maybe NULL)
+ *  @return       A new duplex scan context
+ */
+vrna_plex_t
+vrna_plex_init(vrna_md_t *md_p);
+
+
+/**
+ *  @brief  Free a duplex scan context
+ *
+ *  @see    vrna_plex_init()
+ *
+ *  @param  plex  The duplex scan context
+ */
+void
+vrna_plex_free(vrna_plex_t plex);
+
+
+/**
+ *  @brief  Scan a target RNA for duplexes with a query RNA
+ *
+ *  Both sequences must be padded with 10 'N' on each side, as done by RNAplex.
+ *  If @p access_s1 is NULL, the scan corresponds to Lduplexfold(). Otherwise,
+ *  the opening energies @p access_s1 and @p access_s2 are taken into account
+ *  as in Lduplexfold_XS().
+ *
+ *  @see    vrna_plex_init(), vrna_plex_batch(), Lduplexfold(), Lduplexfold_XS()
+ *
+ *  @param  plex      The duplex scan context
+ *  @param  s1        The target sequence
+ *  @param  s2        The query sequence
+ *  @param  access_s1 The opening energies of the target (Maybe NULL)
+ *  @param  access_s2 The opening energies of the query
+ *  @param  opt       The settings of the scan
+ *  @return           The duplexes found, in the output format of Lduplexfold() and Lduplexfold_XS()
+ */
+char *
+vrna_plex_scan(vrna_plex_t            plex,
+               const char             *s1,
+               const char             *s2,
+               const int              **access_s1,
+               const int              **access_s2,
+               const vrna_plex_opt_t  *opt);
+
+
+/**
+ *  @brief  Scan a target RNA for duplexes with each of a list of query RNAs
+ *
+ *  The target is encoded, and its accessibility penalties are computed, only
+ *  once for all queries. Each thread re-uses its own context for all of its
+ *  queries. The output for query @f$ q @f$ is found at position @f$ q @f$ of
+ *  the returned list, which is terminated by NULL.
+ *
+ *  @note   Queries are distributed among @p jobs threads if the library has been
+ *          compiled with OpenMP support.
+ *
+ *  @see    vrna_plex_scan()
+ *
+ *  @param  target          The target sequence
+ *  @param  access_target   The opening energies of the target (Maybe NULL)
+ *  @param  queries         A NULL-terminated list of query sequences
+ *  @param  access_queries  The opening energies of the queries, ignored if @p access_target is NULL
+ *  @param  md_p            The model details to use (Maybe NULL)
+ *  @param  opt             The settings of the scans
+ *  @param  jobs            The number of threads (<= 0 to use the OpenMP default)
+ *  @return                 The output of vrna_plex_scan() for each query, or NULL if @p queries is NULL
+ */
+char **
+vrna_plex_batch(const char             *target,
+                const int              **access_target,
+                const char             **queries,
+                const int              ***access_queries,
+                vrna_md_t              *md_p,
+                const vrna_plex_opt_t  *opt,
+                int                    jobs);
+
+
+/**
+ *  @brief  Use the scalar column fill in duplex scans regardless of the SIMD features of the CPU
+ *
+ *  @see    vrna_plex_dispatch_enable()
+ */
+void
+vrna_plex_dispatch_disable(void);
+
+
+/**
+ *  @brief  Select the column fill of duplex scans according to the SIMD features of the CPU (default)
+ *
+ *  @see    vrna_plex_dispatch_disable()
+ */
+void
+vrna_plex_dispatch_enable(void);
+
+
+/**
+ *  @}
+ */
 
 #ifndef VRNA_DISABLE_BACKWARD_COMPATIBILITY
 
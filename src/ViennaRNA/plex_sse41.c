@@ -0,0 +1,135 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "ViennaRNA/utils/basic.h"
+
+#include <emmintrin.h>
+#include <smmintrin.h>
+
+/*
+ *  SSE 4.1 kernels for the column-wise fill of the Lduplexfold() and
+ *  Lduplexfold_XS() recursions. All energies are kept in 32-bit lanes
+ *  to yield exactly the same (INF-) arithmetic as the scalar code.
+ *
+ *  16-bit saturating lanes do not pay off here: the DP arrays, profiles,
+ *  and accessibility rows are int arrays, so every term needs two loads
+ *  and a pack, and INF terms require masking plus a 32-bit fallback for
+ *  lanes that saturate.
+ */
+
+static int
+horizontal_min_Vec4i(__m128i x);
+
+
+/*
+ *  dst[j] = min_k (src[k][j] + prof[k][j] + dj[k][j] + c[k]) for all
+ *  from <= j <= to. If type is given, dst[j] is set to INF wherever
+ *  type[j] is 0. Requires to - from >= 3, the last vector is shifted
+ *  back to end at 'to' such that no memory past 'to' is written
+ */
+PUBLIC void
+vrna_plex_fill_min_sse41(int                *dst,
+                         const int          **src,
+                         const int          **prof,
+                         const int          **dj,
+                         const int          *c,
+                         unsigned int       n,
+                         const int          *type,
+                         int                from,
+                         int                to)
+{
+  int           j, jj;
+  unsigned int  k;
+  __m128i       inf   = _mm_set1_epi32(INF);
+  __m128i       zero  = _mm_setzero_si128();
+
+  for (j = from; j <= to; j += 4) {
+    jj = (j + 3 > to) ? to - 3 : j;
+
+    __m128i res = _mm_add_epi32(_mm_loadu_si128((__m128i *)(src[0] + jj)),
+                                _mm_loadu_si128((__m128i *)(prof[0] + jj)));
+    res = _mm_add_epi32(res, _mm_loadu_si128((__m128i *)(dj[0] + jj)));
+    res = _mm_add_epi32(res, _mm_set1_epi32(c[0]));
+
+    for (k = 1; k < n; k++) {
+      __m128i v = _mm_add_epi32(_mm_loadu_si128((__m128i *)(src[k] + jj)),
+                                _mm_loadu_si128((__m128i *)(prof[k] + jj)));
+      v   = _mm_add_epi32(v, _mm_loadu_si128((__m128i *)(dj[k] + jj)));
+      v   = _mm_add_epi32(v, _mm_set1_epi32(c[k]));
+      res = _mm_min_epi32(res, v);
+    }
+
+    if (type) {
+      /* no pair (i,j) possible -> INF */
+      __m128i mask = _mm_cmpeq_epi32(_mm_loadu_si128((__m128i *)(type + jj)), zero);
+      res = _mm_blendv_epi8(res, inf, mask);
+    }
+
+    _mm_storeu_si128((__m128i *)(dst + jj), res);
+  }
+}
+
+
+/*
+ *  Minimum of lc[j] + e[j] + c over all from <= j <= to where type[j] != 0.
+ *  If the minimum is finite, *pos is set to the largest j that attains it
+ */
+PUBLIC int
+vrna_plex_column_min_sse41(const int  *lc,
+                           const int  *e,
+                           int        c,
+                           const int  *type,
+                           int        from,
+                           int        to,
+                           int        *pos)
+{
+  int     j, jj, m;
+  __m128i inf   = _mm_set1_epi32(INF);
+  __m128i zero  = _mm_setzero_si128();
+  __m128i cc    = _mm_set1_epi32(c);
+  __m128i vmin  = inf;
+
+  for (j = from; j <= to; j += 4) {
+    jj = (j + 3 > to) ? to - 3 : j;
+
+    __m128i v = _mm_add_epi32(_mm_loadu_si128((__m128i *)(lc + jj)),
+                              _mm_loadu_si128((__m128i *)(e + jj)));
+    v = _mm_add_epi32(v, cc);
+
+    __m128i mask = _mm_cmpeq_epi32(_mm_loadu_si128((__m128i *)(type + jj)), zero);
+    v     = _mm_blendv_epi8(v, inf, mask);
+    vmin  = _mm_min_epi32(vmin, v);
+  }
+
+  m = horizontal_min_Vec4i(vmin);
+
+  if (m < INF) {
+    for (j = to; j >= from; j--)
+      if ((type[j]) && (lc[j] + e[j] + c == m)) {
+        *pos = j;
+        break;
+      }
+  }
+
+  return m;
+}
+
+
+/*
+ *  SSE minimum
+ *  see also: http://stackoverflow.com/questions/9877700/getting-max-value-in-a-m128i-vector-with-sse
+ */
+static int
+horizontal_min_Vec4i(__m128i x)
+{
+  __m128i min1  = _mm_shuffle_epi32(x, _MM_SHUFFLE(0, 0, 3, 2));
+  __m128i min2  = _mm_min_epi32(x, min1);
+  __m128i min3  = _mm_shuffle_epi32(min2, _MM_SHUFFLE(0, 0, 0, 1));
+  __m128i min4  = _mm_min_epi32(min2, min3);
+
+  return _mm_cvtsi128_si32(min4);
+}
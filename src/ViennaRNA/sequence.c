@@ -99,6 +99,7 @@ vrna_sequences_add(vrna_fold_compound_t *fc,
 
     /* adjust strands counter */
     fc->strands += s_new;
+    fc->mem_generation++;
 
     /* adjust total length of concatenated sequences */
     fc->length += n_new;
@@ -188,6 +189,7 @@ vrna_sequence_add(vrna_fold_compound_t  *vc,
 
     /* increase strands counter */
     vc->strands++;
+    vc->mem_generation++;
 
     /* add new sequence to initial order of all strands */
     vc->sequence = (char *)vrna_realloc(vc->sequence,
@@ -387,6 +389,7 @@ vrna_msa_add(vrna_fold_compound_t     *fc,
 
     /* increase strands counter */
     fc->strands++;
+    fc->mem_generation++;
   }
 
   return ret;
@@ -466,6 +469,8 @@ vrna_sequence_remove_all(vrna_fold_compound_t *fc)
     fc->strand_order_uniq = NULL;
     fc->strand_start      = NULL;
     fc->strand_end        = NULL;
+
+    fc->mem_generation++;
   }
 }
 
@@ -486,6 +491,7 @@ vrna_sequence_prepare(vrna_fold_compound_t *fc)
     fc->strand_order_uniq = NULL;
     fc->strand_start      = NULL;
     fc->strand_end        = NULL;
+    fc->mem_generation++;
 
     fc->strand_number = (unsigned int *)vrna_alloc(sizeof(unsigned int) * (fc->length + 2));
 
@@ -146,6 +146,149 @@ vrna_pscore_freq(vrna_fold_compound_t *fc,
                  const unsigned int   *frequencies,
                  unsigned int         pairs);
 
+
+/**
+ *  @brief  Column-wise bit set representation of an alignment
+ *
+ *  For each column, the alignment is stored as one bit set per numerical nucleotide
+ *  encoding (including gaps), with one bit per sequence. Pair type frequencies
+ *  of a column pair then boil down to bitwise AND and population counts over
+ *  64 sequences at a time.
+ *
+ *  @see vrna_aln_bits(), vrna_aln_bits_pfreq(), vrna_aln_bits_free()
+ */
+typedef struct vrna_aln_bits_s vrna_aln_bits_t;
+
+
+/**
+ *  @brief  Create the column-wise bit set representation of an alignment
+ *
+ *  @note   Numerical encodings of @f$ 255 @f$ and above are not supported by the bit set
+ *          representation, and this function returns NULL in that case. Use vrna_aln_pfreq()
+ *          to count the pair types of such alignments instead.
+ *
+ *  @see vrna_aln_pfreq()
+ *
+ *  @param  S         The numerically encoded (1-based) sequences of the alignment
+ *  @param  AS        The aligned sequences (used to detect '~' characters, may be NULL)
+ *  @param  n_seq     The number of sequences in the alignment
+ *  @param  length    The length of the alignment
+ *  @return           The bit set representation, or NULL on any error
+ */
+vrna_aln_bits_t *
+vrna_aln_bits(const short   **S,
+              const char    **AS,
+              unsigned int  n_seq,
+              unsigned int  length);
+
+
+/**
+ *  @brief  Create the column-wise bit set representation of a weighted alignment
+ *
+ *  Same as vrna_aln_bits(), but each sequence @f$ s @f$ is counted @p weights[s] times
+ *  by vrna_aln_bits_pfreq(). This allows for passing only the distinct sequences of an
+ *  alignment together with their multiplicities, see vrna_aln_unique().
+ *
+ *  @see vrna_aln_bits(), vrna_aln_unique()
+ *
+ *  @param  S         The numerically encoded (1-based) sequences of the alignment
+ *  @param  AS        The aligned sequences (used to detect '~' characters, may be NULL)
+ *  @param  n_seq     The number of sequences in the alignment
+ *  @param  length    The length of the alignment
+ *  @param  weights   The weight of each sequence (may be NULL for all weights equal to 1)
+ *  @return           The bit set representation, or NULL on any error
+ */
+vrna_aln_bits_t *
+vrna_aln_bits_weighted(const short        **S,
+                       const char         **AS,
+                       unsigned int       n_seq,
+                       unsigned int       length,
+                       const unsigned int *weights);
+
+
+/**
+ *  @brief  Free the memory occupied by a column-wise bit set representation
+ *
+ *  @param  bits  The bit set representation of an alignment
+ */
+void
+vrna_aln_bits_free(vrna_aln_bits_t *bits);
+
+
+/**
+ *  @brief  Count the pair types of all sequences for a column pair
+ *
+ *  On return, @p pfreq[t] holds the number (or total weight) of sequences that form a pair of type
+ *  @f$ t @f$ according to @p md between the columns @p i and @p j. As for vrna_pscore_freq(),
+ *  @p pfreq[0] counts sequences that can not form a pair, and @p pfreq[7] those with a
+ *  gap in both columns (or a '~' character in any of them).
+ *
+ *  @param  bits  The bit set representation of an alignment
+ *  @param  md    The model details providing the pair type matrix
+ *  @param  i     The first column (1-based)
+ *  @param  j     The second column (1-based)
+ *  @param  pfreq An array of at least 8 counters
+ */
+void
+vrna_aln_bits_pfreq(const vrna_aln_bits_t *bits,
+                    const vrna_md_t       *md,
+                    unsigned int          i,
+                    unsigned int          j,
+                    unsigned int          *pfreq);
+
+
+/**
+ *  @brief  Count the pair types of all sequences for a column pair without bit sets
+ *
+ *  This is the sequence-by-sequence counterpart of vrna_aln_bits_pfreq() with the same
+ *  meaning of the entries of @p pfreq. It is used whenever the bit set representation of an
+ *  alignment can not be created, e.g. for numerical encodings that exceed its range. Encodings
+ *  outside the pair type matrix of @p md are counted as unable to pair.
+ *
+ *  @see vrna_aln_bits_pfreq(), vrna_aln_bits()
+ *
+ *  @param  S     The numerically encoded (1-based) sequences of the alignment
+ *  @param  AS    The aligned sequences (used to detect '~' characters, may be NULL)
+ *  @param  n_seq The number of sequences in the alignment
+ *  @param  md    The model details providing the pair type matrix
+ *  @param  i     The first column (1-based)
+ *  @param  j     The second column (1-based)
+ *  @param  pfreq An array of at least 8 counters
+ */
+void
+vrna_aln_pfreq(const short      **S,
+               const char       **AS,
+               unsigned int     n_seq,
+               const vrna_md_t  *md,
+               unsigned int     i,
+               unsigned int     j,
+               unsigned int     *pfreq);
+
+
+/**
+ *  @brief  Determine the distinct rows of an alignment
+ *
+ *  Identical aligned sequences contribute identical energies to any comparative
+ *  loop evaluation. This function collapses such rows into a single representative
+ *  with a multiplicity weight. On return, @p representatives[u] holds the (0-based)
+ *  index of the first occurrence of the @f$ u @f$-th distinct row, and @p weights[u]
+ *  the number of rows identical to it. Representatives are listed in order of their
+ *  first occurrence.
+ *
+ *  @note   The user is responsible to free the memory occupied by @p representatives
+ *          and @p weights
+ *
+ *  @param  alignment         The input sequence alignment (last entry must be @em NULL terminated)
+ *  @param  representatives   A pointer to store the array of representative row indices at (may be NULL)
+ *  @param  weights           A pointer to store the array of row multiplicities at (may be NULL)
+ *  @return                   The number of distinct rows in the alignment
+ */
+unsigned int
+vrna_aln_unique(const char    **alignment,
+                unsigned int  **representatives,
+                unsigned int  **weights);
+
+
 /**
  *  @brief  Slice out a subalignment from a larger alignment
  *
@@ -15,6 +15,8 @@
 #include <string.h>
 #include <ctype.h>
 #include <math.h>
+#include <stdint.h>
+#include <limits.h>
 
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/utils/strings.h"
@@ -26,6 +28,12 @@
 #include "ViennaRNA/io/utils.h"
 #include "ViennaRNA/utils/alignments.h"
 
+#ifdef __GNUC__
+# define INLINE inline
+#else
+# define INLINE
+#endif
+
 #define NONE -10000 /* score for forbidden pairs */
 /*
  #################################
@@ -45,6 +53,26 @@
  */
 static char IUP[17] = "-ACMGRSVUWYHKDBN";
 
+/*
+ * Column-wise bit sets of an alignment, one bit per sequence. For column i,
+ * bits for numerical encoding c start at bits[(i * codes + c) * words], the
+ * '~' characters are marked in tilde[i * words], and present[i * (codes + 1)]
+ * holds the 0-terminated list of non-gap encodings found in this column.
+ * For weighted sequences, bit p of each weight is stored in the bit plane
+ * weights[p * words], and n_seq is the sum of all weights
+ */
+struct vrna_aln_bits_s {
+  unsigned int  length;
+  unsigned int  n_seq;
+  unsigned int  words;
+  unsigned int  codes;
+  unsigned int  planes;
+  uint64_t      *bits;
+  uint64_t      *tilde;
+  uint64_t      *weights;
+  unsigned char *present;
+};
+
 /*
  #################################
  # PRIVATE FUNCTION DECLARATIONS #
@@ -55,6 +83,16 @@ copy_alignment(const char   **alignment,
                unsigned int options);
 
 
+PRIVATE INLINE unsigned int
+popcount64(uint64_t x);
+
+
+PRIVATE INLINE unsigned int
+count_word(const vrna_aln_bits_t  *b,
+           size_t                 w,
+           uint64_t               x);
+
+
 /*
  #################################
  # BEGIN OF FUNCTION DEFINITIONS #
@@ -193,7 +231,7 @@ vrna_pscore(vrna_fold_compound_t  *fc,
 {
   char          **AS;
   short         **S;
-  unsigned int  n, tmp, u, s, n_seq;
+  unsigned int  n, tmp, u, r, s, n_seq;
   int           max_span;
   vrna_md_t     *md;
 
@@ -207,7 +245,7 @@ vrna_pscore(vrna_fold_compound_t  *fc,
       (fc->type == VRNA_FC_TYPE_COMPARATIVE) &&
       (fc->length >= j)) {
     n         = fc->length;
-    n_seq     = fc->n_seq;
+    n_seq     = fc->n_seq_unique;
     u         = j - i - 1;
     md        = &(fc->params->model_details);
     max_span  = md->max_bp_span;
@@ -223,10 +261,12 @@ vrna_pscore(vrna_fold_compound_t  *fc,
         0, 0, 0, 0, 0, 0, 0, 0
       };
 
-      /* collect base pair frequencies */
-      for (s = 0; s < n_seq; s++) {
+      /* collect base pair frequencies, identical sequences only once */
+      for (r = 0; r < n_seq; r++) {
         unsigned int type;
 
+        s = (fc->seq_reps) ? fc->seq_reps[r] : r;
+
         if (S[s][i] == 0 && S[s][j] == 0) {
           type = 7;                             /* gap-gap  */
         } else {
@@ -236,7 +276,7 @@ vrna_pscore(vrna_fold_compound_t  *fc,
             type = md->pair[S[s][i]][S[s][j]];
         }
 
-        pfreq[type]++;
+        pfreq[type] += (fc->seq_weights) ? fc->seq_weights[r] : 1;
       }
 
       return vrna_pscore_freq(fc, (const unsigned int *)pfreq, 6);
@@ -286,6 +326,219 @@ vrna_pscore_freq(vrna_fold_compound_t *fc,
 }
 
 
+PUBLIC vrna_aln_bits_t *
+vrna_aln_bits(const short   **S,
+              const char    **AS,
+              unsigned int  n_seq,
+              unsigned int  length)
+{
+  return vrna_aln_bits_weighted(S, AS, n_seq, length, NULL);
+}
+
+
+PUBLIC vrna_aln_bits_t *
+vrna_aln_bits_weighted(const short        **S,
+                       const char         **AS,
+                       unsigned int       n_seq,
+                       unsigned int       length,
+                       const unsigned int *weights)
+{
+  unsigned int    i, s, c, p, words, codes, cnt, planes, total;
+  vrna_aln_bits_t *b;
+
+  if ((!S) ||
+      (n_seq == 0) ||
+      (length == 0))
+    return NULL;
+
+  /* find the largest numerical encoding in use */
+  codes = 1;
+  for (s = 0; s < n_seq; s++)
+    for (i = 1; i <= length; i++)
+      if ((S[s][i] >= 0) &&
+          ((unsigned int)S[s][i] >= codes))
+        codes = (unsigned int)S[s][i] + 1;
+
+  if (codes > UCHAR_MAX)
+    return NULL;
+
+  words   = (n_seq + 63) / 64;
+  planes  = 0;
+  total   = n_seq;
+
+  if (weights) {
+    for (total = 0, s = 0; s < n_seq; s++) {
+      total += weights[s];
+      while ((planes < 32) &&
+             ((weights[s] >> planes) != 0))
+        planes++;
+    }
+  }
+
+  b           = (vrna_aln_bits_t *)vrna_alloc(sizeof(vrna_aln_bits_t));
+  b->length   = length;
+  b->n_seq    = total;
+  b->words    = words;
+  b->codes    = codes;
+  b->planes   = planes;
+  b->bits     = (uint64_t *)vrna_alloc(sizeof(uint64_t) * (length + 1) * codes * words);
+  b->tilde    = (uint64_t *)vrna_alloc(sizeof(uint64_t) * (length + 1) * words);
+  b->weights  = (planes) ? (uint64_t *)vrna_alloc(sizeof(uint64_t) * planes * words) : NULL;
+  b->present  = (unsigned char *)vrna_alloc(sizeof(unsigned char) * (length + 1) * (codes + 1));
+
+  for (s = 0; s < n_seq; s++) {
+    uint64_t  mask  = (uint64_t)1 << (s % 64);
+    size_t    w     = s / 64;
+
+    for (p = 0; p < planes; p++)
+      if (weights[s] & (1U << p))
+        b->weights[(size_t)p * words + w] |= mask;
+
+    for (i = 1; i <= length; i++) {
+      c = (S[s][i] > 0) ? (unsigned int)S[s][i] : 0;
+
+      b->bits[((size_t)i * codes + c) * words + w] |= mask;
+
+      /* keep the same column indexing as the scalar pair type collection */
+      if ((AS) &&
+          (AS[s][i] == '~'))
+        b->tilde[(size_t)i * words + w] |= mask;
+    }
+  }
+
+  for (i = 1; i <= length; i++) {
+    cnt = 0;
+    for (c = 1; c < codes; c++) {
+      uint64_t  *bc = b->bits + ((size_t)i * codes + c) * words;
+      size_t    w;
+
+      for (w = 0; w < words; w++)
+        if (bc[w]) {
+          b->present[(size_t)i * (codes + 1) + cnt++] = (unsigned char)c;
+          break;
+        }
+    }
+  }
+
+  return b;
+}
+
+
+PUBLIC void
+vrna_aln_bits_free(vrna_aln_bits_t *bits)
+{
+  if (bits) {
+    free(bits->bits);
+    free(bits->tilde);
+    free(bits->weights);
+    free(bits->present);
+    free(bits);
+  }
+}
+
+
+PUBLIC void
+vrna_aln_bits_pfreq(const vrna_aln_bits_t *bits,
+                    const vrna_md_t       *md,
+                    unsigned int          i,
+                    unsigned int          j,
+                    unsigned int          *pfreq)
+{
+  unsigned int    k, t, words, codes, sum, cnt;
+  size_t          w;
+  const uint64_t  *gi, *gj, *ti, *tj, *bi, *bj;
+  const unsigned char *pi, *pj;
+
+  for (k = 0; k < 8; k++)
+    pfreq[k] = 0;
+
+  if ((!bits) ||
+      (!md) ||
+      (i < 1) ||
+      (j < 1) ||
+      (i > bits->length) ||
+      (j > bits->length))
+    return;
+
+  words = bits->words;
+  codes = bits->codes;
+  gi    = bits->bits + (size_t)i * codes * words;
+  gj    = bits->bits + (size_t)j * codes * words;
+  ti    = bits->tilde + (size_t)i * words;
+  tj    = bits->tilde + (size_t)j * words;
+  pi    = bits->present + (size_t)i * (codes + 1);
+  pj    = bits->present + (size_t)j * (codes + 1);
+
+  /* gap-gap, and any sequence with a '~' in one of the columns */
+  for (cnt = 0, w = 0; w < words; w++)
+    cnt += count_word(bits, w, (gi[w] & gj[w]) | ti[w] | tj[w]);
+
+  pfreq[7] = cnt;
+
+  /* all remaining sequences with a valid pair type */
+  for (; *pi; pi++) {
+    bi = bits->bits + ((size_t)i * codes + *pi) * words;
+    for (k = 0; pj[k]; k++) {
+      t = (unsigned int)md->pair[*pi][pj[k]];
+      if (t == 0)
+        continue;
+
+      bj = bits->bits + ((size_t)j * codes + pj[k]) * words;
+
+      for (cnt = 0, w = 0; w < words; w++)
+        cnt += count_word(bits, w, bi[w] & bj[w] & ~(ti[w] | tj[w]));
+
+      pfreq[t] += cnt;
+    }
+  }
+
+  /* everything else can't pair */
+  for (sum = 0, k = 1; k < 8; k++)
+    sum += pfreq[k];
+
+  pfreq[0] = bits->n_seq - sum;
+}
+
+
+PUBLIC void
+vrna_aln_pfreq(const short      **S,
+               const char       **AS,
+               unsigned int     n_seq,
+               const vrna_md_t  *md,
+               unsigned int     i,
+               unsigned int     j,
+               unsigned int     *pfreq)
+{
+  unsigned int  s, k, type;
+  int           ci, cj;
+
+  for (k = 0; k < 8; k++)
+    pfreq[k] = 0;
+
+  if ((!S) ||
+      (!md))
+    return;
+
+  for (s = 0; s < n_seq; s++) {
+    ci  = (S[s][i] > 0) ? S[s][i] : 0;
+    cj  = (S[s][j] > 0) ? S[s][j] : 0;
+
+    if ((ci == 0) && (cj == 0)) {
+      type = 7;                             /* gap-gap  */
+    } else if ((AS) &&
+               ((AS[s][i] == '~') || (AS[s][j] == '~'))) {
+      type = 7;
+    } else if ((ci > MAXALPHA) || (cj > MAXALPHA)) {
+      type = 0;
+    } else {
+      type = (unsigned int)md->pair[ci][cj];
+    }
+
+    pfreq[type]++;
+  }
+}
+
+
 PUBLIC int *
 vrna_aln_pscore(const char  **alignment,
                 vrna_md_t   *md)
@@ -302,6 +555,7 @@ vrna_aln_pscore(const char  **alignment,
   vrna_md_t md_default;
   int       *pscore;
   short     **S;
+  vrna_aln_bits_t *bits;
 
   int       olddm[7][7] = { { 0, 0, 0, 0, 0, 0, 0 },  /* hamming distance between pairs */
                             { 0, 0, 2, 2, 1, 2, 2 },  /* CG */
@@ -333,6 +587,12 @@ vrna_aln_pscore(const char  **alignment,
 
     indx = vrna_idx_col_wise(n);
 
+    /*
+     * column-wise bit sets for fast pair type counting, if the
+     * encoding exceeds their range we count sequence by sequence
+     */
+    bits = vrna_aln_bits((const short **)S, alignment, n_seq, n);
+
     pscore = (int *)vrna_alloc(sizeof(int) * ((n + 1) * (n + 2) / 2 + 2));
 
     if (md->ribo) {
@@ -356,29 +616,22 @@ vrna_aln_pscore(const char  **alignment,
 
     for (i = 1; i < n; i++) {
       for (j = i + 1; j <= n; j++) {
-        int     pfreq[8] = {
-          0, 0, 0, 0, 0, 0, 0, 0
-        };
-        double  score;
+        int           pfreq[8];
+        unsigned int  freq[8];
+        double        score;
 
         if ((j - i + 1) > max_span) {
           pscore[indx[j] + i] = NONE;
           continue;
         }
 
-        for (s = 0; s < n_seq; s++) {
-          int type;
-          if (S[s][i] == 0 && S[s][j] == 0) {
-            type = 7;                             /* gap-gap  */
-          } else {
-            if ((alignment[s][i] == '~') || (alignment[s][j] == '~'))
-              type = 7;
-            else
-              type = md->pair[S[s][i]][S[s][j]];
-          }
+        if (bits)
+          vrna_aln_bits_pfreq(bits, md, i, j, freq);
+        else
+          vrna_aln_pfreq((const short **)S, alignment, n_seq, md, i, j, freq);
 
-          pfreq[type]++;
-        }
+        for (k = 0; k < 8; k++)
+          pfreq[k] = (int)freq[k];
 
         if (pfreq[0] * 2 + pfreq[7] >= n_seq) {
           pscore[indx[j] + i] = NONE;
@@ -422,6 +675,8 @@ vrna_aln_pscore(const char  **alignment,
       free(dm[i]);
     free(dm);
 
+    vrna_aln_bits_free(bits);
+
     for (s = 0; s < n_seq; s++)
       free(S[s]);
     free(S);
@@ -433,6 +688,78 @@ vrna_aln_pscore(const char  **alignment,
 }
 
 
+PUBLIC unsigned int
+vrna_aln_unique(const char    **alignment,
+                unsigned int  **representatives,
+                unsigned int  **weights)
+{
+  unsigned int  n_seq, n_uniq, s, u, h, size, *hash, *table, *rep, *w;
+  const char    *c;
+
+  if (representatives)
+    *representatives = NULL;
+
+  if (weights)
+    *weights = NULL;
+
+  if (!alignment)
+    return 0;
+
+  for (n_seq = 0; alignment[n_seq]; n_seq++);
+
+  if (n_seq == 0)
+    return 0;
+
+  /* open addressing table of distinct rows, at most half full */
+  for (size = 2; size < 2 * n_seq; size <<= 1);
+
+  hash    = (unsigned int *)vrna_alloc(sizeof(unsigned int) * n_seq);
+  table   = (unsigned int *)vrna_alloc(sizeof(unsigned int) * size);
+  rep     = (unsigned int *)vrna_alloc(sizeof(unsigned int) * n_seq);
+  w       = (unsigned int *)vrna_alloc(sizeof(unsigned int) * n_seq);
+  n_uniq  = 0;
+
+  for (s = 0; s < n_seq; s++) {
+    /* FNV-1a */
+    for (h = 2166136261U, c = alignment[s]; *c; c++)
+      h = (h ^ (unsigned char)(*c)) * 16777619U;
+
+    hash[s] = h;
+
+    /* table entries store representative + 1, 0 marks an empty slot */
+    for (h &= size - 1; (u = table[h]) != 0; h = (h + 1) & (size - 1)) {
+      u--;
+      if ((hash[rep[u]] == hash[s]) &&
+          (!strcmp(alignment[rep[u]], alignment[s])))
+        break;
+    }
+
+    if (table[h] == 0) {
+      u         = n_uniq++;
+      rep[u]    = s;
+      table[h]  = u + 1;
+    }
+
+    w[u]++;
+  }
+
+  free(hash);
+  free(table);
+
+  if (representatives)
+    *representatives = (unsigned int *)vrna_realloc(rep, sizeof(unsigned int) * n_uniq);
+  else
+    free(rep);
+
+  if (weights)
+    *weights = (unsigned int *)vrna_realloc(w, sizeof(unsigned int) * n_uniq);
+  else
+    free(w);
+
+  return n_uniq;
+}
+
+
 PUBLIC char **
 vrna_aln_slice(const char   **alignment,
                unsigned int i,
@@ -793,6 +1120,38 @@ vrna_aln_consensus_mis(const char       **alignment,
  # BEGIN OF STATIC HELPER FUNCTIONS  #
  #####################################
  */
+PRIVATE INLINE unsigned int
+popcount64(uint64_t x)
+{
+#ifdef __GNUC__
+  return (unsigned int)__builtin_popcountll(x);
+#else
+  x = x - ((x >> 1) & 0x5555555555555555ULL);
+  x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+  x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+  return (unsigned int)((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+
+/* number of set bits in word w of x, each one counted with the weight of its sequence */
+PRIVATE INLINE unsigned int
+count_word(const vrna_aln_bits_t  *b,
+           size_t                 w,
+           uint64_t               x)
+{
+  unsigned int p, cnt;
+
+  if (b->planes == 0)
+    return popcount64(x);
+
+  for (cnt = 0, p = 0; p < b->planes; p++)
+    cnt += popcount64(x & b->weights[(size_t)p * b->words + w]) << p;
+
+  return cnt;
+}
+
+
 PRIVATE char **
 copy_alignment(const char   **alignment,
                unsigned int options)
@@ -26,6 +26,13 @@ extern "C" {
 
 #include "wrap_dlib.h"
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* number of consecutive concentration points solved by one thread in batch mode */
+#define CONC_BATCH_BLOCK  32
+
 using namespace std;
 using namespace dlib;
 
@@ -171,9 +178,9 @@ h_hessian(const column_vector&  L,
           size_t                strands,
           size_t                complexes)
 {
-  double                  *K, **xs;
+  double          *K, **xs;
 
-  PRIVATE matrix<double>  H(strands, strands);
+  matrix<double>  H(strands, strands);
 
   K = (double *)vrna_alloc(sizeof(double) * complexes);
   xs = (double **)vrna_alloc(sizeof(double *) * strands);
@@ -320,6 +327,49 @@ conc_complexes(const column_vector& L,
 }
 
 
+/*
+ *  Minimize h(L) for the given total strand concentrations,
+ *  starting at L. On return, L holds the minimizer, the
+ *  concentrations of the free strands are written to
+ *  concentration_strands and those of the complexes to c
+ */
+PRIVATE void
+solve_equilibrium(column_vector       &L,
+                  const double        *eq_constants,
+                  double              *concentration_strands,
+                  double              *c,
+                  const unsigned int  **A,
+                  size_t              num_strands,
+                  size_t              num_complexes)
+{
+  h_model h;
+
+  h.init(eq_constants,
+         concentration_strands,
+         A,
+         num_strands,
+         num_complexes);
+
+  find_min_trust_region(objective_delta_stop_strategy(1e-18),
+                        h,
+                        L,
+                        1   // initial trust region radius
+                        );
+
+  double *conc_monomers = conc_single_strands(L, num_strands);
+  double *conc_cplx     = conc_complexes(L, eq_constants, A, num_strands, num_complexes);
+
+  for (size_t a = 0; a < num_strands; a++)
+    concentration_strands[a] = conc_monomers[a];
+
+  for (size_t k = 0; k < num_complexes; k++)
+    c[k] = conc_cplx[k];
+
+  free(conc_monomers);
+  free(conc_cplx);
+}
+
+
 double *
 vrna_equilibrium_conc(const double        *eq_constants,
                       double              *concentration_strands,
@@ -327,37 +377,104 @@ vrna_equilibrium_conc(const double        *eq_constants,
                       size_t              num_strands,
                       size_t              num_complexes)
 {
-  double        *r = NULL;
+  double        *r;
 
   column_vector starting_point;
 
-  h_model       h;
-
-  h.init(eq_constants,
-         concentration_strands,
-         A,
-         num_strands,
-         num_complexes);
+  r = (double *)vrna_alloc(sizeof(double) * (num_complexes + 1));
 
   starting_point.set_size(num_strands);
 
   for (size_t a = 0; a < num_strands; a++)
     starting_point(a) = 0.;
 
-  find_min_trust_region(objective_delta_stop_strategy(1e-18),
-                        h,
-                        starting_point,
-                        1   // initial trust region radius
-                        );
+  solve_equilibrium(starting_point,
+                    eq_constants,
+                    concentration_strands,
+                    r,
+                    A,
+                    num_strands,
+                    num_complexes);
 
-  double *conc_monomers = conc_single_strands(starting_point, num_strands);
+  return r;
+}
 
-  for (size_t a = 0; a < num_strands; a++)
-    concentration_strands[a] = conc_monomers[a];
 
-  r = conc_complexes(starting_point, eq_constants, A, num_strands, num_complexes);
+double *
+vrna_equilibrium_conc_batch(const double        *eq_constants,
+                            double              *concentration_strands,
+                            size_t              num_points,
+                            const unsigned int  **A,
+                            size_t              num_strands,
+                            size_t              num_complexes,
+                            int                 jobs)
+{
+  double  *r;
+  long    num_blocks;
+
+  r = (double *)vrna_alloc(sizeof(double) * (num_points * num_complexes + 1));
+
+  /*
+   *  Points are processed in fixed blocks of consecutive points. Within
+   *  a block, each solve starts at the minimizer of the previous point,
+   *  which is usually close for titration series. Since the blocks do
+   *  not depend on the number of threads, neither do the results.
+   */
+  num_blocks = (long)((num_points + CONC_BATCH_BLOCK - 1) / CONC_BATCH_BLOCK);
+
+#ifdef _OPENMP
+  if (jobs <= 0)
+    jobs = omp_get_max_threads();
+
+#pragma omp parallel for schedule(dynamic, 1) num_threads(jobs)
+#else
+  (void)jobs;
+#endif
+  for (long b = 0; b < num_blocks; b++) {
+    size_t        first, last;
+    double        *c_prev = NULL;
+    column_vector L;
+
+    first = (size_t)b * CONC_BATCH_BLOCK;
+    last  = first + CONC_BATCH_BLOCK;
+    if (last > num_points)
+      last = num_points;
+
+    L.set_size(num_strands);
+
+    for (size_t p = first; p < last; p++) {
+      double  *c_tot  = concentration_strands + p * num_strands;
+      int     warm    = (c_prev != NULL);
+
+      /* a strand that is absent in only one of both points has no useful start value */
+      if (warm)
+        for (size_t a = 0; a < num_strands; a++)
+          if ((c_tot[a] > 0.) != (c_prev[a] > 0.)) {
+            warm = 0;
+            break;
+          }
+
+      if (!warm)
+        for (size_t a = 0; a < num_strands; a++)
+          L(a) = 0.;
+
+      if (!c_prev)
+        c_prev = (double *)vrna_alloc(sizeof(double) * (num_strands + 1));
+
+      for (size_t a = 0; a < num_strands; a++)
+        c_prev[a] = c_tot[a];
+
+      solve_equilibrium(L,
+                        eq_constants,
+                        c_tot,
+                        r + p * num_complexes,
+                        A,
+                        num_strands,
+                        num_complexes);
+    }
 
-  free(conc_monomers);
+    free(c_prev);
+  }
 
   return r;
 }
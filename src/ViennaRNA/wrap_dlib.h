@@ -13,6 +13,26 @@ vrna_equilibrium_conc(const double        *eq_constants,
                       size_t              num_complexes);
 
 
+/*
+ *  Equilibrium concentrations for a series of num_points start
+ *  concentration vectors, stored consecutively in concentration_strands
+ *  (num_strands values per point). The free strand concentrations are
+ *  written back in place, the complex concentrations are returned as
+ *  num_points consecutive vectors of num_complexes values each.
+ *  Points are solved in parallel using jobs threads (<= 0 for the
+ *  OpenMP default), each solve is warm-started at the solution of
+ *  the preceding point.
+ */
+double *
+vrna_equilibrium_conc_batch(const double        *eq_constants,
+                            double              *concentration_strands,
+                            size_t              num_points,
+                            const unsigned int  **A,
+                            size_t              num_strands,
+                            size_t              num_complexes,
+                            int                 jobs);
+
+
 #ifdef __cplusplus
 }
 #endif
@@ -262,6 +262,9 @@ main(int  argc,
       vrna_message_error("Input file can't be read!");
     }
 
+    /* large alignment files are read line by line, so use a larger buffer */
+    setvbuf(clust_file, NULL, _IOFBF, 1 << 20);
+
     /*
      *  Use default alignment file formats.
      *  This may be overridden when we parse the
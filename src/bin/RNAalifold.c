@@ -29,6 +29,7 @@
 #include "ViennaRNA/utils/alignments.h"
 #include "ViennaRNA/io/file_formats.h"
 #include "ViennaRNA/io/file_formats_msa.h"
+#include "ViennaRNA/io/probability_store.h"
 #include "ViennaRNA/io/utils.h"
 #include "ViennaRNA/params/io.h"
 #include "ViennaRNA/MEA.h"
@@ -64,6 +65,7 @@ struct options {
   int             verbose;
   int             quiet;
   vrna_md_t       md;
+  vrna_prob_store_t prob_store;
 
   dataset_id      id_control;
   int             continuous_names;
@@ -78,6 +80,7 @@ struct options {
   int             mis;
   int             sci;
   int             endgaps;
+  int             unique_rows;
 
   int             aln_out;
   char            *aln_out_prefix;
@@ -116,8 +119,10 @@ struct record_data {
 
 
 struct output_stream {
-  vrna_cstr_t data;
-  vrna_cstr_t err;
+  vrna_cstr_t               data;
+  vrna_cstr_t               err;
+  vrna_prob_store_t         prob_store;
+  vrna_prob_store_record_t  *prob_record;
 };
 
 
@@ -202,7 +207,8 @@ apply_SHAPE_data(vrna_fold_compound_t *fc,
 
 
 static char *
-get_filename(const char     *id,
+get_filename(vrna_arena_t   arena,
+             const char     *id,
              const char     *suffix,
              const char     *filename_default,
              struct options *opt);
@@ -239,6 +245,7 @@ init_default_options(struct options *opt)
   opt->bppmThreshold  = 1e-6;
   opt->verbose        = 0;
   opt->quiet          = 0;
+  opt->prob_store     = NULL;
   set_model_details(&(opt->md));
 
   opt->continuous_names = 0;
@@ -253,6 +260,7 @@ init_default_options(struct options *opt)
   opt->mis          = 0;
   opt->sci          = 0;
   opt->endgaps      = 0;
+  opt->unique_rows  = 0;
 
   opt->aln_out        = 0;
   opt->aln_out_prefix = NULL;
@@ -302,6 +310,15 @@ flush_cstr_callback(void          *auxdata,
 {
   struct output_stream *s = (struct output_stream *)data;
 
+  /* add probabilities to the store in the same order as the output */
+  if (s->prob_record) {
+    if (!vrna_prob_store_add(s->prob_store, s->prob_record))
+      vrna_message_warning("Failed to add probabilities of %s to probability store",
+                           s->prob_record->id);
+
+    vrna_prob_store_record_free(s->prob_record);
+  }
+
   /* flush/free errors first */
   vrna_cstr_free(s->err);
 
@@ -397,6 +414,18 @@ main(int  argc,
   if (args_info.bppmThreshold_given)
     opt.bppmThreshold = MIN2(1., MAX2(0., args_info.bppmThreshold_arg));
 
+  /* collect equilibrium probabilities of all alignments in a single file */
+  if (args_info.probability_store_given) {
+    opt.pf = 1;
+    if (!opt.md.compute_bpp)
+      opt.md.compute_bpp = 1;
+
+    opt.prob_store = vrna_prob_store_create(args_info.probability_store_arg);
+    if (!opt.prob_store)
+      vrna_message_error("Failed to create probability store %s",
+                         args_info.probability_store_arg);
+  }
+
   /* set cfactor */
   if (args_info.cfactor_given)
     opt.md.cv_fact = args_info.cfactor_arg;
@@ -522,6 +551,10 @@ main(int  argc,
   if (args_info.sci_given)
     opt.sci = 1;
 
+  /* collapse identical rows */
+  if (args_info.unique_rows_given)
+    opt.unique_rows = 1;
+
   /* alignment file name(s) given as unnamed option? */
   input_files = collect_unnamed_options(&args_info, &num_input);
 
@@ -660,6 +693,9 @@ main(int  argc,
                              i + 1,
                              input_files[i]);
 
+        /* large alignment files are read line by line, so use a larger buffer */
+        setvbuf(input_stream, NULL, _IOFBF, 1 << 20);
+
         if (opt.verbose) {
           vrna_message_info(stderr,
                             "Processing %d. input file \"%s\"",
@@ -687,6 +723,8 @@ main(int  argc,
    */
   vrna_ostream_free(opt.output_queue);
 
+  if ((opt.prob_store) && (!vrna_prob_store_close(opt.prob_store)))
+    vrna_message_warning("Failed to finalize probability store!");
 
   /* check whether we've actually processed any alignment so far */
   if (first_alignment_number == get_current_id(opt.id_control)) {
@@ -832,7 +870,7 @@ process_input(FILE            *input_stream,
     /* prepare record data structure */
     struct record_data *record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
 
-    record->number  = opt->next_record_number;
+    record->number  = opt->next_record_number++;
     record->MSA_ID  = fileprefix_from_id_alifold(tmp_id,
                                                  opt->id_control,
                                                  opt->continuous_names);
@@ -847,7 +885,7 @@ process_input(FILE            *input_stream,
     record->options = opt;
 
     if (opt->output_queue)
-      vrna_ostream_request(opt->output_queue, opt->next_record_number++);
+      vrna_ostream_request(opt->output_queue, record->number);
 
     /* process the record we've just read */
     RUN_IN_PARALLEL(process_record, record);
@@ -874,17 +912,19 @@ process_record(struct record_data *record)
   struct options        *opt;
   vrna_fold_compound_t  *vc;
   struct output_stream  *o_stream;
+  vrna_arena_t          arena;
 
   o_stream = (struct output_stream *)vrna_alloc(sizeof(struct output_stream));
 
   opt   = record->options;
   n_seq = record->n_seq;
+  arena = record_arena();
 
   /* construct output file names */
-  char  *filename_plot  = get_filename(record->MSA_ID, "ss.ps", "alirna.ps", opt);
-  char  *filename_dot   = get_filename(record->MSA_ID, "dp.ps", "alidot.ps", opt);
-  char  *filename_aln   = get_filename(record->MSA_ID, "aln.ps", "aln.ps", opt);
-  char  *filename_out   = get_filename(record->MSA_ID, "ali.out", "alifold.out", opt);
+  char  *filename_plot  = get_filename(arena, record->MSA_ID, "ss.ps", "alirna.ps", opt);
+  char  *filename_dot   = get_filename(arena, record->MSA_ID, "dp.ps", "alidot.ps", opt);
+  char  *filename_aln   = get_filename(arena, record->MSA_ID, "aln.ps", "aln.ps", opt);
+  char  *filename_out   = get_filename(arena, record->MSA_ID, "ali.out", "alifold.out", opt);
 
   /*
    *  create a new alignment for internal computations
@@ -900,11 +940,12 @@ process_record(struct record_data *record)
 
   vc = vrna_fold_compound_comparative((const char **)alignment,
                                       &(opt->md),
-                                      VRNA_OPTION_DEFAULT);
+                                      (opt->unique_rows) ? VRNA_OPTION_ALN_UNIQUE : VRNA_OPTION_DEFAULT);
 
   if (!vc) {
     vrna_message_warning("Skipping computations for \"%s\"",
                          (record->MSA_ID) ? record->MSA_ID : "identifier unavailable");
+    vrna_arena_reset(arena);
     return;
   }
 
@@ -943,7 +984,7 @@ process_record(struct record_data *record)
   vrna_cstr_print_fasta_header(o_stream->data, record->MSA_ID);
   vrna_cstr_printf(o_stream->data, "%s\n", consensus_sequence);
 
-  mfe_structure = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  mfe_structure = (char *)vrna_arena_alloc(arena, sizeof(char) * (n + 1));
   min_en        = vrna_mfe(vc, mfe_structure);
 
   /* check whether the constraint allows for any solution */
@@ -1035,7 +1076,7 @@ process_record(struct record_data *record)
     double  energy;
     char    *pairing_propensity;
 
-    pairing_propensity = (char *)vrna_alloc(sizeof(char) * (n + 1));
+    pairing_propensity = (char *)vrna_arena_alloc(arena, sizeof(char) * (n + 1));
 
     vrna_exp_params_rescale(vc, &min_en);
 
@@ -1060,6 +1101,22 @@ process_record(struct record_data *record)
                                  " [%6.2f]",
                                  DBL_ROUND(energy, 2));
 
+      if (opt->prob_store) {
+        char *id = (record->MSA_ID) ?
+                   strdup(record->MSA_ID) :
+                   vrna_strdup_printf("alignment_%04u", record->number + 1);
+
+        /* the record is added along with the output to retain the input order */
+        o_stream->prob_store  = opt->prob_store;
+        o_stream->prob_record = vrna_prob_store_record_fc(id,
+                                                          vc,
+                                                          mfe_structure,
+                                                          min_en,
+                                                          energy,
+                                                          opt->bppmThreshold);
+        free(id);
+      }
+
       pl    = vrna_plist_from_probs(vc, opt->bppmThreshold);
       mfel  = vrna_plist(mfe_structure, 0.95 * 0.95);
 
@@ -1110,8 +1167,6 @@ process_record(struct record_data *record)
                                  DBL_ROUND(energy, 2),
                                  vrna_pr_energy(vc, min_en));
     }
-
-    free(pairing_propensity);
   } /* end partition function block */
 
   /* write output multiple sequence alignment */
@@ -1146,11 +1201,6 @@ process_record(struct record_data *record)
     THREADSAFE_STREAM_OUTPUT(flush_cstr_callback(NULL, record->number, (void *)o_stream));
 
   free(consensus_sequence);
-  free(mfe_structure);
-  free(filename_plot);
-  free(filename_dot);
-  free(filename_aln);
-  free(filename_out);
   vrna_fold_compound_free(vc);
 
   vrna_aln_free(alignment);
@@ -1160,6 +1210,9 @@ process_record(struct record_data *record)
   vrna_aln_free(record->names);
   free(record->consensus_structure);
 
+  /* release all record-scoped temporaries at once */
+  vrna_arena_reset(arena);
+
   free(record);
 }
 
@@ -1427,7 +1480,8 @@ apply_SHAPE_data(vrna_fold_compound_t *fc,
 
 
 static char *
-get_filename(const char     *id,
+get_filename(vrna_arena_t   arena,
+             const char     *id,
              const char     *suffix,
              const char     *filename_default,
              struct options *opt)
@@ -1435,13 +1489,13 @@ get_filename(const char     *id,
   char *tmp_string, *filename = NULL;
 
   if (id) {
-    filename = vrna_strdup_printf("%s%s%s", id, opt->filename_delim, suffix);
+    filename = vrna_arena_strdup_printf(arena, "%s%s%s", id, opt->filename_delim, suffix);
     /* sanitize file names */
-    tmp_string = vrna_filename_sanitize(filename, opt->filename_delim);
-    free(filename);
-    filename = tmp_string;
+    tmp_string  = vrna_filename_sanitize(filename, opt->filename_delim);
+    filename    = vrna_arena_strdup(arena, tmp_string);
+    free(tmp_string);
   } else {
-    filename = vrna_strdup_printf("%s", filename_default);
+    filename = vrna_arena_strdup(arena, filename_default);
   }
 
   return filename;
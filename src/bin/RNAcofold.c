@@ -24,6 +24,7 @@
 #include "ViennaRNA/constraints/soft.h"
 #include "ViennaRNA/constraints/SHAPE.h"
 #include "ViennaRNA/io/file_formats.h"
+#include "ViennaRNA/io/probability_store.h"
 #include "ViennaRNA/io/utils.h"
 #include "ViennaRNA/cofold.h"
 #include "ViennaRNA/fold.h"
@@ -60,6 +61,7 @@ struct options {
   int             verbose;
   vrna_md_t       md;
   vrna_cmd_t      commands;
+  vrna_prob_store_t prob_store;
 
   dataset_id      id_control;
 
@@ -100,8 +102,10 @@ struct record_data {
 
 
 struct output_stream {
-  vrna_cstr_t data;
-  vrna_cstr_t err;
+  vrna_cstr_t               data;
+  vrna_cstr_t               err;
+  vrna_prob_store_t         prob_store;
+  vrna_prob_store_record_t  *prob_record;
 };
 
 
@@ -183,6 +187,7 @@ init_default_options(struct options *opt)
   opt->bppmThreshold  = 1e-5;
   opt->verbose        = 0;
   opt->commands       = NULL;
+  opt->prob_store     = NULL;
   opt->id_control     = NULL;
   set_model_details(&(opt->md));
 
@@ -237,6 +242,15 @@ flush_cstr_callback(void          *auxdata,
 {
   struct output_stream *s = (struct output_stream *)data;
 
+  /* add probabilities to the store in the same order as the output */
+  if (s->prob_record) {
+    if (!vrna_prob_store_add(s->prob_store, s->prob_record))
+      vrna_message_warning("Failed to add probabilities of %s to probability store",
+                           s->prob_record->id);
+
+    vrna_prob_store_record_free(s->prob_record);
+  }
+
   /* flush/free errors first */
   vrna_cstr_free(s->err);
 
@@ -358,6 +372,20 @@ main(int  argc,
       opt.md.compute_bpp = 1;
   }
 
+  /* collect equilibrium probabilities of all sequences in a single file */
+  if (args_info.probability_store_given) {
+    if (!opt.pf)
+      opt.pf = 1;
+
+    if (!opt.md.compute_bpp)
+      opt.md.compute_bpp = 1;
+
+    opt.prob_store = vrna_prob_store_create(args_info.probability_store_arg);
+    if (!opt.prob_store)
+      vrna_message_error("Failed to create probability store %s",
+                         args_info.probability_store_arg);
+  }
+
   if (args_info.verbose_given)
     opt.verbose = 1;
 
@@ -507,6 +535,8 @@ main(int  argc,
    */
   vrna_ostream_free(opt.output_queue);
 
+  if ((opt.prob_store) && (!vrna_prob_store_close(opt.prob_store)))
+    vrna_message_warning("Failed to finalize probability store!");
 
   free(input_files);
   free(opt.constraint_file);
@@ -597,7 +627,7 @@ process_input(FILE            *input_stream,
 
     struct record_data *record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
 
-    record->number          = opt->next_record_number;
+    record->number          = opt->next_record_number++;
     record->sequence        = rec_sequence;
     record->SEQ_ID          = fileprefix_from_id(rec_id, opt->id_control, opt->filename_full);
     record->id              = rec_id;
@@ -608,7 +638,7 @@ process_input(FILE            *input_stream,
     record->input_filename  = (input_filename) ? strdup(input_filename) : NULL;
 
     if (opt->output_queue)
-      vrna_ostream_request(opt->output_queue, opt->next_record_number++);
+      vrna_ostream_request(opt->output_queue, record->number);
 
     RUN_IN_PARALLEL(process_record, record);
 
@@ -645,13 +675,15 @@ process_record(struct record_data *record)
   vrna_ep_t             *prAB, *prAA, *prBB, *prA, *prB, *mfAB, *mfAA, *mfBB, *mfA, *mfB;
   struct options        *opt;
   struct output_stream  *o_stream;
+  vrna_arena_t          arena;
 
   mfAB            = mfAA = mfBB = mfA = mfB = NULL;
   prAB            = prAA = prBB = prA = prB = NULL;
   concentrations  = NULL;
   opt             = record->options;
+  arena           = record_arena();
   o_stream        = (struct output_stream *)vrna_alloc(sizeof(struct output_stream));
-  sequence        = strdup(record->sequence);
+  sequence        = vrna_arena_strdup(arena, record->sequence);
   rec_rest        = record->rest;
 
   /* convert DNA alphabet to RNA if not explicitely switched off */
@@ -670,6 +702,7 @@ process_record(struct record_data *record)
   if (!vc) {
     vrna_message_warning("Skipping computations for \"%s\"",
                          (record->id) ? record->id : "identifier unavailable");
+    vrna_arena_reset(arena);
     return;
   }
 
@@ -702,7 +735,7 @@ process_record(struct record_data *record)
     }
   }
 
-  mfe_structure = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  mfe_structure = (char *)vrna_arena_alloc(arena, sizeof(char) * (n + 1));
 
   /* parse the rest of the current dataset to obtain a structure constraint */
   if (fold_constrained) {
@@ -831,6 +864,7 @@ process_record(struct record_data *record)
   if (opt->pf) {
     char              *Astring, *Bstring, *orig_Astring, *orig_Bstring, *pairing_propensity;
     int               Blength, Alength;
+    double            mfe;
     vrna_dimer_pf_t   AB, AA, BB;
     vrna_dimer_conc_t *conc_result;
 
@@ -844,7 +878,8 @@ process_record(struct record_data *record)
     Astring = Bstring = orig_Astring = orig_Bstring = NULL;
     Alength = Blength = 0;
 
-    pairing_propensity = (char *)vrna_alloc(sizeof(char) * (n + 1));
+    pairing_propensity = (char *)vrna_arena_alloc(arena, sizeof(char) * (n + 1));
+    mfe                = min_en;
 
     if (opt->md.dangles == 1) {
       vc->params->model_details.dangles = 2;   /* recompute with dangles as in pf_fold() */
@@ -885,6 +920,22 @@ process_record(struct record_data *record)
       }
 
       free(costruc);
+
+      if (opt->prob_store) {
+        char *id = (record->SEQ_ID) ?
+                   strdup(record->SEQ_ID) :
+                   vrna_strdup_printf("sequence_%04u", record->number + 1);
+
+        /* the record is added along with the output to retain the input order */
+        o_stream->prob_store  = opt->prob_store;
+        o_stream->prob_record = vrna_prob_store_record_fc(id,
+                                                          vc,
+                                                          mfe_structure,
+                                                          mfe,
+                                                          AB.FAB,
+                                                          opt->bppmThreshold);
+        free(id);
+      }
     } else if (opt->csv_output) {
       vrna_cstr_printf(o_stream->data,
                        "%c"
@@ -933,7 +984,6 @@ process_record(struct record_data *record)
           "Sorry, i cannot do that with only one molecule, please give me two or leave it");
         free(mfAB);
         free(prAB);
-        free(pairing_propensity);
         goto cleanup_record;
       }
 
@@ -1190,7 +1240,6 @@ process_record(struct record_data *record)
     free(mfBB);
     free(mfA);
     free(mfB);
-    free(pairing_propensity);
   }   /*end if(pf)*/
 
 cleanup_record:
@@ -1201,14 +1250,12 @@ cleanup_record:
   if (opt->output_queue)
     vrna_ostream_provide(opt->output_queue, record->number, (void *)o_stream);
   else
-    flush_cstr_callback(NULL, 0, (void *)o_stream);
+    THREADSAFE_STREAM_OUTPUT(flush_cstr_callback(NULL, 0, (void *)o_stream));
 
   /* clean up */
   free(record->SEQ_ID);
   free(record->id);
-  free(sequence);
   free(record->sequence);
-  free(mfe_structure);
   /* free the rest of current dataset */
   if (record->rest) {
     for (i = 0; record->rest[i]; i++)
@@ -1218,6 +1265,9 @@ cleanup_record:
 
   vrna_fold_compound_free(vc);
 
+  /* release all record-scoped temporaries at once */
+  vrna_arena_reset(arena);
+
   free(record);
 }
 
@@ -757,7 +757,7 @@ main(int  argc,
 
   int   verbose     = 0;
   int   max_energy  = 0;
-  int   hash_bits   = 20;
+  int   hash_bits   = 8;
 
   char  *ParamFile = NULL;
 
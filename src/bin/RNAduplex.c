@@ -16,17 +16,108 @@
 #include <string.h>
 #include "ViennaRNA/fold.h"
 #include "ViennaRNA/fold_vars.h"
+#include "ViennaRNA/model.h"
 #include "ViennaRNA/utils/basic.h"
 #include "ViennaRNA/utils/strings.h"
 #include "ViennaRNA/params/io.h"
 #include "ViennaRNA/subopt.h"
 #include "ViennaRNA/duplex.h"
+#include "ViennaRNA/datastructures/char_stream.h"
+#include "ViennaRNA/datastructures/stream_output.h"
 #include "RNAduplex_cmdl.h"
+#include "parallel_helpers.h"
 
 #include "ViennaRNA/color_output.inc"
 
+struct options {
+  int             noconv;
+  int             delta;
+  int             sorted;
+  vrna_md_t       md;
+
+  int             jobs;
+  int             keep_order;
+  unsigned int    next_record_number;
+  vrna_ostream_t  output_queue;
+};
+
+
+struct record_data {
+  unsigned int    number;
+  char            **headers;  /* FASTA headers that preceded the sequences */
+  char            *s1;
+  char            *s2;
+  struct options  *options;
+  int             tty;
+};
+
+
+struct output_stream {
+  vrna_cstr_t data;
+  vrna_cstr_t err;
+};
+
+
+/*
+ *  Each thread keeps a single duplex context for all records it processes,
+ *  such that its DP matrix is allocated only once
+ */
+#if VRNA_WITH_PTHREADS
+static pthread_key_t  duplex_key;
+static pthread_once_t duplex_key_once = PTHREAD_ONCE_INIT;
+
+
+static void
+duplex_destroy(void *data)
+{
+  vrna_duplex_free((vrna_duplex_t)data);
+}
+
+
+static void
+duplex_key_init(void)
+{
+  pthread_key_create(&duplex_key, &duplex_destroy);
+}
+
+
+#else
+static vrna_duplex_t duplex_single = NULL;
+#endif
+
+
+PRIVATE vrna_duplex_t
+thread_duplex(vrna_md_t *md);
+
+
 PRIVATE void
-print_struc(duplexT const *dup);
+thread_duplex_free(void);
+
+
+PRIVATE void
+process_record(struct record_data *record);
+
+
+PRIVATE void
+print_struc(vrna_cstr_t   stream,
+            duplexT const *dup);
+
+
+static void
+flush_cstr_callback(void          *auxdata,
+                    unsigned int  i,
+                    void          *data)
+{
+  struct output_stream *s = (struct output_stream *)data;
+
+  /* flush/free errors first */
+  vrna_cstr_free(s->err);
+
+  /* flush/free data[k] */
+  vrna_cstr_free(s->data);
+
+  free(s);
+}
 
 
 /*--------------------------------------------------------------------------*/
@@ -36,17 +127,23 @@ main(int  argc,
      char *argv[])
 {
   struct        RNAduplex_args_info args_info;
-  char                              *input_string, *s1, *s2, *orig_s1, *orig_s2,
-                                    *c, *ParamFile, *ns_bases;
-  unsigned int                      input_type;
-  int                               i, sym, istty, delta, noconv;
-
-  ParamFile = NULL;
-  ns_bases  = NULL;
-  s1        = s2 = orig_s1 = orig_s2 = NULL;
-  dangles   = 2;
-  delta     = -1;
-  noconv    = 0;
+  char                              *input_string, *s1, *s2, *c, *ParamFile, *ns_bases,
+                                    **headers;
+  unsigned int                      input_type, num_headers;
+  int                               i, sym, istty;
+  struct options                    opt;
+
+  ParamFile               = NULL;
+  ns_bases                = NULL;
+  s1                      = s2 = NULL;
+  dangles                 = 2;
+  opt.delta               = -1;
+  opt.noconv              = 0;
+  opt.sorted              = 0;
+  opt.jobs                = 1;
+  opt.keep_order          = 1;
+  opt.next_record_number  = 0;
+  opt.output_queue        = NULL;
 
   /*
    #############################################
@@ -87,7 +184,7 @@ main(int  argc,
 
   /* do not convert DNA nucleotide "T" to appropriate RNA "U" */
   if (args_info.noconv_given)
-    noconv = 1;
+    opt.noconv = 1;
 
   /* take another energy parameter set */
   if (args_info.paramFile_given)
@@ -99,11 +196,38 @@ main(int  argc,
 
   /*energy range */
   if (args_info.deltaEnergy_given)
-    delta = (int)(0.1 + args_info.deltaEnergy_arg * 100);
+    opt.delta = (int)(0.1 + args_info.deltaEnergy_arg * 100);
 
   /* sorted output */
   if (args_info.sorted_given)
-    subopt_sorted = 1;
+    opt.sorted = 1;
+
+  if (args_info.jobs_given) {
+#if VRNA_WITH_PTHREADS
+    int thread_max = max_user_threads();
+    if (args_info.jobs_arg == 0) {
+      /* use maximum of concurrent threads */
+      int proc_cores, proc_cores_conf;
+      if (num_proc_cores(&proc_cores, &proc_cores_conf)) {
+        opt.jobs = MIN2(thread_max, proc_cores_conf);
+      } else {
+        vrna_message_warning("Could not determine number of available processor cores!\n"
+                             "Defaulting to serial computation");
+        opt.jobs = 1;
+      }
+    } else {
+      opt.jobs = MIN2(thread_max, args_info.jobs_arg);
+    }
+
+    opt.jobs = MAX2(1, opt.jobs);
+#else
+    vrna_message_warning(
+      "This version of RNAduplex has been built without parallel input processing capabilities");
+#endif
+
+    if (args_info.unordered_given)
+      opt.keep_order = 0;
+  }
 
   /* free allocated memory of command line data structure */
   RNAduplex_cmdline_parser_free(&args_info);
@@ -143,15 +267,25 @@ main(int  argc,
     }
   }
 
+  /* collect the model settings from the global variables set above */
+  set_model_details(&(opt.md));
+
   istty = isatty(fileno(stdout)) && isatty(fileno(stdin));
 
+  if (opt.keep_order)
+    opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
+
+  INIT_PARALLELIZATION(opt.jobs);
+
   /*
    #############################################
    # main loop: continue until end of file
    #############################################
    */
+  headers     = NULL;
+  num_headers = 0;
+
   do {
-    duplexT mfe, *subopt;
     /*
      ########################################################
      # handle user input from 'stdin'
@@ -160,10 +294,11 @@ main(int  argc,
     if (istty)
       vrna_message_input_seq("Input two sequences (one line each)");
 
-    /* extract filename from fasta header if available */
+    /* collect FASTA headers, they are printed along with the results */
     while ((input_type = get_input_line(&input_string, 0)) == VRNA_INPUT_FASTA_HEADER) {
-      print_fasta_header(stdout, input_string);
-      free(input_string);
+      headers                 = (char **)vrna_realloc(headers, sizeof(char *) * (num_headers + 2));
+      headers[num_headers++]  = input_string;
+      headers[num_headers]    = NULL;
     }
 
     /* break on any error, EOF or quit request */
@@ -172,80 +307,200 @@ main(int  argc,
     }
     /* else assume a proper sequence of letters of a certain alphabet (RNA, DNA, etc.) */
     else {
-      s1 = strdup(input_string);
-      free(input_string);
+      s1 = input_string;
     }
 
     /* get second sequence */
     while ((input_type = get_input_line(&input_string, 0)) == VRNA_INPUT_FASTA_HEADER) {
-      print_fasta_header(stdout, input_string);
-      free(input_string);
+      headers                 = (char **)vrna_realloc(headers, sizeof(char *) * (num_headers + 2));
+      headers[num_headers++]  = input_string;
+      headers[num_headers]    = NULL;
     }
     /* break on any error, EOF or quit request */
     if (input_type & (VRNA_INPUT_QUIT | VRNA_INPUT_ERROR)) {
+      free(s1);
+      s1 = NULL;
       break;
     }
     /* else assume a proper sequence of letters of a certain alphabet (RNA, DNA, etc.) */
     else {
-      s2 = strdup(input_string);
-      free(input_string);
+      s2 = input_string;
     }
 
+    struct record_data *record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
+
+    record->number  = opt.next_record_number;
+    record->headers = headers;
+    record->s1      = s1;
+    record->s2      = s2;
+    record->options = &opt;
+    record->tty     = istty;
+
+    headers     = NULL;
+    num_headers = 0;
+    s1          = s2 = NULL;
+
+    if (opt.output_queue)
+      vrna_ostream_request(opt.output_queue, opt.next_record_number++);
+
+    RUN_IN_PARALLEL(process_record, record);
+  } while (1);
+
+  /* print any FASTA headers that are not followed by a pair of sequences */
+  if (headers) {
+    struct record_data *record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
+
+    record->number  = opt.next_record_number;
+    record->headers = headers;
+    record->options = &opt;
+    record->tty     = istty;
+
+    if (opt.output_queue)
+      vrna_ostream_request(opt.output_queue, opt.next_record_number++);
+
+    RUN_IN_PARALLEL(process_record, record);
+  }
+
+  UNINIT_PARALLELIZATION
+
+  /* worker threads release their contexts upon termination, the main thread has to do it here */
+  thread_duplex_free();
+
+  vrna_ostream_free(opt.output_queue);
+
+  free(ParamFile);
+  free(ns_bases);
+
+  return 0;
+}
+
+
+PRIVATE void
+process_record(struct record_data *record)
+{
+  char                  *s1, *s2, **h;
+  struct options        *opt;
+  struct output_stream  *o_stream;
+  vrna_duplex_t         dup;
+
+  opt       = record->options;
+  s1        = record->s1;
+  s2        = record->s2;
+  o_stream  = (struct output_stream *)vrna_alloc(sizeof(struct output_stream));
+
+  /* retrieve string stream bound to stdout */
+  o_stream->data  = vrna_cstr((s1 && s2) ? 4 * (strlen(s1) + strlen(s2)) : 256, stdout);
+  o_stream->err   = vrna_cstr(256, stderr);
+
+  if (record->headers)
+    for (h = record->headers; *h; h++)
+      vrna_cstr_print_fasta_header(o_stream->data, *h);
+
+  if ((s1) && (s2)) {
     /* convert DNA alphabet to RNA if not explicitely switched off */
-    if (!noconv) {
+    if (!opt->noconv) {
       vrna_seq_toRNA(s1);
       vrna_seq_toRNA(s2);
     }
 
-    /* store case-unmodified sequence */
-    orig_s1 = strdup(s1);
-    orig_s2 = strdup(s2);
     /* convert sequence to uppercase letters only */
     vrna_seq_toupper(s1);
     vrna_seq_toupper(s2);
 
-    if (istty)
+    if (record->tty)
       vrna_message_info(stdout, "lengths = %d,%d\n", (int)strlen(s1), (int)strlen(s2));
 
-    /*
-     ########################################################
-     # done with 'stdin' handling, now init everything properly
-     ########################################################
-     */
-    update_fold_params();
-
     /*
      ########################################################
      # begin actual computations
      ########################################################
      */
-    if (delta >= 0) {
-      duplexT *sub;
-      subopt = duplex_subopt(s1, s2, delta, 5);
+    dup = thread_duplex(&(opt->md));
+
+    if (opt->delta >= 0) {
+      duplexT *sub, *subopt;
+      subopt = vrna_duplex_subopt(dup, s1, s2, opt->delta, 5, opt->sorted);
       for (sub = subopt; sub->i > 0; sub++) {
-        print_struc(sub);
+        print_struc(o_stream->data, sub);
         free(sub->structure);
       }
       free(subopt);
     } else {
-      mfe = duplexfold(s1, s2);
-      print_struc(&mfe);
+      duplexT mfe = vrna_duplex_mfe(dup, s1, s2);
+      print_struc(o_stream->data, &mfe);
       free(mfe.structure);
     }
+  }
 
-    (void)fflush(stdout);
-    free(s1);
-    free(s2);
-    free(orig_s1);
-    free(orig_s2);
-    s1 = s2 = orig_s1 = orig_s2 = NULL;
-  } while (1);
-  return 0;
+  if (opt->output_queue)
+    vrna_ostream_provide(opt->output_queue, record->number, (void *)o_stream);
+  else
+    THREADSAFE_STREAM_OUTPUT(flush_cstr_callback(NULL, record->number, (void *)o_stream));
+
+  /* clean up */
+  if (record->headers) {
+    for (h = record->headers; *h; h++)
+      free(*h);
+    free(record->headers);
+  }
+
+  free(s1);
+  free(s2);
+  free(record);
+}
+
+
+PRIVATE vrna_duplex_t
+thread_duplex(vrna_md_t *md)
+{
+  vrna_duplex_t dup;
+
+#if VRNA_WITH_PTHREADS
+  pthread_once(&duplex_key_once, &duplex_key_init);
+
+  dup = (vrna_duplex_t)pthread_getspecific(duplex_key);
+
+  if (!dup) {
+    dup = vrna_duplex_init(md);
+    pthread_setspecific(duplex_key, (void *)dup);
+  }
+
+#else
+  if (!duplex_single)
+    duplex_single = vrna_duplex_init(md);
+
+  dup = duplex_single;
+#endif
+
+  return dup;
+}
+
+
+PRIVATE void
+thread_duplex_free(void)
+{
+#if VRNA_WITH_PTHREADS
+  vrna_duplex_t dup;
+
+  pthread_once(&duplex_key_once, &duplex_key_init);
+
+  dup = (vrna_duplex_t)pthread_getspecific(duplex_key);
+
+  if (dup) {
+    pthread_setspecific(duplex_key, NULL);
+    vrna_duplex_free(dup);
+  }
+
+#else
+  vrna_duplex_free(duplex_single);
+  duplex_single = NULL;
+#endif
 }
 
 
 PRIVATE void
-print_struc(duplexT const *dup)
+print_struc(vrna_cstr_t   stream,
+            duplexT const *dup)
 {
   int   l1;
 
@@ -257,6 +512,6 @@ print_struc(duplexT const *dup)
                                   dup->j + (int)strlen(dup->structure) - l1 - 2,
                                   dup->energy);
 
-  print_structure(stdout, dup->structure, msg);
+  vrna_cstr_printf_structure(stream, dup->structure, "%s", msg);
   free(msg);
 }
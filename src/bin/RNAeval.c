@@ -614,10 +614,12 @@ process_record(struct record_data *record)
   int                   n;
   float                 energy;
   vrna_fold_compound_t  *vc;
+  vrna_arena_t          arena;
 
   opt           = record->options;
+  arena         = record_arena();
   o_stream      = (struct output_stream *)vrna_alloc(sizeof(struct output_stream));
-  rec_sequence  = strdup(record->sequence);
+  rec_sequence  = vrna_arena_strdup(arena, record->sequence);
 
   /* convert DNA alphabet to RNA if not explicitely switched off */
   if (!opt->noconv) {
@@ -635,6 +637,7 @@ process_record(struct record_data *record)
   if (!vc) {
     vrna_message_warning("Skipping computations for \"%s\"",
                          (record->id) ? record->id : "identifier unavailable");
+    vrna_arena_reset(arena);
     return;
   }
 
@@ -769,7 +772,6 @@ process_record(struct record_data *record)
   free(record->id);
   free(record->SEQ_ID);
   free(record->sequence);
-  free(rec_sequence);
   free(structure);
 
   /* free the rest of current dataset */
@@ -781,6 +783,9 @@ process_record(struct record_data *record)
 
   free(record->input_filename);
 
+  /* release all record-scoped temporaries at once */
+  vrna_arena_reset(arena);
+
   free(record);
 }
 
@@ -42,6 +42,7 @@
 #include "ViennaRNA/structured_domains.h"
 #include "ViennaRNA/unstructured_domains.h"
 #include "ViennaRNA/io/file_formats.h"
+#include "ViennaRNA/io/probability_store.h"
 #include "ViennaRNA/commands.h"
 #include "ViennaRNA/equilibrium_probs.h"
 #include "ViennaRNA/datastructures/char_stream.h"
@@ -68,6 +69,7 @@ struct options {
   double          bppmThreshold;
   int             verbose;
   char            *ligandMotif;
+  vrna_prob_store_t prob_store;
   vrna_cmd_t      cmds;
   vrna_md_t       md;
   dataset_id      id_control;
@@ -105,8 +107,10 @@ struct record_data {
 
 
 struct output_stream {
-  vrna_cstr_t data;
-  int         individual;
+  vrna_cstr_t               data;
+  int                       individual;
+  vrna_prob_store_t         prob_store;
+  vrna_prob_store_record_t  *prob_record;
 };
 
 
@@ -203,6 +207,15 @@ flush_cstr_callback(void          *auxdata,
   struct output_stream *s = (struct output_stream *)data;
 
   if (s) {
+    /* add probabilities to the store in the same order as the output */
+    if (s->prob_record) {
+      if (!vrna_prob_store_add(s->prob_store, s->prob_record))
+        vrna_message_warning("Failed to add probabilities of %s to probability store",
+                             s->prob_record->id);
+
+      vrna_prob_store_record_free(s->prob_record);
+    }
+
     /* flush/free/close data[k] */
     if (s->individual)
       vrna_cstr_close(s->data);
@@ -371,6 +384,7 @@ init_default_options(struct options *opt)
   opt->bppmThreshold  = 1e-5;
   opt->verbose        = 0;
   opt->ligandMotif    = NULL;
+  opt->prob_store     = NULL;
   opt->cmds           = NULL;
   set_model_details(&(opt->md));
 
@@ -481,6 +495,22 @@ main(int  argc,
       opt.MEAgamma = args_info.MEA_arg;
   }
 
+  /* collect equilibrium probabilities of all sequences in a single file */
+  if (args_info.probability_store_given) {
+    /* the stochastic backtracking shortcut never computes any probabilities */
+    if (opt.lucky)
+      vrna_message_error("Option --probability-store can not be combined with --ImFeelingLucky");
+
+    opt.pf = 1;
+    if (!opt.md.compute_bpp)
+      opt.md.compute_bpp = do_backtrack = 1;
+
+    opt.prob_store = vrna_prob_store_create(args_info.probability_store_arg);
+    if (!opt.prob_store)
+      vrna_message_error("Failed to create probability store %s",
+                         args_info.probability_store_arg);
+  }
+
   if (args_info.layout_type_given)
     rna_plot_type = args_info.layout_type_arg;
 
@@ -618,6 +648,9 @@ main(int  argc,
 
   vrna_ostream_free(opt.output_queue);
 
+  if ((opt.prob_store) && (!vrna_prob_store_close(opt.prob_store)))
+    vrna_message_warning("Failed to finalize probability store!");
+
   free(input_files);
   free(opt.constraint_file);
   free(opt.ligandMotif);
@@ -766,7 +799,7 @@ process_input(FILE            *input_stream,
 
     struct record_data *record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
 
-    record->number          = opt->next_record_number;
+    record->number          = opt->next_record_number++;
     record->sequence        = rec_sequence;
     record->SEQ_ID          = fileprefix_from_id(rec_id, opt->id_control, opt->filename_full);
     record->id              = rec_id;
@@ -777,7 +810,7 @@ process_input(FILE            *input_stream,
     record->input_filename  = (input_filename) ? strdup(input_filename) : NULL;
 
     if (opt->output_queue)
-      vrna_ostream_request(opt->output_queue, opt->next_record_number++);
+      vrna_ostream_request(opt->output_queue, record->number);
 
     RUN_IN_PARALLEL(process_record, record);
 
@@ -810,11 +843,13 @@ process_record(struct record_data *record)
   char                  *rec_sequence, *mfe_structure;
   double                min_en, energy;
   vrna_fold_compound_t  *vc;
+  vrna_arena_t          arena;
   struct output_stream  *o_stream;
 
-  opt = record->options;
+  opt   = record->options;
+  arena = record_arena();
 
-  rec_sequence = strdup(record->sequence);
+  rec_sequence = vrna_arena_strdup(arena, record->sequence);
 
   /* convert DNA alphabet to RNA if not explicitely switched off */
   if (!opt->noconv) {
@@ -830,6 +865,7 @@ process_record(struct record_data *record)
   if (!vc) {
     vrna_message_warning("Skipping computations for \"%s\"",
                          (record->id) ? record->id : "identifier unavailable");
+    vrna_arena_reset(arena);
     return;
   }
 
@@ -849,7 +885,7 @@ process_record(struct record_data *record)
   if (record->tty)
     vrna_message_info(stdout, "length = %d\n", length);
 
-  mfe_structure = (char *)vrna_alloc(sizeof(char) * (length + 1));
+  mfe_structure = (char *)vrna_arena_alloc(arena, sizeof(char) * (length + 1));
 
   /* parse the rest of the current dataset to obtain a structure constraint */
   if (fold_constrained) {
@@ -937,7 +973,8 @@ process_record(struct record_data *record)
     vrna_mx_mfe_free(vc);
 
   if (opt->pf) {
-    char *pf_struc = (char *)vrna_alloc(sizeof(char) * (length + 1));
+    double  mfe       = min_en;
+    char    *pf_struc = (char *)vrna_arena_alloc(arena, sizeof(char) * (length + 1));
     if (vc->params->model_details.dangles % 2) {
       int dang_bak = vc->params->model_details.dangles;
       vc->params->model_details.dangles = 2;   /* recompute with dangles as in pf_fold() */
@@ -970,6 +1007,22 @@ process_record(struct record_data *record)
                                  record->tty ? "\n free energy of ensemble = %6.2f kcal/mol" : " [%6.2f]",
                                  energy);
 
+      if (opt->prob_store) {
+        char *id = (record->SEQ_ID) ?
+                   strdup(record->SEQ_ID) :
+                   vrna_strdup_printf("sequence_%04u", record->number + 1);
+
+        /* the record is added along with the output to retain the input order */
+        o_stream->prob_store  = opt->prob_store;
+        o_stream->prob_record = vrna_prob_store_record_fc(id,
+                                                          vc,
+                                                          mfe_structure,
+                                                          mfe,
+                                                          energy,
+                                                          opt->bppmThreshold);
+        free(id);
+      }
+
       if (!opt->noDP) {
         char  *filename_dotplot;
         plist *pl1, *pl2;
@@ -1050,13 +1103,11 @@ process_record(struct record_data *record)
                                  energy,
                                  vrna_pr_energy(vc, min_en));
     }
-
-    free(pf_struc);
   }
 
   /* print what we've collected in output charstream */
   if (opt->output_queue) {
-    if (o_stream->individual) {
+    if ((o_stream->individual) && (!o_stream->prob_record)) {
       /* output immediately */
       ATOMIC_BLOCK(flush_cstr_callback(NULL, record->number, (void *)o_stream));
 
@@ -1074,8 +1125,9 @@ process_record(struct record_data *record)
   free(record->id);
   free(record->SEQ_ID);
   free(record->sequence);
-  free(rec_sequence);
-  free(mfe_structure);
+
+  /* release all record-scoped temporaries at once */
+  vrna_arena_reset(arena);
 
   /* free the rest of current dataset */
   if (record->rest) {
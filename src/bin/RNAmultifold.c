@@ -84,6 +84,7 @@ struct options {
   char            csv_output_delim;
 
   int             jobs;
+  int             complex_jobs;
   int             keep_order;
   unsigned int    next_record_number;
   vrna_ostream_t  output_queue;
@@ -155,6 +156,14 @@ compute_MEA(vrna_fold_compound_t  *fc,
             vrna_cstr_t           rec_output);
 
 
+static void
+print_complex_progress(size_t             done,
+                       size_t             total,
+                       const unsigned int *strands,
+                       size_t             size,
+                       void               *data);
+
+
 /*--------------------------------------------------------------------------*/
 
 void
@@ -195,6 +204,7 @@ init_default_options(struct options *opt)
   opt->csv_output_delim = ',';  /* delimiting character for one-line output */
 
   opt->jobs               = 1;
+  opt->complex_jobs       = 1;
   opt->keep_order         = 1;
   opt->next_record_number = 0;
   opt->output_queue       = NULL;
@@ -360,6 +370,10 @@ main(int  argc,
       opt.keep_order = 0;
   }
 
+  /* number of threads for the complex enumeration, 0 means all available cores */
+  if (args_info.complex_jobs_given)
+    opt.complex_jobs = MAX2(0, args_info.complex_jobs_arg);
+
   input_files = collect_unnamed_options(&args_info, &num_input);
 
   /* free allocated memory of command line data structure */
@@ -822,136 +836,33 @@ process_record(struct record_data *record)
       size_t        max_interacting_strands = vc->strands;
 
       unsigned int  ***complexes = (unsigned int ***)vrna_alloc(
-        sizeof(unsigned int **) * max_interacting_strands);
-      double        **dG_complexes = (double **)vrna_alloc(
-        sizeof(double *) * max_interacting_strands);
-
-      complexes     -= 1;
-      dG_complexes  -= 1;
-
-      for (size_t k = 1; k <= max_interacting_strands; k++) {
-        size_t num_complexes = 0;
+        sizeof(unsigned int **) * (max_interacting_strands + 1));
+      double        **dG_complexes;
 
-        /* enumerate all complexes of current size */
+      /* enumerate all complexes of each size */
+      for (size_t k = 1; k <= max_interacting_strands; k++)
         complexes[k] = vrna_n_multichoose_k(vc->strands, k);
 
-        /* count number of complexes of current size */
-        for (; complexes[k][num_complexes] != NULL; num_complexes++);
-
-        dG_complexes[k] = (double *)vrna_alloc(sizeof(double) * num_complexes);
-
-        char *verbose_line = NULL;
-
-        if (opt->verbose)
-          fprintf(stderr, "Processing complexes of size %lu\n", k);
-
-        for (size_t c_cnt = 0; c_cnt < num_complexes; c_cnt++) {
-          if (opt->verbose) {
-            vrna_strcat_printf(&verbose_line,
-                               "Complex %u/%u (size %d) ",
-                               c_cnt + 1,
-                               num_complexes, k);
-          }
-
-          /* Now, enumerate all non-cyclic permutations for current complex */
-
-          /* first, compose a list of species counts */
-          unsigned int  *species =
-            (unsigned int *)vrna_alloc(sizeof(unsigned int) * (k + 1));
-          unsigned int  *species_count = (unsigned int *)vrna_alloc(
-            sizeof(unsigned int) * vc->strands);
-          unsigned int  *mapping = (unsigned int *)vrna_alloc(
-            sizeof(unsigned int) * vc->strands);
-          size_t        known_species = 0;
-          for (size_t kk = 0; kk < k; kk++)
-            species_count[complexes[k][c_cnt][kk]]++;
-
-          for (size_t kk = 0; kk < vc->strands; kk++) {
-            if (species_count[kk] > 0) {
-              mapping[known_species]  = kk;
-              species[known_species]  = species_count[kk];
-
-              if (opt->verbose) {
-                vrna_strcat_printf(&verbose_line,
-                                   ", %u x %c",
-                                   species_count[kk],
-                                   kk < 26 ? kk + 'A' : kk + 'a');
-              }
-
-              known_species++;
-            }
-          }
-          species[known_species] = 0;
-
-          /* enumerate all non-cyclic permutations of current complex */
-          unsigned int  **permutations = vrna_enumerate_necklaces(species);
-
-          double        dG_current  = 0.;
-          size_t        num_perm    = 0;
-
-          if (opt->verbose)
-            for (; permutations[num_perm]; num_perm++);
-
-          for (size_t i = 0; permutations[i]; i++) {
-            char *current_sequence = NULL;
-
-            if (opt->verbose) {
-              fprintf(stderr, "\r%s, permutation %lu/%lu                    ",
-                      verbose_line,
-                      i + 1, num_perm);
-              fflush(stderr);
-            }
-
-            vrna_strcat_printf(&current_sequence,
-                               "%s",
-                               vc->nucleotides[mapping[permutations[i][1]]].string);
-
-            for (size_t j = 2; j <= k; j++) {
-              vrna_strcat_printf(&current_sequence,
-                                 "&%s",
-                                 vc->nucleotides[mapping[permutations[i][j]]].string);
-            }
-
-            /* for now, do not compute base pair probs */
-            int                   bpp_comp = opt->md.compute_bpp;
-            opt->md.compute_bpp = 0;
-
-            /* compute MFE and PF for current permutation */
-            vrna_fold_compound_t  *fc_current = vrna_fold_compound(current_sequence,
-                                                                   &(opt->md),
-                                                                   VRNA_OPTION_DEFAULT);
-
-            double                mfe_current = vrna_mfe(fc_current, NULL);
-
-            vrna_exp_params_rescale(fc_current, &mfe_current);
-
-            double                F = vrna_pf(fc_current, NULL);
-
-            /* store, or add up contribution from current permutation */
-            dG_current = (i == 0) ? F : vrna_pf_add(dG_current, F, kT);
-
-            free(current_sequence);
-            vrna_fold_compound_free(fc_current);
-
-            /* restore original base pair probs behavior */
-            opt->md.compute_bpp = bpp_comp;
-
-            free(permutations[i]);
-          }
-
-          free(species);
-          free(species_count);
-          free(mapping);
-          free(permutations);
+      if (opt->verbose) {
+        vrna_message_info(stderr,
+                          "Processing complexes of up to %lu strands",
+                          max_interacting_strands);
+      }
 
-          dG_complexes[k][c_cnt] = dG_current;
-          if (opt->verbose) {
-            free(verbose_line);
-            verbose_line = NULL;
-          }
-        }
-        if (opt->verbose)
-          fprintf(stderr, "\n");
+      /* compute ensemble free energies of all complexes, possibly in parallel */
+      dG_complexes = vrna_pf_complexes_cb(vc,
+                                          complexes,
+                                          max_interacting_strands,
+                                          &(opt->md),
+                                          opt->complex_jobs,
+                                          (opt->verbose) ? &print_complex_progress : NULL,
+                                          NULL);
+
+      if (!dG_complexes) {
+        vrna_message_warning("Failed to compute the ensemble free energies of the complexes");
+        free(concentrations);
+        concentrations = NULL;
+        goto cleanup_complexes;
       }
 
       vrna_cstr_printf_comment(o_stream->data, "Free Energies:");
@@ -1064,54 +975,60 @@ process_record(struct record_data *record)
                                "Initial concentrations\t\trelative Equilibrium concentrations\n"
                                "%s\t\t%s", monomer_string, complex_string);
 
-        double  *cc = (double *)vrna_alloc(sizeof(double) * num_strands);
+        /* solve all concentration points at once, cc receives the free strand concentrations */
+        double  *cc = (double *)vrna_alloc(sizeof(double) * (num_conc * num_strands + 1));
         double  *conc_complexes;
 
+        memcpy(cc, concentrations, sizeof(double) * num_conc * num_strands);
+
+        conc_complexes = vrna_equilibrium_conc_batch(equilibrium_constants_complexes,
+                                                     cc,
+                                                     num_conc,
+                                                     (const unsigned int **)A,
+                                                     num_strands,
+                                                     num_true_complexes,
+                                                     opt->complex_jobs);
+
         for (size_t c_i = 0; c_i < num_conc; c_i++) {
           char    *line = NULL;
           double  tot   = 0.;
+          double  *c0   = concentrations + (c_i * num_strands);
+          double  *cs   = cc + (c_i * num_strands);
+          double  *cx   = conc_complexes + (c_i * num_true_complexes);
 
-          memcpy(cc, concentrations + (c_i * num_strands), sizeof(double) * num_strands);
-
-          tot = cc[0];
+          tot = c0[0];
 
           /* prepare output line with initial concentration data */
-          vrna_strcat_printf(&line, "%-10g", cc[0]);
+          vrna_strcat_printf(&line, "%-10g", c0[0]);
 
           for (size_t i = 1; i < num_strands; i++) {
-            vrna_strcat_printf(&line, "\t%-10g", cc[i]);
-            tot += cc[i];
+            vrna_strcat_printf(&line, "\t%-10g", c0[i]);
+            tot += c0[i];
           }
 
-          conc_complexes = vrna_equilibrium_conc(equilibrium_constants_complexes,
-                                                 cc,
-                                                 (const unsigned int **)A,
-                                                 num_strands,
-                                                 num_true_complexes);
-
           /* append complex concentrations to output line */
           if (opt->concentration_absolute) {
             for (size_t i = 0; i < num_true_complexes; i++)
-              vrna_strcat_printf(&line, "\t%.6g", conc_complexes[i]);
+              vrna_strcat_printf(&line, "\t%.6g", cx[i]);
 
             /* append monomer concentrations to output line */
             for (size_t i = 0; i < num_strands; i++)
-              vrna_strcat_printf(&line, "\t%.6g", cc[i]);
+              vrna_strcat_printf(&line, "\t%.6g", cs[i]);
           } else {
             for (size_t i = 0; i < num_true_complexes; i++)
-              vrna_strcat_printf(&line, "\t%.6g", conc_complexes[i] / tot);
+              vrna_strcat_printf(&line, "\t%.6g", cx[i] / tot);
 
             /* append monomer concentrations to output line */
             for (size_t i = 0; i < num_strands; i++)
-              vrna_strcat_printf(&line, "\t%.6g", cc[i] / tot);
+              vrna_strcat_printf(&line, "\t%.6g", cs[i] / tot);
           }
 
           vrna_cstr_printf_tbody(o_stream->data, line);
 
           free(line);
-          free(conc_complexes);
         }
 
+        free(conc_complexes);
         free(cc);
         free(concentrations);
         free(equilibrium_constants_complexes);
@@ -1125,16 +1042,17 @@ process_record(struct record_data *record)
       free(complex_string);
       free(monomer_string);
 
+cleanup_complexes:
+
       /* major cleanup */
       for (size_t k = 1; k <= max_interacting_strands; k++) {
         for (size_t i = 0; complexes[k][i] != NULL; i++)
           free(complexes[k][i]);
         free(complexes[k]);
-        free(dG_complexes[k]);
+        if (dG_complexes)
+          free(dG_complexes[k]);
       }
 
-      complexes     += 1;
-      dG_complexes  += 1;
       free(complexes);
       free(dG_complexes);
 #if 0
@@ -1397,6 +1315,27 @@ compute_MEA(vrna_fold_compound_t  *fc,
 }
 
 
+/* report each finished complex on a single, continuously updated line */
+static void
+print_complex_progress(size_t             done,
+                       size_t             total,
+                       const unsigned int *strands,
+                       size_t             size,
+                       void               *data)
+{
+  (void)data;
+
+  fprintf(stderr, "\rComplex %lu/%lu (size %lu) ", done, total, size);
+
+  /* same strand naming as in the free energy output */
+  for (size_t k = 0; k < size; k++)
+    fputc((int)strands[k] + ((strands[k] > 25) ? 'a' : 'A'), stderr);
+
+  fprintf(stderr, "                    %s", (done == total) ? "\n" : "");
+  fflush(stderr);
+}
+
+
 static void
 compute_centroid(vrna_fold_compound_t *fc,
                  vrna_cstr_t          rec_output)
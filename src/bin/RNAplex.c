@@ -12,6 +12,7 @@
 #include <ctype.h>
 #include <dirent.h>
 #include <math.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -33,6 +34,7 @@
 #include "ViennaRNA/plotting/alignments.h"
 #include "ViennaRNA/params/io.h"
 #include "ViennaRNA/io/utils.h"
+#include "ViennaRNA/io/accessibility_store.h"
 #include "RNAplex_cmdl.h"
 
 
@@ -61,14 +63,15 @@ EndTimer(clock_t begin)
 extern int subopt_sorted;
 /* static int print_struc(duplexT const *dup); */
 static int **
-average_accessibility_target(char       **names,
-                             char       **ALN,
-                             int        number,
-                             char       *access,
-                             double     verhaeltnis,
-                             const int  alignment_length,
-                             int        binaries,
-                             int        fast);
+average_accessibility_target(char             **names,
+                             char             **ALN,
+                             int              number,
+                             char             *access,
+                             double           verhaeltnis,
+                             const int        alignment_length,
+                             int              binaries,
+                             int              fast,
+                             vrna_acc_store_t acc_store);
 
 
 /* static int ** average_accessibility_query(char **names, char **ALN, int number, char *access, double verhaeltnis); */
@@ -99,6 +102,19 @@ read_plfold_i_bin(char      *fname,
                   int       fast);
 
 
+/**
+ * Same as read_plfold_i_bin() but look up the opening energies in an accessibility store
+ */
+static int **
+read_plfold_i_store(vrna_acc_store_t  store,
+                    const char        *id,
+                    const int         beg,
+                    const int         end,
+                    double            verhaeltnis,
+                    const int         length,
+                    int               fast);
+
+
 /* Compute and pass opening energies in case of f=2*/
 static int
 get_sequence_length_from_alignment(char *sequence);
@@ -169,6 +185,47 @@ static int
 convert_plfold_i(char *fname);           /* convert test accessibility into bin accessibility. */
 
 
+/**
+ * Queries of a target that are scanned in parallel, see --jobs
+ */
+struct plex_queries {
+  int   num;
+  char  **seq;      /* NULL-terminated list of the queries */
+  int   ***access;  /* opening energies of the queries */
+  char  **header;   /* output preceding the duplexes of each query */
+  char  *pending;   /* output for the next query */
+};
+
+
+/**
+ * Print to stdout, or keep the output for the next query if queries are scanned in parallel
+ */
+static void
+queries_printf(struct plex_queries  *queries,
+               const char           *format,
+               ...);
+
+
+/**
+ * Add a query that is scanned once all queries of the target have been read
+ */
+static void
+queries_add(struct plex_queries *queries,
+            char                *s2,
+            int                 **access_s2);
+
+
+/**
+ * Scan the target for duplexes with all queries added so far and print them in input order
+ */
+static void
+queries_scan(struct plex_queries    *queries,
+             const char             *s1,
+             const int              **access_s1,
+             const vrna_plex_opt_t  *opt,
+             int                    jobs);
+
+
 static char scale[] = "....,....1....,....2....,....3....,....4"
                       "....,....5....,....6....,....7....,....8";
 
@@ -189,6 +246,7 @@ main(int  argc,
   char                            *tname  = NULL;
   char                            *qname  = NULL;
   char                            *access = NULL;
+  vrna_acc_store_t                acc_store = NULL;
   char                            fname[FILENAME_MAX_LENGTH];
   char                            *ParamFile = NULL;
   char                            *ns_bases = NULL, *c;
@@ -228,6 +286,8 @@ main(int  argc,
   double                          k_concentration     = 0;
   double                          tris_concentration  = 0;
   int                             probe_mode          = 0;
+  int                             jobs                = 0;
+  struct plex_queries             query_list, *queries = NULL;
   /*
    #############################################
    # check the command line parameters
@@ -288,6 +348,18 @@ main(int  argc,
   if (args_info.convert_to_bin_given)
     convert = 1;
 
+  /*accessibility store*/
+  if (args_info.accessibility_store_given) {
+    acc_store = vrna_acc_store_open(args_info.accessibility_store_arg);
+    if (!acc_store)
+      vrna_message_error("Failed to open accessibility store %s",
+                         args_info.accessibility_store_arg);
+
+    /* switch on accessibility mode */
+    if (!access)
+      access = strdup(args_info.accessibility_store_arg);
+  }
+
   /*alignment_mode*/
   if (args_info.alignment_mode_given)
     alignment_mode = 1;
@@ -304,6 +376,18 @@ main(int  argc,
   k_concentration = args_info.k_concentration_arg;
   /*tris concentration*/
   tris_concentration = args_info.tris_concentration_arg;
+
+  if (args_info.jobs_given) {
+    /* only the plain duplex scans are reentrant, see vrna_plex_batch() */
+    if ((fold_constrained) || (alignment_mode))
+      vrna_message_error("Option --jobs can not be combined with constraints or the alignment mode");
+
+    /* 0 selects the number of threads of the OpenMP runtime */
+    jobs    = args_info.jobs_arg;
+    queries = &query_list;
+    memset(queries, 0, sizeof(struct plex_queries));
+  }
+
   /*probe concentration*/
   probe_concentration = args_info.probe_concentration_arg;
 
@@ -340,6 +424,9 @@ main(int  argc,
 
   int il_a, il_b, b_a, b_b;
   linear_fit(&il_a, &il_b, &b_a, &b_b);
+  vrna_plex_opt_t plex_opt = {
+    delta, alignment_length, deltaz, extension_cost, fast, il_a, il_b, b_a, b_b
+  };
   /**
    * check if we have two input files
    */
@@ -443,7 +530,7 @@ main(int  argc,
     return 0;
   }
 
-  if (convert && access) {
+  if (convert && access && !acc_store) {
     char          pattern[8];
     strcpy(pattern, "_openen");
     DIR           *dfd;
@@ -666,7 +753,10 @@ main(int  argc,
           strcat(file_s1, "/");
           strcat(file_s1, id_s1);
           strcat(file_s1, "_openen");
-          if (!binaries) {
+          if (acc_store) {
+            access_s1 =
+              read_plfold_i_store(acc_store, id_s1, 1, s1_len, verhaeltnis, alignment_length, fast);
+          } else if (!binaries) {
             access_s1 = read_plfold_i(file_s1, 1, s1_len, verhaeltnis, alignment_length, fast);
           } else {
             strcat(file_s1, "_bin");
@@ -741,7 +831,10 @@ main(int  argc,
             strcat(file_s2, "/");
             strcat(file_s2, id_s2);
             strcat(file_s2, "_openen");
-            if (!binaries) {
+            if (acc_store) {
+              access_s2 =
+                read_plfold_i_store(acc_store, id_s2, 1, s2_len, verhaeltnis, alignment_length, fast);
+            } else if (!binaries) {
               access_s2 = read_plfold_i(file_s2, 1, s2_len, verhaeltnis, alignment_length, fast);
             } else {
               strcat(file_s2, "_bin");
@@ -750,7 +843,9 @@ main(int  argc,
             }
 
             if (access_s2 == NULL) {
-              printf("Accessibility file %s not found, look at next target RNA\n", file_s2);
+              queries_printf(queries,
+                             "Accessibility file %s not found, look at next target RNA\n",
+                             file_s2);
               free(file_s2);
               free(s2);
               free(id_s2);
@@ -758,7 +853,15 @@ main(int  argc,
               continue;
             }
 
-            printf(">%s\n>%s\n", id_s1, id_s2);
+            queries_printf(queries, ">%s\n>%s\n", id_s1, id_s2);
+            if (queries) {
+              queries_add(queries, s2, access_s2);
+              free(id_s2);
+              free(file_s2);
+              id_s2 = NULL;
+              continue;
+            }
+
             double begin = BeginTimer();
             Lduplexfold_XS(s1,
                            s2,
@@ -786,6 +889,9 @@ main(int  argc,
               free(access_s2[i]);
             free(access_s2);
           } while (1);
+          if (queries)
+            queries_scan(queries, s1, (const int **)access_s1, &plex_opt, jobs);
+
           free(id_s1);
           id_s1 = NULL;
           free(file_s1);
@@ -914,7 +1020,14 @@ main(int  argc,
               if (!noconv && s2[l] == 'T')
                 s2[l] = 'U';
             }
-            printf(">%s\n>%s\n", id_s1, id_s2);
+            queries_printf(queries, ">%s\n>%s\n", id_s1, id_s2);
+            if (queries) {
+              queries_add(queries, s2, NULL);
+              free(id_s2);
+              id_s2 = NULL;
+              continue;
+            }
+
             /*             double begin = BeginTimer(); */
             Lduplexfold(s1,
                         s2,
@@ -939,6 +1052,9 @@ main(int  argc,
             id_s2 = NULL;
             free(s2);
           } while (1);
+          if (queries)
+            queries_scan(queries, s1, NULL, &plex_opt, jobs);
+
           free(id_s1);
           id_s1 = NULL;
           free(s1);
@@ -1022,7 +1138,10 @@ main(int  argc,
           strcat(file_s1, "/");
           strcat(file_s1, id_s1);
           strcat(file_s1, "_openen");
-          if (!binaries) {
+          if (acc_store) {
+            access_s1 =
+              read_plfold_i_store(acc_store, id_s1, 1, s1_len, verhaeltnis, alignment_length, fast);
+          } else if (!binaries) {
             access_s1 = read_plfold_i(file_s1, 1, s1_len, verhaeltnis, alignment_length, fast);
           } else {
             strcat(file_s1, "_bin");
@@ -1116,7 +1235,10 @@ main(int  argc,
             strcat(file_s2, "/");
             strcat(file_s2, id_s2);
             strcat(file_s2, "_openen");
-            if (!binaries) {
+            if (acc_store) {
+              access_s2 =
+                read_plfold_i_store(acc_store, id_s2, 1, s2_len, verhaeltnis, alignment_length, fast);
+            } else if (!binaries) {
               access_s2 = read_plfold_i(file_s2, 1, s2_len, verhaeltnis, alignment_length, fast);
             } else {
               strcat(file_s2, "_bin");
@@ -1510,7 +1632,10 @@ main(int  argc,
         strcat(file_s2, id_s2);
         strcat(file_s1, "_openen");
         strcat(file_s2, "_openen");
-        if (!binaries) {
+        if (acc_store) {
+          access_s1 =
+            read_plfold_i_store(acc_store, id_s1, 1, s1_len, verhaeltnis, alignment_length, fast);
+        } else if (!binaries) {
           access_s1 = read_plfold_i(file_s1, 1, s1_len, verhaeltnis, alignment_length, fast);
         } else {
           strcat(file_s1, "_bin");
@@ -1527,7 +1652,10 @@ main(int  argc,
           continue;
         }
 
-        if (!binaries) {
+        if (acc_store) {
+          access_s2 =
+            read_plfold_i_store(acc_store, id_s2, 1, s2_len, verhaeltnis, alignment_length, fast);
+        } else if (!binaries) {
           access_s2 = read_plfold_i(file_s2, 1, s2_len, verhaeltnis, alignment_length, fast);
         } else {
           strcat(file_s2, "_bin");
@@ -1682,7 +1810,8 @@ main(int  argc,
                                                    verhaeltnis,
                                                    alignment_length,
                                                    binaries,
-                                                   fast);                                                                      /* get averaged accessibility for alignments */
+                                                   fast,
+                                                   acc_store);                                                                      /* get averaged accessibility for alignments */
       query_access = average_accessibility_target(names2,
                                                   AS2,
                                                   n_seq,
@@ -1690,7 +1819,8 @@ main(int  argc,
                                                   verhaeltnis,
                                                   alignment_length,
                                                   binaries,
-                                                  fast);
+                                                  fast,
+                                                  acc_store);
       if (!(target_access && query_access)) {
         for (i = 0; AS1[i]; i++) {
           free(AS1[i]);
@@ -1742,6 +1872,8 @@ main(int  argc,
     access = NULL;
   }
 
+  vrna_acc_store_close(acc_store);
+
   if (qname) {
     free(tname);
     access = NULL;
@@ -2028,6 +2160,157 @@ read_plfold_i_bin(char      *fname,
 }
 
 
+static int **
+read_plfold_i_store(vrna_acc_store_t  store,
+                    const char        *id,
+                    const int         beg,
+                    const int         end,
+                    double            verhaeltnis,
+                    const int         length,
+                    int               fast)
+{
+  unsigned int  seqlength, lim_x;
+  int           **access, count, p, from, to;
+  const int     *e;
+
+  if ((!id) || (!vrna_acc_store_find(store, id, &seqlength, &lim_x))) {
+    vrna_message_warning("No accessibility profile for '%s' in accessibility store", id);
+    return NULL;
+  }
+
+  if (length > (int)lim_x && fast == 0) {
+    printf(
+      "Interaction length %d is larger than the length of the largest region %d \nfor which the opening energy was computed (-u parameter of RNAplfold)\n",
+      length,
+      lim_x);
+    printf(
+      "Please recompute your profiles with a larger -u or set -l to a smaller interaction length\n");
+    return NULL;
+  }
+
+  /*
+   * reproduce the layout of binary opening energy files, i.e. each line
+   * is padded by 11 (leading) and 9 (trailing) entries of 1000000, and
+   * the first line holds the u length and the sequence length
+   */
+  access = (int **)vrna_alloc(sizeof(int *) * (lim_x + 1));
+
+  for (count = 0; count < (int)lim_x + 1; count++) {
+    access[count] = (int *)vrna_alloc(sizeof(int) * (end - beg + 1));
+    for (p = 0; p <= end - beg; p++)
+      access[count][p] = 1000000;
+  }
+
+  if ((beg <= 2) && (end >= 2))
+    access[0][2 - beg] = seqlength;
+
+  /* line positions beg..end correspond to sequence positions beg - 11..end - 11 */
+  from  = MAX2(beg - 11, 1);
+  to    = MIN2(end - 11, (int)seqlength);
+
+  if (from <= to) {
+    for (count = 1; count <= (int)lim_x; count++) {
+      e = vrna_acc_store_window(store, id, count, from, to);
+      memcpy(access[count] + from + 11 - beg, e, sizeof(int) * (to - from + 1));
+    }
+  }
+
+  access[0][0] = lim_x + 1;
+
+  return access;
+}
+
+
+static void
+queries_printf(struct plex_queries  *queries,
+               const char           *format,
+               ...)
+{
+  va_list args;
+
+  va_start(args, format);
+
+  if (queries)
+    vrna_strcat_vprintf(&(queries->pending), format, args);
+  else
+    vprintf(format, args);
+
+  va_end(args);
+}
+
+
+static void
+queries_add(struct plex_queries *queries,
+            char                *s2,
+            int                 **access_s2)
+{
+  int n = queries->num;
+
+  queries->seq    = (char **)vrna_realloc(queries->seq, sizeof(char *) * (n + 2));
+  queries->access = (int ***)vrna_realloc(queries->access, sizeof(int **) * (n + 1));
+  queries->header = (char **)vrna_realloc(queries->header, sizeof(char *) * (n + 1));
+
+  queries->seq[n]     = s2;
+  queries->seq[n + 1] = NULL;
+  queries->access[n]  = access_s2;
+  queries->header[n]  = queries->pending;
+  queries->pending    = NULL;
+  queries->num++;
+}
+
+
+static void
+queries_scan(struct plex_queries    *queries,
+             const char             *s1,
+             const int              **access_s1,
+             const vrna_plex_opt_t  *opt,
+             int                    jobs)
+{
+  int       q, i;
+  char      **results = NULL;
+  vrna_md_t md;
+
+  set_model_details(&md);
+
+  if (queries->num > 0)
+    results = vrna_plex_batch(s1,
+                              access_s1,
+                              (const char **)queries->seq,
+                              (const int ***)queries->access,
+                              &md,
+                              opt,
+                              jobs);
+
+  for (q = 0; q < queries->num; q++) {
+    printf("%s", queries->header[q]);
+    if (results) {
+      printf("%s", results[q]);
+      free(results[q]);
+    }
+
+    if (queries->access[q]) {
+      i = queries->access[q][0][0];
+      while (--i > -1)
+        free(queries->access[q][i]);
+      free(queries->access[q]);
+    }
+
+    free(queries->header[q]);
+    free(queries->seq[q]);
+  }
+
+  if (queries->pending)
+    printf("%s", queries->pending);
+
+  free(results);
+  free(queries->seq);
+  free(queries->access);
+  free(queries->header);
+  free(queries->pending);
+  memset(queries, 0, sizeof(struct plex_queries));
+}
+
+
 static int
 get_max_u(const char  *s,
           char        delim)
@@ -2047,14 +2330,15 @@ get_max_u(const char  *s,
 
 
 static int **
-average_accessibility_target(char       **names,
-                             char       **ALN,
-                             int        number,
-                             char       *access,
-                             double     verhaeltnis,
-                             const int  alignment_length,
-                             int        binaries,
-                             int        fast)
+average_accessibility_target(char             **names,
+                             char             **ALN,
+                             int              number,
+                             char             *access,
+                             double           verhaeltnis,
+                             const int        alignment_length,
+                             int              binaries,
+                             int              fast,
+                             vrna_acc_store_t acc_store)
 {
   int           i;
   int           ***master_access  = NULL;           /* contains the accessibility arrays for different */
@@ -2151,7 +2435,15 @@ average_accessibility_target(char       **names,
     }
 
     strcat(file_s1, "_openen");
-    if (!binaries) {
+    if (acc_store) {
+      master_access[i] = read_plfold_i_store(acc_store,
+                                             (location_flag) ? bla : names[i],
+                                             begin,
+                                             end,
+                                             verhaeltnis,
+                                             alignment_length,
+                                             fast);                                             /* look up */
+    } else if (!binaries) {
       master_access[i] = read_plfold_i(file_s1, begin, end, verhaeltnis, alignment_length, fast); /* read */
     } else {
       strcat(file_s1, "_bin");
@@ -28,6 +28,8 @@
 #include "ViennaRNA/constraints/SHAPE.h"
 #include "ViennaRNA/io/file_formats.h"
 #include "ViennaRNA/io/utils.h"
+#include "ViennaRNA/io/accessibility_store.h"
+#include "ViennaRNA/io/probability_store.h"
 #include "ViennaRNA/commands.h"
 #include "RNAplfold_cmdl.h"
 #include "gengetopt_helper.h"
@@ -132,6 +134,23 @@ print_pu_bin(vrna_fold_compound_t *fc,
              int                  ulength);
 
 
+PRIVATE int
+store_pu(vrna_acc_store_t     store,
+         const char           *id,
+         vrna_fold_compound_t *fc,
+         plfold_data          *data,
+         int                  ulength);
+
+
+PRIVATE int
+store_probs(vrna_prob_store_t     store,
+            const char            *id,
+            const char            *sequence,
+            vrna_fold_compound_t  *fc,
+            plfold_data           *data,
+            int                   ulength);
+
+
 /*--------------------------------------------------------------------------*/
 int
 main(int  argc,
@@ -142,6 +161,8 @@ main(int  argc,
   char                        *structure, *ParamFile, *ns_bases, *rec_sequence, *rec_id,
                               **rec_rest, *orig_sequence, *filename_delim, *command_file,
                               *shape_file, *shape_method, *shape_conversion;
+  vrna_acc_store_t            acc_store;
+  vrna_prob_store_t           prob_store;
   unsigned int                rec_type, read_opt;
   int                         length, istty, winsize, pairdist, tempwin, temppair, tempunpaired,
                               noconv, i, plexoutput, simply_putout, openenergies, binaries,
@@ -170,6 +191,8 @@ main(int  argc,
   command_file  = NULL;
   commands      = NULL;
   verbose       = 0;
+  acc_store     = NULL;
+  prob_store    = NULL;
 
   set_model_details(&md);
 
@@ -295,6 +318,22 @@ main(int  argc,
   if (args_info.commands_given)
     command_file = strdup(args_info.commands_arg);
 
+  /* collect opening energies of all sequences in a single file */
+  if (args_info.accessibility_store_given) {
+    acc_store = vrna_acc_store_create(args_info.accessibility_store_arg);
+    if (!acc_store)
+      vrna_message_error("Failed to create accessibility store %s",
+                         args_info.accessibility_store_arg);
+  }
+
+  /* collect pair and unpaired probabilities of all sequences in a single file */
+  if (args_info.probability_store_given) {
+    prob_store = vrna_prob_store_create(args_info.probability_store_arg);
+    if (!prob_store)
+      vrna_message_error("Failed to create probability store %s",
+                         args_info.probability_store_arg);
+  }
+
   /* free allocated memory of command line data structure */
   RNAplfold_cmdline_parser_free(&args_info);
 
@@ -317,7 +356,7 @@ main(int  argc,
     commands = vrna_file_commands_read(command_file, VRNA_CMD_PARSE_HC | VRNA_CMD_PARSE_SC);
 
   /* check parameter options again and reset to reasonable values if needed */
-  if (openenergies && !unpaired)
+  if ((openenergies || acc_store) && !unpaired)
     unpaired = 31;
 
   if (pairdist == 0)
@@ -403,6 +442,18 @@ main(int  argc,
       simply_putout = 0;
     }
 
+    if ((simply_putout) && (acc_store)) {
+      vrna_message_warning("accessibility store not available in simple output mode!\n"
+                           "Switching back to full mode instead!");
+      simply_putout = 0;
+    }
+
+    if ((simply_putout) && (prob_store)) {
+      vrna_message_warning("probability store not available in simple output mode!\n"
+                           "Switching back to full mode instead!");
+      simply_putout = 0;
+    }
+
     /* restore winsize if altered before */
     if (tempwin != 0) {
       winsize = tempwin;
@@ -554,6 +605,14 @@ main(int  argc,
         /* create dot plot output */
         PS_dot_plot_turn(orig_sequence, data.plist, ffname, pairdist);
 
+        if ((prob_store) &&
+            (!store_probs(prob_store, SEQ_ID, rec_sequence, fc, &data, unpaired))) {
+          vrna_message_warning("Failed to add probabilities of %s to probability store! "
+                               "Aborting now...",
+                               SEQ_ID);
+          goto rnaplfold_exit;
+        }
+
         /* print unpaired probabilities */
         if (unpaired > 0) {
           if (plexoutput) {
@@ -564,8 +623,20 @@ main(int  argc,
 
           /* print unpaired probabilities to file */
 
-          data.pUfp = fopen(openenergies ? fname4 : fname1, "w");
-          if (binaries) {
+          if (acc_store) {
+            if (!store_pu(acc_store, SEQ_ID, fc, &data, unpaired)) {
+              vrna_message_warning("Failed to add opening energies of %s to accessibility store! "
+                                   "Aborting now...",
+                                   SEQ_ID);
+              goto rnaplfold_exit;
+            }
+          } else {
+            data.pUfp = fopen(openenergies ? fname4 : fname1, "w");
+          }
+
+          if (acc_store) {
+            /* nothing to do, opening energies have been added to the store already */
+          } else if (binaries) {
             print_pu_bin(fc, &data, unpaired);
           } else {
             prepare_up_file(&data);
@@ -583,7 +654,9 @@ main(int  argc,
             }
           }
 
-          fclose(data.pUfp);
+          if (data.pUfp)
+            fclose(data.pUfp);
+
           data.pUfp = NULL;
 
           for (i = 0; i <= length; i++)
@@ -635,6 +708,12 @@ main(int  argc,
 
 rnaplfold_exit:
 
+  if ((acc_store) && (!vrna_acc_store_close(acc_store)))
+    vrna_message_warning("Failed to finalize accessibility store!");
+
+  if ((prob_store) && (!vrna_prob_store_close(prob_store)))
+    vrna_message_warning("Failed to finalize probability store!");
+
   free(filename_delim);
   free(command_file);
   free(shape_method);
@@ -895,3 +974,92 @@ putoutphakim_u(vrna_fold_compound_t *fc,
 
   fflush(fp);
 }
+
+
+PRIVATE int
+store_pu(vrna_acc_store_t     store,
+         const char           *id,
+         vrna_fold_compound_t *fc,
+         plfold_data          *data,
+         int                  ulength)
+{
+  unsigned int  length;
+  int           i, k, **e, ret;
+  double        kT = fc->exp_params->kT / 1000.0;
+
+  length = fc->length;
+
+  /* use the same conversion and placeholders as the binary opening energy files */
+  e = (int **)vrna_alloc(sizeof(int *) * (ulength + 1));
+
+  for (i = 1; i <= ulength; i++) {
+    e[i] = (int *)vrna_alloc(sizeof(int) * (length + 1));
+    for (k = 1; k <= length; k++)
+      e[i][k] = (i > k) ? 1000000 : (int)rint(100 * (-log(data->pup[k][i]) * kT));
+  }
+
+  ret = vrna_acc_store_add(store, id, length, ulength, (const int **)e);
+
+  for (i = 1; i <= ulength; i++)
+    free(e[i]);
+
+  free(e);
+
+  return ret;
+}
+
+
+PRIVATE int
+store_probs(vrna_prob_store_t     store,
+            const char            *id,
+            const char            *sequence,
+            vrna_fold_compound_t  *fc,
+            plfold_data           *data,
+            int                   ulength)
+{
+  unsigned int              length;
+  int                       i, k, ret;
+  double                    *up;
+  vrna_md_t                 *md;
+  vrna_prob_store_record_t  record;
+
+  length  = fc->length;
+  md      = &(fc->exp_params->model_details);
+  up      = NULL;
+
+  /* unpaired probabilities of stretches that would exceed the sequence start are set to 0 */
+  if (ulength > 0) {
+    up = (double *)vrna_alloc(sizeof(double) * ulength * length);
+    for (i = 1; i <= ulength; i++)
+      for (k = i; k <= (int)length; k++)
+        up[(i - 1) * length + (k - 1)] = data->pup[k][i];
+  }
+
+  memset(&record, 0, sizeof(vrna_prob_store_record_t));
+
+  record.id               = id;
+  record.sequence         = sequence;
+  record.length           = length;
+  record.ulength          = ulength;
+  record.n_pairs          = data->plist_cnt;
+  record.pairs            = data->plist;
+  record.unpaired         = up;
+  record.mfe              = NAN;
+  record.ensemble_energy  = NAN;
+  record.cutoff           = data->cutoff;
+  record.temperature      = md->temperature;
+  record.dangles          = md->dangles;
+  record.noLP             = md->noLP;
+  record.noGU             = md->noGU;
+  record.circ             = md->circ;
+  record.gquad            = md->gquad;
+  record.window_size      = md->window_size;
+  record.max_bp_span      = md->max_bp_span;
+  record.n_seq            = 1;
+
+  ret = vrna_prob_store_add(store, &record);
+
+  free(up);
+
+  return ret;
+}
@@ -21,6 +21,10 @@
 #include <float.h>
 #include "ViennaRNA/fold.h"
 #include "ViennaRNA/fold_vars.h"
+#include "ViennaRNA/model.h"
+#include "ViennaRNA/fold_compound.h"
+#include "ViennaRNA/mfe.h"
+#include "ViennaRNA/params/basic.h"
 #include "ViennaRNA/params/io.h"
 #include "ViennaRNA/plotting/probabilities.h"
 #include "ViennaRNA/utils/basic.h"
@@ -33,12 +37,89 @@
 #include "ViennaRNA/constraints/basic.h"
 #include "ViennaRNA/constraints/hard.h"
 #include "ViennaRNA/constraints/soft.h"
+#include "ViennaRNA/datastructures/char_stream.h"
+#include "ViennaRNA/datastructures/stream_output.h"
 #include "RNAup_cmdl.h"
+#include "parallel_helpers.h"
 
 #define MIN(x, y) (((x) < (y)) ? (x) : (y))
 #define MAX(x, y) (((x) > (y)) ? (x) : (y))
 #define EQUAL(A, B) (fabs((A)-(B)) < 1000 * DBL_EPSILON)
 
+/* settings shared by all records of the interaction mode using the first sequence only */
+struct options {
+  vrna_md_t       md;
+  int             w;
+  int             incr3;
+  int             incr5;
+  int             output;
+  int             header;
+  int             **unpaired_values;
+  char            *my_contrib;
+  char            *cmdl_parameters;
+
+  /* the first sequence, its constraint and opening energies */
+  char            *s_target;
+  char            *orig_target;
+  char            *cstruc_target;
+  char            *fname_target;
+  int             length_target;
+  pu_contrib      *unstr_target;
+
+  int             jobs;
+  int             keep_order;
+  unsigned int    next_record_number;
+  vrna_ostream_t  output_queue;
+};
+
+
+struct record_data {
+  unsigned int    number;
+  char            **headers;  /* FASTA headers that preceded the sequence */
+  char            *s1;
+  char            *orig_s1;
+  char            *cstruc1;
+  char            *fname1;
+  char            *up_out;
+  struct options  *options;
+};
+
+
+struct output_stream {
+  vrna_cstr_t data;
+  vrna_cstr_t err;
+};
+
+
+PRIVATE void
+process_record(struct record_data *record);
+
+
+PRIVATE pu_contrib *
+compute_unstru(const char *s,
+               const char *cstruc,
+               int        w,
+               vrna_md_t  *md,
+               vrna_cstr_t err);
+
+
+static void
+flush_cstr_callback(void          *auxdata,
+                    unsigned int  i,
+                    void          *data)
+{
+  struct output_stream *s = (struct output_stream *)data;
+
+  /* flush/free errors first */
+  vrna_cstr_free(s->err);
+
+  /* flush/free data[k] */
+  vrna_cstr_free(s->data);
+
+  free(s);
+}
+
+
 PRIVATE void
 tokenize(char *line,
          char **seq1,
@@ -53,14 +134,17 @@ seperate_bp(char  **inter,
 
 
 PRIVATE void
-print_interaction(interact    *Int,
+print_interaction(vrna_cstr_t stream,
+                  vrna_cstr_t err,
+                  interact    *Int,
                   char        *s1,
                   char        *s2,
                   pu_contrib  *p_c,
                   pu_contrib  *p_c2,
                   int         w,
                   int         incr3,
-                  int         incr5);
+                  int         incr5,
+                  vrna_md_t   *md);
 
 
 PRIVATE void
@@ -100,13 +184,15 @@ main(int  argc,
                           *cstruc1,
                           *cstruc2, *cstruc_target, *cstruc_combined, *cmdl_parameters, *orig_s1,
                           *orig_s2,
-                          *orig_target;
+                          *orig_target, **headers;
   int         i, j, length1, length2, length_target, sym, istty,
               noconv, max_u, **unpaired_values, ulength_num;
+  unsigned int  num_headers;
   double      min_en, sfact;
+  struct options  opt;
 
   /* variables for output */
-  pu_contrib  *unstr_out, *unstr_short, *unstr_target, *contrib1, *contrib2;
+  pu_contrib  *unstr_out, *unstr_short, *contrib1, *contrib2;
   interact    *inter_out;
   /* pu_out *longer; */
 
@@ -135,10 +221,16 @@ main(int  argc,
     NULL;
   length1         = length2 = length_target = 0;
   inter_out       = NULL;
-  unstr_out       = unstr_short = unstr_target = contrib1 = contrib2 = NULL;
+  unstr_out       = unstr_short = contrib1 = contrib2 = NULL;
   structure       = ParamFile = ns_bases = head = orig_s1 = orig_s2 = orig_target = NULL;
   up_out          = NULL;
   fname_target[0] = '\0';
+  headers         = NULL;
+  num_headers     = 0;
+
+  memset(&opt, 0, sizeof(struct options));
+  opt.jobs        = 1;
+  opt.keep_order  = 1;
   /* allocate init length for commandline parameter string */
 
   cmdl_parameters = NULL;
@@ -300,6 +392,39 @@ main(int  argc,
       vrna_strcat_printf(&cmdl_parameters, "-c %s ", my_contrib);
   }
 
+  if (args_info.jobs_given) {
+#if VRNA_WITH_PTHREADS
+    int thread_max = max_user_threads();
+    if (args_info.jobs_arg == 0) {
+      /* use maximum of concurrent threads */
+      int proc_cores, proc_cores_conf;
+      if (num_proc_cores(&proc_cores, &proc_cores_conf)) {
+        opt.jobs = MIN2(thread_max, proc_cores_conf);
+      } else {
+        vrna_message_warning("Could not determine number of available processor cores!\n"
+                             "Defaulting to serial computation");
+        opt.jobs = 1;
+      }
+    } else {
+      opt.jobs = MIN2(thread_max, args_info.jobs_arg);
+    }
+
+    opt.jobs = MAX2(1, opt.jobs);
+#else
+    vrna_message_warning(
+      "This version of RNAup has been built without parallel input processing capabilities");
+#endif
+
+    if (!(up_mode & RNA_UP_MODE_3)) {
+      vrna_message_warning("Parallel processing is only available in interaction mode using "
+                           "the first sequence only, falling back to serial computation");
+      opt.jobs = 1;
+    }
+
+    if (args_info.unordered_given)
+      opt.keep_order = 0;
+  }
+
   /* set length(s) of unpaired (unstructured) region(s) */
   int min, max, tmp;
 
@@ -410,6 +535,26 @@ main(int  argc,
   }
 
   RT = ((temperature + K0) * GASCONST / 1000.0);
+
+  /* collect the settings required for the interaction mode using the first sequence only */
+  set_model_details(&(opt.md));
+  opt.md.compute_bpp    = 1;
+  opt.md.sfact          = sfact;
+  opt.w                 = w;
+  opt.incr3             = incr3;
+  opt.incr5             = incr5;
+  opt.output            = output;
+  opt.header            = header;
+  opt.unpaired_values   = unpaired_values;
+  opt.my_contrib        = my_contrib;
+  opt.cmdl_parameters   = cmdl_parameters;
+  opt.fname_target      = fname_target;
+
+  if ((up_mode & RNA_UP_MODE_3) && (opt.keep_order))
+    opt.output_queue = vrna_ostream_init(&flush_cstr_callback, NULL);
+
+  INIT_PARALLELIZATION(opt.jobs);
+
   /*
    #############################################
    # main loop: continue until end of file
@@ -454,8 +599,15 @@ main(int  argc,
     /* extract filename from fasta header if available */
     while ((input_type = get_input_line(&input_string, 0)) & VRNA_INPUT_FASTA_HEADER) {
       (void)sscanf(input_string, "%" XSTR(FILENAME_ID_LENGTH) "s", fname1);
-      printf(">%s\n", input_string); /* print fasta header if available */
-      free(input_string);
+      if (up_mode & RNA_UP_MODE_3) {
+        /* collect FASTA headers, they are printed along with the results */
+        headers                 = (char **)vrna_realloc(headers, sizeof(char *) * (num_headers + 2));
+        headers[num_headers++]  = input_string;
+        headers[num_headers]    = NULL;
+      } else {
+        printf(">%s\n", input_string); /* print fasta header if available */
+        free(input_string);
+      }
     }
 
     /* break on any error, EOF or quit request */
@@ -506,8 +658,15 @@ main(int  argc,
       /* extract filename from fasta header if available */
       while ((input_type = get_input_line(&input_string, 0)) & VRNA_INPUT_FASTA_HEADER) {
         (void)sscanf(input_string, "%" XSTR(FILENAME_ID_LENGTH) "s", fname2);
-        printf(">%s\n", input_string); /* print fasta header if available */
-        free(input_string);
+        if (up_mode & RNA_UP_MODE_3) {
+          /* collect FASTA headers, they are printed along with the results */
+          headers                 = (char **)vrna_realloc(headers, sizeof(char *) * (num_headers + 2));
+          headers[num_headers++]  = input_string;
+          headers[num_headers]    = NULL;
+        } else {
+          printf(">%s\n", input_string); /* print fasta header if available */
+          free(input_string);
+        }
       }
       /* break on any error, EOF or quit request */
       if (input_type & (VRNA_INPUT_QUIT | VRNA_INPUT_ERROR))
@@ -673,6 +832,53 @@ main(int  argc,
     if (!(up_mode & RNA_UP_MODE_1))
       vrna_strcat_printf(&up_out, "_w%d", w);
 
+    if (up_mode & RNA_UP_MODE_3) {
+      /*
+       * the opening energies of the first sequence are computed only once,
+       * every other sequence is processed as a record of its own
+       */
+      if (opt.unstr_target == NULL) {
+        int         wplus = w + incr3 + incr5;
+        vrna_cstr_t err   = vrna_cstr(256, stderr);
+
+        if (max_u > wplus)
+          wplus = max_u;
+
+        if (length_target < wplus)
+          wplus = length_target;
+
+        opt.s_target      = s_target;
+        opt.orig_target   = orig_target;
+        opt.cstruc_target = cstruc_target;
+        opt.length_target = length_target;
+        opt.unstr_target  = compute_unstru(s_target, cstruc_target, wplus, &(opt.md), err);
+
+        vrna_cstr_free(err);
+      }
+
+      struct record_data *record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
+
+      record->number  = opt.next_record_number;
+      record->headers = headers;
+      record->s1      = s1;
+      record->orig_s1 = orig_s1;
+      record->cstruc1 = cstruc1;
+      record->fname1  = strdup(fname1);
+      record->up_out  = up_out;
+      record->options = &opt;
+
+      headers     = NULL;
+      num_headers = 0;
+      s1          = orig_s1 = cstruc1 = up_out = NULL;
+
+      if (opt.output_queue)
+        vrna_ostream_request(opt.output_queue, opt.next_record_number++);
+
+      RUN_IN_PARALLEL(process_record, record);
+
+      continue;
+    }
+
     structure =
       (char *)vrna_alloc(sizeof(char) * (MAX2(length_target, MAX2(length1, length2)) + 1));
 
@@ -690,19 +896,16 @@ main(int  argc,
 
     /* calc probability to be unstructured for 1st sequence (in upmode=3 this is not the target!) */
 
-    int wplus = w;
-    if (!(up_mode & RNA_UP_MODE_3)) {
-      wplus += incr3 + incr5;
-      /* reset window size if maximum unstructured region is exceeds it */
-      if (max_u > wplus)
-        wplus = max_u;
-    }
+    int wplus = w + incr3 + incr5;
+    /* reset window size if maximum unstructured region is exceeds it */
+    if (max_u > wplus)
+      wplus = max_u;
 
     /* reset window size if sequence length is shorter */
     if (length1 < wplus)
       wplus = length1;
 
-    /* calc mfe for first sequence (2nd if upmode = 3) */
+    /* calc mfe for first sequence */
     if (cstruc1 != NULL)
       strncpy(structure, cstruc1, length1 + 1);
 
@@ -718,16 +921,10 @@ main(int  argc,
     unstr_out = pf_unstru(s1, wplus);
     free_pf_arrays();
 
-    if (fold_constrained) {
-      if (up_mode & RNA_UP_MODE_2) {
-        cstruc_combined = (char *)vrna_alloc(sizeof(char) * (length1 + length2 + 1));
-        strncpy(cstruc_combined, cstruc1, length1 + 1);
-        strcat(cstruc_combined, cstruc2);
-      } else if (up_mode & RNA_UP_MODE_3) {
-        cstruc_combined = (char *)vrna_alloc(sizeof(char) * (length_target + length1 + 1));
-        strncpy(cstruc_combined, cstruc_target, length_target + 1);
-        strcat(cstruc_combined, cstruc1);
-      }
+    if ((fold_constrained) && (up_mode & RNA_UP_MODE_2)) {
+      cstruc_combined = (char *)vrna_alloc(sizeof(char) * (length1 + length2 + 1));
+      strncpy(cstruc_combined, cstruc1, length1 + 1);
+      strcat(cstruc_combined, cstruc2);
     }
 
     contrib1  = contrib2 = NULL;
@@ -749,7 +946,14 @@ main(int  argc,
         break;
       case RNA_UP_MODE_2:
         inter_out = pf_interact(s1, s2, unstr_out, NULL, w, cstruc_combined, incr3, incr5);
-        print_interaction(inter_out, orig_s1, orig_s2, unstr_out, NULL, w, incr3, incr5);
+        {
+          vrna_cstr_t data  = vrna_cstr(256, stdout);
+          vrna_cstr_t err   = vrna_cstr(256, stderr);
+          print_interaction(data, err, inter_out, orig_s1, orig_s2, unstr_out, NULL, w, incr3, incr5,
+                            &(opt.md));
+          vrna_cstr_free(err);
+          vrna_cstr_free(data);
+        }
         if (output && header)
           head = vrna_strdup_printf("# %s\n# %d %s\n# %s\n# %d %s\n# %s",
                                     cmdl_parameters,
@@ -762,83 +966,6 @@ main(int  argc,
 
         contrib1 = unstr_out;
         break;
-      case RNA_UP_MODE_3:   /* calculate prob. unstruct. for target seq */
-        if (unstr_target == NULL) {
-          wplus = w + incr3 + incr5;
-          if (max_u > wplus)
-            wplus = max_u;
-
-          if (length_target < wplus)
-            wplus = length_target;
-
-          if (cstruc_target != NULL)
-            strncpy(structure, cstruc_target, length_target + 1);
-
-          min_en    = fold(s_target, structure);
-          pf_scale  = exp(-(sfact * min_en) / RT / length_target);
-          if (length_target > 2000)
-            vrna_message_info(stderr, "scaling factor %f", pf_scale);
-
-          if (cstruc_target != NULL)
-            strncpy(structure, cstruc_target, length_target + 1);
-
-          (void)pf_fold(s_target, structure);
-          unstr_target = pf_unstru(s_target, wplus);
-          free_pf_arrays();                     /* for arrays for pf_fold(...) */
-        }
-
-        /* check if target sequence is actually longer than query, if not rotate both sequences */
-        if (length_target < length1) {
-          inter_out = pf_interact(s1,
-                                  s_target,
-                                  unstr_out,
-                                  unstr_target,
-                                  w,
-                                  cstruc_combined,
-                                  incr3,
-                                  incr5);
-          print_interaction(inter_out,
-                            orig_s1,
-                            orig_target,
-                            unstr_out,
-                            unstr_target,
-                            w,
-                            incr3,
-                            incr5);
-          contrib1  = unstr_out;
-          contrib2  = unstr_target;
-        } else {
-          inter_out = pf_interact(s_target,
-                                  s1,
-                                  unstr_target,
-                                  unstr_out,
-                                  w,
-                                  cstruc_combined,
-                                  incr3,
-                                  incr5);
-          print_interaction(inter_out,
-                            orig_target,
-                            orig_s1,
-                            unstr_target,
-                            unstr_out,
-                            w,
-                            incr3,
-                            incr5);
-          contrib1  = unstr_target;
-          contrib2  = unstr_out;
-        }
-
-        if (output && header)
-          head = vrna_strdup_printf("# %s\n# %d %s\n# %s\n# %d %s\n# %s",
-                                    cmdl_parameters,
-                                    length_target,
-                                    fname_target,
-                                    orig_target,
-                                    length1,
-                                    fname1,
-                                    orig_s1);
-
-        break;
     }
 
     /* create additional output */
@@ -860,19 +987,11 @@ main(int  argc,
      ########################################################
      */
 
-    /* we can save the pu contribution structure of the target sequence for the next run */
-    if (unstr_target != NULL) {
-      if (length_target < length1)
-        free_pu_contrib_struct(contrib1);
-      else
-        free_pu_contrib_struct(contrib2);
-    } else {
-      if (contrib1 != NULL)
-        free_pu_contrib_struct(contrib1);
+    if (contrib1 != NULL)
+      free_pu_contrib_struct(contrib1);
 
-      if (contrib2 != NULL)
-        free_pu_contrib_struct(contrib2);
-    }
+    if (contrib2 != NULL)
+      free_pu_contrib_struct(contrib2);
 
     if (inter_out != NULL)
       free_interact(inter_out);
@@ -895,12 +1014,213 @@ main(int  argc,
 
     free_arrays(); /* for arrays for fold(...) */
   } while (1);
+
+  /* print any FASTA headers that are not followed by a sequence */
+  if (headers) {
+    struct record_data *record = (struct record_data *)vrna_alloc(sizeof(struct record_data));
+
+    record->number  = opt.next_record_number;
+    record->headers = headers;
+    record->options = &opt;
+
+    if (opt.output_queue)
+      vrna_ostream_request(opt.output_queue, opt.next_record_number++);
+
+    RUN_IN_PARALLEL(process_record, record);
+  }
+
+  UNINIT_PARALLELIZATION
+
+  vrna_ostream_free(opt.output_queue);
+
+  free_pu_contrib_struct(opt.unstr_target);
+  free(s_target);
+  free(orig_target);
+  free(cstruc_target);
   free(cmdl_parameters);
 
   return EXIT_SUCCESS;
 }
 
 
+PRIVATE void
+process_record(struct record_data *record)
+{
+  char                  *s1, *orig_s1, *cstruc_combined, *head, *name, **h;
+  int                   length1, wplus;
+  pu_contrib            *unstr_out, *contrib1, *contrib2;
+  interact              *inter_out;
+  struct options        *opt;
+  struct output_stream  *o_stream;
+
+  opt       = record->options;
+  s1        = record->s1;
+  orig_s1   = record->orig_s1;
+  o_stream  = (struct output_stream *)vrna_alloc(sizeof(struct output_stream));
+
+  /* retrieve string stream bound to stdout */
+  o_stream->data  = vrna_cstr((s1) ? 4 * (strlen(s1) + opt->length_target) : 256, stdout);
+  o_stream->err   = vrna_cstr(256, stderr);
+
+  if (record->headers)
+    for (h = record->headers; *h; h++)
+      vrna_cstr_print_fasta_header(o_stream->data, *h);
+
+  if (s1) {
+    length1         = (int)strlen(s1);
+    cstruc_combined = head = NULL;
+
+    /* calc probability to be unstructured for the current sequence */
+    wplus = MIN2(opt->w, length1);
+
+    unstr_out = compute_unstru(s1, record->cstruc1, wplus, &(opt->md), o_stream->err);
+
+    if ((opt->cstruc_target) && (record->cstruc1)) {
+      cstruc_combined = (char *)vrna_alloc(sizeof(char) * (opt->length_target + length1 + 1));
+      strncpy(cstruc_combined, opt->cstruc_target, opt->length_target + 1);
+      strcat(cstruc_combined, record->cstruc1);
+    }
+
+    /* check if target sequence is actually longer than query, if not rotate both sequences */
+    if (opt->length_target < length1) {
+      inter_out = vrna_pf_interact(s1,
+                                   opt->s_target,
+                                   unstr_out,
+                                   opt->unstr_target,
+                                   opt->w,
+                                   cstruc_combined,
+                                   opt->incr3,
+                                   opt->incr5,
+                                   &(opt->md));
+      print_interaction(o_stream->data,
+                        o_stream->err,
+                        inter_out,
+                        orig_s1,
+                        opt->orig_target,
+                        unstr_out,
+                        opt->unstr_target,
+                        opt->w,
+                        opt->incr3,
+                        opt->incr5,
+                        &(opt->md));
+      contrib1  = unstr_out;
+      contrib2  = opt->unstr_target;
+    } else {
+      inter_out = vrna_pf_interact(opt->s_target,
+                                   s1,
+                                   opt->unstr_target,
+                                   unstr_out,
+                                   opt->w,
+                                   cstruc_combined,
+                                   opt->incr3,
+                                   opt->incr5,
+                                   &(opt->md));
+      print_interaction(o_stream->data,
+                        o_stream->err,
+                        inter_out,
+                        opt->orig_target,
+                        orig_s1,
+                        opt->unstr_target,
+                        unstr_out,
+                        opt->w,
+                        opt->incr3,
+                        opt->incr5,
+                        &(opt->md));
+      contrib1  = opt->unstr_target;
+      contrib2  = unstr_out;
+    }
+
+    /* create additional output */
+    if (opt->output) {
+      if (opt->header)
+        head = vrna_strdup_printf("# %s\n# %d %s\n# %s\n# %d %s\n# %s",
+                                  opt->cmdl_parameters,
+                                  opt->length_target,
+                                  opt->fname_target,
+                                  opt->orig_target,
+                                  length1,
+                                  record->fname1,
+                                  orig_s1);
+
+      name = vrna_strdup_printf("%s_u%d.out", record->up_out, opt->unpaired_values[0][0]);
+      vrna_cstr_printf(o_stream->data, "RNAup output in file: %s\n", name);
+
+      /* different records may write to the same file */
+      THREADSAFE_FILE_OUTPUT(
+        Up_plot(contrib1, contrib2, inter_out, name, opt->unpaired_values, opt->my_contrib, head,
+                RNA_UP_MODE_3));
+
+      free(name);
+      free(head);
+    }
+
+    free_interact(inter_out);
+    free_pu_contrib_struct(unstr_out);
+    free(cstruc_combined);
+  }
+
+  if (opt->output_queue)
+    vrna_ostream_provide(opt->output_queue, record->number, (void *)o_stream);
+  else
+    THREADSAFE_STREAM_OUTPUT(flush_cstr_callback(NULL, record->number, (void *)o_stream));
+
+  /* clean up */
+  if (record->headers) {
+    for (h = record->headers; *h; h++)
+      free(*h);
+    free(record->headers);
+  }
+
+  free(s1);
+  free(orig_s1);
+  free(record->cstruc1);
+  free(record->fname1);
+  free(record->up_out);
+  free(record);
+}
+
+
+/* compute the probabilities of being unpaired of a single sequence */
+PRIVATE pu_contrib *
+compute_unstru(const char *s,
+               const char *cstruc,
+               int        w,
+               vrna_md_t  *md,
+               vrna_cstr_t err)
+{
+  char                  *structure;
+  double                min_en;
+  pu_contrib            *pu;
+  vrna_fold_compound_t  *fc;
+
+  structure = (char *)vrna_alloc(sizeof(char) * (strlen(s) + 1));
+  fc        = vrna_fold_compound(s, md, VRNA_OPTION_DEFAULT);
+
+  if (cstruc)
+    vrna_constraints_add(fc,
+                         cstruc,
+                         VRNA_CONSTRAINT_DB
+                         | VRNA_CONSTRAINT_DB_PIPE
+                         | VRNA_CONSTRAINT_DB_DOT
+                         | VRNA_CONSTRAINT_DB_X
+                         | VRNA_CONSTRAINT_DB_ANG_BRACK
+                         | VRNA_CONSTRAINT_DB_RND_BRACK);
+
+  min_en = (double)vrna_mfe(fc, structure);
+  vrna_exp_params_rescale(fc, &min_en);
+  if (fc->length > 2000)
+    vrna_cstr_message_info(err, "scaling factor %f", fc->exp_params->pf_scale);
+
+  (void)vrna_pf(fc, structure);
+  pu = vrna_pf_unstru(fc, w);
+
+  vrna_fold_compound_free(fc);
+  free(structure);
+
+  return pu;
+}
+
+
 PRIVATE int
 compare_unpaired_values(const void  *p1,
                         const void  *p2)
@@ -1169,27 +1489,31 @@ seperate_bp(char  **inter,
 
 
 PRIVATE void
-print_interaction(interact    *Int,
+print_interaction(vrna_cstr_t stream,
+                  vrna_cstr_t err,
+                  interact    *Int,
                   char        *s1,
                   char        *s2,
                   pu_contrib  *p_c,
                   pu_contrib  *p_c2,
                   int         w,
                   int         incr3,
-                  int         incr5)
+                  int         incr5,
+                  vrna_md_t   *md)
 {
-  char    *i_long, *i_short;
-  int     i, l_l, l_s, len1, end5, end3, i_min, j_min, l1, add_a, add_b, nix_up;
-  double  p_c_S;
-  double  G_min, Gi_min, Gul, G_sum, Gus, diff;
-  duplexT mfe;
-  char    *struc;
+  char          *i_long, *i_short;
+  int           i, l_l, l_s, len1, end5, end3, i_min, j_min, l1, add_a, add_b, nix_up;
+  double        p_c_S;
+  double        G_min, Gi_min, Gul, G_sum, Gus, diff;
+  duplexT       mfe;
+  char          *struc;
+  vrna_duplex_t dup;
 
   G_min   = Int->Gikjl;
   Gi_min  = Int->Gikjl_wo;
   len1    = Int->length;
 
-  /* use duplexfold() to fold the interaction site */
+  /* use vrna_duplex_mfe() to fold the interaction site */
   l_l     = (Int->i - Int->k + 1);
   i_long  = (char *)vrna_alloc(sizeof(char) * (l_l + 1));
   l_s     = (Int->l - Int->j + 1);
@@ -1200,7 +1524,9 @@ print_interaction(interact    *Int,
   strncpy(i_short, &s2[Int->j - 1], l_s);
   i_short[l_s] = '\0';
 
-  mfe = duplexfold(i_long, i_short);
+  dup = vrna_duplex_init(md);
+  mfe = vrna_duplex_mfe(dup, i_long, i_short);
+  vrna_duplex_free(dup);
 
   i_min = mfe.i;
   j_min = mfe.j;
@@ -1254,9 +1580,10 @@ print_interaction(interact    *Int,
     G_sum = Gi_min + Gul;
 
     /* printf("dG = dGint + dGu_l\n"); */
-    printf("%s %3d,%-3d : %3d,%-3d (%.2f = %.2f + %.2f)\n",
-           struc, Int->k, Int->i, Int->j, Int->l, G_min, Gi_min, Gul);
-    printf("%s&%s\n", i_long, i_short);
+    vrna_cstr_printf(stream,
+                     "%s %3d,%-3d : %3d,%-3d (%.2f = %.2f + %.2f)\n",
+                     struc, Int->k, Int->i, Int->j, Int->l, G_min, Gi_min, Gul);
+    vrna_cstr_printf(stream, "%s&%s\n", i_long, i_short);
   } else {
     p_c_S = p_c2->H[Int->j][(Int->l) - (Int->j)] +
             p_c2->I[Int->j][(Int->l) - (Int->j)] +
@@ -1268,20 +1595,21 @@ print_interaction(interact    *Int,
 
     G_sum = Gi_min + Gul + Gus;
     /* printf("dG = dGint + dGu_l + dGu_s\n"); */
-    printf("%s %3d,%-3d : %3d,%-3d (%.2f = %.2f + %.2f + %.2f)\n",
-           struc, Int->k, Int->i, Int->j, Int->l, G_min, Gi_min, Gul, Gus);
-    printf("%s&%s\n", i_long, i_short);
+    vrna_cstr_printf(stream,
+                     "%s %3d,%-3d : %3d,%-3d (%.2f = %.2f + %.2f + %.2f)\n",
+                     struc, Int->k, Int->i, Int->j, Int->l, G_min, Gi_min, Gul, Gus);
+    vrna_cstr_printf(stream, "%s&%s\n", i_long, i_short);
   }
 
   if (!EQUAL(G_min, G_sum)) {
-    printf("ERROR\n");
+    vrna_cstr_printf(stream, "ERROR\n");
     diff = fabs((G_min) - (G_sum));
-    printf("diff %.18f\n", diff);
+    vrna_cstr_printf(stream, "diff %.18f\n", diff);
   }
 
   if (nix_up)
-    vrna_message_warning(
-      "RNAduplex structure doesn't match any structure of RNAup structure ensemble");
+    vrna_cstr_message_warning(err,
+                              "RNAduplex structure doesn't match any structure of RNAup structure ensemble");
 
   free(i_long);
   free(i_short);
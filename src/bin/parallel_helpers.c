@@ -7,6 +7,10 @@
  *
  */
 
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #ifdef _WIN32
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
@@ -18,6 +22,33 @@
 #include <string.h>
 #include <errno.h>
 
+#include "ViennaRNA/datastructures/arena.h"
+
+#if VRNA_WITH_PTHREADS
+#include <pthread.h>
+
+static pthread_key_t  arena_key;
+static pthread_once_t arena_key_once = PTHREAD_ONCE_INIT;
+
+
+static void
+arena_destroy(void *data)
+{
+  vrna_arena_free((vrna_arena_t)data);
+}
+
+
+static void
+arena_key_init(void)
+{
+  pthread_key_create(&arena_key, &arena_destroy);
+}
+
+
+#else
+static vrna_arena_t record_arena_single = NULL;
+#endif
+
 
 int
 num_proc_cores(int  *num_cores,
@@ -134,3 +165,51 @@ max_user_threads(void)
 
   return threadm;
 }
+
+
+vrna_arena_t
+record_arena(void)
+{
+  vrna_arena_t arena;
+
+#if VRNA_WITH_PTHREADS
+  pthread_once(&arena_key_once, &arena_key_init);
+
+  arena = (vrna_arena_t)pthread_getspecific(arena_key);
+
+  if (!arena) {
+    arena = vrna_arena_init(0);
+    pthread_setspecific(arena_key, (void *)arena);
+  }
+
+#else
+  if (!record_arena_single)
+    record_arena_single = vrna_arena_init(0);
+
+  arena = record_arena_single;
+#endif
+
+  return arena;
+}
+
+
+void
+record_arena_free(void)
+{
+#if VRNA_WITH_PTHREADS
+  vrna_arena_t arena;
+
+  pthread_once(&arena_key_once, &arena_key_init);
+
+  arena = (vrna_arena_t)pthread_getspecific(arena_key);
+
+  if (arena) {
+    pthread_setspecific(arena_key, NULL);
+    vrna_arena_free(arena);
+  }
+
+#else
+  vrna_arena_free(record_arena_single);
+  record_arena_single = NULL;
+#endif
+}
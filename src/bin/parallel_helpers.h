@@ -1,6 +1,8 @@
 #ifndef VRNA_PARALLELIZATION_HELPERS
 #define VRNA_PARALLELIZATION_HELPERS
 
+#include "ViennaRNA/datastructures/arena.h"
+
 #if VRNA_WITH_PTHREADS
 
 #include <pthread.h>
@@ -58,6 +60,7 @@ threadpool      worker_pool;
     pthread_mutex_destroy(&output_file_mutex); \
     if (max_threads > 1) \
       thpool_destroy(worker_pool); \
+    record_arena_free(); \
 }
 
 #define RUN_IN_PARALLEL(fun, data)  { \
@@ -78,7 +81,7 @@ threadpool      worker_pool;
 #define THREADSAFE_FILE_OUTPUT(a)   { (a); }
 #define THREADSAFE_STREAM_OUTPUT(a)   { (a); }
 #define INIT_PARALLELIZATION(a)
-#define UNINIT_PARALLELIZATION
+#define UNINIT_PARALLELIZATION      { record_arena_free(); }
 #define RUN_IN_PARALLEL(fun, data)  { fun(data); }
 #define WAIT_FOR_FREE_SLOT(a)
 
@@ -93,4 +96,30 @@ int
 max_user_threads(void);
 
 
+/*
+ *  Retrieve the arena for record-scoped temporaries of the calling thread.
+ *  The arena is created upon first request and should be reset once the
+ *  current record has been processed.
+ *
+ *  Only memory that is both allocated and consumed by the record processing
+ *  function itself may be taken from the arena, i.e. sequence copies, MFE and
+ *  pairing propensity strings, and output file names. Element probability
+ *  lists and other results of library functions are allocated by the library
+ *  and released with free(), partly after in-place reallocation (e.g. ligand
+ *  motif annotation of dot plots). Output char streams are flushed and released
+ *  by the output queue, possibly on another thread and after the arena has
+ *  been reset. Neither of them is served by the arena
+ */
+vrna_arena_t
+record_arena(void);
+
+
+/*
+ *  Release the arena of the calling thread. Arenas of worker threads are
+ *  released automatically when the threads terminate
+ */
+void
+record_arena_free(void);
+
+
 #endif
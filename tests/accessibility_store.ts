@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <ViennaRNA/utils/basic.h>
+#include <ViennaRNA/io/accessibility_store.h>
+
+#define ACC_STORE_TEST_FILE "test_acc_store.bin"
+
+static const char   *acc_ids[]    = {
+  "seq_c", "seq_a", "seq_d", "seq_b"
+};
+static unsigned int acc_lengths[] = {
+  40, 17, 1, 123
+};
+static unsigned int acc_ulength = 5;
+
+
+/* some deterministic opening energy for stretch of length u ending at i */
+static int
+acc_energy(unsigned int r,
+           unsigned int u,
+           unsigned int i)
+{
+  return (u > i) ? INF : (int)(1000 * r + 37 * u - 11 * i);
+}
+
+
+static int **
+acc_energies(unsigned int r)
+{
+  unsigned int  u, i, n = acc_lengths[r];
+  int           **e = (int **)vrna_alloc(sizeof(int *) * (acc_ulength + 1));
+
+  for (u = 1; u <= acc_ulength; u++) {
+    e[u] = (int *)vrna_alloc(sizeof(int) * (n + 1));
+    for (i = 1; i <= n; i++)
+      e[u][i] = acc_energy(r, u, i);
+  }
+
+  return e;
+}
+
+
+static void
+acc_energies_free(int **e)
+{
+  unsigned int u;
+
+  for (u = 1; u <= acc_ulength; u++)
+    free(e[u]);
+
+  free(e);
+}
+
+
+/* overwrite n bytes at a given offset of a file */
+static int
+patch_file(const char *filename,
+           long       offset,
+           const void *data,
+           size_t     n)
+{
+  FILE  *fp;
+  int   ret;
+
+  fp = fopen(filename, "r+b");
+  if (!fp)
+    return 0;
+
+  ret = ((fseek(fp, offset, SEEK_SET) == 0) &&
+         (fwrite(data, 1, n, fp) == n)) ? 1 : 0;
+
+  return (fclose(fp) == 0) ? ret : 0;
+}
+
+
+#suite Accessibility_Store
+
+#tcase Round_Trip
+
+#test test_acc_store_round_trip
+{
+  unsigned int      r, u, i, n, ul, n_records = sizeof(acc_lengths) / sizeof(unsigned int);
+  int               **e;
+  const int         *w;
+  vrna_acc_store_t  store;
+
+  store = vrna_acc_store_create(ACC_STORE_TEST_FILE);
+  ck_assert_ptr_ne(store, NULL);
+
+  for (r = 0; r < n_records; r++) {
+    e = acc_energies(r);
+    ck_assert_int_ne(vrna_acc_store_add(store,
+                                        acc_ids[r],
+                                        acc_lengths[r],
+                                        acc_ulength,
+                                        (const int **)e), 0);
+    acc_energies_free(e);
+  }
+
+  ck_assert_int_eq(vrna_acc_store_size(store), n_records);
+  ck_assert_int_ne(vrna_acc_store_close(store), 0);
+
+  store = vrna_acc_store_open(ACC_STORE_TEST_FILE);
+  ck_assert_ptr_ne(store, NULL);
+  ck_assert_int_eq(vrna_acc_store_size(store), n_records);
+
+  for (r = 0; r < n_records; r++) {
+    ck_assert_int_ne(vrna_acc_store_find(store, acc_ids[r], &n, &ul), 0);
+    ck_assert_int_eq(n, acc_lengths[r]);
+    ck_assert_int_eq(ul, acc_ulength);
+
+    for (u = 1; u <= acc_ulength; u++) {
+      /* the entire sequence */
+      w = vrna_acc_store_window(store, acc_ids[r], u, 1, n);
+      ck_assert_ptr_ne(w, NULL);
+      for (i = 1; i <= n; i++)
+        ck_assert_int_eq(w[i - 1], acc_energy(r, u, i));
+
+      /* a window in the middle of the sequence */
+      if (n > 4) {
+        w = vrna_acc_store_window(store, acc_ids[r], u, 3, n - 2);
+        ck_assert_ptr_ne(w, NULL);
+        for (i = 3; i <= n - 2; i++)
+          ck_assert_int_eq(w[i - 3], acc_energy(r, u, i));
+      }
+    }
+
+    /* out of range requests */
+    ck_assert_ptr_eq(vrna_acc_store_window(store, acc_ids[r], 0, 1, n), NULL);
+    ck_assert_ptr_eq(vrna_acc_store_window(store, acc_ids[r], acc_ulength + 1, 1, n), NULL);
+    ck_assert_ptr_eq(vrna_acc_store_window(store, acc_ids[r], 1, 1, n + 1), NULL);
+  }
+
+  ck_assert_int_eq(vrna_acc_store_find(store, "seq_x", NULL, NULL), 0);
+  ck_assert_ptr_eq(vrna_acc_store_window(store, "seq_x", 1, 1, 1), NULL);
+
+  ck_assert_int_ne(vrna_acc_store_close(store), 0);
+
+  remove(ACC_STORE_TEST_FILE);
+}
+
+
+#tcase Corrupt_Files
+
+#test test_acc_store_corrupt_index
+{
+  /*
+   *  header, truncation, and ID checks are shared with all binary stores and
+   *  tested in binary_store.ts, here we only corrupt the accessibility index
+   */
+  unsigned int      r;
+  uint32_t          length = 0x7fffffffU;
+  uint64_t          index_offset, id_offset = 0xffffffffU;
+  int               **e;
+  FILE              *fp;
+  vrna_acc_store_t  store;
+
+  store = vrna_acc_store_create(ACC_STORE_TEST_FILE);
+  ck_assert_ptr_ne(store, NULL);
+
+  for (r = 0; r < 2; r++) {
+    e = acc_energies(r);
+    ck_assert_int_ne(vrna_acc_store_add(store,
+                                        acc_ids[r],
+                                        acc_lengths[r],
+                                        acc_ulength,
+                                        (const int **)e), 0);
+    acc_energies_free(e);
+  }
+
+  ck_assert_int_ne(vrna_acc_store_close(store), 0);
+
+  /* the index offset is the last member of the 32 byte header */
+  fp = fopen(ACC_STORE_TEST_FILE, "rb");
+  ck_assert_ptr_ne(fp, NULL);
+  ck_assert_int_eq(fseek(fp, 24, SEEK_SET), 0);
+  ck_assert_int_eq(fread(&index_offset, sizeof(uint64_t), 1, fp), 1);
+  fclose(fp);
+
+  /* an energy matrix that exceeds the data section */
+  ck_assert_int_ne(patch_file(ACC_STORE_TEST_FILE,
+                              (long)index_offset + 16,
+                              &length,
+                              sizeof(uint32_t)), 0);
+  ck_assert_ptr_eq(vrna_acc_store_open(ACC_STORE_TEST_FILE), NULL);
+
+  /* the index entries are sorted by ID, "seq_a" is the first one */
+  length = acc_lengths[1];
+  ck_assert_int_ne(patch_file(ACC_STORE_TEST_FILE,
+                              (long)index_offset + 16,
+                              &length,
+                              sizeof(uint32_t)), 0);
+
+  store = vrna_acc_store_open(ACC_STORE_TEST_FILE);
+  ck_assert_ptr_ne(store, NULL);
+  ck_assert_int_eq(vrna_acc_store_size(store), 2);
+  vrna_acc_store_close(store);
+
+  /* an ID beyond the end of the file */
+  ck_assert_int_ne(patch_file(ACC_STORE_TEST_FILE,
+                              (long)index_offset,
+                              &id_offset,
+                              sizeof(uint64_t)), 0);
+  ck_assert_ptr_eq(vrna_acc_store_open(ACC_STORE_TEST_FILE), NULL);
+
+  remove(ACC_STORE_TEST_FILE);
+}
+
+
+#main-pre
+    srunner_set_tap(sr, "-");
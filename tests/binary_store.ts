@@ -0,0 +1,291 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#include <ViennaRNA/utils/basic.h>
+#include <ViennaRNA/io/accessibility_store.h>
+#include <ViennaRNA/io/probability_store.h>
+
+/* the helpers shared by all indexed binary stores are tested directly */
+#include "ViennaRNA/io/binary_store.inc"
+
+#define STORE_TEST_FILE     "test_binary_store.bin"
+#define STORE_TEST_MAGIC    "VRNA_TST"
+#define STORE_TEST_VERSION  3U
+#define STORE_TEST_ENTRY    16
+
+
+/*
+ *  Write a minimal store with n entries of STORE_TEST_ENTRY bytes each,
+ *  followed by a single '\0'-terminated ID, and map it into memory
+ */
+static int
+store_test_file(struct store_file *file,
+                uint64_t          n)
+{
+  uint64_t  k, offset;
+  char      entry[STORE_TEST_ENTRY];
+  FILE      *fp;
+
+  fp = fopen(STORE_TEST_FILE, "wb");
+  if (!fp)
+    return 0;
+
+  offset = sizeof(struct store_header);
+  memset(entry, 'e', sizeof(entry));
+
+  if (!store_header_write(fp, STORE_TEST_MAGIC, STORE_TEST_VERSION, n, offset))
+    return 0;
+
+  for (k = 0; k < n; k++)
+    if (fwrite(entry, 1, sizeof(entry), fp) != sizeof(entry))
+      return 0;
+
+  if ((!store_id_write(fp, "id")) ||
+      (fclose(fp)))
+    return 0;
+
+  return store_map(file, STORE_TEST_FILE, "store_test_file");
+}
+
+
+/* read the header of a (possibly modified) store */
+static int
+store_test_header(struct store_file   *file,
+                  struct store_header *header)
+{
+  return store_header_read(file,
+                           STORE_TEST_MAGIC,
+                           STORE_TEST_VERSION,
+                           STORE_TEST_ENTRY,
+                           header,
+                           "store_test_header",
+                           STORE_TEST_FILE);
+}
+
+
+#suite Binary_Store
+
+#tcase Header
+
+#test test_store_header
+{
+  struct store_file   file;
+  struct store_header header;
+
+  ck_assert_int_ne(store_test_file(&file, 2), 0);
+  ck_assert_int_eq(file.size, sizeof(struct store_header) + 2 * STORE_TEST_ENTRY + 3);
+
+  ck_assert_int_eq(store_test_header(&file, &header), STORE_HEADER_OK);
+  ck_assert_int_eq(header.version, STORE_TEST_VERSION);
+  ck_assert_int_eq(header.n_records, 2);
+  ck_assert_int_eq(header.index_offset, sizeof(struct store_header));
+
+  /* a different store type */
+  ck_assert_int_eq(store_header_read(&file, "VRNA_XXX", STORE_TEST_VERSION, STORE_TEST_ENTRY,
+                                     &header, "test_store_header", STORE_TEST_FILE),
+                   STORE_HEADER_CORRUPT);
+
+  /* an unsupported version is not a corrupt file */
+  ck_assert_int_eq(store_header_read(&file, STORE_TEST_MAGIC, STORE_TEST_VERSION + 1,
+                                     STORE_TEST_ENTRY, &header, "test_store_header",
+                                     STORE_TEST_FILE),
+                   STORE_HEADER_FAIL);
+
+  store_unmap(&file);
+  ck_assert_ptr_eq(file.data, NULL);
+
+  remove(STORE_TEST_FILE);
+}
+
+
+#test test_store_header_placeholder
+{
+  struct store_file   file;
+  struct store_header header;
+  FILE                *fp;
+
+  /* the header written upon creation of a store is never accepted */
+  fp = fopen(STORE_TEST_FILE, "wb");
+  ck_assert_ptr_ne(fp, NULL);
+  ck_assert_int_ne(store_header_write(fp, NULL, 0, 0, 0), 0);
+  ck_assert_int_ne(store_id_write(fp, ""), 0);
+  ck_assert_int_eq(fclose(fp), 0);
+
+  ck_assert_int_ne(store_map(&file, STORE_TEST_FILE, "test_store_header_placeholder"), 0);
+  ck_assert_int_eq(store_test_header(&file, &header), STORE_HEADER_CORRUPT);
+  store_unmap(&file);
+
+  remove(STORE_TEST_FILE);
+}
+
+
+#test test_store_padding
+{
+  uint64_t  offset;
+  FILE      *fp;
+
+  fp = fopen(STORE_TEST_FILE, "wb");
+  ck_assert_ptr_ne(fp, NULL);
+
+  for (offset = 0; offset <= 3 * STORE_ALIGN; offset++) {
+    uint64_t o = offset;
+
+    ck_assert_int_ne(store_padding_write(fp, &o), 0);
+    ck_assert_int_eq(o % STORE_ALIGN, 0);
+    ck_assert(o >= offset);
+    ck_assert(o < offset + STORE_ALIGN);
+  }
+
+  fclose(fp);
+  remove(STORE_TEST_FILE);
+}
+
+
+#tcase Corrupt_Files
+
+#test test_store_missing
+{
+  struct store_file file;
+  FILE              *fp;
+
+  memset(&file, 0, sizeof(struct store_file));
+
+  ck_assert_int_eq(store_map(&file, "does_not_exist.bin", "test_store_missing"), 0);
+
+  /* empty files are rejected before they are mapped */
+  fp = fopen(STORE_TEST_FILE, "wb");
+  ck_assert_ptr_ne(fp, NULL);
+  fclose(fp);
+
+  ck_assert_int_eq(store_map(&file, STORE_TEST_FILE, "test_store_missing"), 0);
+  ck_assert_ptr_eq(file.data, NULL);
+
+  remove(STORE_TEST_FILE);
+}
+
+
+#test test_store_corrupt_header
+{
+  size_t              size;
+  unsigned char       *copy;
+  struct store_file   file, modified;
+  struct store_header header, *h;
+
+  ck_assert_int_ne(store_test_file(&file, 3), 0);
+
+  size  = file.size;
+  copy  = (unsigned char *)vrna_alloc(size);
+  h     = (struct store_header *)copy;
+
+  modified.data   = copy;
+  modified.mapped = 0;
+
+  /* truncated within the header, the index, and the IDs */
+  memcpy(copy, file.data, size);
+  modified.size = 0;
+  ck_assert_int_eq(store_test_header(&modified, &header), STORE_HEADER_CORRUPT);
+  modified.size = sizeof(struct store_header) - 1;
+  ck_assert_int_eq(store_test_header(&modified, &header), STORE_HEADER_CORRUPT);
+  modified.size = sizeof(struct store_header) + STORE_TEST_ENTRY;
+  ck_assert_int_eq(store_test_header(&modified, &header), STORE_HEADER_CORRUPT);
+  modified.size = size - 1;
+  ck_assert_int_eq(store_test_header(&modified, &header), STORE_HEADER_CORRUPT);
+
+  modified.size = size;
+  ck_assert_int_eq(store_test_header(&modified, &header), STORE_HEADER_OK);
+
+  /* byte order mismatch */
+  h->byte_order = 0x04030201U;
+  ck_assert_int_eq(store_test_header(&modified, &header), STORE_HEADER_FAIL);
+  memcpy(copy, file.data, size);
+
+  /* misaligned index */
+  h->index_offset += 1;
+  ck_assert_int_eq(store_test_header(&modified, &header), STORE_HEADER_CORRUPT);
+  memcpy(copy, file.data, size);
+
+  /* index beyond the end of the file */
+  h->index_offset = STORE_PAD(size + 1);
+  ck_assert_int_eq(store_test_header(&modified, &header), STORE_HEADER_CORRUPT);
+  memcpy(copy, file.data, size);
+
+  /* more entries than the file can hold */
+  h->n_records = size;
+  ck_assert_int_eq(store_test_header(&modified, &header), STORE_HEADER_CORRUPT);
+  memcpy(copy, file.data, size);
+
+  /* unterminated IDs */
+  copy[size - 1] = 'x';
+  ck_assert_int_eq(store_test_header(&modified, &header), STORE_HEADER_CORRUPT);
+
+  free(copy);
+  store_unmap(&file);
+
+  remove(STORE_TEST_FILE);
+}
+
+
+#tcase Write_Errors
+
+#test test_store_write_error
+{
+#ifdef __linux__
+  /*
+   *  /dev/full can be opened, but any write that reaches the device fails.
+   *  Records that exceed the stream buffer fail while being written. Both
+   *  stores then refuse any further records and fail to close
+   */
+  unsigned int              n = 100000;
+  int                       *e[2];
+  vrna_acc_store_t          acc;
+  vrna_prob_store_t         prob;
+  char                      *seq;
+  vrna_prob_store_record_t  record;
+
+  e[0]  = NULL;
+  e[1]  = (int *)vrna_alloc(sizeof(int) * (n + 1));
+
+  acc = vrna_acc_store_create("/dev/full");
+
+  if (acc) {
+    ck_assert_int_eq(vrna_acc_store_add(acc, "seq_large", n, 1, (const int **)e), 0);
+    ck_assert_int_eq(vrna_acc_store_add(acc, "seq_small", 1, 1, (const int **)e), 0);
+    ck_assert_int_eq(vrna_acc_store_size(acc), 0);
+    ck_assert_int_eq(vrna_acc_store_close(acc), 0);
+  }
+
+  seq = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  memset(seq, 'A', n);
+
+  memset(&record, 0, sizeof(vrna_prob_store_record_t));
+  record.id       = "seq_large";
+  record.sequence = seq;
+  record.length   = n;
+
+  prob = vrna_prob_store_create("/dev/full");
+
+  if (prob) {
+    ck_assert_int_eq(vrna_prob_store_add(prob, &record), 0);
+
+    seq[1]        = '\0';
+    record.id     = "seq_small";
+    record.length = 1;
+    ck_assert_int_eq(vrna_prob_store_add(prob, &record), 0);
+    ck_assert_int_eq(vrna_prob_store_size(prob), 0);
+    ck_assert_int_eq(vrna_prob_store_close(prob), 0);
+  }
+
+  free(seq);
+  free(e[1]);
+#endif
+}
+
+
+#main-pre
+    srunner_set_tap(sr, "-");
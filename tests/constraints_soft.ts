@@ -6,6 +6,22 @@
 #include <ViennaRNA/data_structures.h>
 #include <ViennaRNA/utils/strings.h>
 #include <ViennaRNA/constraints/soft.h>
+#include <ViennaRNA/constraints/hard.h>
+#include <ViennaRNA/unstructured_domains.h>
+#include <ViennaRNA/mfe.h>
+#include <ViennaRNA/part_func.h>
+
+static unsigned char
+hc_allow_all(int           i,
+             int           j,
+             int           k,
+             int           l,
+             unsigned char d,
+             void          *data)
+{
+  return (unsigned char)1;
+}
+
 
 #suite Constraints
 
@@ -220,3 +236,53 @@
 
 #main-pre
     srunner_set_tap(sr, "-");
+
+
+#test test_int_loop_plain_selection
+{
+  const char            *seq = "GGGGAAUCCAGCGAUAGCCUUAGCGGAAACUAGCCCC";
+  float                 mfe, mfe_sc;
+  double                mfe_d, dG, dG_sc;
+  vrna_fold_compound_t  *fc;
+
+  fc = vrna_fold_compound(seq, NULL, VRNA_OPTION_DEFAULT);
+
+  /* the callback-free interior loops are selected upon preparation */
+  mfe = vrna_mfe(fc, NULL);
+  ck_assert_int_eq(fc->int_loop_plain, 1);
+
+  mfe_d = (double)mfe;
+  vrna_exp_params_rescale(fc, &mfe_d);
+  dG = vrna_pf(fc, NULL);
+  ck_assert_int_eq(fc->int_loop_plain, 1);
+
+  /* soft constraints disable the selection upon the next preparation, results do not change */
+  vrna_sc_add_up(fc, 7, 0., VRNA_OPTION_DEFAULT);
+
+  mfe_sc = vrna_mfe(fc, NULL);
+  ck_assert_int_eq(fc->int_loop_plain, 0);
+  ck_assert(mfe == mfe_sc);
+
+  dG_sc = vrna_pf(fc, NULL);
+  ck_assert(fabs(dG - dG_sc) < 1e-6);
+
+  /* without soft constraints, the selection is restored by the next preparation */
+  vrna_sc_remove(fc);
+  vrna_mfe(fc, NULL);
+  ck_assert_int_eq(fc->int_loop_plain, 1);
+
+  vrna_hc_add_f(fc, &hc_allow_all);
+  vrna_mfe(fc, NULL);
+  ck_assert_int_eq(fc->int_loop_plain, 0);
+  vrna_fold_compound_free(fc);
+
+  fc = vrna_fold_compound(seq, NULL, VRNA_OPTION_DEFAULT);
+  vrna_mfe(fc, NULL);
+  ck_assert_int_eq(fc->int_loop_plain, 1);
+
+  vrna_ud_add_motif(fc, "AAA", -1., NULL, VRNA_UNSTRUCTURED_DOMAIN_ALL_LOOPS);
+  vrna_mfe(fc, NULL);
+  ck_assert_int_eq(fc->int_loop_plain, 0);
+
+  vrna_fold_compound_free(fc);
+}
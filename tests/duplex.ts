@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <ViennaRNA/fold_vars.h>
+#include <ViennaRNA/model.h>
+#include <ViennaRNA/duplex.h>
+#include <ViennaRNA/utils/basic.h>
+
+static const char *dup_queries[] = {
+  "GCAUGCUAGCUAGCUAGGCU",
+  "UGAGGUAGUAGGUUGUAUAGUU",
+  NULL
+};
+static const char *dup_targets[] = {
+  "UUAGGCCGAUAGCGCAAGCUUCGGCUAAUCCGAUGGCAUCAGGCUAGCGAUUCGC",
+  "AACUAUACAACCUACUACCUCAGGAUCCGAUGGCAUGCUAGCUAGC",
+  NULL
+};
+
+/* MFE duplexes for all query/target combinations, as obtained with ViennaRNA 2.6 */
+static const struct {
+  const char  *structure;
+  int         i;
+  int         j;
+  double      energy;
+} dup_mfe[] = {
+  { ".((((((((((((((((&.))))).))))...............))))))).", 20, 16, -18.20 },
+  { ".((((((((((...(((&.)))..))))))))))",                   20, 31, -20.50 },
+  { "((((((.....(((((.&.)))))....)))))).",                  17, 8,  -8.60  },
+  { "((((((((((((((((((((((&)))))))))))))))))))))).",       22, 1,  -36.40 }
+};
+
+
+static int
+duplex_eq(const duplexT *a,
+          const duplexT *b)
+{
+  return (a->i == b->i) &&
+         (a->j == b->j) &&
+         (fabs(a->energy - b->energy) < 1e-6) &&
+         (strcmp(a->structure, b->structure) == 0);
+}
+
+
+static unsigned int
+duplex_list_size(const duplexT *list)
+{
+  unsigned int n;
+
+  for (n = 0; list[n].i > 0; n++);
+
+  return n;
+}
+
+
+static void
+duplex_list_free(duplexT *list)
+{
+  duplexT *d;
+
+  for (d = list; d->i > 0; d++)
+    free(d->structure);
+
+  free(list);
+}
+
+
+#suite Duplex
+
+#tcase Reentrant_Interface
+
+#test test_vrna_duplex_mfe
+{
+  unsigned int  q, t, k;
+  duplexT       mfe, mfe_old;
+  vrna_md_t     md;
+  vrna_duplex_t dup;
+
+  vrna_md_set_default(&md);
+  dup = vrna_duplex_init(&md);
+  ck_assert_ptr_ne(dup, NULL);
+
+  /* one context for all predictions, such that its matrix is re-used */
+  for (k = 0, q = 0; dup_queries[q]; q++)
+    for (t = 0; dup_targets[t]; t++, k++) {
+      mfe     = vrna_duplex_mfe(dup, dup_queries[q], dup_targets[t]);
+      mfe_old = duplexfold(dup_queries[q], dup_targets[t]);
+
+      ck_assert_str_eq(mfe.structure, dup_mfe[k].structure);
+      ck_assert_int_eq(mfe.i, dup_mfe[k].i);
+      ck_assert_int_eq(mfe.j, dup_mfe[k].j);
+      ck_assert(fabs(mfe.energy - dup_mfe[k].energy) < 1e-6);
+      ck_assert(duplex_eq(&mfe, &mfe_old));
+
+      free(mfe.structure);
+      free(mfe_old.structure);
+    }
+
+  vrna_duplex_free(dup);
+}
+
+
+#test test_vrna_duplex_subopt
+{
+  unsigned int  q, t, k, n;
+  duplexT       *sub, *sub_old;
+  vrna_md_t     md;
+  vrna_duplex_t dup;
+
+  vrna_md_set_default(&md);
+  dup = vrna_duplex_init(&md);
+
+  for (q = 0; dup_queries[q]; q++)
+    for (t = 0; dup_targets[t]; t++) {
+      sub     = vrna_duplex_subopt(dup, dup_queries[q], dup_targets[t], 500, 5, 0);
+      sub_old = duplex_subopt(dup_queries[q], dup_targets[t], 500, 5);
+
+      ck_assert_ptr_ne(sub, NULL);
+      ck_assert_ptr_ne(sub_old, NULL);
+
+      n = duplex_list_size(sub);
+      ck_assert_int_gt(n, 0);
+      ck_assert_int_eq(n, duplex_list_size(sub_old));
+
+      for (k = 0; k < n; k++)
+        ck_assert(duplex_eq(sub + k, sub_old + k));
+
+      duplex_list_free(sub);
+      duplex_list_free(sub_old);
+    }
+
+  vrna_duplex_free(dup);
+}
+
+
+#test test_vrna_duplex_batch
+{
+  unsigned int  q, t, k, n, num_targets = 2;
+  int           jobs;
+  duplexT       **mfe, **sub, *ref, mfe_old;
+  vrna_md_t     md;
+  vrna_duplex_t dup;
+
+  vrna_md_set_default(&md);
+  dup = vrna_duplex_init(&md);
+
+  /* the result does not depend on the number of threads */
+  for (jobs = 1; jobs <= 4; jobs += 3) {
+    mfe = vrna_duplex_batch(dup_queries, dup_targets, &md, -1, 5, jobs);
+    sub = vrna_duplex_batch(dup_queries, dup_targets, &md, 500, 5, jobs);
+
+    ck_assert_ptr_ne(mfe, NULL);
+    ck_assert_ptr_ne(sub, NULL);
+
+    for (q = 0; dup_queries[q]; q++)
+      for (t = 0; dup_targets[t]; t++) {
+        k = q * num_targets + t;
+
+        /* MFE only */
+        mfe_old = duplexfold(dup_queries[q], dup_targets[t]);
+        ck_assert_int_eq(duplex_list_size(mfe[k]), 1);
+        ck_assert(duplex_eq(mfe[k], &mfe_old));
+        free(mfe_old.structure);
+
+        /* suboptimal duplexes, sorted by free energy */
+        ref = vrna_duplex_subopt(dup, dup_queries[q], dup_targets[t], 500, 5, 1);
+        n   = duplex_list_size(ref);
+        ck_assert_int_eq(duplex_list_size(sub[k]), n);
+
+        for (n = 0; ref[n].i > 0; n++)
+          ck_assert(duplex_eq(sub[k] + n, ref + n));
+
+        duplex_list_free(ref);
+        duplex_list_free(mfe[k]);
+        duplex_list_free(sub[k]);
+      }
+
+    free(mfe);
+    free(sub);
+  }
+
+  ck_assert_ptr_eq(vrna_duplex_batch(NULL, dup_targets, &md, -1, 5, 1), NULL);
+
+  vrna_duplex_free(dup);
+}
+
+
+#main-pre
+    srunner_set_tap(sr, "-");
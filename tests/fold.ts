@@ -1,5 +1,7 @@
 #include <stdio.h>      /* printf, scanf, NULL */
 #include <stdlib.h>     /* malloc, free, rand */
+#include <string.h>
+#include <math.h>
 
 #include <ViennaRNA/fold_vars.h>
 #include <ViennaRNA/data_structures.h>
@@ -7,7 +9,265 @@
 #include <ViennaRNA/utils/structures.h>
 #include <ViennaRNA/constraints/basic.h>
 #include <ViennaRNA/fold.h>
+#include <ViennaRNA/mfe.h>
 #include <ViennaRNA/part_func.h>
+#include <ViennaRNA/dp_matrices.h>
+#include <ViennaRNA/2Dfold.h>
+#include <ViennaRNA/utils/strings.h>
+
+
+static size_t mx_alloc_calls   = 0;
+static size_t mx_release_calls = 0;
+
+
+static void *
+mx_alloc_counting(size_t  size,
+                  void    *data)
+{
+  mx_alloc_calls++;
+  *((size_t *)data) += size;
+
+  return calloc(1, size);
+}
+
+
+static void
+mx_release_counting(void    *ptr,
+                    size_t  size,
+                    void    *data)
+{
+  mx_release_calls++;
+  *((size_t *)data) -= size;
+
+  free(ptr);
+}
+
+
+/*
+ *  Predict the MFE and, if requested, equilibrium probabilities for a sequence
+ *  with either the default DP matrix allocator (alloc_mode = 0), the built-in
+ *  page allocator (alloc_mode = 1), or a counting user allocator (alloc_mode = 2)
+ */
+static vrna_fold_compound_t *
+fold_with_allocator(const char  *sequence,
+                    int         alloc_mode,
+                    int         pf,
+                    int         max_bp_span,
+                    char        *mfe_structure,
+                    double      *mfe,
+                    double      *ens_en,
+                    size_t      *bytes)
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML     = 1;
+  md.max_bp_span = max_bp_span;
+
+  fc = vrna_fold_compound(sequence, &md, (pf) ? VRNA_OPTION_DEFAULT : VRNA_OPTION_MFE);
+
+  if (alloc_mode == 1)
+    vrna_mx_allocator_pages(fc, 0);
+  else if (alloc_mode == 2)
+    vrna_mx_allocator_set(fc, &mx_alloc_counting, &mx_release_counting, (void *)bytes);
+
+  *mfe = (double)vrna_mfe(fc, mfe_structure);
+
+  if (pf) {
+    vrna_exp_params_rescale(fc, mfe);
+    *ens_en = (double)vrna_pf(fc, NULL);
+  }
+
+  return fc;
+}
+
+
+/* not part of the API, enables the computation of the 3' distance class arrays in 2Dfold.c */
+extern int compute_2Dfold_F3;
+
+
+/*
+ *  Compute the distance class MFE matrices of a sequence with respect to two
+ *  reference structures up to a maximum distance, optionally including the
+ *  3' arrays E_F3
+ */
+static vrna_fold_compound_t *
+fold_TwoD(const char  *sequence,
+          const char  *s1,
+          const char  *s2,
+          int         max_dist,
+          int         with_F3)
+{
+  int                   i;
+  vrna_md_t             md;
+  vrna_sol_TwoD_t       *sol;
+  vrna_fold_compound_t  *fc;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML    = 1;
+  md.backtrack  = 0;
+
+  fc                = vrna_fold_compound_TwoD(sequence, s1, s2, &md, VRNA_OPTION_MFE);
+  compute_2Dfold_F3 = with_F3;
+  sol               = vrna_mfe_TwoD(fc, max_dist, max_dist);
+  compute_2Dfold_F3 = 0;
+
+  for (i = 0; sol[i].k != INF; i++)
+    free(sol[i].s);
+
+  free(sol);
+
+  return fc;
+}
+
+
+/* an alignment where rows 0, 3, 5 and rows 1, 4 are identical */
+static const char *aln_dup[] = {
+  "GCGGAUUUAGCUCAGUUGGGAGAGCGCCAGACUGAAGAUCUGGAGGUCCUGUGUUCGAUCCACAGAAUUCGCACCA",
+  "GCGGAUUUAGCUCAGUUGGGAGAGCGCC-GACUGAAGAUC-GGAGGUCCUGUGUUCGAUCCACAGAAUUCGC-CCA",
+  "GGGGCUAUAGCUCAGCUGGGAGAGCGCUUGCAUGGCAUGCAAGAGGUCAGCGGUUCGAUCCCGCUUAGCUCCACCA",
+  "GCGGAUUUAGCUCAGUUGGGAGAGCGCCAGACUGAAGAUCUGGAGGUCCUGUGUUCGAUCCACAGAAUUCGCACCA",
+  "GCGGAUUUAGCUCAGUUGGGAGAGCGCC-GACUGAAGAUC-GGAGGUCCUGUGUUCGAUCCACAGAAUUCGC-CCA",
+  "GCGGAUUUAGCUCAGUUGGGAGAGCGCCAGACUGAAGAUCUGGAGGUCCUGUGUUCGAUCCACAGAAUUCGCACCA",
+  NULL
+};
+
+
+/*
+ *  Predict the consensus MFE structure and equilibrium probabilities for an
+ *  alignment, optionally with identical sequences evaluated only once
+ */
+static vrna_fold_compound_t *
+fold_alignment(const char **aln,
+               int        dangles,
+               int        unique,
+               char       *structure,
+               double     *mfe,
+               double     *ens_en)
+{
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  vrna_md_set_default(&md);
+  md.dangles  = dangles;
+  md.uniq_ML  = 1;
+
+  fc = vrna_fold_compound_comparative(aln,
+                                      &md,
+                                      VRNA_OPTION_DEFAULT |
+                                      ((unique) ? VRNA_OPTION_ALN_UNIQUE : 0));
+
+  *mfe = (double)vrna_mfe(fc, structure);
+  vrna_exp_params_rescale(fc, mfe);
+  *ens_en = (double)vrna_pf(fc, NULL);
+
+  return fc;
+}
+
+
+static const char pf_update_seq[] =
+  "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+
+
+/*
+ *  Change the constraints of a fold compound in step 'step' of the
+ *  vrna_pf_update() test. Steps < 0 replace all hard constraints by a window
+ *  of 8 unpaired nucleotides starting at -step. Step 0 removes the window,
+ *  steps 1 and 2 add soft constraints for unpaired nucleotides, and step 3
+ *  enforces a base pair
+ */
+static void
+pf_update_constraints(vrna_fold_compound_t  *fc,
+                      int                   step)
+{
+  int p;
+
+  switch (step) {
+    case 0:
+      vrna_hc_init(fc);
+      break;
+
+    case 1:
+      for (p = 20; p <= 25; p++)
+        vrna_sc_add_up(fc, p, -1.5, VRNA_OPTION_DEFAULT);
+      break;
+
+    case 2:
+      for (p = 90; p <= 92; p++)
+        vrna_sc_add_up(fc, p, 2.0, VRNA_OPTION_DEFAULT);
+      break;
+
+    case 3:
+      vrna_hc_add_bp(fc,
+                     41,
+                     60,
+                     VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS | VRNA_CONSTRAINT_CONTEXT_ENFORCE);
+      break;
+
+    default:
+      vrna_hc_init(fc);
+      for (p = -step; p < -step + 8; p++)
+        vrna_hc_add_up(fc, p, VRNA_CONSTRAINT_CONTEXT_ALL_LOOPS);
+      break;
+  }
+}
+
+
+/*
+ *  Compare the result of an update of fc, after the changes of 'step' to the
+ *  constraints of nucleotides i to j, against a fresh vrna_pf(). The fresh
+ *  fold compound receives the changes of all steps up to 'step', or only the
+ *  current window for steps < 0
+ */
+static void
+pf_update_check(vrna_fold_compound_t  *fc,
+                int                   step,
+                unsigned int          i,
+                unsigned int          j)
+{
+  unsigned int          k, l, n;
+  int                   s, *iindx;
+  char                  *s1, *s2;
+  double                G1, G2;
+  vrna_fold_compound_t  *ref;
+
+  n   = (unsigned int)fc->length;
+  s1  = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  s2  = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  ref = vrna_fold_compound(pf_update_seq, &(fc->params->model_details), VRNA_OPTION_DEFAULT);
+
+  pf_update_constraints(fc, step);
+
+  if (step < 0)
+    pf_update_constraints(ref, step);
+  else
+    for (s = 0; s <= step; s++)
+      pf_update_constraints(ref, s);
+
+  G1 = (double)vrna_pf_update(fc, i, j, s1);
+  G2 = (double)vrna_pf(ref, s2);
+
+  ck_assert_msg(fabs(G1 - G2) < 1e-6,
+                "Ensemble free energy after update of [%u, %u] in step %d differs: %g vs. %g",
+                i, j, step, G1, G2);
+  ck_assert_str_eq(s1, s2);
+
+  iindx = fc->iindx;
+
+  for (k = 1; k < n; k++)
+    for (l = k + 1; l <= n; l++)
+      ck_assert_msg(fabs(fc->exp_matrices->probs[iindx[k] - l] -
+                         ref->exp_matrices->probs[iindx[k] - l]) < 1e-9,
+                    "Probability of pair (%u, %u) after update of [%u, %u] in step %d differs",
+                    k, l, i, j, step);
+
+  vrna_fold_compound_free(ref);
+  free(s1);
+  free(s2);
+}
+
+
 
 #suite  MFE_Prediction
 
@@ -55,6 +315,41 @@
   vrna_fold_compound_free(vc);
 }
 
+
+#tcase Incremental_Updates
+
+#test test_pf_update
+{
+  unsigned int          start, n;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  vrna_md_set_default(&md);
+  md.uniq_ML = 1;
+
+  n   = sizeof(pf_update_seq) - 1;
+  fc  = vrna_fold_compound(pf_update_seq, &md, VRNA_OPTION_DEFAULT);
+
+  vrna_pf(fc, NULL);
+
+  /* block one window after the other, the previous and current window changed */
+  for (start = 1; start + 7 <= n; start += 7)
+    pf_update_check(fc, -(int)start, MAX2(1, (int)start - 7), MIN2(n, start + 7));
+
+  /* remove the last window */
+  start -= 7;
+  pf_update_check(fc, 0, start, start + 7);
+
+  /* soft constraints for unpaired nucleotides in two separate regions */
+  pf_update_check(fc, 1, 20, 25);
+  pf_update_check(fc, 2, 90, 92);
+
+  /* an enforced base pair */
+  pf_update_check(fc, 3, 41, 60);
+
+  vrna_fold_compound_free(fc);
+}
+
 #suite  Constraints_Implementation
 
 #tcase  Soft_Constraints
@@ -144,5 +439,246 @@
 }
 
 
+#suite  DP_Matrices
+
+#tcase  Allocators
+
+#test test_mx_allocator_pages
+{
+  /*
+   *  The sequence is long enough for the MFE and PF matrices to exceed the
+   *  size threshold of the page allocator, i.e. they are actually mapped.
+   *  To keep the running time low, the base pair span is limited, which
+   *  does not affect the size of the matrices, and equilibrium probabilities
+   *  are computed for a shorter prefix only
+   */
+  int                   i, j, n = 1100, n_pf = 750;
+  char                  *sequence, *s1, *s2;
+  double                mfe1, mfe2, en1, en2;
+  vrna_fold_compound_t  *fc1, *fc2;
+
+  srand(4711);
+  sequence  = vrna_random_string(n, "ACGU");
+  s1        = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  s2        = (char *)vrna_alloc(sizeof(char) * (n + 1));
+
+  fc1 = fold_with_allocator(sequence, 0, 0, 100, s1, &mfe1, NULL, NULL);
+  fc2 = fold_with_allocator(sequence, 1, 0, 100, s2, &mfe2, NULL, NULL);
+
+  ck_assert_str_eq(s1, s2);
+  ck_assert(mfe1 == mfe2);
+
+  for (i = 1; i < n; i++)
+    for (j = i + 1; j <= n; j++) {
+      ck_assert(fc1->matrices->c[fc1->jindx[j] + i] == fc2->matrices->c[fc2->jindx[j] + i]);
+      ck_assert(fc1->matrices->fML[fc1->jindx[j] + i] == fc2->matrices->fML[fc2->jindx[j] + i]);
+    }
+
+  vrna_fold_compound_free(fc1);
+  vrna_fold_compound_free(fc2);
+
+  sequence[n_pf] = '\0';
+
+  fc1 = fold_with_allocator(sequence, 0, 1, 100, s1, &mfe1, &en1, NULL);
+  fc2 = fold_with_allocator(sequence, 1, 1, 100, s2, &mfe2, &en2, NULL);
+
+  ck_assert(en1 == en2);
+
+  for (i = 1; i < n_pf; i++)
+    for (j = i + 1; j <= n_pf; j++)
+      ck_assert(fc1->exp_matrices->probs[fc1->iindx[i] - j] ==
+                fc2->exp_matrices->probs[fc2->iindx[i] - j]);
+
+  vrna_fold_compound_free(fc1);
+  vrna_fold_compound_free(fc2);
+  free(sequence);
+  free(s1);
+  free(s2);
+}
+
+
+#test test_mx_allocator_user
+{
+  const char            sequence[] =
+    "UGCCUGGCGGCCGUAGCGCGGUGGUCCCACCUGACCCCAUGCCGAACUCAGAAGUGAAACGCCGUAGCGCCGAUGGUAGUGUGGGGUCUCCCCAUGCGAGAGUAGGGAACUGCCAGGCAU";
+  int                   i, j, n = sizeof(sequence) - 1;
+  char                  s1[sizeof(sequence)], s2[sizeof(sequence)];
+  double                mfe1, mfe2, en1, en2;
+  size_t                bytes = 0;
+  vrna_fold_compound_t  *fc1, *fc2;
+
+  mx_alloc_calls    = 0;
+  mx_release_calls  = 0;
+
+  fc1 = fold_with_allocator(sequence, 0, 1, -1, s1, &mfe1, &en1, NULL);
+  fc2 = fold_with_allocator(sequence, 2, 1, -1, s2, &mfe2, &en2, &bytes);
+
+  ck_assert(mx_alloc_calls > 0);
+  ck_assert(bytes > 0);
+
+  ck_assert_str_eq(s1, s2);
+  ck_assert(mfe1 == mfe2);
+  ck_assert(en1 == en2);
+
+  for (i = 1; i < n; i++)
+    for (j = i + 1; j <= n; j++)
+      ck_assert(fc1->exp_matrices->probs[fc1->iindx[i] - j] ==
+                fc2->exp_matrices->probs[fc2->iindx[i] - j]);
+
+  vrna_fold_compound_free(fc1);
+  vrna_fold_compound_free(fc2);
+
+  /* all memory is returned through the allocator it was obtained from */
+  ck_assert_int_eq(mx_release_calls, mx_alloc_calls);
+  ck_assert_int_eq(bytes, 0);
+}
+
+
+#tcase  Memory_Generation
+
+#test test_mx_mem_generation
+{
+  const char            sequence[] = "GGGGAAAACCCCAUAUGGGAAACCCU";
+  char                  structure[sizeof(sequence)];
+  unsigned int          generation;
+  vrna_fold_compound_t  *fc;
+
+  fc = vrna_fold_compound(sequence, NULL, VRNA_OPTION_DEFAULT);
+
+  /* matrices that are kept and re-used do not change the generation */
+  (void)vrna_mfe(fc, structure);
+  generation = fc->mem_generation;
+  (void)vrna_mfe(fc, structure);
+  ck_assert_int_eq(fc->mem_generation, generation);
+
+  /* adding partition function matrices leaves the MFE matrices in place */
+  (void)vrna_pf(fc, structure);
+  ck_assert_int_eq(fc->mem_generation, generation);
+  (void)vrna_pf(fc, structure);
+  ck_assert_int_eq(fc->mem_generation, generation);
+
+  /* releasing or replacing matrices invalidates all memory handed out before */
+  vrna_mx_pf_free(fc);
+  ck_assert_int_gt(fc->mem_generation, generation);
+  generation = fc->mem_generation;
+
+  vrna_mx_mfe_add(fc, VRNA_MX_DEFAULT, VRNA_OPTION_MFE);
+  ck_assert_int_gt(fc->mem_generation, generation);
+  generation = fc->mem_generation;
+
+  /* so does adding a strand */
+  vrna_sequence_add(fc, "GGGAAACCC", VRNA_SEQUENCE_RNA);
+  ck_assert_int_gt(fc->mem_generation, generation);
+
+  vrna_fold_compound_free(fc);
+}
+
+
+#suite  Distance_Class_Prediction
+
+#tcase  Auxiliary_Arrays
+
+#test test_TwoD_F3_boundaries
+{
+  /*
+   *  The E_F3 arrays are filled after E_F5 and must not touch the latter.
+   *  Their first entry spans the entire sequence, just as the last entry
+   *  of E_F5 does, hence both must hold the same distance class energies
+   */
+  const char            sequence[] = "GGGGAAAACCCCAUAUGGGAAACCCUAGCUAGCAUCGAUCGACUAGC";
+  const char            s1[]       = "((((....))))....(((...)))......................";
+  const char            s2[]       = "......................((((...........))))......";
+  int                   d, j, k, l, n = sizeof(sequence) - 1;
+  int                   max_dist[] = {
+    -1, 6
+  };
+  vrna_mx_mfe_t         *m1, *m2;
+  vrna_fold_compound_t  *fc1, *fc2;
+
+  for (d = 0; d < 2; d++) {
+    fc1 = fold_TwoD(sequence, s1, s2, max_dist[d], 0);
+    fc2 = fold_TwoD(sequence, s1, s2, max_dist[d], 1);
+    m1  = fc1->matrices;
+    m2  = fc2->matrices;
+
+    for (j = 1; j <= n; j++) {
+      ck_assert_int_eq(m2->k_min_F5[j], m1->k_min_F5[j]);
+      ck_assert_int_eq(m2->k_max_F5[j], m1->k_max_F5[j]);
+      ck_assert_int_eq(m2->E_F5_rem[j], m1->E_F5_rem[j]);
+
+      for (k = m1->k_min_F5[j]; k <= m1->k_max_F5[j]; k++) {
+        ck_assert_int_eq(m2->l_min_F5[j][k], m1->l_min_F5[j][k]);
+        ck_assert_int_eq(m2->l_max_F5[j][k], m1->l_max_F5[j][k]);
+
+        if (m1->l_min_F5[j][k] < INF)
+          for (l = m1->l_min_F5[j][k]; l <= m1->l_max_F5[j][k]; l += 2)
+            ck_assert_int_eq(m2->E_F5[j][k][l / 2], m1->E_F5[j][k][l / 2]);
+      }
+    }
+
+    ck_assert_int_eq(m2->E_F3_rem[1], m2->E_F5_rem[n]);
+    ck_assert_int_eq(m2->k_min_F3[1], m2->k_min_F5[n]);
+    ck_assert_int_eq(m2->k_max_F3[1], m2->k_max_F5[n]);
+
+    for (k = m2->k_min_F3[1]; k <= m2->k_max_F3[1]; k++) {
+      ck_assert_int_eq(m2->l_min_F3[1][k], m2->l_min_F5[n][k]);
+      ck_assert_int_eq(m2->l_max_F3[1][k], m2->l_max_F5[n][k]);
+
+      if (m2->l_min_F3[1][k] < INF)
+        for (l = m2->l_min_F3[1][k]; l <= m2->l_max_F3[1][k]; l += 2)
+          ck_assert_int_eq(m2->E_F3[1][k][l / 2], m2->E_F5[n][k][l / 2]);
+    }
+
+    vrna_fold_compound_free(fc1);
+    vrna_fold_compound_free(fc2);
+  }
+}
+
+
+#suite  Comparative_Prediction
+
+#tcase  Unique_Sequences
+
+#test test_aln_unique
+{
+  int                   d, i, j, n = (int)strlen(aln_dup[0]);
+  int                   dangles[] = {
+    0, 2
+  };
+  char                  *s_all, *s_uniq;
+  double                mfe_all, mfe_uniq, ens_all, ens_uniq;
+  FLT_OR_DBL            *p_all, *p_uniq;
+  vrna_fold_compound_t  *fc_all, *fc_uniq;
+
+  s_all   = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  s_uniq  = (char *)vrna_alloc(sizeof(char) * (n + 1));
+
+  for (d = 0; d < 2; d++) {
+    fc_all  = fold_alignment(aln_dup, dangles[d], 0, s_all, &mfe_all, &ens_all);
+    fc_uniq = fold_alignment(aln_dup, dangles[d], 1, s_uniq, &mfe_uniq, &ens_uniq);
+
+    ck_assert_int_eq(fc_uniq->n_seq, fc_all->n_seq);
+    ck_assert_int_eq(fc_uniq->n_seq_unique, 3);
+
+    /* weighting the distinct sequences yields the very same energies */
+    ck_assert(mfe_uniq == mfe_all);
+    ck_assert_str_eq(s_uniq, s_all);
+    ck_assert(fabs(ens_uniq - ens_all) < 1e-6);
+
+    p_all   = fc_all->exp_matrices->probs;
+    p_uniq  = fc_uniq->exp_matrices->probs;
+    for (i = 1; i < n; i++)
+      for (j = i + 1; j <= n; j++)
+        ck_assert(fabs(p_uniq[fc_all->iindx[i] - j] - p_all[fc_all->iindx[i] - j]) < 1e-9);
+
+    vrna_fold_compound_free(fc_all);
+    vrna_fold_compound_free(fc_uniq);
+  }
+
+  free(s_all);
+  free(s_uniq);
+}
+
+
 #main-pre
     srunner_set_tap(sr, "-");
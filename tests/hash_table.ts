@@ -1,8 +1,16 @@
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <ViennaRNA/datastructures/hash_tables.h>
 #include <stdarg.h>
 
+#ifdef VRNA_WITH_PTHREADS
+#include <pthread.h>
+#endif
+
 
 static unsigned
 hash_function_test(void           *hash_entry,
@@ -12,6 +20,14 @@ hash_function_test(void           *hash_entry,
 }
 
 
+static unsigned
+hash_function_int(void          *hash_entry,
+                  unsigned long hashtable_size)
+{
+  return *((unsigned int *)hash_entry) % hashtable_size;
+}
+
+
 static int
 hash_comparison_test(void *x,
                      void *y)
@@ -33,6 +49,58 @@ free_dummy(void *x)
 }
 
 
+#ifdef VRNA_WITH_PTHREADS
+
+#define HT_THREADS  8
+
+typedef struct {
+  vrna_hash_table_t ht;
+  unsigned int      *vals;
+  unsigned int      n;
+  unsigned int      thread;
+  unsigned int      errors;
+} ht_worker_data;
+
+
+/*
+ *  Each thread inserts every HT_THREADS-th value, starting at its own
+ *  offset, reads back its own and its neighbor's values, and finally
+ *  removes every other of its own values again
+ */
+static void *
+ht_worker(void *arg)
+{
+  ht_worker_data  *d = (ht_worker_data *)arg;
+  unsigned int    i, *res, other;
+
+  other = (d->thread + 1) % HT_THREADS;
+
+  for (i = d->thread; i < d->n; i += HT_THREADS)
+    if (vrna_ht_insert(d->ht, (void *)&(d->vals[i])) != 0)
+      d->errors++;
+
+  for (i = d->thread; i < d->n; i += HT_THREADS) {
+    res = vrna_ht_get(d->ht, (void *)&(d->vals[i]));
+    if ((res == NULL) || (*res != d->vals[i]))
+      d->errors++;
+
+    /* entries of other threads may or may not be present yet */
+    if (i - d->thread + other < d->n) {
+      res = vrna_ht_get(d->ht, (void *)&(d->vals[i - d->thread + other]));
+      if ((res) && (*res != d->vals[i - d->thread + other]))
+        d->errors++;
+    }
+  }
+
+  for (i = d->thread; i < d->n; i += 2 * HT_THREADS)
+    vrna_ht_remove(d->ht, (void *)&(d->vals[i]));
+
+  return NULL;
+}
+
+
+#endif
+
 #suite Hash Table
 
 #test test_vrna_hash_table
@@ -79,5 +147,105 @@ free_dummy(void *x)
 }
 
 
+#test test_vrna_hash_table_resize
+{
+  /* start with a tiny table and let it grow */
+  unsigned int      i, n = 10000;
+  unsigned int      *vals = (unsigned int *)malloc(sizeof(unsigned int) * n);
+  vrna_hash_table_t ht    = vrna_ht_init(1,
+                                         hash_comparison_test,
+                                         hash_function_int,
+                                         free_dummy);
+
+  for (i = 0; i < n; i++) {
+    vals[i] = 3 * i;
+    ck_assert_int_eq(vrna_ht_insert(ht, (void *)&(vals[i])), 0);
+  }
+
+  ck_assert_int_eq(vrna_ht_count(ht), n);
+  ck_assert(vrna_ht_size(ht) >= n);
+
+  /* inserting an entry a second time does not change anything */
+  ck_assert_int_eq(vrna_ht_insert(ht, (void *)&(vals[7])), 0);
+  ck_assert_int_eq(vrna_ht_count(ht), n);
+
+  for (i = 0; i < n; i += 2)
+    vrna_ht_remove(ht, (void *)&(vals[i]));
+
+  ck_assert_int_eq(vrna_ht_count(ht), n / 2);
+
+  for (i = 0; i < n; i++) {
+    unsigned int  x     = 3 * i;
+    unsigned int  *res  = vrna_ht_get(ht, (void *)&x);
+    if (i % 2) {
+      ck_assert_ptr_ne(res, NULL);
+      ck_assert_int_eq(*res, x);
+    } else {
+      ck_assert_ptr_eq(res, NULL);
+    }
+  }
+
+  vrna_ht_free(ht);
+  free(vals);
+}
+
+
+#test test_vrna_hash_table_concurrent
+{
+  /* the concurrent variant is only locked if the library uses pthreads */
+#ifdef VRNA_WITH_PTHREADS
+  unsigned int      i, n = 50000, expected;
+  unsigned int      *vals = (unsigned int *)malloc(sizeof(unsigned int) * n);
+  pthread_t         threads[HT_THREADS];
+  ht_worker_data    data[HT_THREADS];
+  vrna_hash_table_t ht = vrna_ht_init_concurrent(4,
+                                                 8,
+                                                 hash_comparison_test,
+                                                 hash_function_int,
+                                                 free_dummy);
+
+  ck_assert_ptr_ne(ht, NULL);
+
+  for (i = 0; i < n; i++)
+    vals[i] = 7 * i;
+
+  for (i = 0; i < HT_THREADS; i++) {
+    data[i].ht      = ht;
+    data[i].vals    = vals;
+    data[i].n       = n;
+    data[i].thread  = i;
+    data[i].errors  = 0;
+    ck_assert_int_eq(pthread_create(&(threads[i]), NULL, ht_worker, (void *)&(data[i])), 0);
+  }
+
+  for (i = 0; i < HT_THREADS; i++) {
+    ck_assert_int_eq(pthread_join(threads[i], NULL), 0);
+    ck_assert_int_eq(data[i].errors, 0);
+  }
+
+  /* every thread removed the values at positions i with i % (2 * HT_THREADS) < HT_THREADS */
+  for (expected = 0, i = 0; i < n; i++) {
+    unsigned int *res = vrna_ht_get(ht, (void *)&(vals[i]));
+    if (i % (2 * HT_THREADS) < HT_THREADS) {
+      ck_assert_ptr_eq(res, NULL);
+    } else {
+      ck_assert_ptr_ne(res, NULL);
+      ck_assert_int_eq(*res, vals[i]);
+      expected++;
+    }
+  }
+
+  ck_assert_int_eq(vrna_ht_count(ht), expected);
+
+  vrna_ht_clear(ht);
+  ck_assert_int_eq(vrna_ht_count(ht), 0);
+  ck_assert_ptr_eq(vrna_ht_get(ht, (void *)&(vals[HT_THREADS])), NULL);
+
+  vrna_ht_free(ht);
+  free(vals);
+#endif
+}
+
+
 #main-pre
     srunner_set_tap(sr, "-");
@@ -0,0 +1,300 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <ViennaRNA/fold_compound.h>
+#include <ViennaRNA/model.h>
+#include <ViennaRNA/mfe.h>
+#include <ViennaRNA/part_func.h>
+#include <ViennaRNA/combinatorics.h>
+#include <ViennaRNA/concentrations.h>
+#include <ViennaRNA/wrap_dlib.h>
+#include <ViennaRNA/utils/basic.h>
+#include <ViennaRNA/utils/strings.h>
+
+static const char *ms_strands[] = {
+  "GGGAAACCCAGUCU", "AGACUGGGUUUCCC", "UUCGAAGCGAA"
+};
+
+
+/* ensemble free energy of a single strand permutation via vrna_pf() */
+static double
+pf_permutation(const unsigned int *perm,
+               size_t             k,
+               vrna_md_t          *md)
+{
+  size_t                i;
+  char                  *sequence;
+  double                mfe, dG;
+  vrna_fold_compound_t  *fc;
+
+  sequence = vrna_strdup_printf("%s", ms_strands[perm[0]]);
+  for (i = 1; i < k; i++)
+    vrna_strcat_printf(&sequence, "&%s", ms_strands[perm[i]]);
+
+  fc  = vrna_fold_compound(sequence, md, VRNA_OPTION_DEFAULT);
+  mfe = (double)vrna_mfe(fc, NULL);
+  vrna_exp_params_rescale(fc, &mfe);
+  dG = (double)vrna_pf(fc, NULL);
+
+  vrna_fold_compound_free(fc);
+  free(sequence);
+
+  return dG;
+}
+
+
+static unsigned int ***
+all_complexes(size_t  strands,
+              size_t  max_strands)
+{
+  size_t        k;
+  unsigned int  ***complexes = (unsigned int ***)vrna_alloc(sizeof(unsigned int **) *
+                                                            (max_strands + 1));
+
+  for (k = 1; k <= max_strands; k++)
+    complexes[k] = vrna_n_multichoose_k(strands, k);
+
+  return complexes;
+}
+
+
+static void
+free_complexes(unsigned int ***complexes,
+               double       **dG,
+               size_t       max_strands)
+{
+  size_t k, c;
+
+  for (k = 1; k <= max_strands; k++) {
+    for (c = 0; complexes[k][c]; c++)
+      free(complexes[k][c]);
+    free(complexes[k]);
+    if (dG)
+      free(dG[k]);
+  }
+
+  free(complexes);
+  free(dG);
+}
+
+
+/* progress of vrna_pf_complexes_cb(): counts the reported complexes of each size */
+struct complex_progress {
+  size_t  calls;
+  size_t  total;
+  size_t  per_size[4];
+};
+
+
+static void
+count_complexes(size_t              done,
+                size_t              total,
+                const unsigned int  *strands,
+                size_t              size,
+                void                *data)
+{
+  struct complex_progress *progress = (struct complex_progress *)data;
+
+  progress->calls++;
+  progress->total = total;
+  progress->per_size[size]++;
+
+  ck_assert_int_eq(done, progress->calls);
+  ck_assert(done <= total);
+  ck_assert(strands[size - 1] < 3);
+}
+
+
+#suite Multi_Strand
+
+#tcase Complexes
+
+#test test_vrna_pf_complexes
+{
+  size_t                  k, c, strands = 3;
+  unsigned int            ***complexes, *p, perm[3];
+  double                  **dG, **dG_par, ref, kT;
+  char                    *input;
+  vrna_md_t               md;
+  vrna_fold_compound_t    *fc;
+  struct complex_progress progress;
+
+  vrna_md_set_default(&md);
+  md.compute_bpp = 0;
+
+  kT    = (md.temperature + K0) * GASCONST / 1000.;
+  input = vrna_strdup_printf("%s&%s&%s", ms_strands[0], ms_strands[1], ms_strands[2]);
+  fc    = vrna_fold_compound(input, &md, VRNA_OPTION_DEFAULT);
+
+  complexes = all_complexes(strands, strands);
+  dG        = vrna_pf_complexes(fc, complexes, strands, &md, 1);
+  ck_assert_ptr_ne(dG, NULL);
+
+  for (k = 1; k <= strands; k++)
+    for (c = 0; complexes[k][c]; c++) {
+      p = complexes[k][c];
+
+      /*
+       *  complexes are listed with non-decreasing strand numbers. All other
+       *  non-cyclic permutations only exist for three distinct strands
+       */
+      ref = pf_permutation(p, k, &md);
+
+      if ((k == 3) && (p[0] != p[1]) && (p[1] != p[2])) {
+        perm[0] = p[0];
+        perm[1] = p[2];
+        perm[2] = p[1];
+        ref     = vrna_pf_add(ref, pf_permutation(perm, k, &md), kT);
+      }
+
+      ck_assert(fabs(dG[k][c] - ref) < 1e-9);
+    }
+
+  /* the result does not depend on the number of threads */
+  dG_par = vrna_pf_complexes(fc, complexes, strands, &md, 4);
+  ck_assert_ptr_ne(dG_par, NULL);
+
+  for (k = 1; k <= strands; k++) {
+    for (c = 0; complexes[k][c]; c++)
+      ck_assert(dG_par[k][c] == dG[k][c]);
+    free(dG_par[k]);
+  }
+
+  free(dG_par);
+
+  /* every complex is reported exactly once, also with several threads */
+  memset(&progress, 0, sizeof(struct complex_progress));
+  dG_par = vrna_pf_complexes_cb(fc, complexes, strands, &md, 4, &count_complexes, &progress);
+  ck_assert_ptr_ne(dG_par, NULL);
+
+  for (k = 1; k <= strands; k++) {
+    for (c = 0; complexes[k][c]; c++)
+      ck_assert(dG_par[k][c] == dG[k][c]);
+    ck_assert_int_eq(progress.per_size[k], c);
+    free(dG_par[k]);
+  }
+
+  ck_assert_int_eq(progress.calls, progress.total);
+  free(dG_par);
+
+  /* invalid input */
+  ck_assert_ptr_eq(vrna_pf_complexes(NULL, complexes, strands, &md, 1), NULL);
+  ck_assert_ptr_eq(vrna_pf_complexes(fc, NULL, strands, &md, 1), NULL);
+  ck_assert_ptr_eq(vrna_pf_complexes(fc, complexes, 0, &md, 1), NULL);
+  ck_assert_ptr_eq(vrna_pf_complexes(fc, complexes, strands + 1, &md, 1), NULL);
+
+  free_complexes(complexes, dG, strands);
+  vrna_fold_compound_free(fc);
+  free(input);
+}
+
+
+#tcase Concentrations
+
+#test test_vrna_equilibrium_conc_batch
+{
+  /* two strands A and B that form the complexes AB, AA, and BB */
+  size_t        p, a, k, strands = 2, cmplx = 3, num_points = 80;
+  unsigned int  A_row0[] = {
+    1, 2, 0
+  };
+  unsigned int  A_row1[] = {
+    1, 0, 2
+  };
+  unsigned int  *A[] = {
+    A_row0, A_row1
+  };
+  double        dG_complexes[] = {
+    -21.3, -9.7, -11.2
+  };
+  double        dG_strands[] = {
+    -4.1, -3.6
+  };
+  double        kT, *K, *c_tot, *c_batch, *c_par, *conc, *conc_par, *c_single, *conc_single;
+
+  kT = (37. + K0) * GASCONST / 1000.;
+  K  = vrna_equilibrium_constants(dG_complexes,
+                                  dG_strands,
+                                  (const unsigned int **)A,
+                                  kT,
+                                  strands,
+                                  cmplx);
+  ck_assert_ptr_ne(K, NULL);
+
+  /* a titration series that spans several blocks of the batch solver */
+  c_tot = (double *)vrna_alloc(sizeof(double) * num_points * strands);
+  for (p = 0; p < num_points; p++) {
+    c_tot[p * strands]      = 1e-6 * (double)(p + 1);
+    c_tot[p * strands + 1]  = 1e-6 * (double)(num_points - p) / 3.;
+  }
+
+  c_batch = (double *)vrna_alloc(sizeof(double) * num_points * strands);
+  c_par   = (double *)vrna_alloc(sizeof(double) * num_points * strands);
+  memcpy(c_batch, c_tot, sizeof(double) * num_points * strands);
+  memcpy(c_par, c_tot, sizeof(double) * num_points * strands);
+
+  conc = vrna_equilibrium_conc_batch(K,
+                                     c_batch,
+                                     num_points,
+                                     (const unsigned int **)A,
+                                     strands,
+                                     cmplx,
+                                     1);
+  conc_par = vrna_equilibrium_conc_batch(K,
+                                         c_par,
+                                         num_points,
+                                         (const unsigned int **)A,
+                                         strands,
+                                         cmplx,
+                                         4);
+
+  ck_assert_ptr_ne(conc, NULL);
+  ck_assert_ptr_ne(conc_par, NULL);
+
+  c_single = (double *)vrna_alloc(sizeof(double) * strands);
+
+  for (p = 0; p < num_points; p++) {
+    /* the result does not depend on the number of threads */
+    for (a = 0; a < strands; a++)
+      ck_assert(c_par[p * strands + a] == c_batch[p * strands + a]);
+
+    for (k = 0; k < cmplx; k++)
+      ck_assert(conc_par[p * cmplx + k] == conc[p * cmplx + k]);
+
+    /* and is the same as solving each point individually */
+    memcpy(c_single, c_tot + p * strands, sizeof(double) * strands);
+    conc_single = vrna_equilibrium_conc(K,
+                                        c_single,
+                                        (const unsigned int **)A,
+                                        strands,
+                                        cmplx);
+
+    for (a = 0; a < strands; a++)
+      ck_assert(fabs(c_single[a] - c_batch[p * strands + a]) <= 1e-5 * c_single[a]);
+
+    for (k = 0; k < cmplx; k++)
+      ck_assert(fabs(conc_single[k] - conc[p * cmplx + k]) <= 1e-5 * conc_single[k]);
+
+    /* total strand concentrations are conserved */
+    ck_assert(fabs(c_batch[p * strands] + conc[p * cmplx] + 2. * conc[p * cmplx + 1] -
+                   c_tot[p * strands]) <= 1e-5 * c_tot[p * strands]);
+    ck_assert(fabs(c_batch[p * strands + 1] + conc[p * cmplx] + 2. * conc[p * cmplx + 2] -
+                   c_tot[p * strands + 1]) <= 1e-5 * c_tot[p * strands + 1]);
+
+    free(conc_single);
+  }
+
+  free(c_single);
+  free(conc);
+  free(conc_par);
+  free(c_batch);
+  free(c_par);
+  free(c_tot);
+  free(K);
+}
+
+
+#main-pre
+    srunner_set_tap(sr, "-");
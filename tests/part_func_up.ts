@@ -0,0 +1,192 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <ViennaRNA/fold_vars.h>
+#include <ViennaRNA/fold_compound.h>
+#include <ViennaRNA/model.h>
+#include <ViennaRNA/fold.h>
+#include <ViennaRNA/mfe.h>
+#include <ViennaRNA/part_func.h>
+#include <ViennaRNA/part_func_up.h>
+#include <ViennaRNA/utils/basic.h>
+
+static const char *up_s1 =
+  "GGGAAACCCAUAGCUAGCUAGCAUCGAUCGAUCGUAGCUAGCUAGCUUUCGAGCGAUCGAUGCAUGCAUGCUAGCUAGUCGAUCGAUGC";
+static const char *up_s2 = "GCAUGCUAGCUAGCUAGGCU";
+static const char *up_s3 =
+  "UUAGGCCGAUAGCGCAAGCUUCGGCUAAUCCGAUGGCAUCAGGCUAGCGAUUCGC";
+
+
+static int
+rel_eq(double a,
+       double b)
+{
+  return fabs(a - b) <= 1e-10 * MAX2(1., MAX2(fabs(a), fabs(b)));
+}
+
+
+static int
+pu_contrib_eq(pu_contrib  *a,
+              pu_contrib  *b)
+{
+  int i, j;
+
+  if ((a->length != b->length) ||
+      (a->w != b->w))
+    return 0;
+
+  for (i = 1; i <= a->length; i++)
+    for (j = 0; j < a->w; j++)
+      if ((!rel_eq(a->H[i][j], b->H[i][j])) ||
+          (!rel_eq(a->I[i][j], b->I[i][j])) ||
+          (!rel_eq(a->M[i][j], b->M[i][j])) ||
+          (!rel_eq(a->E[i][j], b->E[i][j])))
+        return 0;
+
+  return 1;
+}
+
+
+/* the legacy way of obtaining unpaired probabilities via global pf arrays */
+static pu_contrib *
+legacy_pf_unstru(const char *s,
+                 int        w)
+{
+  int         n = (int)strlen(s);
+  char        *structure = (char *)vrna_alloc(sizeof(char) * (n + 1));
+  double      min_en;
+  pu_contrib  *p;
+
+  min_en    = (double)fold(s, structure);
+  pf_scale  = exp(-(1.07 * min_en) / (GASCONST / 1000. * (temperature + K0)) / n);
+
+  init_pf_fold(n);
+  pf_fold(s, structure);
+  p = pf_unstru((char *)s, w);
+  free_pf_arrays();
+  free_arrays();
+  free(structure);
+
+  return p;
+}
+
+
+static vrna_fold_compound_t *
+prepare_fc(const char *s,
+           vrna_md_t  *md)
+{
+  double                min_en;
+  vrna_fold_compound_t  *fc = vrna_fold_compound(s, md, VRNA_OPTION_DEFAULT);
+
+  min_en = (double)vrna_mfe(fc, NULL);
+  vrna_exp_params_rescale(fc, &min_en);
+  vrna_pf(fc, NULL);
+
+  return fc;
+}
+
+
+#suite RNAup
+
+#tcase Reentrant_Interface
+
+#test test_vrna_pf_unstru_interact
+{
+  int                   i, w = 20, n1 = (int)strlen(up_s1);
+  pu_contrib            *p1_old, *p2_old, *p1, *p2;
+  interact              *I_old, *I;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc;
+
+  p1_old  = legacy_pf_unstru(up_s1, w);
+  p2_old  = legacy_pf_unstru(up_s2, w);
+  I_old   = pf_interact(up_s1, up_s2, p1_old, p2_old, w, NULL, 0, 0);
+
+  vrna_md_set_default(&md);
+  md.compute_bpp = 1;
+
+  fc  = prepare_fc(up_s1, &md);
+  p1  = vrna_pf_unstru(fc, w);
+  vrna_fold_compound_free(fc);
+
+  fc  = prepare_fc(up_s2, &md);
+  p2  = vrna_pf_unstru(fc, w);
+  vrna_fold_compound_free(fc);
+
+  ck_assert_ptr_ne(p1, NULL);
+  ck_assert_ptr_ne(p2, NULL);
+  ck_assert(pu_contrib_eq(p1, p1_old));
+  ck_assert(pu_contrib_eq(p2, p2_old));
+
+  I = vrna_pf_interact(up_s1, up_s2, p1, p2, w, NULL, 0, 0, &md);
+  ck_assert_ptr_ne(I, NULL);
+
+  ck_assert_int_eq(I->length, I_old->length);
+  ck_assert_int_eq(I->i, I_old->i);
+  ck_assert_int_eq(I->k, I_old->k);
+  ck_assert_int_eq(I->j, I_old->j);
+  ck_assert_int_eq(I->l, I_old->l);
+  ck_assert(rel_eq(I->Gikjl, I_old->Gikjl));
+  ck_assert(rel_eq(I->Gikjl_wo, I_old->Gikjl_wo));
+
+  for (i = 1; i <= n1; i++) {
+    ck_assert(rel_eq(I->Pi[i], I_old->Pi[i]));
+    ck_assert(rel_eq(I->Gi[i], I_old->Gi[i]));
+  }
+
+  free_interact(I);
+  free_interact(I_old);
+  free_pu_contrib_struct(p1);
+  free_pu_contrib_struct(p2);
+  free_pu_contrib_struct(p1_old);
+  free_pu_contrib_struct(p2_old);
+}
+
+
+#test test_vrna_pf_unstru_interleaved
+{
+  int                   w = 15;
+  pu_contrib            *p1_ref, *p3_ref, *p1, *p3;
+  vrna_md_t             md;
+  vrna_fold_compound_t  *fc1, *fc3;
+
+  vrna_md_set_default(&md);
+  md.compute_bpp = 1;
+
+  /* reference: each sequence processed on its own */
+  fc1     = prepare_fc(up_s1, &md);
+  p1_ref  = vrna_pf_unstru(fc1, w);
+  vrna_fold_compound_free(fc1);
+
+  fc3     = prepare_fc(up_s3, &md);
+  p3_ref  = vrna_pf_unstru(fc3, w);
+  vrna_fold_compound_free(fc3);
+
+  /* both partition functions first, then the unpaired contributions in reverse order */
+  fc1 = prepare_fc(up_s1, &md);
+  fc3 = prepare_fc(up_s3, &md);
+  p3  = vrna_pf_unstru(fc3, w);
+  p1  = vrna_pf_unstru(fc1, w);
+
+  ck_assert(pu_contrib_eq(p1, p1_ref));
+  ck_assert(pu_contrib_eq(p3, p3_ref));
+
+  /* fold compounds without base pair probabilities are rejected */
+  md.compute_bpp = 0;
+  vrna_fold_compound_free(fc3);
+  fc3 = prepare_fc(up_s3, &md);
+  ck_assert_ptr_eq(vrna_pf_unstru(fc3, w), NULL);
+
+  vrna_fold_compound_free(fc1);
+  vrna_fold_compound_free(fc3);
+  free_pu_contrib_struct(p1);
+  free_pu_contrib_struct(p3);
+  free_pu_contrib_struct(p1_ref);
+  free_pu_contrib_struct(p3_ref);
+}
+
+
+#main-pre
+    srunner_set_tap(sr, "-");
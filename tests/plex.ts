@@ -0,0 +1,255 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <ViennaRNA/model.h>
+#include <ViennaRNA/plex.h>
+#include <ViennaRNA/utils/basic.h>
+
+#define PLEX_TARGET_LENGTH  800
+#define PLEX_QUERY_LENGTH   25
+#define PLEX_MAX_LENGTH     40
+#define PLEX_QUERIES        5
+
+
+/* a reproducible random sequence padded with 10 'N' on each side, as in RNAplex */
+static char *
+plex_sequence(unsigned int  n,
+              unsigned int  *seed)
+{
+  unsigned int  i;
+  char          *s = (char *)vrna_alloc(sizeof(char) * (n + 21));
+
+  memset(s, 'N', n + 20);
+  for (i = 0; i < n; i++) {
+    *seed     = *seed * 1103515245U + 12345U;
+    s[i + 10] = "ACGU"[(*seed >> 16) % 4];
+  }
+
+  return s;
+}
+
+
+/* opening energies for up to PLEX_MAX_LENGTH unpaired nucleotides */
+static int **
+plex_access(const char *s)
+{
+  int i, u, n = (int)strlen(s);
+  int **a = (int **)vrna_alloc(sizeof(int *) * (PLEX_MAX_LENGTH + 1));
+
+  for (u = 0; u <= PLEX_MAX_LENGTH; u++) {
+    a[u] = (int *)vrna_alloc(sizeof(int) * (n + 1));
+    for (i = 0; i <= n; i++)
+      a[u][i] = u * (20 + i % 7);
+  }
+
+  a[0][0] = PLEX_MAX_LENGTH + 1;
+
+  return a;
+}
+
+
+static void
+plex_access_free(int **a)
+{
+  int u;
+
+  for (u = 0; u <= PLEX_MAX_LENGTH; u++)
+    free(a[u]);
+
+  free(a);
+}
+
+
+/* run Lduplexfold() or Lduplexfold_XS() and return everything they print */
+static char *
+plex_output(const char  *s1,
+            const char  *s2,
+            const int   **a1,
+            const int   **a2,
+            int         fast)
+{
+  int   fd;
+  long  size;
+  char  *out;
+  FILE  *tmp;
+
+  tmp = tmpfile();
+  if (!tmp)
+    return NULL;
+
+  fflush(stdout);
+  fd = dup(fileno(stdout));
+  dup2(fileno(tmp), fileno(stdout));
+
+  if (a1)
+    Lduplexfold_XS(s1, s2, a1, a2, -500, PLEX_MAX_LENGTH, 10, fast, 10, 0, 100, 0);
+  else
+    Lduplexfold(s1, s2, -500, 15, PLEX_MAX_LENGTH, 10, fast, 10, 0, 100, 0);
+
+  fflush(stdout);
+  dup2(fd, fileno(stdout));
+  close(fd);
+
+  size = ftell(tmp);
+  out  = (char *)vrna_alloc(sizeof(char) * (size + 1));
+  rewind(tmp);
+  if (fread(out, 1, size, tmp) != (size_t)size)
+    out[0] = '\0';
+
+  fclose(tmp);
+
+  return out;
+}
+
+
+#suite Plex
+
+#tcase SIMD_Dispatch
+
+#test test_Lduplexfold_scalar_fallback
+{
+  unsigned int  seed = 42, fast;
+  char          *s1, *s2, *scalar, *simd;
+
+  s1 = plex_sequence(PLEX_TARGET_LENGTH, &seed);
+  s2 = plex_sequence(PLEX_QUERY_LENGTH, &seed);
+
+  for (fast = 0; fast < 2; fast++) {
+    vrna_plex_dispatch_disable();
+    scalar = plex_output(s1, s2, NULL, NULL, fast);
+    vrna_plex_dispatch_enable();
+    simd = plex_output(s1, s2, NULL, NULL, fast);
+
+    ck_assert_ptr_ne(scalar, NULL);
+    ck_assert_ptr_ne(simd, NULL);
+    ck_assert(strlen(scalar) > 0);
+    ck_assert_str_eq(simd, scalar);
+
+    free(scalar);
+    free(simd);
+  }
+
+  free(s1);
+  free(s2);
+}
+
+
+#test test_Lduplexfold_XS_scalar_fallback
+{
+  unsigned int  seed = 7, fast;
+  int           **a1, **a2;
+  char          *s1, *s2, *scalar, *simd;
+
+  s1 = plex_sequence(PLEX_TARGET_LENGTH, &seed);
+  s2 = plex_sequence(PLEX_QUERY_LENGTH, &seed);
+  a1 = plex_access(s1);
+  a2 = plex_access(s2);
+
+  for (fast = 0; fast < 2; fast++) {
+    vrna_plex_dispatch_disable();
+    scalar = plex_output(s1, s2, (const int **)a1, (const int **)a2, fast);
+    vrna_plex_dispatch_enable();
+    simd = plex_output(s1, s2, (const int **)a1, (const int **)a2, fast);
+
+    ck_assert_ptr_ne(scalar, NULL);
+    ck_assert_ptr_ne(simd, NULL);
+    ck_assert(strlen(scalar) > 0);
+    ck_assert_str_eq(simd, scalar);
+
+    free(scalar);
+    free(simd);
+  }
+
+  plex_access_free(a1);
+  plex_access_free(a2);
+  free(s1);
+  free(s2);
+}
+
+
+#tcase Reentrant_Interface
+
+#test test_vrna_plex_batch
+{
+  unsigned int    seed = 23, q, acc;
+  int             jobs, **a1, **a2[PLEX_QUERIES];
+  char            *s1, *s2[PLEX_QUERIES + 1], *ref[PLEX_QUERIES], *out, **batch;
+  vrna_md_t       md;
+  vrna_plex_t     plex;
+  vrna_plex_opt_t opt = {
+    -500, PLEX_MAX_LENGTH, 10, 15, 0, 10, 0, 100, 0
+  };
+
+  vrna_md_set_default(&md);
+
+  s1 = plex_sequence(PLEX_TARGET_LENGTH, &seed);
+  a1 = plex_access(s1);
+  for (q = 0; q < PLEX_QUERIES; q++) {
+    s2[q] = plex_sequence(PLEX_QUERY_LENGTH - 2 * q, &seed);
+    a2[q] = plex_access(s2[q]);
+  }
+  s2[PLEX_QUERIES] = NULL;
+
+  plex = vrna_plex_init(&md);
+
+  for (acc = 0; acc < 2; acc++) {
+    for (q = 0; q < PLEX_QUERIES; q++) {
+      /* the same output as the legacy interface, with one context for all queries */
+      ref[q] = plex_output(s1,
+                           s2[q],
+                           (acc) ? (const int **)a1 : NULL,
+                           (acc) ? (const int **)a2[q] : NULL,
+                           0);
+      ck_assert(strlen(ref[q]) > 0);
+
+      out = vrna_plex_scan(plex,
+                           s1,
+                           s2[q],
+                           (acc) ? (const int **)a1 : NULL,
+                           (acc) ? (const int **)a2[q] : NULL,
+                           &opt);
+      ck_assert_ptr_ne(out, NULL);
+      ck_assert_str_eq(out, ref[q]);
+      free(out);
+    }
+
+    /* the result does not depend on the number of threads */
+    for (jobs = 1; jobs <= 4; jobs += 3) {
+      batch = vrna_plex_batch(s1,
+                              (acc) ? (const int **)a1 : NULL,
+                              (const char **)s2,
+                              (const int ***)a2,
+                              &md,
+                              &opt,
+                              jobs);
+      ck_assert_ptr_ne(batch, NULL);
+
+      for (q = 0; q < PLEX_QUERIES; q++) {
+        ck_assert_str_eq(batch[q], ref[q]);
+        free(batch[q]);
+      }
+
+      ck_assert_ptr_eq(batch[PLEX_QUERIES], NULL);
+      free(batch);
+    }
+
+    for (q = 0; q < PLEX_QUERIES; q++)
+      free(ref[q]);
+  }
+
+  ck_assert_ptr_eq(vrna_plex_batch(s1, NULL, NULL, NULL, &md, &opt, 1), NULL);
+
+  vrna_plex_free(plex);
+  plex_access_free(a1);
+  free(s1);
+  for (q = 0; q < PLEX_QUERIES; q++) {
+    plex_access_free(a2[q]);
+    free(s2[q]);
+  }
+}
+
+
+#main-pre
+    srunner_set_tap(sr, "-");
@@ -0,0 +1,257 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <ViennaRNA/utils/basic.h>
+#include <ViennaRNA/io/probability_store.h>
+
+#define PROB_STORE_TEST_FILE  "test_prob_store.bin"
+
+static const char   *prob_ids[] = {
+  "seq_c", "seq_a", "seq_d", "seq_b"
+};
+static const char   *prob_seqs[] = {
+  "GGGGAAAACCCC",
+  "A",
+  "GGGAAAUCCUUUGGGAAACCC",
+  "CGCGAUAUGCGC"
+};
+static const char   *prob_structs[] = {
+  "((((....))))",
+  NULL,
+  "(((...)))...(((...)))",
+  NULL
+};
+static unsigned int prob_ulength = 3;
+
+
+/* some deterministic probabilities of record r */
+static double
+prob_value(unsigned int r,
+           unsigned int u,
+           unsigned int i)
+{
+  return 1. / (1. + r + 2. * u + 3. * i);
+}
+
+
+static vrna_prob_store_record_t *
+prob_record(unsigned int r)
+{
+  unsigned int              i, u, n, n_pairs;
+  double                    *unpaired;
+  vrna_ep_t                 *pairs;
+  vrna_prob_store_record_t  *record;
+
+  n       = (unsigned int)strlen(prob_seqs[r]);
+  n_pairs = n / 2;
+  pairs   = (vrna_ep_t *)vrna_alloc(sizeof(vrna_ep_t) * (n_pairs + 1));
+
+  for (i = 0; i < n_pairs; i++) {
+    pairs[i].i    = i + 1;
+    pairs[i].j    = n - i;
+    pairs[i].p    = (float)prob_value(r, 0, i + 1);
+    pairs[i].type = VRNA_PLIST_TYPE_BASEPAIR;
+  }
+
+  unpaired = (double *)vrna_alloc(sizeof(double) * prob_ulength * n);
+
+  for (u = 1; u <= prob_ulength; u++)
+    for (i = 1; i <= n; i++)
+      unpaired[(u - 1) * n + (i - 1)] = prob_value(r, u, i);
+
+  record                  = (vrna_prob_store_record_t *)vrna_alloc(sizeof(vrna_prob_store_record_t));
+  record->id              = strdup(prob_ids[r]);
+  record->sequence        = strdup(prob_seqs[r]);
+  record->structure       = (prob_structs[r]) ? strdup(prob_structs[r]) : NULL;
+  record->length          = n;
+  record->ulength         = prob_ulength;
+  record->n_pairs         = n_pairs;
+  record->pairs           = pairs;
+  record->unpaired        = unpaired;
+  record->mfe             = -1.5 * r;
+  record->ensemble_energy = -2.5 * r;
+  record->cutoff          = 1e-5;
+  record->temperature     = 37.;
+  record->dangles         = 2;
+  record->max_bp_span     = (int)n;
+  record->window_size     = (int)n;
+  record->n_seq           = 1;
+
+  return record;
+}
+
+
+static void
+check_record(unsigned int                   r,
+             const vrna_prob_store_record_t *record)
+{
+  unsigned int  i, u, n;
+
+  n = (unsigned int)strlen(prob_seqs[r]);
+
+  ck_assert_str_eq(record->id, prob_ids[r]);
+  ck_assert_str_eq(record->sequence, prob_seqs[r]);
+
+  if (prob_structs[r])
+    ck_assert_str_eq(record->structure, prob_structs[r]);
+  else
+    ck_assert_ptr_eq(record->structure, NULL);
+
+  ck_assert_int_eq(record->length, n);
+  ck_assert_int_eq(record->ulength, prob_ulength);
+  ck_assert_int_eq(record->n_pairs, n / 2);
+  ck_assert(record->mfe == -1.5 * r);
+  ck_assert(record->ensemble_energy == -2.5 * r);
+  ck_assert_int_eq(record->dangles, 2);
+
+  for (i = 0; i < n / 2; i++) {
+    ck_assert_int_eq(record->pairs[i].i, i + 1);
+    ck_assert_int_eq(record->pairs[i].j, n - i);
+    ck_assert(record->pairs[i].p == (float)prob_value(r, 0, i + 1));
+  }
+
+  /* the pair list is terminated */
+  ck_assert_int_eq(record->pairs[n / 2].i, 0);
+  ck_assert_int_eq(record->pairs[n / 2].j, 0);
+
+  for (u = 1; u <= prob_ulength; u++)
+    for (i = 1; i <= n; i++)
+      ck_assert(record->unpaired[(u - 1) * n + (i - 1)] == prob_value(r, u, i));
+}
+
+
+#suite Probability_Store
+
+#tcase Round_Trip
+
+#test test_prob_store_round_trip
+{
+  unsigned int              r, n_records = sizeof(prob_seqs) / sizeof(char *);
+  vrna_prob_store_t         store;
+  vrna_prob_store_record_t  *rec, record;
+
+  store = vrna_prob_store_create(PROB_STORE_TEST_FILE);
+  ck_assert_ptr_ne(store, NULL);
+
+  for (r = 0; r < n_records; r++) {
+    rec = prob_record(r);
+    ck_assert_int_ne(vrna_prob_store_add(store, rec), 0);
+    vrna_prob_store_record_free(rec);
+  }
+
+  ck_assert_int_eq(vrna_prob_store_size(store), n_records);
+  ck_assert_int_ne(vrna_prob_store_close(store), 0);
+
+  store = vrna_prob_store_open(PROB_STORE_TEST_FILE);
+  ck_assert_ptr_ne(store, NULL);
+  ck_assert_int_eq(vrna_prob_store_size(store), n_records);
+
+  /* records are numbered in the order they were added */
+  for (r = 0; r < n_records; r++) {
+    memset(&record, 0, sizeof(vrna_prob_store_record_t));
+    ck_assert_int_ne(vrna_prob_store_get_nth(store, r, &record), 0);
+    check_record(r, &record);
+  }
+
+  ck_assert_int_eq(vrna_prob_store_get_nth(store, n_records, &record), 0);
+
+  /* look-up by ID */
+  for (r = 0; r < n_records; r++) {
+    memset(&record, 0, sizeof(vrna_prob_store_record_t));
+    ck_assert_int_ne(vrna_prob_store_get(store, prob_ids[r], &record), 0);
+    check_record(r, &record);
+  }
+
+  /* IDs that are not in the store */
+  ck_assert_int_eq(vrna_prob_store_get(store, "seq_x", &record), 0);
+  ck_assert_int_eq(vrna_prob_store_get(store, "", &record), 0);
+  ck_assert_int_eq(vrna_prob_store_get(store, "seq_a_", &record), 0);
+
+  ck_assert_int_ne(vrna_prob_store_close(store), 0);
+
+  remove(PROB_STORE_TEST_FILE);
+}
+
+
+#test test_prob_store_invalid
+{
+  vrna_prob_store_t         store;
+  vrna_prob_store_record_t  *rec, record;
+
+  store = vrna_prob_store_create(PROB_STORE_TEST_FILE);
+  ck_assert_ptr_ne(store, NULL);
+
+  /* the sequence does not match the length of the record */
+  rec         = prob_record(0);
+  rec->length = 5;
+  ck_assert_int_eq(vrna_prob_store_add(store, rec), 0);
+  rec->length = (unsigned int)strlen(rec->sequence);
+
+  /* no look-ups while writing */
+  ck_assert_int_eq(vrna_prob_store_get(store, prob_ids[0], &record), 0);
+
+  ck_assert_int_ne(vrna_prob_store_add(store, rec), 0);
+  vrna_prob_store_record_free(rec);
+
+  ck_assert_int_eq(vrna_prob_store_size(store), 1);
+  ck_assert_int_ne(vrna_prob_store_close(store), 0);
+
+  /* an empty store can still be opened */
+  store = vrna_prob_store_create(PROB_STORE_TEST_FILE);
+  ck_assert_ptr_ne(store, NULL);
+  ck_assert_int_ne(vrna_prob_store_close(store), 0);
+
+  store = vrna_prob_store_open(PROB_STORE_TEST_FILE);
+  ck_assert_ptr_ne(store, NULL);
+  ck_assert_int_eq(vrna_prob_store_size(store), 0);
+  ck_assert_int_eq(vrna_prob_store_get(store, prob_ids[0], &record), 0);
+  vrna_prob_store_close(store);
+
+  remove(PROB_STORE_TEST_FILE);
+}
+
+
+#tcase Corrupt_Files
+
+#test test_prob_store_corrupt_record
+{
+  /*
+   *  header, truncation, and ID checks are shared with all binary stores and
+   *  tested in binary_store.ts, here we only corrupt a record
+   */
+  long                      terminator;
+  FILE                      *fp;
+  vrna_prob_store_t         store;
+  vrna_prob_store_record_t  *rec;
+
+  store = vrna_prob_store_create(PROB_STORE_TEST_FILE);
+  ck_assert_ptr_ne(store, NULL);
+
+  rec = prob_record(0);
+  ck_assert_int_ne(vrna_prob_store_add(store, rec), 0);
+  vrna_prob_store_record_free(rec);
+
+  ck_assert_int_ne(vrna_prob_store_close(store), 0);
+
+  /* the first record directly follows the 32 byte header */
+  terminator = 32 + (long)strlen(prob_seqs[0]);
+
+  fp = fopen(PROB_STORE_TEST_FILE, "r+b");
+  ck_assert_ptr_ne(fp, NULL);
+  ck_assert_int_eq(fseek(fp, terminator, SEEK_SET), 0);
+  ck_assert_int_eq(fgetc(fp), '\0');
+
+  /* a sequence that is no longer terminated */
+  ck_assert_int_eq(fseek(fp, terminator, SEEK_SET), 0);
+  ck_assert_int_eq(fputc('A', fp), 'A');
+  ck_assert_int_eq(fclose(fp), 0);
+
+  ck_assert_ptr_eq(vrna_prob_store_open(PROB_STORE_TEST_FILE), NULL);
+
+  remove(PROB_STORE_TEST_FILE);
+}
+
+
+#main-pre
+    srunner_set_tap(sr, "-");
@@ -289,6 +289,132 @@ class FoldCompoundTest(unittest.TestCase):
         self.assertTrue((cf < comfe) and (comfe - cf < 1.3))
 
 
+    def test_pf_update(self):
+        """fold_compound method - Partition function update after local constraint changes"""
+        seq = seq1 + seq2 + seq3
+        fc  = RNA.fold_compound(seq)
+        fc2 = RNA.fold_compound(seq)
+        fc.pf()
+        for start in range(1, len(seq) - 8, 7):
+            for f in [fc, fc2]:
+                f.hc_init()
+                for i in range(start, start + 8):
+                    f.hc_add_up(i, RNA.CONSTRAINT_CONTEXT_ALL_LOOPS)
+
+            # the changed region covers the previous and the current window
+            (ss, gfe)   = fc.pf_update(max(1, start - 7), start + 7)
+            (ss2, gfe2) = fc2.pf()
+            self.assertEqual(ss, ss2)
+            self.assertTrue(abs(gfe - gfe2) < 1e-5)
+            bpp   = fc.bpp()
+            bpp2  = fc2.bpp()
+            for i in range(1, len(seq) + 1):
+                for j in range(i + 1, len(seq) + 1):
+                    self.assertTrue(abs(bpp[i][j] - bpp2[i][j]) < 1e-9)
+
+
+    def test_matrix_views(self):
+        """fold_compound method - Zero-copy access to base pair probabilities"""
+        fc = RNA.fold_compound(seq1)
+        fc.pf()
+        bpp   = fc.bpp()
+        iindx = fc.iindx
+        view  = fc.bpp_view()
+        self.assertEqual(len(view), len(fc.exp_matrices.probs))
+        self.assertTrue(abs(view[iindx[2] - 15] - bpp[2][15]) < 1e-9)
+
+        # the view keeps the fold_compound alive
+        del fc
+        self.assertTrue(abs(view[iindx[2] - 15] - bpp[2][15]) < 1e-9)
+
+
+    def test_matrix_views_invalidation(self):
+        """fold_compound method - Access to released memory"""
+        fc = RNA.fold_compound(seq1)
+        fc.pf()
+        view  = fc.bpp_view()
+        iindx = fc.iindx
+        self.assertTrue(view[0] == view[0])
+
+        # adding a strand releases the memory of the fold_compound
+        fc.sequence_add(seq2)
+
+        with self.assertRaises(RuntimeError):
+            view[0]
+        with self.assertRaises(RuntimeError):
+            iindx[1]
+
+        # arrays obtained afterwards are valid again
+        fc.pf()
+        view = fc.bpp_view()
+        self.assertTrue(view[0] == view[0])
+
+
+    def test_fold_batch(self):
+        """Batch MFE and partition function computations"""
+        seqs    = [seq1, seq2, seq3]
+        results = RNA.fold_batch(seqs, threads = 2)
+        self.assertEqual(len(results), len(seqs))
+        for s, (structure, mfe) in zip(seqs, results):
+            (ss, e) = RNA.fold_compound(s).mfe()
+            self.assertEqual(structure, ss)
+            self.assertTrue(abs(mfe - e) < 1e-5)
+
+        results = RNA.pf_fold_batch(seqs)
+        for s, (propensity, g) in zip(seqs, results):
+            fc = RNA.fold_compound(s)
+            (ss, mfe) = fc.mfe()
+            fc.exp_params_rescale(mfe)
+            (pp, e) = fc.pf()
+            self.assertEqual(propensity, pp)
+            self.assertTrue(abs(g - e) < 1e-5)
+
+
+    def test_prob_store(self):
+        """Write and read a probability store"""
+        import os, tempfile
+        (fd, filename) = tempfile.mkstemp(suffix = ".bpp")
+        os.close(fd)
+
+        seqs    = [seq1, seq2, seq3]
+        ids     = ["seq1", "seq2", "seq3"]
+        store   = RNA.prob_store_writer(filename)
+        for name, s in zip(ids, seqs):
+            fc = RNA.fold_compound(s)
+            (ss, mfe) = fc.mfe()
+            fc.exp_params_rescale(mfe)
+            (pp, g) = fc.pf()
+            self.assertEqual(store.add(name, fc, ss, mfe, g, 1e-3), 1)
+        store.close()
+
+        with RNA.prob_store(filename) as reader:
+            self.assertEqual(len(reader), 3)
+            self.assertEqual(reader.keys(), ids)
+            self.assertFalse("seq4" in reader)
+            for k, s in enumerate(seqs):
+                rec = reader[ids[k]]
+                self.assertEqual(rec.sequence, s)
+                self.assertEqual(rec.id, reader[k].id)
+
+                fc = RNA.fold_compound(s)
+                (ss, mfe) = fc.mfe()
+                fc.exp_params_rescale(mfe)
+                (pp, g) = fc.pf()
+                bpp = fc.bpp()
+                self.assertEqual(rec.structure, ss)
+                self.assertTrue(abs(rec.mfe - mfe) < 1e-5)
+                self.assertTrue(abs(rec.ensemble_energy - g) < 1e-5)
+                for (i, j, p, t) in rec.pairs:
+                    self.assertTrue(p >= 1e-3)
+                    self.assertTrue(abs(p - bpp[i][j]) < 1e-6)
+
+                for i in range(1, len(s) + 1):
+                    q = 1. - sum(bpp[min(i, j)][max(i, j)] for j in range(1, len(s) + 1) if j != i)
+                    self.assertTrue(abs(rec.unpaired[0][i - 1] - q) < 1e-9)
+
+        os.remove(filename)
+
+
 if __name__ == '__main__':
     unittest.main(testRunner=taprunner.TAPTestRunner())
 
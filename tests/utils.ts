@@ -6,6 +6,8 @@
 #include <ViennaRNA/utils/strings.h>
 #include <ViennaRNA/alphabet.h>
 #include <ViennaRNA/mfe.h>
+#include <ViennaRNA/utils/alignments.h>
+#include <ViennaRNA/datastructures/arena.h>
 
 static int
 compare_str(const void  *a,
@@ -299,6 +301,122 @@ compare_str(const void  *a,
 }
 
 
+#tcase Alignment_Utils
+
+#test test_vrna_aln_pfreq
+{
+  const char    *alignment[] = {
+    "GGGAAACCCU",
+    "GCGA-AGCGU",
+    "GGUAAAAUCC",
+    "-UGAAACAC-",
+    NULL
+  };
+  unsigned int  i, j, k, t, n_seq, n, ref[8], freq[8], single[8];
+  short         *S[4], *S_large[4];
+  vrna_md_t     md;
+  vrna_aln_bits_t *bits;
+
+  vrna_md_set_default(&md);
+
+  n_seq = 4;
+  n     = (unsigned int)strlen(alignment[0]);
+
+  for (i = 0; i < n_seq; i++) {
+    S[i]        = vrna_seq_encode_simple(alignment[i], &md);
+    S_large[i]  = vrna_seq_encode_simple(alignment[i], &md);
+  }
+
+  /* both counting schemes agree on a regular alignment */
+  bits = vrna_aln_bits((const short **)S, alignment, n_seq, n);
+  ck_assert(bits != NULL);
+
+  for (i = 1; i < n; i++)
+    for (j = i + 1; j <= n; j++) {
+      vrna_aln_bits_pfreq(bits, &md, i, j, ref);
+      vrna_aln_pfreq((const short **)S, alignment, n_seq, &md, i, j, freq);
+      for (k = 0; k < 8; k++)
+        ck_assert_uint_eq(freq[k], ref[k]);
+    }
+
+  /* an encoding beyond the range of the bit sets */
+  S_large[1][3] = 300;
+
+  ck_assert(vrna_aln_bits((const short **)S_large, alignment, n_seq, n) == NULL);
+
+  for (i = 1; i < n; i++)
+    for (j = i + 1; j <= n; j++) {
+      vrna_aln_bits_pfreq(bits, &md, i, j, ref);
+      vrna_aln_pfreq((const short **)S_large, alignment, n_seq, &md, i, j, freq);
+
+      /* the modified sequence can not pair at column 3 anymore */
+      if ((i == 3) || (j == 3)) {
+        vrna_aln_pfreq((const short **)&S[1], &alignment[1], 1, &md, i, j, single);
+        for (t = 0; single[t] == 0; t++);
+        if (t != 7) {
+          ref[t]--;
+          ref[0]++;
+        }
+      }
+
+      for (k = 0; k < 8; k++)
+        ck_assert_uint_eq(freq[k], ref[k]);
+    }
+
+  vrna_aln_bits_free(bits);
+
+  for (i = 0; i < n_seq; i++) {
+    free(S[i]);
+    free(S_large[i]);
+  }
+}
+
+
+#tcase Memory_Utils
+
+#test test_vrna_arena
+{
+  int           i;
+  char          *a, *b, *c, *big, *s;
+  vrna_arena_t  arena;
+
+  arena = vrna_arena_init(1024);
+
+  /* small requests are served consecutively from the current block */
+  a = (char *)vrna_arena_alloc(arena, 96);
+  b = (char *)vrna_arena_alloc(arena, 96);
+  ck_assert(b == a + 96);
+
+  /*
+   *  a request that exceeds the next block size gets a block of its own,
+   *  the remainder of the current block stays available
+   */
+  big = (char *)vrna_arena_alloc(arena, 1024 * 1024);
+  ck_assert(big != NULL);
+  for (i = 0; i < 1024 * 1024; i++)
+    ck_assert(big[i] == 0);
+
+  memset(big, 'x', 1024 * 1024);
+
+  c = (char *)vrna_arena_alloc(arena, 96);
+  ck_assert(c == b + 96);
+
+  s = vrna_arena_strdup_printf(arena, "%s-%d", "arena", 42);
+  ck_assert_str_eq(s, "arena-42");
+
+  /* a reset hands out the memory of the current block again, zeroed */
+  memset(a, 'x', 96);
+  vrna_arena_reset(arena);
+
+  c = (char *)vrna_arena_alloc(arena, 96);
+  ck_assert(c == a);
+  for (i = 0; i < 96; i++)
+    ck_assert(c[i] == 0);
+
+  vrna_arena_free(arena);
+}
+
+
 //@TODO: extend alphabeth
 //@TODO: details.noLP = 1
 //@TODO: idx_type = 1